@@ -8,6 +8,7 @@
 #endif
 
 #include <dyad/common/dyad_rc.h>
+#include <dyad/common/dyad_stats.h>
 #include <dyad/common/dyad_structures.h>
 #include <dyad/core/dyad_ctx.h>
 #include <sys/types.h>
@@ -36,16 +37,29 @@ extern "C" {
 struct dyad_metadata {
     char *fpath;
     uint32_t owner_rank;
+    uint32_t flags;       ///< DYAD_MDATA_HAS_* bits of the fields below published by the producer
+    uint64_t file_size;   ///< Size of the file in bytes
+    int64_t mtime_ns;     ///< Modification time of the file at publication, in ns since the epoch
+    uint64_t checksum;    ///< Checksum of the contents, if published
+    uint64_t block_size;  ///< Block size over which the checksum was computed
 };
 typedef struct dyad_metadata dyad_metadata_t;
 
+struct dyad_request;
+/**
+ * @brief Handle of a consume started by @c dyad_consume_async().
+ */
+typedef struct dyad_request dyad_request_t;
+
 /**
  * @brief Publishes a file under a DYAD-managed directory so it is available to consumers.
  *
  * @details
  * If @p fname falls under the producer-managed path, this function publishes
  * the file's metadata to the Flux KVS via @c dyad_commit(), signaling to
- * consumers that the file is ready to be read.
+ * consumers that the file is ready to be read. With
+ * @c DYAD_PUBLISH_BATCH_COUNT set, the metadata joins a batch committed
+ * once full, on @c dyad_flush() or at finalization.
  *
  * This function is the producer-side counterpart to @c dyad_consume(). It
  * does not transfer file data directly; instead it notifies the DYAD
@@ -71,6 +85,52 @@ typedef struct dyad_metadata dyad_metadata_t;
  */
 DYAD_PFA_ANNOTATE DYAD_DLL_EXPORTED dyad_rc_t dyad_produce (dyad_ctx_t *ctx, const char *fname);
 
+/**
+ * @brief Publishes several files in a single KVS commit.
+ *
+ * @details
+ * Each file is handled as by @c dyad_produce(), but the metadata of all of
+ * them, along with any batch left by previous calls, is committed at once
+ * before returning, whatever the @c DYAD_PUBLISH_BATCH_COUNT setting.
+ * Files not under the producer-managed path are skipped.
+ *
+ * @param[in] ctx     Pointer to the DYAD context. Must not be @c NULL and must
+ *                    have a valid @c prod_managed_path set.
+ * @param[in] fnames  Paths to the files that have been written.
+ * @param[in] n       Number of paths in @p fnames.
+ *
+ * @return @c dyad_rc_t return code indicating the outcome:
+ * @retval DYAD_RC_OK              Every file was published.
+ * @retval DYAD_RC_NOCTX           The context @p ctx or its Flux handle is @c NULL.
+ * @retval DYAD_RC_BADMANAGEDPATH  The producer-managed path in the context is @c NULL.
+ * @retval DYAD_RC_BADBUF          @p fnames is @c NULL while @p n is not 0.
+ * @retval DYAD_RC_*               The first error of @c dyad_commit() or of the
+ *                                 commit. The files added before an error
+ *                                 are still committed.
+ */
+DYAD_PFA_ANNOTATE DYAD_DLL_EXPORTED dyad_rc_t dyad_produce_batch (dyad_ctx_t *ctx,
+                                                                  const char **fnames,
+                                                                  size_t n);
+
+/**
+ * @brief Commits the files published by @c dyad_produce() that are still
+ *        waiting in the publication batch (see @c DYAD_PUBLISH_BATCH_COUNT).
+ *
+ * @details
+ * The batch is otherwise only committed once full, once older than
+ * @c DYAD_PUBLISH_BATCH_TIMEOUT, before the context blocks on a consume,
+ * or at finalization. Without a timeout, a producer should thus call this
+ * function before waiting on its consumers elsewhere.
+ *
+ * @param[in] ctx  Pointer to the DYAD context. Must not be @c NULL.
+ *
+ * @return @c dyad_rc_t return code indicating the outcome:
+ * @retval DYAD_RC_OK     The batch was committed, or was empty.
+ * @retval DYAD_RC_NOCTX  The context @p ctx or its Flux handle is @c NULL.
+ * @retval DYAD_RC_*      Any error code of the KVS commit.
+ */
+DYAD_DLL_EXPORTED dyad_rc_t dyad_flush (dyad_ctx_t *ctx);
+
 /**
  * @brief Retrieves metadata for a file under a DYAD-managed directory.
  *
@@ -122,6 +182,46 @@ DYAD_PFA_ANNOTATE DYAD_DLL_EXPORTED dyad_rc_t dyad_get_metadata (dyad_ctx_t *ctx
                                                                  bool should_wait,
                                                                  dyad_metadata_t **mdata);
 
+/**
+ * @brief Retrieves metadata for several files under a DYAD-managed
+ *        directory, with their KVS lookups in flight concurrently.
+ *
+ * @details
+ * Does the same as calling @c dyad_get_metadata() on every file of
+ * @p fnames, but sends the KVS lookups without waiting for each other, so
+ * that looking up @p n files costs about one round trip to the KVS rather
+ * than @p n. Up to 256 lookups are kept in flight at a time, and the next
+ * one is sent as each response is collected.
+ *
+ * A failure for one file does not stop the others: its entry of @p mdata
+ * is left @c NULL and the first such error is returned once every file has
+ * been looked up.
+ *
+ * @param[in]  ctx          Pointer to the DYAD context. Must not be @c NULL.
+ * @param[in]  fnames       Array of @p n paths, as accepted by
+ *                          @c dyad_get_metadata().
+ * @param[in]  n            Number of files.
+ * @param[in]  should_wait  If @c true, wait until the producers publish the
+ *                          metadata of every file.
+ * @param[out] mdata        Array of @p n metadata pointers, filled in with
+ *                          new objects to be freed by the caller with
+ *                          @c dyad_free_metadata(), or @c NULL for files
+ *                          whose metadata could not be retrieved.
+ *
+ * @return @c dyad_rc_t return code indicating the outcome:
+ * @retval DYAD_RC_OK       The metadata of every file was retrieved.
+ * @retval DYAD_RC_NOCTX    The context @p ctx or its Flux handle is @c NULL.
+ * @retval DYAD_RC_BADBUF   @p fnames or @p mdata is @c NULL.
+ * @retval DYAD_RC_SYSFAIL  The lookup window could not be allocated.
+ * @retval DYAD_RC_*        The error of the first file that failed, as
+ *                          returned by @c dyad_get_metadata().
+ */
+DYAD_PFA_ANNOTATE DYAD_DLL_EXPORTED dyad_rc_t dyad_get_metadata_batch (dyad_ctx_t *ctx,
+                                                                       const char **fnames,
+                                                                       size_t n,
+                                                                       bool should_wait,
+                                                                       dyad_metadata_t **mdata);
+
 /**
  * @brief Frees a @c dyad_metadata_t object allocated by @c dyad_get_metadata().
  *
@@ -179,6 +279,14 @@ DYAD_PFA_ANNOTATE DYAD_DLL_EXPORTED dyad_rc_t dyad_free_metadata (dyad_metadata_
  * released. Because POSIX @c fcntl locks are cooperative, these guarantees
  * only hold between processes that also participate in locking.
  *
+ * If @c DYAD_COALESCE_PATH names a node-local directory, consumers on the
+ * same node that request the same file also serialize on a lock of a
+ * record in that directory before looking up its metadata. The first one
+ * looks up and fetches the file and records it as fetched. The others wake
+ * up as soon as it is done and return without a KVS lookup or transfer of
+ * their own, including with shared storage and with C++ streams, where
+ * the size of the file alone cannot tell that it is complete.
+ *
  * @param[in]     ctx    Pointer to the DYAD context. Must not be @c NULL and must
  *                       have a valid @c cons_managed_path set.
  * @param[in]     fname  Path to the file to be checked and made ready. May be an
@@ -261,6 +369,327 @@ DYAD_PFA_ANNOTATE DYAD_DLL_EXPORTED dyad_rc_t dyad_consume (dyad_ctx_t *ctx, con
 DYAD_PFA_ANNOTATE DYAD_DLL_EXPORTED dyad_rc_t
 dyad_consume_w_metadata (dyad_ctx_t *ctx, const char *fname, const dyad_metadata_t *mdata);
 
+/**
+ * @brief Ensures several files under a DYAD-managed directory are ready to
+ *        be read, fetching those owned by the same producer together.
+ *
+ * @details
+ * Equivalent to calling @c dyad_consume() on each of @p fnames, but with
+ * far fewer round trips when many files come from the same producer. Every
+ * file is first locked and its metadata looked up, as in @c dyad_consume().
+ * The files to transfer are then grouped by owner broker rank, and each
+ * group is fetched with a single @c DYAD_DTL_BATCH_RPC_NAME RPC stream and
+ * DTL session, instead of one RPC, connection and end-of-stream exchange
+ * per file. Each file is written to its destination as it arrives.
+ *
+ * Files that a producer could not serve in a batch, including every file
+ * when the producer's module does not support batches, are fetched one by
+ * one with @c dyad_consume() once the locks have been released.
+ *
+ * With shared storage, or with a DTL other than @c FLUX_RPC, this simply
+ * calls @c dyad_consume() on each file.
+ *
+ * @param[in]     ctx     Pointer to the DYAD context. Must not be @c NULL and
+ *                        must have a valid @c cons_managed_path set.
+ * @param[in]     fnames  Paths of the files to be checked and made ready, as
+ *                        accepted by @c dyad_consume().
+ * @param[in]     n       Number of entries in @p fnames.
+ *
+ * @return @c dyad_rc_t return code indicating the outcome:
+ * @retval DYAD_RC_OK              Every file is ready to read, was already
+ *                                 available, or is not under the managed path.
+ * @retval DYAD_RC_NOCTX           The context @p ctx or its Flux handle is @c NULL.
+ * @retval DYAD_RC_BADMANAGEDPATH  The consumer-managed path in the context is @c NULL.
+ * @retval DYAD_RC_SYSFAIL         The state of the batch could not be allocated.
+ * @retval DYAD_RC_*               The last error encountered for any of the files.
+ *                                 The other files are still made ready.
+ *
+ * @note The exclusive locks of all the files fetched in a batch are held
+ *       until the whole batch has been received.
+ *
+ * @warning The caller must ensure @p ctx remains valid for the duration of this call.
+ */
+DYAD_PFA_ANNOTATE DYAD_DLL_EXPORTED dyad_rc_t dyad_consume_batch (dyad_ctx_t *ctx,
+                                                                  const char **fnames,
+                                                                  size_t n);
+
+/**
+ * @brief Ensures a byte range of a file under a DYAD-managed directory is
+ *        ready to be read, without fetching the rest of the file.
+ *
+ * @details
+ * Looks up the metadata of the file as @c dyad_consume() does, but only
+ * asks the producer's module for @p length bytes starting at @p offset,
+ * and writes them at the same offset in the destination file. This avoids
+ * moving a whole file when a reader, e.g., a record-oriented data loader,
+ * only needs a few records of it.
+ *
+ * The destination file is marked with the @c user.dyad.partial extended
+ * attribute until the whole file is fetched, so that @c dyad_consume()
+ * and @c dyad_consume_batch() do not take it for a complete copy. This
+ * requires a file system supporting user extended attributes for the
+ * consumer-managed directory. Ranges already fetched are not tracked, so
+ * requesting the same range twice transfers it twice.
+ *
+ * If the whole file is already available, nothing is fetched. With shared
+ * storage, or when both @p offset and @p length are 0, this is the same as
+ * @c dyad_consume().
+ *
+ * @param[in] ctx     Pointer to the DYAD context. Must not be @c NULL and
+ *                    must have a valid @c cons_managed_path set.
+ * @param[in] fname   Path of the file, as accepted by @c dyad_consume().
+ * @param[in] offset  Offset of the first byte to fetch. Must be less than
+ *                    the size of the producer's file.
+ * @param[in] length  Number of bytes to fetch, or 0 for everything from
+ *                    @p offset to the end of the file. Ranges running past
+ *                    the end of the file are cut short.
+ *
+ * @return @c dyad_rc_t return code indicating the outcome:
+ * @retval DYAD_RC_OK              The range is ready to read, the whole file was
+ *                                 already available, or the file is not under the
+ *                                 managed path.
+ * @retval DYAD_RC_NOCTX           The context @p ctx or its Flux handle is @c NULL.
+ * @retval DYAD_RC_BADMANAGEDPATH  The consumer-managed path in the context is @c NULL.
+ * @retval DYAD_RC_BADFIO          The destination file could not be created, marked
+ *                                 or written.
+ * @retval DYAD_RC_BADRPC          The producer rejected the range, e.g., because
+ *                                 @p offset is past the end of the file.
+ * @retval DYAD_RC_*               Any error returned by the metadata lookup or the
+ *                                 transfer, as in @c dyad_consume().
+ *
+ * @warning The caller must ensure @p ctx remains valid for the duration of this call.
+ */
+DYAD_PFA_ANNOTATE DYAD_DLL_EXPORTED dyad_rc_t dyad_consume_range (dyad_ctx_t *ctx,
+                                                                  const char *fname,
+                                                                  size_t offset,
+                                                                  size_t length);
+
+/**
+ * @brief Retrieves the contents of a file under a DYAD-managed directory
+ *        into memory, without storing it in the consumer-managed directory.
+ *
+ * @details
+ * Waits for the file to be published as @c dyad_consume() does, then hands
+ * its contents to the caller instead of writing them to a local file. No
+ * destination file is created, locked or written, so data consumed once,
+ * e.g., training samples, neither costs local writes nor fills node-local
+ * storage.
+ *
+ * Data fetched from a remote producer is returned in the buffer the DTL
+ * received it into, except with the @c UCX DTL, whose receive buffer is
+ * reused by every transfer and is therefore copied. Files that are already
+ * accessible, i.e., with shared storage or a producer on the same node,
+ * are read from the file system. The whole file is transferred as a single
+ * message, regardless of @c DYAD_TRANSFER_CHUNK_SIZE.
+ *
+ * @param[in]  ctx    Pointer to the DYAD context. Must not be @c NULL and
+ *                    must have a valid @c cons_managed_path set.
+ * @param[in]  fname  Path of the file, as accepted by @c dyad_consume().
+ * @param[out] buf    Set to the contents of the file, to be released with
+ *                    @c dyad_release_buffer(), or to @c NULL for an empty
+ *                    file.
+ * @param[out] len    Set to the size of the file.
+ *
+ * @return @c dyad_rc_t return code indicating the outcome:
+ * @retval DYAD_RC_OK              @p buf holds the contents of the file.
+ * @retval DYAD_RC_NOCTX           The context @p ctx or its Flux handle is @c NULL.
+ * @retval DYAD_RC_BADBUF          @p buf or @p len is @c NULL.
+ * @retval DYAD_RC_BADMANAGEDPATH  The consumer-managed path in the context is @c NULL.
+ * @retval DYAD_RC_UNTRACKED       The file is not under the consumer-managed path.
+ * @retval DYAD_RC_BADFIO          An accessible file could not be read.
+ * @retval DYAD_RC_SYSFAIL         A buffer could not be allocated.
+ * @retval DYAD_RC_*               Any error returned by the metadata lookup or the
+ *                                 transfer, as in @c dyad_consume().
+ */
+DYAD_PFA_ANNOTATE DYAD_DLL_EXPORTED dyad_rc_t dyad_consume_to_buffer (dyad_ctx_t *ctx,
+                                                                      const char *fname,
+                                                                      void **buf,
+                                                                      size_t *len);
+
+/**
+ * @brief Releases a buffer returned by @c dyad_consume_to_buffer() and sets
+ *        @p *buf to @c NULL. Does nothing if @p buf or @p *buf is @c NULL.
+ *
+ * @param[in]     ctx  Context the buffer was obtained with.
+ * @param[in,out] buf  Address of the buffer to release.
+ *
+ * @return @c DYAD_RC_OK, or @c DYAD_RC_NOCTX if @p ctx has no DTL.
+ */
+DYAD_DLL_EXPORTED dyad_rc_t dyad_release_buffer (dyad_ctx_t *ctx, void **buf);
+
+/**
+ * @brief Starts consuming a file under a DYAD-managed directory without
+ *        blocking.
+ *
+ * @details
+ * Resolves @p fname as @c dyad_consume() does and sends the KVS lookup of
+ * its metadata, but returns right away instead of waiting for the producer
+ * to publish the file. The consume is completed with @c dyad_test(),
+ * @c dyad_wait() or @c dyad_wait_any(). This lets an application keep
+ * lookups of many files outstanding from a single thread, and overlap
+ * them with computation.
+ *
+ * Lookups progress concurrently, driven by the reactor of the context's
+ * Flux handle whenever one of the completion functions is called. Once a
+ * lookup is answered, the file is fetched and stored as by
+ * @c dyad_consume_w_metadata(). Since transfers share the DTL connection of
+ * the context, they run one at a time, in the thread completing the
+ * request. With shared storage, or if the producer is on the same node,
+ * completion only waits for the lookup.
+ *
+ * Like the context, requests must not be used from several threads at
+ * once.
+ *
+ * @param[in]  ctx    Pointer to the DYAD context. Must not be @c NULL and
+ *                    must have a valid @c cons_managed_path set.
+ * @param[in]  fname  Path of the file, as accepted by @c dyad_consume().
+ * @param[out] req    Handle of the consume, to be passed to one of the
+ *                    completion functions, which frees it. Set to @c NULL
+ *                    on error. Files outside the managed path get a handle
+ *                    that completes right away with @c DYAD_RC_OK.
+ *
+ * @return @c dyad_rc_t return code indicating the outcome:
+ * @retval DYAD_RC_OK              The consume was started.
+ * @retval DYAD_RC_NOCTX           The context @p ctx or its Flux handle is @c NULL.
+ * @retval DYAD_RC_BADMANAGEDPATH  The consumer-managed path in the context is @c NULL.
+ * @retval DYAD_RC_BADBUF          @p req is @c NULL.
+ * @retval DYAD_RC_BADFIO          @p fname is longer than @c PATH_MAX.
+ * @retval DYAD_RC_SYSFAIL         The request could not be allocated.
+ * @retval DYAD_RC_NOTFOUND        The KVS lookup could not be sent.
+ *
+ * @warning The caller must ensure @p ctx remains valid until the request
+ *          completes.
+ */
+DYAD_PFA_ANNOTATE DYAD_DLL_EXPORTED dyad_rc_t dyad_consume_async (dyad_ctx_t *ctx,
+                                                                  const char *fname,
+                                                                  dyad_request_t **req);
+
+/**
+ * @brief Completes a consume started by @c dyad_consume_async() if its
+ *        metadata has been published, without waiting for it otherwise.
+ *
+ * @details
+ * Handles the lookup responses that have already arrived. If the one of
+ * @p *req is among them, fetches and stores the file, which does block for
+ * the duration of the transfer, frees the request and sets @p *req to
+ * @c NULL.
+ *
+ * @param[in,out] req   Address of the handle of the consume.
+ * @param[out]    done  Whether the consume has completed.
+ *
+ * @return The outcome of the consume, as returned by @c dyad_consume(), if
+ *         @p done is set. Otherwise @c DYAD_RC_OK, @c DYAD_RC_BADBUF if an
+ *         argument is @c NULL, or @c DYAD_RC_SYSFAIL if the reactor failed.
+ */
+DYAD_PFA_ANNOTATE DYAD_DLL_EXPORTED dyad_rc_t dyad_test (dyad_request_t **req, bool *done);
+
+/**
+ * @brief Waits for a consume started by @c dyad_consume_async() to
+ *        complete.
+ *
+ * @details
+ * Frees the request and sets @p *req to @c NULL once the consume has
+ * completed. Lookups of other outstanding requests of the same context
+ * keep progressing while waiting.
+ *
+ * @param[in,out] req  Address of the handle of the consume.
+ *
+ * @return The outcome of the consume, as returned by @c dyad_consume(),
+ *         @c DYAD_RC_BADBUF if @p req is @c NULL, or @c DYAD_RC_SYSFAIL if
+ *         the reactor failed, in which case the request is left pending.
+ */
+DYAD_PFA_ANNOTATE DYAD_DLL_EXPORTED dyad_rc_t dyad_wait (dyad_request_t **req);
+
+/**
+ * @brief Waits for any of several consumes started by
+ *        @c dyad_consume_async() to complete.
+ *
+ * @details
+ * Completes one request whose metadata has been published, frees it and
+ * sets its entry of @p reqs to @c NULL. @c NULL entries are skipped, so
+ * the same array can be passed again until every request has completed.
+ * All requests must have been started with the same context, i.e., by the
+ * same thread, whose reactor is the one run while waiting. An array mixing
+ * contexts is rejected before any request is completed.
+ *
+ * @param[in,out] reqs   Array of @p n handles, possibly @c NULL.
+ * @param[in]     n      Number of entries of @p reqs.
+ * @param[out]    index  Index of the completed request, or @p n if every
+ *                       entry of @p reqs is @c NULL.
+ *
+ * @return The outcome of the completed consume, as returned by
+ *         @c dyad_consume(), @c DYAD_RC_OK if there was nothing to wait
+ *         for, @c DYAD_RC_BADBUF if @p reqs or @p index is @c NULL or the
+ *         requests have different contexts, or @c DYAD_RC_SYSFAIL if the
+ *         reactor failed.
+ */
+DYAD_PFA_ANNOTATE DYAD_DLL_EXPORTED dyad_rc_t dyad_wait_any (dyad_request_t **reqs,
+                                                             size_t n,
+                                                             size_t *index);
+
+/**
+ * @brief Copies the latency histograms recorded by this process.
+ *
+ * @details
+ * The histograms are shared by every DYAD context of the process and
+ * cover the consumer phases of @c dyad_stats_phase_t, i.e., those prefixed
+ * with "Client". Setting @c DYAD_STATS_DUMP also writes a summary of them,
+ * with estimated medians and tails, when the context is finalized.
+ *
+ * @param[in]  ctx    Pointer to the DYAD context. Must not be @c NULL.
+ * @param[out] stats  Snapshot of the histograms. Must not be @c NULL.
+ *
+ * @return @c dyad_rc_t return code indicating the outcome:
+ * @retval DYAD_RC_OK      The snapshot was taken.
+ * @retval DYAD_RC_NOCTX   The context @p ctx is @c NULL.
+ * @retval DYAD_RC_BADBUF  @p stats is @c NULL.
+ */
+DYAD_PFA_ANNOTATE DYAD_DLL_EXPORTED dyad_rc_t dyad_get_stats (dyad_ctx_t *ctx,
+                                                              dyad_stats_t *stats);
+
+/**
+ * @brief Clears the latency histograms recorded by this process.
+ *
+ * @param[in] ctx  Pointer to the DYAD context. Must not be @c NULL.
+ *
+ * @return @c dyad_rc_t return code indicating the outcome:
+ * @retval DYAD_RC_OK     The histograms were cleared.
+ * @retval DYAD_RC_NOCTX  The context @p ctx is @c NULL.
+ */
+DYAD_PFA_ANNOTATE DYAD_DLL_EXPORTED dyad_rc_t dyad_reset_stats (dyad_ctx_t *ctx);
+
+/**
+ * @brief Retrieves the latency histograms of the DYAD module of a broker.
+ *
+ * @details
+ * Sends a @c dyad.stats RPC to the module loaded on broker @p rank, which
+ * replies with the producer phases of @c dyad_stats_phase_t, i.e., those
+ * prefixed with "Module". Together with @c dyad_get_stats(), this tells
+ * whether a slow transfer waited on the producer's storage, on its worker
+ * threads or on the network.
+ *
+ * @param[in]  ctx    Pointer to the DYAD context. Must not be @c NULL and
+ *                    must have a valid Flux handle.
+ * @param[in]  rank   Rank of the broker to query, e.g., the @c owner_rank
+ *                    of a file's metadata.
+ * @param[in]  reset  Whether the module clears its histograms after replying.
+ * @param[out] stats  Histograms of the module. Must not be @c NULL.
+ *
+ * @return @c dyad_rc_t return code indicating the outcome:
+ * @retval DYAD_RC_OK         @p stats holds the histograms of the module.
+ * @retval DYAD_RC_NOCTX      The context @p ctx or its Flux handle is @c NULL.
+ * @retval DYAD_RC_BADBUF     @p stats is @c NULL.
+ * @retval DYAD_RC_BADRPC     The RPC failed, e.g., because no DYAD module is
+ *                            loaded on broker @p rank.
+ * @retval DYAD_RC_BADUNPACK  The reply could not be parsed.
+ *
+ * @warning The caller must ensure @p ctx remains valid for the duration of this call.
+ */
+DYAD_PFA_ANNOTATE DYAD_DLL_EXPORTED dyad_rc_t dyad_get_module_stats (dyad_ctx_t *ctx,
+                                                                     uint32_t rank,
+                                                                     bool reset,
+                                                                     dyad_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
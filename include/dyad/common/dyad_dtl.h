@@ -93,6 +93,69 @@ typedef enum dyad_dtl_comm_mode dyad_dtl_comm_mode_t;
  */
 #define DYAD_DTL_RPC_NAME "dyad.fetch"
 
+/**
+ * @brief Flux RPC topic name for batched DYAD file fetch requests.
+ *
+ * @details
+ * Used by @c dyad_consume_batch() to request several files from the same
+ * producer's broker in a single RPC stream. The payload is that of a
+ * @c DYAD_DTL_RPC_NAME request for the first file, with an additional
+ * @c "upaths" array listing every requested file. Each file is answered
+ * by a header response, @c {"index": i, "size": n} or
+ * @c {"index": i, "errnum": e}, followed by its contents, and the stream
+ * ends with @c ENODATA. Only served with the @c FLUX_RPC DTL.
+ */
+#define DYAD_DTL_BATCH_RPC_NAME "dyad.fetch_batch"
+
+/**
+ * @brief Topic of the RPC retrieving the latency histograms of a module.
+ *
+ * @details
+ * Used by @c dyad_get_module_stats(). The request may carry
+ * @c {"reset": true} to clear the histograms after replying. The response
+ * is @c {"phases": [...]}, with one object per non-empty phase holding its
+ * @c "name", @c "count", @c "total_ns", @c "max_ns" and @c "buckets".
+ */
+#define DYAD_STATS_RPC_NAME "dyad.stats"
+
+/**
+ * @brief Topic of the RPC retrieving the size of a file from the module of
+ *        its producer.
+ *
+ * @details
+ * Used by consumers to plan striped transfers (see
+ * @c DYAD_STRIPE_THRESHOLD_ENV). The request is @c {"upath": path}, with
+ * the path relative to the producer-managed directory, and the response is
+ * @c {"size": n}.
+ */
+#define DYAD_STAT_RPC_NAME "dyad.stat"
+
+/**
+ * @brief Topic of the RPC with which a consumer registers with the module
+ *        of a producer before its first fetch from it.
+ *
+ * @details
+ * Only used by DTLs that set @c rpc_register, i.e., the UCX DTL, whose
+ * consumers send their worker address and the key of their receive ring
+ * once, as a raw payload, instead of with every fetch. The response is
+ * the raw 64-bit key under which the producer knows the consumer, carried
+ * by later @c DYAD_DTL_RPC_NAME requests.
+ */
+#define DYAD_DTL_REGISTER_RPC_NAME "dyad.register"
+
+/**
+ * @brief Prefix of the Flux event topics on which producers announce the
+ *        files they publish.
+ *
+ * @details
+ * Used when @c DYAD_NOTIFY_ENV is set to @c "event". The topic of a file
+ * appends the first-level bin of its KVS key followed by a dot, so that a
+ * waiting consumer only subscribes to the bin of its file. The payload is
+ * the binary metadata record of the file (see @c mdata_record.h) followed
+ * by its null-terminated path relative to the managed directory.
+ */
+#define DYAD_NOTIFY_TOPIC_PREFIX "dyad.ready."
+
 /**
  * @brief Opaque DTL handle.
  *
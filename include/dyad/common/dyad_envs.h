@@ -132,4 +132,324 @@
  */
 #define DYAD_MARGO_PROTO_ENV "DYAD_MARGO_PROTO"
 
+/**
+ * @brief Number of worker threads the DYAD Flux module uses to load files
+ *        for fetch requests.
+ *
+ * @details
+ * 0 or unset serves every request on the broker's reactor thread. Can be
+ * overridden with the module's @c -w option.
+ */
+#define DYAD_MOD_WORKERS_ENV "DYAD_MOD_WORKERS"
+
+/**
+ * @brief Number of fetch requests that may wait for a worker of the DYAD
+ *        Flux module.
+ *
+ * @details
+ * Unset defaults to 64 per worker. Further requests are answered with
+ * @c EAGAIN until a worker picks up a waiting one. Set to 0 for no limit.
+ * Ignored without @c DYAD_MOD_WORKERS.
+ */
+#define DYAD_MOD_QUEUE_SIZE_ENV "DYAD_MOD_QUEUE_SIZE"
+
+/**
+ * @brief Size in bytes of the chunks in which a consumer asks the DYAD
+ *        module to stream a file.
+ *
+ * @details
+ * 0 or unset transfers each file as a single message. Only honored with
+ * the @c FLUX_RPC DTL.
+ */
+#define DYAD_TRANSFER_CHUNK_SIZE_ENV "DYAD_TRANSFER_CHUNK_SIZE"
+
+/**
+ * @brief Number of chunks of a streamed transfer the DYAD module may send
+ *        ahead of the consumer.
+ *
+ * @details
+ * Unset defaults to 16. The consumer asks for a file in byte ranges of
+ * half that many chunks, and asks for the next range only once it wrote
+ * the oldest one, so that a slow consumer holds at most this many chunks
+ * in flight. Set to 0 to ask for the whole file at once. Only used with
+ * @c DYAD_TRANSFER_CHUNK_SIZE.
+ */
+#define DYAD_TRANSFER_WINDOW_ENV "DYAD_TRANSFER_WINDOW"
+
+/**
+ * @brief If set, the DYAD Flux module sends files from a memory mapping
+ *        instead of reading them into a buffer first.
+ *
+ * @details
+ * Files on file systems that do not support @c mmap() are still read.
+ * Can also be enabled with the module's @c -z option.
+ */
+#define DYAD_MOD_ZERO_COPY_ENV "DYAD_MOD_ZERO_COPY"
+
+/**
+ * @brief Memory budget in bytes for the DYAD Flux module's cache of
+ *        recently fetched files.
+ *
+ * @details
+ * 0 or unset disables the cache. Cached copies are checked against the
+ * file's size and modification time on every fetch. Can be overridden
+ * with the module's @c -c option.
+ */
+#define DYAD_MOD_CACHE_SIZE_ENV "DYAD_MOD_CACHE_SIZE"
+
+/**
+ * @brief Node-local directory in which consumers coordinate fetches of the
+ *        same file.
+ *
+ * @details
+ * If set, concurrent consumers on a node that request the same file share
+ * a single metadata lookup and transfer. The directory holds one small
+ * record file per requested file, and must be on storage private to the
+ * node, e.g., under @c /dev/shm or @c /tmp. Unset or empty disables
+ * coalescing.
+ */
+#define DYAD_COALESCE_PATH_ENV "DYAD_COALESCE_PATH"
+
+/**
+ * @brief Codec with which a consumer asks the DYAD module to compress the
+ *        files it fetches: @c "none", @c "lz4" or @c "zstd".
+ *
+ * @details
+ * The codec is requested per transfer, so consumers of different KVS
+ * namespaces can make different choices. Modules built without the codec,
+ * or predating compression, send uncompressed data, which the consumer
+ * accepts as well. Unset defaults to @c "none". Only honored with the
+ * @c FLUX_RPC and @c MARGO DTLs.
+ */
+#define DYAD_COMPRESSION_ENV "DYAD_COMPRESSION"
+
+/**
+ * @brief Size in bytes below which messages are sent uncompressed even if
+ *        @c DYAD_COMPRESSION is set.
+ */
+#define DYAD_COMPRESSION_THRESHOLD_ENV "DYAD_COMPRESSION_THRESHOLD"
+
+/**
+ * @brief Engine with which files are read by the DYAD module and written
+ *        by consumers: @c "posix" or @c "io_uring".
+ *
+ * @details
+ * Unset defaults to @c "posix". @c "io_uring" requires DYAD to be built
+ * with @c DYAD_ENABLE_IO_URING, and threads that cannot set up a ring
+ * fall back to @c "posix". Can be overridden with the module's @c -u
+ * option.
+ */
+#define DYAD_IO_ENGINE_ENV "DYAD_IO_ENGINE"
+
+/**
+ * @brief Number of threads with which a consumer writes a large received
+ *        buffer.
+ *
+ * @details
+ * Unset defaults to 1. Buffers are cut into parts of at least
+ * @c DYAD_STORE_MIN_PART bytes, the first written by the calling thread
+ * and the others by threads started once per context and kept for its
+ * lifetime. The threads of a striped fetch write their stripes as a
+ * single part.
+ */
+#define DYAD_STORE_THREADS_ENV "DYAD_STORE_THREADS"
+
+/**
+ * @brief Whether consumers write fetched files with @c O_DIRECT.
+ *
+ * @details
+ * Set to 1 to bypass the page cache for the aligned part of each write.
+ * Files on a file system without @c O_DIRECT support, e.g., tmpfs, are
+ * written through the page cache.
+ */
+#define DYAD_STORE_DIRECT_ENV "DYAD_STORE_DIRECT"
+
+/**
+ * @brief Set to @c "0" to stop recording the latency histograms of
+ *        @c dyad_stats.h. Recording is on otherwise.
+ */
+#define DYAD_STATS_ENV "DYAD_STATS"
+
+/**
+ * @brief File to which a summary of the latency histograms of the process
+ *        is appended when its DYAD context is finalized, or @c "-" for
+ *        standard error.
+ *
+ * @details
+ * Unset disables the summary. Every process appends its own table, headed
+ * by its rank and pid, so a single file can be shared by a whole job.
+ */
+#define DYAD_STATS_DUMP_ENV "DYAD_STATS_DUMP"
+
+/**
+ * @brief Maximum number of owner ranks cached by each consumer, so that
+ *        files fetched again are not looked up in the KVS again.
+ *
+ * @details
+ * Unset defaults to 4096. Set to 0 to disable the cache. The threads of a
+ * process share one cache, sized by the first thread to initialize DYAD.
+ */
+#define DYAD_MDATA_CACHE_SIZE_ENV "DYAD_MDATA_CACHE_SIZE"
+
+/**
+ * @brief Seconds an owner rank stays in the metadata cache, or 0 for no
+ *        expiration.
+ *
+ * @details
+ * Unset defaults to 60. A producer republishing a file from another
+ * broker is noticed once the entry expires, or as soon as a fetch from
+ * the cached owner fails.
+ */
+#define DYAD_MDATA_CACHE_TTL_ENV "DYAD_MDATA_CACHE_TTL"
+
+/**
+ * @brief Seconds a file found missing by a lookup that does not wait stays
+ *        in the metadata cache, so that polling consumers do not flood the
+ *        KVS.
+ *
+ * @details
+ * Unset defaults to 0, i.e., missing files are not cached.
+ */
+#define DYAD_MDATA_CACHE_NEG_TTL_ENV "DYAD_MDATA_CACHE_NEG_TTL"
+
+/**
+ * @brief Size in bytes from which a consumer fetches a file as several
+ *        byte ranges transferred concurrently.
+ *
+ * @details
+ * 0 or unset transfers each file over a single stream. A file of at least
+ * this size is split into up to @c DYAD_STRIPE_COUNT ranges of at least
+ * half this size each, and every range but the first is fetched by a thread
+ * with its own Flux and DTL handles.
+ */
+#define DYAD_STRIPE_THRESHOLD_ENV "DYAD_STRIPE_THRESHOLD"
+
+/**
+ * @brief Maximum number of concurrent streams of a striped transfer.
+ *
+ * @details
+ * Unset defaults to 4. Values below 2 disable striping.
+ */
+#define DYAD_STRIPE_COUNT_ENV "DYAD_STRIPE_COUNT"
+
+/**
+ * @brief Number of published files a producer gathers into a single KVS
+ *        commit.
+ *
+ * @details
+ * Unset defaults to 1, i.e., every file is committed on its own. Larger
+ * values delay the publication of a file until the batch is full, exceeds
+ * @c DYAD_PUBLISH_BATCH_BYTES, is older than @c DYAD_PUBLISH_BATCH_TIMEOUT,
+ * or is flushed by @c dyad_flush() or at finalization.
+ */
+#define DYAD_PUBLISH_BATCH_COUNT_ENV "DYAD_PUBLISH_BATCH_COUNT"
+
+/**
+ * @brief Approximate size in bytes of the keys of a publication batch from
+ *        which it is committed.
+ *
+ * @details
+ * Unset defaults to 65536. Set to 0 for no limit.
+ */
+#define DYAD_PUBLISH_BATCH_BYTES_ENV "DYAD_PUBLISH_BATCH_BYTES"
+
+/**
+ * @brief Seconds after which a publication batch is committed.
+ *
+ * @details
+ * Unset defaults to 0.1. A batch that ages while its producer publishes
+ * nothing is committed by a helper thread, with a Flux handle of its own.
+ * Set to 0 for no limit, in which case a producer that stops publishing
+ * should call @c dyad_flush().
+ */
+#define DYAD_PUBLISH_BATCH_TIMEOUT_ENV "DYAD_PUBLISH_BATCH_TIMEOUT"
+
+/**
+ * @brief Whether producers publish a checksum of each file in its KVS record.
+ *
+ * @details
+ * Set to 1 to enable. The checksum lets consumers reuse a local copy of a
+ * file without fetching it again, at the cost of reading the whole file
+ * when it is published. Without it, consumers always fetch the file, as
+ * its size and modification time do not tell two versions apart.
+ */
+#define DYAD_PUBLISH_CHECKSUM_ENV "DYAD_PUBLISH_CHECKSUM"
+
+/**
+ * @brief Whether producers publish the owner rank alone in the KVS record.
+ *
+ * @details
+ * Set to 1 while consumers built before the binary metadata record are
+ * still running. Consumers read both forms of the record.
+ */
+#define DYAD_MDATA_LEGACY_ENV "DYAD_MDATA_LEGACY"
+
+/**
+ * @brief Channel on which consumers wait for files to be published:
+ *        @c "kvs" or @c "event".
+ *
+ * @details
+ * Unset defaults to @c "kvs", where each waiting consumer holds a
+ * @c FLUX_KVS_WAITCREATE lookup. With @c "event", producers also announce
+ * each committed file with a Flux event (see @c DYAD_NOTIFY_TOPIC_PREFIX),
+ * and consumers wait for the event instead, checking the KVS again every
+ * @c DYAD_NOTIFY_TIMEOUT seconds. Should be set alike for producers and
+ * consumers, although a consumer waiting on events for a producer that
+ * does not send them still sees its files on the next KVS check.
+ */
+#define DYAD_NOTIFY_ENV "DYAD_NOTIFY"
+
+/**
+ * @brief Seconds a consumer waits for the event of a file before checking
+ *        the KVS again.
+ *
+ * @details
+ * Unset defaults to 1. Set to 0 to only check the KVS once, before
+ * waiting. Only used when @c DYAD_NOTIFY_ENV is @c "event".
+ */
+#define DYAD_NOTIFY_TIMEOUT_ENV "DYAD_NOTIFY_TIMEOUT"
+
+/**
+ * @brief Size in bytes of each slot of the receive ring of a UCX consumer.
+ *
+ * @details
+ * Unset defaults to 16 MiB, rounded up to a multiple of 64 bytes.
+ * Producers put every message into the ring of the consumer as chunks of
+ * at most this size, so that messages of any size can be received.
+ */
+#define DYAD_UCX_SLOT_SIZE_ENV "DYAD_UCX_SLOT_SIZE"
+
+/**
+ * @brief Number of slots of the receive ring of a UCX consumer.
+ *
+ * @details
+ * Unset defaults to 4, and at most 64 slots are used. This many chunks of
+ * a message can be in flight before the producer waits for the consumer
+ * to release a slot.
+ */
+#define DYAD_UCX_SLOTS_ENV "DYAD_UCX_SLOTS"
+
+/**
+ * @brief Maximum number of UCX endpoints a producer keeps open to its
+ *        consumers.
+ *
+ * @details
+ * Unset defaults to 256. Once as many are open, the endpoint of the least
+ * recently served consumer is closed to make room for a new one. The
+ * module option @c -n sets it as well.
+ */
+#define DYAD_UCX_EP_CACHE_SIZE_ENV "DYAD_UCX_EP_CACHE_SIZE"
+
+/**
+ * @brief Number of UCX workers from which the DYAD Flux module's fetch
+ *        workers send files concurrently.
+ *
+ * @details
+ * 0 or unset sends every file from the reactor thread, one consumer at a
+ * time. Needs a fetch worker pool (@c DYAD_MOD_WORKERS) and the @c UCX
+ * DTL, and is ignored otherwise. Can be overridden with the module's
+ * @c -x option.
+ */
+#define DYAD_MOD_UCX_WORKERS_ENV "DYAD_MOD_UCX_WORKERS"
+
 #endif  // DYAD_COMMON_DYAD_ENVS_H
@@ -0,0 +1,82 @@
+/**
+ * @file dyad_stats.h
+ * @brief Latency histograms recorded by the DYAD client and module.
+ *
+ * @details
+ * Every process using DYAD keeps one histogram per phase of a transfer.
+ * The client records the phases of consumers and the module those of the
+ * producer's broker, so each side only fills its own phases. Latencies are
+ * counted in power-of-two buckets of nanoseconds, which is enough to tell
+ * the median from the tail without any per-sample storage.
+ *
+ * Recording is always compiled in and costs two clock reads and a few
+ * atomic increments per phase. It can be turned off with
+ * @c DYAD_STATS=0.
+ */
+
+#ifndef DYAD_COMMON_DYAD_STATS_H
+#define DYAD_COMMON_DYAD_STATS_H
+
+#if defined(DYAD_HAS_CONFIG)
+#include <dyad/dyad_config.hpp>
+#else
+#error "no config"
+#endif
+
+#ifdef __cplusplus
+#include <cstdint>
+
+extern "C" {
+#else
+#include <stdint.h>
+#endif
+
+/**
+ * @brief Phases of a transfer with a latency histogram.
+ */
+enum dyad_stats_phase {
+    DYAD_STATS_KVS_LOOKUP = 0,  ///< Client: metadata lookup in the KVS.
+    DYAD_STATS_RPC_SETUP = 1,   ///< Client: fetch RPC until the DTL connection is up.
+    DYAD_STATS_DTL_RECV = 2,    ///< Client: one DTL receive.
+    DYAD_STATS_CONS_STORE = 3,  ///< Client: one write of fetched data to the file.
+    DYAD_STATS_LOCK_WAIT = 4,   ///< Client: wait for an exclusive file lock.
+    DYAD_STATS_MOD_QUEUE = 5,   ///< Module: wait of a fetch for a worker thread.
+    DYAD_STATS_MOD_READ = 6,    ///< Module: one read of a requested file.
+    DYAD_STATS_MOD_SEND = 7,    ///< Module: one DTL send.
+    DYAD_STATS_NUM_PHASES = 8
+};
+typedef enum dyad_stats_phase dyad_stats_phase_t;
+
+/**
+ * @brief Number of buckets of a histogram. The last one also counts every
+ *        latency above its lower bound, about 9 minutes.
+ */
+#define DYAD_STATS_NUM_BUCKETS 40
+
+/**
+ * @brief Latency histogram of one phase.
+ */
+typedef struct dyad_stats_hist {
+    uint64_t count;     ///< Number of samples.
+    uint64_t total_ns;  ///< Sum of the samples.
+    uint64_t max_ns;    ///< Largest sample.
+    /**
+     * @c buckets[i] counts the samples in [2^i, 2^(i+1)) nanoseconds.
+     * @c buckets[0] also counts samples of 0.
+     */
+    uint64_t buckets[DYAD_STATS_NUM_BUCKETS];
+} dyad_stats_hist_t;
+
+/**
+ * @brief Snapshot of the histograms of every phase, indexed by
+ *        @c dyad_stats_phase_t.
+ */
+typedef struct dyad_stats {
+    dyad_stats_hist_t phases[DYAD_STATS_NUM_PHASES];
+} dyad_stats_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // DYAD_COMMON_DYAD_STATS_H
@@ -48,6 +48,30 @@ DYAD_DLL_EXPORTED dyad_ctx_t *dyad_ctx_get (void);
  */
 DYAD_DLL_EXPORTED void dyad_ctx_init (dyad_dtl_comm_mode_t dtl_comm_mode, void *flux_handle);
 
+/**
+ * @brief Returns the DYAD context of the calling thread, initializing one
+ *        from environment variables if the thread does not have one yet.
+ *
+ * @details
+ * Contexts are thread-local, and every operation uses per-transfer state
+ * of its context, i.e., its Flux handle and DTL handle. Threads consuming
+ * or producing files concurrently must therefore each use their own
+ * context. This function gives the calling thread one with
+ * @c dyad_ctx_init(), with its own Flux handle, and finalizes it when the
+ * thread exits. The latency histograms are shared by the whole process,
+ * so only @c dyad_finalize() writes their summary (@c DYAD_STATS_DUMP).
+ *
+ * Called by the GOTCHA wrapper for the threads other than the one that
+ * loaded it.
+ *
+ * @param[in] dtl_comm_mode  Communication mode for the data transport layer.
+ *
+ * @return The context of the calling thread, or @c NULL if it could not be
+ *         allocated. As with @c dyad_ctx_init(), a context that failed to
+ *         initialize is left inert, with @c initialized set to @c false.
+ */
+DYAD_DLL_EXPORTED dyad_ctx_t *dyad_ctx_attach (dyad_dtl_comm_mode_t dtl_comm_mode);
+
 /**
  * @brief Tears down the DYAD context at the wrapper or library level.
  *
@@ -61,6 +61,35 @@ class DyadCtxWrapper(ctypes.Structure):
         ("prod_managed_path", ctypes.c_char_p),
         ("cons_managed_path", ctypes.c_char_p),
         ("relative_to_managed_path", ctypes.c_bool),
+        ("transfer_chunk_size", ctypes.c_size_t),
+        ("coalesce_path", ctypes.c_char_p),
+        ("compression", ctypes.c_int),
+        ("compression_threshold", ctypes.c_size_t),
+        ("io_engine", ctypes.c_int),
+        ("mdata_cache", ctypes.c_void_p),
+        ("mdata_cache_size", ctypes.c_size_t),
+        ("mdata_cache_ttl", ctypes.c_double),
+        ("mdata_cache_neg_ttl", ctypes.c_double),
+        ("stripe_threshold", ctypes.c_size_t),
+        ("stripe_count", ctypes.c_uint),
+        ("publish_txn", ctypes.c_void_p),
+        ("publish_pending", ctypes.c_uint),
+        ("publish_pending_bytes", ctypes.c_size_t),
+        ("publish_since", ctypes.c_double),
+        ("publish_batch_count", ctypes.c_uint),
+        ("publish_batch_bytes", ctypes.c_size_t),
+        ("publish_batch_timeout", ctypes.c_double),
+        ("publish_checksum", ctypes.c_bool),
+        ("mdata_legacy", ctypes.c_bool),
+        ("store_threads", ctypes.c_uint),
+        ("store_direct", ctypes.c_bool),
+        ("notify_events", ctypes.c_bool),
+        ("notify_timeout", ctypes.c_double),
+        ("notify_buf", ctypes.c_void_p),
+        ("notify_len", ctypes.c_size_t),
+        ("ucx_slot_size", ctypes.c_size_t),
+        ("ucx_slots", ctypes.c_uint),
+        ("ucx_ep_cache_size", ctypes.c_size_t),
     ]
 
 
@@ -68,6 +97,11 @@ class DyadMetadataWrapper(ctypes.Structure):
     _fields_ = [
         ("fpath", ctypes.c_char_p),
         ("owner_rank", ctypes.c_uint32),
+        ("flags", ctypes.c_uint32),
+        ("file_size", ctypes.c_uint64),
+        ("mtime_ns", ctypes.c_int64),
+        ("checksum", ctypes.c_uint64),
+        ("block_size", ctypes.c_uint64),
     ]
 
 
@@ -118,8 +152,19 @@ class Dyad:
         self.dyad_init = None
         self.dyad_init_env = None
         self.dyad_produce = None
+        self.dyad_produce_batch = None
+        self.dyad_flush = None
         self.dyad_consume = None
         self.dyad_consume_w_metadata = None
+        self.dyad_consume_batch = None
+        self.dyad_consume_range = None
+        self.dyad_consume_to_buffer = None
+        self.dyad_release_buffer = None
+        self.dyad_consume_async = None
+        self.dyad_test = None
+        self.dyad_wait = None
+        self.dyad_wait_any = None
+        self.dyad_get_metadata_batch = None
         self.dyad_finalize = None
         dyad_client_lib_file = None
         dyad_ctx_lib_file = None
@@ -186,6 +231,20 @@ class Dyad:
         ]
         self.dyad_produce.restype = ctypes.c_int
 
+        self.dyad_produce_batch = self.dyad_client_lib.dyad_produce_batch
+        self.dyad_produce_batch.argtypes = [
+            ctypes.POINTER(DyadCtxWrapper),
+            ctypes.POINTER(ctypes.c_char_p),
+            ctypes.c_size_t,
+        ]
+        self.dyad_produce_batch.restype = ctypes.c_int
+
+        self.dyad_flush = self.dyad_client_lib.dyad_flush
+        self.dyad_flush.argtypes = [
+            ctypes.POINTER(DyadCtxWrapper),
+        ]
+        self.dyad_flush.restype = ctypes.c_int
+
         self.dyad_get_metadata = self.dyad_client_lib.dyad_get_metadata
         self.dyad_get_metadata.argtypes = [
             ctypes.POINTER(DyadCtxWrapper),
@@ -195,6 +254,16 @@ class Dyad:
         ]
         self.dyad_get_metadata.restype = ctypes.c_int
 
+        self.dyad_get_metadata_batch = self.dyad_client_lib.dyad_get_metadata_batch
+        self.dyad_get_metadata_batch.argtypes = [
+            ctypes.POINTER(DyadCtxWrapper),
+            ctypes.POINTER(ctypes.c_char_p),
+            ctypes.c_size_t,
+            ctypes.c_bool,
+            ctypes.POINTER(ctypes.POINTER(DyadMetadataWrapper)),
+        ]
+        self.dyad_get_metadata_batch.restype = ctypes.c_int
+
         self.dyad_free_metadata = self.dyad_client_lib.dyad_free_metadata
         self.dyad_free_metadata.argtypes = [
             ctypes.POINTER(ctypes.POINTER(DyadMetadataWrapper))
@@ -216,6 +285,68 @@ class Dyad:
         ]
         self.dyad_consume_w_metadata.restype = ctypes.c_int
 
+        self.dyad_consume_batch = self.dyad_client_lib.dyad_consume_batch
+        self.dyad_consume_batch.argtypes = [
+            ctypes.POINTER(DyadCtxWrapper),
+            ctypes.POINTER(ctypes.c_char_p),
+            ctypes.c_size_t,
+        ]
+        self.dyad_consume_batch.restype = ctypes.c_int
+
+        self.dyad_consume_range = self.dyad_client_lib.dyad_consume_range
+        self.dyad_consume_range.argtypes = [
+            ctypes.POINTER(DyadCtxWrapper),
+            ctypes.c_char_p,
+            ctypes.c_size_t,
+            ctypes.c_size_t,
+        ]
+        self.dyad_consume_range.restype = ctypes.c_int
+
+        self.dyad_consume_to_buffer = self.dyad_client_lib.dyad_consume_to_buffer
+        self.dyad_consume_to_buffer.argtypes = [
+            ctypes.POINTER(DyadCtxWrapper),
+            ctypes.c_char_p,
+            ctypes.POINTER(ctypes.c_void_p),
+            ctypes.POINTER(ctypes.c_size_t),
+        ]
+        self.dyad_consume_to_buffer.restype = ctypes.c_int
+
+        self.dyad_release_buffer = self.dyad_client_lib.dyad_release_buffer
+        self.dyad_release_buffer.argtypes = [
+            ctypes.POINTER(DyadCtxWrapper),
+            ctypes.POINTER(ctypes.c_void_p),
+        ]
+        self.dyad_release_buffer.restype = ctypes.c_int
+
+        self.dyad_consume_async = self.dyad_client_lib.dyad_consume_async
+        self.dyad_consume_async.argtypes = [
+            ctypes.POINTER(DyadCtxWrapper),
+            ctypes.c_char_p,
+            ctypes.POINTER(ctypes.c_void_p),
+        ]
+        self.dyad_consume_async.restype = ctypes.c_int
+
+        self.dyad_test = self.dyad_client_lib.dyad_test
+        self.dyad_test.argtypes = [
+            ctypes.POINTER(ctypes.c_void_p),
+            ctypes.POINTER(ctypes.c_bool),
+        ]
+        self.dyad_test.restype = ctypes.c_int
+
+        self.dyad_wait = self.dyad_client_lib.dyad_wait
+        self.dyad_wait.argtypes = [
+            ctypes.POINTER(ctypes.c_void_p),
+        ]
+        self.dyad_wait.restype = ctypes.c_int
+
+        self.dyad_wait_any = self.dyad_client_lib.dyad_wait_any
+        self.dyad_wait_any.argtypes = [
+            ctypes.POINTER(ctypes.c_void_p),
+            ctypes.c_size_t,
+            ctypes.POINTER(ctypes.c_size_t),
+        ]
+        self.dyad_wait_any.restype = ctypes.c_int
+
         self.dyad_finalize = self.dyad_ctx_lib.dyad_finalize
         self.dyad_finalize.argtypes = []
         self.dyad_finalize.restype = ctypes.c_int
@@ -343,6 +474,31 @@ class Dyad:
         if int(res) != 0:
             raise RuntimeError("Cannot produce data with DYAD!")
 
+    @dft_log.log
+    def produce_batch(self, fnames):
+        if self.dyad_produce_batch is None:
+            warnings.warn(
+                "Trying to produce a batch with DYAD when libdyad_client.so was not found",
+                RuntimeWarning,
+            )
+            return
+        c_fnames = (ctypes.c_char_p * len(fnames))(*[f.encode() for f in fnames])
+        res = self.dyad_produce_batch(self.ctx, c_fnames, len(fnames))
+        if int(res) != 0:
+            raise RuntimeError("Cannot produce a batch of data with DYAD!")
+
+    @dft_log.log
+    def flush(self):
+        if self.dyad_flush is None:
+            warnings.warn(
+                "Trying to flush with DYAD when libdyad_client.so was not found",
+                RuntimeWarning,
+            )
+            return
+        res = self.dyad_flush(self.ctx)
+        if int(res) != 0:
+            raise RuntimeError("Cannot flush published data with DYAD!")
+
     @dft_log.log
     def get_metadata(self, fname, should_wait=False, raw=False):
         if self.dyad_get_metadata is None:
@@ -361,6 +517,25 @@ class Dyad:
             return DyadMetadata(mdata, self)
         return mdata
 
+    @dft_log.log
+    def get_metadata_batch(self, fnames, should_wait=False, raw=False):
+        if self.dyad_get_metadata_batch is None:
+            warnings.warn(
+                "Trying to get metadata for files with DYAD when libdyad_client.so was not found",
+                RuntimeWarning,
+            )
+            return [None] * len(fnames)
+        c_fnames = (ctypes.c_char_p * len(fnames))(*[f.encode() for f in fnames])
+        c_mdata = (ctypes.POINTER(DyadMetadataWrapper) * len(fnames))()
+        self.dyad_get_metadata_batch(
+            self.ctx, c_fnames, len(fnames), should_wait, c_mdata
+        )
+        # Files whose metadata could not be retrieved are left NULL
+        mdata = [m if m else None for m in c_mdata]
+        if not raw:
+            return [DyadMetadata(m, self) if m is not None else None for m in mdata]
+        return mdata
+
     @dft_log.log
     def free_metadata(self, metadata_wrapper):
         if self.dyad_free_metadata is None:
@@ -400,6 +575,110 @@ class Dyad:
         if int(res) != 0:
             raise RuntimeError("Cannot consume data with metadata with DYAD!")
 
+    @dft_log.log
+    def consume_batch(self, fnames):
+        if self.dyad_consume_batch is None:
+            warnings.warn(
+                "Trying to consume a batch with DYAD when libdyad_client.so was not found",
+                RuntimeWarning,
+            )
+            return
+        c_fnames = (ctypes.c_char_p * len(fnames))(*[f.encode() for f in fnames])
+        res = self.dyad_consume_batch(self.ctx, c_fnames, len(fnames))
+        if int(res) != 0:
+            raise RuntimeError("Cannot consume a batch of data with DYAD!")
+
+    @dft_log.log
+    def consume_range(self, fname, offset, length=0):
+        if self.dyad_consume_range is None:
+            warnings.warn(
+                "Trying to consume a byte range with DYAD when libdyad_client.so was not found",
+                RuntimeWarning,
+            )
+            return
+        res = self.dyad_consume_range(
+            self.ctx, fname.encode(), ctypes.c_size_t(offset), ctypes.c_size_t(length)
+        )
+        if int(res) != 0:
+            raise RuntimeError("Cannot consume a byte range of data with DYAD!")
+
+    @dft_log.log
+    def consume_to_buffer(self, fname):
+        if self.dyad_consume_to_buffer is None:
+            warnings.warn(
+                "Trying to consume into memory with DYAD when libdyad_client.so was not found",
+                RuntimeWarning,
+            )
+            return None
+        buf = ctypes.c_void_p()
+        length = ctypes.c_size_t(0)
+        res = self.dyad_consume_to_buffer(
+            self.ctx, fname.encode(), ctypes.byref(buf), ctypes.byref(length)
+        )
+        if int(res) != 0:
+            raise RuntimeError("Cannot consume data into memory with DYAD!")
+        try:
+            return ctypes.string_at(buf, length.value) if buf.value else b""
+        finally:
+            self.dyad_release_buffer(self.ctx, ctypes.byref(buf))
+
+    @dft_log.log
+    def consume_async(self, fname):
+        if self.dyad_consume_async is None:
+            warnings.warn(
+                "Trying to start an async consume with DYAD when libdyad_client.so was not found",
+                RuntimeWarning,
+            )
+            return None
+        req = ctypes.c_void_p()
+        res = self.dyad_consume_async(self.ctx, fname.encode(), ctypes.byref(req))
+        if int(res) != 0:
+            raise RuntimeError("Cannot start consuming data with DYAD!")
+        return req
+
+    @dft_log.log
+    def test(self, req):
+        if self.dyad_test is None:
+            warnings.warn(
+                "Trying to test an async consume with DYAD when libdyad_client.so was not found",
+                RuntimeWarning,
+            )
+            return True
+        done = ctypes.c_bool(False)
+        res = self.dyad_test(ctypes.byref(req), ctypes.byref(done))
+        if int(res) != 0:
+            raise RuntimeError("Cannot consume data asynchronously with DYAD!")
+        return done.value
+
+    @dft_log.log
+    def wait(self, req):
+        if self.dyad_wait is None:
+            warnings.warn(
+                "Trying to wait for async consumes with DYAD when libdyad_client.so was not found",
+                RuntimeWarning,
+            )
+            return
+        res = self.dyad_wait(ctypes.byref(req))
+        if int(res) != 0:
+            raise RuntimeError("Cannot consume data asynchronously with DYAD!")
+
+    @dft_log.log
+    def wait_any(self, reqs):
+        if self.dyad_wait_any is None:
+            warnings.warn(
+                "Trying to wait for async consumes with DYAD when libdyad_client.so was not found",
+                RuntimeWarning,
+            )
+            return len(reqs)
+        c_reqs = (ctypes.c_void_p * len(reqs))(*[r.value for r in reqs])
+        index = ctypes.c_size_t(0)
+        res = self.dyad_wait_any(c_reqs, len(reqs), ctypes.byref(index))
+        if index.value < len(reqs):
+            reqs[index.value].value = None
+        if int(res) != 0:
+            raise RuntimeError("Cannot consume data asynchronously with DYAD!")
+        return index.value
+
     @dft_log.log
     def finalize(self):
         if not self.initialized:
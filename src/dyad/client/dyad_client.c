@@ -4,19 +4,36 @@
 #error "no config"
 #endif
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif  // _GNU_SOURCE
+
 // clang-format off
 #include <dyad/common/dyad_dtl.h>
 #include <dyad/common/dyad_envs.h>
 #include <dyad/common/dyad_logging.h>
 #include <dyad/common/dyad_profiler.h>
 #include <dyad/client/dyad_client_int.h>
+#include <dyad/core/dyad_ctx.h>
 #include <dyad/dtl/dyad_dtl_api.h>
+#include <dyad/utils/codec.h>
+#include <dyad/utils/io_engine.h>
+#include <dyad/utils/mdata_cache.h>
+#include <dyad/utils/mdata_record.h>
 #include <dyad/utils/murmur3.h>
+#include <dyad/utils/stats.h>
+#include <dyad/utils/store_engine.h>
+#include <dyad/utils/timer.h>
 #include <dyad/utils/utils.h>
+#include <dyad/utils/worker_pool.h>
 #include <fcntl.h>
 #include <flux/core.h>
+#include <inttypes.h>
 #include <libgen.h>
 #include <stdlib.h>
+#include <sys/stat.h>
+#include <sys/xattr.h>
+#include <time.h>
 #include <unistd.h>
 // clang-format on
 
@@ -126,6 +143,150 @@ DYAD_DLL_EXPORTED int gen_path_key (const char *restrict str,
     return 0;
 }
 
+/**
+ * @brief Returns the time of a monotonic clock in seconds, used to age the
+ *        publication batch.
+ */
+static inline double dyad_monotonic_time (void)
+{
+    struct timespec ts;
+    if (clock_gettime (CLOCK_MONOTONIC, &ts) != 0) {
+        return 0.0;
+    }
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Size of the buffer holding a topic built by @c dyad_notify_topic().
+ */
+#define DYAD_NOTIFY_TOPIC_LEN 32ul
+
+/**
+ * @brief Writes to @p topic the Flux event topic on which the publication
+ *        of @p upath is announced.
+ *
+ * @details
+ * The topic appends to @c DYAD_NOTIFY_TOPIC_PREFIX the first-level bin of
+ * the KVS key of @p upath (see @c gen_path_key()) and a dot, so that no
+ * topic is a prefix of another, as Flux matches subscriptions by prefix.
+ * Without key bins (@c DYAD_KEY_DEPTH of 0), all files share the prefix.
+ *
+ * @param[in]  ctx    Pointer to the DYAD context. Must not be @c NULL.
+ * @param[in]  upath  Path to the file relative to the managed directory.
+ * @param[out] topic  Buffer of at least @c DYAD_NOTIFY_TOPIC_LEN bytes.
+ */
+DYAD_CORE_FUNC_MODS void dyad_notify_topic (const dyad_ctx_t *restrict ctx,
+                                            const char *restrict upath,
+                                            char *restrict topic)
+{
+    char key[PATH_MAX + 1] = {'\0'};
+    const char *dot = NULL;
+
+    snprintf (topic, DYAD_NOTIFY_TOPIC_LEN, "%s", DYAD_NOTIFY_TOPIC_PREFIX);
+    if (ctx->key_depth == 0u || gen_path_key (upath, key, PATH_MAX, 1u, ctx->key_bins) != 0
+        || (dot = strchr (key, '.')) == NULL) {
+        return;
+    }
+    snprintf (topic,
+              DYAD_NOTIFY_TOPIC_LEN,
+              "%s%.*s",
+              DYAD_NOTIFY_TOPIC_PREFIX,
+              (int)(dot - key + 1),
+              key);
+}
+
+/**
+ * @brief Queues the event announcing @p upath, to be sent by
+ *        @c dyad_notify_publish() once the batch holding it is committed.
+ *
+ * @details
+ * Notifications are best effort, as consumers fall back to the KVS, so a
+ * failure to queue the event is only logged.
+ */
+DYAD_CORE_FUNC_MODS void dyad_notify_add (dyad_ctx_t *restrict ctx,
+                                          const char *restrict upath,
+                                          const dyad_mdata_record_t *restrict record)
+{
+    const size_t upath_len = strlen (upath) + 1ul;
+    char *buf = (char *)realloc (ctx->notify_buf,
+                                 ctx->notify_len + DYAD_MDATA_RECORD_SIZE + upath_len);
+    if (buf == NULL) {
+        DYAD_LOG_ERROR (ctx, "DYAD CLIENT: Cannot queue the notification of %s", upath);
+        return;
+    }
+    dyad_mdata_record_encode (record, buf + ctx->notify_len);
+    memcpy (buf + ctx->notify_len + DYAD_MDATA_RECORD_SIZE, upath, upath_len);
+    ctx->notify_buf = buf;
+    ctx->notify_len += DYAD_MDATA_RECORD_SIZE + upath_len;
+}
+
+/**
+ * @brief Files taken out of the publication batch of a context by
+ *        @c dyad_publish_take(), to be committed without its lock.
+ */
+typedef struct dyad_publish_batch {
+    flux_kvs_txn_t *txn;  ///< Transaction of the files, or NULL if none
+    unsigned pending;     ///< Number of files in @c txn
+    char *notify_buf;     ///< Events queued by @c dyad_notify_add()
+    size_t notify_len;    ///< Number of bytes in @c notify_buf
+} dyad_publish_batch_t;
+
+/**
+ * @brief Sends the events of @p batch on @p h and empties its queue.
+ *
+ * @details
+ * Each file is announced with its own event on the topic of its bin, with
+ * the entry queued for it as payload. The events are sent before any reply
+ * is awaited, so that a batch costs a single round trip to the broker.
+ *
+ * @param[in] ctx    Pointer to the DYAD context. Must not be @c NULL.
+ * @param[in] h      Flux handle on which the batch was committed.
+ * @param[in] batch  Batch taken by @c dyad_publish_take().
+ * @param[in] send   Whether to send the events, or only drop them, e.g.,
+ *                   because the commit of the batch failed.
+ */
+DYAD_CORE_FUNC_MODS void dyad_notify_publish (const dyad_ctx_t *restrict ctx,
+                                              flux_t *restrict h,
+                                              dyad_publish_batch_t *restrict batch,
+                                              bool send)
+{
+    char topic[DYAD_NOTIFY_TOPIC_LEN] = {'\0'};
+    flux_future_t **f = NULL;
+    const char *entry = batch->notify_buf;
+    const char *end = entry + batch->notify_len;
+    size_t entry_len = 0ul;
+    size_t n = 0ul;
+    size_t i = 0ul;
+
+    if (send && batch->notify_len > 0ul) {
+        f = (flux_future_t **)calloc (batch->pending, sizeof (flux_future_t *));
+    }
+    for (; f != NULL && entry < end && n < batch->pending; entry += entry_len) {
+        entry_len = DYAD_MDATA_RECORD_SIZE + strlen (entry + DYAD_MDATA_RECORD_SIZE) + 1ul;
+        dyad_notify_topic (ctx, entry + DYAD_MDATA_RECORD_SIZE, topic);
+        f[n++] = flux_event_publish_raw (h, topic, 0, entry, (int)entry_len);
+    }
+    for (i = 0ul; i < n; i++) {
+        if (f[i] == NULL || flux_future_get (f[i], NULL) < 0) {
+            DYAD_LOG_ERROR_ON (h, "DYAD CLIENT: Could not send a publication event");
+        }
+        flux_future_destroy (f[i]);
+    }
+    free (f);
+    free (batch->notify_buf);
+    batch->notify_buf = NULL;
+    batch->notify_len = 0ul;
+}
+
+/**
+ * @brief Events of a batch committed asynchronously, announced by
+ *        @c future_cleanup_cb() once the commit completes.
+ */
+typedef struct dyad_publish_notice {
+    const dyad_ctx_t *ctx;       ///< Context that committed the batch
+    dyad_publish_batch_t batch;  ///< Events of the batch, without its transaction
+} dyad_publish_notice_t;
+
 /**
  * @brief Callback to clean up a Flux future after an asynchronous KVS commit completes.
  *
@@ -137,15 +298,26 @@ DYAD_DLL_EXPORTED int gen_path_key (const char *restrict str,
  *
  * If the future completed with an error, logs a message to stderr before
  * destroying the future. The error is not propagated since there is no caller
- * context to return to at callback invocation time.
+ * context to return to at callback invocation time. The events of the batch,
+ * if any, are sent with @c dyad_notify_publish() only now, so that no consumer
+ * is told of a file whose record is not in the KVS yet, and dropped if the
+ * commit failed.
  *
  * @param[in] f    Pointer to the fulfilled Flux future. Destroyed before returning.
- * @param[in] arg  Unused. Reserved for future use.
+ * @param[in] arg  A @c dyad_publish_notice_t, freed before returning, or @c NULL.
  */
 static void future_cleanup_cb (flux_future_t *f, void *arg)
 {
+    dyad_publish_notice_t *notice = (dyad_publish_notice_t *)arg;
+    bool committed = true;
+
     if (flux_future_get (f, NULL) < 0) {
         DYAD_LOG_STDERR ("future_cleanup: future error detected with.%s", "");
+        committed = false;
+    }
+    if (notice != NULL) {
+        dyad_notify_publish (notice->ctx, (flux_t *)notice->ctx->h, &notice->batch, committed);
+        free (notice);
     }
     flux_future_destroy (f);
 }
@@ -165,9 +337,11 @@ static void future_cleanup_cb (flux_future_t *f, void *arg)
  *   @c future_cleanup_cb via @c flux_future_then() and returns immediately
  *   without waiting for the commit to complete. The future is destroyed by
  *   the callback when the commit eventually completes. The caller cannot
- *   assume the metadata is visible to consumers upon return.
+ *   assume the metadata is visible to consumers upon return. The events
+ *   queued in @p batch are moved to the callback, which sends them once the
+ *   commit completed, leaving @p batch without any.
  *
- * This function is an internal helper called by @c publish_via_flux() and
+ * This function is an internal helper called by @c dyad_publish_flush() and
  * is not intended to be called directly by users.
  *
  * @param[in] ctx  Pointer to the DYAD context. Must not be @c NULL. Provides
@@ -175,6 +349,8 @@ static void future_cleanup_cb (flux_future_t *f, void *arg)
  * @param[in] txn  Pointer to the Flux KVS transaction to commit. Must not be
  *                 @c NULL. The caller retains ownership and is responsible for
  *                 destroying @p txn after this function returns.
+ * @param[in,out] batch  Batch holding @p txn, whose events are to be sent
+ *                       once it is committed, or @c NULL.
  *
  * @return @c dyad_rc_t return code indicating the outcome:
  * @retval DYAD_RC_OK        The transaction was successfully submitted, and in
@@ -183,15 +359,16 @@ static void future_cleanup_cb (flux_future_t *f, void *arg)
  *                           the transaction.
  *
  * @note In asynchronous mode, a failure to register @c future_cleanup_cb via
- *       @c flux_future_then() is logged but does not affect the return code.
- *       The commit may still complete, but the future may not be properly
- *       cleaned up.
+ *       @c flux_future_then() is logged and the commit is waited for
+ *       instead, so that the events of @p batch are still sent after it.
  */
 DYAD_CORE_FUNC_MODS dyad_rc_t dyad_kvs_commit (const dyad_ctx_t *restrict ctx,
-                                               flux_kvs_txn_t *restrict txn)
+                                               flux_kvs_txn_t *restrict txn,
+                                               dyad_publish_batch_t *restrict batch)
 {
     DYAD_C_FUNCTION_START ();
     flux_future_t *f = NULL;
+    dyad_publish_notice_t *notice = NULL;
     dyad_rc_t rc = DYAD_RC_OK;
     // Commit the transaction to the Flux KVS
     f = flux_kvs_commit ((flux_t *)ctx->h, ctx->kvs_namespace, 0, txn);
@@ -202,147 +379,380 @@ DYAD_CORE_FUNC_MODS dyad_rc_t dyad_kvs_commit (const dyad_ctx_t *restrict ctx,
         goto kvs_commit_region_finish;
     }
     if (ctx->async_publish) {
-        if (flux_future_then (f, -1, future_cleanup_cb, NULL) < 0) {
-            DYAD_LOG_ERROR (ctx, "Error with flux_future_then");
+        if (batch != NULL && batch->notify_len > 0ul) {
+            notice = (dyad_publish_notice_t *)malloc (sizeof (dyad_publish_notice_t));
+            if (notice == NULL) {
+                DYAD_LOG_ERROR (ctx, "DYAD CLIENT: Cannot defer the publication events");
+                goto kvs_commit_wait;
+            }
+            notice->ctx = ctx;
+            notice->batch = *batch;
+            notice->batch.txn = NULL;
+            batch->notify_buf = NULL;
+            batch->notify_len = 0ul;
+        }
+        if (flux_future_then (f, -1, future_cleanup_cb, notice) == 0) {
+            goto kvs_commit_region_finish;
+        }
+        DYAD_LOG_ERROR (ctx, "Error with flux_future_then");
+        if (notice != NULL) {
+            batch->notify_buf = notice->batch.notify_buf;
+            batch->notify_len = notice->batch.notify_len;
+            free (notice);
         }
-    } else {
-        // If the commit is pending, wait for it to complete
-        flux_future_wait_for (f, -1.0);
-        // Once the commit is complete, destroy the future and transaction
-        flux_future_destroy (f);
-        f = NULL;
     }
-    rc = DYAD_RC_OK;
+kvs_commit_wait:;
+    // If the commit is pending, wait for it to complete
+    if (flux_future_get (f, NULL) < 0) {
+        DYAD_LOG_ERROR (ctx, "Could not commit transaction to Flux KVS");
+        rc = DYAD_RC_BADCOMMIT;
+    }
+    // Once the commit is complete, destroy the future and transaction
+    flux_future_destroy (f);
+    f = NULL;
 kvs_commit_region_finish:;
     DYAD_C_FUNCTION_END ();
     return rc;
 }
 
 /**
- * @brief Builds and commits a Flux KVS transaction to advertise a produced file.
+ * @brief Locks the publication batch of @p ctx against its timer, if any.
+ */
+static inline void dyad_publish_lock (const dyad_ctx_t *restrict ctx)
+{
+    if (ctx->publish_timer != NULL) {
+        dyad_timer_lock ((dyad_timer_t *)ctx->publish_timer);
+    }
+}
+
+/**
+ * @brief Unlocks the publication batch of @p ctx.
+ */
+static inline void dyad_publish_unlock (const dyad_ctx_t *restrict ctx)
+{
+    if (ctx->publish_timer != NULL) {
+        dyad_timer_unlock ((dyad_timer_t *)ctx->publish_timer);
+    }
+}
+
+/**
+ * @brief Moves the publication batch of @p ctx into @p batch, leaving the
+ *        context without one. The caller holds @c dyad_publish_lock().
+ */
+static void dyad_publish_take (dyad_ctx_t *restrict ctx, dyad_publish_batch_t *restrict batch)
+{
+    batch->txn = (flux_kvs_txn_t *)ctx->publish_txn;
+    batch->pending = ctx->publish_pending;
+    batch->notify_buf = (char *)ctx->notify_buf;
+    batch->notify_len = ctx->notify_len;
+    ctx->publish_txn = NULL;
+    ctx->publish_pending = 0u;
+    ctx->publish_pending_bytes = 0ul;
+    ctx->notify_buf = NULL;
+    ctx->notify_len = 0ul;
+}
+
+/**
+ * @brief Commits the publication batch of @p ctx, if any, with
+ *        @c dyad_kvs_commit().
+ *
+ * @details
+ * The batch is emptied whether or not the commit succeeds. Once it is
+ * committed, its files are announced with @c dyad_notify_publish(). Used
+ * when the batch is full, by @c dyad_flush() and by
+ * @c dyad_produce_batch(), as well as before the consumer blocks on the
+ * KVS or on a request, so that a producer that also consumes never waits
+ * on a file it holds back itself.
+ *
+ * @param[in] ctx  Pointer to the DYAD context. Must not be @c NULL.
+ *
+ * @return @c DYAD_RC_OK if there was nothing to commit, or the return code
+ *         of @c dyad_kvs_commit().
+ */
+DYAD_CORE_FUNC_MODS dyad_rc_t dyad_publish_flush (dyad_ctx_t *restrict ctx)
+{
+    dyad_rc_t rc = DYAD_RC_OK;
+    dyad_publish_batch_t batch;
+
+    dyad_publish_lock (ctx);
+    dyad_publish_take (ctx, &batch);
+    dyad_publish_unlock (ctx);
+    if (batch.txn == NULL) {
+        return DYAD_RC_OK;
+    }
+    if (batch.pending > 0u) {
+        DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Publishing a batch of %u files", batch.pending);
+        rc = dyad_kvs_commit (ctx, batch.txn, &batch);
+        if (DYAD_IS_ERROR (rc)) {
+            DYAD_LOG_ERROR (ctx, "dyad_kvs_commit failed for %u files!", batch.pending);
+        }
+    }
+    // Announce the files only once their records are in the KVS, unless
+    // the events were left to the continuation of an asynchronous commit
+    dyad_notify_publish (ctx, (flux_t *)ctx->h, &batch, !DYAD_IS_ERROR (rc));
+    flux_kvs_txn_destroy (batch.txn);
+    return rc;
+}
+
+/**
+ * @brief Commits the publication batch of @p arg, a @c dyad_ctx_t, if it
+ *        reached @c DYAD_PUBLISH_BATCH_TIMEOUT. Run by its timer.
+ *
+ * @details
+ * The timer thread cannot share the Flux handle of the context, which is
+ * not thread-safe, so it opens its own on first use, kept in
+ * @c ctx->publish_h until the context is cleared. The commit is waited for
+ * even with @c DYAD_ASYNC_PUBLISH, as no reactor runs on this thread. If
+ * the handle cannot be opened, the batch is left to its producer.
+ */
+static void dyad_publish_expire (void *arg)
+{
+    dyad_ctx_t *ctx = (dyad_ctx_t *)arg;
+    dyad_publish_batch_t batch = {NULL, 0u, NULL, 0ul};
+    flux_future_t *f = NULL;
+    bool committed = true;
+
+    if (ctx->publish_h == NULL && (ctx->publish_h = flux_open (NULL, 0)) == NULL) {
+        DYAD_LOG_STDERR ("DYAD CLIENT: Cannot open a Flux handle for the publish timer\n");
+        return;
+    }
+    dyad_publish_lock (ctx);
+    if (ctx->publish_txn != NULL
+        && dyad_monotonic_time () - ctx->publish_since >= ctx->publish_batch_timeout) {
+        dyad_publish_take (ctx, &batch);
+    }
+    dyad_publish_unlock (ctx);
+    if (batch.txn == NULL) {
+        return;
+    }
+    if (batch.pending > 0u) {
+        DYAD_LOG_DEBUG_ON (ctx->publish_h,
+                           "DYAD CLIENT: Publishing an aged batch of %u files",
+                           batch.pending);
+        f = flux_kvs_commit ((flux_t *)ctx->publish_h, ctx->kvs_namespace, 0, batch.txn);
+        if (f == NULL || flux_future_get (f, NULL) < 0) {
+            DYAD_LOG_ERROR_ON (ctx->publish_h,
+                               "DYAD CLIENT: Could not publish an aged batch of %u files",
+                               batch.pending);
+            committed = false;
+        }
+        flux_future_destroy (f);
+    }
+    dyad_notify_publish (ctx, (flux_t *)ctx->publish_h, &batch, committed);
+    flux_kvs_txn_destroy (batch.txn);
+}
+
+/**
+ * @brief Tells whether the publication batch of @p ctx should be committed
+ *        now, because it reached one of its thresholds.
+ *
+ * @details
+ * With @c ctx->publish_batch_count of 1 or less (@c DYAD_PUBLISH_BATCH_COUNT),
+ * batching is disabled and every file is committed right away. The age is
+ * also enforced by the timer of the batch, which commits it while its
+ * producer does not publish, but is checked here for contexts without one.
+ */
+static inline bool dyad_publish_batch_full (const dyad_ctx_t *restrict ctx)
+{
+    return (ctx->publish_batch_count <= 1u) || (ctx->publish_pending >= ctx->publish_batch_count)
+           || (ctx->publish_batch_bytes > 0ul
+               && ctx->publish_pending_bytes >= ctx->publish_batch_bytes)
+           || (ctx->publish_batch_timeout > 0.0
+               && dyad_monotonic_time () - ctx->publish_since >= ctx->publish_batch_timeout);
+}
+
+/**
+ * @brief Fills in the KVS record of a produced file from its current state.
+ *
+ * @details
+ * The size and modification time are included whenever the file can be
+ * stat'ed, while the checksum is only computed with
+ * @c DYAD_PUBLISH_CHECKSUM, as it reads the whole file. A file that cannot
+ * be stat'ed is published with the owner rank alone.
+ *
+ * @param[in]  ctx     Pointer to the DYAD context. Must not be @c NULL.
+ * @param[in]  upath   Path to the file relative to the producer-managed
+ *                     directory.
+ * @param[out] record  Record to fill in.
+ */
+DYAD_CORE_FUNC_MODS void dyad_make_record (const dyad_ctx_t *restrict ctx,
+                                           const char *restrict upath,
+                                           dyad_mdata_record_t *restrict record)
+{
+    char fullpath[PATH_MAX + 1] = {'\0'};
+    struct stat st;
+    int fd = -1;
+
+    memset (record, 0, sizeof (*record));
+    record->owner_rank = ctx->rank;
+    strncpy (fullpath, ctx->prod_managed_path, PATH_MAX - 1);
+    concat_str (fullpath, upath, "/", PATH_MAX);
+    if (stat (fullpath, &st) != 0 || !S_ISREG (st.st_mode)) {
+        DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Cannot stat %s, publishing the rank only", fullpath);
+        return;
+    }
+    record->flags = DYAD_MDATA_HAS_SIZE;
+    record->file_size = (uint64_t)st.st_size;
+    record->mtime_ns = (int64_t)st.st_mtim.tv_sec * 1000000000ll + (int64_t)st.st_mtim.tv_nsec;
+    if (!ctx->publish_checksum) {
+        return;
+    }
+    fd = open (fullpath, O_RDONLY);
+    if (fd != -1
+        && dyad_mdata_checksum (fd,
+                                record->file_size,
+                                DYAD_MDATA_CHECKSUM_BLOCK,
+                                &record->checksum)
+               == 0) {
+        record->flags |= DYAD_MDATA_HAS_CHECKSUM;
+        record->block_size = DYAD_MDATA_CHECKSUM_BLOCK;
+    } else {
+        DYAD_LOG_ERROR (ctx, "DYAD CLIENT: Cannot compute the checksum of %s", fullpath);
+    }
+    if (fd != -1) {
+        close (fd);
+    }
+}
+
+/**
+ * @brief Adds a produced file to the Flux KVS transaction of the publication
+ *        batch, and commits the batch if it is full.
  *
  * @details
- * Generates a KVS key from @p upath via @c gen_path_key(), then creates and
- * commits a single-entry Flux KVS transaction that maps the key to the
- * producer's broker rank (@c ctx->rank). This rank is later retrieved by
- * consumers via @c dyad_kvs_read() to determine file locality and, if needed,
- * to identify which broker to contact for data transfer.
+ * Generates a KVS key from @p upath via @c gen_path_key(), and packs into
+ * @c ctx->publish_txn a key-value pair mapping it to the record of the file
+ * built by @c dyad_make_record(), creating the transaction if needed. The
+ * record holds the producer's broker rank (@c ctx->rank), later retrieved
+ * by consumers via @c dyad_kvs_read() to determine file locality and, if
+ * needed, to identify which broker to contact for data transfer. With
+ * @c DYAD_MDATA_LEGACY set, the rank alone is published, as a JSON integer
+ * that older consumers can read. With @c DYAD_NOTIFY set to @c "event",
+ * the record is also queued with @c dyad_notify_add() to be announced
+ * once the batch is committed.
+ *
+ * Unless @p defer is set, the batch is then committed by
+ * @c dyad_publish_flush() once it holds @c DYAD_PUBLISH_BATCH_COUNT files,
+ * exceeds @c DYAD_PUBLISH_BATCH_BYTES or is older than
+ * @c DYAD_PUBLISH_BATCH_TIMEOUT. A batch that ages while no file is added
+ * is committed by @c dyad_publish_expire() on the timer armed when the
+ * batch is created. Without batching, the file is thus committed right
+ * away. Gathering keys into one commit spares the KVS
+ * a commit per file for producers writing many small files.
  *
  * This function sits between @c dyad_commit() and @c dyad_kvs_commit() in the
  * producer publish pipeline:
  *
  * @code
  * dyad_produce()
- *     -> dyad_commit()          [resolves path, checks management, guards reenter]
- *         -> publish_via_flux() [builds and submits the KVS transaction]
- *             -> dyad_kvs_commit() [commits the transaction to the Flux KVS]
+ *     -> dyad_commit()              [resolves path, checks management, guards reenter]
+ *         -> publish_via_flux()     [adds the key to the publication batch]
+ *             -> dyad_publish_flush() [when the batch is full]
+ *                 -> dyad_kvs_commit() [commits the transaction to the Flux KVS]
  * @endcode
  *
- * The KVS transaction is destroyed before returning regardless of whether the
- * commit succeeded or failed.
- *
  * This function is an internal helper and is not intended to be called directly
  * by users.
  *
  * @param[in] ctx    Pointer to the DYAD context. Must not be @c NULL. Provides
- *                   the Flux handle, KVS namespace, producer rank, and key
- *                   generation parameters (@c key_depth and @c key_bins).
+ *                   the Flux handle, KVS namespace, producer rank, key
+ *                   generation parameters (@c key_depth and @c key_bins) and
+ *                   the publication batch.
  * @param[in] upath  Path to the file relative to the producer-managed directory.
  *                   Used to generate the KVS key. Must not be @c NULL.
+ * @param[in] defer  If @c true, leave the batch for the caller to commit.
  *
  * @return @c dyad_rc_t return code indicating the outcome:
- * @retval DYAD_RC_OK        The transaction was successfully built and committed.
+ * @retval DYAD_RC_OK        The key was added, and committed if the batch was
+ *                           full.
  * @retval DYAD_RC_FLUXFAIL  The Flux KVS transaction could not be created or packed.
  * @retval DYAD_RC_*         Any error code propagated from @c dyad_kvs_commit().
  */
-DYAD_CORE_FUNC_MODS dyad_rc_t publish_via_flux (const dyad_ctx_t *restrict ctx,
-                                                const char *restrict upath)
+DYAD_CORE_FUNC_MODS dyad_rc_t publish_via_flux (dyad_ctx_t *restrict ctx,
+                                                const char *restrict upath,
+                                                bool defer)
 {
     DYAD_C_FUNCTION_START ();
-    DYAD_C_FUNCTION_UPDATE_STR ("fname", ctx->fname);
     DYAD_C_FUNCTION_UPDATE_STR ("upath", upath);
     dyad_rc_t rc = DYAD_RC_OK;
-    flux_kvs_txn_t *txn = NULL;
     const size_t topic_len = PATH_MAX;
     char topic[PATH_MAX + 1] = {'\0'};
+    dyad_mdata_record_t record;
+    char value[DYAD_MDATA_RECORD_SIZE];
+    int packed = 0;
+    bool full = false;
     memset (topic, 0, topic_len + 1);
     memset (topic, '\0', topic_len + 1);
     // Generate the KVS key from the file path relative to
     // the producer-managed directory
     DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Generating KVS key from path (%s)", upath);
     gen_path_key (upath, topic, topic_len, ctx->key_depth, ctx->key_bins);
-    // Crete and pack a Flux KVS transaction.
-    // The transaction will contain a single key-value pair
-    // with the previously generated key as the key and the
-    // producer's rank as the value
-    DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Creating FLUX KVS transaction under the key %s", topic);
-    txn = flux_kvs_txn_create ();
-    if (txn == NULL) {
-        DYAD_LOG_ERROR (ctx, "Could not create Flux KVS transaction");
-        rc = DYAD_RC_FLUXFAIL;
-        goto publish_done;
+    // Pack into the batch a key-value pair with the previously generated
+    // key as the key and the record of the file as the value
+    DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Adding the key %s to the FLUX KVS transaction", topic);
+    if (!ctx->mdata_legacy || ctx->notify_events) {
+        dyad_make_record (ctx, upath, &record);
+    }
+    dyad_publish_lock (ctx);
+    if (ctx->publish_txn == NULL) {
+        ctx->publish_txn = flux_kvs_txn_create ();
+        if (ctx->publish_txn == NULL) {
+            dyad_publish_unlock (ctx);
+            DYAD_LOG_ERROR (ctx, "Could not create Flux KVS transaction");
+            rc = DYAD_RC_FLUXFAIL;
+            goto publish_done;
+        }
+        ctx->publish_since = dyad_monotonic_time ();
+        if (ctx->publish_timer != NULL
+            && dyad_timer_arm ((dyad_timer_t *)ctx->publish_timer,
+                               ctx->publish_batch_timeout,
+                               dyad_publish_expire,
+                               ctx)
+                   < 0) {
+            DYAD_LOG_WARN (ctx, "DYAD CLIENT: Cannot arm the publish timer");
+        }
+    }
+    if (ctx->mdata_legacy) {
+        packed = flux_kvs_txn_pack ((flux_kvs_txn_t *)ctx->publish_txn, 0, topic, "i", ctx->rank);
+    } else {
+        dyad_mdata_record_encode (&record, value);
+        packed = flux_kvs_txn_put_raw ((flux_kvs_txn_t *)ctx->publish_txn,
+                                       0,
+                                       topic,
+                                       value,
+                                       DYAD_MDATA_RECORD_SIZE);
     }
-    if (flux_kvs_txn_pack (txn, 0, topic, "i", ctx->rank) < 0) {
+    if (packed < 0) {
+        dyad_publish_unlock (ctx);
         DYAD_LOG_ERROR (ctx, "Could not pack Flux KVS transaction");
         rc = DYAD_RC_FLUXFAIL;
         goto publish_done;
     }
-    // Call dyad_kvs_commit to commit the transaction into the Flux KVS
-    rc = dyad_kvs_commit (ctx, txn);
-    // If dyad_kvs_commit failed, log an error and forward the return code
-    if (DYAD_IS_ERROR (rc)) {
-        DYAD_LOG_ERROR (ctx, "dyad_kvs_commit failed!");
-        goto publish_done;
+    ctx->publish_pending++;
+    ctx->publish_pending_bytes += strlen (topic) + DYAD_MDATA_RECORD_SIZE;
+    if (ctx->notify_events) {
+        dyad_notify_add (ctx, upath, &record);
     }
-    rc = DYAD_RC_OK;
-publish_done:;
-    if (txn != NULL) {
-        flux_kvs_txn_destroy (txn);
+    full = !defer && dyad_publish_batch_full (ctx);
+    dyad_publish_unlock (ctx);
+    // Call dyad_publish_flush to commit the batch into the Flux KVS
+    if (full) {
+        rc = dyad_publish_flush (ctx);
     }
+publish_done:;
     DYAD_C_FUNCTION_END ();
     return rc;
 }
 
 /**
- * @brief Publishes file metadata to the Flux KVS to notify consumers that a file is ready.
- *
- * @details
- * Resolves @p fname to a path relative to the producer-managed directory and
- * publishes the file's metadata to the Flux KVS via @c publish_via_flux(). This
- * signals to waiting consumers that the file has been written and is ready to
- * be read or transferred.
- *
- * If @p fname is not under the producer-managed path, the function returns
- * @c DYAD_RC_OK immediately without taking any action, so that DYAD does not
- * interfere with file operations outside its managed directories.
- *
- * This function is the internal implementation called by @c dyad_produce(). It
- * may also be called directly when finer control over the commit step is needed,
- * such as when bypassing the context validation performed by @c dyad_produce().
- *
- * @param[in]     ctx    Pointer to the DYAD context. Must not be @c NULL and must
- *                       have a valid @c prod_managed_path set. @c ctx->reenter is
- *                       temporarily set to @c false during the KVS publish to
- *                       prevent re-entrant interception.
- * @param[in]     fname  Path to the file to be published. May be an absolute path
- *                       or, if @c ctx->relative_to_managed_path is set, a path
- *                       relative to @c ctx->prod_managed_path.
- *
- * @return @c dyad_rc_t return code indicating the outcome:
- * @retval DYAD_RC_OK   The file metadata was successfully published, or @p fname
- *                      is not under the producer-managed path (no action taken).
- * @retval DYAD_RC_*    Any error code propagated from @c publish_via_flux().
- *
- * @note The caller is responsible for ensuring the file has been fully written
- *       and flushed to storage before calling this function, as consumers may
- *       begin reading the file immediately upon receiving the KVS notification.
- * @note If @c ctx->check is set and the operation succeeds, the environment
- *       variable @c DYAD_CHECK_ENV is set to @c "ok".
+ * @brief Implementation of @c dyad_commit(), which leaves the publication
+ *        batch for the caller to commit if @p defer is set.
  */
-DYAD_DLL_EXPORTED dyad_rc_t dyad_commit (dyad_ctx_t *restrict ctx, const char *restrict fname)
+DYAD_CORE_FUNC_MODS dyad_rc_t dyad_commit_path (dyad_ctx_t *restrict ctx,
+                                                const char *restrict fname,
+                                                bool defer)
 {
     DYAD_C_FUNCTION_START ();
-    DYAD_C_FUNCTION_UPDATE_STR ("fname", ctx->fname);
+    DYAD_C_FUNCTION_UPDATE_STR ("fname", fname);
     dyad_rc_t rc = DYAD_RC_OK;
     char upath[PATH_MAX + 1] = {'\0'};
 #if 0
@@ -375,8 +785,12 @@ DYAD_DLL_EXPORTED dyad_rc_t dyad_commit (dyad_ctx_t *restrict ctx, const char *r
     // Fence this call with reassignments of reenter so that, if intercepting
     // file I/O API calls, we will not get stuck in infinite recursion
     ctx->reenter = false;
-    rc = publish_via_flux (ctx, upath);
+    rc = publish_via_flux (ctx, upath, defer);
     ctx->reenter = true;
+    // Do not let this process fetch the file from its previous owner
+    if (ctx->mdata_cache != NULL) {
+        dyad_mdata_cache_invalidate ((dyad_mdata_cache_t *)ctx->mdata_cache, upath);
+    }
 
 commit_done:;
     // If "check" is set and the operation was successful, set the
@@ -388,6 +802,49 @@ commit_done:;
     return rc;
 }
 
+/**
+ * @brief Publishes file metadata to the Flux KVS to notify consumers that a file is ready.
+ *
+ * @details
+ * Resolves @p fname to a path relative to the producer-managed directory and
+ * publishes the file's metadata to the Flux KVS via @c publish_via_flux(). This
+ * signals to waiting consumers that the file has been written and is ready to
+ * be read or transferred. With @c DYAD_PUBLISH_BATCH_COUNT set, the metadata
+ * is only committed along with that of the next files, once the batch is
+ * full or flushed.
+ *
+ * If @p fname is not under the producer-managed path, the function returns
+ * @c DYAD_RC_OK immediately without taking any action, so that DYAD does not
+ * interfere with file operations outside its managed directories.
+ *
+ * This function is the internal implementation called by @c dyad_produce(). It
+ * may also be called directly when finer control over the commit step is needed,
+ * such as when bypassing the context validation performed by @c dyad_produce().
+ *
+ * @param[in]     ctx    Pointer to the DYAD context. Must not be @c NULL and must
+ *                       have a valid @c prod_managed_path set. @c ctx->reenter is
+ *                       temporarily set to @c false during the KVS publish to
+ *                       prevent re-entrant interception.
+ * @param[in]     fname  Path to the file to be published. May be an absolute path
+ *                       or, if @c ctx->relative_to_managed_path is set, a path
+ *                       relative to @c ctx->prod_managed_path.
+ *
+ * @return @c dyad_rc_t return code indicating the outcome:
+ * @retval DYAD_RC_OK   The file metadata was successfully published, or @p fname
+ *                      is not under the producer-managed path (no action taken).
+ * @retval DYAD_RC_*    Any error code propagated from @c publish_via_flux().
+ *
+ * @note The caller is responsible for ensuring the file has been fully written
+ *       and flushed to storage before calling this function, as consumers may
+ *       begin reading the file immediately upon receiving the KVS notification.
+ * @note If @c ctx->check is set and the operation succeeds, the environment
+ *       variable @c DYAD_CHECK_ENV is set to @c "ok".
+ */
+DYAD_DLL_EXPORTED dyad_rc_t dyad_commit (dyad_ctx_t *restrict ctx, const char *restrict fname)
+{
+    return dyad_commit_path (ctx, fname, false);
+}
+
 static void print_mdata (const dyad_ctx_t *restrict ctx, const dyad_metadata_t *restrict mdata)
 {
     if (mdata == NULL) {
@@ -396,685 +853,3211 @@ static void print_mdata (const dyad_ctx_t *restrict ctx, const dyad_metadata_t *
         DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Printing contents of DYAD Metadata object");
         DYAD_LOG_DEBUG (ctx, "               fpath = %s", mdata->fpath);
         DYAD_LOG_DEBUG (ctx, "               owner_rank = %u", mdata->owner_rank);
+        if (mdata->flags & DYAD_MDATA_HAS_SIZE) {
+            DYAD_LOG_DEBUG (ctx, "               file_size = %" PRIu64, mdata->file_size);
+            DYAD_LOG_DEBUG (ctx, "               mtime_ns = %" PRId64, mdata->mtime_ns);
+        }
+        if (mdata->flags & DYAD_MDATA_HAS_CHECKSUM) {
+            DYAD_LOG_DEBUG (ctx, "               checksum = %016" PRIx64, mdata->checksum);
+        }
     }
 }
 
 /**
- * @brief Looks up file metadata from the Flux KVS.
+ * @brief Allocates @c *mdata if it is @c NULL and sets its @c fpath to a
+ *        copy of @p upath, with no published field known yet.
  *
  * @details
- * Queries the Flux KVS for metadata associated with the file identified by
- * @p topic (the KVS key) and @p upath (the file path relative to the
- * consumer-managed directory). The only metadata currently stored in the KVS
- * is the producer's broker rank (@c owner_rank), which is used by the caller
- * to determine locality and, if needed, to dispatch an RPC to the correct
- * producer broker for data transfer.
- *
- * If @p should_wait is @c true, the lookup blocks using @c FLUX_KVS_WAITCREATE
- * until the producer publishes the metadata. If @p should_wait is @c false,
- * the lookup returns immediately with @c DYAD_RC_NOTFOUND if the metadata is
- * not yet available.
- *
- * If @c *mdata is already allocated on entry, the existing object is reused
- * and only @c fpath and @c owner_rank are overwritten. Otherwise a new
- * @c dyad_metadata_t object is allocated. On error, any partially allocated
- * @p mdata is freed before returning.
- *
- * @param[in]     ctx         Pointer to the DYAD context. Must not be @c NULL.
- *                            Provides the Flux handle and KVS namespace.
- * @param[in]     topic       KVS key for the file, generated from @p upath via
- *                            @c gen_path_key(). Must not be @c NULL.
- * @param[in]     upath       Path to the file relative to the consumer-managed
- *                            directory. Stored in the populated metadata object.
- *                            Must not be @c NULL.
- * @param[in]     should_wait If @c true, block until the producer publishes the
- *                            metadata to the KVS. If @c false, return immediately
- *                            if the metadata is not yet available.
- * @param[in,out] mdata       Address of a @c dyad_metadata_t pointer to be
- *                            populated. Must not be @c NULL. If @c *mdata is
- *                            already allocated, it is reused; otherwise a new
- *                            object is allocated. The caller is responsible for
- *                            freeing it via @c dyad_free_metadata() when no
- *                            longer needed.
+ * An existing @c *mdata is reused, as when @c dyad_kvs_wait_event() looks
+ * it up again, and its previous @c fpath is released.
  *
- * @return @c dyad_rc_t         return code indicating the outcome:
- * @retval DYAD_RC_OK           Metadata was successfully retrieved and @p mdata
- *                              has been populated.
- * @retval DYAD_RC_NOTFOUND     @p mdata is @c NULL, the KVS lookup failed, or
- *                              the metadata is not yet available and
- *                              @p should_wait is @c false.
- * @retval DYAD_RC_SYSFAIL      Memory allocation for the metadata object or its
- *                              @c fpath field failed.
- * @retval DYAD_RC_BADMETADATA  The KVS response could not be unpacked to extract
- *                              the producer's broker rank.
+ * @return @c DYAD_RC_OK, or @c DYAD_RC_SYSFAIL if an allocation failed.
  */
-DYAD_DLL_EXPORTED dyad_rc_t dyad_kvs_read (const dyad_ctx_t *restrict ctx,
-                                           const char *restrict topic,
-                                           const char *restrict upath,
-                                           bool should_wait,
-                                           dyad_metadata_t **restrict mdata)
+DYAD_CORE_FUNC_MODS dyad_rc_t dyad_alloc_mdata (const dyad_ctx_t *restrict ctx,
+                                                const char *restrict upath,
+                                                dyad_metadata_t **restrict mdata)
 {
-    DYAD_C_FUNCTION_START ();
-    DYAD_C_FUNCTION_UPDATE_STR ("upath", upath);
-    dyad_rc_t rc = DYAD_RC_OK;
-    int kvs_lookup_flags = 0;
-    flux_future_t *f = NULL;
-    if (mdata == NULL) {
-        DYAD_LOG_ERROR (ctx,
-                        "Metadata double pointer is NULL. "
-                        "Cannot correctly create metadata object");
-        rc = DYAD_RC_NOTFOUND;
-        goto kvs_read_end;
-    }
-    // Lookup information about the desired file (represented by kvs_topic)
-    // from the Flux KVS. If there is no information, wait for it to be
-    // made available
-    if (should_wait)
-        kvs_lookup_flags = FLUX_KVS_WAITCREATE;
-    f = flux_kvs_lookup ((flux_t *)ctx->h, ctx->kvs_namespace, kvs_lookup_flags, topic);
-    // If the KVS lookup failed, log an error and return DYAD_BADLOOKUP
-    if (f == NULL) {
-        DYAD_LOG_ERROR (ctx, "KVS lookup failed!\n");
-        rc = DYAD_RC_NOTFOUND;
-        goto kvs_read_end;
-    }
-    // Extract the rank of the producer from the KVS response
+    size_t upath_len = strlen (upath);
     if (*mdata != NULL) {
         DYAD_LOG_INFO (ctx, "Metadata object is already allocated. Skipping allocation");
+        free ((*mdata)->fpath);
+        (*mdata)->fpath = NULL;
     } else {
         *mdata = (dyad_metadata_t *)malloc (sizeof (struct dyad_metadata));
         if (*mdata == NULL) {
             DYAD_LOG_ERROR (ctx, "Cannot allocate memory for metadata object");
-            rc = DYAD_RC_SYSFAIL;
-            goto kvs_read_end;
+            return DYAD_RC_SYSFAIL;
         }
     }
-    size_t upath_len = strlen (upath);
     (*mdata)->fpath = (char *)malloc (upath_len + 1);
     if ((*mdata)->fpath == NULL) {
         DYAD_LOG_ERROR (ctx, "Cannot allocate memory for fpath in metadata object");
-        rc = DYAD_RC_SYSFAIL;
-        goto kvs_read_end;
+        return DYAD_RC_SYSFAIL;
     }
     memset ((*mdata)->fpath, '\0', upath_len + 1);
     memcpy ((*mdata)->fpath, upath, upath_len);
-    rc = flux_kvs_lookup_get_unpack (f, "i", &((*mdata)->owner_rank));
-    // If the extraction did not work, log an error and return DYAD_BADFETCH
-    if (rc < 0) {
-        DYAD_LOG_ERROR (ctx, "Could not unpack owner's rank from KVS response\n");
-        rc = DYAD_RC_BADMETADATA;
-        goto kvs_read_end;
-    }
-    DYAD_LOG_INFO (ctx, "DYAD CLIENT: Successfully retrieved metadata for key %s", topic);
-    print_mdata (ctx, *mdata);
-    DYAD_C_FUNCTION_UPDATE_STR ("fpath", (*mdata)->fpath);
-    DYAD_C_FUNCTION_UPDATE_INT ("owner_rank", (*mdata)->owner_rank);
-    rc = DYAD_RC_OK;
+    (*mdata)->flags = 0u;
+    (*mdata)->file_size = 0ull;
+    (*mdata)->mtime_ns = 0ll;
+    (*mdata)->checksum = 0ull;
+    (*mdata)->block_size = 0ull;
+    return DYAD_RC_OK;
+}
 
-kvs_read_end:;
-    if (DYAD_IS_ERROR (rc) && mdata != NULL && *mdata != NULL) {
-        dyad_free_metadata (mdata);
-    }
-    if (f != NULL) {
-        flux_future_destroy (f);
-        f = NULL;
-    }
-    DYAD_C_FUNCTION_END ();
-    return rc;
+/**
+ * @brief Copies the fields of a KVS record into @p mdata.
+ */
+static inline void dyad_mdata_from_record (dyad_metadata_t *restrict mdata,
+                                           const dyad_mdata_record_t *restrict record)
+{
+    mdata->owner_rank = record->owner_rank;
+    mdata->flags = record->flags & ~DYAD_MDATA_FROM_KVS;
+    mdata->file_size = record->file_size;
+    mdata->mtime_ns = record->mtime_ns;
+    mdata->checksum = record->checksum;
+    mdata->block_size = record->block_size;
 }
 
 /**
- * @brief Retrieves file metadata from the Flux KVS for an internal consumer operation.
+ * @brief Copies the published fields of @p mdata into a KVS record.
+ */
+static inline void dyad_mdata_to_record (const dyad_metadata_t *restrict mdata,
+                                         dyad_mdata_record_t *restrict record)
+{
+    record->owner_rank = mdata->owner_rank;
+    record->flags = mdata->flags & ~DYAD_MDATA_FROM_KVS;
+    record->file_size = mdata->file_size;
+    record->mtime_ns = mdata->mtime_ns;
+    record->checksum = mdata->checksum;
+    record->block_size = mdata->block_size;
+}
+
+/**
+ * @brief Fills in metadata from a KVS lookup of @p topic.
  *
  * @details
- * Looks up metadata for the file identified by @p upath in the Flux KVS,
- * blocking until the producer publishes it. This is the internal counterpart
- * to @c dyad_get_metadata(), used exclusively by @c dyad_consume().
- *
- * After retrieving metadata, the function determines whether a remote data
- * transfer is actually needed by checking if the producer and consumer reside
- * on the same node. This is done by comparing @c mdata->owner_rank / @c ctx->service_mux
- * against @c ctx->node_idx. If they match, the producer is on the same node and
- * the file is already locally accessible, so the metadata object is freed and
- * set to @c NULL to signal to @c dyad_consume() that the data transfer step
- * should be skipped.
+ * Shared by @c dyad_kvs_read(), which waits for the lookup, and the
+ * asynchronous consume, which calls it from the continuation of the
+ * lookup. Allocates @c *mdata if it is @c NULL. On error, @c *mdata may be
+ * partially filled and is left to the caller to free.
  *
- * Note that this locality check is only relevant for node-local storage. When
- * shared storage is enabled, @c dyad_consume() never uses the metadata for data
- * transfer regardless, so the check is not needed in that path.
+ * @param[in]     ctx    Pointer to the DYAD context. Must not be @c NULL.
+ * @param[in]     f      Future returned by @c flux_kvs_lookup().
+ * @param[in]     topic  KVS key that was looked up, for logging.
+ * @param[in]     upath  Path to the file relative to the consumer-managed
+ *                       directory, copied into @c (*mdata)->fpath.
+ * @param[in,out] mdata  Address of the metadata object to fill in.
  *
- * The @c mdata == @c NULL convention on return is therefore not an error condition
- * but a deliberate signal that the data transfer step should be skipped.
+ * The value is decoded by @c dyad_mdata_record_decode(), which also
+ * accepts the bare owner rank published by older producers.
  *
- * This function is not intended to be called directly by users.
+ * @return @c DYAD_RC_OK, @c DYAD_RC_SYSFAIL if the metadata could not be
+ *         allocated, @c DYAD_RC_NOTFOUND if the file is not published yet,
+ *         or @c DYAD_RC_BADMETADATA if the lookup failed otherwise or the
+ *         value could not be unpacked.
+ */
+DYAD_CORE_FUNC_MODS dyad_rc_t dyad_kvs_get_mdata (const dyad_ctx_t *restrict ctx,
+                                                  flux_future_t *restrict f,
+                                                  const char *restrict topic,
+                                                  const char *restrict upath,
+                                                  dyad_metadata_t **restrict mdata)
+{
+    const void *value = NULL;
+    size_t value_len = 0ul;
+    dyad_mdata_record_t record;
+    dyad_rc_t rc = dyad_alloc_mdata (ctx, upath, mdata);
+    if (DYAD_IS_ERROR (rc)) {
+        return rc;
+    }
+    // If the extraction did not work, log an error and return DYAD_BADFETCH
+    if (flux_kvs_lookup_get_raw (f, &value, &value_len) < 0) {
+        if (errno == ENOENT) {
+            DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: No metadata published for key %s", topic);
+            return DYAD_RC_NOTFOUND;
+        }
+        DYAD_LOG_ERROR (ctx, "Could not get the metadata from KVS response\n");
+        return DYAD_RC_BADMETADATA;
+    }
+    if (DYAD_IS_ERROR (dyad_mdata_record_decode (value, value_len, &record))) {
+        DYAD_LOG_ERROR (ctx, "Could not unpack the metadata of key %s\n", topic);
+        return DYAD_RC_BADMETADATA;
+    }
+    dyad_mdata_from_record (*mdata, &record);
+    (*mdata)->flags |= DYAD_MDATA_FROM_KVS;
+    DYAD_LOG_INFO (ctx, "DYAD CLIENT: Successfully retrieved metadata for key %s", topic);
+    print_mdata (ctx, *mdata);
+    return DYAD_RC_OK;
+}
+
+/**
+ * @brief Answers the metadata lookup of @p upath from the metadata cache
+ *        of @p ctx (@c DYAD_MDATA_CACHE_SIZE), if possible.
  *
- * @param[in]  ctx    Pointer to the DYAD context. Must not be @c NULL.
- * @param[in]  fname  Absolute path to the file being consumed.
- * @param[in]  upath  Path to the file relative to the consumer-managed directory.
- *                    Used to generate the Flux KVS lookup key.
- * @param[out] mdata  Address of a @c dyad_metadata_t pointer. Always set to
- *                    @c NULL on entry. On success, either points to the retrieved
- *                    metadata if a remote transfer is needed, or remains @c NULL
- *                    if the producer is on the same node and the file is already
- *                    locally accessible.
+ * @details
+ * A file cached as not published yet only answers lookups that do not
+ * wait, since a waiting lookup has to block until the file is published.
  *
- * @return @c dyad_rc_t return code indicating the outcome:
- * @retval DYAD_RC_OK   Metadata was successfully retrieved, or the producer is
- *                      on the same node and no transfer is needed (@p mdata will
- *                      be @c NULL).
- * @retval DYAD_RC_*    Any error code propagated from @c dyad_kvs_read().
+ * @param[in]     ctx          Pointer to the DYAD context. Must not be @c NULL.
+ * @param[in]     upath        Path to the file relative to the consumer-managed
+ *                             directory.
+ * @param[in]     should_wait  Whether the lookup would wait for the file.
+ * @param[in,out] mdata        Address of the metadata object to fill in, as
+ *                             for @c dyad_kvs_get_mdata().
+ * @param[out]    rc           Set if the lookup is answered: @c DYAD_RC_OK
+ *                             with @p mdata filled in, @c DYAD_RC_NOTFOUND
+ *                             for a file not published yet, or
+ *                             @c DYAD_RC_SYSFAIL.
  *
- * @note Unlike @c dyad_get_metadata(), this function always blocks until the
- *       producer publishes the file's metadata to the KVS.
- * @note The @c service_mux field in @p ctx controls how many Flux broker ranks
- *       map to a single node, and is used to determine node-level locality.
+ * @return @c true if the lookup was answered from the cache.
  */
-DYAD_CORE_FUNC_MODS dyad_rc_t dyad_fetch_metadata (const dyad_ctx_t *restrict ctx,
-                                                   const char *restrict fname,
+DYAD_CORE_FUNC_MODS bool dyad_lookup_cached_mdata (const dyad_ctx_t *restrict ctx,
                                                    const char *restrict upath,
-                                                   dyad_metadata_t **restrict mdata)
+                                                   bool should_wait,
+                                                   dyad_metadata_t **restrict mdata,
+                                                   dyad_rc_t *restrict rc)
 {
-    DYAD_C_FUNCTION_START ();
-    DYAD_C_FUNCTION_UPDATE_STR ("fname", fname);
-    dyad_rc_t rc = DYAD_RC_OK;
-    const size_t topic_len = PATH_MAX;
-    char topic[PATH_MAX + 1] = {'\0'};
-    *mdata = NULL;
-#if 0
-    if (fname == NULL || upath == NULL || strlen (fname) == 0ul || strlen (upath) == 0ul) {
-        rc = DYAD_RC_BADFIO;
-        goto get_metadata_done;
+    bool found = false;
+    dyad_mdata_record_t record;
+    if (ctx->mdata_cache == NULL
+        || dyad_mdata_cache_get ((dyad_mdata_cache_t *)ctx->mdata_cache, upath, &found, &record)
+               != DYAD_RC_OK
+        || (!found && should_wait)) {
+        return false;
     }
-#endif
-    // Set reenter to false to avoid recursively performing DYAD operations
-    DYAD_C_FUNCTION_UPDATE_STR ("upath", upath);
-    // Generate the KVS key from the file path relative to
-    // the consumer-managed directory
-    gen_path_key (upath, topic, topic_len, ctx->key_depth, ctx->key_bins);
-    DYAD_LOG_INFO (ctx, "DYAD CLIENT: Fetch metadata for: %s, key: %s.", upath, topic);
-    // Call dyad_kvs_read to retrieve infromation about the file
-    // from the Flux KVS
-    rc = dyad_kvs_read (ctx, topic, upath, true, mdata);
-    // If an error occured in dyad_kvs_read, log it and propagate the return
-    // code
-    if (DYAD_IS_ERROR (rc)) {
-        DYAD_LOG_ERROR (ctx, "DYAD CLIENT: dyad_kvs_read failed!");
-        goto fetch_done;
+    if (!found) {
+        DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: %s is cached as not published yet", upath);
+        *rc = DYAD_RC_NOTFOUND;
+        return true;
     }
-    // There are two cases where we do not want to perform file transfer:
-    //   1. if the shared storage feature is enabled
-    //   2. if the producer and consumer share the same rank
-    // In either of these cases, skip the creation of the dyad_kvs_response_t
-    // object, and return DYAD_OK. This will cause the file transfer step to be
-    // skipped
-    DYAD_C_FUNCTION_UPDATE_INT ("owner_rank", (*mdata)->owner_rank);
-    DYAD_C_FUNCTION_UPDATE_INT ("node_idx", ctx->node_idx);
-    // if (ctx->shared_storage || ((*mdata)->owner_rank / ctx->service_mux) == ctx->node_idx) {
-    if (((*mdata)->owner_rank / ctx->service_mux) == ctx->node_idx) {
-        DYAD_LOG_INFO (ctx,
-                       "Either shared-storage is indicated or the producer rank (%u) is the"
-                       " same as the consumer rank (%u)",
-                       (*mdata)->owner_rank,
-                       ctx->rank);
-        if (mdata != NULL && *mdata != NULL) {
-            dyad_free_metadata (mdata);
-        }
-        rc = DYAD_RC_OK;
-        DYAD_C_FUNCTION_UPDATE_INT ("is_local", 1);
-        goto fetch_done;
+    *rc = dyad_alloc_mdata (ctx, upath, mdata);
+    if (!DYAD_IS_ERROR (*rc)) {
+        dyad_mdata_from_record (*mdata, &record);
+        DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Found the metadata of %s in the cache", upath);
+        print_mdata (ctx, *mdata);
     }
-    DYAD_C_FUNCTION_UPDATE_INT ("is_local", 0);
-    rc = DYAD_RC_OK;
-
-fetch_done:;
-    DYAD_C_FUNCTION_END ();
-    return rc;
+    return true;
 }
 
 /**
- * @brief Retrieves file data from a remote producer's Flux broker via RPC.
+ * @brief Records the outcome of the KVS lookup of @p upath in the owner
+ *        rank cache of @p ctx.
  *
  * @details
- * Dispatches a streaming Flux RPC to the DYAD module running on the producer's
- * broker (identified by @p mdata->owner_rank) and retrieves the file data via
- * the configured Data Transport Layer (DTL). The retrieved data is returned in
- * @p file_data and its length in @p file_len.
- *
- * The sequence of operations is:
- *  1. Pack an RPC payload containing the file path and producer rank.
- *  2. Send a streaming Flux RPC to the producer's DYAD module.
- *  3. Receive and parse the RPC response.
- *  4. Establish a DTL connection to the producer.
- *  5. Receive the file data over the DTL connection.
- *  6. Close the DTL connection.
- *  7. Wait for the end-of-stream RPC message from the producer module.
- *
- * The streaming RPC protocol expects exactly one data message followed by an
- * end-of-stream signal (indicated by @c ENODATA). If additional messages arrive
- * or the module reports an error, @c DYAD_RC_BADRPC is returned. Two return
- * codes from the DTL have special meaning and bypass the end-of-stream wait:
- * @c DYAD_RC_RPC_FINISHED (end of stream already received) and
- * @c DYAD_RC_BADRPC (a prior RPC operation failed irrecoverably).
+ * Caches the record on success, and the absence of the file if the
+ * lookup did not wait and negative caching is enabled
+ * (@c DYAD_MDATA_CACHE_NEG_TTL). Caching is best effort, so failures are
+ * ignored.
+ */
+DYAD_CORE_FUNC_MODS void dyad_cache_mdata (const dyad_ctx_t *restrict ctx,
+                                           const char *restrict upath,
+                                           bool should_wait,
+                                           dyad_rc_t rc,
+                                           const dyad_metadata_t *restrict mdata)
+{
+    dyad_mdata_record_t record;
+    if (ctx->mdata_cache == NULL) {
+        return;
+    }
+    if (rc == DYAD_RC_OK) {
+        dyad_mdata_to_record (mdata, &record);
+        dyad_mdata_cache_put ((dyad_mdata_cache_t *)ctx->mdata_cache, upath, &record);
+    } else if (rc == DYAD_RC_NOTFOUND && !should_wait) {
+        dyad_mdata_cache_put_negative ((dyad_mdata_cache_t *)ctx->mdata_cache, upath);
+    }
+}
+
+/**
+ * @brief Drops @p upath from the metadata cache of @p ctx, so that its
+ *        next lookup goes to the KVS.
  *
- * When built with UCX DTL support (@c DYAD_ENABLE_UCX_DTL), the producer
- * prepends the file size to the data buffer. This prefix is extracted and
- * stripped before returning, so @p file_data always points to the raw file
- * contents.
+ * @details
+ * Called when the file is republished by this process and when a fetch
+ * from the cached owner fails, e.g., because the producer republished the
+ * file from another broker.
+ */
+DYAD_CORE_FUNC_MODS void dyad_uncache_mdata (const dyad_ctx_t *restrict ctx,
+                                             const char *restrict upath)
+{
+    if (ctx->mdata_cache != NULL) {
+        dyad_mdata_cache_invalidate ((dyad_mdata_cache_t *)ctx->mdata_cache, upath);
+    }
+}
+
+/**
+ * @brief Handles a publication event received while waiting for @p upath.
  *
- * This function is an internal helper called by @c dyad_consume() and
- * @c dyad_consume_w_metadata(). It is not intended to be called directly
- * by users.
+ * @details
+ * An event announcing another file of the bin is recorded in the metadata
+ * cache, which serves as the local table of published files, so that a
+ * later wait for that file is answered without the KVS.
  *
- * @param[in]  ctx        Pointer to the DYAD context. Must not be @c NULL.
- *                        Provides the Flux handle, DTL handle, and other
- *                        connection parameters.
- * @param[in]  mdata      Metadata for the file to retrieve. Must not be @c NULL.
- *                        @c mdata->fpath and @c mdata->owner_rank identify the
- *                        file and the producer broker to contact.
- * @param[out] file_data  Address of a pointer to be set to the buffer containing
- *                        the retrieved file data. The buffer is allocated by the
- *                        DTL layer. The caller is responsible for releasing it
- *                        via @c ctx->dtl_handle->return_buffer().
- * @param[out] file_len   Address of a @c size_t to be set to the number of bytes
- *                        in @p file_data.
+ * @param[in]  ctx     Pointer to the DYAD context. Must not be @c NULL.
+ * @param[in]  msg     Event sent by @c dyad_notify_publish().
+ * @param[in]  upath   Path to the awaited file relative to the
+ *                     consumer-managed directory.
+ * @param[out] record  Set to the record of @p upath if announced by @p msg.
  *
- * @return @c dyad_rc_t return code indicating the outcome:
- * @retval DYAD_RC_OK           File data was successfully retrieved.
- * @retval DYAD_RC_BADRPC       An RPC operation failed, the producer module sent
- *                              an unexpected number of responses, or the module
- *                              reported an error.
- * @retval DYAD_RC_BADFIO       UCX DTL only: the producer-prepended file size
- *                              was negative, indicating a read failure on the
- *                              producer side.
- * @retval DYAD_RC_*            Any error code propagated from
- *                              @c dtl_handle->rpc_pack(),
- *                              @c dtl_handle->rpc_recv_response(),
- *                              @c dtl_handle->establish_connection(), or
- *                              @c dtl_handle->recv().
+ * @return @c true if @p msg announces @p upath.
  */
-DYAD_DLL_EXPORTED dyad_rc_t dyad_get_data (const dyad_ctx_t *restrict ctx,
-                                           const dyad_metadata_t *restrict mdata,
-                                           char **restrict file_data,
-                                           size_t *restrict file_len)
+DYAD_CORE_FUNC_MODS bool dyad_notify_recv (const dyad_ctx_t *restrict ctx,
+                                           const flux_msg_t *restrict msg,
+                                           const char *restrict upath,
+                                           dyad_mdata_record_t *restrict record)
 {
-    DYAD_C_FUNCTION_START ();
-    dyad_rc_t rc = DYAD_RC_OK;
-    flux_future_t *f = NULL;
-    json_t *rpc_payload = NULL;
-    DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Packing payload for RPC to DYAD module");
-    DYAD_C_FUNCTION_UPDATE_INT ("owner_rank", mdata->owner_rank);
-    DYAD_C_FUNCTION_UPDATE_STR ("fpath", mdata->fpath);
-    rc = ctx->dtl_handle->rpc_pack (ctx, mdata->fpath, mdata->owner_rank, &rpc_payload);
-    if (DYAD_IS_ERROR (rc)) {
-        DYAD_LOG_ERROR (ctx,
-                        "Cannot create JSON payload for Flux RPC to "
-                        "DYAD module\n");
-        goto get_done;
-    }
-    DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Sending payload for RPC to DYAD module");
-    f = flux_rpc_pack ((flux_t *)ctx->h,
-                       DYAD_DTL_RPC_NAME,
-                       mdata->owner_rank,
-                       FLUX_RPC_STREAMING,
-                       "o",
-                       rpc_payload);
-    if (f == NULL) {
-        DYAD_LOG_ERROR (ctx, "Cannot send RPC to producer module.");
-        rc = DYAD_RC_BADRPC;
-        goto get_done;
-    }
-    DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Receive RPC response from DYAD module");
-    rc = ctx->dtl_handle->rpc_recv_response (ctx, f);
-    if (DYAD_IS_ERROR (rc)) {
-        DYAD_LOG_ERROR (ctx, "Cannot receive and/or parse the RPC response.");
-        goto get_done;
+    const void *payload = NULL;
+    const char *path = NULL;
+    int len = 0;
+    dyad_mdata_record_t announced;
+
+    if (flux_event_decode_raw (msg, NULL, &payload, &len) < 0
+        || len <= (int)DYAD_MDATA_RECORD_SIZE || ((const char *)payload)[len - 1] != '\0'
+        || DYAD_IS_ERROR (
+            dyad_mdata_record_decode (payload, DYAD_MDATA_RECORD_SIZE, &announced))) {
+        DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Ignoring a malformed publication event");
+        return false;
     }
-    DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Establish DTL connection with DYAD module");
-    rc = ctx->dtl_handle->establish_connection (ctx);
-    if (DYAD_IS_ERROR (rc)) {
-        DYAD_LOG_ERROR (ctx,
-                        "Cannot establish connection with DYAD module on broker "
-                        "%u.",
-                        mdata->owner_rank);
-        goto get_done;
+    path = (const char *)payload + DYAD_MDATA_RECORD_SIZE;
+    if (strcmp (path, upath) == 0) {
+        *record = announced;
+        return true;
     }
-    DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Receive file data via DTL");
-    rc = ctx->dtl_handle->recv (ctx, (void **)file_data, file_len);
-    DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Close DTL connection with DYAD module");
-    ctx->dtl_handle->close_connection (ctx);
-    if (DYAD_IS_ERROR (rc)) {
-        DYAD_LOG_ERROR (ctx, "Cannot receive data from producer module.");
-        goto get_done;
+    if (ctx->mdata_cache != NULL) {
+        dyad_mdata_cache_put ((dyad_mdata_cache_t *)ctx->mdata_cache, path, &announced);
     }
-    DYAD_C_FUNCTION_UPDATE_INT ("file_len", *file_len);
+    return false;
+}
 
-    rc = DYAD_RC_OK;
+/**
+ * @brief Number of bins a Flux handle stays subscribed to while no wait is
+ *        in progress on them.
+ */
+#define DYAD_NOTIFY_IDLE_SUBS 8u
 
-get_done:;
-    // There are two return codes that have special meaning when coming from the
-    // DTL:
-    //  * DYAD_RC_RPC_FINISHED: occurs when an ENODATA error occurs
-    //  * DYAD_RC_BADRPC: occurs when a previous RPC operation fails
-    // In either of these cases, we do not need to wait for the end of stream
-    // because the RPC is already completely messed up. If we do not have either
-    // of these cases, we will wait for one more RPC message. If everything went
-    // well in the module, this last message will set errno to ENODATA (i.e.,
-    // end of stream). Otherwise, something went wrong, so we'll return
-    // DYAD_RC_BADRPC.
-    // DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Wait for end-of-stream message from module (current RC =
-    // %d)", rc);
-    if (rc != DYAD_RC_RPC_FINISHED && rc != DYAD_RC_BADRPC) {
-        if (!(flux_rpc_get (f, NULL) < 0 && errno == ENODATA)) {
-            DYAD_LOG_ERROR (ctx,
-                            "An error occured at end of getting data! Either the "
-                            "module sent too many responses, or the module "
-                            "failed with a bad error (errno = %d).",
-                            errno);
-            rc = DYAD_RC_BADRPC;
-        }
-    }
-#ifdef DYAD_ENABLE_UCX_DTL
-    // For UCX RMA, file_size was prepended to the buffer by the server; extract it
-    // here to get the true data length and advance past the prefix.
-    if (ctx->dtl_handle->mode == DYAD_DTL_UCX) {
-        ctx->dtl_handle->get_buffer (ctx, 0, (void **)file_data);
-        ssize_t read_len = 0l;
-        memcpy (&read_len, *file_data, sizeof (read_len));
-        if (read_len < 0l) {
-            *file_len = 0ul;
-            DYAD_LOG_DEBUG (ctx, "Not able to read from %s file", mdata->fpath);
-            rc = DYAD_RC_BADFIO;
-        } else {
-            *file_len = (size_t)read_len;
-        }
-        *file_data = ((char *)*file_data) + sizeof (read_len);
-    }
-#endif
-    DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Read %zd bytes from %s file", *file_len, mdata->fpath);
-    DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Destroy the Flux future for the RPC.");
-    flux_future_destroy (f);
-    DYAD_C_FUNCTION_END ();
-    return rc;
+/**
+ * @brief Key of the @c dyad_notify_subs_t of a Flux handle in its aux items.
+ */
+#define DYAD_NOTIFY_SUBS_AUX "dyad::notify_subs"
+
+/**
+ * @brief Subscription of a Flux handle to the events of a bin.
+ */
+typedef struct dyad_notify_sub {
+    char topic[DYAD_NOTIFY_TOPIC_LEN];  ///< Topic built by dyad_notify_topic()
+    unsigned refs;                      ///< Waits in progress on the topic
+    unsigned long used;                 ///< Tick of the last wait on the topic
+} dyad_notify_sub_t;
+
+/**
+ * @brief Subscriptions of a Flux handle, kept in its aux items, so that they
+ *        last as long as the handle and are dropped with it by the broker.
+ */
+typedef struct dyad_notify_subs {
+    dyad_notify_sub_t *subs;  ///< Subscribed topics, @c count of them
+    unsigned count;           ///< Number of entries in @c subs
+    unsigned long tick;       ///< Incremented on every wait
+} dyad_notify_subs_t;
+
+static void dyad_notify_subs_destroy (void *arg)
+{
+    dyad_notify_subs_t *subs = (dyad_notify_subs_t *)arg;
+    free (subs->subs);
+    free (subs);
 }
 
 /**
- * @brief Writes file data retrieved from a producer to the consumer-managed directory.
+ * @brief Takes a reference on the subscription of the Flux handle of
+ *        @p ctx to @p evtopic, subscribing only if it has none yet.
  *
  * @details
- * Stores @p data_len bytes of @p file_data to the appropriate path under the
- * consumer-managed directory, as determined by combining @c ctx->cons_managed_path
- * with the relative file path in @p mdata->fpath. Any intermediate directories
- * that do not yet exist are created as needed.
- *
- * For large files (at or above @c DYAD_POSIX_TRANSFER_GRANULARITY bytes), the
- * data is written in chunks of @c DYAD_POSIX_TRANSFER_GRANULARITY rather than
- * in a single @c write() call.
- *
- * This function is an internal helper called by @c dyad_consume() and
- * @c dyad_consume_w_metadata() after data has been retrieved from the producer
- * via @c dyad_get_data(). It is not intended to be called directly by users.
- *
- * @param[in] ctx        Pointer to the DYAD context. Must not be @c NULL. Used to
- *                       resolve the consumer-managed path and check the @c check flag.
- * @param[in] mdata      Metadata for the file being stored. Must not be @c NULL.
- *                       @c mdata->fpath is appended to @c ctx->cons_managed_path to
- *                       form the full destination path.
- * @param[in] fd         Open, writable file descriptor for the destination file.
- * @param[in] data_len   Number of bytes to write from @p file_data.
- * @param[in] file_data  Buffer containing the file data to write. Must be at least
- *                       @p data_len bytes in size.
- *
- * @return @c dyad_rc_t return code indicating the outcome:
- * @retval DYAD_RC_OK      All @p data_len bytes were successfully written.
- * @retval DYAD_RC_BADFIO  Directory creation failed, a @c write() call failed,
- *                         or the total bytes written does not match @p data_len.
+ * Consumers tend to wait for several files of the same bins, so a
+ * subscription outlives the wait that made it: it is only dropped by
+ * @c dyad_notify_release() once more than @c DYAD_NOTIFY_IDLE_SUBS bins
+ * are subscribed to without a wait in progress, saving the two round trips
+ * to the broker of subscribing and unsubscribing on every wait.
  *
- * @note If the operation succeeds and @c ctx->check is set, the environment
- *       variable @c DYAD_CHECK_ENV is set to @c "ok".
+ * @return 0, or -1 if the subscription failed.
  */
-DYAD_CORE_FUNC_MODS dyad_rc_t dyad_cons_store (const dyad_ctx_t *restrict ctx,
-                                               const dyad_metadata_t *restrict mdata,
-                                               int fd,
-                                               const size_t data_len,
-                                               char *restrict file_data)
+DYAD_CORE_FUNC_MODS int dyad_notify_acquire (const dyad_ctx_t *restrict ctx,
+                                             const char *restrict evtopic)
 {
-    DYAD_C_FUNCTION_START ();
-    DYAD_C_FUNCTION_UPDATE_INT ("fd", fd);
-    dyad_rc_t rc = DYAD_RC_OK;
-    const char *odir = NULL;
-    char file_path[PATH_MAX + 1] = {'\0'};
-    char file_path_copy[PATH_MAX + 1] = {'\0'};
-    mode_t m = (S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH | S_ISGID);
-    size_t written_len = 0;
-    memset (file_path, 0, PATH_MAX + 1);
-    memset (file_path_copy, 0, PATH_MAX + 1);
-
-    // Build the full path to the file being consumed
-    strncpy (file_path, ctx->cons_managed_path, PATH_MAX - 1);
-    concat_str (file_path, mdata->fpath, "/", PATH_MAX);
-    memcpy (file_path_copy, file_path, PATH_MAX);  // dirname modifies the arg
-    DYAD_C_FUNCTION_UPDATE_STR ("cons_managed_path", ctx->cons_managed_path);
-    DYAD_C_FUNCTION_UPDATE_STR ("fpath", mdata->fpath);
-    DYAD_C_FUNCTION_UPDATE_STR ("file_path_copy", file_path_copy);
+    flux_t *h = (flux_t *)ctx->h;
+    dyad_notify_subs_t *subs = (dyad_notify_subs_t *)flux_aux_get (h, DYAD_NOTIFY_SUBS_AUX);
+    dyad_notify_sub_t *grown = NULL;
+    unsigned i = 0u;
 
-    DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Saving retrieved data to %s", file_path);
-    // Create the directory as needed
-    // TODO: Need to be consistent with the mode at the source
-    odir = dirname (file_path_copy);
-    if ((strncmp (odir, ".", strlen (".")) != 0) && (mkdir_as_needed (odir, m) < 0)) {
-        DYAD_LOG_ERROR (ctx, "DYAD CLIENT: Cannot create needed directories for pulled file");
-        rc = DYAD_RC_BADFIO;
-        goto pull_done;
+    if (subs == NULL) {
+        subs = (dyad_notify_subs_t *)calloc (1ul, sizeof (dyad_notify_subs_t));
+        if (subs == NULL) {
+            return -1;
+        }
+        if (flux_aux_set (h, DYAD_NOTIFY_SUBS_AUX, subs, dyad_notify_subs_destroy) < 0) {
+            free (subs);
+            return -1;
+        }
+    }
+    subs->tick++;
+    for (i = 0u; i < subs->count; i++) {
+        if (strcmp (subs->subs[i].topic, evtopic) == 0) {
+            subs->subs[i].refs++;
+            subs->subs[i].used = subs->tick;
+            return 0;
+        }
+    }
+    grown = (dyad_notify_sub_t *)realloc (subs->subs,
+                                          (subs->count + 1u) * sizeof (dyad_notify_sub_t));
+    if (grown == NULL) {
+        return -1;
+    }
+    subs->subs = grown;
+    if (flux_event_subscribe (h, evtopic) < 0) {
+        return -1;
     }
+    snprintf (subs->subs[subs->count].topic, DYAD_NOTIFY_TOPIC_LEN, "%s", evtopic);
+    subs->subs[subs->count].refs = 1u;
+    subs->subs[subs->count].used = subs->tick;
+    subs->count++;
+    return 0;
+}
 
-    // Write the file contents to the location specified by the user
-    if (data_len < DYAD_POSIX_TRANSFER_GRANULARITY) {
-        written_len = write (fd, file_data, data_len);
-    } else {
-        ssize_t written_data = 0;
-        ssize_t granularity = DYAD_POSIX_TRANSFER_GRANULARITY;
-        DYAD_LOG_DEBUG (ctx,
-                        " writing file %s with bytes %zd is big. Writing in granularity %zd",
-                        file_path,
-                        data_len,
-                        granularity);
-        while (written_data < (ssize_t)data_len) {
-            ssize_t written_size = (ssize_t)(data_len - written_data) > granularity
-                                       ? granularity
-                                       : (ssize_t)(data_len - written_data);
-            written_len = write (fd, file_data + written_data, written_size);
-            DYAD_LOG_DEBUG (ctx,
-                            " writing file %s with bytes %zd of %zd",
-                            file_path,
-                            written_size,
-                            written_len);
-            if (written_len <= 0) {
-                DYAD_LOG_ERROR (ctx,
-                                "DYAD CLIENT: Failed to write file \"%s\" only read %zd of %zd of "
-                                "%zd. with "
-                                "code %d:%s.",
-                                file_path,
-                                written_len,
-                                written_size,
-                                data_len,
-                                errno,
-                                strerror (errno));
-                goto pull_done;
+/**
+ * @brief Drops the reference taken on @p evtopic by @c dyad_notify_acquire(),
+ *        and the least recently waited on idle subscription if there are
+ *        more than @c DYAD_NOTIFY_IDLE_SUBS of them.
+ */
+DYAD_CORE_FUNC_MODS void dyad_notify_release (const dyad_ctx_t *restrict ctx,
+                                              const char *restrict evtopic)
+{
+    flux_t *h = (flux_t *)ctx->h;
+    dyad_notify_subs_t *subs = (dyad_notify_subs_t *)flux_aux_get (h, DYAD_NOTIFY_SUBS_AUX);
+    unsigned idle = 0u;
+    unsigned oldest = 0u;
+    unsigned i = 0u;
+
+    if (subs == NULL) {
+        return;
+    }
+    for (i = 0u; i < subs->count; i++) {
+        if (subs->subs[i].refs > 0u && strcmp (subs->subs[i].topic, evtopic) == 0) {
+            subs->subs[i].refs--;
+        }
+        if (subs->subs[i].refs == 0u) {
+            if (idle == 0u || subs->subs[i].used < subs->subs[oldest].used) {
+                oldest = i;
             }
-            written_data += written_len;
+            idle++;
         }
-        written_len = written_data;
     }
-    if (written_len != data_len) {
-        DYAD_LOG_ERROR (ctx, "DYAD CLIENT: cons store write of pulled file failed!\n");
-        rc = DYAD_RC_BADFIO;
-        goto pull_done;
+    if (idle <= DYAD_NOTIFY_IDLE_SUBS) {
+        return;
     }
-    DYAD_C_FUNCTION_UPDATE_INT ("data_len", data_len);
-    rc = DYAD_RC_OK;
+    if (flux_event_unsubscribe (h, subs->subs[oldest].topic) < 0) {
+        DYAD_LOG_DEBUG (ctx,
+                        "DYAD CLIENT: Cannot unsubscribe from %s",
+                        subs->subs[oldest].topic);
+    }
+    subs->subs[oldest] = subs->subs[--subs->count];
+}
 
-pull_done:;
-    // If "check" is set and the operation was successful, set the
-    // DYAD_CHECK_ENV environment variable to "ok"
-    if (rc == DYAD_RC_OK && (ctx && ctx->check))
-        setenv (DYAD_CHECK_ENV, "ok", 1);
-    DYAD_C_FUNCTION_END ();
-    return rc;
+/**
+ * @brief State of a @c dyad_notify_wait() shared with its watchers.
+ */
+typedef struct dyad_notify_waiter {
+    const dyad_ctx_t *ctx;         ///< Context waiting
+    const char *upath;             ///< Path of the awaited file
+    dyad_mdata_record_t *record;   ///< Set to the record of @c upath
+    bool found;                    ///< Whether @c upath was announced
+} dyad_notify_waiter_t;
+
+/**
+ * @brief Message handler of @c dyad_notify_wait(), which stops the reactor
+ *        once the awaited file is announced.
+ */
+static void dyad_notify_event_cb (flux_t *h,
+                                  flux_msg_handler_t *mh,
+                                  const flux_msg_t *msg,
+                                  void *arg)
+{
+    dyad_notify_waiter_t *waiter = (dyad_notify_waiter_t *)arg;
+
+    // Events dispatched after the awaited one are only recorded
+    if (dyad_notify_recv (waiter->ctx, msg, waiter->found ? "" : waiter->upath, waiter->record)) {
+        waiter->found = true;
+        flux_reactor_stop (flux_get_reactor (h));
+    }
 }
 
-dyad_rc_t dyad_produce (dyad_ctx_t *restrict ctx, const char *restrict fname)
+/**
+ * @brief Timer of @c dyad_notify_wait(), which stops the reactor once the
+ *        wait timed out.
+ */
+static void dyad_notify_timeout_cb (flux_reactor_t *r, flux_watcher_t *w, int revents, void *arg)
 {
-    DYAD_C_FUNCTION_START ();
-    ctx->fname = fname;
-    DYAD_C_FUNCTION_UPDATE_STR ("fname", ctx->fname);
-    DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Executing dyad_produce");
-    dyad_rc_t rc = DYAD_RC_OK;
-    // If the context is not defined, then it is not valid.
-    // So, return DYAD_NOCTX
-    if (!ctx || !ctx->h) {
-        DYAD_LOG_ERROR (ctx, "DYAD CLIENT: No CTX found in dyad_produce");
-        rc = DYAD_RC_NOCTX;
-        goto produce_done;
+    flux_reactor_stop (r);
+}
+
+/**
+ * @brief Waits for the publication event of @p upath, whose bin the Flux
+ *        handle of @p ctx is subscribed to.
+ *
+ * @details
+ * Runs the reactor of the handle, blocked in it until an event of DYAD
+ * arrives or @p timeout passes, so that the consumer does not wake up
+ * while nothing happens. Every event is handed to @c dyad_notify_recv(),
+ * which records the other files announced. The reactor also runs the
+ * continuations of the asynchronous operations of the context, e.g., the
+ * commits of @c DYAD_ASYNC_PUBLISH.
+ *
+ * @param[in]  ctx      Pointer to the DYAD context. Must not be @c NULL.
+ * @param[in]  upath    Path to the file relative to the consumer-managed
+ *                      directory.
+ * @param[in]  timeout  Seconds to wait, or 0 to wait until the event.
+ * @param[out] record   Set to the record of @p upath once announced.
+ *
+ * @return @c DYAD_RC_OK if @p upath was announced, @c DYAD_RC_NOTFOUND
+ *         once @p timeout has passed, or @c DYAD_RC_FLUXFAIL if receiving
+ *         failed.
+ */
+DYAD_CORE_FUNC_MODS dyad_rc_t dyad_notify_wait (const dyad_ctx_t *restrict ctx,
+                                                const char *restrict upath,
+                                                double timeout,
+                                                dyad_mdata_record_t *restrict record)
+{
+    struct flux_match match = FLUX_MATCH_EVENT;
+    flux_reactor_t *r = flux_get_reactor ((flux_t *)ctx->h);
+    flux_msg_handler_t *mh = NULL;
+    flux_watcher_t *timer = NULL;
+    dyad_notify_waiter_t waiter = {ctx, upath, record, false};
+    dyad_rc_t rc = DYAD_RC_NOTFOUND;
+
+    match.topic_glob = DYAD_NOTIFY_TOPIC_PREFIX "*";
+    if (r == NULL
+        || (mh = flux_msg_handler_create ((flux_t *)ctx->h, match, dyad_notify_event_cb, &waiter))
+               == NULL) {
+        DYAD_LOG_ERROR (ctx, "DYAD CLIENT: Cannot receive publication events");
+        return DYAD_RC_FLUXFAIL;
     }
-    // If the producer-managed path is NULL or empty, then the context is not
-    // valid for a producer operation. So, return DYAD_BADMANAGEDPATH
-    if (ctx->prod_managed_path == NULL) {
-        DYAD_LOG_ERROR (ctx, "DYAD CLIENT: No or empty producer managed path was found");
-        rc = DYAD_RC_BADMANAGEDPATH;
-        goto produce_done;
+    if (timeout > 0.0) {
+        flux_reactor_now_update (r);
+        timer = flux_timer_watcher_create (r, timeout, 0.0, dyad_notify_timeout_cb, NULL);
+        if (timer == NULL) {
+            DYAD_LOG_ERROR (ctx, "DYAD CLIENT: Cannot time the wait for publication events");
+            flux_msg_handler_destroy (mh);
+            return DYAD_RC_FLUXFAIL;
+        }
+        flux_watcher_start (timer);
+    }
+    flux_msg_handler_start (mh);
+    if (flux_reactor_run (r, 0) < 0) {
+        DYAD_LOG_ERROR (ctx, "DYAD CLIENT: Cannot receive publication events");
+        rc = DYAD_RC_FLUXFAIL;
+    }
+    flux_msg_handler_destroy (mh);
+    flux_watcher_destroy (timer);
+    if (waiter.found) {
+        rc = DYAD_RC_OK;
     }
-    // If the context is valid, call dyad_commit to perform
-    // the producer operation
-    rc = dyad_commit (ctx, fname);
-produce_done:;
-    DYAD_C_FUNCTION_END ();
     return rc;
 }
 
-/** This function is coupled with Python API. This populates `mdata' which
- * is used by `dyad_consume_w_metadata ()'
+/**
+ * @brief Waits for the metadata of a file to be published, on the events
+ *        of its bin rather than a @c FLUX_KVS_WAITCREATE lookup.
+ *
+ * @details
+ * Subscribes to the topic of the file before the first KVS lookup, so that
+ * an announcement sent in between is not missed, or keeps the subscription
+ * of an earlier wait (see @c dyad_notify_acquire()). As long as the file is
+ * not in the KVS, waits for its event with @c dyad_notify_wait(), looking
+ * it up in the KVS again every @c ctx->notify_timeout seconds, so that a
+ * lost event, or a producer that does not send them, only delays the
+ * consumer. Events still queued once the file is found are recorded with
+ * @c dyad_notify_recv().
+ *
+ * @param[in]     ctx    Pointer to the DYAD context. Must not be @c NULL.
+ * @param[in]     topic  KVS key for the file.
+ * @param[in]     upath  Path to the file relative to the consumer-managed
+ *                       directory.
+ * @param[in,out] mdata  As for @c dyad_kvs_read().
+ *
+ * @return As @c dyad_kvs_get_mdata(), or @c DYAD_RC_FLUXFAIL if the events
+ *         cannot be received, in which case the caller falls back to a
+ *         waiting KVS lookup.
  */
-dyad_rc_t dyad_get_metadata (dyad_ctx_t *restrict ctx,
-                             const char *restrict fname,
-                             bool should_wait,
-                             dyad_metadata_t **restrict mdata)
+DYAD_CORE_FUNC_MODS dyad_rc_t dyad_kvs_wait_event (const dyad_ctx_t *restrict ctx,
+                                                   const char *restrict topic,
+                                                   const char *restrict upath,
+                                                   dyad_metadata_t **restrict mdata)
 {
-    DYAD_C_FUNCTION_START ();
-    DYAD_C_FUNCTION_UPDATE_STR ("fname", fname);
-    DYAD_C_FUNCTION_UPDATE_INT ("should_wait", should_wait);
+    char evtopic[DYAD_NOTIFY_TOPIC_LEN] = {'\0'};
+    struct flux_match match = FLUX_MATCH_EVENT;
+    dyad_mdata_record_t record;
+    flux_future_t *f = NULL;
+    flux_msg_t *msg = NULL;
     dyad_rc_t rc = DYAD_RC_OK;
 
-#if 0
-    if (fname == NULL || strlen (fname) > PATH_MAX) {
-        rc = DYAD_RC_SYSFAIL;
-        goto get_metadata_done;
+    dyad_notify_topic (ctx, upath, evtopic);
+    if (dyad_notify_acquire (ctx, evtopic) < 0) {
+        DYAD_LOG_ERROR (ctx, "DYAD CLIENT: Cannot subscribe to %s", evtopic);
+        return DYAD_RC_FLUXFAIL;
     }
-#endif
-    const size_t fname_len = strlen (fname);
-    char upath[PATH_MAX + 1] = {'\0'};
-
-    if (fname_len == 0ul) {
-        rc = DYAD_RC_BADFIO;
-        DYAD_LOG_ERROR (ctx, "Filename length is zero");
-        goto get_metadata_done;
+    for (;;) {
+        f = flux_kvs_lookup ((flux_t *)ctx->h, ctx->kvs_namespace, 0, topic);
+        if (f == NULL) {
+            DYAD_LOG_ERROR (ctx, "KVS lookup failed!\n");
+            rc = DYAD_RC_NOTFOUND;
+            break;
+        }
+        rc = dyad_kvs_get_mdata (ctx, f, topic, upath, mdata);
+        flux_future_destroy (f);
+        if (rc != DYAD_RC_NOTFOUND) {
+            break;
+        }
+        rc = dyad_notify_wait (ctx, upath, ctx->notify_timeout, &record);
+        if (rc == DYAD_RC_OK) {
+            DYAD_LOG_INFO (ctx,
+                           "DYAD CLIENT: %s was announced by broker %u",
+                           upath,
+                           record.owner_rank);
+            rc = dyad_alloc_mdata (ctx, upath, mdata);
+            if (!DYAD_IS_ERROR (rc)) {
+                dyad_mdata_from_record (*mdata, &record);
+            }
+            break;
+        }
+        if (rc != DYAD_RC_NOTFOUND) {
+            break;
+        }
     }
-    if (ctx->relative_to_managed_path
+    dyad_notify_release (ctx, evtopic);
+    match.topic_glob = DYAD_NOTIFY_TOPIC_PREFIX "*";
+    while ((msg = flux_recv ((flux_t *)ctx->h, match, FLUX_O_NONBLOCK)) != NULL) {
+        dyad_notify_recv (ctx, msg, "", &record);
+        flux_msg_destroy (msg);
+    }
+    return rc;
+}
+
+/**
+ * @brief Looks up file metadata from the Flux KVS.
+ *
+ * @details
+ * Queries the Flux KVS for metadata associated with the file identified by
+ * @p topic (the KVS key) and @p upath (the file path relative to the
+ * consumer-managed directory). The KVS holds the producer's broker rank
+ * (@c owner_rank), which is used by the caller to determine locality and,
+ * if needed, to dispatch an RPC to the correct producer broker for data
+ * transfer, along with the size, modification time and optional checksum
+ * of the file (see @c mdata_record.h).
+ *
+ * If @p should_wait is @c true, the lookup blocks using @c FLUX_KVS_WAITCREATE
+ * until the producer publishes the metadata, or, with @c DYAD_NOTIFY set to
+ * @c "event", waits for its announcement with @c dyad_kvs_wait_event().
+ * If @p should_wait is @c false,
+ * the lookup returns immediately with @c DYAD_RC_NOTFOUND if the metadata is
+ * not yet available.
+ *
+ * Lookups are answered from the metadata cache of @p ctx when possible,
+ * and their outcome is recorded in it (see @c dyad_lookup_cached_mdata()
+ * and @c dyad_cache_mdata()).
+ *
+ * If @c *mdata is already allocated on entry, the existing object is reused
+ * and only @c fpath and @c owner_rank are overwritten. Otherwise a new
+ * @c dyad_metadata_t object is allocated. On error, any partially allocated
+ * @p mdata is freed before returning.
+ *
+ * @param[in]     ctx         Pointer to the DYAD context. Must not be @c NULL.
+ *                            Provides the Flux handle and KVS namespace.
+ * @param[in]     topic       KVS key for the file, generated from @p upath via
+ *                            @c gen_path_key(). Must not be @c NULL.
+ * @param[in]     upath       Path to the file relative to the consumer-managed
+ *                            directory. Stored in the populated metadata object.
+ *                            Must not be @c NULL.
+ * @param[in]     should_wait If @c true, block until the producer publishes the
+ *                            metadata to the KVS. If @c false, return immediately
+ *                            if the metadata is not yet available.
+ * @param[in,out] mdata       Address of a @c dyad_metadata_t pointer to be
+ *                            populated. Must not be @c NULL. If @c *mdata is
+ *                            already allocated, it is reused; otherwise a new
+ *                            object is allocated. The caller is responsible for
+ *                            freeing it via @c dyad_free_metadata() when no
+ *                            longer needed.
+ *
+ * @return @c dyad_rc_t         return code indicating the outcome:
+ * @retval DYAD_RC_OK           Metadata was successfully retrieved and @p mdata
+ *                              has been populated.
+ * @retval DYAD_RC_NOTFOUND     @p mdata is @c NULL, the KVS lookup failed, or
+ *                              the metadata is not yet available and
+ *                              @p should_wait is @c false.
+ * @retval DYAD_RC_SYSFAIL      Memory allocation for the metadata object or its
+ *                              @c fpath field failed.
+ * @retval DYAD_RC_BADMETADATA  The KVS response could not be unpacked to extract
+ *                              the producer's broker rank.
+ */
+DYAD_DLL_EXPORTED dyad_rc_t dyad_kvs_read (const dyad_ctx_t *restrict ctx,
+                                           const char *restrict topic,
+                                           const char *restrict upath,
+                                           bool should_wait,
+                                           dyad_metadata_t **restrict mdata)
+{
+    DYAD_C_FUNCTION_START ();
+    DYAD_C_FUNCTION_UPDATE_STR ("upath", upath);
+    dyad_rc_t rc = DYAD_RC_OK;
+    int kvs_lookup_flags = 0;
+    flux_future_t *f = NULL;
+    uint64_t t_lookup = 0ull;
+    if (mdata == NULL) {
+        DYAD_LOG_ERROR (ctx,
+                        "Metadata double pointer is NULL. "
+                        "Cannot correctly create metadata object");
+        rc = DYAD_RC_NOTFOUND;
+        goto kvs_read_end;
+    }
+    if (dyad_lookup_cached_mdata (ctx, upath, should_wait, mdata, &rc)) {
+        goto kvs_read_end;
+    }
+    t_lookup = dyad_stats_now ();
+    if (should_wait && ctx->notify_events) {
+        rc = dyad_kvs_wait_event (ctx, topic, upath, mdata);
+        if (rc != DYAD_RC_FLUXFAIL) {
+            goto kvs_read_got;
+        }
+        DYAD_LOG_INFO (ctx, "DYAD CLIENT: Waiting for %s in the KVS instead", upath);
+    }
+    // Lookup information about the desired file (represented by kvs_topic)
+    // from the Flux KVS. If there is no information, wait for it to be
+    // made available
+    if (should_wait)
+        kvs_lookup_flags = FLUX_KVS_WAITCREATE;
+    f = flux_kvs_lookup ((flux_t *)ctx->h, ctx->kvs_namespace, kvs_lookup_flags, topic);
+    // If the KVS lookup failed, log an error and return DYAD_BADLOOKUP
+    if (f == NULL) {
+        DYAD_LOG_ERROR (ctx, "KVS lookup failed!\n");
+        rc = DYAD_RC_NOTFOUND;
+        goto kvs_read_end;
+    }
+    // Extract the rank of the producer from the KVS response
+    rc = dyad_kvs_get_mdata (ctx, f, topic, upath, mdata);
+kvs_read_got:;
+    dyad_stats_record (DYAD_STATS_KVS_LOOKUP, t_lookup);
+    dyad_cache_mdata (ctx, upath, should_wait, rc, *mdata);
+    if (DYAD_IS_ERROR (rc)) {
+        goto kvs_read_end;
+    }
+    DYAD_C_FUNCTION_UPDATE_STR ("fpath", (*mdata)->fpath);
+    DYAD_C_FUNCTION_UPDATE_INT ("owner_rank", (*mdata)->owner_rank);
+    rc = DYAD_RC_OK;
+
+kvs_read_end:;
+    if (DYAD_IS_ERROR (rc) && mdata != NULL && *mdata != NULL) {
+        dyad_free_metadata (mdata);
+    }
+    if (f != NULL) {
+        flux_future_destroy (f);
+        f = NULL;
+    }
+    DYAD_C_FUNCTION_END ();
+    return rc;
+}
+
+/**
+ * @brief Retrieves file metadata from the Flux KVS for an internal consumer operation.
+ *
+ * @details
+ * Looks up metadata for the file identified by @p upath in the Flux KVS,
+ * blocking until the producer publishes it. This is the internal counterpart
+ * to @c dyad_get_metadata(), used exclusively by @c dyad_consume().
+ *
+ * After retrieving metadata, the function determines whether a remote data
+ * transfer is actually needed by checking if the producer and consumer reside
+ * on the same node. This is done by comparing @c mdata->owner_rank / @c ctx->service_mux
+ * against @c ctx->node_idx. If they match, the producer is on the same node and
+ * the file is already locally accessible, so the metadata object is freed and
+ * set to @c NULL to signal to @c dyad_consume() that the data transfer step
+ * should be skipped.
+ *
+ * Note that this locality check is only relevant for node-local storage. When
+ * shared storage is enabled, @c dyad_consume() never uses the metadata for data
+ * transfer regardless, so the check is not needed in that path.
+ *
+ * The @c mdata == @c NULL convention on return is therefore not an error condition
+ * but a deliberate signal that the data transfer step should be skipped.
+ *
+ * This function is not intended to be called directly by users.
+ *
+ * @param[in]  ctx    Pointer to the DYAD context. Must not be @c NULL.
+ * @param[in]  fname  Absolute path to the file being consumed.
+ * @param[in]  upath  Path to the file relative to the consumer-managed directory.
+ *                    Used to generate the Flux KVS lookup key.
+ * @param[out] mdata  Address of a @c dyad_metadata_t pointer. Always set to
+ *                    @c NULL on entry. On success, either points to the retrieved
+ *                    metadata if a remote transfer is needed, or remains @c NULL
+ *                    if the producer is on the same node and the file is already
+ *                    locally accessible.
+ *
+ * @return @c dyad_rc_t return code indicating the outcome:
+ * @retval DYAD_RC_OK   Metadata was successfully retrieved, or the producer is
+ *                      on the same node and no transfer is needed (@p mdata will
+ *                      be @c NULL).
+ * @retval DYAD_RC_*    Any error code propagated from @c dyad_kvs_read().
+ *
+ * @note Unlike @c dyad_get_metadata(), this function always blocks until the
+ *       producer publishes the file's metadata to the KVS.
+ * @note The @c service_mux field in @p ctx controls how many Flux broker ranks
+ *       map to a single node, and is used to determine node-level locality.
+ */
+DYAD_CORE_FUNC_MODS dyad_rc_t dyad_fetch_metadata (dyad_ctx_t *restrict ctx,
+                                                   const char *restrict fname,
+                                                   const char *restrict upath,
+                                                   dyad_metadata_t **restrict mdata)
+{
+    DYAD_C_FUNCTION_START ();
+    DYAD_C_FUNCTION_UPDATE_STR ("fname", fname);
+    dyad_rc_t rc = DYAD_RC_OK;
+    const size_t topic_len = PATH_MAX;
+    char topic[PATH_MAX + 1] = {'\0'};
+    *mdata = NULL;
+#if 0
+    if (fname == NULL || upath == NULL || strlen (fname) == 0ul || strlen (upath) == 0ul) {
+        rc = DYAD_RC_BADFIO;
+        goto get_metadata_done;
+    }
+#endif
+    // Set reenter to false to avoid recursively performing DYAD operations
+    DYAD_C_FUNCTION_UPDATE_STR ("upath", upath);
+    // Generate the KVS key from the file path relative to
+    // the consumer-managed directory
+    gen_path_key (upath, topic, topic_len, ctx->key_depth, ctx->key_bins);
+    DYAD_LOG_INFO (ctx, "DYAD CLIENT: Fetch metadata for: %s, key: %s.", upath, topic);
+    // Commit the files held back in the publication batch first, as this
+    // context may be the producer being waited on
+    dyad_publish_flush (ctx);
+    // Call dyad_kvs_read to retrieve infromation about the file
+    // from the Flux KVS
+    rc = dyad_kvs_read (ctx, topic, upath, true, mdata);
+    // If an error occured in dyad_kvs_read, log it and propagate the return
+    // code
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (ctx, "DYAD CLIENT: dyad_kvs_read failed!");
+        goto fetch_done;
+    }
+    // There are two cases where we do not want to perform file transfer:
+    //   1. if the shared storage feature is enabled
+    //   2. if the producer and consumer share the same rank
+    // In either of these cases, skip the creation of the dyad_kvs_response_t
+    // object, and return DYAD_OK. This will cause the file transfer step to be
+    // skipped
+    DYAD_C_FUNCTION_UPDATE_INT ("owner_rank", (*mdata)->owner_rank);
+    DYAD_C_FUNCTION_UPDATE_INT ("node_idx", ctx->node_idx);
+    // if (ctx->shared_storage || ((*mdata)->owner_rank / ctx->service_mux) == ctx->node_idx) {
+    if (((*mdata)->owner_rank / ctx->service_mux) == ctx->node_idx) {
+        DYAD_LOG_INFO (ctx,
+                       "Either shared-storage is indicated or the producer rank (%u) is the"
+                       " same as the consumer rank (%u)",
+                       (*mdata)->owner_rank,
+                       ctx->rank);
+        if (mdata != NULL && *mdata != NULL) {
+            dyad_free_metadata (mdata);
+        }
+        rc = DYAD_RC_OK;
+        DYAD_C_FUNCTION_UPDATE_INT ("is_local", 1);
+        goto fetch_done;
+    }
+    DYAD_C_FUNCTION_UPDATE_INT ("is_local", 0);
+    rc = DYAD_RC_OK;
+
+fetch_done:;
+    DYAD_C_FUNCTION_END ();
+    return rc;
+}
+
+/**
+ * @brief Tells whether transfers should be compressed.
+ *
+ * @details
+ * Compression is requested when @c ctx->compression (set from
+ * @c DYAD_COMPRESSION) names a codec. Every DTL delivers each message with
+ * its own length, so that frames and raw data can be told apart.
+ *
+ * @param[in] ctx  Pointer to the DYAD context. Must not be @c NULL.
+ *
+ * @return @c true if the RPC payload should ask for compression.
+ */
+static inline bool dyad_use_compression (const dyad_ctx_t *restrict ctx)
+{
+    return (ctx->compression != DYAD_CODEC_NONE) && (ctx->dtl_handle != NULL);
+}
+
+/**
+ * @brief Asks the module to compress the transfer, if compression is in use.
+ *
+ * @details
+ * Adds the codec name under the @c "codec" key and
+ * @c ctx->compression_threshold under the @c "codec_min" key to
+ * @p rpc_payload. A module that does not know these keys ignores them and
+ * sends raw data, which @c dyad_decode_frame() passes through.
+ *
+ * @param[in]     ctx          Pointer to the DYAD context. Must not be @c NULL.
+ * @param[in,out] rpc_payload  Payload returned by @c dtl_handle->rpc_pack().
+ *
+ * @return @c DYAD_RC_OK, or @c DYAD_RC_BADPACK if a key could not be added.
+ */
+DYAD_CORE_FUNC_MODS dyad_rc_t dyad_pack_codec (const dyad_ctx_t *restrict ctx,
+                                               json_t *restrict rpc_payload)
+{
+    if (!dyad_use_compression (ctx)) {
+        return DYAD_RC_OK;
+    }
+    if (json_object_set_new (rpc_payload,
+                             "codec",
+                             json_string (dyad_codec_name ((dyad_codec_t)ctx->compression)))
+            < 0
+        || json_object_set_new (rpc_payload,
+                                "codec_min",
+                                json_integer ((json_int_t)ctx->compression_threshold))
+               < 0) {
+        DYAD_LOG_ERROR (ctx, "Cannot add the codec to the RPC payload\n");
+        return DYAD_RC_BADPACK;
+    }
+    return DYAD_RC_OK;
+}
+
+/**
+ * @brief Returns the future through which the responses of the current
+ *        fetch come.
+ *
+ * @details
+ * The DTL may have sent the fetch request again, e.g., after the producer
+ * lost the registration of this consumer. In that case, @p f is destroyed
+ * and the future of the request sent again is returned in its place.
+ *
+ * @param[in] ctx Pointer to the DYAD context. Must not be @c NULL.
+ * @param[in] f   Future of the fetch RPC, or @c NULL.
+ *
+ * @return The future to read the remaining responses from and destroy.
+ */
+static inline flux_future_t *dyad_fetch_future (const dyad_ctx_t *restrict ctx,
+                                                flux_future_t *f)
+{
+    if (ctx->dtl_handle->rpc_future == NULL) {
+        return f;
+    }
+    return ctx->dtl_handle->rpc_future (ctx, f);
+}
+
+/**
+ * @brief Decodes a message received from the module, if it is a frame.
+ *
+ * @details
+ * Only messages of transfers for which compression was requested can be
+ * frames. On success, @p buf is replaced with a DTL buffer holding the
+ * decoded message, the received one is returned to the DTL, and @p len is
+ * updated. Messages that are not frames are left untouched.
+ *
+ * @param[in]     ctx  Pointer to the DYAD context. Must not be @c NULL.
+ * @param[in,out] buf  Message returned by @c dtl_handle->recv().
+ * @param[in,out] len  Size of @p buf.
+ *
+ * @return @c dyad_rc_t return code indicating the outcome:
+ * @retval DYAD_RC_OK      The message is raw data or was decoded.
+ * @retval DYAD_RC_BADBUF  No buffer could be obtained for the decoded message.
+ * @retval DYAD_RC_BADRPC  The frame is corrupted or uses a codec this build
+ *                         does not support.
+ */
+DYAD_CORE_FUNC_MODS dyad_rc_t dyad_decode_frame (const dyad_ctx_t *restrict ctx,
+                                                 char **restrict buf,
+                                                 size_t *restrict len)
+{
+    dyad_rc_t rc = DYAD_RC_OK;
+    char *raw = NULL;
+    size_t raw_len = 0ul;
+
+    if (!dyad_use_compression (ctx) || !dyad_frame_check (*buf, *len, &raw_len)) {
+        return DYAD_RC_OK;
+    }
+    rc = ctx->dtl_handle->get_buffer (ctx, raw_len, (void **)&raw);
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (ctx, "Cannot get a buffer of %zu bytes to decode into\n", raw_len);
+        return DYAD_RC_BADBUF;
+    }
+    if (dyad_frame_decode (*buf, *len, raw, raw_len) < 0) {
+        DYAD_LOG_ERROR (ctx, "Cannot decode a message of the module (errno = %d)\n", errno);
+        ctx->dtl_handle->return_buffer (ctx, (void **)&raw);
+        return DYAD_RC_BADRPC;
+    }
+    ctx->dtl_handle->return_buffer (ctx, (void **)buf);
+    *buf = raw;
+    *len = raw_len;
+    return DYAD_RC_OK;
+}
+
+/**
+ * @brief Retrieves a byte range of a file from a remote producer's Flux broker
+ *        via RPC.
+ *
+ * @details
+ * Dispatches a streaming Flux RPC to the DYAD module running on the producer's
+ * broker (identified by @p mdata->owner_rank) and retrieves the file data via
+ * the configured Data Transport Layer (DTL). The retrieved data is returned in
+ * @p file_data and its length in @p file_len.
+ *
+ * Unless @p offset and @p length are both 0, which asks for the whole file,
+ * they are added to the RPC payload under the @c "offset" and @c "length"
+ * keys, and the module only sends that part of the file. A @p length of 0
+ * extends the range to the end of the file, and a range extending past the
+ * end of the file stops there, so @p file_len may be less than @p length.
+ *
+ * If compression is enabled, the codec is added to the payload by
+ * @c dyad_pack_codec() and the received message is decoded by
+ * @c dyad_decode_frame(), so @p file_data always holds raw file contents.
+ *
+ * The sequence of operations is:
+ *  1. Pack an RPC payload containing the file path and producer rank.
+ *  2. Send a streaming Flux RPC to the producer's DYAD module.
+ *  3. Receive and parse the RPC response.
+ *  4. Establish a DTL connection to the producer.
+ *  5. Receive the file data over the DTL connection.
+ *  6. Close the DTL connection.
+ *  7. Wait for the end-of-stream RPC message from the producer module.
+ *
+ * The streaming RPC protocol expects exactly one data message followed by an
+ * end-of-stream signal (indicated by @c ENODATA). If additional messages arrive
+ * or the module reports an error, @c DYAD_RC_BADRPC is returned. Two return
+ * codes from the DTL have special meaning and bypass the end-of-stream wait:
+ * @c DYAD_RC_RPC_FINISHED (end of stream already received) and
+ * @c DYAD_RC_BADRPC (a prior RPC operation failed irrecoverably).
+ *
+ * This function is an internal helper called by @c dyad_get_data() and
+ * @c dyad_consume_range(). It is not intended to be called directly by users.
+ *
+ * @param[in]  ctx        Pointer to the DYAD context. Must not be @c NULL.
+ *                        Provides the Flux handle, DTL handle, and other
+ *                        connection parameters.
+ * @param[in]  mdata      Metadata for the file to retrieve. Must not be @c NULL.
+ *                        @c mdata->fpath and @c mdata->owner_rank identify the
+ *                        file and the producer broker to contact.
+ * @param[in]  offset     First byte of the file to retrieve.
+ * @param[in]  length     Number of bytes to retrieve, or 0 for the rest of the
+ *                        file.
+ * @param[out] file_data  Address of a pointer to be set to the buffer containing
+ *                        the retrieved file data. The buffer is allocated by the
+ *                        DTL layer. The caller is responsible for releasing it
+ *                        via @c ctx->dtl_handle->return_buffer().
+ * @param[out] file_len   Address of a @c size_t to be set to the number of bytes
+ *                        in @p file_data.
+ *
+ * @return @c dyad_rc_t return code indicating the outcome:
+ * @retval DYAD_RC_OK           File data was successfully retrieved.
+ * @retval DYAD_RC_BADPACK      The byte range could not be added to the payload.
+ * @retval DYAD_RC_BADRPC       An RPC operation failed, the producer module sent
+ *                              an unexpected number of responses, or the module
+ *                              reported an error, e.g., because @p offset is
+ *                              beyond the end of the file.
+ * @retval DYAD_RC_*            Any error code propagated from
+ *                              @c dtl_handle->rpc_pack(),
+ *                              @c dtl_handle->rpc_recv_response(),
+ *                              @c dtl_handle->establish_connection(), or
+ *                              @c dtl_handle->recv().
+ */
+DYAD_DLL_EXPORTED dyad_rc_t dyad_get_data_range (const dyad_ctx_t *restrict ctx,
+                                                 const dyad_metadata_t *restrict mdata,
+                                                 size_t offset,
+                                                 size_t length,
+                                                 char **restrict file_data,
+                                                 size_t *restrict file_len)
+{
+    DYAD_C_FUNCTION_START ();
+    dyad_rc_t rc = DYAD_RC_OK;
+    flux_future_t *f = NULL;
+    json_t *rpc_payload = NULL;
+    uint64_t t0 = 0ull;
+    DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Packing payload for RPC to DYAD module");
+    DYAD_C_FUNCTION_UPDATE_INT ("owner_rank", mdata->owner_rank);
+    DYAD_C_FUNCTION_UPDATE_STR ("fpath", mdata->fpath);
+    DYAD_C_FUNCTION_UPDATE_INT ("offset", offset);
+    DYAD_C_FUNCTION_UPDATE_INT ("length", length);
+    rc = ctx->dtl_handle->rpc_pack (ctx, mdata->fpath, mdata->owner_rank, &rpc_payload);
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (ctx,
+                        "Cannot create JSON payload for Flux RPC to "
+                        "DYAD module\n");
+        goto get_done;
+    }
+    if ((offset > 0ul || length > 0ul)
+        && (json_object_set_new (rpc_payload, "offset", json_integer ((json_int_t)offset)) < 0
+            || json_object_set_new (rpc_payload, "length", json_integer ((json_int_t)length))
+                   < 0)) {
+        DYAD_LOG_ERROR (ctx, "Cannot add the byte range to the RPC payload\n");
+        json_decref (rpc_payload);
+        rc = DYAD_RC_BADPACK;
+        goto get_done;
+    }
+    rc = dyad_pack_codec (ctx, rpc_payload);
+    if (DYAD_IS_ERROR (rc)) {
+        json_decref (rpc_payload);
+        goto get_done;
+    }
+    DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Sending payload for RPC to DYAD module");
+    t0 = dyad_stats_now ();
+    f = flux_rpc_pack ((flux_t *)ctx->h,
+                       DYAD_DTL_RPC_NAME,
+                       mdata->owner_rank,
+                       FLUX_RPC_STREAMING,
+                       "o",
+                       rpc_payload);
+    if (f == NULL) {
+        DYAD_LOG_ERROR (ctx, "Cannot send RPC to producer module.");
+        rc = DYAD_RC_BADRPC;
+        goto get_done;
+    }
+    DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Receive RPC response from DYAD module");
+    rc = ctx->dtl_handle->rpc_recv_response (ctx, f);
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (ctx, "Cannot receive and/or parse the RPC response.");
+        goto get_done;
+    }
+    DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Establish DTL connection with DYAD module");
+    rc = ctx->dtl_handle->establish_connection (ctx);
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (ctx,
+                        "Cannot establish connection with DYAD module on broker "
+                        "%u.",
+                        mdata->owner_rank);
+        goto get_done;
+    }
+    dyad_stats_record (DYAD_STATS_RPC_SETUP, t0);
+    DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Receive file data via DTL");
+    t0 = dyad_stats_now ();
+    rc = ctx->dtl_handle->recv (ctx, (void **)file_data, file_len);
+    dyad_stats_record (DYAD_STATS_DTL_RECV, t0);
+    DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Close DTL connection with DYAD module");
+    ctx->dtl_handle->close_connection (ctx);
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (ctx, "Cannot receive data from producer module.");
+        goto get_done;
+    }
+    rc = dyad_decode_frame (ctx, file_data, file_len);
+    if (DYAD_IS_ERROR (rc)) {
+        goto get_done;
+    }
+    DYAD_C_FUNCTION_UPDATE_INT ("file_len", *file_len);
+
+    rc = DYAD_RC_OK;
+
+get_done:;
+    // There are two return codes that have special meaning when coming from the
+    // DTL:
+    //  * DYAD_RC_RPC_FINISHED: occurs when an ENODATA error occurs
+    //  * DYAD_RC_BADRPC: occurs when a previous RPC operation fails
+    // In either of these cases, we do not need to wait for the end of stream
+    // because the RPC is already completely messed up. If we do not have either
+    // of these cases, we will wait for one more RPC message. If everything went
+    // well in the module, this last message will set errno to ENODATA (i.e.,
+    // end of stream). Otherwise, something went wrong, so we'll return
+    // DYAD_RC_BADRPC.
+    // DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Wait for end-of-stream message from module (current RC =
+    // %d)", rc);
+    f = dyad_fetch_future (ctx, f);
+    if (f != NULL && rc != DYAD_RC_RPC_FINISHED && rc != DYAD_RC_BADRPC) {
+        if (!(flux_rpc_get (f, NULL) < 0 && errno == ENODATA)) {
+            DYAD_LOG_ERROR (ctx,
+                            "An error occured at end of getting data! Either the "
+                            "module sent too many responses, or the module "
+                            "failed with a bad error (errno = %d).",
+                            errno);
+            rc = DYAD_RC_BADRPC;
+        }
+    }
+    if (DYAD_IS_ERROR (rc)) {
+        dyad_uncache_mdata (ctx, mdata->fpath);
+    }
+    DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Read %zd bytes from %s file", *file_len, mdata->fpath);
+    DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Destroy the Flux future for the RPC.");
+    flux_future_destroy (f);
+    DYAD_C_FUNCTION_END ();
+    return rc;
+}
+
+/**
+ * @brief Retrieves file data from a remote producer's Flux broker via RPC.
+ *
+ * @details
+ * Retrieves the whole file with @c dyad_get_data_range(). This function is
+ * an internal helper called by @c dyad_consume() and
+ * @c dyad_consume_w_metadata(). It is not intended to be called directly
+ * by users.
+ *
+ * @param[in]  ctx        Pointer to the DYAD context. Must not be @c NULL.
+ * @param[in]  mdata      Metadata for the file to retrieve. Must not be @c NULL.
+ * @param[out] file_data  Address of a pointer to be set to the buffer containing
+ *                        the retrieved file data. The caller is responsible for
+ *                        releasing it via @c ctx->dtl_handle->return_buffer().
+ * @param[out] file_len   Address of a @c size_t to be set to the number of bytes
+ *                        in @p file_data.
+ *
+ * @return @c dyad_rc_t return code of @c dyad_get_data_range().
+ */
+DYAD_DLL_EXPORTED dyad_rc_t dyad_get_data (const dyad_ctx_t *restrict ctx,
+                                           const dyad_metadata_t *restrict mdata,
+                                           char **restrict file_data,
+                                           size_t *restrict file_len)
+{
+    return dyad_get_data_range (ctx, mdata, 0ul, 0ul, file_data, file_len);
+}
+
+/**
+ * @brief Writes @p len bytes of @p buf to @p fd at @p offset.
+ *
+ * @details
+ * Writes with the engine selected by @c DYAD_IO_ENGINE, which retries
+ * short and interrupted writes until the whole buffer has been written.
+ * The POSIX engine issues @c pwrite() calls of at most
+ * @c DYAD_POSIX_TRANSFER_GRANULARITY bytes, and the io_uring engine keeps
+ * many blocks of the buffer in flight at once. A large buffer is split
+ * across @c DYAD_STORE_THREADS threads, and with @c DYAD_STORE_DIRECT its
+ * aligned part bypasses the page cache, as described in
+ * @c store_engine.h.
+ *
+ * @param[in] ctx     Pointer to the DYAD context, used for logging.
+ * @param[in] fd      File descriptor opened for writing.
+ * @param[in] buf     Data to write.
+ * @param[in] len     Number of bytes of @p buf to write.
+ * @param[in] offset  File offset at which to write @p buf.
+ * @param[in] fpath   Path of the file, used for logging.
+ *
+ * @return @c dyad_rc_t return code indicating the outcome:
+ * @retval DYAD_RC_OK      All @p len bytes were written.
+ * @retval DYAD_RC_BADFIO  A write failed.
+ */
+DYAD_CORE_FUNC_MODS dyad_rc_t dyad_cons_write_at (const dyad_ctx_t *restrict ctx,
+                                                  int fd,
+                                                  const char *restrict buf,
+                                                  size_t len,
+                                                  size_t offset,
+                                                  const char *restrict fpath)
+{
+    ssize_t written_len = 0l;
+    uint64_t t0 = 0ull;
+    dyad_store_opts_t opts;
+
+    opts.engine = (dyad_io_engine_t)ctx->io_engine;
+    opts.threads = ctx->store_threads;
+    opts.pool = (dyad_worker_pool_t *)ctx->store_pool;
+    opts.direct = ctx->store_direct;
+    DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Writing %zu bytes of %s at offset %zu", len, fpath, offset);
+    t0 = dyad_stats_now ();
+    written_len = dyad_store_write (&opts, fd, buf, len, (off_t)offset);
+    dyad_stats_record (DYAD_STATS_CONS_STORE, t0);
+    if (written_len != (ssize_t)len) {
+        DYAD_LOG_ERROR (ctx,
+                        "DYAD CLIENT: Failed to write %s at offset %zu with code %d:%s.",
+                        fpath,
+                        offset,
+                        errno,
+                        strerror (errno));
+        return DYAD_RC_BADFIO;
+    }
+    return DYAD_RC_OK;
+}
+
+/**
+ * @brief Writes file data retrieved from a producer to the consumer-managed directory.
+ *
+ * @details
+ * Stores @p data_len bytes of @p file_data to the appropriate path under the
+ * consumer-managed directory, as determined by combining @c ctx->cons_managed_path
+ * with the relative file path in @p mdata->fpath. Any intermediate directories
+ * that do not yet exist are created as needed.
+ *
+ * The data is written by @c dyad_cons_write_at() at @p offset in the file,
+ * so that a byte range retrieved by @c dyad_get_data_range() lands at its
+ * place.
+ *
+ * This function is an internal helper called by @c dyad_consume(),
+ * @c dyad_consume_w_metadata() and @c dyad_consume_range() after data has
+ * been retrieved from the producer via @c dyad_get_data() or
+ * @c dyad_get_data_range(). It is not intended to be called directly by users.
+ *
+ * @param[in] ctx        Pointer to the DYAD context. Must not be @c NULL. Used to
+ *                       resolve the consumer-managed path and check the @c check flag.
+ * @param[in] mdata      Metadata for the file being stored. Must not be @c NULL.
+ *                       @c mdata->fpath is appended to @c ctx->cons_managed_path to
+ *                       form the full destination path.
+ * @param[in] fd         Open, writable file descriptor for the destination file.
+ * @param[in] offset     File offset at which to write @p file_data.
+ * @param[in] data_len   Number of bytes to write from @p file_data.
+ * @param[in] file_data  Buffer containing the file data to write. Must be at least
+ *                       @p data_len bytes in size.
+ *
+ * @return @c dyad_rc_t return code indicating the outcome:
+ * @retval DYAD_RC_OK      All @p data_len bytes were successfully written.
+ * @retval DYAD_RC_BADFIO  Directory creation failed or a write failed.
+ *
+ * @note If the operation succeeds and @c ctx->check is set, the environment
+ *       variable @c DYAD_CHECK_ENV is set to @c "ok".
+ */
+DYAD_CORE_FUNC_MODS dyad_rc_t dyad_cons_store (const dyad_ctx_t *restrict ctx,
+                                               const dyad_metadata_t *restrict mdata,
+                                               int fd,
+                                               const size_t offset,
+                                               const size_t data_len,
+                                               char *restrict file_data)
+{
+    DYAD_C_FUNCTION_START ();
+    DYAD_C_FUNCTION_UPDATE_INT ("fd", fd);
+    dyad_rc_t rc = DYAD_RC_OK;
+    const char *odir = NULL;
+    char file_path[PATH_MAX + 1] = {'\0'};
+    char file_path_copy[PATH_MAX + 1] = {'\0'};
+    mode_t m = (S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH | S_ISGID);
+    memset (file_path, 0, PATH_MAX + 1);
+    memset (file_path_copy, 0, PATH_MAX + 1);
+
+    // Build the full path to the file being consumed
+    strncpy (file_path, ctx->cons_managed_path, PATH_MAX - 1);
+    concat_str (file_path, mdata->fpath, "/", PATH_MAX);
+    memcpy (file_path_copy, file_path, PATH_MAX);  // dirname modifies the arg
+    DYAD_C_FUNCTION_UPDATE_STR ("cons_managed_path", ctx->cons_managed_path);
+    DYAD_C_FUNCTION_UPDATE_STR ("fpath", mdata->fpath);
+    DYAD_C_FUNCTION_UPDATE_STR ("file_path_copy", file_path_copy);
+
+    DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Saving retrieved data to %s", file_path);
+    // Create the directory as needed
+    // TODO: Need to be consistent with the mode at the source
+    odir = dirname (file_path_copy);
+    if ((strncmp (odir, ".", strlen (".")) != 0) && (mkdir_as_needed (odir, m) < 0)) {
+        DYAD_LOG_ERROR (ctx, "DYAD CLIENT: Cannot create needed directories for pulled file");
+        rc = DYAD_RC_BADFIO;
+        goto pull_done;
+    }
+
+    // Reserve the blocks first so that the file is not extended piecemeal
+    dyad_store_prealloc (fd, (off_t)offset, data_len);
+    // Write the file contents to the location specified by the user
+    rc = dyad_cons_write_at (ctx, fd, file_data, data_len, offset, file_path);
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (ctx, "DYAD CLIENT: cons store write of pulled file failed!\n");
+        goto pull_done;
+    }
+    DYAD_C_FUNCTION_UPDATE_INT ("data_len", data_len);
+    rc = DYAD_RC_OK;
+
+pull_done:;
+    // If "check" is set and the operation was successful, set the
+    // DYAD_CHECK_ENV environment variable to "ok"
+    if (rc == DYAD_RC_OK && (ctx && ctx->check))
+        setenv (DYAD_CHECK_ENV, "ok", 1);
+    DYAD_C_FUNCTION_END ();
+    return rc;
+}
+
+/**
+ * @brief Tells whether files should be fetched with @c dyad_cons_store_chunked().
+ *
+ * @details
+ * Chunked transfers are used when @c ctx->transfer_chunk_size (set from
+ * @c DYAD_TRANSFER_CHUNK_SIZE) is non-zero and the @c FLUX_RPC DTL is in use.
+ * The UCX DTL already cuts every message into chunks that stream through
+ * the consumer's receive ring, and the Margo DTL keeps a single pending
+ * receive, so both receive one message per request and whole files.
+ *
+ * @param[in] ctx  Pointer to the DYAD context. Must not be @c NULL.
+ *
+ * @return @c true if the chunked transfer path should be used.
+ */
+static inline bool dyad_use_chunked_transfer (const dyad_ctx_t *restrict ctx)
+{
+    return (ctx->transfer_chunk_size > 0ul) && (ctx->dtl_handle != NULL)
+           && (ctx->dtl_handle->mode == DYAD_DTL_FLUX_RPC);
+}
+
+/**
+ * @brief Reserves the blocks of a file about to be fetched.
+ *
+ * @details
+ * When the KVS record of the file carries its size, the blocks are
+ * allocated up front with @c dyad_store_prealloc(), so that the writes of
+ * the transfer do not extend the file piecemeal. The apparent size is left
+ * unchanged, so a file whose transfer fails is not mistaken for a complete
+ * one. A file system without @c fallocate() support is left as is.
+ *
+ * @param[in] ctx    Pointer to the DYAD context. Must not be @c NULL.
+ * @param[in] mdata  Metadata for the file to retrieve. Must not be @c NULL.
+ * @param[in] fd     Destination file, opened for writing.
+ */
+DYAD_CORE_FUNC_MODS void dyad_prealloc (const dyad_ctx_t *restrict ctx,
+                                        const dyad_metadata_t *restrict mdata,
+                                        int fd)
+{
+    if (!(mdata->flags & DYAD_MDATA_HAS_SIZE)) {
+        return;
+    }
+    if (dyad_store_prealloc (fd, 0, (size_t)mdata->file_size) != 0) {
+        DYAD_LOG_DEBUG (ctx,
+                        "DYAD CLIENT: Cannot preallocate %" PRIu64 " bytes for %s: %s",
+                        mdata->file_size,
+                        mdata->fpath,
+                        strerror (errno));
+    }
+}
+
+/**
+ * @brief Asks the module of the owner of a file for its size.
+ *
+ * @param[in]  ctx        Pointer to the DYAD context. Must not be @c NULL.
+ * @param[in]  mdata      Metadata for the file to retrieve. Must not be @c NULL.
+ * @param[out] file_size  Set to the size of the file on success.
+ *
+ * @return @c false if the module did not serve the @c DYAD_STAT_RPC_NAME
+ *         request, e.g., an older one.
+ */
+DYAD_CORE_FUNC_MODS bool dyad_stat_remote (const dyad_ctx_t *restrict ctx,
+                                           const dyad_metadata_t *restrict mdata,
+                                           size_t *restrict file_size)
+{
+    flux_future_t *f = NULL;
+    json_int_t size = 0;
+
+    f = flux_rpc_pack ((flux_t *)ctx->h,
+                       DYAD_STAT_RPC_NAME,
+                       mdata->owner_rank,
+                       0,
+                       "{s:s}",
+                       "upath",
+                       mdata->fpath);
+    if (f == NULL || flux_rpc_get_unpack (f, "{s:I}", "size", &size) < 0 || size < 0) {
+        DYAD_LOG_DEBUG (ctx,
+                        "DYAD CLIENT: Cannot get the size of %s from broker %u",
+                        mdata->fpath,
+                        mdata->owner_rank);
+        flux_future_destroy (f);
+        return false;
+    }
+    flux_future_destroy (f);
+    *file_size = (size_t)size;
+    return true;
+}
+
+/**
+ * @brief Sends the request for a byte range of a chunked transfer.
+ *
+ * @param[in]  ctx     Pointer to the DYAD context. Must not be @c NULL.
+ * @param[in]  mdata   Metadata for the file to retrieve. Must not be @c NULL.
+ * @param[in]  offset  Offset of the range in the file.
+ * @param[in]  length  Length of the range, or 0 for the rest of the file.
+ * @param[out] f       Set to the future of the streaming RPC.
+ *
+ * @return @c dyad_rc_t return code indicating the outcome:
+ * @retval DYAD_RC_OK       The request was sent.
+ * @retval DYAD_RC_BADPACK  The range or chunk size could not be added to the
+ *                          payload.
+ * @retval DYAD_RC_BADRPC   The RPC could not be sent.
+ * @retval DYAD_RC_*        Any error code propagated from
+ *                          @c dtl_handle->rpc_pack() or @c dyad_pack_codec().
+ */
+static dyad_rc_t dyad_chunked_request (const dyad_ctx_t *restrict ctx,
+                                       const dyad_metadata_t *restrict mdata,
+                                       size_t offset,
+                                       size_t length,
+                                       flux_future_t **restrict f)
+{
+    dyad_rc_t rc = DYAD_RC_OK;
+    json_t *rpc_payload = NULL;
+
+    rc = ctx->dtl_handle->rpc_pack (ctx, mdata->fpath, mdata->owner_rank, &rpc_payload);
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (ctx, "Cannot create JSON payload for Flux RPC to DYAD module\n");
+        return rc;
+    }
+    if ((offset > 0ul || length > 0ul)
+        && (json_object_set_new (rpc_payload, "offset", json_integer ((json_int_t)offset)) < 0
+            || json_object_set_new (rpc_payload, "length", json_integer ((json_int_t)length))
+                   < 0)) {
+        DYAD_LOG_ERROR (ctx, "Cannot add the byte range to the RPC payload\n");
+        json_decref (rpc_payload);
+        return DYAD_RC_BADPACK;
+    }
+    if (json_object_set_new (rpc_payload,
+                             "chunk_size",
+                             json_integer ((json_int_t)ctx->transfer_chunk_size))
+        < 0) {
+        DYAD_LOG_ERROR (ctx, "Cannot add the chunk size to the RPC payload\n");
+        json_decref (rpc_payload);
+        return DYAD_RC_BADPACK;
+    }
+    rc = dyad_pack_codec (ctx, rpc_payload);
+    if (DYAD_IS_ERROR (rc)) {
+        json_decref (rpc_payload);
+        return rc;
+    }
+    *f = flux_rpc_pack ((flux_t *)ctx->h,
+                        DYAD_DTL_RPC_NAME,
+                        mdata->owner_rank,
+                        FLUX_RPC_STREAMING,
+                        "o",
+                        rpc_payload);
+    if (*f == NULL) {
+        DYAD_LOG_ERROR (ctx, "Cannot send RPC to producer module.");
+        return DYAD_RC_BADRPC;
+    }
+    return DYAD_RC_OK;
+}
+
+/**
+ * @brief Retrieves a file from the producer as a stream of chunks and writes
+ *        each chunk to @p fname as it arrives.
+ *
+ * @details
+ * Streaming counterpart of @c dyad_get_data() followed by
+ * @c dyad_cons_store(). The RPC payload additionally carries
+ * @c ctx->transfer_chunk_size under the @c "chunk_size" key, which asks the
+ * producer's DYAD module to send the file as a series of responses of at
+ * most that many bytes, followed by the usual end-of-stream (@c ENODATA)
+ * message.
+ *
+ * Each chunk is written by @c dyad_cons_write_at() at its offset in
+ * @p fname, and its buffer is returned to the DTL before the next one is
+ * received. Flux keeps delivering the following responses to the handle
+ * while a chunk is being written, so the disk writes of the consumer
+ * overlap with the network transfer and the reads of the producer.
+ *
+ * Flux has no flow control of its own, so the file is requested in byte
+ * ranges of half of @c ctx->transfer_window chunks each, with two ranges
+ * in flight: the range after next is only requested once the oldest one
+ * was written. A consumer writing slower than the module reads thus holds
+ * at most @c ctx->transfer_window chunks, rather than the rest of the
+ * file, queued on its handle. The size of the file is taken from its KVS
+ * record or asked with @c dyad_stat_remote(). The last range is requested
+ * up to the end of the file, so that data appended since is fetched too,
+ * and a range shorter than requested ends the transfer. A file of unknown
+ * size, a file of a single range, or a window of 0 is requested at once.
+ *
+ * A module that does not know the @c "chunk_size" key ignores it and sends
+ * each range as a single response, which is simply handled as a stream of
+ * one chunk.
+ *
+ * With compression enabled, every chunk is compressed on its own by the
+ * module and decoded here before being written.
+ *
+ * @param[in]  ctx       Pointer to the DYAD context. Must not be @c NULL.
+ * @param[in]  mdata     Metadata for the file to retrieve. Must not be @c NULL.
+ * @param[in]  fname     Path of the destination file, which must already exist.
+ * @param[out] file_len  Set to the number of bytes written to @p fname.
+ *
+ * @return @c dyad_rc_t return code indicating the outcome:
+ * @retval DYAD_RC_OK       The whole file was received and written.
+ * @retval DYAD_RC_BADPACK  The range or chunk size could not be added to the
+ *                          payload.
+ * @retval DYAD_RC_BADRPC   An RPC operation failed or the module reported an
+ *                          error.
+ * @retval DYAD_RC_BADFIO   @p fname could not be opened or closed, or a
+ *                          write failed.
+ * @retval DYAD_RC_*        Any error code propagated from
+ *                          @c dtl_handle->rpc_pack(),
+ *                          @c dtl_handle->rpc_recv_response(),
+ *                          @c dtl_handle->establish_connection(), or
+ *                          @c dtl_handle->recv().
+ *
+ * @note If the operation succeeds and @c ctx->check is set, the environment
+ *       variable @c DYAD_CHECK_ENV is set to @c "ok", as in @c dyad_cons_store().
+ */
+DYAD_CORE_FUNC_MODS dyad_rc_t dyad_cons_store_chunked (const dyad_ctx_t *restrict ctx,
+                                                       const dyad_metadata_t *restrict mdata,
+                                                       const char *restrict fname,
+                                                       size_t *restrict file_len)
+{
+    DYAD_C_FUNCTION_START ();
+    dyad_rc_t rc = DYAD_RC_OK;
+    // Ranges in flight, oldest first, and the length requested for each,
+    // 0 for the rest of the file
+    flux_future_t *f[2] = {NULL, NULL};
+    size_t range_len[2] = {0ul, 0ul};
+    size_t range_got = 0ul;
+    size_t window_len = 0ul;
+    size_t file_size = 0ul;
+    size_t next_offset = 0ul;
+    bool requested_all = false;
+    bool connected = false;
+    unsigned i = 0u;
+    char *chunk = NULL;
+    size_t chunk_len = 0ul;
+    uint64_t t0 = 0ull;
+    int fd = -1;
+
+    *file_len = 0ul;
+    DYAD_C_FUNCTION_UPDATE_INT ("owner_rank", mdata->owner_rank);
+    DYAD_C_FUNCTION_UPDATE_STR ("fpath", mdata->fpath);
+    DYAD_C_FUNCTION_UPDATE_INT ("chunk_size", ctx->transfer_chunk_size);
+    DYAD_C_FUNCTION_UPDATE_INT ("window", ctx->transfer_window);
+    fd = open (fname, O_WRONLY);
+    DYAD_C_FUNCTION_UPDATE_INT ("io_fd", fd);
+    if (fd == -1) {
+        DYAD_LOG_ERROR (ctx, "Cannot open file (%s) in write mode for dyad_consume!\n", fname);
+        rc = DYAD_RC_BADFIO;
+        goto get_chunked_done;
+    }
+    dyad_prealloc (ctx, mdata, fd);
+    if (ctx->transfer_window > 0u) {
+        if (mdata->flags & DYAD_MDATA_HAS_SIZE) {
+            file_size = (size_t)mdata->file_size;
+            window_len = ctx->transfer_chunk_size;
+        } else if (dyad_stat_remote (ctx, mdata, &file_size)) {
+            window_len = ctx->transfer_chunk_size;
+        }
+        if (ctx->transfer_window > 3u) {
+            window_len *= (size_t)(ctx->transfer_window / 2u);
+        }
+    }
+    t0 = dyad_stats_now ();
+    for (i = 0u; i < 2u && !requested_all; i++) {
+        if (window_len == 0ul || file_size - next_offset <= window_len) {
+            range_len[i] = 0ul;
+            requested_all = true;
+        } else {
+            range_len[i] = window_len;
+        }
+        rc = dyad_chunked_request (ctx, mdata, next_offset, range_len[i], &f[i]);
+        if (DYAD_IS_ERROR (rc)) {
+            goto get_chunked_done;
+        }
+        next_offset += range_len[i];
+    }
+    for (;;) {
+        rc = ctx->dtl_handle->rpc_recv_response (ctx, f[0]);
+        if (DYAD_IS_ERROR (rc)) {
+            DYAD_LOG_ERROR (ctx, "Cannot receive and/or parse the RPC response.");
+            break;
+        }
+        if (!connected) {
+            rc = ctx->dtl_handle->establish_connection (ctx);
+            if (DYAD_IS_ERROR (rc)) {
+                DYAD_LOG_ERROR (ctx,
+                                "Cannot establish connection with DYAD module on broker %u.",
+                                mdata->owner_rank);
+                break;
+            }
+            connected = true;
+            dyad_stats_record (DYAD_STATS_RPC_SETUP, t0);
+        }
+        range_got = 0ul;
+        for (;;) {
+            t0 = dyad_stats_now ();
+            rc = ctx->dtl_handle->recv (ctx, (void **)&chunk, &chunk_len);
+            dyad_stats_record (DYAD_STATS_DTL_RECV, t0);
+            if (rc == DYAD_RC_RPC_FINISHED) {
+                rc = DYAD_RC_OK;
+                break;
+            }
+            if (DYAD_IS_ERROR (rc)) {
+                DYAD_LOG_ERROR (ctx, "Cannot receive data from producer module.");
+                break;
+            }
+            rc = dyad_decode_frame (ctx, &chunk, &chunk_len);
+            if (DYAD_IS_ERROR (rc)) {
+                ctx->dtl_handle->return_buffer (ctx, (void **)&chunk);
+                break;
+            }
+            rc = dyad_cons_write_at (ctx, fd, chunk, chunk_len, *file_len, mdata->fpath);
+            ctx->dtl_handle->return_buffer (ctx, (void **)&chunk);
+            if (DYAD_IS_ERROR (rc)) {
+                break;
+            }
+            *file_len += chunk_len;
+            range_got += chunk_len;
+        }
+        // The last range, or one cut short because the file shrank since its
+        // size was taken, ends the transfer
+        if (DYAD_IS_ERROR (rc) || range_len[0] == 0ul || range_got < range_len[0]) {
+            break;
+        }
+        flux_future_destroy (f[0]);
+        f[0] = f[1];
+        range_len[0] = range_len[1];
+        f[1] = NULL;
+        if (!requested_all) {
+            if (file_size - next_offset <= window_len) {
+                range_len[1] = 0ul;
+                requested_all = true;
+            } else {
+                range_len[1] = window_len;
+            }
+            rc = dyad_chunked_request (ctx, mdata, next_offset, range_len[1], &f[1]);
+            if (DYAD_IS_ERROR (rc)) {
+                break;
+            }
+            next_offset += range_len[1];
+        }
+    }
+    ctx->dtl_handle->close_connection (ctx);
+    DYAD_C_FUNCTION_UPDATE_INT ("file_len", *file_len);
+
+get_chunked_done:;
+    DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Wrote %zu bytes of %s file", *file_len, mdata->fpath);
+    flux_future_destroy (dyad_fetch_future (ctx, f[0]));
+    flux_future_destroy (f[1]);
+    if (fd != -1 && close (fd) != 0) {
+        rc = DYAD_RC_BADFIO;
+    }
+    if (DYAD_IS_ERROR (rc)) {
+        dyad_uncache_mdata (ctx, mdata->fpath);
+    }
+    if (rc == DYAD_RC_OK && ctx->check)
+        setenv (DYAD_CHECK_ENV, "ok", 1);
+    DYAD_C_FUNCTION_END ();
+    return rc;
+}
+
+/**
+ * @brief Decides in how many byte ranges a file is fetched concurrently.
+ *
+ * @details
+ * Striping is enabled by @c ctx->stripe_threshold (set from
+ * @c DYAD_STRIPE_THRESHOLD). The size of the file is taken from its KVS
+ * record or, for a record without it, asked to the module of its owner with
+ * @c dyad_stat_remote(). A file of at least the threshold is split into as
+ * many stripes as it holds halves of the threshold, up to
+ * @c ctx->stripe_count. A file of unknown size is left on a single stream.
+ *
+ * @param[in]  ctx        Pointer to the DYAD context. Must not be @c NULL.
+ * @param[in]  mdata      Metadata for the file to retrieve. Must not be @c NULL.
+ * @param[out] file_size  Set to the size of the file if striped.
+ *
+ * @return Number of stripes, or 1 to fetch the file over a single stream.
+ */
+DYAD_CORE_FUNC_MODS unsigned dyad_stripe_count (const dyad_ctx_t *restrict ctx,
+                                                const dyad_metadata_t *restrict mdata,
+                                                size_t *restrict file_size)
+{
+    size_t stripes = 1ul;
+
+    if (ctx->stripe_threshold == 0ul || ctx->stripe_count < 2u || ctx->dtl_handle == NULL) {
+        return 1u;
+    }
+    if (mdata->flags & DYAD_MDATA_HAS_SIZE) {
+        *file_size = (size_t)mdata->file_size;
+    } else if (!dyad_stat_remote (ctx, mdata, file_size)) {
+        return 1u;
+    }
+    if (*file_size < ctx->stripe_threshold) {
+        return 1u;
+    }
+    stripes = *file_size / ((ctx->stripe_threshold + 1ul) / 2ul);
+    if (stripes > (size_t)ctx->stripe_count) {
+        stripes = (size_t)ctx->stripe_count;
+    }
+    DYAD_LOG_DEBUG (ctx,
+                    "DYAD CLIENT: Fetching %zu bytes of %s in %zu stripes",
+                    *file_size,
+                    mdata->fpath,
+                    stripes);
+    return (unsigned)stripes;
+}
+
+/**
+ * @brief One byte range of a striped transfer.
+ */
+typedef struct dyad_stripe {
+    const dyad_metadata_t *mdata;  ///< File to fetch.
+    int fd;                        ///< Destination file, opened for writing.
+    size_t offset;                 ///< First byte of the range.
+    size_t length;                 ///< Number of bytes of the range.
+    bool started;                  ///< Whether a stripe worker took the range.
+    dyad_rc_t rc;                  ///< Outcome of the transfer.
+} dyad_stripe_t;
+
+/**
+ * @brief Retrieves the byte range of @p stripe with @c dyad_get_data_range()
+ *        and writes it at its offset in the destination file.
+ *
+ * @param[in] ctx     DYAD context of the calling thread.
+ * @param[in] stripe  Range to fetch.
+ *
+ * @return @c DYAD_RC_OK, @c DYAD_RC_BADFIO if the producer sent fewer bytes
+ *         than requested or a write failed, or the error of
+ *         @c dyad_get_data_range().
+ */
+DYAD_CORE_FUNC_MODS dyad_rc_t dyad_fetch_stripe (const dyad_ctx_t *restrict ctx,
+                                                 const dyad_stripe_t *restrict stripe)
+{
+    dyad_rc_t rc = DYAD_RC_OK;
+    char *data = NULL;
+    size_t data_len = 0ul;
+
+    rc = dyad_get_data_range (ctx, stripe->mdata, stripe->offset, stripe->length, &data, &data_len);
+    if (!DYAD_IS_ERROR (rc) && data_len != stripe->length) {
+        DYAD_LOG_ERROR (ctx,
+                        "DYAD CLIENT: Received %zu of %zu bytes of %s at offset %zu",
+                        data_len,
+                        stripe->length,
+                        stripe->mdata->fpath,
+                        stripe->offset);
+        rc = DYAD_RC_BADFIO;
+    }
+    if (!DYAD_IS_ERROR (rc)) {
+        rc = dyad_cons_write_at (ctx,
+                                 stripe->fd,
+                                 data,
+                                 data_len,
+                                 stripe->offset,
+                                 stripe->mdata->fpath);
+    }
+    if (data != NULL) {
+        ctx->dtl_handle->return_buffer (ctx, (void **)&data);
+    }
+    return rc;
+}
+
+/**
+ * @brief Task of a stripe worker, fetching one range with the DYAD context
+ *        of the worker.
+ *
+ * @details
+ * Flux handles and DTL connections cannot be shared between threads, so
+ * each worker of @c ctx->stripe_pool set up its own context with
+ * @c dyad_ctx_attach() when it started, and keeps it, with its connections,
+ * for every range it fetches until the pool is destroyed.
+ */
+static void dyad_stripe_task (void *arg)
+{
+    dyad_stripe_t *stripe = (dyad_stripe_t *)arg;
+    dyad_ctx_t *worker_ctx = dyad_ctx_get ();
+
+    if (worker_ctx == NULL || worker_ctx->h == NULL || worker_ctx->dtl_handle == NULL) {
+        stripe->rc = DYAD_RC_NOCTX;
+        return;
+    }
+    worker_ctx->reenter = false;
+    stripe->rc = dyad_fetch_stripe (worker_ctx, stripe);
+    worker_ctx->reenter = true;
+}
+
+/**
+ * @brief Retrieves a file as several byte ranges transferred concurrently
+ *        and writes each to @p fname at its offset.
+ *
+ * @details
+ * Counterpart of @c dyad_get_data() followed by @c dyad_cons_store() for
+ * files that @c dyad_stripe_count() splits into @p stripes ranges. The
+ * ranges are of equal length, rounded up to a multiple of the page size.
+ * The calling thread fetches the first one with @p ctx, and the others are
+ * handed to the workers of @c ctx->stripe_pool, so that every range
+ * travels over its own RPC stream and DTL connection and is written with
+ * @c pwrite() as soon as it arrives. A range no worker takes, or whose
+ * worker could not set up its context, is fetched by the calling thread
+ * afterwards.
+ *
+ * The blocks of @p fname are reserved with @c dyad_prealloc() before any
+ * range is written.
+ *
+ * @param[in]  ctx        Pointer to the DYAD context. Must not be @c NULL.
+ * @param[in]  mdata      Metadata for the file to retrieve. Must not be @c NULL.
+ * @param[in]  fname      Path of the destination file, which must already exist.
+ * @param[in]  file_size  Size of the file, as returned by @c dyad_stripe_count().
+ * @param[in]  stripes    Number of ranges, as returned by @c dyad_stripe_count().
+ * @param[out] file_len   Set to the number of bytes written to @p fname.
+ *
+ * @return @c dyad_rc_t return code indicating the outcome:
+ * @retval DYAD_RC_OK       The whole file was received and written.
+ * @retval DYAD_RC_SYSFAIL  The ranges could not be allocated.
+ * @retval DYAD_RC_BADFIO   @p fname could not be opened or closed, a
+ *                          range was cut short or a write failed.
+ * @retval DYAD_RC_*        The first error of @c dyad_get_data_range() among
+ *                          the ranges.
+ *
+ * @note If the operation succeeds and @c ctx->check is set, the environment
+ *       variable @c DYAD_CHECK_ENV is set to @c "ok", as in @c dyad_cons_store().
+ */
+DYAD_CORE_FUNC_MODS dyad_rc_t dyad_cons_store_striped (const dyad_ctx_t *restrict ctx,
+                                                       const dyad_metadata_t *restrict mdata,
+                                                       const char *restrict fname,
+                                                       size_t file_size,
+                                                       unsigned stripes,
+                                                       size_t *restrict file_len)
+{
+    DYAD_C_FUNCTION_START ();
+    dyad_rc_t rc = DYAD_RC_OK;
+    dyad_stripe_t *stripe = NULL;
+    const size_t page_size = (size_t)sysconf (_SC_PAGESIZE);
+    size_t stripe_len = 0ul;
+    unsigned i = 0u;
+    int fd = -1;
+    dyad_work_group_t group;
+    bool grouped = false;
+
+    *file_len = 0ul;
+    DYAD_C_FUNCTION_UPDATE_INT ("owner_rank", mdata->owner_rank);
+    DYAD_C_FUNCTION_UPDATE_STR ("fpath", mdata->fpath);
+    DYAD_C_FUNCTION_UPDATE_INT ("stripes", stripes);
+    stripe_len = (file_size + stripes - 1ul) / stripes;
+    stripe_len = ((stripe_len + page_size - 1ul) / page_size) * page_size;
+    stripes = (unsigned)((file_size + stripe_len - 1ul) / stripe_len);
+    stripe = (dyad_stripe_t *)calloc (stripes, sizeof (dyad_stripe_t));
+    if (stripe == NULL) {
+        rc = DYAD_RC_SYSFAIL;
+        goto get_striped_done;
+    }
+    fd = open (fname, O_WRONLY);
+    DYAD_C_FUNCTION_UPDATE_INT ("io_fd", fd);
+    if (fd == -1) {
+        DYAD_LOG_ERROR (ctx, "Cannot open file (%s) in write mode for dyad_consume!\n", fname);
+        rc = DYAD_RC_BADFIO;
+        goto get_striped_done;
+    }
+    dyad_prealloc (ctx, mdata, fd);
+    for (i = 0u; i < stripes; i++) {
+        stripe[i].mdata = mdata;
+        stripe[i].fd = fd;
+        stripe[i].offset = i * stripe_len;
+        stripe[i].length = (i + 1u == stripes) ? (file_size - stripe[i].offset) : stripe_len;
+        stripe[i].rc = DYAD_RC_OK;
+    }
+    grouped = (ctx->stripe_pool != NULL && dyad_work_group_init (&group) == 0);
+    for (i = 1u; grouped && i < stripes; i++) {
+        stripe[i].started = (dyad_worker_pool_submit ((dyad_worker_pool_t *)ctx->stripe_pool,
+                                                      &group,
+                                                      dyad_stripe_task,
+                                                      &stripe[i])
+                             == 0);
+    }
+    stripe[0].rc = dyad_fetch_stripe (ctx, &stripe[0]);
+    if (grouped) {
+        dyad_work_group_wait (&group);
+    }
+    for (i = 1u; i < stripes; i++) {
+        if (!stripe[i].started || stripe[i].rc == DYAD_RC_NOCTX) {
+            DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Fetching stripe %u of %s inline", i, mdata->fpath);
+            stripe[i].rc = dyad_fetch_stripe (ctx, &stripe[i]);
+        }
+    }
+    for (i = 0u; i < stripes; i++) {
+        if (DYAD_IS_ERROR (stripe[i].rc)) {
+            DYAD_LOG_ERROR (ctx,
+                            "DYAD CLIENT: Stripe %u of %s failed with code %d",
+                            i,
+                            mdata->fpath,
+                            stripe[i].rc);
+            rc = stripe[i].rc;
+            goto get_striped_done;
+        }
+    }
+    *file_len = file_size;
+    DYAD_C_FUNCTION_UPDATE_INT ("file_len", *file_len);
+
+get_striped_done:;
+    DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Wrote %zu bytes of %s file", *file_len, mdata->fpath);
+    free (stripe);
+    if (fd != -1 && close (fd) != 0) {
+        rc = DYAD_RC_BADFIO;
+    }
+    if (DYAD_IS_ERROR (rc)) {
+        dyad_uncache_mdata (ctx, mdata->fpath);
+    }
+    if (rc == DYAD_RC_OK && ctx->check)
+        setenv (DYAD_CHECK_ENV, "ok", 1);
+    DYAD_C_FUNCTION_END ();
+    return rc;
+}
+
+/**
+ * @brief State of one file of a @c dyad_consume_batch() call.
+ */
+typedef struct dyad_batch_entry {
+    const char *fname;        ///< Path of the file as given by the caller.
+    dyad_metadata_t *mdata;   ///< Metadata of the file, or @c NULL if not to be fetched.
+    int lock_fd;              ///< Descriptor holding the exclusive lock, or -1.
+    struct flock lock;        ///< Exclusive lock held on @c lock_fd.
+    size_t received;          ///< Number of bytes written so far.
+    bool requested;           ///< Whether the file was included in a batch RPC.
+    bool done;                ///< Whether the whole file was received.
+} dyad_batch_entry_t;
+
+/**
+ * @brief Retrieves several files from the same producer in a single RPC
+ *        stream and DTL session.
+ *
+ * @details
+ * Sends one @c DYAD_DTL_BATCH_RPC_NAME request listing the @c fpath of
+ * every entry of @p batch to the producer's broker. For each file, the
+ * module answers with a header response giving its index in the request
+ * and either its size or an @c errno value, followed by its contents in
+ * one or more messages (see @c DYAD_TRANSFER_CHUNK_SIZE). The contents are
+ * written with @c dyad_cons_write_at() to the locked @c lock_fd of the
+ * entry as they arrive, and @c done is set once the whole file has been
+ * received.
+ *
+ * Entries left with @c done unset, i.e., files the module could not serve
+ * or that were cut off by an error, must be fetched on their own by the
+ * caller. Only supported with the @c FLUX_RPC DTL.
+ *
+ * @param[in]     ctx    Pointer to the DYAD context. Must not be @c NULL.
+ * @param[in,out] batch  Entries to fetch, all owned by the same broker rank.
+ * @param[in]     count  Number of entries in @p batch. Must be at least 1.
+ *
+ * @return @c dyad_rc_t return code indicating the outcome:
+ * @retval DYAD_RC_OK       The stream was completely received.
+ * @retval DYAD_RC_BADPACK  The RPC payload could not be built.
+ * @retval DYAD_RC_BADRPC   An RPC operation failed, the module does not
+ *                          support batches, or it sent an unexpected
+ *                          message.
+ * @retval DYAD_RC_BADFIO   A write failed.
+ * @retval DYAD_RC_*        Any error code propagated from the DTL.
+ */
+DYAD_CORE_FUNC_MODS dyad_rc_t dyad_get_batch (const dyad_ctx_t *restrict ctx,
+                                              dyad_batch_entry_t **restrict batch,
+                                              size_t count)
+{
+    DYAD_C_FUNCTION_START ();
+    dyad_rc_t rc = DYAD_RC_OK;
+    flux_future_t *f = NULL;
+    flux_future_t *next = NULL;
+    json_t *rpc_payload = NULL;
+    json_t *upaths = NULL;
+    dyad_batch_entry_t *entry = NULL;
+    char *chunk = NULL;
+    size_t chunk_len = 0ul;
+    size_t i = 0ul;
+    uint64_t t0 = 0ull;
+    int index = -1;
+    int errnum = 0;
+    json_int_t size = -1;
+    const uint32_t owner_rank = batch[0]->mdata->owner_rank;
+
+    DYAD_C_FUNCTION_UPDATE_INT ("owner_rank", owner_rank);
+    DYAD_C_FUNCTION_UPDATE_INT ("batch_size", count);
+    rc = ctx->dtl_handle->rpc_pack (ctx, batch[0]->mdata->fpath, owner_rank, &rpc_payload);
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (ctx, "Cannot create JSON payload for Flux RPC to DYAD module\n");
+        goto get_batch_done;
+    }
+    upaths = json_array ();
+    if (upaths == NULL || json_object_set_new (rpc_payload, "upaths", upaths) < 0) {
+        DYAD_LOG_ERROR (ctx, "Cannot add the file list to the RPC payload\n");
+        json_decref (rpc_payload);
+        rc = DYAD_RC_BADPACK;
+        goto get_batch_done;
+    }
+    for (i = 0ul; i < count; i++) {
+        if (json_array_append_new (upaths, json_string (batch[i]->mdata->fpath)) < 0) {
+            DYAD_LOG_ERROR (ctx, "Cannot add %s to the RPC payload\n", batch[i]->mdata->fpath);
+            json_decref (rpc_payload);
+            rc = DYAD_RC_BADPACK;
+            goto get_batch_done;
+        }
+        batch[i]->requested = true;
+    }
+    if (ctx->transfer_chunk_size > 0ul
+        && json_object_set_new (rpc_payload,
+                                "chunk_size",
+                                json_integer ((json_int_t)ctx->transfer_chunk_size))
+               < 0) {
+        DYAD_LOG_ERROR (ctx, "Cannot add the chunk size to the RPC payload\n");
+        json_decref (rpc_payload);
+        rc = DYAD_RC_BADPACK;
+        goto get_batch_done;
+    }
+    rc = dyad_pack_codec (ctx, rpc_payload);
+    if (DYAD_IS_ERROR (rc)) {
+        json_decref (rpc_payload);
+        goto get_batch_done;
+    }
+    DYAD_LOG_DEBUG (ctx,
+                    "DYAD CLIENT: Requesting a batch of %zu files from broker %u",
+                    count,
+                    owner_rank);
+    t0 = dyad_stats_now ();
+    f = flux_rpc_pack ((flux_t *)ctx->h,
+                       DYAD_DTL_BATCH_RPC_NAME,
+                       owner_rank,
+                       FLUX_RPC_STREAMING,
+                       "o",
+                       rpc_payload);
+    if (f == NULL) {
+        DYAD_LOG_ERROR (ctx, "Cannot send RPC to producer module.");
+        rc = DYAD_RC_BADRPC;
+        goto get_batch_done;
+    }
+    rc = ctx->dtl_handle->rpc_recv_response (ctx, f);
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (ctx, "Cannot receive and/or parse the RPC response.");
+        goto get_batch_done;
+    }
+    rc = ctx->dtl_handle->establish_connection (ctx);
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (ctx,
+                        "Cannot establish connection with DYAD module on broker %u.",
+                        owner_rank);
+        goto get_batch_done;
+    }
+    dyad_stats_record (DYAD_STATS_RPC_SETUP, t0);
+    for (;;) {
+        index = -1;
+        errnum = 0;
+        size = -1;
+        if (flux_rpc_get_unpack (f,
+                                 "{s:i s?I s?i}",
+                                 "index",
+                                 &index,
+                                 "size",
+                                 &size,
+                                 "errnum",
+                                 &errnum)
+            < 0) {
+            // The DTL may send the request again if the producer rejects it as stale
+            if (errno == ESTALE && (next = dyad_fetch_future (ctx, f)) != f) {
+                f = next;
+                continue;
+            }
+            if (errno == ENODATA) {
+                rc = DYAD_RC_OK;
+            } else {
+                DYAD_LOG_ERROR (ctx,
+                                "Batch RPC to broker %u failed (errno = %d).",
+                                owner_rank,
+                                errno);
+                rc = DYAD_RC_BADRPC;
+            }
+            break;
+        }
+        flux_future_reset (f);
+        if (index < 0 || (size_t)index >= count) {
+            DYAD_LOG_ERROR (ctx, "Unexpected file index %d in batch RPC response.", index);
+            rc = DYAD_RC_BADRPC;
+            break;
+        }
+        entry = batch[index];
+        if (errnum != 0 || size < 0) {
+            DYAD_LOG_DEBUG (ctx,
+                            "DYAD CLIENT: Module could not send %s (errno = %d)",
+                            entry->mdata->fpath,
+                            errnum);
+            continue;
+        }
+        while (entry->received < (size_t)size) {
+            t0 = dyad_stats_now ();
+            rc = ctx->dtl_handle->recv (ctx, (void **)&chunk, &chunk_len);
+            dyad_stats_record (DYAD_STATS_DTL_RECV, t0);
+            if (DYAD_IS_ERROR (rc)) {
+                DYAD_LOG_ERROR (ctx, "Cannot receive data from producer module.");
+                rc = DYAD_RC_BADRPC;
+                goto get_batch_close;
+            }
+            rc = dyad_decode_frame (ctx, &chunk, &chunk_len);
+            if (DYAD_IS_ERROR (rc)) {
+                ctx->dtl_handle->return_buffer (ctx, (void **)&chunk);
+                goto get_batch_close;
+            }
+            rc = dyad_cons_write_at (ctx,
+                                     entry->lock_fd,
+                                     chunk,
+                                     chunk_len,
+                                     entry->received,
+                                     entry->mdata->fpath);
+            ctx->dtl_handle->return_buffer (ctx, (void **)&chunk);
+            if (DYAD_IS_ERROR (rc)) {
+                goto get_batch_close;
+            }
+            entry->received += chunk_len;
+        }
+        entry->done = true;
+    }
+
+get_batch_close:;
+    ctx->dtl_handle->close_connection (ctx);
+
+get_batch_done:;
+    flux_future_destroy (dyad_fetch_future (ctx, f));
+    DYAD_C_FUNCTION_END ();
+    return rc;
+}
+
+/**
+ * @brief Identity of a fetched file, as stored in its coalescing record.
+ *
+ * @details
+ * See @c dyad_coalesce_lock(). A record matches the destination file only
+ * while the file keeps the same device, inode, size, modification time
+ * and status change time, so that a file truncated, replaced or rewritten
+ * since it was fetched is fetched again.
+ */
+typedef struct dyad_coalesce_record {
+    dev_t dev;              ///< Device of the fetched file.
+    ino_t ino;              ///< Inode of the fetched file.
+    off_t size;             ///< Size of the fetched file.
+    struct timespec mtim;   ///< Last modification of the fetched file.
+    struct timespec ctim;   ///< Last status change of the fetched file.
+} dyad_coalesce_record_t;
+
+/**
+ * @brief Locks the node-local coalescing record of @p upath.
+ *
+ * @details
+ * When @c ctx->coalesce_path is set (@c DYAD_COALESCE_PATH), consumers on
+ * the same node that request the same file serialize on an exclusive lock
+ * of a small record file in that directory, named after two hashes of
+ * @p upath. The first one to get the lock looks up the metadata of the
+ * file and fetches it, then writes the identity of the fetched file to the
+ * record with @c dyad_coalesce_update() before releasing the lock. Every
+ * waiter wakes up as soon as the lock is released, finds a record matching
+ * the destination file with @c dyad_coalesce_is_fetched(), and returns
+ * without a KVS lookup or a transfer of its own.
+ *
+ * Unlike the lock on the destination file, this lock is never requested
+ * by producers, so it can be held while waiting for the KVS with shared
+ * storage. It is always taken after, and never while waiting for, the lock
+ * on the destination file.
+ *
+ * Coalescing is best effort: if the record cannot be opened or locked,
+ * the caller proceeds as if coalescing were disabled.
+ *
+ * @param[in]  ctx    Pointer to the DYAD context. Must not be @c NULL.
+ * @param[in]  upath  Path of the file relative to the consumer-managed path.
+ * @param[out] lock   Lock to pass to @c dyad_coalesce_unlock().
+ *
+ * @return The locked record file descriptor, or -1 if coalescing is
+ *         disabled or unavailable.
+ */
+DYAD_CORE_FUNC_MODS int dyad_coalesce_lock (const dyad_ctx_t *restrict ctx,
+                                            const char *restrict upath,
+                                            struct flock *restrict lock)
+{
+    DYAD_C_FUNCTION_START ();
+    char record_path[PATH_MAX + 1] = {'\0'};
+    mode_t m = (S_IRWXU | S_IRWXG | S_IRWXO | S_ISVTX);
+    int fd = -1;
+
+    if (ctx->coalesce_path == NULL) {
+        goto coalesce_lock_done;
+    }
+    snprintf (record_path,
+              PATH_MAX,
+              "%s/dyad_%08x%08x",
+              ctx->coalesce_path,
+              hash_str (upath, DYAD_SEED),
+              hash_str (upath, DYAD_SEED + 1u));
+    DYAD_C_FUNCTION_UPDATE_STR ("record_path", record_path);
+    if (mkdir_as_needed (ctx->coalesce_path, m) < 0) {
+        DYAD_LOG_ERROR (ctx, "Cannot create coalescing directory %s", ctx->coalesce_path);
+        goto coalesce_lock_done;
+    }
+    fd = open (record_path, O_RDWR | O_CREAT, 0666);
+    if (fd == -1) {
+        DYAD_LOG_ERROR (ctx, "Cannot open coalescing record %s", record_path);
+        goto coalesce_lock_done;
+    }
+    if (DYAD_IS_ERROR (dyad_excl_flock (ctx, fd, lock))) {
+        dyad_release_flock (ctx, fd, lock);
+        close (fd);
+        fd = -1;
+    }
+
+coalesce_lock_done:;
+    DYAD_C_FUNCTION_END ();
+    return fd;
+}
+
+/**
+ * @brief Releases a record locked by @c dyad_coalesce_lock().
+ *
+ * @param[in] ctx        Pointer to the DYAD context. Must not be @c NULL.
+ * @param[in] record_fd  Record file descriptor. Ignored if -1.
+ * @param[in] lock       Lock set by @c dyad_coalesce_lock().
+ */
+DYAD_CORE_FUNC_MODS void dyad_coalesce_unlock (const dyad_ctx_t *restrict ctx,
+                                               int record_fd,
+                                               struct flock *restrict lock)
+{
+    if (record_fd != -1) {
+        dyad_release_flock (ctx, record_fd, lock);
+        close (record_fd);
+    }
+}
+
+/**
+ * @brief Tells whether the locked record says that the file open as
+ *        @p fd has already been fetched on this node.
+ *
+ * @param[in] record_fd  Record file descriptor from @c dyad_coalesce_lock(),
+ *                       or -1.
+ * @param[in] fd         Open descriptor of the destination file.
+ *
+ * @return @c true if the record matches the current state of a non-empty
+ *         destination file.
+ */
+DYAD_CORE_FUNC_MODS bool dyad_coalesce_is_fetched (int record_fd, int fd)
+{
+    dyad_coalesce_record_t record;
+    struct stat st;
+
+    if (record_fd == -1 || fstat (fd, &st) != 0 || st.st_size <= 0) {
+        return false;
+    }
+    if (pread (record_fd, &record, sizeof (record), 0) != (ssize_t)sizeof (record)) {
+        return false;
+    }
+    return record.dev == st.st_dev && record.ino == st.st_ino && record.size == st.st_size
+           && record.mtim.tv_sec == st.st_mtim.tv_sec && record.mtim.tv_nsec == st.st_mtim.tv_nsec
+           && record.ctim.tv_sec == st.st_ctim.tv_sec && record.ctim.tv_nsec == st.st_ctim.tv_nsec;
+}
+
+/**
+ * @brief Records in the locked record that the file open as @p fd has
+ *        been fetched, so that the consumers waiting for the record lock
+ *        do not fetch it again.
+ *
+ * @param[in] ctx        Pointer to the DYAD context. Must not be @c NULL.
+ * @param[in] record_fd  Record file descriptor from @c dyad_coalesce_lock(),
+ *                       or -1.
+ * @param[in] fd         Open descriptor of the destination file, once its
+ *                       contents are complete.
+ */
+DYAD_CORE_FUNC_MODS void dyad_coalesce_update (const dyad_ctx_t *restrict ctx,
+                                               int record_fd,
+                                               int fd)
+{
+    dyad_coalesce_record_t record;
+    struct stat st;
+
+    if (record_fd == -1 || fstat (fd, &st) != 0) {
+        return;
+    }
+    memset (&record, 0, sizeof (record));
+    record.dev = st.st_dev;
+    record.ino = st.st_ino;
+    record.size = st.st_size;
+    record.mtim = st.st_mtim;
+    record.ctim = st.st_ctim;
+    if (pwrite (record_fd, &record, sizeof (record), 0) != (ssize_t)sizeof (record)) {
+        DYAD_LOG_ERROR (ctx, "Cannot update coalescing record (errno = %d)", errno);
+    }
+}
+
+/**
+ * @brief Name of the extended attribute marking a file that only holds
+ *        the byte ranges fetched by @c dyad_consume_range().
+ *
+ * @details
+ * Such a file has the size of the producer's file, so without the mark
+ * @c dyad_consume() would take it for a complete copy.
+ */
+#define DYAD_PARTIAL_XATTR "user.dyad.partial"
+
+/**
+ * @brief Tells whether the file open as @p fd only holds some byte ranges
+ *        of the producer's file.
+ *
+ * @param[in] fd  Open descriptor of the destination file.
+ *
+ * @return @c true if the file carries the @c DYAD_PARTIAL_XATTR mark.
+ */
+DYAD_CORE_FUNC_MODS bool dyad_is_partial (int fd)
+{
+    return fgetxattr (fd, DYAD_PARTIAL_XATTR, NULL, 0) >= 0;
+}
+
+/**
+ * @brief Marks the file open as @p fd as holding only some byte ranges of
+ *        the producer's file.
+ *
+ * @param[in] ctx  Pointer to the DYAD context. Must not be @c NULL.
+ * @param[in] fd   Open descriptor of the destination file.
+ *
+ * @return @c dyad_rc_t return code:
+ * @retval DYAD_RC_OK      The file is marked.
+ * @retval DYAD_RC_BADFIO  The file system does not support user extended
+ *                         attributes, or setting the mark failed.
+ */
+DYAD_CORE_FUNC_MODS dyad_rc_t dyad_set_partial (const dyad_ctx_t *restrict ctx, int fd)
+{
+    if (fsetxattr (fd, DYAD_PARTIAL_XATTR, "1", 1ul, 0) != 0) {
+        DYAD_LOG_ERROR (ctx,
+                        "Cannot mark file (fd %d) as partially fetched (errno = %d)",
+                        fd,
+                        errno);
+        return DYAD_RC_BADFIO;
+    }
+    return DYAD_RC_OK;
+}
+
+/**
+ * @brief Removes the mark set by @c dyad_set_partial() once the whole file
+ *        has been fetched.
+ *
+ * @param[in] fd  Open descriptor of the destination file.
+ */
+DYAD_CORE_FUNC_MODS void dyad_clear_partial (int fd)
+{
+    // ENODATA, i.e., the file is not marked, is the common case
+    fremovexattr (fd, DYAD_PARTIAL_XATTR);
+}
+
+/**
+ * @brief Checks whether a local file already holds the version of a file
+ *        described by its KVS record.
+ *
+ * @details
+ * Only a record just read from the KVS that carries a checksum is trusted,
+ * since a cached record or the one of an event may predate a republication,
+ * and the modification times of two nodes cannot be compared. The local
+ * copy is then current if it is not a partial transfer, has the size of
+ * the record and the checksum of its contents matches.
+ *
+ * @param[in] ctx    Pointer to the DYAD context. Must not be @c NULL.
+ * @param[in] mdata  Metadata for the file to retrieve. Must not be @c NULL.
+ * @param[in] fd     Local copy of the file, opened for reading.
+ *
+ * @return @c true if the file does not need to be fetched.
+ */
+DYAD_CORE_FUNC_MODS bool dyad_local_copy_is_current (const dyad_ctx_t *restrict ctx,
+                                                     const dyad_metadata_t *restrict mdata,
+                                                     int fd)
+{
+    const uint32_t required = DYAD_MDATA_FROM_KVS | DYAD_MDATA_HAS_SIZE | DYAD_MDATA_HAS_CHECKSUM;
+    struct stat st;
+    uint64_t checksum = 0ull;
+
+    if ((mdata->flags & required) != required || fd == -1 || fstat (fd, &st) != 0
+        || (uint64_t)st.st_size != mdata->file_size || dyad_is_partial (fd)) {
+        return false;
+    }
+    if (dyad_mdata_checksum (fd, mdata->file_size, mdata->block_size, &checksum) != 0
+        || checksum != mdata->checksum) {
+        return false;
+    }
+    DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Local copy of %s is current", mdata->fpath);
+    return true;
+}
+
+dyad_rc_t dyad_produce (dyad_ctx_t *restrict ctx, const char *restrict fname)
+{
+    DYAD_C_FUNCTION_START ();
+    DYAD_C_FUNCTION_UPDATE_STR ("fname", fname);
+    DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Executing dyad_produce");
+    dyad_rc_t rc = DYAD_RC_OK;
+    // If the context is not defined, then it is not valid.
+    // So, return DYAD_NOCTX
+    if (!ctx || !ctx->h) {
+        DYAD_LOG_ERROR (ctx, "DYAD CLIENT: No CTX found in dyad_produce");
+        rc = DYAD_RC_NOCTX;
+        goto produce_done;
+    }
+    // If the producer-managed path is NULL or empty, then the context is not
+    // valid for a producer operation. So, return DYAD_BADMANAGEDPATH
+    if (ctx->prod_managed_path == NULL) {
+        DYAD_LOG_ERROR (ctx, "DYAD CLIENT: No or empty producer managed path was found");
+        rc = DYAD_RC_BADMANAGEDPATH;
+        goto produce_done;
+    }
+    // If the context is valid, call dyad_commit to perform
+    // the producer operation
+    rc = dyad_commit (ctx, fname);
+produce_done:;
+    DYAD_C_FUNCTION_END ();
+    return rc;
+}
+
+dyad_rc_t dyad_produce_batch (dyad_ctx_t *restrict ctx, const char **fnames, size_t n)
+{
+    DYAD_C_FUNCTION_START ();
+    DYAD_C_FUNCTION_UPDATE_INT ("n", n);
+    dyad_rc_t rc = DYAD_RC_OK;
+    dyad_rc_t flush_rc = DYAD_RC_OK;
+    size_t i = 0ul;
+
+    if (!ctx || !ctx->h) {
+        DYAD_LOG_ERROR (ctx, "DYAD CLIENT: No CTX found in dyad_produce_batch");
+        rc = DYAD_RC_NOCTX;
+        goto produce_batch_done;
+    }
+    if (ctx->prod_managed_path == NULL) {
+        DYAD_LOG_ERROR (ctx, "DYAD CLIENT: No or empty producer managed path was found");
+        rc = DYAD_RC_BADMANAGEDPATH;
+        goto produce_batch_done;
+    }
+    if (fnames == NULL && n > 0ul) {
+        rc = DYAD_RC_BADBUF;
+        goto produce_batch_done;
+    }
+    for (i = 0ul; i < n && !DYAD_IS_ERROR (rc); i++) {
+        rc = dyad_commit_path (ctx, fnames[i], true);
+    }
+    // Commit whatever was added, even if a file failed
+    flush_rc = dyad_publish_flush (ctx);
+    if (!DYAD_IS_ERROR (rc)) {
+        rc = flush_rc;
+    }
+produce_batch_done:;
+    DYAD_C_FUNCTION_END ();
+    return rc;
+}
+
+dyad_rc_t dyad_flush (dyad_ctx_t *restrict ctx)
+{
+    if (!ctx || !ctx->h) {
+        return DYAD_RC_NOCTX;
+    }
+    return dyad_publish_flush (ctx);
+}
+
+/** This function is coupled with Python API. This populates `mdata' which
+ * is used by `dyad_consume_w_metadata ()'
+ */
+/**
+ * @brief Resolves @p fname for a metadata lookup, answering it right away
+ *        if the file already exists locally.
+ *
+ * @details
+ * Shared by @c dyad_get_metadata() and @c dyad_get_metadata_batch(). If
+ * the file can be opened, @p mdata is filled in with its path and the rank
+ * of this process, as there is nothing to look up. Otherwise @p upath and
+ * @p topic are set for the KVS lookup and @p need_lookup is set.
+ *
+ * @param[in]  ctx          Pointer to the DYAD context. Must not be @c NULL.
+ * @param[in]  fname        Path to the file, as accepted by
+ *                          @c dyad_get_metadata().
+ * @param[out] upath        Buffer of @c PATH_MAX + 1 zeroed bytes for the
+ *                          path relative to the consumer-managed directory.
+ * @param[out] topic        Buffer of @c PATH_MAX + 1 zeroed bytes for the
+ *                          KVS key.
+ * @param[out] mdata        Address of the metadata object to fill in for a
+ *                          local file, as in @c dyad_get_metadata().
+ * @param[out] need_lookup  Whether the KVS must be consulted.
+ *
+ * @return @c DYAD_RC_OK, or the error code documented in
+ *         @c dyad_get_metadata(). On error, @c *mdata may be partially
+ *         filled and is left to the caller to free.
+ */
+DYAD_CORE_FUNC_MODS dyad_rc_t dyad_resolve_metadata (dyad_ctx_t *restrict ctx,
+                                                     const char *restrict fname,
+                                                     char *restrict upath,
+                                                     char *restrict topic,
+                                                     dyad_metadata_t **restrict mdata,
+                                                     bool *restrict need_lookup)
+{
+    const size_t fname_len = strlen (fname);
+
+    *need_lookup = false;
+    if (fname_len == 0ul) {
+        DYAD_LOG_ERROR (ctx, "Filename length is zero");
+        return DYAD_RC_BADFIO;
+    }
+    if (ctx->relative_to_managed_path
+        && (strncmp (fname, DYAD_PATH_DELIM, ctx->delim_len)
+            != 0)) {  // fname is a relative path that is relative to the
+                      // cons_managed_path
+        memcpy (upath, fname, fname_len);
+    } else if (!cmp_canonical_path_prefix (ctx, false, fname, upath, PATH_MAX)) {
+        // Extract the path to the file specified by fname relative to the
+        // producer-managed path
+        // This relative path will be stored in upath
+        // DYAD_LOG_TRACE (ctx, "%s is not in the Consumer's managed path\n",
+        // fname);
+        // NOTE: This is different from what dyad_fetch/commit returns,
+        // which is DYAD_RC_OK such that dyad does not interfere accesses on
+        // non-managed directories.
+        return DYAD_RC_UNTRACKED;
+    }
+    DYAD_LOG_DEBUG (ctx,
+                    "DYAD CLIENT: Obtaining file path relative to consumer directory: %s",
+                    upath);
+
+    // check if file exist locally, if so skip kvs
+    int fd = open (fname, O_RDONLY);
+    if (fd != -1) {
+        close (fd);
+        if (mdata == NULL) {
+            DYAD_LOG_ERROR (ctx,
+                            "Metadata double pointer is NULL. "
+                            "Cannot correctly create metadata object");
+            return DYAD_RC_NOTFOUND;
+        }
+        if (*mdata != NULL) {
+            DYAD_LOG_DEBUG (ctx,
+                            "DYAD CLIENT: Metadata object is already allocated. Skipping "
+                            "allocation");
+        } else {
+            *mdata = (dyad_metadata_t *)malloc (sizeof (struct dyad_metadata));
+            if (*mdata == NULL) {
+                DYAD_LOG_ERROR (ctx, "Cannot allocate memory for metadata object");
+                return DYAD_RC_SYSFAIL;
+            }
+        }
+        (*mdata)->fpath = (char *)malloc (fname_len + 1);
+        if ((*mdata)->fpath == NULL) {
+            DYAD_LOG_ERROR (ctx, "Cannot allocate memory for fpath in metadata object");
+            return DYAD_RC_SYSFAIL;
+        }
+        memset ((*mdata)->fpath, '\0', fname_len + 1);
+        memcpy ((*mdata)->fpath, fname, fname_len);
+        (*mdata)->owner_rank = ctx->rank;
+        (*mdata)->flags = 0u;
+        return DYAD_RC_OK;
+    }
+
+    gen_path_key (upath, topic, PATH_MAX, ctx->key_depth, ctx->key_bins);
+    DYAD_LOG_INFO (ctx, "Generated KVS key: %s", topic);
+    *need_lookup = true;
+    return DYAD_RC_OK;
+}
+
+dyad_rc_t dyad_get_metadata (dyad_ctx_t *restrict ctx,
+                             const char *restrict fname,
+                             bool should_wait,
+                             dyad_metadata_t **restrict mdata)
+{
+    DYAD_C_FUNCTION_START ();
+    DYAD_C_FUNCTION_UPDATE_STR ("fname", fname);
+    DYAD_C_FUNCTION_UPDATE_INT ("should_wait", should_wait);
+    dyad_rc_t rc = DYAD_RC_OK;
+    char upath[PATH_MAX + 1] = {'\0'};
+    char topic[PATH_MAX + 1] = {'\0'};
+    bool need_lookup = false;
+
+    ctx->reenter = false;
+    rc = dyad_resolve_metadata (ctx, fname, upath, topic, mdata, &need_lookup);
+    if (DYAD_IS_ERROR (rc) || !need_lookup) {
+        goto get_metadata_done;
+    }
+    DYAD_C_FUNCTION_UPDATE_STR ("upath", upath);
+    if (should_wait) {
+        dyad_publish_flush (ctx);
+    }
+    rc = dyad_kvs_read (ctx, topic, upath, should_wait, mdata);
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (ctx, "Could not read data from the KVS");
+        goto get_metadata_done;
+    }
+    rc = DYAD_RC_OK;
+
+get_metadata_done:;
+    if (DYAD_IS_ERROR (rc) && mdata != NULL && *mdata != NULL) {
+        dyad_free_metadata (mdata);
+    }
+    ctx->reenter = true;
+    DYAD_C_FUNCTION_END ();
+    return rc;
+}
+
+/**
+ * @brief Maximum number of KVS lookups @c dyad_get_metadata_batch() keeps
+ *        in flight.
+ */
+#define DYAD_KVS_LOOKUP_WINDOW 256ul
+
+/**
+ * @brief Lookup of one file of @c dyad_get_metadata_batch(), from the
+ *        time it is sent until its response is collected.
+ */
+typedef struct dyad_mdata_lookup {
+    flux_future_t *f;           ///< KVS lookup in flight, or @c NULL if not needed.
+    dyad_rc_t rc;               ///< Outcome of resolving the file.
+    char upath[PATH_MAX + 1];   ///< Path relative to the consumer-managed directory.
+    char topic[PATH_MAX + 1];   ///< KVS key of the file.
+} dyad_mdata_lookup_t;
+
+dyad_rc_t dyad_get_metadata_batch (dyad_ctx_t *restrict ctx,
+                                   const char **fnames,
+                                   size_t n,
+                                   bool should_wait,
+                                   dyad_metadata_t **mdata)
+{
+    DYAD_C_FUNCTION_START ();
+    DYAD_C_FUNCTION_UPDATE_INT ("n", n);
+    DYAD_C_FUNCTION_UPDATE_INT ("should_wait", should_wait);
+    dyad_rc_t rc = DYAD_RC_OK;
+    dyad_mdata_lookup_t *window = NULL;
+    dyad_mdata_lookup_t *lookup = NULL;
+    const int flags = should_wait ? FLUX_KVS_WAITCREATE : 0;
+    bool need_lookup = false;
+    uint64_t t0 = 0ull;
+    size_t sent = 0ul;
+    size_t i = 0ul;
+
+    if (!ctx || !ctx->h) {
+        rc = DYAD_RC_NOCTX;
+        goto get_metadata_batch_done;
+    }
+    if (fnames == NULL || mdata == NULL) {
+        rc = DYAD_RC_BADBUF;
+        goto get_metadata_batch_done;
+    }
+    window = (dyad_mdata_lookup_t *)calloc (DYAD_KVS_LOOKUP_WINDOW, sizeof (*window));
+    if (window == NULL) {
+        rc = DYAD_RC_SYSFAIL;
+        goto get_metadata_batch_done;
+    }
+    ctx->reenter = false;
+    if (should_wait) {
+        dyad_publish_flush (ctx);
+    }
+    // Keep up to DYAD_KVS_LOOKUP_WINDOW lookups in flight, and send the
+    // next one each time the oldest is collected
+    for (i = 0ul; i < n; i++) {
+        for (; sent < n && sent < i + DYAD_KVS_LOOKUP_WINDOW; sent++) {
+            lookup = &window[sent % DYAD_KVS_LOOKUP_WINDOW];
+            memset (lookup, 0, sizeof (*lookup));
+            mdata[sent] = NULL;
+            lookup->rc = dyad_resolve_metadata (ctx,
+                                                fnames[sent],
+                                                lookup->upath,
+                                                lookup->topic,
+                                                &mdata[sent],
+                                                &need_lookup);
+            if (DYAD_IS_ERROR (lookup->rc) || !need_lookup
+                || dyad_lookup_cached_mdata (ctx,
+                                             lookup->upath,
+                                             should_wait,
+                                             &mdata[sent],
+                                             &lookup->rc)) {
+                continue;
+            }
+            lookup->f =
+                flux_kvs_lookup ((flux_t *)ctx->h, ctx->kvs_namespace, flags, lookup->topic);
+            if (lookup->f == NULL) {
+                DYAD_LOG_ERROR (ctx, "KVS lookup failed!\n");
+                lookup->rc = DYAD_RC_NOTFOUND;
+            }
+        }
+        lookup = &window[i % DYAD_KVS_LOOKUP_WINDOW];
+        if (lookup->f != NULL) {
+            t0 = dyad_stats_now ();
+            lookup->rc =
+                dyad_kvs_get_mdata (ctx, lookup->f, lookup->topic, lookup->upath, &mdata[i]);
+            dyad_stats_record (DYAD_STATS_KVS_LOOKUP, t0);
+            dyad_cache_mdata (ctx, lookup->upath, should_wait, lookup->rc, mdata[i]);
+            flux_future_destroy (lookup->f);
+            lookup->f = NULL;
+        }
+        if (DYAD_IS_ERROR (lookup->rc)) {
+            DYAD_LOG_DEBUG (ctx,
+                            "DYAD CLIENT: No metadata for %s (rc = %d)",
+                            fnames[i],
+                            lookup->rc);
+            dyad_free_metadata (&mdata[i]);
+            if (!DYAD_IS_ERROR (rc)) {
+                rc = lookup->rc;
+            }
+        }
+    }
+    ctx->reenter = true;
+
+get_metadata_batch_done:;
+    free (window);
+    DYAD_C_FUNCTION_END ();
+    return rc;
+}
+
+dyad_rc_t dyad_free_metadata (dyad_metadata_t **mdata)
+{
+    DYAD_C_FUNCTION_START ();
+    if (mdata == NULL || *mdata == NULL) {
+        return DYAD_RC_OK;
+    }
+    if ((*mdata)->fpath != NULL)
+        free ((*mdata)->fpath);
+    free (*mdata);
+    *mdata = NULL;
+    DYAD_C_FUNCTION_END ();
+    return DYAD_RC_OK;
+}
+
+dyad_rc_t dyad_consume (dyad_ctx_t *restrict ctx, const char *restrict fname)
+{
+    DYAD_C_FUNCTION_START ();
+    DYAD_C_FUNCTION_UPDATE_STR ("fname", fname);
+    dyad_rc_t rc = DYAD_RC_OK;
+    int lock_fd = -1, io_fd = -1, record_fd = -1;
+    ssize_t file_size = -1;
+    char *file_data = NULL;
+    size_t data_len = 0ul;
+    size_t remote_size = 0ul;
+    unsigned stripes = 1u;
+    dyad_metadata_t *mdata = NULL;
+    struct flock exclusive_lock;
+    struct flock record_lock;
+    char upath[PATH_MAX + 1] = {'\0'};
+
+    // If the context is not defined, then it is not valid.
+    // So, return DYAD_NOCTX
+    if (!ctx || !ctx->h) {
+        rc = DYAD_RC_NOCTX;
+        goto consume_close;
+    }
+    // If the consumer-managed path is NULL or empty, then the context is not
+    // valid for a consumer operation. So, return DYAD_BADMANAGEDPATH
+    if (ctx->cons_managed_path == NULL) {
+        rc = DYAD_RC_BADMANAGEDPATH;
+        goto consume_close;
+    }
+
+    if (ctx->relative_to_managed_path && (strlen (fname) > 0ul)
         && (strncmp (fname, DYAD_PATH_DELIM, ctx->delim_len)
             != 0)) {  // fname is a relative path that is relative to the
                       // cons_managed_path
-        memcpy (upath, fname, fname_len);
+        memcpy (upath, fname, strlen (fname));
     } else if (!cmp_canonical_path_prefix (ctx, false, fname, upath, PATH_MAX)) {
         // Extract the path to the file specified by fname relative to the
-        // producer-managed path
+        // consumer-managed path
         // This relative path will be stored in upath
         // DYAD_LOG_TRACE (ctx, "%s is not in the Consumer's managed path\n",
         // fname);
-        // NOTE: This is different from what dyad_fetch/commit returns,
-        // which is DYAD_RC_OK such that dyad does not interfere accesses on
-        // non-managed directories.
-        rc = DYAD_RC_UNTRACKED;
-        goto get_metadata_done;
+        rc = DYAD_RC_OK;
+        goto consume_close;
     }
-    DYAD_LOG_DEBUG (ctx,
-                    "DYAD CLIENT: Obtaining file path relative to consumer directory: %s",
-                    upath);
     ctx->reenter = false;
-    DYAD_C_FUNCTION_UPDATE_STR ("upath", upath);
 
-    // check if file exist locally, if so skip kvs
-    int fd = open (fname, O_RDONLY);
-    if (fd != -1) {
-        close (fd);
-        if (mdata == NULL) {
-            DYAD_LOG_ERROR (ctx,
-                            "Metadata double pointer is NULL. "
-                            "Cannot correctly create metadata object");
-            rc = DYAD_RC_NOTFOUND;
-            goto get_metadata_done;
-        }
-        if (*mdata != NULL) {
-            DYAD_LOG_DEBUG (ctx,
-                            "DYAD CLIENT: Metadata object is already allocated. Skipping "
-                            "allocation");
-        } else {
-            *mdata = (dyad_metadata_t *)malloc (sizeof (struct dyad_metadata));
-            if (*mdata == NULL) {
-                DYAD_LOG_ERROR (ctx, "Cannot allocate memory for metadata object");
-                rc = DYAD_RC_SYSFAIL;
-                goto get_metadata_done;
+    lock_fd = open (fname, O_RDWR | O_CREAT, 0666);
+    if (lock_fd == -1) {
+        // This could be a system file on which users have no write permission
+        DYAD_LOG_ERROR (ctx, "Cannot create file (%s) for dyad_consume!\n", fname);
+        rc = DYAD_RC_BADFIO;
+        goto consume_close;
+    }
+    rc = dyad_excl_flock (ctx, lock_fd, &exclusive_lock);
+    if (DYAD_IS_ERROR (rc)) {
+        dyad_release_flock (ctx, lock_fd, &exclusive_lock);
+        goto consume_done;
+    }
+    file_size = get_file_size (lock_fd);
+    if (ctx->shared_storage) {
+        dyad_release_flock (ctx, lock_fd, &exclusive_lock);
+        if (!ctx->use_fs_locks || file_size <= 0) {
+            // As file size being zero means that consumer won the lock first. So has to
+            // wait for kvs. or we cannot use file lock based synchronization as it
+            // does not work with the files managed by c++ fstream.
+            // With coalescing, only one consumer per node waits for the kvs.
+            record_fd = dyad_coalesce_lock (ctx, upath, &record_lock);
+            if (dyad_coalesce_is_fetched (record_fd, lock_fd)) {
+                DYAD_LOG_INFO (ctx, "File '%s' is already available on this node!\n", fname);
+                goto consume_done;
+            }
+            rc = dyad_fetch_metadata (ctx, fname, upath, &mdata);
+            if (DYAD_IS_ERROR (rc)) {
+                DYAD_LOG_ERROR (ctx, "dyad_fetch_metadata failed for shared storage!\n");
+                goto consume_done;
             }
+            dyad_coalesce_update (ctx, record_fd, lock_fd);
         }
-        (*mdata)->fpath = (char *)malloc (fname_len + 1);
-        if ((*mdata)->fpath == NULL) {
-            DYAD_LOG_ERROR (ctx, "Cannot allocate memory for fpath in metadata object");
-            rc = DYAD_RC_SYSFAIL;
-            goto get_metadata_done;
+    } else {
+        // When use_fs_locks is false, filesystem locking is unavailable
+        // (e.g. DYAD_HAS_STD_FSTREAM_FD is not defined for C++ streams),
+        // so we cannot rely on file size alone to determine if the file is
+        // fully written as producer cannot lock the file it is still writting.
+        // In that case, always fetch metadata from KVS to ensure correctness,
+        // as in the shared storage path. For the C GOTCHA wrapper path,
+        // use_fs_locks is irrelevant and should always be true.
+        // A file holding only the byte ranges fetched by dyad_consume_range ()
+        // is not complete either.
+        if (!ctx->use_fs_locks || file_size <= 0 || dyad_is_partial (lock_fd)) {
+            DYAD_LOG_INFO (ctx,
+                           "[node %u rank %u pid %d] File (%s with lock_fd %d) is not "
+                           "fetched yet",
+                           ctx->node_idx,
+                           ctx->rank,
+                           ctx->pid,
+                           fname,
+                           lock_fd);
+            // Skip the lookup and the transfer if another consumer on this
+            // node has just fetched the file
+            record_fd = dyad_coalesce_lock (ctx, upath, &record_lock);
+            if (dyad_coalesce_is_fetched (record_fd, lock_fd)) {
+                DYAD_LOG_INFO (ctx, "File '%s' is already fetched on this node!\n", fname);
+                dyad_release_flock (ctx, lock_fd, &exclusive_lock);
+                goto consume_done;
+            }
+            // Call dyad_fetch to get (and possibly wait on)
+            // data from the Flux KVS
+            rc = dyad_fetch_metadata (ctx, fname, upath, &mdata);
+            // If an error occured in dyad_fetch_metadata, log an error
+            // and return the corresponding DYAD return code
+            if (DYAD_IS_ERROR (rc)) {
+                DYAD_LOG_ERROR (ctx, "dyad_fetch_metadata failed!\n");
+                dyad_release_flock (ctx, lock_fd, &exclusive_lock);
+                goto consume_done;
+            }
+            // If dyad_fetch_metadata was successful, but mdata is still NULL,
+            // then we need to skip data transfer.
+            // This is either because producer and consumer share storage
+            // or because the file is not on the managed directory.
+            if (mdata == NULL) {
+                DYAD_LOG_INFO (ctx, "File '%s' is local!\n", fname);
+                rc = DYAD_RC_OK;
+                dyad_release_flock (ctx, lock_fd, &exclusive_lock);
+                goto consume_done;
+            }
+            // Without file locks, a copy left by an earlier fetch may
+            // already match the producer's file
+            if (dyad_local_copy_is_current (ctx, mdata, lock_fd)) {
+                DYAD_LOG_INFO (ctx, "File '%s' is already up to date!\n", fname);
+                dyad_free_metadata (&mdata);
+                dyad_coalesce_update (ctx, record_fd, lock_fd);
+                dyad_release_flock (ctx, lock_fd, &exclusive_lock);
+                goto consume_done;
+            }
+
+            stripes = dyad_stripe_count (ctx, mdata, &remote_size);
+            if (stripes > 1u || dyad_use_chunked_transfer (ctx)) {
+                // Receive the file over several streams, or in chunks, and
+                // write each part as it arrives
+                rc = (stripes > 1u) ? dyad_cons_store_striped (ctx,
+                                                               mdata,
+                                                               fname,
+                                                               remote_size,
+                                                               stripes,
+                                                               &data_len)
+                                    : dyad_cons_store_chunked (ctx, mdata, fname, &data_len);
+                dyad_free_metadata (&mdata);
+                if (DYAD_IS_ERROR (rc)) {
+                    DYAD_LOG_ERROR (ctx, "Cannot store %s as it arrives!\n", fname);
+                } else {
+                    dyad_clear_partial (lock_fd);
+                    dyad_coalesce_update (ctx, record_fd, lock_fd);
+                }
+                dyad_release_flock (ctx, lock_fd, &exclusive_lock);
+                goto consume_done;
+            }
+
+            // Call dyad_get_data to dispatch a RPC to the producer's Flux broker
+            // and retrieve the data associated with the file
+            rc = dyad_get_data (ctx, mdata, &file_data, &data_len);
+            if (DYAD_IS_ERROR (rc)) {
+                DYAD_LOG_ERROR (ctx, "dyad_get_data failed!\n");
+                dyad_release_flock (ctx, lock_fd, &exclusive_lock);
+                goto consume_done;
+            }
+            DYAD_C_FUNCTION_UPDATE_INT ("data_len", data_len);
+            io_fd = open (fname, O_WRONLY);
+            DYAD_C_FUNCTION_UPDATE_INT ("io_fd", io_fd);
+            if (io_fd == -1) {
+                DYAD_LOG_ERROR (ctx,
+                                "Cannot open file (%s) in write mode for dyad_consume!\n",
+                                fname);
+                rc = DYAD_RC_BADFIO;
+                goto consume_close;
+            }
+            // Call dyad_pull to fetch the data from the producer's
+            // Flux broker
+            rc = dyad_cons_store (ctx, mdata, io_fd, 0ul, data_len, file_data);
+            // Regardless if there was an error in dyad_pull,
+            // free the KVS response object
+            if (mdata != NULL) {
+                dyad_free_metadata (&mdata);
+            }
+            if (close (io_fd) != 0) {
+                rc = DYAD_RC_BADFIO;
+                dyad_release_flock (ctx, lock_fd, &exclusive_lock);
+                goto consume_done;
+            }
+            // If an error occured in dyad_pull, log it
+            // and return the corresponding DYAD return code
+            if (DYAD_IS_ERROR (rc)) {
+                DYAD_LOG_ERROR (ctx, "dyad_cons_store failed!\n");
+                dyad_release_flock (ctx, lock_fd, &exclusive_lock);
+                goto consume_done;
+            };
+            // Clear the mark first as it changes the status change time
+            dyad_clear_partial (lock_fd);
+            dyad_coalesce_update (ctx, record_fd, lock_fd);
         }
-        memset ((*mdata)->fpath, '\0', fname_len + 1);
-        memcpy ((*mdata)->fpath, fname, fname_len);
-        (*mdata)->owner_rank = ctx->rank;
+        dyad_release_flock (ctx, lock_fd, &exclusive_lock);
+    }
+    DYAD_C_FUNCTION_UPDATE_INT ("file_size", file_size);
+consume_done:;
+    if (close (lock_fd) != 0) {
+        rc = DYAD_RC_BADFIO;
+    }
+    if (file_data != NULL) {
+        ctx->dtl_handle->return_buffer (ctx, (void **)&file_data);
+    }
+    // Set reenter to true to allow additional intercepting
+consume_close:;
+    dyad_coalesce_unlock (ctx, record_fd, &record_lock);
+    ctx->reenter = true;
+    DYAD_C_FUNCTION_END ();
+    return rc;
+}
+
+dyad_rc_t dyad_consume_w_metadata (dyad_ctx_t *restrict ctx,
+                                   const char *fname,
+                                   const dyad_metadata_t *restrict mdata)
+{
+    DYAD_C_FUNCTION_START ();
+    DYAD_C_FUNCTION_UPDATE_STR ("fname", fname);
+    dyad_rc_t rc = DYAD_RC_OK;
+    int lock_fd = -1, io_fd = -1;
+    ssize_t file_size = -1;
+    char *file_data = NULL;
+    size_t data_len = 0ul;
+    size_t remote_size = 0ul;
+    unsigned stripes = 1u;
+    struct flock exclusive_lock;
+    // If the context is not defined, then it is not valid.
+    // So, return DYAD_NOCTX
+    if (!ctx || !ctx->h) {
+        rc = DYAD_RC_NOCTX;
+        goto consume_close;
+    }
+    // If dyad_get_metadata was successful, but mdata is still NULL,
+    // then we need to skip data transfer.
+    if (mdata == NULL) {
+        DYAD_LOG_INFO (ctx, "File '%s' is local!\n", fname);
         rc = DYAD_RC_OK;
-        goto get_metadata_done;
+        goto consume_close;
+    }
+    // If the consumer-managed path is NULL or empty, then the context is not
+    // valid for a consumer operation. So, return DYAD_BADMANAGEDPATH
+    if (ctx->cons_managed_path == NULL) {
+        rc = DYAD_RC_BADMANAGEDPATH;
+        goto consume_close;
+    }
+    // Set reenter to false to avoid recursively performing DYAD operations
+    ctx->reenter = false;
+    lock_fd = open (fname, O_RDWR | O_CREAT, 0666);
+    DYAD_C_FUNCTION_UPDATE_INT ("lock_fd", lock_fd);
+    if (lock_fd == -1) {
+        DYAD_LOG_ERROR (ctx, "Cannot create file (%s) for dyad_consume_w_metadata!", fname);
+        rc = DYAD_RC_BADFIO;
+        goto consume_close;
+    }
+    rc = dyad_excl_flock (ctx, lock_fd, &exclusive_lock);
+    if (DYAD_IS_ERROR (rc)) {
+        dyad_release_flock (ctx, lock_fd, &exclusive_lock);
+        goto consume_close;
+    }
+    if ((file_size = get_file_size (lock_fd)) <= 0 || dyad_is_partial (lock_fd)) {
+        DYAD_LOG_INFO (ctx,
+                       "DYAD CLIENT: [node %u rank %u pid %d] File (%s with fd %d) is not fetched "
+                       "yet",
+                       ctx->node_idx,
+                       ctx->rank,
+                       ctx->pid,
+                       fname,
+                       lock_fd);
+
+        stripes = dyad_stripe_count (ctx, mdata, &remote_size);
+        if (stripes > 1u || dyad_use_chunked_transfer (ctx)) {
+            // Receive the file over several streams, or in chunks, and write
+            // each part as it arrives
+            rc = (stripes > 1u)
+                     ? dyad_cons_store_striped (ctx, mdata, fname, remote_size, stripes, &data_len)
+                     : dyad_cons_store_chunked (ctx, mdata, fname, &data_len);
+            if (!DYAD_IS_ERROR (rc)) {
+                dyad_clear_partial (lock_fd);
+            }
+            dyad_release_flock (ctx, lock_fd, &exclusive_lock);
+            if (DYAD_IS_ERROR (rc)) {
+                DYAD_LOG_ERROR (ctx, "Cannot store %s as it arrives!\n", fname);
+                goto consume_done;
+            }
+            goto consume_stored;
+        }
+
+        // Call dyad_get_data to dispatch a RPC to the producer's Flux broker
+        // and retrieve the data associated with the file
+        rc = dyad_get_data (ctx, mdata, &file_data, &data_len);
+        if (DYAD_IS_ERROR (rc)) {
+            DYAD_LOG_ERROR (ctx, "dyad_get_data failed!\n");
+            dyad_release_flock (ctx, lock_fd, &exclusive_lock);
+            goto consume_done;
+        }
+        DYAD_C_FUNCTION_UPDATE_INT ("data_len", data_len);
+        io_fd = open (fname, O_WRONLY);
+        DYAD_C_FUNCTION_UPDATE_INT ("io_fd", io_fd);
+        if (io_fd == -1) {
+            DYAD_LOG_ERROR (ctx, "Cannot open file (%s) in write mode for dyad_consume!\n", fname);
+            rc = DYAD_RC_BADFIO;
+            goto consume_close;
+        }
+        // Call dyad_pull to fetch the data from the producer's
+        // Flux broker
+        rc = dyad_cons_store (ctx, mdata, io_fd, 0ul, data_len, file_data);
+
+        if (close (io_fd) != 0) {
+            rc = DYAD_RC_BADFIO;
+            dyad_release_flock (ctx, lock_fd, &exclusive_lock);
+            goto consume_done;
+        }
+        // If an error occured in dyad_pull, log it
+        // and return the corresponding DYAD return code
+        if (DYAD_IS_ERROR (rc)) {
+            DYAD_LOG_ERROR (ctx, "dyad_cons_store failed!\n");
+            dyad_release_flock (ctx, io_fd, &exclusive_lock);
+            goto consume_done;
+        };
+        dyad_clear_partial (lock_fd);
     }
+    dyad_release_flock (ctx, lock_fd, &exclusive_lock);
+consume_stored:;
+    DYAD_C_FUNCTION_UPDATE_INT ("file_size", file_size);
 
-    const size_t topic_len = PATH_MAX;
-    char topic[PATH_MAX + 1] = {'\0'};
-    DYAD_LOG_INFO (ctx, "Generating KVS key: %s", topic);
-    gen_path_key (upath, topic, topic_len, ctx->key_depth, ctx->key_bins);
-    rc = dyad_kvs_read (ctx, topic, upath, should_wait, mdata);
-    if (DYAD_IS_ERROR (rc)) {
-        DYAD_LOG_ERROR (ctx, "Could not read data from the KVS");
-        goto get_metadata_done;
+    if (close (lock_fd) != 0) {
+        rc = DYAD_RC_BADFIO;
+        goto consume_done;
     }
     rc = DYAD_RC_OK;
-
-get_metadata_done:;
-    if (DYAD_IS_ERROR (rc) && mdata != NULL && *mdata != NULL) {
-        dyad_free_metadata (mdata);
+consume_done:;
+    if (file_data != NULL) {
+        ctx->dtl_handle->return_buffer (ctx, (void **)&file_data);
     }
+consume_close:;
+    // Set reenter to true to allow additional intercepting
     ctx->reenter = true;
     DYAD_C_FUNCTION_END ();
     return rc;
 }
 
-dyad_rc_t dyad_free_metadata (dyad_metadata_t **mdata)
+dyad_rc_t dyad_consume_batch (dyad_ctx_t *restrict ctx, const char **fnames, size_t n)
 {
     DYAD_C_FUNCTION_START ();
-    if (mdata == NULL || *mdata == NULL) {
-        return DYAD_RC_OK;
+    DYAD_C_FUNCTION_UPDATE_INT ("n", n);
+    dyad_rc_t rc = DYAD_RC_OK;
+    dyad_rc_t file_rc = DYAD_RC_OK;
+    dyad_batch_entry_t *entries = NULL;
+    dyad_batch_entry_t *entry = NULL;
+    dyad_batch_entry_t **batch = NULL;
+    size_t count = 0ul;
+    size_t i = 0ul, j = 0ul;
+    ssize_t file_size = -1;
+    char upath[PATH_MAX + 1] = {'\0'};
+
+    // If the context is not defined, then it is not valid.
+    // So, return DYAD_NOCTX
+    if (!ctx || !ctx->h) {
+        rc = DYAD_RC_NOCTX;
+        goto consume_batch_done;
     }
-    if ((*mdata)->fpath != NULL)
-        free ((*mdata)->fpath);
-    free (*mdata);
-    *mdata = NULL;
+    // If the consumer-managed path is NULL or empty, then the context is not
+    // valid for a consumer operation. So, return DYAD_BADMANAGEDPATH
+    if (ctx->cons_managed_path == NULL) {
+        rc = DYAD_RC_BADMANAGEDPATH;
+        goto consume_batch_done;
+    }
+    // Only the Flux RPC DTL can carry several files in one stream, and there
+    // is nothing to transfer with shared storage
+    if (ctx->shared_storage || ctx->dtl_handle->mode != DYAD_DTL_FLUX_RPC) {
+        for (i = 0ul; i < n; i++) {
+            file_rc = dyad_consume (ctx, fnames[i]);
+            if (DYAD_IS_ERROR (file_rc) && !DYAD_IS_ERROR (rc)) {
+                rc = file_rc;
+            }
+        }
+        goto consume_batch_done;
+    }
+    entries = (dyad_batch_entry_t *)calloc (n, sizeof (*entries));
+    batch = (dyad_batch_entry_t **)calloc (n, sizeof (*batch));
+    if (entries == NULL || batch == NULL) {
+        DYAD_LOG_ERROR (ctx, "Cannot allocate the state of a batch of %zu files", n);
+        rc = DYAD_RC_SYSFAIL;
+        goto consume_batch_done;
+    }
+    ctx->reenter = false;
+
+    // Lock every file and look up the metadata of those not fetched yet, as
+    // dyad_consume () does for a single file
+    for (i = 0ul; i < n; i++) {
+        entry = &entries[i];
+        entry->fname = fnames[i];
+        entry->lock_fd = -1;
+        memset (upath, 0, PATH_MAX + 1);
+        if (ctx->relative_to_managed_path && (strlen (entry->fname) > 0ul)
+            && (strncmp (entry->fname, DYAD_PATH_DELIM, ctx->delim_len) != 0)) {
+            memcpy (upath, entry->fname, strlen (entry->fname));
+        } else if (!cmp_canonical_path_prefix (ctx, false, entry->fname, upath, PATH_MAX)) {
+            continue;
+        }
+        entry->lock_fd = open (entry->fname, O_RDWR | O_CREAT, 0666);
+        if (entry->lock_fd == -1) {
+            DYAD_LOG_ERROR (ctx, "Cannot create file (%s) for dyad_consume_batch!\n", entry->fname);
+            rc = DYAD_RC_BADFIO;
+            continue;
+        }
+        file_rc = dyad_excl_flock (ctx, entry->lock_fd, &entry->lock);
+        if (DYAD_IS_ERROR (file_rc)) {
+            dyad_release_flock (ctx, entry->lock_fd, &entry->lock);
+            close (entry->lock_fd);
+            entry->lock_fd = -1;
+            rc = file_rc;
+            continue;
+        }
+        file_size = get_file_size (entry->lock_fd);
+        if (ctx->use_fs_locks && file_size > 0 && !dyad_is_partial (entry->lock_fd)) {
+            continue;
+        }
+        file_rc = dyad_fetch_metadata (ctx, entry->fname, upath, &entry->mdata);
+        if (DYAD_IS_ERROR (file_rc)) {
+            DYAD_LOG_ERROR (ctx, "dyad_fetch_metadata failed for %s!\n", entry->fname);
+            rc = file_rc;
+        }
+    }
+
+    // Fetch the files owned by each broker with a single batch RPC
+    for (i = 0ul; i < n; i++) {
+        if (entries[i].mdata == NULL || entries[i].requested) {
+            continue;
+        }
+        count = 0ul;
+        for (j = i; j < n; j++) {
+            if (entries[j].mdata != NULL && !entries[j].requested
+                && entries[j].mdata->owner_rank == entries[i].mdata->owner_rank) {
+                batch[count++] = &entries[j];
+            }
+        }
+        file_rc = dyad_get_batch (ctx, batch, count);
+        if (DYAD_IS_ERROR (file_rc)) {
+            DYAD_LOG_INFO (ctx,
+                           "Batch fetch from broker %u failed (rc = %d). Fetching the remaining "
+                           "files one by one.",
+                           entries[i].mdata->owner_rank,
+                           file_rc);
+        }
+    }
+
+    // Release the locks. Files that were not received completely are
+    // truncated so that dyad_consume () fetches them again below.
+    for (i = 0ul; i < n; i++) {
+        entry = &entries[i];
+        if (entry->mdata != NULL && !entry->done && ftruncate (entry->lock_fd, 0) != 0) {
+            rc = DYAD_RC_BADFIO;
+        }
+        if (entry->done) {
+            dyad_clear_partial (entry->lock_fd);
+        }
+        if (entry->lock_fd != -1) {
+            dyad_release_flock (ctx, entry->lock_fd, &entry->lock);
+            if (close (entry->lock_fd) != 0) {
+                rc = DYAD_RC_BADFIO;
+            }
+        }
+    }
+    ctx->reenter = true;
+    for (i = 0ul; i < n; i++) {
+        entry = &entries[i];
+        if (entry->mdata != NULL && !entry->done) {
+            file_rc = dyad_consume (ctx, entry->fname);
+            if (DYAD_IS_ERROR (file_rc)) {
+                DYAD_LOG_ERROR (ctx, "dyad_consume failed for %s!\n", entry->fname);
+                rc = file_rc;
+            }
+        }
+        dyad_free_metadata (&entry->mdata);
+    }
+    if (rc == DYAD_RC_OK && ctx->check)
+        setenv (DYAD_CHECK_ENV, "ok", 1);
+
+consume_batch_done:;
+    free (batch);
+    free (entries);
     DYAD_C_FUNCTION_END ();
-    return DYAD_RC_OK;
+    return rc;
 }
 
-dyad_rc_t dyad_consume (dyad_ctx_t *restrict ctx, const char *restrict fname)
+dyad_rc_t dyad_consume_range (dyad_ctx_t *restrict ctx,
+                              const char *restrict fname,
+                              size_t offset,
+                              size_t length)
 {
     DYAD_C_FUNCTION_START ();
     DYAD_C_FUNCTION_UPDATE_STR ("fname", fname);
+    DYAD_C_FUNCTION_UPDATE_INT ("offset", offset);
+    DYAD_C_FUNCTION_UPDATE_INT ("length", length);
     dyad_rc_t rc = DYAD_RC_OK;
     int lock_fd = -1, io_fd = -1;
     ssize_t file_size = -1;
@@ -1084,257 +4067,692 @@ dyad_rc_t dyad_consume (dyad_ctx_t *restrict ctx, const char *restrict fname)
     struct flock exclusive_lock;
     char upath[PATH_MAX + 1] = {'\0'};
 
-    // If the context is not defined, then it is not valid.
-    // So, return DYAD_NOCTX
     if (!ctx || !ctx->h) {
         rc = DYAD_RC_NOCTX;
-        goto consume_close;
+        goto consume_range_close;
     }
-    // If the consumer-managed path is NULL or empty, then the context is not
-    // valid for a consumer operation. So, return DYAD_BADMANAGEDPATH
     if (ctx->cons_managed_path == NULL) {
         rc = DYAD_RC_BADMANAGEDPATH;
-        goto consume_close;
+        goto consume_range_close;
+    }
+    // The whole file is requested, or there is nothing to transfer as the
+    // producer's file is directly readable
+    if ((offset == 0ul && length == 0ul) || ctx->shared_storage) {
+        rc = dyad_consume (ctx, fname);
+        goto consume_range_close;
     }
-
     if (ctx->relative_to_managed_path && (strlen (fname) > 0ul)
-        && (strncmp (fname, DYAD_PATH_DELIM, ctx->delim_len)
-            != 0)) {  // fname is a relative path that is relative to the
-                      // cons_managed_path
+        && (strncmp (fname, DYAD_PATH_DELIM, ctx->delim_len) != 0)) {
         memcpy (upath, fname, strlen (fname));
     } else if (!cmp_canonical_path_prefix (ctx, false, fname, upath, PATH_MAX)) {
-        // Extract the path to the file specified by fname relative to the
-        // consumer-managed path
-        // This relative path will be stored in upath
-        // DYAD_LOG_TRACE (ctx, "%s is not in the Consumer's managed path\n",
-        // fname);
         rc = DYAD_RC_OK;
-        goto consume_close;
+        goto consume_range_close;
     }
     ctx->reenter = false;
 
     lock_fd = open (fname, O_RDWR | O_CREAT, 0666);
     if (lock_fd == -1) {
-        // This could be a system file on which users have no write permission
-        DYAD_LOG_ERROR (ctx, "Cannot create file (%s) for dyad_consume!\n", fname);
+        DYAD_LOG_ERROR (ctx, "Cannot create file (%s) for dyad_consume_range!\n", fname);
         rc = DYAD_RC_BADFIO;
-        goto consume_close;
+        goto consume_range_close;
     }
     rc = dyad_excl_flock (ctx, lock_fd, &exclusive_lock);
     if (DYAD_IS_ERROR (rc)) {
-        dyad_release_flock (ctx, lock_fd, &exclusive_lock);
-        goto consume_done;
+        goto consume_range_unlock;
     }
     file_size = get_file_size (lock_fd);
-    if (ctx->shared_storage) {
-        dyad_release_flock (ctx, lock_fd, &exclusive_lock);
-        if (!ctx->use_fs_locks || file_size <= 0) {
-            // As file size being zero means that consumer won the lock first. So has to
-            // wait for kvs. or we cannot use file lock based synchronization as it
-            // does not work with the files managed by c++ fstream.
-            rc = dyad_fetch_metadata (ctx, fname, upath, &mdata);
-            if (DYAD_IS_ERROR (rc)) {
-                DYAD_LOG_ERROR (ctx, "dyad_fetch_metadata failed for shared storage!\n");
-                goto consume_done;
-            }
-        }
-    } else {
-        // When use_fs_locks is false, filesystem locking is unavailable
-        // (e.g. DYAD_HAS_STD_FSTREAM_FD is not defined for C++ streams),
-        // so we cannot rely on file size alone to determine if the file is
-        // fully written as producer cannot lock the file it is still writting.
-        // In that case, always fetch metadata from KVS to ensure correctness,
-        // as in the shared storage path. For the C GOTCHA wrapper path,
-        // use_fs_locks is irrelevant and should always be true.
-        if (!ctx->use_fs_locks || file_size <= 0) {
-            DYAD_LOG_INFO (ctx,
-                           "[node %u rank %u pid %d] File (%s with lock_fd %d) is not "
-                           "fetched yet",
-                           ctx->node_idx,
-                           ctx->rank,
-                           ctx->pid,
-                           fname,
-                           lock_fd);
-            // Call dyad_fetch to get (and possibly wait on)
-            // data from the Flux KVS
-            rc = dyad_fetch_metadata (ctx, fname, upath, &mdata);
-            // If an error occured in dyad_fetch_metadata, log an error
-            // and return the corresponding DYAD return code
-            if (DYAD_IS_ERROR (rc)) {
-                DYAD_LOG_ERROR (ctx, "dyad_fetch_metadata failed!\n");
-                dyad_release_flock (ctx, lock_fd, &exclusive_lock);
-                goto consume_done;
-            }
-            // If dyad_fetch_metadata was successful, but mdata is still NULL,
-            // then we need to skip data transfer.
-            // This is either because producer and consumer share storage
-            // or because the file is not on the managed directory.
-            if (mdata == NULL) {
-                DYAD_LOG_INFO (ctx, "File '%s' is local!\n", fname);
-                rc = DYAD_RC_OK;
-                dyad_release_flock (ctx, lock_fd, &exclusive_lock);
-                goto consume_done;
-            }
+    DYAD_C_FUNCTION_UPDATE_INT ("file_size", file_size);
+    if (ctx->use_fs_locks && file_size > 0 && !dyad_is_partial (lock_fd)) {
+        DYAD_LOG_INFO (ctx, "File '%s' is already fetched!\n", fname);
+        goto consume_range_unlock;
+    }
+    rc = dyad_fetch_metadata (ctx, fname, upath, &mdata);
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (ctx, "dyad_fetch_metadata failed!\n");
+        goto consume_range_unlock;
+    }
+    if (mdata == NULL) {
+        DYAD_LOG_INFO (ctx, "File '%s' is local!\n", fname);
+        rc = DYAD_RC_OK;
+        goto consume_range_unlock;
+    }
+    // Mark the file before writing anything into it, so that it is never
+    // taken for a complete copy
+    rc = dyad_set_partial (ctx, lock_fd);
+    if (DYAD_IS_ERROR (rc)) {
+        goto consume_range_unlock;
+    }
+    rc = dyad_get_data_range (ctx, mdata, offset, length, &file_data, &data_len);
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (ctx, "dyad_get_data_range failed!\n");
+        goto consume_range_unlock;
+    }
+    DYAD_C_FUNCTION_UPDATE_INT ("data_len", data_len);
+    io_fd = open (fname, O_WRONLY);
+    if (io_fd == -1) {
+        DYAD_LOG_ERROR (ctx,
+                        "Cannot open file (%s) in write mode for dyad_consume_range!\n",
+                        fname);
+        rc = DYAD_RC_BADFIO;
+        goto consume_range_unlock;
+    }
+    rc = dyad_cons_store (ctx, mdata, io_fd, offset, data_len, file_data);
+    if (close (io_fd) != 0) {
+        rc = DYAD_RC_BADFIO;
+    }
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (ctx, "dyad_cons_store failed!\n");
+    }
 
-            // Call dyad_get_data to dispatch a RPC to the producer's Flux broker
-            // and retrieve the data associated with the file
-            rc = dyad_get_data (ctx, mdata, &file_data, &data_len);
-            if (DYAD_IS_ERROR (rc)) {
-                DYAD_LOG_ERROR (ctx, "dyad_get_data failed!\n");
-                dyad_release_flock (ctx, lock_fd, &exclusive_lock);
-                goto consume_done;
-            }
-            DYAD_C_FUNCTION_UPDATE_INT ("data_len", data_len);
-            io_fd = open (fname, O_WRONLY);
-            DYAD_C_FUNCTION_UPDATE_INT ("io_fd", io_fd);
-            if (io_fd == -1) {
-                DYAD_LOG_ERROR (ctx,
-                                "Cannot open file (%s) in write mode for dyad_consume!\n",
-                                fname);
-                rc = DYAD_RC_BADFIO;
-                goto consume_close;
-            }
-            // Call dyad_pull to fetch the data from the producer's
-            // Flux broker
-            rc = dyad_cons_store (ctx, mdata, io_fd, data_len, file_data);
-            // Regardless if there was an error in dyad_pull,
-            // free the KVS response object
-            if (mdata != NULL) {
-                dyad_free_metadata (&mdata);
-            }
-            if (close (io_fd) != 0) {
-                rc = DYAD_RC_BADFIO;
-                dyad_release_flock (ctx, lock_fd, &exclusive_lock);
-                goto consume_done;
-            }
-            // If an error occured in dyad_pull, log it
-            // and return the corresponding DYAD return code
-            if (DYAD_IS_ERROR (rc)) {
-                DYAD_LOG_ERROR (ctx, "dyad_cons_store failed!\n");
-                dyad_release_flock (ctx, lock_fd, &exclusive_lock);
-                goto consume_done;
-            };
+consume_range_unlock:;
+    dyad_release_flock (ctx, lock_fd, &exclusive_lock);
+    if (close (lock_fd) != 0) {
+        rc = DYAD_RC_BADFIO;
+    }
+    dyad_free_metadata (&mdata);
+    if (file_data != NULL) {
+        ctx->dtl_handle->return_buffer (ctx, (void **)&file_data);
+    }
+consume_range_close:;
+    ctx->reenter = true;
+    DYAD_C_FUNCTION_END ();
+    return rc;
+}
+
+/**
+ * @brief Allocates a buffer of @p size bytes to hand to the application in
+ *        @c dyad_consume_to_buffer().
+ *
+ * @details
+ * Buffers come from the DTL, so that received messages can be handed over
+ * as they are, except with the @c UCX DTL, whose messages may occupy a slot
+ * of its receive ring, which the producer needs back for later transfers.
+ * Released by @c dyad_release_buffer().
+ */
+DYAD_CORE_FUNC_MODS dyad_rc_t dyad_get_app_buffer (const dyad_ctx_t *restrict ctx,
+                                                   size_t size,
+                                                   void **restrict buf)
+{
+    if (ctx->dtl_handle->mode != DYAD_DTL_UCX) {
+        return ctx->dtl_handle->get_buffer (ctx, size, buf);
+    }
+    *buf = malloc (size);
+    return (*buf == NULL) ? DYAD_RC_SYSFAIL : DYAD_RC_OK;
+}
+
+/**
+ * @brief Reads a file that is directly accessible, e.g., with shared
+ *        storage, into a buffer from @c dyad_get_app_buffer().
+ *
+ * @details
+ * Holds a shared lock on the file while reading it, so that a producer on
+ * the same node still writing it is waited for.
+ *
+ * @return @c DYAD_RC_OK, @c DYAD_RC_BADFIO if the file could not be opened,
+ *         locked or read, or @c DYAD_RC_SYSFAIL if no buffer could be
+ *         obtained.
+ */
+DYAD_CORE_FUNC_MODS dyad_rc_t dyad_read_to_buffer (const dyad_ctx_t *restrict ctx,
+                                                   const char *restrict fname,
+                                                   void **restrict buf,
+                                                   size_t *restrict len)
+{
+    dyad_rc_t rc = DYAD_RC_OK;
+    struct flock shared_lock;
+    ssize_t file_size = -1;
+    ssize_t n = 0l;
+    size_t off = 0ul;
+    int fd = open (fname, O_RDONLY);
+
+    if (fd == -1) {
+        DYAD_LOG_ERROR (ctx, "Cannot open file (%s) for dyad_consume_to_buffer!\n", fname);
+        return DYAD_RC_BADFIO;
+    }
+    rc = dyad_shared_flock (ctx, fd, &shared_lock);
+    if (DYAD_IS_ERROR (rc)) {
+        goto read_to_buffer_done;
+    }
+    file_size = get_file_size (fd);
+    if (file_size < 0l) {
+        rc = DYAD_RC_BADFIO;
+        goto read_to_buffer_unlock;
+    }
+    if (file_size == 0l) {
+        goto read_to_buffer_unlock;
+    }
+    rc = dyad_get_app_buffer (ctx, (size_t)file_size, buf);
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (ctx, "Cannot get a buffer of %zd bytes for %s\n", file_size, fname);
+        rc = DYAD_RC_SYSFAIL;
+        goto read_to_buffer_unlock;
+    }
+    while (off < (size_t)file_size) {
+        n = pread (fd, (char *)*buf + off, (size_t)file_size - off, (off_t)off);
+        if (n < 0l && errno == EINTR) {
+            continue;
         }
-        dyad_release_flock (ctx, lock_fd, &exclusive_lock);
+        if (n <= 0l) {
+            DYAD_LOG_ERROR (ctx, "Cannot read file (%s) (errno = %d)\n", fname, errno);
+            rc = DYAD_RC_BADFIO;
+            break;
+        }
+        off += (size_t)n;
+    }
+    *len = off;
+
+read_to_buffer_unlock:;
+    dyad_release_flock (ctx, fd, &shared_lock);
+read_to_buffer_done:;
+    close (fd);
+    return rc;
+}
+
+dyad_rc_t dyad_consume_to_buffer (dyad_ctx_t *restrict ctx,
+                                  const char *restrict fname,
+                                  void **restrict buf,
+                                  size_t *restrict len)
+{
+    DYAD_C_FUNCTION_START ();
+    DYAD_C_FUNCTION_UPDATE_STR ("fname", fname);
+    dyad_rc_t rc = DYAD_RC_OK;
+    char *file_data = NULL;
+    size_t data_len = 0ul;
+    dyad_metadata_t *mdata = NULL;
+    char upath[PATH_MAX + 1] = {'\0'};
+
+    if (buf == NULL || len == NULL) {
+        rc = DYAD_RC_BADBUF;
+        goto consume_to_buffer_close;
     }
-    DYAD_C_FUNCTION_UPDATE_INT ("file_size", file_size);
-consume_done:;
-    if (close (lock_fd) != 0) {
-        rc = DYAD_RC_BADFIO;
+    *buf = NULL;
+    *len = 0ul;
+    if (!ctx || !ctx->h) {
+        rc = DYAD_RC_NOCTX;
+        goto consume_to_buffer_close;
+    }
+    if (ctx->cons_managed_path == NULL) {
+        rc = DYAD_RC_BADMANAGEDPATH;
+        goto consume_to_buffer_close;
+    }
+    if (ctx->relative_to_managed_path && (strlen (fname) > 0ul)
+        && (strncmp (fname, DYAD_PATH_DELIM, ctx->delim_len) != 0)) {
+        memcpy (upath, fname, strlen (fname));
+    } else if (!cmp_canonical_path_prefix (ctx, false, fname, upath, PATH_MAX)) {
+        rc = DYAD_RC_UNTRACKED;
+        goto consume_to_buffer_close;
+    }
+    ctx->reenter = false;
+
+    // Wait for the file to be published, as dyad_consume () does
+    rc = dyad_fetch_metadata (ctx, fname, upath, &mdata);
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (ctx, "dyad_fetch_metadata failed!\n");
+        goto consume_to_buffer_done;
+    }
+    if (ctx->shared_storage || mdata == NULL) {
+        DYAD_LOG_INFO (ctx, "File '%s' is local!\n", fname);
+        rc = dyad_read_to_buffer (ctx, fname, buf, len);
+        goto consume_to_buffer_done;
     }
+    rc = dyad_get_data (ctx, mdata, &file_data, &data_len);
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (ctx, "dyad_get_data failed!\n");
+        goto consume_to_buffer_done;
+    }
+    DYAD_C_FUNCTION_UPDATE_INT ("data_len", data_len);
+    if (ctx->dtl_handle->mode != DYAD_DTL_UCX) {
+        // Hand the received message over as it is
+        *buf = file_data;
+        *len = data_len;
+        file_data = NULL;
+        goto consume_to_buffer_done;
+    }
+    // UCX messages may occupy a slot of the receive ring, which must be handed back
+    if (data_len > 0ul) {
+        rc = dyad_get_app_buffer (ctx, data_len, buf);
+        if (DYAD_IS_ERROR (rc)) {
+            DYAD_LOG_ERROR (ctx, "Cannot get a buffer of %zu bytes for %s\n", data_len, fname);
+            goto consume_to_buffer_done;
+        }
+        memcpy (*buf, file_data, data_len);
+        *len = data_len;
+    }
+
+consume_to_buffer_done:;
+    dyad_free_metadata (&mdata);
     if (file_data != NULL) {
         ctx->dtl_handle->return_buffer (ctx, (void **)&file_data);
     }
-    // Set reenter to true to allow additional intercepting
-consume_close:;
+    if (DYAD_IS_ERROR (rc)) {
+        dyad_release_buffer (ctx, buf);
+        *len = 0ul;
+    }
     ctx->reenter = true;
+consume_to_buffer_close:;
     DYAD_C_FUNCTION_END ();
     return rc;
 }
 
-dyad_rc_t dyad_consume_w_metadata (dyad_ctx_t *restrict ctx,
-                                   const char *fname,
-                                   const dyad_metadata_t *restrict mdata)
+dyad_rc_t dyad_release_buffer (dyad_ctx_t *restrict ctx, void **buf)
+{
+    if (buf == NULL || *buf == NULL) {
+        return DYAD_RC_OK;
+    }
+    if (!ctx || !ctx->dtl_handle) {
+        return DYAD_RC_NOCTX;
+    }
+    if (ctx->dtl_handle->mode != DYAD_DTL_UCX) {
+        return ctx->dtl_handle->return_buffer (ctx, buf);
+    }
+    free (*buf);
+    *buf = NULL;
+    return DYAD_RC_OK;
+}
+
+/**
+ * @brief State of a consume started by @c dyad_consume_async().
+ */
+struct dyad_request {
+    dyad_ctx_t *ctx;                 ///< Context the consume was started with.
+    flux_future_t *f;                ///< KVS lookup in flight, or @c NULL once answered.
+    dyad_metadata_t *mdata;          ///< Metadata from the lookup, or @c NULL.
+    uint64_t t_lookup;               ///< Start of the lookup, for @c DYAD_STATS_KVS_LOOKUP.
+    dyad_rc_t rc;                    ///< Outcome of the lookup, then of the consume.
+    bool ready;                      ///< Whether the lookup has been answered.
+    bool done;                       ///< Whether the consume has completed.
+    char fname[PATH_MAX + 1];        ///< Path of the file, as passed by the caller.
+    char topic[PATH_MAX + 1];        ///< KVS key of the file.
+    char upath[PATH_MAX + 1];        ///< Path relative to the consumer-managed directory.
+};
+
+static void dyad_request_free (dyad_request_t *restrict req)
+{
+    if (req->f != NULL) {
+        flux_future_destroy (req->f);
+    }
+    dyad_free_metadata (&req->mdata);
+    free (req);
+}
+
+/**
+ * @brief Continuation of the KVS lookup of an asynchronous consume.
+ *
+ * @details
+ * Called from the reactor of the context's Flux handle, i.e., from
+ * @c dyad_test(), @c dyad_wait() or @c dyad_wait_any(), once the producer
+ * has published the file. Only records the metadata: the transfer itself
+ * is left to @c dyad_request_complete(), outside of the reactor.
+ */
+static void dyad_request_lookup_cb (flux_future_t *f, void *arg)
+{
+    dyad_request_t *req = (dyad_request_t *)arg;
+    dyad_stats_record (DYAD_STATS_KVS_LOOKUP, req->t_lookup);
+    req->rc = dyad_kvs_get_mdata (req->ctx, f, req->topic, req->upath, &req->mdata);
+    dyad_cache_mdata (req->ctx, req->upath, true, req->rc, req->mdata);
+    flux_future_destroy (f);
+    req->f = NULL;
+    req->ready = true;
+}
+
+/**
+ * @brief Finishes the consume of @p req once its metadata is known.
+ *
+ * @details
+ * Mirrors @c dyad_consume(): nothing is fetched with shared storage or if
+ * the producer is on the same node. Otherwise the file is fetched and
+ * stored with @c dyad_consume_w_metadata(), which skips files already
+ * fetched. Transfers use the DTL connection of the context, so they run
+ * one at a time, in the calling thread.
+ */
+static void dyad_request_complete (dyad_request_t *restrict req)
+{
+    dyad_ctx_t *ctx = req->ctx;
+
+    if (!req->ready || req->done) {
+        return;
+    }
+    req->done = true;
+    if (DYAD_IS_ERROR (req->rc)) {
+        DYAD_LOG_ERROR (ctx, "DYAD CLIENT: Lookup of '%s' failed", req->fname);
+        return;
+    }
+    if (ctx->shared_storage || (req->mdata->owner_rank / ctx->service_mux) == ctx->node_idx) {
+        DYAD_LOG_INFO (ctx, "File '%s' is local!\n", req->fname);
+        req->rc = DYAD_RC_OK;
+        return;
+    }
+    req->rc = dyad_consume_w_metadata (ctx, req->fname, req->mdata);
+}
+
+/**
+ * @brief Runs the reactor of the Flux handle of @p ctx once, so that the
+ *        continuations of answered lookups are called.
+ *
+ * @param[in] ctx    Pointer to the DYAD context. Must not be @c NULL.
+ * @param[in] flags  @c FLUX_REACTOR_NOWAIT to only handle what has already
+ *                   arrived, or @c FLUX_REACTOR_ONCE to block until
+ *                   something does, after committing the publication
+ *                   batch with @c dyad_publish_flush().
+ *
+ * @return @c DYAD_RC_OK, or @c DYAD_RC_SYSFAIL if the reactor failed.
+ */
+DYAD_CORE_FUNC_MODS dyad_rc_t dyad_request_progress (dyad_ctx_t *restrict ctx, int flags)
+{
+    // Do not block while holding back files another request may wait on
+    if (flags == FLUX_REACTOR_ONCE) {
+        dyad_publish_flush (ctx);
+    }
+    if (flux_reactor_run (flux_get_reactor ((flux_t *)ctx->h), flags) < 0) {
+        DYAD_LOG_ERROR (ctx, "DYAD CLIENT: Flux reactor failed (errno = %d)", errno);
+        return DYAD_RC_SYSFAIL;
+    }
+    return DYAD_RC_OK;
+}
+
+/**
+ * @brief Completes @p *req if its consume is done: frees the request,
+ *        sets @p *req to @c NULL and returns the outcome of the consume.
+ */
+DYAD_CORE_FUNC_MODS dyad_rc_t dyad_request_finish (dyad_request_t **restrict req)
+{
+    dyad_rc_t rc = (*req)->rc;
+    dyad_request_free (*req);
+    *req = NULL;
+    return rc;
+}
+
+dyad_rc_t dyad_consume_async (dyad_ctx_t *restrict ctx,
+                              const char *restrict fname,
+                              dyad_request_t **restrict req)
 {
     DYAD_C_FUNCTION_START ();
     DYAD_C_FUNCTION_UPDATE_STR ("fname", fname);
     dyad_rc_t rc = DYAD_RC_OK;
-    int lock_fd = -1, io_fd = -1;
-    ssize_t file_size = -1;
-    char *file_data = NULL;
-    size_t data_len = 0ul;
-    struct flock exclusive_lock;
-    // If the context is not defined, then it is not valid.
-    // So, return DYAD_NOCTX
+    dyad_request_t *new_req = NULL;
+
+    if (req == NULL) {
+        rc = DYAD_RC_BADBUF;
+        goto consume_async_done;
+    }
+    *req = NULL;
     if (!ctx || !ctx->h) {
         rc = DYAD_RC_NOCTX;
-        goto consume_close;
-    }
-    // If dyad_get_metadata was successful, but mdata is still NULL,
-    // then we need to skip data transfer.
-    if (mdata == NULL) {
-        DYAD_LOG_INFO (ctx, "File '%s' is local!\n", fname);
-        rc = DYAD_RC_OK;
-        goto consume_close;
+        goto consume_async_done;
     }
-    // If the consumer-managed path is NULL or empty, then the context is not
-    // valid for a consumer operation. So, return DYAD_BADMANAGEDPATH
     if (ctx->cons_managed_path == NULL) {
         rc = DYAD_RC_BADMANAGEDPATH;
-        goto consume_close;
+        goto consume_async_done;
     }
-    // Set reenter to false to avoid recursively performing DYAD operations
-    ctx->reenter = false;
-    lock_fd = open (fname, O_RDWR | O_CREAT, 0666);
-    DYAD_C_FUNCTION_UPDATE_INT ("lock_fd", lock_fd);
-    if (lock_fd == -1) {
-        DYAD_LOG_ERROR (ctx, "Cannot create file (%s) for dyad_consume_w_metadata!", fname);
+    if (strlen (fname) > PATH_MAX) {
         rc = DYAD_RC_BADFIO;
-        goto consume_close;
+        goto consume_async_done;
     }
-    rc = dyad_excl_flock (ctx, lock_fd, &exclusive_lock);
-    if (DYAD_IS_ERROR (rc)) {
-        dyad_release_flock (ctx, lock_fd, &exclusive_lock);
-        goto consume_close;
+    new_req = (dyad_request_t *)calloc (1, sizeof (*new_req));
+    if (new_req == NULL) {
+        rc = DYAD_RC_SYSFAIL;
+        goto consume_async_done;
     }
-    if ((file_size = get_file_size (lock_fd)) <= 0) {
-        DYAD_LOG_INFO (ctx,
-                       "DYAD CLIENT: [node %u rank %u pid %d] File (%s with fd %d) is not fetched "
-                       "yet",
-                       ctx->node_idx,
-                       ctx->rank,
-                       ctx->pid,
-                       fname,
-                       lock_fd);
+    new_req->ctx = ctx;
+    new_req->rc = DYAD_RC_OK;
+    memcpy (new_req->fname, fname, strlen (fname));
+    if (ctx->relative_to_managed_path && (strlen (fname) > 0ul)
+        && (strncmp (fname, DYAD_PATH_DELIM, ctx->delim_len) != 0)) {
+        memcpy (new_req->upath, fname, strlen (fname));
+    } else if (!cmp_canonical_path_prefix (ctx, false, fname, new_req->upath, PATH_MAX)) {
+        // Not managed by DYAD: complete right away, as dyad_consume() would
+        new_req->ready = true;
+        new_req->done = true;
+        *req = new_req;
+        goto consume_async_done;
+    }
+    gen_path_key (new_req->upath, new_req->topic, PATH_MAX, ctx->key_depth, ctx->key_bins);
+    DYAD_LOG_INFO (ctx,
+                   "DYAD CLIENT: Start async consume of %s, key: %s.",
+                   new_req->upath,
+                   new_req->topic);
+    if (dyad_lookup_cached_mdata (ctx, new_req->upath, true, &new_req->mdata, &new_req->rc)) {
+        new_req->ready = true;
+        *req = new_req;
+        goto consume_async_done;
+    }
+    new_req->t_lookup = dyad_stats_now ();
+    new_req->f = flux_kvs_lookup ((flux_t *)ctx->h,
+                                  ctx->kvs_namespace,
+                                  FLUX_KVS_WAITCREATE,
+                                  new_req->topic);
+    if (new_req->f == NULL
+        || flux_future_then (new_req->f, -1.0, dyad_request_lookup_cb, new_req) < 0) {
+        DYAD_LOG_ERROR (ctx, "KVS lookup failed!\n");
+        dyad_request_free (new_req);
+        rc = DYAD_RC_NOTFOUND;
+        goto consume_async_done;
+    }
+    *req = new_req;
 
-        // Call dyad_get_data to dispatch a RPC to the producer's Flux broker
-        // and retrieve the data associated with the file
-        rc = dyad_get_data (ctx, mdata, &file_data, &data_len);
+consume_async_done:;
+    DYAD_C_FUNCTION_END ();
+    return rc;
+}
+
+dyad_rc_t dyad_test (dyad_request_t **req, bool *done)
+{
+    dyad_rc_t rc = DYAD_RC_OK;
+
+    if (req == NULL || *req == NULL || done == NULL) {
+        return DYAD_RC_BADBUF;
+    }
+    *done = false;
+    if (!(*req)->ready) {
+        rc = dyad_request_progress ((*req)->ctx, FLUX_REACTOR_NOWAIT);
         if (DYAD_IS_ERROR (rc)) {
-            DYAD_LOG_ERROR (ctx, "dyad_get_data failed!\n");
-            dyad_release_flock (ctx, lock_fd, &exclusive_lock);
-            goto consume_done;
+            return rc;
         }
-        DYAD_C_FUNCTION_UPDATE_INT ("data_len", data_len);
-        io_fd = open (fname, O_WRONLY);
-        DYAD_C_FUNCTION_UPDATE_INT ("io_fd", io_fd);
-        if (io_fd == -1) {
-            DYAD_LOG_ERROR (ctx, "Cannot open file (%s) in write mode for dyad_consume!\n", fname);
-            rc = DYAD_RC_BADFIO;
-            goto consume_close;
+    }
+    if (!(*req)->ready) {
+        return DYAD_RC_OK;
+    }
+    dyad_request_complete (*req);
+    *done = true;
+    return dyad_request_finish (req);
+}
+
+dyad_rc_t dyad_wait (dyad_request_t **req)
+{
+    dyad_rc_t rc = DYAD_RC_OK;
+
+    if (req == NULL || *req == NULL) {
+        return DYAD_RC_BADBUF;
+    }
+    while (!(*req)->ready) {
+        rc = dyad_request_progress ((*req)->ctx, FLUX_REACTOR_ONCE);
+        if (DYAD_IS_ERROR (rc)) {
+            return rc;
         }
-        // Call dyad_pull to fetch the data from the producer's
-        // Flux broker
-        rc = dyad_cons_store (ctx, mdata, io_fd, data_len, file_data);
+    }
+    dyad_request_complete (*req);
+    return dyad_request_finish (req);
+}
 
-        if (close (io_fd) != 0) {
-            rc = DYAD_RC_BADFIO;
-            dyad_release_flock (ctx, lock_fd, &exclusive_lock);
-            goto consume_done;
+dyad_rc_t dyad_wait_any (dyad_request_t **reqs, size_t n, size_t *index)
+{
+    dyad_ctx_t *ctx = NULL;
+    dyad_rc_t rc = DYAD_RC_OK;
+    size_t i = 0ul;
+
+    if (reqs == NULL || index == NULL) {
+        return DYAD_RC_BADBUF;
+    }
+    // Only the reactor of one context is run below, and those of other
+    // contexts belong to other threads
+    for (i = 0ul; i < n; i++) {
+        if (reqs[i] == NULL) {
+            continue;
         }
-        // If an error occured in dyad_pull, log it
-        // and return the corresponding DYAD return code
+        if (ctx != NULL && reqs[i]->ctx != ctx) {
+            return DYAD_RC_BADBUF;
+        }
+        ctx = reqs[i]->ctx;
+    }
+    for (;;) {
+        ctx = NULL;
+        for (i = 0ul; i < n; i++) {
+            if (reqs[i] == NULL) {
+                continue;
+            }
+            if (reqs[i]->ready) {
+                dyad_request_complete (reqs[i]);
+                *index = i;
+                return dyad_request_finish (&reqs[i]);
+            }
+            ctx = reqs[i]->ctx;
+        }
+        if (ctx == NULL) {
+            // Nothing left to wait for
+            *index = n;
+            return DYAD_RC_OK;
+        }
+        rc = dyad_request_progress (ctx, FLUX_REACTOR_ONCE);
         if (DYAD_IS_ERROR (rc)) {
-            DYAD_LOG_ERROR (ctx, "dyad_cons_store failed!\n");
-            dyad_release_flock (ctx, io_fd, &exclusive_lock);
-            goto consume_done;
-        };
+            return rc;
+        }
     }
-    dyad_release_flock (ctx, lock_fd, &exclusive_lock);
-    DYAD_C_FUNCTION_UPDATE_INT ("file_size", file_size);
+}
 
-    if (close (lock_fd) != 0) {
-        rc = DYAD_RC_BADFIO;
-        goto consume_done;
+dyad_rc_t dyad_get_stats (dyad_ctx_t *restrict ctx, dyad_stats_t *restrict stats)
+{
+    if (ctx == NULL) {
+        return DYAD_RC_NOCTX;
     }
-    rc = DYAD_RC_OK;
-consume_done:;
-    if (file_data != NULL) {
-        ctx->dtl_handle->return_buffer (ctx, (void **)&file_data);
+    if (stats == NULL) {
+        return DYAD_RC_BADBUF;
+    }
+    dyad_stats_snapshot (stats);
+    return DYAD_RC_OK;
+}
+
+dyad_rc_t dyad_reset_stats (dyad_ctx_t *restrict ctx)
+{
+    if (ctx == NULL) {
+        return DYAD_RC_NOCTX;
+    }
+    dyad_stats_reset ();
+    return DYAD_RC_OK;
+}
+
+/**
+ * @brief Fills the histogram of one phase from an entry of a
+ *        @c DYAD_STATS_RPC_NAME response.
+ */
+DYAD_CORE_FUNC_MODS dyad_rc_t dyad_unpack_stats_phase (const dyad_ctx_t *restrict ctx,
+                                                       json_t *restrict entry,
+                                                       dyad_stats_t *restrict stats)
+{
+    const char *name = NULL;
+    json_int_t count = 0;
+    json_int_t total_ns = 0;
+    json_int_t max_ns = 0;
+    json_t *buckets = NULL;
+    json_t *bucket = NULL;
+    dyad_stats_hist_t *hist = NULL;
+    size_t i = 0ul;
+    int phase = -1;
+
+    if (json_unpack (entry,
+                     "{s:s s:I s:I s:I s:o}",
+                     "name",
+                     &name,
+                     "count",
+                     &count,
+                     "total_ns",
+                     &total_ns,
+                     "max_ns",
+                     &max_ns,
+                     "buckets",
+                     &buckets)
+            < 0
+        || !json_is_array (buckets)) {
+        DYAD_LOG_ERROR (ctx, "Malformed phase in the response to %s", DYAD_STATS_RPC_NAME);
+        return DYAD_RC_BADUNPACK;
+    }
+    phase = dyad_stats_phase_from_name (name);
+    if (phase < 0) {
+        // Phases from a newer module are skipped
+        DYAD_LOG_DEBUG (ctx, "DYAD CLIENT: Skipping unknown phase '%s'", name);
+        return DYAD_RC_OK;
+    }
+    hist = &stats->phases[phase];
+    hist->count = (uint64_t)count;
+    hist->total_ns = (uint64_t)total_ns;
+    hist->max_ns = (uint64_t)max_ns;
+    json_array_foreach (buckets, i, bucket)
+    {
+        if (i < DYAD_STATS_NUM_BUCKETS) {
+            hist->buckets[i] = (uint64_t)json_integer_value (bucket);
+        }
+    }
+    return DYAD_RC_OK;
+}
+
+dyad_rc_t dyad_get_module_stats (dyad_ctx_t *restrict ctx,
+                                 uint32_t rank,
+                                 bool reset,
+                                 dyad_stats_t *restrict stats)
+{
+    DYAD_C_FUNCTION_START ();
+    DYAD_C_FUNCTION_UPDATE_INT ("rank", rank);
+    dyad_rc_t rc = DYAD_RC_OK;
+    flux_future_t *f = NULL;
+    json_t *phases = NULL;
+    json_t *entry = NULL;
+    size_t i = 0ul;
+
+    if (ctx == NULL || ctx->h == NULL) {
+        rc = DYAD_RC_NOCTX;
+        goto get_module_stats_done;
+    }
+    if (stats == NULL) {
+        rc = DYAD_RC_BADBUF;
+        goto get_module_stats_done;
+    }
+    memset (stats, 0, sizeof (*stats));
+    f = flux_rpc_pack ((flux_t *)ctx->h,
+                       DYAD_STATS_RPC_NAME,
+                       rank,
+                       0,
+                       "{s:b}",
+                       "reset",
+                       reset);
+    if (f == NULL) {
+        DYAD_LOG_ERROR (ctx, "Cannot send %s RPC to broker %u", DYAD_STATS_RPC_NAME, rank);
+        rc = DYAD_RC_BADRPC;
+        goto get_module_stats_done;
+    }
+    if (flux_rpc_get_unpack (f, "{s:o}", "phases", &phases) < 0) {
+        DYAD_LOG_ERROR (ctx,
+                        "%s RPC to broker %u failed (errno = %d)",
+                        DYAD_STATS_RPC_NAME,
+                        rank,
+                        errno);
+        rc = DYAD_RC_BADRPC;
+        goto get_module_stats_done;
+    }
+    if (!json_is_array (phases)) {
+        rc = DYAD_RC_BADUNPACK;
+        goto get_module_stats_done;
+    }
+    json_array_foreach (phases, i, entry)
+    {
+        rc = dyad_unpack_stats_phase (ctx, entry, stats);
+        if (DYAD_IS_ERROR (rc)) {
+            goto get_module_stats_done;
+        }
+    }
+
+get_module_stats_done:;
+    // phases is owned by the future
+    if (f != NULL) {
+        flux_future_destroy (f);
     }
-consume_close:;
-    // Set reenter to true to allow additional intercepting
-    ctx->reenter = true;
     DYAD_C_FUNCTION_END ();
     return rc;
 }
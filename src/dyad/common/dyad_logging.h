@@ -28,6 +28,9 @@ extern "C" {
 #define DYAD_LOG_WARN(dyad_ctx, ...) DYAD_NOOP_MACRO
 #define DYAD_LOG_INFO(dyad_ctx, ...) DYAD_NOOP_MACRO
 #define DYAD_LOG_DEBUG(dyad_ctx, ...) DYAD_NOOP_MACRO
+#define DYAD_LOG_ERROR_ON(h, ...) DYAD_NOOP_MACRO
+#define DYAD_LOG_WARN_ON(h, ...) DYAD_NOOP_MACRO
+#define DYAD_LOG_DEBUG_ON(h, ...) DYAD_NOOP_MACRO
 #define DYAD_LOG_STDOUT_REDIRECT(fpath) DYAD_NOOP_MACRO
 #define DYAD_LOG_STDERR_REDIRECT(fpath) DYAD_NOOP_MACRO
 //=============================================================================
@@ -94,6 +97,26 @@ extern "C" {
 #else
 #define DYAD_LOG_ERROR(dyad_ctx, ...) DYAD_NOOP_MACRO
 #endif
+
+// Same as above, on a given Flux handle rather than that of a context, for
+// threads that cannot share the handle of the context.
+#ifdef DYAD_LOGGER_LEVEL_DEBUG
+#define DYAD_LOG_DEBUG_ON(h, ...) flux_log ((flux_t *)(h), LOG_DEBUG, __VA_ARGS__);
+#else
+#define DYAD_LOG_DEBUG_ON(h, ...) DYAD_NOOP_MACRO
+#endif
+
+#ifdef DYAD_LOGGER_LEVEL_WARN
+#define DYAD_LOG_WARN_ON(h, ...) flux_log ((flux_t *)(h), LOG_WARNING, __VA_ARGS__);
+#else
+#define DYAD_LOG_WARN_ON(h, ...) DYAD_NOOP_MACRO
+#endif
+
+#ifdef DYAD_LOGGER_LEVEL_ERROR
+#define DYAD_LOG_ERROR_ON(h, ...) flux_log_error ((flux_t *)(h), __VA_ARGS__);
+#else
+#define DYAD_LOG_ERROR_ON(h, ...) DYAD_NOOP_MACRO
+#endif
 #endif                                 // DYAD_UTIL_LOGGER
 #elif defined(DYAD_LOGGER_CPP_LOGGER)  // CPP_LOGGER ---------------------------
 #include <cpp-logger/clogger.h>
@@ -141,6 +164,13 @@ extern "C" {
 #define DYAD_LOG_ERROR(dyad_ctx, ...) DYAD_NOOP_MACRO
 #endif
 #endif  // DYAD_LOGGER_FLUX ----------------------------------------------------
+
+// Loggers that do not go through a Flux handle ignore the one given here.
+#ifndef DYAD_LOG_ERROR_ON
+#define DYAD_LOG_ERROR_ON(h, ...) DYAD_LOG_ERROR (NULL, __VA_ARGS__)
+#define DYAD_LOG_WARN_ON(h, ...) DYAD_LOG_WARN (NULL, __VA_ARGS__)
+#define DYAD_LOG_DEBUG_ON(h, ...) DYAD_LOG_DEBUG (NULL, __VA_ARGS__)
+#endif
 //=============================================================================
 #endif  // DYAD_LOGGER_NO_LOG
 //=============================================================================
@@ -10,9 +10,11 @@
 #include <dyad/common/dyad_structures.h>
 
 #ifdef __cplusplus
+#include <cstddef>
 #include <cstdint>
 #else
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #endif
 
@@ -27,7 +29,7 @@ struct dyad_ctx {
     // Internal
     void *h;                      ///< the Flux handle for DYAD
     struct dyad_dtl *dtl_handle;  ///< Opaque handle to DTL info
-    const char *fname;            ///< Used to track which file is getting processed.
+    const char *fname;            ///< Unused, kept for the layout of the bindings
     bool use_fs_locks;            ///< Used to track if fs locks should be used.
     char *prod_real_path;         ///< producer managed real path
     char *cons_real_path;         ///< consumer managed real path
@@ -58,6 +60,40 @@ struct dyad_ctx {
     char *prod_managed_path;        ///< producer path managed by DYAD
     char *cons_managed_path;        ///< consumer path managed by DYAD
     bool relative_to_managed_path;  ///< relative path is relative to the managed path
+    size_t transfer_chunk_size;     ///< chunk size for streamed transfers, 0 to disable
+    unsigned transfer_window;       ///< chunks of a streamed transfer in flight, 0 for all
+    char *coalesce_path;            ///< node-local directory to coalesce fetches, or NULL
+    int compression;                ///< dyad_codec_t requested for transfers
+    size_t compression_threshold;   ///< smallest message to compress
+    int io_engine;                  ///< dyad_io_engine_t for file reads and writes
+    void *mdata_cache;              ///< dyad_mdata_cache_t of the process, or NULL
+    size_t mdata_cache_size;        ///< capacity of mdata_cache, 0 to disable
+    double mdata_cache_ttl;         ///< seconds an owner rank stays cached
+    double mdata_cache_neg_ttl;     ///< seconds a missing file stays cached
+    size_t stripe_threshold;        ///< smallest file to fetch in stripes, 0 to disable
+    unsigned stripe_count;          ///< maximum number of streams of a striped fetch
+    void *stripe_pool;              ///< dyad_worker_pool_t of striped fetches, or NULL
+    void *publish_txn;              ///< flux_kvs_txn_t of unpublished files, or NULL
+    unsigned publish_pending;       ///< number of files in publish_txn
+    size_t publish_pending_bytes;   ///< approximate size of publish_txn
+    double publish_since;           ///< monotonic time of the oldest file in publish_txn
+    unsigned publish_batch_count;   ///< files per KVS commit, 1 to disable batching
+    size_t publish_batch_bytes;     ///< size of publish_txn to commit, 0 for no limit
+    double publish_batch_timeout;   ///< age of publish_txn to commit, 0 for no limit
+    void *publish_timer;            ///< dyad_timer_t committing an aged publish_txn, or NULL
+    void *publish_h;                ///< flux_t of the publish_timer thread, or NULL
+    bool publish_checksum;          ///< publish the checksum of each file
+    bool mdata_legacy;              ///< publish the owner rank alone
+    unsigned store_threads;         ///< threads writing a large received buffer
+    void *store_pool;               ///< dyad_worker_pool_t writing parts of buffers, or NULL
+    bool store_direct;              ///< write fetched files with O_DIRECT
+    bool notify_events;             ///< announce and wait for files with Flux events
+    double notify_timeout;          ///< seconds between KVS checks of a waiting consumer
+    void *notify_buf;               ///< events of publish_txn, sent once it is committed
+    size_t notify_len;              ///< number of bytes in notify_buf
+    size_t ucx_slot_size;           ///< bytes per slot of the UCX receive ring
+    unsigned ucx_slots;             ///< number of slots of the UCX receive ring
+    size_t ucx_ep_cache_size;       ///< maximum number of cached UCX endpoints
 };
 typedef void *ucx_ep_cache_h;
 
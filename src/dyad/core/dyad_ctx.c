@@ -10,15 +10,25 @@
 // #include <dyad/core/dyad_core_int.h>
 #include <dyad/core/dyad_ctx.h>
 #include <dyad/dtl/dyad_dtl_api.h>
+#include <dyad/utils/codec.h>
+#include <dyad/utils/io_engine.h>
+#include <dyad/utils/mdata_cache.h>
+#include <dyad/utils/stats.h>
+#include <dyad/utils/timer.h>
 #include <dyad/utils/utils.h>
+#include <dyad/utils/worker_pool.h>
 #include <flux/core.h>
+#include <pthread.h>
+#include <strings.h>
 
 #ifdef __cplusplus
+#include <cerrno>
 #include <climits>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #else
+#include <errno.h>
 #include <limits.h>
 #include <linux/limits.h>
 #include <stdio.h>
@@ -32,6 +42,22 @@
 // 2) The DYAD context should be on the heap (done w/ malloc in dyad_init)
 static __thread dyad_ctx_t *ctx = NULL;
 
+// Set on the threads of a stripe pool, whose contexts never stripe themselves
+static __thread bool stripe_worker = false;
+
+// Finalizes the context of a thread set up by dyad_ctx_attach () when the
+// thread exits
+static pthread_key_t thread_ctx_key;
+static pthread_once_t thread_ctx_once = PTHREAD_ONCE_INIT;
+static bool thread_ctx_key_ok = false;
+
+#ifdef DYAD_PROFILER_DFTRACER
+// Tracing is set up once per process, by the first context, rather than
+// again by every thread attaching one, and torn down by dyad_finalize ()
+static pthread_mutex_t tracer_lock = PTHREAD_MUTEX_INITIALIZER;
+static bool tracer_initialized = false;
+#endif
+
 const struct dyad_ctx dyad_ctx_default = {
     // Internal
     NULL,   ///< h
@@ -66,7 +92,41 @@ const struct dyad_ctx dyad_ctx_default = {
     NULL,   ///< kvs_namespace
     NULL,   ///< prod_managed_path
     NULL,   ///< cons_managed_path
-    false   ///< relative_to_managed_path
+    false,  ///< relative_to_managed_path
+    0ul,    ///< transfer_chunk_size
+    16u,    ///< transfer_window
+    NULL,   ///< coalesce_path
+    0,      ///< compression
+    65536u, ///< compression_threshold
+    0,      ///< io_engine
+    NULL,   ///< mdata_cache
+    4096ul, ///< mdata_cache_size
+    60.0,   ///< mdata_cache_ttl
+    0.0,    ///< mdata_cache_neg_ttl
+    0ul,    ///< stripe_threshold
+    4u,     ///< stripe_count
+    NULL,   ///< stripe_pool
+    NULL,   ///< publish_txn
+    0u,     ///< publish_pending
+    0ul,    ///< publish_pending_bytes
+    0.0,    ///< publish_since
+    1u,     ///< publish_batch_count
+    65536ul,///< publish_batch_bytes
+    0.1,    ///< publish_batch_timeout
+    NULL,   ///< publish_timer
+    NULL,   ///< publish_h
+    false,  ///< publish_checksum
+    false,  ///< mdata_legacy
+    1u,     ///< store_threads
+    NULL,   ///< store_pool
+    false,  ///< store_direct
+    false,  ///< notify_events
+    1.0,    ///< notify_timeout
+    NULL,   ///< notify_buf
+    0ul,    ///< notify_len
+    16777216ul, ///< ucx_slot_size
+    4u,     ///< ucx_slots
+    256ul   ///< ucx_ep_cache_size
 };
 
 DYAD_DLL_EXPORTED dyad_ctx_t *dyad_ctx_get (void)
@@ -98,6 +158,64 @@ DYAD_DLL_EXPORTED void dyad_ctx_init (const dyad_dtl_comm_mode_t dtl_comm_mode,
     DYAD_C_FUNCTION_END ();
 }
 
+static void dyad_ctx_thread_exit (void *arg);
+
+static void dyad_ctx_thread_key_create (void)
+{
+    thread_ctx_key_ok = (pthread_key_create (&thread_ctx_key, dyad_ctx_thread_exit) == 0);
+}
+
+#ifdef DYAD_PROFILER_DFTRACER
+/**
+ * @brief Initializes DFTracer for the process, unless a context already did.
+ */
+static void dyad_tracer_init (void)
+{
+    pthread_mutex_lock (&tracer_lock);
+    if (!tracer_initialized) {
+        const char *file_prefix = getenv (DFTRACER_LOG_FILE);
+        if (file_prefix == NULL)
+            file_prefix = "./dyad_";
+        char log_file[4096] = {'\0'};
+        sprintf (log_file, "%s_core-%d.pfw", file_prefix, getpid ());
+        DFTRACER_C_INIT_NO_BIND (log_file, NULL, NULL);
+        tracer_initialized = true;
+    }
+    pthread_mutex_unlock (&tracer_lock);
+}
+#endif
+
+/**
+ * @brief Sets up the context of a thread of the stripe pool of another
+ *        context, when the thread starts.
+ *
+ * @details
+ * Flux handles and DTL connections cannot be shared between threads, so
+ * each worker has a context of its own. It lives as long as the worker,
+ * i.e., until @c dyad_clear() destroys the pool of the parent context.
+ */
+static void dyad_stripe_worker_start (void *arg)
+{
+    (void)arg;
+    stripe_worker = true;
+    dyad_ctx_attach (DYAD_COMM_RECV);
+}
+
+DYAD_DLL_EXPORTED dyad_ctx_t *dyad_ctx_attach (const dyad_dtl_comm_mode_t dtl_comm_mode)
+{
+    if (ctx != NULL) {
+        return ctx;
+    }
+    pthread_once (&thread_ctx_once, dyad_ctx_thread_key_create);
+    // Never share the Flux handle of another thread: handles are not
+    // thread-safe
+    dyad_ctx_init (dtl_comm_mode, NULL);
+    if (ctx != NULL && thread_ctx_key_ok) {
+        pthread_setspecific (thread_ctx_key, ctx);
+    }
+    return ctx;
+}
+
 DYAD_DLL_EXPORTED void dyad_ctx_fini (void)
 {
     // pydyad closes dyad by calling dyad_finalize ()
@@ -133,14 +251,10 @@ dyad_rc_t dyad_init (bool debug,
     DYAD_LOGGER_INIT ();
     unsigned my_rank = 0u;
     size_t namespace_len = 0ul;
+    const char *e = NULL;
 
 #ifdef DYAD_PROFILER_DFTRACER
-    const char *file_prefix = getenv (DFTRACER_LOG_FILE);
-    if (file_prefix == NULL)
-        file_prefix = "./dyad_";
-    char log_file[4096] = {'\0'};
-    sprintf (log_file, "%s_core-%d.pfw", file_prefix, getpid ());
-    DFTRACER_C_INIT_NO_BIND (log_file, NULL, NULL);
+    dyad_tracer_init ();
 #endif
     DYAD_C_FUNCTION_START ();
     dyad_rc_t rc = DYAD_RC_OK;
@@ -291,6 +405,180 @@ dyad_rc_t dyad_init (bool debug,
     DYAD_C_FUNCTION_UPDATE_STR ("prod_managed_path", ctx->prod_managed_path);
     DYAD_C_FUNCTION_UPDATE_STR ("cons_managed_path", ctx->cons_managed_path);
     ctx->use_fs_locks = true;  // This is default value except for streams which dont have a fp.
+    // Not an argument of dyad_init () so that the existing bindings keep working.
+    if ((e = getenv (DYAD_TRANSFER_CHUNK_SIZE_ENV))) {
+        ctx->transfer_chunk_size = (size_t)strtoull (e, NULL, 10);
+    }
+    if ((e = getenv (DYAD_TRANSFER_WINDOW_ENV))) {
+        ctx->transfer_window = (unsigned)strtoul (e, NULL, 10);
+    }
+    DYAD_LOG_DEBUG (ctx,
+                    "DYAD_CORE: transfer_chunk_size %zu, window of %u chunks",
+                    ctx->transfer_chunk_size,
+                    ctx->transfer_window);
+    if ((e = getenv (DYAD_STRIPE_THRESHOLD_ENV))) {
+        ctx->stripe_threshold = (size_t)strtoull (e, NULL, 10);
+    }
+    if ((e = getenv (DYAD_STRIPE_COUNT_ENV))) {
+        ctx->stripe_count = (unsigned)strtoul (e, NULL, 10);
+    }
+    DYAD_LOG_DEBUG (ctx,
+                    "DYAD_CORE: up to %u stripes from %zu bytes",
+                    ctx->stripe_count,
+                    ctx->stripe_threshold);
+    if (!stripe_worker && ctx->stripe_threshold > 0ul && ctx->stripe_count > 1u
+        && dyad_worker_pool_create (ctx->stripe_count - 1u,
+                                    dyad_stripe_worker_start,
+                                    NULL,
+                                    (dyad_worker_pool_t **)&ctx->stripe_pool)
+               < 0) {
+        DYAD_LOG_WARN (ctx, "DYAD_CORE: cannot create the stripe workers, fetching inline");
+        ctx->stripe_pool = NULL;
+    }
+    if ((e = getenv (DYAD_PUBLISH_BATCH_COUNT_ENV))) {
+        ctx->publish_batch_count = (unsigned)strtoul (e, NULL, 10);
+    }
+    if ((e = getenv (DYAD_PUBLISH_BATCH_BYTES_ENV))) {
+        ctx->publish_batch_bytes = (size_t)strtoull (e, NULL, 10);
+    }
+    if ((e = getenv (DYAD_PUBLISH_BATCH_TIMEOUT_ENV))) {
+        ctx->publish_batch_timeout = strtod (e, NULL);
+    }
+    DYAD_LOG_DEBUG (ctx,
+                    "DYAD_CORE: publish batches of %u files, %zu bytes or %.3f s",
+                    ctx->publish_batch_count,
+                    ctx->publish_batch_bytes,
+                    ctx->publish_batch_timeout);
+    // The timer commits a batch its producer leaves aside, e.g., while
+    // computing or consuming, once it is older than the timeout
+    if (!stripe_worker && ctx->publish_batch_count > 1u && ctx->publish_batch_timeout > 0.0
+        && dyad_timer_create ((dyad_timer_t **)&ctx->publish_timer) < 0) {
+        DYAD_LOG_WARN (ctx, "DYAD_CORE: cannot create the publish timer, aging batches on publish");
+        ctx->publish_timer = NULL;
+    }
+    if ((e = getenv (DYAD_PUBLISH_CHECKSUM_ENV)) && strcmp (e, "0") != 0) {
+        ctx->publish_checksum = true;
+    }
+    if ((e = getenv (DYAD_MDATA_LEGACY_ENV)) && strcmp (e, "0") != 0) {
+        ctx->mdata_legacy = true;
+    }
+    if ((e = getenv (DYAD_NOTIFY_ENV)) && strlen (e) > 0ul) {
+        if (strcasecmp (e, "event") == 0) {
+            ctx->notify_events = true;
+        } else if (strcasecmp (e, "kvs") != 0) {
+            DYAD_LOG_ERROR (ctx, "DYAD_CORE: Unknown notification channel '%s', using kvs", e);
+        }
+    }
+    if ((e = getenv (DYAD_NOTIFY_TIMEOUT_ENV))) {
+        ctx->notify_timeout = strtod (e, NULL);
+    }
+    DYAD_LOG_DEBUG (ctx,
+                    "DYAD_CORE: notifications through %s",
+                    ctx->notify_events ? "events" : "kvs");
+    if ((e = getenv (DYAD_COALESCE_PATH_ENV)) && strlen (e) > 0ul) {
+        ctx->coalesce_path = strdup (e);
+        if (ctx->coalesce_path == NULL) {
+            rc = DYAD_RC_SYSFAIL;
+            goto init_region_failed;
+        }
+        DYAD_LOG_DEBUG (ctx, "DYAD_CORE: coalesce_path %s", ctx->coalesce_path);
+    }
+    if ((e = getenv (DYAD_COMPRESSION_ENV)) && strlen (e) > 0ul) {
+        int codec = dyad_codec_from_name (e);
+        // Only ask for codecs this client can decode
+        if (codec < 0 || !dyad_codec_is_available ((dyad_codec_t)codec)) {
+            DYAD_LOG_ERROR (ctx, "DYAD_CORE: compression '%s' is not supported by this build", e);
+        } else {
+            ctx->compression = codec;
+        }
+    }
+    if ((e = getenv (DYAD_COMPRESSION_THRESHOLD_ENV))) {
+        ctx->compression_threshold = (size_t)strtoull (e, NULL, 10);
+    }
+    DYAD_LOG_DEBUG (ctx,
+                    "DYAD_CORE: compression %s above %zu bytes",
+                    dyad_codec_name ((dyad_codec_t)ctx->compression),
+                    ctx->compression_threshold);
+    if ((e = getenv (DYAD_IO_ENGINE_ENV)) && strlen (e) > 0ul) {
+        int engine = dyad_io_engine_from_name (e);
+        if (engine < 0 || !dyad_io_engine_is_available ((dyad_io_engine_t)engine)) {
+            DYAD_LOG_ERROR (ctx, "DYAD_CORE: I/O engine '%s' is not supported by this build", e);
+        } else {
+            ctx->io_engine = engine;
+        }
+    }
+    DYAD_LOG_DEBUG (ctx,
+                    "DYAD_CORE: io_engine %s",
+                    dyad_io_engine_name ((dyad_io_engine_t)ctx->io_engine));
+    if ((e = getenv (DYAD_STORE_THREADS_ENV))) {
+        ctx->store_threads = (unsigned)strtoul (e, NULL, 10);
+        if (ctx->store_threads == 0u) {
+            ctx->store_threads = 1u;
+        }
+    }
+    if ((e = getenv (DYAD_STORE_DIRECT_ENV)) && strcmp (e, "0") != 0) {
+        ctx->store_direct = true;
+    }
+    DYAD_LOG_DEBUG (ctx,
+                    "DYAD_CORE: store with %u threads%s",
+                    ctx->store_threads,
+                    ctx->store_direct ? " and O_DIRECT" : "");
+    // Stripe workers already write their stripes concurrently
+    if (!stripe_worker && ctx->store_threads > 1u
+        && dyad_worker_pool_create (ctx->store_threads - 1u,
+                                    NULL,
+                                    NULL,
+                                    (dyad_worker_pool_t **)&ctx->store_pool)
+               < 0) {
+        DYAD_LOG_WARN (ctx, "DYAD_CORE: cannot create the store threads, writing inline");
+        ctx->store_pool = NULL;
+    }
+    if ((e = getenv (DYAD_UCX_SLOT_SIZE_ENV))) {
+        ctx->ucx_slot_size = (size_t)strtoull (e, NULL, 10);
+        if (ctx->ucx_slot_size == 0ul) {
+            ctx->ucx_slot_size = dyad_ctx_default.ucx_slot_size;
+        }
+    }
+    if ((e = getenv (DYAD_UCX_SLOTS_ENV))) {
+        ctx->ucx_slots = (unsigned)strtoul (e, NULL, 10);
+        if (ctx->ucx_slots == 0u) {
+            ctx->ucx_slots = 1u;
+        }
+    }
+    if ((e = getenv (DYAD_UCX_EP_CACHE_SIZE_ENV))) {
+        ctx->ucx_ep_cache_size = (size_t)strtoull (e, NULL, 10);
+        if (ctx->ucx_ep_cache_size == 0ul) {
+            ctx->ucx_ep_cache_size = 1ul;
+        }
+    }
+    if ((e = getenv (DYAD_STATS_ENV)) && strcmp (e, "0") == 0) {
+        dyad_stats_enable (false);
+    }
+    if ((e = getenv (DYAD_MDATA_CACHE_SIZE_ENV))) {
+        ctx->mdata_cache_size = (size_t)strtoull (e, NULL, 10);
+    }
+    if ((e = getenv (DYAD_MDATA_CACHE_TTL_ENV))) {
+        ctx->mdata_cache_ttl = strtod (e, NULL);
+    }
+    if ((e = getenv (DYAD_MDATA_CACHE_NEG_TTL_ENV))) {
+        ctx->mdata_cache_neg_ttl = strtod (e, NULL);
+    }
+    if (ctx->mdata_cache_size > 0ul) {
+        rc = dyad_mdata_cache_acquire (ctx->kvs_namespace,
+                                       ctx->mdata_cache_size,
+                                       ctx->mdata_cache_ttl,
+                                       ctx->mdata_cache_neg_ttl,
+                                       (dyad_mdata_cache_t **)&ctx->mdata_cache);
+        if (DYAD_IS_ERROR (rc)) {
+            DYAD_LOG_ERROR (ctx, "DYAD_CORE: cannot create the metadata cache");
+            goto init_region_failed;
+        }
+    }
+    DYAD_LOG_DEBUG (ctx,
+                    "DYAD_CORE: metadata cache of %zu entries, ttl %.1f s, negative ttl %.1f s",
+                    ctx->mdata_cache_size,
+                    ctx->mdata_cache_ttl,
+                    ctx->mdata_cache_neg_ttl);
     // TODO Print logging info
     rc = DYAD_RC_OK;
     // TODO: Add folder option here.
@@ -741,6 +1029,43 @@ set_cons_path_region_finish:;
     return rc;
 }
 
+/**
+ * @brief Commits the files left in the publication batch of @p ctx, so that
+ *        none stays unpublished once the Flux handle is closed.
+ *
+ * @details
+ * Counterpart of @c dyad_flush() for finalization. Always waits for the
+ * commit, even with @c DYAD_ASYNC_PUBLISH, as the handle is closed next.
+ */
+static void dyad_commit_pending (dyad_ctx_t *ctx)
+{
+    flux_future_t *f = NULL;
+
+    if (ctx->publish_txn == NULL) {
+        return;
+    }
+    if (ctx->h != NULL && ctx->publish_pending > 0u) {
+        f = flux_kvs_commit ((flux_t *)ctx->h,
+                             ctx->kvs_namespace,
+                             0,
+                             (flux_kvs_txn_t *)ctx->publish_txn);
+        if (f == NULL || flux_future_get (f, NULL) < 0) {
+            DYAD_LOG_ERROR (ctx,
+                            "DYAD_CORE: Could not publish the last %u files",
+                            ctx->publish_pending);
+        }
+        flux_future_destroy (f);
+    }
+    flux_kvs_txn_destroy ((flux_kvs_txn_t *)ctx->publish_txn);
+    ctx->publish_txn = NULL;
+    ctx->publish_pending = 0u;
+    ctx->publish_pending_bytes = 0ul;
+    // Consumers waiting on events see these files on their next KVS check
+    free (ctx->notify_buf);
+    ctx->notify_buf = NULL;
+    ctx->notify_len = 0ul;
+}
+
 DYAD_DLL_EXPORTED dyad_rc_t dyad_clear (void)
 {
     DYAD_C_FUNCTION_START ();
@@ -750,6 +1075,14 @@ DYAD_DLL_EXPORTED dyad_rc_t dyad_clear (void)
         rc = DYAD_RC_OK;
         goto clear_region_finish;
     }
+    // Stop the timer first, so that the batch is no longer shared
+    dyad_timer_destroy ((dyad_timer_t *)ctx->publish_timer);
+    ctx->publish_timer = NULL;
+    if (ctx->publish_h != NULL) {
+        flux_close ((flux_t *)ctx->publish_h);
+        ctx->publish_h = NULL;
+    }
+    dyad_commit_pending (ctx);
     dyad_dtl_finalize (ctx);
     if (ctx->h != NULL) {
         flux_close (ctx->h);
@@ -775,28 +1108,86 @@ DYAD_DLL_EXPORTED dyad_rc_t dyad_clear (void)
         free (ctx->cons_real_path);
         ctx->cons_real_path = NULL;
     }
+    if (ctx->coalesce_path != NULL) {
+        free (ctx->coalesce_path);
+        ctx->coalesce_path = NULL;
+    }
+    dyad_mdata_cache_release ((dyad_mdata_cache_t *)ctx->mdata_cache);
+    ctx->mdata_cache = NULL;
+    // The contexts of the workers are released as they exit
+    dyad_worker_pool_destroy ((dyad_worker_pool_t *)ctx->stripe_pool);
+    ctx->stripe_pool = NULL;
+    // and the io_uring rings of the store threads likewise
+    dyad_worker_pool_destroy ((dyad_worker_pool_t *)ctx->store_pool);
+    ctx->store_pool = NULL;
     rc = DYAD_RC_OK;
 clear_region_finish:;
     DYAD_C_FUNCTION_END ();
     return rc;
 }
 
-DYAD_DLL_EXPORTED dyad_rc_t dyad_finalize (void)
+/**
+ * @brief Writes a summary of the latency histograms of the process to the
+ *        file named by @c DYAD_STATS_DUMP, if set.
+ */
+static void dyad_dump_stats (const dyad_ctx_t *ctx)
+{
+    const char *path = getenv (DYAD_STATS_DUMP_ENV);
+    char label[64] = {'\0'};
+    dyad_stats_t stats;
+
+    if (path == NULL || strlen (path) == 0ul) {
+        return;
+    }
+    dyad_stats_snapshot (&stats);
+    snprintf (label, sizeof (label), "rank %u pid %d", ctx->rank, ctx->pid);
+    if (dyad_stats_dump (&stats, label, path) != 0) {
+        DYAD_LOG_STDERR ("Cannot write DYAD stats to %s: %s\n", path, strerror (errno));
+    }
+}
+
+/**
+ * @brief Releases the context of the calling thread, if any.
+ */
+static void dyad_free_ctx (void)
 {
-    DYAD_C_FUNCTION_START ();
-    dyad_rc_t rc = DYAD_RC_OK;
     if (ctx == NULL) {
-        rc = DYAD_RC_OK;
-        goto finalize_region_finish;
+        return;
     }
     dyad_clear ();
     free (ctx);
     ctx = NULL;
-    rc = DYAD_RC_OK;
-finalize_region_finish:;
+}
+
+/**
+ * @brief Destructor of the context of a thread set up by
+ *        @c dyad_ctx_attach(), called when the thread exits.
+ *
+ * @details
+ * Unlike @c dyad_finalize(), neither dumps the latency histograms nor stops
+ * the profiler, as both are shared with the other threads of the process.
+ */
+static void dyad_ctx_thread_exit (void *arg)
+{
+    (void)arg;
+    dyad_free_ctx ();
+}
+
+DYAD_DLL_EXPORTED dyad_rc_t dyad_finalize (void)
+{
+    DYAD_C_FUNCTION_START ();
+    if (ctx != NULL) {
+        dyad_dump_stats (ctx);
+    }
+    dyad_free_ctx ();
     DYAD_C_FUNCTION_END ();
 #ifdef DYAD_PROFILER_DFTRACER
-    DFTRACER_C_FINI ();
+    pthread_mutex_lock (&tracer_lock);
+    if (tracer_initialized) {
+        DFTRACER_C_FINI ();
+        tracer_initialized = false;
+    }
+    pthread_mutex_unlock (&tracer_lock);
 #endif
-    return rc;
+    return DYAD_RC_OK;
 }
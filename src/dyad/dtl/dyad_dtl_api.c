@@ -32,6 +32,8 @@ dyad_rc_t dyad_dtl_init (dyad_ctx_t *ctx,
     }
 
     ctx->dtl_handle->mode = mode;
+    ctx->dtl_handle->rpc_register = NULL;
+    ctx->dtl_handle->rpc_future = NULL;
     // clang-format off
 #if defined (DYAD_ENABLE_UCX_DTL)
     if (mode == DYAD_DTL_UCX) {
@@ -95,6 +95,10 @@ typedef union dyad_dtl_private dyad_dtl_private_t;
  * return_buffer()      // service: release send buffer
  * close_connection()   // service: tear down DTL data channel
  * @endcode
+ *
+ * When the service maps the file into memory instead of reading it,
+ * @c get_buffer() and @c return_buffer() are skipped and @c send() is
+ * replaced by @c send_mapped().
  */
 struct dyad_dtl {
     dyad_dtl_private_t private_dtl;  ///< Opaque pointer to the active backend context.
@@ -142,6 +146,39 @@ struct dyad_dtl {
      */
     dyad_rc_t (*rpc_recv_response) (const dyad_ctx_t *ctx, flux_future_t *f);
 
+    /**
+     * @brief Hands over the RPC through which the responses of the current
+     *        fetch come.
+     *
+     * @details
+     * A backend may send the fetch request again, e.g., after the service
+     * rejected it with @c ESTALE because it lost the registration of this
+     * consumer. It does so at most once per fetch, while waiting in
+     * @c recv(), or here if @p f already failed that way. @c NULL for
+     * backends that never send a request again.
+     *
+     * @param[in] ctx DYAD context.
+     * @param[in] f   Flux future passed to @c rpc_recv_response().
+     * @return @p f, or the future of the request sent again, in which case
+     *         @p f is destroyed and the caller owns the returned future.
+     */
+    flux_future_t *(*rpc_future) (const dyad_ctx_t *ctx, flux_future_t *f);
+
+    /**
+     * @brief Registers a consumer from an incoming
+     *        @c DYAD_DTL_REGISTER_RPC_NAME request on the service.
+     *
+     * @details
+     * @c NULL for backends whose fetch requests carry everything the
+     * service needs.
+     *
+     * @param[in]  ctx DYAD context.
+     * @param[in]  msg Incoming Flux RPC message.
+     * @param[out] key Key under which the consumer is known, returned to it.
+     * @return @c DYAD_RC_OK on success, or an error code on failure.
+     */
+    dyad_rc_t (*rpc_register) (const dyad_ctx_t *ctx, const flux_msg_t *msg, uint64_t *key);
+
     /**
      * @brief Allocates a backend-managed buffer for data transfer.
      *
@@ -189,6 +226,23 @@ struct dyad_dtl {
      */
     dyad_rc_t (*send) (const dyad_ctx_t *ctx, void *buf, size_t buflen);
 
+    /**
+     * @brief Sends file data directly from memory not obtained through
+     *        @c get_buffer(), such as a file mapped with @c mmap().
+     *
+     * @details
+     * Unlike @c send(), @p buf holds only the file contents. Any framing
+     * the backend needs (e.g., the chunk headers of the UCX DTL) is added
+     * by the backend. @p buf must stay valid and unchanged until the call
+     * returns.
+     *
+     * @param[in] ctx    DYAD context.
+     * @param[in] buf    File contents to send.
+     * @param[in] buflen Number of bytes to send.
+     * @return @c DYAD_RC_OK on success, or an error code on failure.
+     */
+    dyad_rc_t (*send_mapped) (const dyad_ctx_t *ctx, void *buf, size_t buflen);
+
     /**
      * @brief Receives file data from the producer over the DTL data channel.
      *
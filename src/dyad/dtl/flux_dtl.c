@@ -37,6 +37,8 @@ dyad_rc_t dyad_dtl_flux_init (const dyad_ctx_t *ctx,
     ctx->dtl_handle->return_buffer = dyad_dtl_flux_return_buffer;
     ctx->dtl_handle->establish_connection = dyad_dtl_flux_establish_connection;
     ctx->dtl_handle->send = dyad_dtl_flux_send;
+    // flux_respond_raw () copies the data into the response either way
+    ctx->dtl_handle->send_mapped = dyad_dtl_flux_send;
     ctx->dtl_handle->recv = dyad_dtl_flux_recv;
     ctx->dtl_handle->close_connection = dyad_dtl_flux_close_connection;
 
@@ -191,11 +193,14 @@ dyad_rc_t dyad_dtl_flux_recv (const dyad_ctx_t *ctx, void **buf, size_t *buflen)
     }
     rc = flux_rpc_get_raw (dtl_handle->f, (const void **)&tmp_buf, &tmp_buflen);
     if (FLUX_IS_ERROR (rc)) {
-        DYAD_LOG_ERROR (ctx, "Could not get file data from Flux RPC");
-        if (errno == ENODATA)
+        // ENODATA is the regular end of a streamed transfer
+        if (errno == ENODATA) {
+            DYAD_LOG_DEBUG (ctx, "Reached the end of the Flux RPC stream");
             dyad_rc = DYAD_RC_RPC_FINISHED;
-        else
+        } else {
+            DYAD_LOG_ERROR (ctx, "Could not get file data from Flux RPC");
             dyad_rc = DYAD_RC_BADRPC;
+        }
         goto finish_recv;
     }
     *buflen = tmp_buflen;
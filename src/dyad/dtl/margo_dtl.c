@@ -4,7 +4,6 @@
 #error "no config"
 #endif
 
-#include <assert.h>
 #include <inttypes.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -49,6 +48,199 @@ MERCURY_GEN_PROC (margo_rpc_in_t, ((int64_t)(n)) ((hg_bulk_t)(bulk)))
  */
 MERCURY_GEN_PROC (margo_rpc_out_t, ((int32_t)(ret)))
 
+/**
+ * @brief Size class of a buffer of @p size bytes in the registered bulk
+ *        buffer pool.
+ *
+ * @return The index of the smallest class holding @p size bytes, or -1 if
+ *         @p size is larger than all classes.
+ */
+static inline int margo_pool_class (size_t size)
+{
+    size_t class_size = DYAD_MARGO_POOL_MIN_CLASS;
+    int cls = 0;
+    for (cls = 0; cls < (int)DYAD_MARGO_POOL_CLASSES; cls++) {
+        if (size <= class_size) {
+            return cls;
+        }
+        class_size *= 4ul;
+    }
+    return -1;
+}
+
+/**
+ * @brief Takes a registered buffer of at least @p size bytes from the pool.
+ *
+ * @details
+ * Reuses a free buffer of the size class of @p size, or allocates a new
+ * page-aligned one, so that consumers can write it with @c O_DIRECT, and
+ * registers it with @c margo_bulk_create() for both RDMA directions.
+ * Buffers larger than the largest class are registered for @p size bytes
+ * exactly. The buffer is added to the list of used buffers until
+ * @c margo_pool_release(). Thread-safe.
+ *
+ * @param[in,out] margo_handle Margo DTL internal state.
+ * @param[in]     size         Number of bytes needed.
+ * @param[out]    pbuf         Set to the buffer on success.
+ *
+ * @return @c dyad_rc_t return code:
+ * @retval DYAD_RC_OK             A buffer was taken.
+ * @retval DYAD_RC_SYSFAIL        A new buffer could not be allocated.
+ * @retval DYAD_RC_MARGOCOMM_FAIL A new buffer could not be registered.
+ */
+static dyad_rc_t margo_pool_get (dyad_dtl_margo_t *margo_handle,
+                                 size_t size,
+                                 margo_pool_buf_t **pbuf)
+{
+    int cls = margo_pool_class (size);
+    margo_pool_buf_t *buf = NULL;
+
+    pthread_mutex_lock (&margo_handle->pool_lock);
+    if (cls >= 0 && margo_handle->pool_free[cls] != NULL) {
+        buf = margo_handle->pool_free[cls];
+        margo_handle->pool_free[cls] = buf->next;
+        margo_handle->pool_nfree[cls]--;
+    }
+    pthread_mutex_unlock (&margo_handle->pool_lock);
+
+    if (buf == NULL) {
+        buf = (margo_pool_buf_t *)malloc (sizeof (margo_pool_buf_t));
+        if (buf == NULL) {
+            return DYAD_RC_SYSFAIL;
+        }
+        buf->cls = cls;
+        buf->size = (cls >= 0) ? (DYAD_MARGO_POOL_MIN_CLASS << (2 * cls)) : size;
+        buf->bulk = HG_BULK_NULL;
+        if (posix_memalign (&buf->addr, (size_t)sysconf (_SC_PAGESIZE), buf->size) != 0) {
+            free (buf);
+            return DYAD_RC_SYSFAIL;
+        }
+        if (margo_bulk_create (margo_handle->mid,
+                               1,
+                               &buf->addr,
+                               &buf->size,
+                               HG_BULK_READWRITE,
+                               &buf->bulk)
+            != HG_SUCCESS) {
+            free (buf->addr);
+            free (buf);
+            return DYAD_RC_MARGOCOMM_FAIL;
+        }
+    }
+
+    pthread_mutex_lock (&margo_handle->pool_lock);
+    buf->next = margo_handle->pool_used;
+    margo_handle->pool_used = buf;
+    pthread_mutex_unlock (&margo_handle->pool_lock);
+    *pbuf = buf;
+    return DYAD_RC_OK;
+}
+
+/**
+ * @brief Finds the used buffer of the pool that starts at @p addr.
+ *
+ * @details
+ * The caller must hold @c margo_handle->pool_lock.
+ *
+ * @return The buffer, or @c NULL if @p addr is not a used buffer of the
+ *         pool.
+ */
+static margo_pool_buf_t *margo_pool_find (const dyad_dtl_margo_t *margo_handle, const void *addr)
+{
+    margo_pool_buf_t *buf = NULL;
+    for (buf = margo_handle->pool_used; buf != NULL; buf = buf->next) {
+        if (buf->addr == addr) {
+            return buf;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Frees a buffer of the pool along with its bulk handle.
+ */
+static void margo_pool_free (margo_pool_buf_t *buf)
+{
+    if (buf->bulk != HG_BULK_NULL) {
+        margo_bulk_free (buf->bulk);
+    }
+    free (buf->addr);
+    free (buf);
+}
+
+/**
+ * @brief Gives the used buffer of the pool that starts at @p addr back to
+ *        the pool.
+ *
+ * @details
+ * Up to @c DYAD_MARGO_POOL_KEEP buffers per size class are kept registered
+ * for later transfers. Other buffers are freed. Thread-safe.
+ *
+ * @param[in,out] margo_handle Margo DTL internal state.
+ * @param[in]     addr         Start of the buffer.
+ *
+ * @return @c DYAD_RC_OK, or @c DYAD_RC_BADBUF if @p addr is not a used
+ *         buffer of the pool.
+ */
+static dyad_rc_t margo_pool_release (dyad_dtl_margo_t *margo_handle, const void *addr)
+{
+    margo_pool_buf_t **link = NULL;
+    margo_pool_buf_t *buf = NULL;
+
+    pthread_mutex_lock (&margo_handle->pool_lock);
+    for (link = &(margo_handle->pool_used); *link != NULL; link = &((*link)->next)) {
+        if ((*link)->addr == addr) {
+            break;
+        }
+    }
+    buf = *link;
+    if (buf == NULL) {
+        pthread_mutex_unlock (&margo_handle->pool_lock);
+        return DYAD_RC_BADBUF;
+    }
+    *link = buf->next;
+    if (buf->cls >= 0 && margo_handle->pool_nfree[buf->cls] < DYAD_MARGO_POOL_KEEP) {
+        buf->next = margo_handle->pool_free[buf->cls];
+        margo_handle->pool_free[buf->cls] = buf;
+        margo_handle->pool_nfree[buf->cls]++;
+        buf = NULL;
+    }
+    pthread_mutex_unlock (&margo_handle->pool_lock);
+    if (buf != NULL) {
+        margo_pool_free (buf);
+    }
+    return DYAD_RC_OK;
+}
+
+/**
+ * @brief Releases every buffer of the pool, whether free or still used.
+ *
+ * @details
+ * Must be called before the Margo instance is finalized, as the bulk
+ * handles belong to it.
+ *
+ * @param[in,out] margo_handle Margo DTL internal state.
+ */
+static void margo_pool_destroy (dyad_dtl_margo_t *margo_handle)
+{
+    margo_pool_buf_t *buf = NULL;
+    margo_pool_buf_t **list = NULL;
+    unsigned cls = 0u;
+    // The last iteration releases the buffers still in use
+    for (cls = 0u; cls <= DYAD_MARGO_POOL_CLASSES; cls++) {
+        list = (cls < DYAD_MARGO_POOL_CLASSES) ? &(margo_handle->pool_free[cls])
+                                               : &(margo_handle->pool_used);
+        while (*list != NULL) {
+            buf = *list;
+            *list = buf->next;
+            margo_pool_free (buf);
+        }
+        if (cls < DYAD_MARGO_POOL_CLASSES) {
+            margo_handle->pool_nfree[cls] = 0u;
+        }
+    }
+}
+
 /**
  * @brief Margo RPC handler that pulls file data from the producer via RDMA.
  *
@@ -64,30 +256,27 @@ MERCURY_GEN_PROC (margo_rpc_out_t, ((int32_t)(ret)))
  *     Margo instance via @c margo_registered_data().
  *  3. Unpacks the input (@c margo_rpc_in_t) to obtain the transfer
  *     size (@c n) and the producer's bulk handle.
- *  4. Allocates a receive buffer of @c n bytes and creates a local
- *     Mercury bulk handle with @c HG_BULK_WRITE_ONLY access.
+ *  4. Takes a registered buffer of at least @c n bytes from the bulk
+ *     buffer pool with @c margo_pool_get().
  *  5. Performs an RDMA pull (@c HG_BULK_PULL) from the producer's
- *     bulk handle into the local buffer via @c margo_bulk_transfer().
+ *     bulk handle straight into that buffer via
+ *     @c margo_bulk_transfer().
  *  6. Responds to the producer with @c out.ret = 0 to signal
- *     completion, then frees the input and destroys the RPC handle.
- *  7. Sets @c margo_handle->recv_ready = 1 to unblock the consumer
- *     thread waiting in a busy loop on that flag.
+ *     completion, or -1 if any step failed, then frees the input and
+ *     destroys the RPC handle.
+ *  7. Sets @c margo_handle->recv_eventual to the status of the transfer
+ *     to wake up the consumer thread waiting on it in
+ *     @c dyad_dtl_margo_recv().
  *
- * @note All Mercury/Margo calls are checked with @c assert(). This
- *       means any failure aborts the process rather than returning an
- *       error code. Error handling should be improved in a future
- *       revision.
- *
- * @note The receive buffer allocated in step 4 is stored in
- *       @c margo_handle->recv_buffer and must be freed by the caller
- *       after consuming the data.
+ * @note The buffer taken in step 4 is stored in
+ *       @c margo_handle->recv_buffer and handed over as is to the caller
+ *       of @c dyad_dtl_margo_recv(), which returns it to the pool with
+ *       @c dyad_dtl_margo_return_buffer(). The data is thus never copied
+ *       on the consumer.
  *
  * @note @c DEFINE_MARGO_RPC_HANDLER() wraps this function to register
  *       it with the Margo runtime as a ULT (user-level thread) handler.
  *
- * @todo Replace @c assert() calls with proper error handling that
- *       propagates failures back to the caller rather than aborting.
- *
  * @param[in] h  Mercury RPC handle for the incoming request.
  */
 static void data_ready_rpc (hg_handle_t h)
@@ -95,10 +284,9 @@ static void data_ready_rpc (hg_handle_t h)
     hg_return_t ret;
     margo_rpc_in_t in;
     margo_rpc_out_t out;
-    hg_bulk_t local_bulk;
-    // clang-format off
-    (void) ret;
-    // clang-format on
+    margo_pool_buf_t *pbuf = NULL;
+    int32_t status = -1;
+    bool got_input = false;
 
     margo_instance_id mid = margo_hg_handle_get_instance (h);
     margo_set_log_level (mid, MARGO_LOG_INFO);
@@ -108,44 +296,49 @@ static void data_ready_rpc (hg_handle_t h)
 
     dyad_dtl_margo_t *margo_handle = (dyad_dtl_margo_t *)margo_registered_data (mid, info->id);
 
+    margo_handle->recv_buffer = NULL;
+    margo_handle->recv_len = 0ul;
+
     ret = margo_get_input (h, &in);
-    assert (ret == HG_SUCCESS);
+    if (ret != HG_SUCCESS) {
+        goto data_ready_respond;
+    }
+    got_input = true;
+
+    if (DYAD_IS_ERROR (margo_pool_get (margo_handle, (size_t)in.n, &pbuf))) {
+        goto data_ready_respond;
+    }
 
+    // RDMA pull from the producer (which for now is the flux borker)
+    // straight into the buffer handed over to the caller of recv
+    if (in.n > 0) {
+        ret = margo_bulk_transfer (mid,
+                                   HG_BULK_PULL,
+                                   producer_addr,
+                                   in.bulk,
+                                   0,
+                                   pbuf->bulk,
+                                   0,
+                                   (hg_size_t)in.n);
+        if (ret != HG_SUCCESS) {
+            margo_pool_release (margo_handle, pbuf->addr);
+            goto data_ready_respond;
+        }
+    }
+    margo_handle->recv_buffer = pbuf->addr;
     margo_handle->recv_len = (size_t)in.n;
-    margo_handle->recv_buffer = malloc (margo_handle->recv_len);
+    status = 0;
 
-    ret = margo_bulk_create (mid,
-                             1,
-                             (void **)&margo_handle->recv_buffer,
-                             &margo_handle->recv_len,
-                             HG_BULK_WRITE_ONLY,
-                             &local_bulk);
-    assert (ret == HG_SUCCESS);
+data_ready_respond:;
+    out.ret = status;
+    margo_respond (h, &out);
+    if (got_input) {
+        margo_free_input (h, &in);
+    }
+    margo_destroy (h);
 
-    // RDMA pull from the producer (which for now is the flux borker)
-    ret = margo_bulk_transfer (mid,
-                               HG_BULK_PULL,
-                               producer_addr,
-                               in.bulk,
-                               0,
-                               local_bulk,
-                               0,
-                               margo_handle->recv_len);
-    assert (ret == HG_SUCCESS);
-
-    // DYAD_LOG_DEBUG(ctx, "[MARGO DTL] RDMA pulled from the producer.");
-
-    out.ret = 0;
-    ret = margo_respond (h, &out);
-    assert (ret == HG_SUCCESS);
-    ret = margo_free_input (h, &in);
-    assert (ret == HG_SUCCESS);
-    ret = margo_destroy (h);
-    assert (ret == HG_SUCCESS);
-
-    // set the ready flag so the client (should be in the busy-while
-    // loop) can proceed with the pulled data.
-    margo_handle->recv_ready = 1;
+    // Wake up the consumer waiting in dyad_dtl_margo_recv()
+    ABT_eventual_set (margo_handle->recv_eventual, &status, sizeof (status));
 }
 DEFINE_MARGO_RPC_HANDLER (data_ready_rpc)
 
@@ -153,22 +346,18 @@ dyad_rc_t dyad_dtl_margo_get_buffer (const dyad_ctx_t *ctx, size_t data_size, vo
 {
     DYAD_C_FUNCTION_START ();
     dyad_rc_t rc = DYAD_RC_OK;
+    margo_pool_buf_t *pbuf = NULL;
 
     if (data_buf == NULL || *data_buf != NULL) {
         rc = DYAD_RC_BADBUF;
         goto margo_get_buf_done;
     }
-#if 1
-    *data_buf = malloc (data_size);
-    if (*data_buf == NULL) {
-        rc = DYAD_RC_SYSFAIL;
-    }
-#else
-    rc = posix_memalign (data_buf, sysconf (_SC_PAGESIZE), data_size);
-    if (rc != 0 || *data_buf == NULL) {
-        rc = DYAD_RC_SYSFAIL;
+    rc = margo_pool_get (ctx->dtl_handle->private_dtl.margo_dtl_handle, data_size, &pbuf);
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (ctx, "[MARGO DTL] Could not get a bulk buffer of %zu bytes", data_size);
+        goto margo_get_buf_done;
     }
-#endif
+    *data_buf = pbuf->addr;
 
 margo_get_buf_done:
     DYAD_C_FUNCTION_END ();
@@ -183,9 +372,12 @@ dyad_rc_t dyad_dtl_margo_return_buffer (const dyad_ctx_t *ctx, void **data_buf)
         rc = DYAD_RC_BADBUF;
         goto margo_ret_buf_done;
     }
-    free (*data_buf);
+    rc = margo_pool_release (ctx->dtl_handle->private_dtl.margo_dtl_handle, *data_buf);
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (ctx, "[MARGO DTL] Returned buffer is not from the bulk buffer pool");
+        goto margo_ret_buf_done;
+    }
     *data_buf = NULL;
-    rc = DYAD_RC_OK;
 
 margo_ret_buf_done:
     DYAD_C_FUNCTION_END ();
@@ -282,7 +474,7 @@ dyad_rc_t dyad_dtl_margo_init (const dyad_ctx_t *ctx,
     // dyad_rc_t rc = DYAD_RC_OK;
     dyad_dtl_margo_t *margo_handle = NULL;
 
-    ctx->dtl_handle->private_dtl.margo_dtl_handle = malloc (sizeof (struct dyad_dtl_margo));
+    ctx->dtl_handle->private_dtl.margo_dtl_handle = calloc (1, sizeof (struct dyad_dtl_margo));
     if (ctx->dtl_handle->private_dtl.margo_dtl_handle == NULL) {
         DYAD_LOG_ERROR (ctx, "Could not allocate internal Margo DTL context\n");
         DYAD_C_FUNCTION_END ();
@@ -292,7 +484,9 @@ dyad_rc_t dyad_dtl_margo_init (const dyad_ctx_t *ctx,
     margo_handle = ctx->dtl_handle->private_dtl.margo_dtl_handle;
     margo_handle->h = (flux_t *)ctx->h;  // flux handle
     margo_handle->debug = debug;
-    margo_handle->recv_ready = 0;
+    margo_handle->mid = MARGO_INSTANCE_NULL;
+    margo_handle->recv_eventual = ABT_EVENTUAL_NULL;
+    pthread_mutex_init (&margo_handle->pool_lock, NULL);
 
     // Determine the Mercury network abstraction (NA) protocol (communication fabric) to use.
     //
@@ -365,6 +559,12 @@ dyad_rc_t dyad_dtl_margo_init (const dyad_ctx_t *ctx,
                                                         margo_rpc_out_t,
                                                         data_ready_rpc);
         margo_register_data (margo_handle->mid, margo_handle->sendrecv_rpc_id, margo_handle, NULL);
+        // Set by data_ready_rpc() to the status of each transfer, which
+        // lets dyad_dtl_margo_recv() block instead of polling
+        if (ABT_eventual_create (sizeof (int32_t), &margo_handle->recv_eventual) != ABT_SUCCESS) {
+            DYAD_LOG_ERROR (ctx, "[MARGO DTL] Could not create the receive eventual");
+            goto error;
+        }
     }
 
     // both margo client and server
@@ -379,6 +579,8 @@ dyad_rc_t dyad_dtl_margo_init (const dyad_ctx_t *ctx,
     ctx->dtl_handle->return_buffer = dyad_dtl_margo_return_buffer;
     ctx->dtl_handle->establish_connection = dyad_dtl_margo_establish_connection;
     ctx->dtl_handle->send = dyad_dtl_margo_send;
+    // The bulk handle is created directly over whatever memory is passed
+    ctx->dtl_handle->send_mapped = dyad_dtl_margo_send;
     ctx->dtl_handle->recv = dyad_dtl_margo_recv;
     ctx->dtl_handle->close_connection = dyad_dtl_margo_close_connection;
 
@@ -519,22 +721,33 @@ dyad_rc_t dyad_dtl_margo_send (const dyad_ctx_t *ctx, void *buf, size_t buflen)
 
     hg_size_t segment_sizes[1] = {buflen};
     void *segment_ptrs[1] = {buf};
-    hg_bulk_t local_bulk;
+    hg_bulk_t local_bulk = HG_BULK_NULL;
+    bool own_bulk = false;
+    margo_pool_buf_t *pbuf = NULL;
     margo_rpc_in_t args;
-    hg_handle_t mh;
+    hg_handle_t mh = HG_HANDLE_NULL;
     margo_rpc_out_t resp;
 
-    // Register my local data
-    // which will be pulled by the consumer
-    ret = margo_bulk_create (margo_handle->mid,
-                             1,
-                             segment_ptrs,
-                             segment_sizes,
-                             HG_BULK_READ_ONLY,
-                             &local_bulk);
-    if (ret != HG_SUCCESS) {
-        DYAD_LOG_ERROR (ctx, "margo_bulk_create failed: %d", (int)ret);
-        goto margo_error_bulk;
+    // Buffers of the pool are already registered. Register other memory,
+    // e.g., mapped files, for this transfer only
+    pthread_mutex_lock (&margo_handle->pool_lock);
+    pbuf = margo_pool_find (margo_handle, buf);
+    if (pbuf != NULL && buflen <= pbuf->size) {
+        local_bulk = pbuf->bulk;
+    }
+    pthread_mutex_unlock (&margo_handle->pool_lock);
+    if (local_bulk == HG_BULK_NULL) {
+        ret = margo_bulk_create (margo_handle->mid,
+                                 1,
+                                 segment_ptrs,
+                                 segment_sizes,
+                                 HG_BULK_READ_ONLY,
+                                 &local_bulk);
+        if (ret != HG_SUCCESS) {
+            DYAD_LOG_ERROR (ctx, "margo_bulk_create failed: %d", (int)ret);
+            goto margo_error;
+        }
+        own_bulk = true;
     }
 
     args.n = buflen;
@@ -560,52 +773,59 @@ dyad_rc_t dyad_dtl_margo_send (const dyad_ctx_t *ctx, void *buf, size_t buflen)
         DYAD_LOG_ERROR (ctx, "margo_get_output failed: %d", (int)ret);
         goto margo_error;
     }
+    if (resp.ret != 0) {
+        DYAD_LOG_ERROR (ctx, "[MARGO DTL] The consumer failed to pull %lu bytes", buflen);
+        rc = DYAD_RC_MARGOCOMM_FAIL;
+    }
     margo_free_output (mh, &resp);
-    margo_destroy (mh);
-
-    DYAD_LOG_DEBUG (ctx, "[MARGO DTL] margo_send completed, buflen: %lu", buflen);
-
-    DYAD_C_FUNCTION_END ();
-    return rc;
+    goto margo_send_done;
 
 margo_error:;
+    rc = DYAD_RC_MARGOCOMM_FAIL;
+
+margo_send_done:;
     if (mh != HG_HANDLE_NULL) {
         margo_destroy (mh);
     }
-
-margo_error_bulk:;
-    if (local_bulk != HG_BULK_NULL) {
+    if (own_bulk) {
         margo_bulk_free (local_bulk);
     }
-
-    return DYAD_RC_MARGOINIT_FAIL;
+    if (!DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_DEBUG (ctx, "[MARGO DTL] margo_send completed, buflen: %lu", buflen);
+    }
+    DYAD_C_FUNCTION_END ();
+    return rc;
 }
 
 dyad_rc_t dyad_dtl_margo_recv (const dyad_ctx_t *ctx, void **buf, size_t *buflen)
 {
     DYAD_C_FUNCTION_START ();
     dyad_rc_t rc = DYAD_RC_OK;
+    int32_t *status = NULL;
     DYAD_LOG_DEBUG (ctx, "[MARGO DTL] margo_recv is called, waiting for data.");
 
     dyad_dtl_margo_t *margo_handle = ctx->dtl_handle->private_dtl.margo_dtl_handle;
 
-    while (!margo_handle->recv_ready) {
-        usleep (100);
+    // Sleeps until data_ready_rpc() has pulled the data
+    if (ABT_eventual_wait (margo_handle->recv_eventual, (void **)&status) != ABT_SUCCESS
+        || status == NULL || *status != 0) {
+        DYAD_LOG_ERROR (ctx, "[MARGO DTL] Could not pull the data from the producer");
+        rc = DYAD_RC_MARGOCOMM_FAIL;
+        ABT_eventual_reset (margo_handle->recv_eventual);
+        goto margo_recv_done;
     }
+    ABT_eventual_reset (margo_handle->recv_eventual);
 
     DYAD_LOG_DEBUG (ctx, "[MARGO DTL] margo_recv received %ld bytes.", margo_handle->recv_len);
 
-    // recv message handled, reset it to 0
+    // margo_handle->recv_buffer is the pool buffer data_ready_rpc() pulled
+    // into, and is returned by dyad_dtl_margo_return_buffer()
     *buflen = margo_handle->recv_len;
-    *buf = malloc (*buflen);
-    memcpy (*buf, margo_handle->recv_buffer, margo_handle->recv_len);
-
-    // margo_handle->recv_buffer is allocated in data_ready_rpc()
-    free (margo_handle->recv_buffer);
+    *buf = margo_handle->recv_buffer;
     margo_handle->recv_buffer = NULL;
     margo_handle->recv_len = 0;
-    margo_handle->recv_ready = 0;
 
+margo_recv_done:;
     DYAD_C_FUNCTION_END ();
     return rc;
 }
@@ -634,6 +854,12 @@ dyad_rc_t dyad_dtl_margo_finalize (const dyad_ctx_t *ctx)
 
     margo_handle = ctx->dtl_handle->private_dtl.margo_dtl_handle;
 
+    if (margo_handle->recv_eventual != ABT_EVENTUAL_NULL) {
+        ABT_eventual_free (&margo_handle->recv_eventual);
+    }
+    // The bulk handles of the pool belong to the Margo instance
+    margo_pool_destroy (margo_handle);
+    pthread_mutex_destroy (&margo_handle->pool_lock);
     if (margo_handle->mid != MARGO_INSTANCE_NULL) {
         margo_addr_free (margo_handle->mid, margo_handle->local_addr);
         if (margo_handle->remote_addr != NULL)
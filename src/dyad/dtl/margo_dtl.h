@@ -8,9 +8,39 @@
 #endif
 
 #include <dyad/dtl/dyad_dtl_api.h>
+#include <abt.h>
 #include <margo.h>
+#include <pthread.h>
 #include <stdlib.h>
 
+/**
+ * @brief Size of the smallest class of the registered bulk buffer pool.
+ */
+#define DYAD_MARGO_POOL_MIN_CLASS (64ul * 1024ul)
+
+/**
+ * @brief Number of size classes of the registered bulk buffer pool. Each
+ *        class holds buffers 4 times larger than the previous one, i.e.,
+ *        up to 256 MiB. Larger buffers are registered on demand.
+ */
+#define DYAD_MARGO_POOL_CLASSES 7u
+
+/**
+ * @brief Number of free buffers kept registered in each size class.
+ */
+#define DYAD_MARGO_POOL_KEEP 4u
+
+/**
+ * @brief A buffer of the registered bulk buffer pool.
+ */
+typedef struct margo_pool_buf {
+    struct margo_pool_buf *next;  ///< Next buffer of the free or used list.
+    void *addr;                   ///< Start of the buffer, page-aligned.
+    hg_size_t size;               ///< Size of the buffer in bytes.
+    hg_bulk_t bulk;               ///< Read-write bulk handle of the buffer.
+    int cls;                      ///< Size class, or -1 if larger than all classes.
+} margo_pool_buf_t;
+
 struct dyad_dtl_margo {
     flux_t *h;
     bool debug;
@@ -18,9 +48,17 @@ struct dyad_dtl_margo {
     hg_addr_t local_addr;     // margo local server address
     hg_addr_t remote_addr;    // margo remote server address
     hg_id_t sendrecv_rpc_id;  // margo rpc id for send/recv
-    bool recv_ready;
-    size_t recv_len;
-    void *recv_buffer;
+    /// Set by @c data_ready_rpc() to the @c int32_t status of a transfer
+    /// once its data is in @c recv_buffer. Only created on the consumer.
+    ABT_eventual recv_eventual;
+    size_t recv_len;    ///< Number of bytes of the last transfer.
+    void *recv_buffer;  ///< Buffer of the pool the last transfer landed in.
+    /// Protects the pool, which the consumer's RPC handler and the threads
+    /// returning buffers use concurrently.
+    pthread_mutex_t pool_lock;
+    margo_pool_buf_t *pool_free[DYAD_MARGO_POOL_CLASSES];  ///< Free buffers of each class.
+    unsigned pool_nfree[DYAD_MARGO_POOL_CLASSES];          ///< Length of each free list.
+    margo_pool_buf_t *pool_used;  ///< Buffers handed out and not returned yet.
 };
 
 typedef struct dyad_dtl_margo dyad_dtl_margo_t;
@@ -64,12 +102,14 @@ typedef struct dyad_dtl_margo dyad_dtl_margo_t;
  *   The RPC named @c "data_ready_rpc" is registered with @c data_ready_rpc()
  *   as its handler function, and the @c margo_handle is registered a
  *   auxiliary data accessible to the handler via @c margo_registered_data().
+ *   The consumer also creates the @c recv_eventual that
+ *   @c data_ready_rpc() sets once a transfer has landed.
  * @note  RPC handlers run in the same Argobots Execution Stream (ES) as the
  *        Mercury progress loop (@c rpc_thread_count=-1), meaning no additional
  *        ES is created for handler execution. This is safe because the consumer
- *        blocks in a busy-wait loop on @c margo_handle->recv_ready until
- *        @c data_ready_rpc() signals completion — there is no concurrent work
- *        that could be starved by sharing the progress loop ES with the handler.
+ *        blocks on @c margo_handle->recv_eventual until @c data_ready_rpc()
+ *        signals completion — there is no concurrent work that could be
+ *        starved by sharing the progress loop ES with the handler.
  *
  * Both modes retrieve their own local Margo address via
  * @c margo_addr_self() and initialize @c remote_addr to @c NULL
@@ -225,7 +265,7 @@ dyad_rc_t dyad_dtl_margo_rpc_respond (const dyad_ctx_t *ctx, const flux_msg_t *o
  * @details
  * No-op for the Margo DTL. The consumer does not need to process a
  * Flux RPC response before data transfer begins — it waits directly
- * on @c margo_handle->recv_ready, which is set by @c data_ready_rpc()
+ * on @c margo_handle->recv_eventual, which is set by @c data_ready_rpc()
  * after the RDMA pull completes.
  *
  * @param[in] ctx Unused by this backend.
@@ -236,70 +276,68 @@ dyad_rc_t dyad_dtl_margo_rpc_respond (const dyad_ctx_t *ctx, const flux_msg_t *o
 dyad_rc_t dyad_dtl_margo_rpc_recv_response (const dyad_ctx_t *ctx, flux_future_t *f);
 
 /**
- * @brief Allocates a buffer for Margo DTL data transfer.
+ * @brief Takes a buffer for Margo DTL data transfer from the registered
+ *        bulk buffer pool.
  *
  * @details
- * Allocates a buffer of @p data_size bytes via @c malloc(). The function
- * validates @p data_buf before allocation:
+ * Rather than allocating a buffer and registering it with Mercury on each
+ * transfer, the Margo backend keeps a pool of page-aligned buffers with a
+ * read-write bulk handle each, in size classes of
+ * @c DYAD_MARGO_POOL_MIN_CLASS times powers of 4. A free buffer of the
+ * size class of @p data_size is reused, or a new one is allocated and
+ * registered with @c margo_bulk_create(). Buffers larger than the largest
+ * class are registered for @p data_size bytes exactly.
+ *
+ * @c dyad_dtl_margo_send() sends a buffer of the pool through its bulk
+ * handle, and @c data_ready_rpc() pulls into one, so that neither
+ * registers memory per transfer. The function validates @p data_buf
+ * before taking a buffer:
  * - If @p data_buf is @c NULL, the caller passed an invalid output
  *   pointer and @c DYAD_RC_BADBUF is returned.
  * - If @p *data_buf is non-@c NULL, a buffer is already present and
  *   overwriting it would cause a memory leak, so @c DYAD_RC_BADBUF
  *   is returned.
  *
- * The allocated buffer must be released via
- * @c dyad_dtl_margo_return_buffer().
- *
- * @note A @c posix_memalign() path exists in the source but is disabled
- *       (@c #else branch, @c #if 1 selects @c malloc()). Unlike the Flux
- *       RPC DTL which uses page-aligned allocation, the Margo DTL
- *       currently uses plain @c malloc() since Margo manages its own
- *       RDMA memory registration separately via @c margo_bulk_create().
+ * The buffer must be released via @c dyad_dtl_margo_return_buffer().
  *
  * @param[in]  ctx       DYAD context.
- * @param[in]  data_size Number of bytes to allocate.
+ * @param[in]  data_size Number of bytes needed.
  * @param[out] data_buf  Must point to a @c NULL pointer on entry. Set
- *                       to the allocated buffer on success.
+ *                       to the buffer on success.
  *
  * @return @c dyad_rc_t return code:
- * @retval DYAD_RC_OK      Buffer allocated successfully.
- * @retval DYAD_RC_BADBUF  @p data_buf is @c NULL or @p *data_buf is
- *                         already non-@c NULL.
- * @retval DYAD_RC_SYSFAIL @c malloc() failed to allocate the buffer.
+ * @retval DYAD_RC_OK             Buffer taken successfully.
+ * @retval DYAD_RC_BADBUF         @p data_buf is @c NULL or @p *data_buf is
+ *                                already non-@c NULL.
+ * @retval DYAD_RC_SYSFAIL        The buffer could not be allocated.
+ * @retval DYAD_RC_MARGOCOMM_FAIL The buffer could not be registered.
  */
 dyad_rc_t dyad_dtl_margo_get_buffer (const dyad_ctx_t *ctx, size_t data_size, void **data_buf);
 
 /**
- * @brief Releases a buffer previously allocated by
- *        @c dyad_dtl_margo_get_buffer().
+ * @brief Releases a buffer previously taken with
+ *        @c dyad_dtl_margo_get_buffer() or @c dyad_dtl_margo_recv().
  *
  * @details
- * Frees the buffer pointed to by @p *data_buf. The function validates
- * @p data_buf before freeing:
+ * Gives the buffer back to the registered bulk buffer pool, which keeps
+ * up to @c DYAD_MARGO_POOL_KEEP free buffers per size class registered and
+ * frees the others. The function validates @p data_buf first:
  * - If @p data_buf is @c NULL, the caller passed an invalid pointer
  *   and @c DYAD_RC_BADBUF is returned.
- * - If @p *data_buf is @c NULL, the buffer has already been freed or
- *   was never allocated, and @c DYAD_RC_BADBUF is returned.
- *
- * @note @p *data_buf is not set to @c NULL after freeing. The caller
- *       is responsible for nulling the pointer to prevent use-after-free
- *       (see TODO).
- *
- * @todo Set @p *data_buf to @c NULL after @c free() to prevent
- *       use-after-free:
- *       @code
- *       free (*data_buf);
- *       *data_buf = NULL;
- *       @endcode
+ * - If @p *data_buf is @c NULL, the buffer has already been returned or
+ *   was never taken, and @c DYAD_RC_BADBUF is returned.
+ * - If @p *data_buf is not a buffer of the pool, @c DYAD_RC_BADBUF is
+ *   returned as well.
  *
  * @param[in]     ctx      DYAD context.
- * @param[in,out] data_buf Pointer to the buffer to free. @p *data_buf
- *                         must be non-@c NULL on entry.
+ * @param[in,out] data_buf Pointer to the buffer to return. @p *data_buf
+ *                         must be non-@c NULL on entry, and is set to
+ *                         @c NULL on success.
  *
  * @return @c dyad_rc_t return code:
- * @retval DYAD_RC_OK     Buffer freed successfully.
- * @retval DYAD_RC_BADBUF @p data_buf is @c NULL or @p *data_buf is
- *                        @c NULL.
+ * @retval DYAD_RC_OK     Buffer returned successfully.
+ * @retval DYAD_RC_BADBUF @p data_buf is @c NULL, @p *data_buf is @c NULL,
+ *                        or @p *data_buf is not a buffer of the pool.
  */
 dyad_rc_t dyad_dtl_margo_return_buffer (const dyad_ctx_t *ctx, void **data_buf);
 
@@ -328,8 +366,11 @@ dyad_rc_t dyad_dtl_margo_establish_connection (const dyad_ctx_t *ctx);
  * @brief Sends file data to the consumer via Margo RDMA.
  *
  * @details
- * Registers @p buf as a read-only Mercury bulk handle via
- * @c margo_bulk_create(), then sends an RPC to the consumer's Margo
+ * Uses the bulk handle of @p buf if it is a buffer of the registered
+ * bulk buffer pool, i.e., was taken with @c dyad_dtl_margo_get_buffer(),
+ * and otherwise, e.g., for a mapped file, registers @p buf as a read-only
+ * Mercury bulk handle via @c margo_bulk_create() for this transfer only.
+ * It then sends an RPC to the consumer's Margo
  * server at @c margo_handle->remote_addr (resolved during
  * @c dyad_dtl_margo_rpc_unpack()) via @c margo_forward(). The RPC
  * payload contains the bulk handle and the buffer size, allowing the
@@ -337,8 +378,9 @@ dyad_rc_t dyad_dtl_margo_establish_connection (const dyad_ctx_t *ctx);
  * from the producer's registered buffer.
  *
  * @c margo_forward() blocks until the consumer responds, confirming
- * that the RDMA pull is complete. The producer then frees the RPC
- * output and destroys the handle.
+ * that the RDMA pull is complete, or reporting that it failed. The
+ * producer then frees the RPC output, destroys the handle and frees the
+ * bulk handle it created, if any.
  *
  * @note Unlike the Flux RPC backend where the producer needs the original
  *       request message (@c flux_msg_t) as a reply address to route
@@ -361,12 +403,9 @@ dyad_rc_t dyad_dtl_margo_establish_connection (const dyad_ctx_t *ctx);
  * @param[in] buflen Number of bytes in @p buf.
  *
  * @return @c dyad_rc_t return code:
- * @retval DYAD_RC_OK Always returned. Error handling for Margo calls
- *                    is not yet implemented (see TODO).
- *
- * @todo Add error checking for @c margo_bulk_create(),
- *       @c margo_create(), @c margo_forward(), and
- *       @c margo_get_output() — all currently unchecked.
+ * @retval DYAD_RC_OK             The consumer pulled the data.
+ * @retval DYAD_RC_MARGOCOMM_FAIL A Margo call failed, or the consumer
+ *                                could not pull the data.
  */
 dyad_rc_t dyad_dtl_margo_send (const dyad_ctx_t *ctx, void *buf, size_t buflen);
 
@@ -374,17 +413,14 @@ dyad_rc_t dyad_dtl_margo_send (const dyad_ctx_t *ctx, void *buf, size_t buflen);
  * @brief Receives file data from the producer via the Margo DTL.
  *
  * @details
- * Busy-waits on @c margo_handle->recv_ready, sleeping 100 microseconds
- * between checks, until @c data_ready_rpc() sets it to 1 after
- * completing the RDMA pull from the producer. Once the data is ready,
- * allocates a new buffer, copies the received data from
- * @c margo_handle->recv_buffer, and frees the buffer allocated by
- * @c data_ready_rpc().
- *
- * After copying, the Margo handle state is reset for the next transfer:
- * - @c recv_buffer is freed and set to @c NULL.
- * - @c recv_len is reset to 0.
- * - @c recv_ready is reset to 0.
+ * Blocks on @c margo_handle->recv_eventual with @c ABT_eventual_wait()
+ * until @c data_ready_rpc() sets it after completing the RDMA pull from
+ * the producer, so that the calling thread neither polls nor adds latency
+ * to the transfer. The eventual carries the status of the transfer, and
+ * is reset for the next one. On success, the buffer of the registered
+ * bulk buffer pool that the data was pulled into is handed over to the
+ * caller as is, without a copy, and @c recv_buffer and @c recv_len are
+ * reset.
  *
  * @note The data flow for Margo receive is inverted compared to the
  *       Flux RPC backend. In the Flux RPC backend the producer pushes
@@ -392,29 +428,20 @@ dyad_rc_t dyad_dtl_margo_send (const dyad_ctx_t *ctx, void *buf, size_t buflen);
  *       it via @c flux_rpc_get_raw(). In this Margo-based backend the producer
  *       registers its buffer and notifies the consumer's Margo server,
  *       which performs an RDMA pull into @c margo_handle->recv_buffer
- *       via @c data_ready_rpc(). The consumer then copies from that
- *       buffer here. The actual data movement therefore happens in
- *       @c data_ready_rpc() running on the progress loop ES, not in
- *       this function.
- *
- * @note The busy-wait with @c usleep(100) is a simple polling approach.
- *       A condition variable or Argobots synchronization primitive would
- *       be more efficient but would require additional coordination with
- *       the Margo progress loop ES (see TODO).
- *
- * @todo Replace the busy-wait loop with a more efficient synchronization
- *       mechanism such as an Argobots eventual or condition variable.
+ *       via @c data_ready_rpc(). The actual data movement therefore
+ *       happens in @c data_ready_rpc() running on the progress loop ES,
+ *       not in this function.
  *
  * @param[in]  ctx    DYAD context.
- * @param[out] buf    Set to a newly allocated buffer containing a copy
- *                    of the received file data. The caller must free
- *                    this buffer via @c ctx->dtl_handle->return_buffer().
+ * @param[out] buf    Set to the buffer holding the received file data.
+ *                    The caller must release it via
+ *                    @c ctx->dtl_handle->return_buffer().
  * @param[out] buflen Set to the number of bytes received.
  *
- * @return Always returns @c DYAD_RC_OK. Error handling for allocation
- *         failure and copy errors is not yet implemented (see TODO).
- *
- * @todo Add error checking for @c malloc() failure.
+ * @return @c dyad_rc_t return code:
+ * @retval DYAD_RC_OK             The data was received.
+ * @retval DYAD_RC_MARGOCOMM_FAIL Waiting failed, or @c data_ready_rpc()
+ *                                could not pull the data.
  */
 dyad_rc_t dyad_dtl_margo_recv (const dyad_ctx_t *ctx, void **buf, size_t *buflen);
 
@@ -449,14 +476,16 @@ dyad_rc_t dyad_dtl_margo_close_connection (const dyad_ctx_t *ctx);
  * Releases all resources associated with the Margo DTL in the following
  * order:
  *
- *  1. If @c margo_handle->mid is a valid Margo instance, frees the
+ *  1. Frees the receive eventual, if created, and every buffer of the
+ *     registered bulk buffer pool along with its bulk handle.
+ *  2. If @c margo_handle->mid is a valid Margo instance, frees the
  *     local Margo address via @c margo_addr_free().
- *  2. If @c margo_handle->remote_addr is non-@c NULL, frees the remote
+ *  3. If @c margo_handle->remote_addr is non-@c NULL, frees the remote
  *     address (the consumer's resolved Margo server address) via
  *     @c margo_addr_free().
- *  3. Finalizes the Margo instance via @c margo_finalize(), which shuts
+ *  4. Finalizes the Margo instance via @c margo_finalize(), which shuts
  *     down the Mercury progress loop and any associated Argobots ESs.
- *  4. Frees the @c dyad_dtl_margo struct and sets the handle pointer
+ *  5. Frees the @c dyad_dtl_margo struct and sets the handle pointer
  *     to @c NULL.
  *
  * If @c ctx->dtl_handle is @c NULL or
@@ -5,7 +5,10 @@
 #endif
 
 #include <assert.h>
+#include <errno.h>
 #include <inttypes.h>
+#include <pthread.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -16,22 +19,6 @@
 #include <dyad/common/dyad_logging.h>
 #include <dyad/common/dyad_profiler.h>
 #include <dyad/dtl/ucx_dtl.h>
-#include <dyad/utils/base64/base64.h>
-
-/**
- * @brief Base64 encoding map for RFC 4648, used to encode/decode UCX
- *        remote keys for transmission over the Flux RPC channel.
- */
-extern const base64_maps_t base64_maps_rfc4648;
-
-/**
- * @brief Maximum data size for a single UCX transfer (4 GiB).
- *
- * @details
- * UCX tag send/receive operations are limited to 4 GiB per transfer.
- * Files larger than this limit must be split into multiple transfers.
- */
-#define UCX_MAX_TRANSFER_SIZE (4 * 1024L * 1024L * 1024L)
 
 /**
  * @brief Tag mask used for UCX tag send/receive operations.
@@ -43,6 +30,12 @@ extern const base64_maps_t base64_maps_rfc4648;
  */
 #define DYAD_UCX_TAG_MASK UINT64_MAX
 
+/**
+ * @brief Number of polls of the receive ring between two checks of the
+ *        RPC for an error from the producer.
+ */
+#define DYAD_UCX_RPC_POLL 1000u
+
 /**
  * @brief Request struct used to track the completion of async UCX
  *        operations.
@@ -192,63 +185,171 @@ dtl_ucx_request_wait_region_finish:;
 }
 
 /**
- * @brief Allocates and registers a UCX memory buffer for RDMA operations.
+ * @brief Allocates and registers @p length bytes of host memory with UCX.
  *
  * @details
- * Allocates a host memory buffer of @c dtl_handle->max_transfer_size +
- * @c sizeof(size_t) bytes using @c ucp_mem_map() with
- * @c UCP_MEM_MAP_ALLOCATE, which lets UCX allocate and register the
- * memory in one step. The extra @c sizeof(size_t) bytes prepend the
- * file size to the buffer so the consumer can determine the data
- * boundary without an additional RDMA operation.
- *
- * The memory protection flags differ by communication direction:
- * - @c DYAD_COMM_SEND (producer): @c UCP_MEM_MAP_PROT_LOCAL_READ —
- *   the producer only reads from the buffer locally to send data.
- * - @c DYAD_COMM_RECV (consumer): @c UCP_MEM_MAP_PROT_REMOTE_WRITE —
- *   the buffer is exposed for remote write so the producer can push
- *   data into it via RDMA.
- *
- * After mapping, queries the actual allocated address via
- * @c ucp_mem_query() and stores it in @c dtl_handle->net_buf and
- * @c dtl_handle->cons_buf_ptr. On the producer side (@c DYAD_COMM_SEND),
- * @c cons_buf_ptr is initialized to the producer's own buffer address
- * as a placeholder; it is overwritten with the consumer's remote buffer
- * address in @c dyad_dtl_ucx_rpc_unpack() before each transfer.
- *
- * @c ucp_rkey_pack() is called only when @c comm_mode == @c DYAD_COMM_RECV.
- * The consumer packs its registered memory region into @c rkey_buf so
- * that the packed key can be sent to the producer (encoded in base64 via
- * @c dyad_dtl_ucx_rpc_pack()) to authorize the RDMA push into the
- * consumer's buffer. The producer does not need to pack its own memory
- * region since no peer performs RDMA into the producer's buffer.
+ * Uses @c ucp_mem_map() with @c UCP_MEM_MAP_ALLOCATE, which lets UCX
+ * allocate and register the memory in one step, and queries the address
+ * of the memory with @c ucp_mem_query(). The memory is released with
+ * @c ucx_free_buffer().
+ *
+ * @param[in]  ctx      DYAD context. Used for logging.
+ * @param[in]  ucp_ctx  UCX context with which to register the memory.
+ * @param[in]  length   Number of bytes to allocate.
+ * @param[in]  prot     @c UCP_MEM_MAP_PROT_* flags of the registration.
+ * @param[out] memh     Set to the UCX memory handle on success.
+ * @param[out] addr     Set to the start of the memory on success.
+ *
+ * @return @c dyad_rc_t return code:
+ * @retval DYAD_RC_OK            Memory allocated and registered.
+ * @retval DYAD_RC_UCXMMAP_FAIL  @c ucp_mem_map() or @c ucp_mem_query()
+ *                               failed.
+ */
+static dyad_rc_t ucx_mem_alloc (const dyad_ctx_t *ctx,
+                                ucp_context_h ucp_ctx,
+                                size_t length,
+                                unsigned prot,
+                                ucp_mem_h *memh,
+                                void **addr)
+{
+    ucs_status_t status;
+    ucp_mem_map_params_t mmap_params;
+    ucp_mem_attr_t attr;
+
+    mmap_params.field_mask = UCP_MEM_MAP_PARAM_FIELD_ADDRESS | UCP_MEM_MAP_PARAM_FIELD_LENGTH
+                             | UCP_MEM_MAP_PARAM_FIELD_FLAGS | UCP_MEM_MAP_PARAM_FIELD_MEMORY_TYPE
+                             | UCP_MEM_MAP_PARAM_FIELD_PROT;
+    mmap_params.address = NULL;
+    mmap_params.memory_type = UCS_MEMORY_TYPE_HOST;
+    mmap_params.length = length;
+    mmap_params.flags = UCP_MEM_MAP_ALLOCATE;
+    mmap_params.prot = prot;
+    status = ucp_mem_map (ucp_ctx, &mmap_params, memh);
+    if (UCX_STATUS_FAIL (status)) {
+        DYAD_LOG_ERROR (ctx, "ucx_mem_map failed for %zu bytes", length);
+        *memh = NULL;
+        return DYAD_RC_UCXMMAP_FAIL;
+    }
+    attr.field_mask = UCP_MEM_ATTR_FIELD_ADDRESS;
+    status = ucp_mem_query (*memh, &attr);
+    if (UCX_STATUS_FAIL (status)) {
+        ucp_mem_unmap (ucp_ctx, *memh);
+        *memh = NULL;
+        DYAD_LOG_ERROR (ctx, "Failed to get address to UCX allocated buffer");
+        return DYAD_RC_UCXMMAP_FAIL;
+    }
+    *addr = attr.address;
+    return DYAD_RC_OK;
+}
+
+/**
+ * @brief Offset of the control words of @p slot from the start of the
+ *        receive ring. The data of the slot follows them.
+ */
+static inline uint64_t ucx_slot_offset (const dyad_dtl_ucx_t *dtl_handle, unsigned slot)
+{
+    return DYAD_UCX_HDR_SIZE + (uint64_t)slot * (DYAD_UCX_HDR_SIZE + dtl_handle->slot_size);
+}
+
+/**
+ * @brief Control words of @p slot of the consumer's own receive ring.
+ */
+static inline ucx_slot_hdr_t *ucx_slot_hdr (const dyad_dtl_ucx_t *dtl_handle, unsigned slot)
+{
+    return (ucx_slot_hdr_t *)((char *)dtl_handle->net_buf + ucx_slot_offset (dtl_handle, slot));
+}
+
+/**
+ * @brief Prepares the receive ring for a new transfer.
+ *
+ * @details
+ * Clears the count of released chunks and the sequence number of every
+ * slot, so that chunks left from an earlier transfer are not mistaken for
+ * those of the next one, and restarts the sequence at the first slot. On
+ * the producer side, only resets the sequence.
+ *
+ * @param[in,out] dtl_handle UCX DTL internal state.
+ */
+static void ucx_ring_reset (dyad_dtl_ucx_t *dtl_handle)
+{
+    unsigned slot = 0u;
+    dtl_handle->chunk_seq = 0ull;
+    dtl_handle->consumed = 0ull;
+    dtl_handle->released = 0ull;
+    if (dtl_handle->net_buf == NULL) {
+        return;
+    }
+    __atomic_store_n ((uint64_t *)dtl_handle->net_buf, 0ull, __ATOMIC_RELAXED);
+    for (slot = 0u; slot < dtl_handle->slots; slot++) {
+        __atomic_store_n (&(ucx_slot_hdr (dtl_handle, slot)->seq), 0ull, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * @brief Hands @p slot of the receive ring back to the producer.
+ *
+ * @details
+ * The producer only learns the number of chunks released, so a slot
+ * returned before older ones is handed back together with them.
+ *
+ * @param[in,out] dtl_handle UCX DTL internal state of the consumer.
+ * @param[in]     slot       Slot whose chunk is no longer needed.
+ */
+static void ucx_ring_release (dyad_dtl_ucx_t *dtl_handle, unsigned slot)
+{
+    uint64_t bit = 0ull;
+    dtl_handle->released |= (1ull << slot);
+    for (;;) {
+        bit = 1ull << (dtl_handle->consumed % dtl_handle->slots);
+        if (!(dtl_handle->released & bit)) {
+            break;
+        }
+        dtl_handle->released &= ~bit;
+        dtl_handle->consumed++;
+    }
+    __atomic_store_n ((uint64_t *)dtl_handle->net_buf, dtl_handle->consumed, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Allocates and registers the receive ring of a consumer.
+ *
+ * @details
+ * Allocates @c DYAD_UCX_HDR_SIZE bytes for the count of released chunks,
+ * followed by @c dtl_handle->slots slots of @c DYAD_UCX_HDR_SIZE bytes of
+ * control words and @c dtl_handle->slot_size bytes of data, with
+ * @c ucx_mem_alloc(). The ring is exposed for remote writes, so that
+ * producers can put chunks into its slots, and for remote reads, so that
+ * they can read the count of released chunks before reusing a slot.
+ *
+ * The address of the ring is stored in @c dtl_handle->net_buf and
+ * @c dtl_handle->cons_buf_ptr, and the registration is packed into
+ * @c rkey_buf with @c ucp_rkey_pack(), so that both can be sent to the
+ * producer (when registering with it in @c dyad_dtl_ucx_rpc_pack()) to
+ * authorize the puts into the ring.
+ *
+ * Producers (@c DYAD_COMM_SEND) have no ring. They put from the buffers of
+ * the registered buffer pool, see @c ucx_pool_get().
  *
  * On any failure after a successful @c ucp_mem_map(), the memory is
  * unmapped via @c ucp_mem_unmap() before returning.
  *
  * @param[in]     ctx        DYAD context. Used for logging.
- * @param[in,out] dtl_handle UCX DTL internal state. On success,
- *                           @c net_buf, @c cons_buf_ptr, and
- *                           @c mem_handle are always populated.
- *                           @c rkey_buf and @c rkey_size are populated
- *                           only when @p comm_mode is @c DYAD_COMM_RECV.
- * @param[in]     comm_mode  Communication direction. Controls the memory
- *                           protection flags and whether @c ucp_rkey_pack()
- *                           is called. Must not be @c DYAD_COMM_NONE.
+ * @param[in,out] dtl_handle UCX DTL internal state. On success on the
+ *                           consumer side, @c net_buf, @c cons_buf_ptr,
+ *                           @c mem_handle, @c rkey_buf and @c rkey_size
+ *                           are populated.
+ * @param[in]     comm_mode  Communication direction. Must not be
+ *                           @c DYAD_COMM_NONE.
  *
  * @return @c dyad_rc_t return code:
- * @retval DYAD_RC_OK                  Buffer allocated and registered
- *                                     successfully.
+ * @retval DYAD_RC_OK                  Ring allocated and registered, or
+ *                                     not needed on the producer side.
  * @retval DYAD_RC_NOCTX               @c dtl_handle->ucx_ctx is @c NULL.
  * @retval DYAD_RC_BAD_COMM_MODE       @c dtl_handle->comm_mode is
  *                                     @c DYAD_COMM_NONE.
  * @retval DYAD_RC_UCXMMAP_FAIL        @c ucp_mem_map() or
  *                                     @c ucp_mem_query() failed.
  * @retval DYAD_RC_UCXRKEY_PACK_FAILED @c ucp_rkey_pack() failed.
- *                                     Only possible when @p comm_mode
- *                                     is @c DYAD_COMM_RECV.
- * @retval DYAD_RC_BADBUF              Default error before any specific
- *                                     check is reached.
  */
 static dyad_rc_t ucx_allocate_buffer (const dyad_ctx_t *ctx,
                                       dyad_dtl_ucx_t *dtl_handle,
@@ -257,8 +358,6 @@ static dyad_rc_t ucx_allocate_buffer (const dyad_ctx_t *ctx,
     DYAD_C_FUNCTION_START ();
     dyad_rc_t rc = DYAD_RC_BADBUF;
     ucs_status_t status;
-    ucp_mem_map_params_t mmap_params;
-    ucp_mem_attr_t attr;
     if (dtl_handle->ucx_ctx == NULL) {
         rc = DYAD_RC_NOCTX;
         DYAD_LOG_ERROR (ctx, "No UCX context provided");
@@ -268,51 +367,41 @@ static dyad_rc_t ucx_allocate_buffer (const dyad_ctx_t *ctx,
         rc = DYAD_RC_BAD_COMM_MODE;
         goto ucx_allocate_done;
     }
-    DYAD_LOG_INFO (ctx, "Allocating memory with UCX");
-    mmap_params.field_mask = UCP_MEM_MAP_PARAM_FIELD_ADDRESS | UCP_MEM_MAP_PARAM_FIELD_LENGTH
-                             | UCP_MEM_MAP_PARAM_FIELD_FLAGS | UCP_MEM_MAP_PARAM_FIELD_MEMORY_TYPE
-                             | UCP_MEM_MAP_PARAM_FIELD_PROT;
-    mmap_params.address = NULL;
-    mmap_params.memory_type = UCS_MEMORY_TYPE_HOST;
-    mmap_params.length = dtl_handle->max_transfer_size + sizeof (size_t);
-    mmap_params.flags = UCP_MEM_MAP_ALLOCATE;
     if (dtl_handle->comm_mode == DYAD_COMM_SEND) {
-        mmap_params.prot = UCP_MEM_MAP_PROT_LOCAL_READ;
-    } else {
-        mmap_params.prot = UCP_MEM_MAP_PROT_REMOTE_WRITE;
-    }
-    status = ucp_mem_map (dtl_handle->ucx_ctx, &mmap_params, &(dtl_handle->mem_handle));
-    if (UCX_STATUS_FAIL (status)) {
-        rc = DYAD_RC_UCXMMAP_FAIL;
-        DYAD_LOG_ERROR (ctx, "ucx_mem_map failed");
+        rc = DYAD_RC_OK;
         goto ucx_allocate_done;
     }
-    attr.field_mask = UCP_MEM_ATTR_FIELD_ADDRESS;
-    status = ucp_mem_query (dtl_handle->mem_handle, &attr);
-    if (UCX_STATUS_FAIL (status)) {
-        ucp_mem_unmap (dtl_handle->ucx_ctx, dtl_handle->mem_handle);
-        rc = DYAD_RC_UCXMMAP_FAIL;
-        DYAD_LOG_ERROR (ctx, "Failed to get address to UCX allocated buffer");
+    DYAD_LOG_INFO (ctx,
+                   "Allocating a receive ring of %u slots of %zu bytes with UCX",
+                   dtl_handle->slots,
+                   dtl_handle->slot_size);
+    rc = ucx_mem_alloc (ctx,
+                        dtl_handle->ucx_ctx,
+                        ucx_slot_offset (dtl_handle, dtl_handle->slots),
+                        UCP_MEM_MAP_PROT_LOCAL_READ | UCP_MEM_MAP_PROT_LOCAL_WRITE
+                            | UCP_MEM_MAP_PROT_REMOTE_READ | UCP_MEM_MAP_PROT_REMOTE_WRITE,
+                        &(dtl_handle->mem_handle),
+                        &(dtl_handle->net_buf));
+    if (DYAD_IS_ERROR (rc)) {
         goto ucx_allocate_done;
     }
-    dtl_handle->net_buf = attr.address;
-    /* On the producer side this is a placeholder that will be overwritten
-     * by the consumer's remote buffer address in dyad_dtl_ucx_rpc_unpack().
-     * On the consumer side this is the actual RDMA destination address sent
-     * to the producer via the RPC payload. */
+    /* On the consumer side this is the actual RDMA destination address sent
+     * to the producer via the RPC payload. On the producer side it is
+     * overwritten by the consumer's address in dyad_dtl_ucx_rpc_unpack(). */
     dtl_handle->cons_buf_ptr = (uint64_t)dtl_handle->net_buf;
+    ucx_ring_reset (dtl_handle);
     DYAD_LOG_DEBUG (ctx, "Done writing address");
-    if (dtl_handle->comm_mode == DYAD_COMM_RECV) {
-        status = ucp_rkey_pack (dtl_handle->ucx_ctx,
-                                dtl_handle->mem_handle,
-                                &(dtl_handle->rkey_buf),
-                                &(dtl_handle->rkey_size));
-        if (UCX_STATUS_FAIL (status)) {
-            ucp_mem_unmap (dtl_handle->ucx_ctx, dtl_handle->mem_handle);
-            rc = DYAD_RC_UCXRKEY_PACK_FAILED;
-            DYAD_LOG_ERROR (ctx, "ucp_rkey_pack failed errno %d", status);
-            goto ucx_allocate_done;
-        }
+    status = ucp_rkey_pack (dtl_handle->ucx_ctx,
+                            dtl_handle->mem_handle,
+                            &(dtl_handle->rkey_buf),
+                            &(dtl_handle->rkey_size));
+    if (UCX_STATUS_FAIL (status)) {
+        ucp_mem_unmap (dtl_handle->ucx_ctx, dtl_handle->mem_handle);
+        dtl_handle->mem_handle = NULL;
+        dtl_handle->net_buf = NULL;
+        rc = DYAD_RC_UCXRKEY_PACK_FAILED;
+        DYAD_LOG_ERROR (ctx, "ucp_rkey_pack failed errno %d", status);
+        goto ucx_allocate_done;
     }
     rc = DYAD_RC_OK;
 
@@ -390,6 +479,258 @@ ucx_free_buf_done:;
     return rc;
 }
 
+
+/**
+ * @brief Size class of a buffer of @p size bytes in the registered buffer
+ *        pool.
+ *
+ * @return The index of the smallest class holding @p size bytes, or -1 if
+ *         @p size is larger than all classes.
+ */
+static inline int ucx_pool_class (size_t size)
+{
+    size_t class_size = DYAD_UCX_POOL_MIN_CLASS;
+    int cls = 0;
+    for (cls = 0; cls < (int)DYAD_UCX_POOL_CLASSES; cls++) {
+        if (size <= class_size) {
+            return cls;
+        }
+        class_size *= 4ul;
+    }
+    return -1;
+}
+
+/**
+ * @brief Takes a registered buffer of at least @p size bytes from the pool.
+ *
+ * @details
+ * Reuses a free buffer of the size class of @p size, or allocates and
+ * registers a new one with @c ucx_mem_alloc(). Buffers larger than the
+ * largest class are registered for @p size bytes exactly. Registration
+ * pins the memory and is expensive compared with a transfer, which is
+ * what keeping the buffers registered avoids. The buffer is added to the
+ * list of used buffers until @c ucx_pool_release().
+ *
+ * @param[in]     ctx        DYAD context. Used for logging.
+ * @param[in,out] dtl_handle UCX DTL internal state.
+ * @param[in]     size       Number of bytes needed.
+ * @param[out]    pbuf       Set to the buffer on success.
+ *
+ * @return @c DYAD_RC_OK, @c DYAD_RC_SYSFAIL if the buffer could not be
+ *         tracked, or the return code of @c ucx_mem_alloc().
+ */
+static dyad_rc_t ucx_pool_get (const dyad_ctx_t *ctx,
+                               dyad_dtl_ucx_t *dtl_handle,
+                               size_t size,
+                               ucx_pool_buf_t **pbuf)
+{
+    dyad_rc_t rc = DYAD_RC_OK;
+    int cls = ucx_pool_class (size);
+    ucx_pool_buf_t *buf = NULL;
+
+    if (cls >= 0 && dtl_handle->pool_free[cls] != NULL) {
+        buf = dtl_handle->pool_free[cls];
+        dtl_handle->pool_free[cls] = buf->next;
+        dtl_handle->pool_nfree[cls]--;
+    } else {
+        buf = (ucx_pool_buf_t *)malloc (sizeof (ucx_pool_buf_t));
+        if (buf == NULL) {
+            DYAD_LOG_ERROR (ctx, "Could not allocate a UCX buffer pool entry");
+            return DYAD_RC_SYSFAIL;
+        }
+        buf->cls = cls;
+        buf->size = (cls >= 0) ? (DYAD_UCX_POOL_MIN_CLASS << (2 * cls)) : size;
+        rc = ucx_mem_alloc (ctx,
+                            dtl_handle->ucx_ctx,
+                            buf->size,
+                            UCP_MEM_MAP_PROT_LOCAL_READ | UCP_MEM_MAP_PROT_LOCAL_WRITE,
+                            &(buf->memh),
+                            &(buf->addr));
+        if (DYAD_IS_ERROR (rc)) {
+            free (buf);
+            return rc;
+        }
+        DYAD_LOG_DEBUG (ctx, "Registered a pool buffer of %zu bytes with UCX", buf->size);
+    }
+    buf->next = dtl_handle->pool_used;
+    dtl_handle->pool_used = buf;
+    *pbuf = buf;
+    return DYAD_RC_OK;
+}
+
+/**
+ * @brief Finds the used buffer of the pool that contains @p addr.
+ *
+ * @return The buffer, or @c NULL if @p addr is not in a buffer of the pool.
+ */
+static ucx_pool_buf_t *ucx_pool_find (const dyad_dtl_ucx_t *dtl_handle, const void *addr)
+{
+    ucx_pool_buf_t *buf = NULL;
+    for (buf = dtl_handle->pool_used; buf != NULL; buf = buf->next) {
+        if ((const char *)addr >= (const char *)buf->addr
+            && (const char *)addr < (const char *)buf->addr + buf->size) {
+            return buf;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Gives a buffer taken with @c ucx_pool_get() back to the pool.
+ *
+ * @details
+ * Up to @c DYAD_UCX_POOL_KEEP buffers per size class are kept registered
+ * for later transfers. Other buffers are released with
+ * @c ucx_free_buffer().
+ *
+ * @param[in]     ctx        DYAD context. Used for logging.
+ * @param[in,out] dtl_handle UCX DTL internal state.
+ * @param[in]     pbuf       Used buffer of the pool.
+ */
+static void ucx_pool_release (const dyad_ctx_t *ctx,
+                              dyad_dtl_ucx_t *dtl_handle,
+                              ucx_pool_buf_t *pbuf)
+{
+    ucx_pool_buf_t **link = &(dtl_handle->pool_used);
+    while (*link != NULL && *link != pbuf) {
+        link = &((*link)->next);
+    }
+    if (*link != NULL) {
+        *link = pbuf->next;
+    }
+    if (pbuf->cls >= 0 && dtl_handle->pool_nfree[pbuf->cls] < DYAD_UCX_POOL_KEEP) {
+        pbuf->next = dtl_handle->pool_free[pbuf->cls];
+        dtl_handle->pool_free[pbuf->cls] = pbuf;
+        dtl_handle->pool_nfree[pbuf->cls]++;
+        return;
+    }
+    ucx_free_buffer (ctx, dtl_handle->ucx_ctx, pbuf->memh, &(pbuf->addr));
+    free (pbuf);
+}
+
+/**
+ * @brief Releases every buffer of the pool, whether free or still used.
+ *
+ * @param[in]     ctx        DYAD context. Used for logging.
+ * @param[in,out] dtl_handle UCX DTL internal state.
+ */
+static void ucx_pool_destroy (const dyad_ctx_t *ctx, dyad_dtl_ucx_t *dtl_handle)
+{
+    ucx_pool_buf_t *buf = NULL;
+    ucx_pool_buf_t **list = NULL;
+    unsigned cls = 0u;
+    // The last iteration releases the buffers still in use
+    for (cls = 0u; cls <= DYAD_UCX_POOL_CLASSES; cls++) {
+        list = (cls < DYAD_UCX_POOL_CLASSES) ? &(dtl_handle->pool_free[cls])
+                                             : &(dtl_handle->pool_used);
+        while (*list != NULL) {
+            buf = *list;
+            *list = buf->next;
+            ucx_free_buffer (ctx, dtl_handle->ucx_ctx, buf->memh, &(buf->addr));
+            free (buf);
+        }
+        if (cls < DYAD_UCX_POOL_CLASSES) {
+            dtl_handle->pool_nfree[cls] = 0u;
+        }
+    }
+}
+
+/**
+ * @brief Unpacks the consumer's remote key for the current connection.
+ *
+ * @details
+ * Any key left from an earlier send on this connection is destroyed
+ * first, so that several puts may share one connection without leaking
+ * @c ucp_rkey_t handles.
+ *
+ * @param[in] ctx DYAD context.
+ *
+ * @return @c UCS_OK on success, or @c UCS_ERR_NOT_CONNECTED if there is
+ *         no endpoint or remote key buffer, or if unpacking failed.
+ */
+static inline ucs_status_t ucx_unpack_rkey (const dyad_ctx_t *ctx)
+{
+    ucs_status_t status = UCS_OK;
+    dyad_dtl_ucx_t *dtl_handle = ctx->dtl_handle->private_dtl.ucx_dtl_handle;
+    if (dtl_handle->ep == NULL) {
+        DYAD_LOG_ERROR (ctx, "UCP endpoint was not created prior to invoking send!");
+        return UCS_ERR_NOT_CONNECTED;
+    }
+    if (dtl_handle->rkey_buf == NULL) {
+        DYAD_LOG_ERROR (ctx, "UCP remote key buffer is NULL prior to invoking send!");
+        return UCS_ERR_NOT_CONNECTED;
+    }
+    if (dtl_handle->rkey != NULL) {
+        ucp_rkey_destroy (dtl_handle->rkey);
+        dtl_handle->rkey = NULL;
+    }
+    status = ucp_ep_rkey_unpack (dtl_handle->ep, dtl_handle->rkey_buf, &(dtl_handle->rkey));
+    if (UCX_STATUS_FAIL (status)) {
+        DYAD_LOG_ERROR (ctx, "ucp_ep_rkey_unpack failed");
+        dtl_handle->rkey = NULL;
+        return UCS_ERR_NOT_CONNECTED;
+    }
+    return UCS_OK;
+}
+
+/**
+ * @brief Issues a non-blocking RDMA put into the consumer's buffer.
+ *
+ * @details
+ * Requires the consumer's remote key to be unpacked already (see
+ * @c ucx_unpack_rkey()). The data is written at @p remote_offset bytes
+ * past @c dtl_handle->cons_buf_ptr.
+ *
+ * @param[in] ctx           DYAD context.
+ * @param[in] buf           Local buffer containing the data to send.
+ * @param[in] buflen        Number of bytes to send.
+ * @param[in] remote_offset Offset into the consumer's buffer.
+ * @param[in] memh          Registration of @p buf, or @c NULL to let UCX
+ *                          look it up. Only passed on to UCX 1.14 and
+ *                          newer, which accept it as a request parameter.
+ *
+ * @return Same as @c ucx_send_no_wait().
+ */
+static inline ucs_status_ptr_t ucx_put_no_wait (const dyad_ctx_t *ctx,
+                                                void *buf,
+                                                size_t buflen,
+                                                uint64_t remote_offset,
+                                                ucp_mem_h memh)
+{
+    DYAD_C_FUNCTION_START ();
+    ucs_status_ptr_t stat_ptr = NULL;
+    dyad_dtl_ucx_t *dtl_handle = ctx->dtl_handle->private_dtl.ucx_dtl_handle;
+    ucp_request_param_t params;
+    params.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK;
+    params.cb.send = dyad_send_callback;
+#if UCP_API_VERSION >= UCP_VERSION(1, 14)
+    if (memh != NULL) {
+        params.op_attr_mask |= UCP_OP_ATTR_FIELD_MEMH;
+        params.memh = memh;
+    }
+#else   // UCP_API_VERSION
+    (void)memh;
+#endif  // UCP_API_VERSION
+    stat_ptr = ucp_put_nbx (dtl_handle->ep,
+                            buf,
+                            buflen,
+                            dtl_handle->cons_buf_ptr + remote_offset,
+                            dtl_handle->rkey,
+                            &params);
+    if (UCS_PTR_IS_ERR (stat_ptr)) {
+        DYAD_LOG_ERROR (ctx,
+                        "ucp_put_nbx() failed %s (%d)\n",
+                        ucs_status_string (UCS_PTR_STATUS (stat_ptr)),
+                        UCS_PTR_STATUS (stat_ptr));
+        stat_ptr = (void *)UCS_ERR_NOT_CONNECTED;
+        goto ucx_put_no_wait_done;
+    }
+    DYAD_LOG_INFO (ctx, "written data buf of length %lu", buflen);
+ucx_put_no_wait_done:;
+    DYAD_C_FUNCTION_END ();
+    return stat_ptr;
+}
+
 /**
  * @brief Initiates a non-blocking UCX RDMA push operation.
  *
@@ -428,8 +769,10 @@ ucx_free_buf_done:;
  *       @c ucp_ep_rkey_unpack() returns.
  *
  * @note The @p is_warmup parameter is accepted for interface consistency
- *       with the receive path (@c ucx_recv_no_wait()) but is not used —
- *       no warmup distinction is made on the send path.
+ *       but is not used — no warmup distinction is made on the send path.
+ *
+ * @note Only used by @c ucx_warmup(). Transfers to a consumer go through
+ *       @c ucx_send_msg(), which puts into the slots of its receive ring.
  *
  * @note This function uses the push RDMA model: the producer pushes data
  *       directly into the consumer's pre-registered memory buffer via
@@ -440,8 +783,7 @@ ucx_free_buf_done:;
  * @param[in] ctx       DYAD context. The UCX endpoint, remote key buffer,
  *                      and consumer buffer pointer are read from the UCX
  *                      DTL internal state.
- * @param[in] is_warmup Unused. Accepted for interface consistency with
- *                      the receive path.
+ * @param[in] is_warmup Unused. Accepted for interface consistency.
  * @param[in] buf       Local buffer containing the data to send.
  * @param[in] buflen    Number of bytes to send.
  *
@@ -457,109 +799,507 @@ ucx_free_buf_done:;
  *                               @c ucp_ep_rkey_unpack() failed, or
  *                               @c ucp_put_nbx() returned an error.
  */
-static inline ucs_status_ptr_t ucx_send_no_wait (const dyad_ctx_t *ctx,
-                                                 bool is_warmup,
-                                                 void *buf,
-                                                 size_t buflen)
+static inline ucs_status_ptr_t ucx_send_no_wait (const dyad_ctx_t *ctx,
+                                                 bool is_warmup,
+                                                 void *buf,
+                                                 size_t buflen)
+{
+    /**
+     * The warmup flag is not used but is kept for interface consistency.
+     */
+    (void)is_warmup;
+    DYAD_C_FUNCTION_START ();
+    ucs_status_ptr_t stat_ptr = NULL;
+    if (UCX_STATUS_FAIL (ucx_unpack_rkey (ctx))) {
+        stat_ptr = (void *)UCS_ERR_NOT_CONNECTED;
+        goto ucx_send_no_wait_done;
+    }
+    stat_ptr = ucx_put_no_wait (ctx, buf, buflen, 0ul, NULL);
+ucx_send_no_wait_done:;
+    DYAD_C_FUNCTION_END ();
+    return stat_ptr;
+}
+
+/**
+ * @brief Waits until the slot of the next chunk is free in the consumer's
+ *        receive ring.
+ *
+ * @details
+ * A slot is free once the consumer released the chunk put into it one
+ * round of the ring earlier. The consumer's count of released chunks is
+ * read with @c ucp_get_nbx() from the start of its ring, only when the
+ * chunks put since the last read fill the ring.
+ *
+ * @param[in] ctx DYAD context.
+ *
+ * @return @c UCS_OK, or the status of the failed get.
+ */
+static ucs_status_t ucx_wait_slot (const dyad_ctx_t *ctx)
+{
+    dyad_dtl_ucx_t *dtl_handle = ctx->dtl_handle->private_dtl.ucx_dtl_handle;
+    ucp_request_param_t params;
+    ucs_status_ptr_t stat_ptr = NULL;
+    ucs_status_t status = UCS_OK;
+
+    while (dtl_handle->chunk_seq - dtl_handle->consumed >= dtl_handle->slots) {
+        params.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK;
+        params.cb.send = dyad_send_callback;
+        stat_ptr = ucp_get_nbx (dtl_handle->ep,
+                                &(dtl_handle->cons_count),
+                                sizeof (dtl_handle->cons_count),
+                                dtl_handle->cons_buf_ptr,
+                                dtl_handle->rkey,
+                                &params);
+        status = dyad_ucx_request_wait (ctx, stat_ptr);
+        if (UCX_STATUS_FAIL (status)) {
+            DYAD_LOG_ERROR (ctx,
+                            "ucp_get_nbx() failed %s (%d)",
+                            ucs_status_string (status),
+                            status);
+            return status;
+        }
+        if (dtl_handle->cons_count > dtl_handle->consumed) {
+            dtl_handle->consumed = dtl_handle->cons_count;
+        } else {
+            nanosleep ((const struct timespec[]){{0, 10000L}}, NULL);
+        }
+    }
+    return UCS_OK;
+}
+
+/**
+ * @brief Waits for the puts of the last chunk put into @p slot.
+ *
+ * @param[in] ctx  DYAD context.
+ * @param[in] slot Slot of the consumer's receive ring.
+ *
+ * @return @c UCS_OK, or the status of the first failed put.
+ */
+static ucs_status_t ucx_wait_puts (const dyad_ctx_t *ctx, unsigned slot)
+{
+    dyad_dtl_ucx_t *dtl_handle = ctx->dtl_handle->private_dtl.ucx_dtl_handle;
+    ucs_status_t status = UCS_OK;
+    ucs_status_t req_status = UCS_OK;
+    size_t i = 0ul;
+    for (i = 0ul; i < 3ul; i++) {
+        if (dtl_handle->send_req[slot][i] == NULL) {
+            continue;
+        }
+        req_status = dyad_ucx_request_wait (ctx, dtl_handle->send_req[slot][i]);
+        dtl_handle->send_req[slot][i] = NULL;
+        if (status == UCS_OK) {
+            status = req_status;
+        }
+    }
+    return status;
+}
+
+/**
+ * @brief Waits for the puts of all chunks in flight.
+ *
+ * @param[in] ctx DYAD context.
+ *
+ * @return @c UCS_OK, or the status of the first failed put.
+ */
+static ucs_status_t ucx_flush_puts (const dyad_ctx_t *ctx)
+{
+    ucs_status_t status = UCS_OK;
+    ucs_status_t slot_status = UCS_OK;
+    unsigned slot = 0u;
+    for (slot = 0u; slot < DYAD_UCX_MAX_SLOTS; slot++) {
+        slot_status = ucx_wait_puts (ctx, slot);
+        if (status == UCS_OK) {
+            status = slot_status;
+        }
+    }
+    return status;
+}
+
+/**
+ * @brief Puts one chunk of a message into the next slot of the consumer's
+ *        receive ring, without waiting for completion.
+ *
+ * @details
+ * Once the slot is free (see @c ucx_wait_slot()) and the puts of the
+ * chunk it last held have completed, puts the data of the chunk and its
+ * lengths into the slot. After a @c ucp_worker_fence(), the sequence
+ * number of the chunk is put in front of them, so that the consumer
+ * polling on it in @c ucx_recv_chunk() never sees it before the rest of
+ * the chunk. The control words are put from @c dtl_handle->send_hdr,
+ * which stays untouched until the puts complete.
+ *
+ * @param[in] ctx      DYAD context.
+ * @param[in] data     Data of the chunk.
+ * @param[in] len      Number of bytes of @p data, at most @c slot_size.
+ * @param[in] msg_len  Number of bytes of the whole message.
+ * @param[in] offset   Offset of @p data in the message.
+ * @param[in] memh     Registration of @p data, or @c NULL.
+ *
+ * @return @c UCS_OK, or the status of the failed operation.
+ */
+static ucs_status_t ucx_put_chunk (const dyad_ctx_t *ctx,
+                                   const char *data,
+                                   size_t len,
+                                   size_t msg_len,
+                                   size_t offset,
+                                   ucp_mem_h memh)
+{
+    dyad_dtl_ucx_t *dtl_handle = ctx->dtl_handle->private_dtl.ucx_dtl_handle;
+    unsigned slot = (unsigned)(dtl_handle->chunk_seq % dtl_handle->slots);
+    uint64_t hdr_offset = ucx_slot_offset (dtl_handle, slot);
+    ucx_slot_hdr_t *hdr = &(dtl_handle->send_hdr[slot]);
+    ucs_status_ptr_t *req = dtl_handle->send_req[slot];
+    ucs_status_t status = UCS_OK;
+
+    status = ucx_wait_slot (ctx);
+    if (UCX_STATUS_FAIL (status)) {
+        return status;
+    }
+    status = ucx_wait_puts (ctx, slot);
+    if (UCX_STATUS_FAIL (status)) {
+        return status;
+    }
+    hdr->seq = dtl_handle->chunk_seq + 1ull;
+    hdr->len = len;
+    hdr->msg_len = msg_len;
+    hdr->offset = offset;
+    if (len > 0ul) {
+        req[0] = ucx_put_no_wait (ctx, (void *)data, len, hdr_offset + DYAD_UCX_HDR_SIZE, memh);
+        if (UCS_PTR_IS_ERR (req[0])) {
+            req[0] = NULL;
+            return UCS_ERR_NOT_CONNECTED;
+        }
+    }
+    req[1] = ucx_put_no_wait (ctx,
+                              &(hdr->len),
+                              sizeof (ucx_slot_hdr_t) - offsetof (ucx_slot_hdr_t, len),
+                              hdr_offset + offsetof (ucx_slot_hdr_t, len),
+                              NULL);
+    if (UCS_PTR_IS_ERR (req[1])) {
+        req[1] = NULL;
+        return UCS_ERR_NOT_CONNECTED;
+    }
+    // The consumer polls on the sequence number, so it must land last
+    status = ucp_worker_fence (dtl_handle->ucx_worker);
+    if (UCX_STATUS_FAIL (status)) {
+        DYAD_LOG_ERROR (ctx, "ucp_worker_fence failed");
+        return status;
+    }
+    req[2] = ucx_put_no_wait (ctx, &(hdr->seq), sizeof (hdr->seq), hdr_offset, NULL);
+    if (UCS_PTR_IS_ERR (req[2])) {
+        req[2] = NULL;
+        return UCS_ERR_NOT_CONNECTED;
+    }
+    dtl_handle->chunk_seq++;
+    return UCS_OK;
+}
+
+/**
+ * @brief Sends a message of any size into the consumer's receive ring.
+ *
+ * @details
+ * Cuts @p buf into chunks of at most @c slot_size bytes, put with
+ * @c ucx_put_chunk() into the rotating slots of the ring without waiting
+ * for one another, so that as many chunks as the ring has slots are in
+ * flight at once. A message larger than the ring proceeds as the consumer
+ * releases slots. Returns once all puts have completed, so that @p buf can
+ * be reused. An empty message is sent as a single empty chunk.
+ *
+ * With @p staging, each chunk is first copied into that registered buffer
+ * and put from there, once the puts of the previous chunk have completed.
+ *
+ * @param[in] ctx      DYAD context.
+ * @param[in] buf      Message to send.
+ * @param[in] buflen   Number of bytes of @p buf.
+ * @param[in] memh     Registration of @p buf, or @c NULL to let UCX look
+ *                     it up. Unused with @p staging.
+ * @param[in] staging  Buffer of the pool of at least @c slot_size bytes,
+ *                     or @c NULL to put straight from @p buf.
+ *
+ * @return @c dyad_rc_t return code:
+ * @retval DYAD_RC_OK            Message sent successfully.
+ * @retval DYAD_RC_UCXCOMM_FAIL  Unpacking the remote key, or one of the
+ *                               gets, fences or puts failed.
+ */
+static dyad_rc_t ucx_send_msg (const dyad_ctx_t *ctx,
+                               const char *buf,
+                               size_t buflen,
+                               ucp_mem_h memh,
+                               ucx_pool_buf_t *staging)
+{
+    dyad_dtl_ucx_t *dtl_handle = ctx->dtl_handle->private_dtl.ucx_dtl_handle;
+    ucs_status_t status = UCS_OK;
+    ucs_status_t flush_status = UCS_OK;
+    uint64_t first_seq = dtl_handle->chunk_seq;
+    size_t offset = 0ul;
+    size_t len = 0ul;
+
+    if (UCX_STATUS_FAIL (ucx_unpack_rkey (ctx))) {
+        return DYAD_RC_UCXCOMM_FAIL;
+    }
+    do {
+        len = (buflen - offset > dtl_handle->slot_size) ? dtl_handle->slot_size : buflen - offset;
+        if (staging != NULL) {
+            status = ucx_flush_puts (ctx);
+            if (UCX_STATUS_FAIL (status)) {
+                break;
+            }
+            memcpy (staging->addr, buf + offset, len);
+            status = ucx_put_chunk (ctx, staging->addr, len, buflen, offset, staging->memh);
+        } else {
+            status = ucx_put_chunk (ctx, buf + offset, len, buflen, offset, memh);
+        }
+        if (UCX_STATUS_FAIL (status)) {
+            break;
+        }
+        offset += len;
+    } while (offset < buflen);
+    // Wait for the puts in any case, since the caller may release buf
+    flush_status = ucx_flush_puts (ctx);
+    if (status == UCS_OK) {
+        status = flush_status;
+    }
+    if (UCX_STATUS_FAIL (status)) {
+        DYAD_LOG_ERROR (ctx, "UCP Put failed (status = %d)!\n", (int)status);
+        return DYAD_RC_UCXCOMM_FAIL;
+    }
+    DYAD_LOG_INFO (ctx,
+                   "Sent %zu bytes in %" PRIu64 " chunks with UCP\n",
+                   buflen,
+                   dtl_handle->chunk_seq - first_seq);
+    return DYAD_RC_OK;
+}
+
+/**
+ * @brief Drops the payload and the RPC sent again of the previous fetch.
+ */
+static void ucx_rpc_clear (dyad_dtl_ucx_t *dtl_handle)
+{
+    json_decref (dtl_handle->rpc_payload);
+    dtl_handle->rpc_payload = NULL;
+    flux_future_destroy (dtl_handle->retry_f);
+    dtl_handle->retry_f = NULL;
+    dtl_handle->retried = false;
+}
+
+/**
+ * @brief Finds the key under which the producer on @p rank knows this
+ *        consumer.
+ *
+ * @return The key, or 0 if the consumer did not register with it.
+ */
+static uint64_t ucx_reg_find (const dyad_dtl_ucx_t *dtl_handle, uint32_t rank)
+{
+    size_t i = 0ul;
+    for (i = 0ul; i < dtl_handle->nregs; i++) {
+        if (dtl_handle->regs[i].rank == rank) {
+            return dtl_handle->regs[i].key;
+        }
+    }
+    return 0ull;
+}
+
+/**
+ * @brief Forgets the registration with the producer on @p rank, so that
+ *        the next request to it registers again.
+ */
+static void ucx_reg_forget (dyad_dtl_ucx_t *dtl_handle, uint32_t rank)
+{
+    size_t i = 0ul;
+    for (i = 0ul; i < dtl_handle->nregs; i++) {
+        if (dtl_handle->regs[i].rank == rank) {
+            dtl_handle->regs[i] = dtl_handle->regs[--dtl_handle->nregs];
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Registers this consumer with the producer on @p rank.
+ *
+ * @details
+ * Sends the geometry and address of the receive ring, the worker address
+ * and the packed key of the ring in a raw @c DYAD_DTL_REGISTER_RPC_NAME
+ * request, and remembers the key the producer answers with.
+ *
+ * @param[in]  ctx  DYAD context.
+ * @param[in]  rank Broker rank of the producer.
+ * @param[out] key  Set to the key under which the producer knows this
+ *                  consumer.
+ *
+ * @return @c dyad_rc_t return code:
+ * @retval DYAD_RC_OK      The consumer is registered.
+ * @retval DYAD_RC_SYSFAIL The payload or the list of registrations could
+ *                         not be allocated.
+ * @retval DYAD_RC_BADRPC  The RPC failed or its response is not a key.
+ */
+static dyad_rc_t ucx_register (const dyad_ctx_t *ctx, uint32_t rank, uint64_t *key)
+{
+    DYAD_C_FUNCTION_START ();
+    dyad_dtl_ucx_t *dtl_handle = ctx->dtl_handle->private_dtl.ucx_dtl_handle;
+    dyad_rc_t rc = DYAD_RC_OK;
+    ucx_reg_hdr_t *reg = NULL;
+    ucx_reg_t *regs = NULL;
+    size_t reg_len = sizeof (ucx_reg_hdr_t) + dtl_handle->local_addr_len + dtl_handle->rkey_size;
+    size_t cap = 0ul;
+    flux_future_t *f = NULL;
+    const void *data = NULL;
+    size_t len = 0ul;
+
+    if (dtl_handle->nregs == dtl_handle->regs_cap) {
+        cap = (dtl_handle->regs_cap == 0ul) ? 16ul : 2ul * dtl_handle->regs_cap;
+        regs = realloc (dtl_handle->regs, cap * sizeof (ucx_reg_t));
+        if (regs == NULL) {
+            rc = DYAD_RC_SYSFAIL;
+            goto ucx_register_done;
+        }
+        dtl_handle->regs = regs;
+        dtl_handle->regs_cap = cap;
+    }
+    reg = malloc (reg_len);
+    if (reg == NULL) {
+        rc = DYAD_RC_SYSFAIL;
+        goto ucx_register_done;
+    }
+    reg->version = DYAD_UCX_REG_VERSION;
+    reg->slots = dtl_handle->slots;
+    reg->slot_size = dtl_handle->slot_size;
+    reg->cons_buf = dtl_handle->cons_buf_ptr;
+    reg->addr_len = (uint32_t)dtl_handle->local_addr_len;
+    reg->rkey_len = (uint32_t)dtl_handle->rkey_size;
+    memcpy ((char *)reg + sizeof (ucx_reg_hdr_t),
+            dtl_handle->local_address,
+            dtl_handle->local_addr_len);
+    memcpy ((char *)reg + sizeof (ucx_reg_hdr_t) + dtl_handle->local_addr_len,
+            dtl_handle->rkey_buf,
+            dtl_handle->rkey_size);
+    f = flux_rpc_raw (dtl_handle->h, DYAD_DTL_REGISTER_RPC_NAME, reg, (int)reg_len, rank, 0);
+    free (reg);
+    if (f == NULL || flux_rpc_get_raw (f, &data, &len) < 0 || len != sizeof (uint64_t)) {
+        DYAD_LOG_ERROR (ctx, "Could not register with the producer on broker %u", rank);
+        rc = DYAD_RC_BADRPC;
+        goto ucx_register_done;
+    }
+    memcpy (key, data, sizeof (uint64_t));
+    dtl_handle->regs[dtl_handle->nregs].rank = rank;
+    dtl_handle->regs[dtl_handle->nregs].key = *key;
+    dtl_handle->nregs++;
+    DYAD_LOG_DEBUG (ctx, "Registered with broker %u as UCX consumer %" PRIu64, rank, *key);
+ucx_register_done:;
+    flux_future_destroy (f);
+    DYAD_C_FUNCTION_END ();
+    return rc;
+}
+
+/**
+ * @brief Sends the fetch request of the current transfer again, after the
+ *        producer failed it with @c ESTALE.
+ *
+ * @details
+ * The producer lost the registration of this consumer, e.g., because its
+ * module was reloaded or its registry dropped it. Forgets the key,
+ * registers again with @c ucx_register(), and sends the payload kept by
+ * @c dyad_dtl_ucx_rpc_pack(), with the new key, to the same topic. The new
+ * RPC replaces @c dtl_handle->f and is owned in @c dtl_handle->retry_f
+ * until @c dyad_dtl_ucx_rpc_future() hands it over.
+ *
+ * Only done once per fetch, and only before its first chunk arrived, so
+ * that no data is received twice.
+ *
+ * @param[in] ctx DYAD context.
+ *
+ * @return @c dyad_rc_t return code:
+ * @retval DYAD_RC_OK      The request was sent again.
+ * @retval DYAD_RC_BADRPC  The fetch was already sent again or received
+ *                         data, or registering or sending failed.
+ * @retval DYAD_RC_BADPACK The new key could not be set in the payload.
+ */
+static dyad_rc_t ucx_rpc_retry (const dyad_ctx_t *ctx)
 {
-    /**
-     * The warmup is not used but is passed for consistency with the recv_no_wait calls.
-     */
-    (void)is_warmup;
     DYAD_C_FUNCTION_START ();
-    ucs_status_ptr_t stat_ptr = NULL;
     dyad_dtl_ucx_t *dtl_handle = ctx->dtl_handle->private_dtl.ucx_dtl_handle;
-    if (dtl_handle->ep == NULL) {
-        DYAD_LOG_ERROR (ctx, "UCP endpoint was not created prior to invoking send!");
-        stat_ptr = (void *)UCS_ERR_NOT_CONNECTED;
-        goto ucx_send_no_wait_done;
+    dyad_rc_t rc = DYAD_RC_OK;
+    uint64_t key = 0ull;
+    const char *topic = DYAD_DTL_RPC_NAME;
+
+    if (dtl_handle->retried || dtl_handle->rpc_payload == NULL || dtl_handle->chunk_seq > 0ull) {
+        rc = DYAD_RC_BADRPC;
+        goto ucx_rpc_retry_done;
     }
-    if (dtl_handle->rkey_buf == NULL) {
-        DYAD_LOG_ERROR (ctx, "UCP remote key buffer is NULL prior to invoking send!");
-        stat_ptr = (void *)UCS_ERR_NOT_CONNECTED;
-        goto ucx_send_no_wait_done;
+    dtl_handle->retried = true;
+    DYAD_LOG_INFO (ctx,
+                   "Producer on broker %u lost the registration of this consumer, "
+                   "registering again",
+                   dtl_handle->prod_rank);
+    ucx_reg_forget (dtl_handle, dtl_handle->prod_rank);
+    rc = ucx_register (ctx, dtl_handle->prod_rank, &key);
+    if (DYAD_IS_ERROR (rc)) {
+        rc = DYAD_RC_BADRPC;
+        goto ucx_rpc_retry_done;
     }
-    ucs_status_t status =
-        ucp_ep_rkey_unpack (dtl_handle->ep, dtl_handle->rkey_buf, &(dtl_handle->rkey));
-    if (UCX_STATUS_FAIL (status)) {
-        DYAD_LOG_ERROR (ctx, "ucp_ep_rkey_unpack failed");
-        stat_ptr = (void *)UCS_ERR_NOT_CONNECTED;
-        goto ucx_send_no_wait_done;
+    if (json_object_set_new (dtl_handle->rpc_payload, "key", json_integer ((json_int_t)key)) < 0) {
+        rc = DYAD_RC_BADPACK;
+        goto ucx_rpc_retry_done;
     }
-    ucp_request_param_t params;
-    params.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK;
-    params.cb.send = dyad_send_callback;
-    stat_ptr = ucp_put_nbx (dtl_handle->ep,
-                            buf,
-                            buflen,
-                            dtl_handle->cons_buf_ptr,
-                            dtl_handle->rkey,
-                            &params);
-    if (UCS_PTR_IS_ERR (stat_ptr)) {
-        DYAD_LOG_ERROR (ctx,
-                        "ucp_put_nbx() failed %s (%d)\n",
-                        ucs_status_string (UCS_PTR_STATUS (stat_ptr)),
-                        UCS_PTR_STATUS (stat_ptr));
-        stat_ptr = (void *)UCS_ERR_NOT_CONNECTED;
-        goto ucx_send_no_wait_done;
+    if (json_object_get (dtl_handle->rpc_payload, "upaths") != NULL) {
+        topic = DYAD_DTL_BATCH_RPC_NAME;
     }
-    DYAD_LOG_INFO (ctx, "written data buf of length %lu", buflen);
-ucx_send_no_wait_done:;
+    dtl_handle->retry_f = flux_rpc_pack (dtl_handle->h,
+                                         topic,
+                                         dtl_handle->prod_rank,
+                                         FLUX_RPC_STREAMING,
+                                         "O",
+                                         dtl_handle->rpc_payload);
+    if (dtl_handle->retry_f == NULL) {
+        DYAD_LOG_ERROR (ctx, "Cannot send the RPC again to broker %u", dtl_handle->prod_rank);
+        rc = DYAD_RC_BADRPC;
+        goto ucx_rpc_retry_done;
+    }
+    dtl_handle->f = dtl_handle->retry_f;
+    rc = DYAD_RC_OK;
+ucx_rpc_retry_done:;
     DYAD_C_FUNCTION_END ();
-    return stat_ptr;
+    return rc;
 }
 
 /**
- * @brief Waits for incoming RDMA data by polling the consumer's
- *        pre-registered buffer.
+ * @brief Waits for the next chunk to land in the consumer's receive ring.
  *
  * @details
- * Busy-polls the first @c sizeof(ssize_t) bytes of
- * @c dtl_handle->net_buf, which the producer prepends with the file
- * size before initiating the RDMA push via @c ucp_put_nbx(). The
- * consumer spins until this value becomes non-zero, indicating that
- * the producer has started writing data into the buffer.
- *
- * On each iteration the UCX worker is progressed via
- * @c ucp_worker_progress() to process incoming network events, and
- * the thread sleeps for 10 microseconds to avoid saturating the CPU.
- *
- * This approach works because the UCX backend uses a push RDMA model —
- * the producer writes directly into the consumer's pre-registered
- * memory buffer (@c dtl_handle->net_buf) via @c ucp_put_nbx(). The
- * prepended file size acts as a sentinel: once the producer has
- * initiated the RDMA put, the first bytes of the buffer are non-zero,
- * signalling to the consumer that data is arriving.
+ * Busy-polls the sequence number of the slot of chunk
+ * @c dtl_handle->chunk_seq, which the producer puts with
+ * @c ucx_put_chunk() after a fence, once the data and lengths of the chunk
+ * are in place. The chunk has arrived once the number is
+ * @c chunk_seq + 1. Older chunks that went through the same slot carry
+ * smaller numbers, and @c ucx_ring_reset() clears them before each
+ * transfer.
+ *
+ * Between checks, the UCX worker is progressed via
+ * @c ucp_worker_progress() to process incoming network events, and the
+ * thread sleeps for 10 microseconds to avoid saturating the CPU.
  *
  * @note Unlike @c dyad_ucx_request_wait() which polls a UCX request
  *       handle for a specific operation, this function polls the buffer
  *       contents directly. This is necessary because the consumer has
- *       no UCX request handle for the producer's @c ucp_put_nbx() call
- *       — the put is one-sided and the consumer is not notified by UCX
- *       when it completes.
- *
- * @note The @p buf and @p buflen output parameters are accepted for
- *       interface consistency but are not populated by this function.
- *       The actual buffer pointer and length are read from
- *       @c dtl_handle->net_buf and the prepended size field by the
- *       caller (@c dyad_dtl_ucx_recv()) after this function returns.
- *
- * @note The @p is_warmup parameter controls whether this is a warmup
- *       iteration used to prime the RDMA connection before the actual
- *       data transfer. During warmup the buffer sentinel check still
- *       applies but the received data is discarded by the caller.
- *
- * @param[in]  ctx      DYAD context. The UCX worker and network buffer
- *                      are read from the UCX DTL internal state.
- * @param[in]  is_warmup If @c true, this is a warmup receive used to
- *                      prime the RDMA connection.
- * @param[out] buf      Unused by this function. Populated by the caller
- *                      after return.
- * @param[out] buflen   Unused by this function. Populated by the caller
- *                      after return.
- *
- * @return Always returns @c NULL. The actual data is read directly from
- *         @c dtl_handle->net_buf by the caller.
+ *       no UCX request handle for the producer's @c ucp_put_nbx() calls
+ *       — the puts are one-sided and the consumer is not notified by UCX
+ *       when they complete.
+ *
+ * Every @c DYAD_UCX_RPC_POLL polls, the RPC stored by
+ * @c dyad_dtl_ucx_rpc_recv_response() is checked without blocking. If the
+ * producer answered it with an error, e.g., because it does not know the
+ * key of this consumer after a reload of the module, the chunk will never
+ * come. If the producer lost the registration of this consumer and
+ * answered with @c ESTALE, the request is sent again under a new key with
+ * @c ucx_rpc_retry(), once, and the wait goes on. Otherwise, the
+ * registration with the producer is forgotten.
+ *
+ * @param[in] ctx DYAD context. The UCX worker and receive ring are read
+ *                from the UCX DTL internal state.
+ *
+ * @return The control words of the slot, followed by the data of the
+ *         chunk, or @c NULL if the producer failed the RPC.
+ *         @c chunk_seq is left unchanged.
  *
  * @todo Replace the busy-poll with a more efficient notification
  *       mechanism. The current approach wastes CPU cycles and adds
@@ -567,28 +1307,51 @@ ucx_send_no_wait_done:;
  *       or a lightweight atomic flag could provide lower-latency
  *       completion notification.
  */
-static inline ucs_status_ptr_t ucx_recv_no_wait (const dyad_ctx_t *ctx,
-                                                 bool is_warmup,
-                                                 void **buf,
-                                                 size_t *buflen)
+static ucx_slot_hdr_t *ucx_recv_chunk (const dyad_ctx_t *ctx)
 {
     DYAD_C_FUNCTION_START ();
-    ucs_status_ptr_t stat_ptr = NULL;
     dyad_dtl_ucx_t *dtl_handle = ctx->dtl_handle->private_dtl.ucx_dtl_handle;
-    ssize_t temp = 0l;
+    ucx_slot_hdr_t *hdr =
+        ucx_slot_hdr (dtl_handle, (unsigned)(dtl_handle->chunk_seq % dtl_handle->slots));
     int is_first = 1;
-    do {
-        memcpy (&temp, dtl_handle->net_buf, sizeof (temp));
-        ucp_worker_progress (ctx->dtl_handle->private_dtl.ucx_dtl_handle->ucx_worker);
+    int errnum = 0;
+    unsigned polls = 0u;
+    while (__atomic_load_n (&(hdr->seq), __ATOMIC_ACQUIRE) != dtl_handle->chunk_seq + 1ull) {
+        ucp_worker_progress (dtl_handle->ucx_worker);
         nanosleep ((const struct timespec[]){{0, 10000L}}, NULL);
         if (is_first == 1) {
-            DYAD_LOG_DEBUG (ctx, "Consumer Waiting for worker to finsih all work");
+            DYAD_LOG_DEBUG (ctx,
+                            "Consumer waiting for chunk %" PRIu64 " from producer",
+                            dtl_handle->chunk_seq);
         }
         is_first = 0;
-    } while (temp == 0l);
-    DYAD_LOG_DEBUG (ctx, "Consumer finsihed all work");
+        if (++polls % DYAD_UCX_RPC_POLL != 0u || dtl_handle->f == NULL
+            || flux_future_wait_for (dtl_handle->f, 0.0) < 0
+            || !(flux_rpc_get (dtl_handle->f, NULL) < 0 && errno != ENODATA)) {
+            continue;
+        }
+        errnum = errno;
+        // Recheck the slot, in case the chunk landed before the error
+        if (__atomic_load_n (&(hdr->seq), __ATOMIC_ACQUIRE) == dtl_handle->chunk_seq + 1ull) {
+            break;
+        }
+        if (errnum == ESTALE && !DYAD_IS_ERROR (ucx_rpc_retry (ctx))) {
+            continue;
+        }
+        DYAD_LOG_ERROR (ctx,
+                        "Producer on broker %u failed the RPC before chunk %" PRIu64,
+                        dtl_handle->prod_rank,
+                        dtl_handle->chunk_seq);
+        ucx_reg_forget (dtl_handle, dtl_handle->prod_rank);
+        DYAD_C_FUNCTION_END ();
+        return NULL;
+    }
+    DYAD_LOG_DEBUG (ctx,
+                    "Consumer received chunk %" PRIu64 " of %" PRIu64 " bytes",
+                    dtl_handle->chunk_seq,
+                    hdr->len);
     DYAD_C_FUNCTION_END ();
-    return stat_ptr;
+    return hdr;
 }
 
 /**
@@ -707,15 +1470,116 @@ warmup_region_done:;
     return rc;
 }
 
+/**
+ * @brief UCP context shared by the UCX DTL handles of the process.
+ *
+ * @details
+ * Each handle, i.e., each thread with a DYAD context of its own, creates
+ * a worker of its own in this context, with its own endpoints, receive
+ * ring and registered buffers. The context is created by the first handle
+ * and released by the last one, under @c ucx_shared_lock.
+ */
+static ucp_context_h ucx_shared_ctx = NULL;
+static unsigned ucx_shared_refs = 0u;
+static pthread_mutex_t ucx_shared_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Takes a reference to the process's UCP context, creating it if
+ *        needed.
+ *
+ * @details
+ * The context is created with @c mt_workers_shared set, since the workers
+ * of threads that run concurrently share it.
+ *
+ * @param[in]  ctx      DYAD context, for logging.
+ * @param[in]  debug    Whether to print the UCX configuration.
+ * @param[out] ucx_ctx  Set to the shared context.
+ *
+ * @return The status of @c ucp_config_read() or @c ucp_init().
+ */
+static ucs_status_t ucx_context_get (const dyad_ctx_t *ctx, bool debug, ucp_context_h *ucx_ctx)
+{
+    ucp_params_t ucx_params;
+    ucp_config_t *config = NULL;
+    ucs_status_t status = UCS_OK;
+
+    pthread_mutex_lock (&ucx_shared_lock);
+    if (ucx_shared_refs > 0u) {
+        goto context_get_done;
+    }
+    // Read the UCX configuration
+    DYAD_LOG_INFO (ctx, "Reading UCP config\n");
+    status = ucp_config_read (NULL, NULL, &config);
+    if (UCX_STATUS_FAIL (status)) {
+        DYAD_LOG_ERROR (ctx, "Could not read the UCX config\n");
+        goto context_get_done;
+    }
+
+    // Define the settings, parameters, features, etc.
+    // for the UCX context. UCX will use this info internally
+    // when creating workers, endpoints, etc.
+    //
+    // The settings enabled are:
+    //   * Tag-matching send/recv
+    //   * Remote Memory Access communication
+    //   * Auto initialization of request objects
+    //   * Workers of several threads in the same context
+    ucx_params.field_mask = UCP_PARAM_FIELD_FEATURES | UCP_PARAM_FIELD_REQUEST_SIZE
+                            | UCP_PARAM_FIELD_MT_WORKERS_SHARED;
+    ucx_params.features = UCP_FEATURE_RMA | UCP_FEATURE_AMO32 | UCP_FEATURE_TAG;
+    ucx_params.request_size = sizeof (struct ucx_request);
+    ucx_params.request_init = dyad_ucx_request_init;
+    ucx_params.mt_workers_shared = 1;
+
+    // Initialize UCX
+    DYAD_LOG_INFO (ctx, "Initializing UCP\n");
+    status = ucp_init (&ucx_params, config, &ucx_shared_ctx);
+
+    // If in debug mode, print the configuration of UCX to stderr
+    if (debug) {
+        ucp_config_print (config, stderr, "UCX Configuration", UCS_CONFIG_PRINT_CONFIG);
+    }
+    // Release the config
+    ucp_config_release (config);
+    // Log an error if UCX initialization failed
+    if (UCX_STATUS_FAIL (status)) {
+        DYAD_LOG_ERROR (ctx, "ucp_init failed (status = %d)\n", status);
+        ucx_shared_ctx = NULL;
+    }
+
+context_get_done:;
+    if (ucx_shared_ctx != NULL) {
+        ucx_shared_refs++;
+    }
+    *ucx_ctx = ucx_shared_ctx;
+    pthread_mutex_unlock (&ucx_shared_lock);
+    return status;
+}
+
+/**
+ * @brief Drops a reference to the process's UCP context, cleaning it up
+ *        with the last one.
+ *
+ * @details
+ * All workers and memory mappings of the caller must already be released.
+ */
+static void ucx_context_put (void)
+{
+    pthread_mutex_lock (&ucx_shared_lock);
+    if (ucx_shared_refs > 0u && --ucx_shared_refs == 0u) {
+        ucp_cleanup (ucx_shared_ctx);
+        ucx_shared_ctx = NULL;
+    }
+    pthread_mutex_unlock (&ucx_shared_lock);
+}
+
 dyad_rc_t dyad_dtl_ucx_init (const dyad_ctx_t *ctx,
                              dyad_dtl_mode_t mode,
                              dyad_dtl_comm_mode_t comm_mode,
                              bool debug)
 {
     DYAD_C_FUNCTION_START ();
-    ucp_params_t ucx_params;
     ucp_worker_params_t worker_params;
-    ucp_config_t *config;
     ucs_status_t status;
     dyad_rc_t rc = DYAD_RC_OK;
     dyad_dtl_ucx_t *dtl_handle = NULL;
@@ -736,7 +1600,20 @@ dyad_rc_t dyad_dtl_ucx_init (const dyad_ctx_t *ctx,
     dtl_handle->ucx_worker = NULL;
     dtl_handle->mem_handle = NULL;
     dtl_handle->net_buf = NULL;
-    dtl_handle->max_transfer_size = UCX_MAX_TRANSFER_SIZE;
+    // Slots hold whole control blocks, so that every header stays aligned
+    dtl_handle->slot_size =
+        (ctx->ucx_slot_size + DYAD_UCX_HDR_SIZE - 1ul) / DYAD_UCX_HDR_SIZE * DYAD_UCX_HDR_SIZE;
+    dtl_handle->slots = (ctx->ucx_slots > DYAD_UCX_MAX_SLOTS) ? DYAD_UCX_MAX_SLOTS : ctx->ucx_slots;
+    dtl_handle->slots = (dtl_handle->slots == 0u) ? 1u : dtl_handle->slots;
+    dtl_handle->chunk_seq = 0ull;
+    dtl_handle->consumed = 0ull;
+    dtl_handle->released = 0ull;
+    dtl_handle->cons_count = 0ull;
+    memset (dtl_handle->send_hdr, 0, sizeof (dtl_handle->send_hdr));
+    memset (dtl_handle->send_req, 0, sizeof (dtl_handle->send_req));
+    memset (dtl_handle->pool_free, 0, sizeof (dtl_handle->pool_free));
+    memset (dtl_handle->pool_nfree, 0, sizeof (dtl_handle->pool_nfree));
+    dtl_handle->pool_used = NULL;
     dtl_handle->local_address = NULL;
     dtl_handle->local_addr_len = 0ul;
     dtl_handle->remote_address = NULL;
@@ -745,46 +1622,24 @@ dyad_rc_t dyad_dtl_ucx_init (const dyad_ctx_t *ctx,
     dtl_handle->comm_tag = 0ul;
     dtl_handle->ep_cache = NULL;
     dtl_handle->consumer_conn_key = 0ul;
+    dtl_handle->reg_copy = NULL;
+    dtl_handle->reg_copy_size = 0ul;
+    dtl_handle->regs = NULL;
+    dtl_handle->nregs = 0ul;
+    dtl_handle->regs_cap = 0ul;
+    dtl_handle->prod_rank = 0u;
+    dtl_handle->f = NULL;
+    dtl_handle->rpc_payload = NULL;
+    dtl_handle->retry_f = NULL;
+    dtl_handle->retried = false;
     dtl_handle->rkey_buf = NULL;
     dtl_handle->rkey_size = 0ul;
     dtl_handle->cons_buf_ptr = 0ul;
     dtl_handle->rkey = NULL;
 
-    // Read the UCX configuration
-    DYAD_LOG_INFO (ctx, "Reading UCP config\n");
-    status = ucp_config_read (NULL, NULL, &config);
-    if (UCX_STATUS_FAIL (status)) {
-        DYAD_LOG_ERROR (ctx, "Could not read the UCX config\n");
-        goto error;
-    }
-
-    // Define the settings, parameters, features, etc.
-    // for the UCX context. UCX will use this info internally
-    // when creating workers, endpoints, etc.
-    //
-    // The settings enabled are:
-    //   * Tag-matching send/recv
-    //   * Remote Memory Access communication
-    //   * Auto initialization of request objects
-    //   * Worker sleep, wakeup, poll, etc. features
-    ucx_params.field_mask = UCP_PARAM_FIELD_FEATURES | UCP_PARAM_FIELD_REQUEST_SIZE;
-    ucx_params.features = UCP_FEATURE_RMA | UCP_FEATURE_AMO32 | UCP_FEATURE_TAG;
-    ucx_params.request_size = sizeof (struct ucx_request);
-    ucx_params.request_init = dyad_ucx_request_init;
-
-    // Initialize UCX
-    DYAD_LOG_INFO (ctx, "Initializing UCP\n");
-    status = ucp_init (&ucx_params, config, &dtl_handle->ucx_ctx);
-
-    // If in debug mode, print the configuration of UCX to stderr
-    if (debug) {
-        ucp_config_print (config, stderr, "UCX Configuration", UCS_CONFIG_PRINT_CONFIG);
-    }
-    // Release the config
-    ucp_config_release (config);
-    // Log an error if UCX initialization failed
+    // Share the UCX context of the process, but not its workers
+    status = ucx_context_get (ctx, debug, &(dtl_handle->ucx_ctx));
     if (UCX_STATUS_FAIL (status)) {
-        DYAD_LOG_ERROR (ctx, "ucp_init failed (status = %d)\n", status);
         goto error;
     }
     worker_params.field_mask = UCP_WORKER_PARAM_FIELD_THREAD_MODE;
@@ -804,23 +1659,30 @@ dyad_rc_t dyad_dtl_ucx_init (const dyad_ctx_t *ctx,
                                      &(dtl_handle->local_addr_len));
 
     // Initialize endpoint cache
-    rc = dyad_ucx_ep_cache_init (ctx, &(dtl_handle->ep_cache));
+    rc = dyad_ucx_ep_cache_init (ctx, ctx->ucx_ep_cache_size, &(dtl_handle->ep_cache));
     if (DYAD_IS_ERROR (rc)) {
         DYAD_LOG_ERROR (ctx, "Cannot create endpoint cache (err code = %d)", (int)rc);
         goto error;
     }
 
-    // Allocate a buffer of max transfer size using UCX
-    ucx_allocate_buffer (ctx, dtl_handle, comm_mode);
+    // Allocate the receive ring of a consumer using UCX
+    rc = ucx_allocate_buffer (ctx, dtl_handle, comm_mode);
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (ctx, "Cannot allocate the UCX receive ring (err code = %d)", (int)rc);
+        goto error;
+    }
 
     ctx->dtl_handle->rpc_pack = dyad_dtl_ucx_rpc_pack;
     ctx->dtl_handle->rpc_unpack = dyad_dtl_ucx_rpc_unpack;
     ctx->dtl_handle->rpc_respond = dyad_dtl_ucx_rpc_respond;
     ctx->dtl_handle->rpc_recv_response = dyad_dtl_ucx_rpc_recv_response;
+    ctx->dtl_handle->rpc_register = dyad_dtl_ucx_rpc_register;
+    ctx->dtl_handle->rpc_future = dyad_dtl_ucx_rpc_future;
     ctx->dtl_handle->get_buffer = dyad_dtl_ucx_get_buffer;
     ctx->dtl_handle->return_buffer = dyad_dtl_ucx_return_buffer;
     ctx->dtl_handle->establish_connection = dyad_dtl_ucx_establish_connection;
     ctx->dtl_handle->send = dyad_dtl_ucx_send;
+    ctx->dtl_handle->send_mapped = dyad_dtl_ucx_send_mapped;
     ctx->dtl_handle->recv = dyad_dtl_ucx_recv;
     ctx->dtl_handle->close_connection = dyad_dtl_ucx_close_connection;
 
@@ -853,105 +1715,41 @@ dyad_rc_t dyad_dtl_ucx_rpc_pack (const dyad_ctx_t *ctx,
     DYAD_C_FUNCTION_UPDATE_INT ("producer_rank", producer_rank);
     DYAD_C_FUNCTION_UPDATE_INT ("pid", ctx->pid);
     dyad_dtl_ucx_t *dtl_handle = ctx->dtl_handle->private_dtl.ucx_dtl_handle;
-    /**
-     * Reset the Buffer so that we can loop on it
-     * as we expect a size_t lets put int -1 as a check.
-     */
-    ssize_t temp = 0l;
-    memcpy (dtl_handle->net_buf, &temp, sizeof (temp));
+    // Clear the ring so that the chunks of this transfer start at the first slot
+    ucx_ring_reset (dtl_handle);
     dyad_rc_t rc = DYAD_RC_OK;
-    size_t cons_enc_len = 0ul;
-    char *cons_enc_buf = NULL;
-    ssize_t cons_enc_size = 0l;
+    uint64_t key = 0ull;
+    ucx_rpc_clear (dtl_handle);
 
     if (dtl_handle->local_address == NULL) {
         DYAD_LOG_ERROR (dtl_handle, "Tried to pack an RPC payload without a local UCX address");
         rc = DYAD_RC_BADPACK;
         goto dtl_ucx_rpc_pack_region_finish;
     }
-    DYAD_LOG_INFO (ctx, "Encode UCP address using base64\n");
-    cons_enc_len = base64_encoded_length (dtl_handle->local_addr_len);
-    // Add 1 to encoded length because the encoded buffer will be
-    // packed as if it is a string
-    cons_enc_buf = malloc (cons_enc_len + 1);
-    if (cons_enc_buf == NULL) {
-        DYAD_LOG_ERROR (ctx, "Could not allocate buffer for packed address\n");
-        rc = DYAD_RC_SYSFAIL;
-        goto dtl_ucx_rpc_pack_region_finish;
-    }
-    // remote_address is casted to const char* to avoid warnings
-    // This is valid because it is a pointer to an opaque struct,
-    // so the cast can be treated like a void*->char* cast.
-    cons_enc_size = base64_encode_using_maps (&base64_maps_rfc4648,
-                                              cons_enc_buf,
-                                              cons_enc_len + 1,
-                                              (const char *)dtl_handle->local_address,
-                                              dtl_handle->local_addr_len);
-    if (cons_enc_size < 0l) {
-        DYAD_LOG_ERROR (ctx, "Unable to encode address\n");
-        // TODO log error
-        free (cons_enc_buf);
-        rc = DYAD_RC_BADPACK;
-        goto dtl_ucx_rpc_pack_region_finish;
-    }
-
-    DYAD_LOG_INFO (ctx, "Encode UCP rkey using base64\n");
-    size_t rkey_enc_len = 0ul;
-    char *rkey_enc_buf = NULL;
-    ssize_t rkey_enc_size = 0l;
-    rkey_enc_len = base64_encoded_length (dtl_handle->rkey_size);
-    // Add 1 to encoded length because the encoded buffer will be
-    // packed as if it is a string
-    rkey_enc_buf = malloc (rkey_enc_len + 1);
-    if (rkey_enc_buf == NULL) {
-        DYAD_LOG_ERROR (ctx, "Could not allocate buffer for packed rkey\n");
-        rc = DYAD_RC_SYSFAIL;
-        goto dtl_ucx_rpc_pack_region_finish;
-    }
-    // remote_address is casted to const char* to avoid warnings
-    // This is valid because it is a pointer to an opaque struct,
-    // so the cast can be treated like a void*->char* cast.
-    rkey_enc_size = base64_encode_using_maps (&base64_maps_rfc4648,
-                                              rkey_enc_buf,
-                                              rkey_enc_len + 1,
-                                              (const char *)dtl_handle->rkey_buf,
-                                              dtl_handle->rkey_size);
-    if (rkey_enc_size < 0l) {
-        DYAD_LOG_ERROR (ctx, "Unable to encode rkey\n");
-        // TODO log error
-        free (rkey_enc_buf);
-        rc = DYAD_RC_BADPACK;
-        goto dtl_ucx_rpc_pack_region_finish;
+    // The address and key of this consumer are only sent once per producer
+    key = ucx_reg_find (dtl_handle, producer_rank);
+    if (key == 0ull) {
+        rc = ucx_register (ctx, producer_rank, &key);
+        if (DYAD_IS_ERROR (rc)) {
+            goto dtl_ucx_rpc_pack_region_finish;
+        }
     }
-    char *tag_name = "cons_buf";
-    uint64_t tag_val = dtl_handle->cons_buf_ptr;
-    char tag_val_buf[128];
-    memset (tag_val_buf, 0x00, 128);
-    sprintf (tag_val_buf, "%" PRIu64, tag_val);
-    DYAD_LOG_INFO (ctx, "Creating Json object %lu with buf %s", tag_val, tag_val_buf);
-    *packed_obj = json_pack ("{s:s, s:i, s:s, s:i, s:s%, s:s%}",
+    dtl_handle->prod_rank = producer_rank;
+    *packed_obj = json_pack ("{s:s, s:i, s:I}",
                              "upath",
                              upath,
                              "tag_prod",
                              (int)producer_rank,
-                             tag_name,
-                             tag_val_buf,
-                             "pid_cons",
-                             ctx->pid,
-                             "addr",
-                             cons_enc_buf,
-                             cons_enc_len,
-                             "rkey",
-                             rkey_enc_buf,
-                             rkey_enc_len);
-    free (cons_enc_buf);
-    free (rkey_enc_buf);
+                             "key",
+                             (json_int_t)key);
     // If the packing failed, log an error
     if (*packed_obj == NULL) {
-        DYAD_LOG_ERROR (ctx, "Could not pack upath and UCX address for RPC\n");
+        DYAD_LOG_ERROR (ctx, "Could not pack upath and UCX consumer key for RPC\n");
         rc = DYAD_RC_BADPACK;
         goto dtl_ucx_rpc_pack_region_finish;
     }
+    // Keep the request, which the caller completes, to send it again if needed
+    dtl_handle->rpc_payload = json_incref (*packed_obj);
     rc = DYAD_RC_OK;
 dtl_ucx_rpc_pack_region_finish:;
     DYAD_C_FUNCTION_END ();
@@ -962,111 +1760,85 @@ dyad_rc_t dyad_dtl_ucx_rpc_unpack (const dyad_ctx_t *ctx, const flux_msg_t *msg,
 {
     DYAD_C_FUNCTION_START ();
     dyad_rc_t rc = DYAD_RC_OK;
-    char *enc_addr = NULL;
-    size_t enc_addr_len = 0;
-    char *enc_rkey = NULL;
-    size_t enc_rkey_len = 0;
     int errcode = 0;
-    uint64_t tag_prod = 0;
-    uint64_t tag_cons = 0;
-    uint64_t pid = 0;
-    ssize_t decoded_len = 0;
+    int tag_prod = 0;
+    json_int_t key = 0;
+    const ucx_reg_hdr_t *reg = NULL;
     dyad_dtl_ucx_t *dtl_handle = ctx->dtl_handle->private_dtl.ucx_dtl_handle;
     DYAD_LOG_INFO (ctx, "Unpacking RPC payload\n");
-    uint64_t tag_val;
-    char *tag_name = "cons_buf";
-    char *tag_value_str = NULL;
     errcode = flux_request_unpack (msg,
                                    NULL,
-                                   "{s:s, s:i, s:s, s:i, s:s%, s:s%}",
+                                   "{s:s, s:i, s:I}",
                                    "upath",
                                    upath,
                                    "tag_prod",
                                    &tag_prod,
-                                   tag_name,
-                                   &tag_value_str,
-                                   "pid_cons",
-                                   &pid,
-                                   "addr",
-                                   &enc_addr,
-                                   &enc_addr_len,
-                                   "rkey",
-                                   &enc_rkey,
-                                   &enc_rkey_len);
-    tag_val = atoll (tag_value_str);
-    DYAD_LOG_INFO (ctx, "Reading Json object %lu", tag_val);
+                                   "key",
+                                   &key);
     if (errcode < 0) {
         DYAD_LOG_ERROR (ctx, "Could not unpack Flux message from consumer!\n");
         rc = DYAD_RC_BADUNPACK;
         goto dtl_ucx_rpc_unpack_region_finish;
     }
-    dtl_handle->cons_buf_ptr = tag_val;
-    DYAD_C_FUNCTION_UPDATE_INT ("pid", pid);
-    DYAD_C_FUNCTION_UPDATE_INT ("tag_cons", tag_cons);
-    dtl_handle->comm_tag = tag_prod << 32 | tag_cons;
-    dtl_handle->consumer_conn_key = pid << 32 | tag_cons;
+    rc = dyad_ucx_consumer_find (ctx,
+                                 (uint64_t)key,
+                                 &(dtl_handle->reg_copy),
+                                 &(dtl_handle->reg_copy_size));
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (ctx, "No UCX consumer is registered as %lld", (long long)key);
+        goto dtl_ucx_rpc_unpack_region_finish;
+    }
+    // Point into this handle's copy of the registration, which stays
+    // valid even if the registry drops it during the transfer
+    reg = (const ucx_reg_hdr_t *)dtl_handle->reg_copy;
+    dtl_handle->cons_buf_ptr = reg->cons_buf;
+    dtl_handle->slots = reg->slots;
+    dtl_handle->slot_size = (size_t)reg->slot_size;
+    dtl_handle->chunk_seq = 0ull;
+    dtl_handle->consumed = 0ull;
+    dtl_handle->remote_address = (ucp_address_t *)((const char *)reg + sizeof (ucx_reg_hdr_t));
+    dtl_handle->remote_addr_len = reg->addr_len;
+    dtl_handle->rkey_buf = (void *)((const char *)reg + sizeof (ucx_reg_hdr_t) + reg->addr_len);
+    dtl_handle->rkey_size = reg->rkey_len;
+    dtl_handle->comm_tag = (uint64_t)tag_prod << 32;
+    dtl_handle->consumer_conn_key = (uint64_t)key;
     DYAD_C_FUNCTION_UPDATE_INT ("cons_key", dtl_handle->consumer_conn_key);
     DYAD_LOG_INFO (ctx, "Obtained upath from RPC payload: %s\n", *upath);
     DYAD_LOG_INFO (ctx, "Obtained UCP tag from RPC payload: %lu\n", dtl_handle->comm_tag);
-    DYAD_LOG_INFO (ctx, "Decoding consumer UCP address using base64\n");
-    dtl_handle->remote_addr_len = base64_decoded_length (enc_addr_len);
-    dtl_handle->remote_address = (ucp_address_t *)malloc (dtl_handle->remote_addr_len);
-    if (dtl_handle->remote_address == NULL) {
-        DYAD_LOG_ERROR (ctx, "Could not allocate memory for consumer address");
-        rc = DYAD_RC_SYSFAIL;
-        goto dtl_ucx_rpc_unpack_region_finish;
-    }
-    decoded_len = base64_decode_using_maps (&base64_maps_rfc4648,
-                                            (char *)dtl_handle->remote_address,
-                                            dtl_handle->remote_addr_len,
-                                            enc_addr,
-                                            enc_addr_len);
-    if (decoded_len < 0) {
-        DYAD_LOG_ERROR (dtl_handle, "Failed to decode remote address");
-        free (dtl_handle->remote_address);
-        dtl_handle->remote_address = NULL;
-        dtl_handle->remote_addr_len = 0;
-        rc = DYAD_RC_BAD_B64DECODE;
-        goto dtl_ucx_rpc_unpack_region_finish;
-    }
-
-    DYAD_LOG_INFO (ctx, "Decoding consumer UCP rkey using base64\n");
-    dtl_handle->rkey_size = base64_decoded_length (enc_rkey_len);
-
-    /* Guard against a previous RPC where dyad_dtl_ucx_close_connection()
-     * was skipped on an error path, which would leave rkey_buf non-NULL. */
-    if (dtl_handle->rkey_buf != NULL) {
-        free (dtl_handle->rkey_buf);
-        // dtl_handle->rkey_buf = NULL;
-    }
+    rc = DYAD_RC_OK;
+dtl_ucx_rpc_unpack_region_finish:;
+    DYAD_C_FUNCTION_END ();
+    return rc;
+}
 
-    /* rkey_buf here is a plain malloc() allocation holding the consumer's
-     * packed key decoded from the RPC payload, distinct from the consumer's
-     * own UCX-allocated rkey_buf produced by ucp_rkey_pack(). It must be
-     * freed with free() in dyad_dtl_ucx_close_connection(), not with
-     * ucp_rkey_buffer_release(). */
-    dtl_handle->rkey_buf = malloc (dtl_handle->rkey_size);
+dyad_rc_t dyad_dtl_ucx_rpc_register (const dyad_ctx_t *ctx, const flux_msg_t *msg, uint64_t *key)
+{
+    DYAD_C_FUNCTION_START ();
+    dyad_rc_t rc = DYAD_RC_OK;
+    const ucx_reg_hdr_t *reg = NULL;
+    const void *data = NULL;
+    size_t len = 0ul;
 
-    if (dtl_handle->rkey_buf == NULL) {
-        DYAD_LOG_ERROR (ctx, "Could not allocate memory for consumer rkey");
-        rc = DYAD_RC_SYSFAIL;
-        goto dtl_ucx_rpc_unpack_region_finish;
+    if (flux_request_decode_raw (msg, NULL, &data, &len) < 0 || len < sizeof (ucx_reg_hdr_t)) {
+        DYAD_LOG_ERROR (ctx, "Could not decode UCX consumer registration");
+        rc = DYAD_RC_BADUNPACK;
+        goto dtl_ucx_rpc_register_done;
     }
-    decoded_len = base64_decode_using_maps (&base64_maps_rfc4648,
-                                            (char *)dtl_handle->rkey_buf,
-                                            dtl_handle->rkey_size,
-                                            enc_rkey,
-                                            enc_rkey_len);
-    if (decoded_len < 0) {
-        DYAD_LOG_ERROR (dtl_handle, "Failed to decode remote rkey");
-        free (dtl_handle->rkey_buf);
-        dtl_handle->rkey_buf = NULL;
-        dtl_handle->rkey_size = 0;
-        rc = DYAD_RC_BAD_B64DECODE;
-        goto dtl_ucx_rpc_unpack_region_finish;
+    reg = (const ucx_reg_hdr_t *)data;
+    if (reg->version != DYAD_UCX_REG_VERSION
+        || len != sizeof (ucx_reg_hdr_t) + (size_t)reg->addr_len + (size_t)reg->rkey_len
+        || reg->addr_len == 0u || reg->rkey_len == 0u || reg->slots < 1u
+        || reg->slots > DYAD_UCX_MAX_SLOTS || reg->slot_size == 0ull
+        || reg->slot_size % DYAD_UCX_HDR_SIZE != 0ull) {
+        DYAD_LOG_ERROR (ctx,
+                        "Invalid UCX consumer registration of %zu bytes (version %u)",
+                        len,
+                        reg->version);
+        rc = DYAD_RC_BADUNPACK;
+        goto dtl_ucx_rpc_register_done;
     }
-    rc = DYAD_RC_OK;
-dtl_ucx_rpc_unpack_region_finish:;
+    rc = dyad_ucx_consumer_register (ctx, reg, len, key);
+dtl_ucx_rpc_register_done:;
     DYAD_C_FUNCTION_END ();
     return rc;
 }
@@ -1081,15 +1853,34 @@ dyad_rc_t dyad_dtl_ucx_rpc_respond (const dyad_ctx_t *ctx, const flux_msg_t *ori
 dyad_rc_t dyad_dtl_ucx_rpc_recv_response (const dyad_ctx_t *ctx, flux_future_t *f)
 {
     DYAD_C_FUNCTION_START ();
+    ctx->dtl_handle->private_dtl.ucx_dtl_handle->f = f;
     DYAD_C_FUNCTION_END ();
     return DYAD_RC_OK;
 }
 
+flux_future_t *dyad_dtl_ucx_rpc_future (const dyad_ctx_t *ctx, flux_future_t *f)
+{
+    DYAD_C_FUNCTION_START ();
+    dyad_dtl_ucx_t *dtl_handle = ctx->dtl_handle->private_dtl.ucx_dtl_handle;
+    if (!dtl_handle->retried && f != NULL && flux_future_wait_for (f, 0.0) == 0
+        && flux_rpc_get (f, NULL) < 0 && errno == ESTALE) {
+        ucx_rpc_retry (ctx);
+    }
+    if (dtl_handle->retry_f != NULL) {
+        flux_future_destroy (f);
+        f = dtl_handle->retry_f;
+        dtl_handle->retry_f = NULL;
+    }
+    DYAD_C_FUNCTION_END ();
+    return f;
+}
+
 dyad_rc_t dyad_dtl_ucx_get_buffer (const dyad_ctx_t *ctx, size_t data_size, void **data_buf)
 {
     DYAD_C_FUNCTION_START ();
     dyad_rc_t rc = DYAD_RC_OK;
     dyad_dtl_ucx_t *dtl_handle = ctx->dtl_handle->private_dtl.ucx_dtl_handle;
+    ucx_pool_buf_t *pbuf = NULL;
     DYAD_LOG_INFO (dtl_handle, "Validating data_buf in get_buffer");
     // TODO(Ian): the second part of this check is (for some reason) evaluating
     //            to true despite `data_buf` being a pointer to a NULL pointer.
@@ -1102,15 +1893,13 @@ dyad_rc_t dyad_dtl_ucx_get_buffer (const dyad_ctx_t *ctx, size_t data_size, void
     //     rc = DYAD_RC_BADBUF;
     //     goto ucx_get_buffer_done;
     // }
-    DYAD_LOG_INFO (dtl_handle, "Validating data_size in get_buffer");
-    if (data_size > ctx->dtl_handle->private_dtl.ucx_dtl_handle->max_transfer_size) {
-        DYAD_LOG_ERROR (dtl_handle,
-                        "Requested a data size that's larger than the pre-allocated UCX buffer");
-        rc = DYAD_RC_BADBUF;
+    DYAD_LOG_INFO (dtl_handle, "Taking a registered buffer from the UCX buffer pool");
+    rc = ucx_pool_get (ctx, dtl_handle, data_size, &pbuf);
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (dtl_handle, "Cannot get a UCX buffer of %zu bytes", data_size);
         goto ucx_get_buffer_done;
     }
-    DYAD_LOG_INFO (dtl_handle, "Setting the data buffer pointer to the UCX-allocated buffer");
-    *data_buf = dtl_handle->net_buf;
+    *data_buf = pbuf->addr;
     rc = DYAD_RC_OK;
 
 ucx_get_buffer_done:;
@@ -1122,10 +1911,28 @@ dyad_rc_t dyad_dtl_ucx_return_buffer (const dyad_ctx_t *ctx, void **data_buf)
 {
     DYAD_C_FUNCTION_START ();
     dyad_rc_t rc = DYAD_RC_OK;
+    dyad_dtl_ucx_t *dtl_handle = ctx->dtl_handle->private_dtl.ucx_dtl_handle;
+    const char *ring = (const char *)dtl_handle->net_buf;
+    ucx_pool_buf_t *pbuf = NULL;
     if (data_buf == NULL || *data_buf == NULL) {
         rc = DYAD_RC_BADBUF;
         goto dtl_ucx_return_buffer_done;
     }
+    if (ring != NULL && (const char *)*data_buf >= ring + DYAD_UCX_HDR_SIZE
+        && (const char *)*data_buf < ring + ucx_slot_offset (dtl_handle, dtl_handle->slots)) {
+        // A message received in a single slot of the ring
+        ucx_ring_release (dtl_handle,
+                          (unsigned)(((const char *)*data_buf - ring - DYAD_UCX_HDR_SIZE)
+                                     / (DYAD_UCX_HDR_SIZE + dtl_handle->slot_size)));
+    } else {
+        pbuf = ucx_pool_find (dtl_handle, *data_buf);
+        if (pbuf == NULL) {
+            DYAD_LOG_ERROR (ctx, "Returned a buffer that was not taken from UCX");
+            rc = DYAD_RC_BADBUF;
+            goto dtl_ucx_return_buffer_done;
+        }
+        ucx_pool_release (ctx, dtl_handle, pbuf);
+    }
     *data_buf = NULL;
 dtl_ucx_return_buffer_done:;
     DYAD_C_FUNCTION_END ();
@@ -1178,14 +1985,12 @@ dyad_rc_t dyad_dtl_ucx_send (const dyad_ctx_t *ctx, void *buf, size_t buflen)
 {
     DYAD_C_FUNCTION_START ();
     dyad_rc_t rc = DYAD_RC_OK;
-    ucs_status_ptr_t stat_ptr;
-    ucs_status_t status = UCS_OK;
-    stat_ptr = ucx_send_no_wait (ctx, false, buf, buflen);
+    dyad_dtl_ucx_t *dtl_handle = ctx->dtl_handle->private_dtl.ucx_dtl_handle;
+    // Buffers of the pool are already registered, so UCX need not look them up
+    ucx_pool_buf_t *pbuf = ucx_pool_find (dtl_handle, buf);
     DYAD_LOG_INFO (ctx, "Processing UCP send request\n");
-    status = dyad_ucx_request_wait (ctx, stat_ptr);
-    if (status != UCS_OK) {
-        DYAD_LOG_ERROR (ctx, "UCP Put failed (status = %d)!\n", (int)status);
-        rc = DYAD_RC_UCXCOMM_FAIL;
+    rc = ucx_send_msg (ctx, buf, buflen, (pbuf != NULL) ? pbuf->memh : NULL, NULL);
+    if (DYAD_IS_ERROR (rc)) {
         goto dtl_ucx_send_region_finish;
     }
     DYAD_LOG_INFO (ctx, "Data send with UCP succeeded\n");
@@ -1195,20 +2000,118 @@ dtl_ucx_send_region_finish:;
     return rc;
 }
 
+dyad_rc_t dyad_dtl_ucx_send_mapped (const dyad_ctx_t *ctx, void *buf, size_t buflen)
+{
+    DYAD_C_FUNCTION_START ();
+    dyad_rc_t rc = DYAD_RC_OK;
+    dyad_dtl_ucx_t *dtl_handle = ctx->dtl_handle->private_dtl.ucx_dtl_handle;
+    ucp_mem_map_params_t mmap_params;
+    ucp_mem_h memh = NULL;
+    ucs_status_t status = UCS_OK;
+    ucx_pool_buf_t *staging = NULL;
+
+    mmap_params.field_mask = UCP_MEM_MAP_PARAM_FIELD_ADDRESS | UCP_MEM_MAP_PARAM_FIELD_LENGTH
+                             | UCP_MEM_MAP_PARAM_FIELD_PROT;
+    mmap_params.address = buf;
+    mmap_params.length = buflen;
+    mmap_params.prot = UCP_MEM_MAP_PROT_LOCAL_READ;
+    status = ucp_mem_map (dtl_handle->ucx_ctx, &mmap_params, &memh);
+    if (UCX_STATUS_FAIL (status)) {
+        // Some transports cannot register file-backed pages. Fall back to
+        // staging the data through a registered buffer of the pool, one
+        // chunk at a time.
+        DYAD_LOG_DEBUG (ctx,
+                        "Cannot register mapped data with UCX (%s), copying it instead",
+                        ucs_status_string (status));
+        rc = ucx_pool_get (ctx, dtl_handle, dtl_handle->slot_size, &staging);
+        if (DYAD_IS_ERROR (rc)) {
+            goto dtl_ucx_send_mapped_region_finish;
+        }
+        rc = ucx_send_msg (ctx, buf, buflen, NULL, staging);
+        ucx_pool_release (ctx, dtl_handle, staging);
+        goto dtl_ucx_send_mapped_region_finish;
+    }
+
+    DYAD_LOG_INFO (ctx, "Processing UCP send requests for mapped data\n");
+    // ucx_send_msg waits for all puts, so memh can be released right after
+    rc = ucx_send_msg (ctx, buf, buflen, memh, NULL);
+    if (!DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_INFO (ctx, "Mapped data send with UCP succeeded\n");
+    }
+    ucp_mem_unmap (dtl_handle->ucx_ctx, memh);
+dtl_ucx_send_mapped_region_finish:;
+    DYAD_C_FUNCTION_END ();
+    return rc;
+}
+
 dyad_rc_t dyad_dtl_ucx_recv (const dyad_ctx_t *ctx, void **buf, size_t *buflen)
 {
     DYAD_C_FUNCTION_START ();
     dyad_rc_t rc = DYAD_RC_OK;
+    dyad_dtl_ucx_t *dtl_handle = ctx->dtl_handle->private_dtl.ucx_dtl_handle;
+    ucx_slot_hdr_t *hdr = NULL;
+    ucx_pool_buf_t *pbuf = NULL;
+    unsigned slot = 0u;
+    size_t msg_len = 0ul;
+    size_t received = 0ul;
 
-    ucs_status_ptr_t stat_ptr = NULL;
-    // Wait on the recv operation to complete
-    stat_ptr = ucx_recv_no_wait (ctx, false, buf, buflen);
-    (void)stat_ptr;
+    *buf = NULL;
+    *buflen = 0ul;
+    // Wait on the first chunk of the message to land in the ring
+    slot = (unsigned)(dtl_handle->chunk_seq % dtl_handle->slots);
+    hdr = ucx_recv_chunk (ctx);
+    if (hdr == NULL) {
+        rc = DYAD_RC_BADRPC;
+        goto dtl_ucx_recv_region_finish;
+    }
+    msg_len = hdr->msg_len;
+    if (hdr->len == msg_len) {
+        // The whole message is in the slot, which is handed to the caller
+        // until dyad_dtl_ucx_return_buffer()
+        dtl_handle->chunk_seq++;
+        *buf = (char *)hdr + DYAD_UCX_HDR_SIZE;
+        *buflen = msg_len;
+        goto dtl_ucx_recv_region_finish;
+    }
+    // Reassemble a larger message, releasing each slot once it is copied.
+    // If no buffer can be had, the chunks are still drained, so that the
+    // producer does not wait for slots forever.
+    rc = ucx_pool_get (ctx, dtl_handle, msg_len, &pbuf);
+    for (;;) {
+        if (hdr->offset > msg_len || hdr->len > msg_len - hdr->offset) {
+            DYAD_LOG_ERROR (ctx, "Received a chunk past the end of its message");
+            rc = DYAD_RC_UCXCOMM_FAIL;
+            break;
+        }
+        if (pbuf != NULL) {
+            memcpy ((char *)pbuf->addr + hdr->offset, (char *)hdr + DYAD_UCX_HDR_SIZE, hdr->len);
+        }
+        received += hdr->len;
+        dtl_handle->chunk_seq++;
+        ucx_ring_release (dtl_handle, slot);
+        if (received >= msg_len) {
+            break;
+        }
+        slot = (unsigned)(dtl_handle->chunk_seq % dtl_handle->slots);
+        hdr = ucx_recv_chunk (ctx);
+        if (hdr == NULL) {
+            rc = DYAD_RC_BADRPC;
+            break;
+        }
+    }
+    if (DYAD_IS_ERROR (rc)) {
+        if (pbuf != NULL) {
+            ucx_pool_release (ctx, dtl_handle, pbuf);
+        }
+        goto dtl_ucx_recv_region_finish;
+    }
+    *buf = pbuf->addr;
+    *buflen = msg_len;
 
     DYAD_LOG_INFO (ctx, "Data receive using UCX is successful\n");
     DYAD_LOG_INFO (ctx, "Received %lu bytes from producer\n", *buflen);
-
     rc = DYAD_RC_OK;
+dtl_ucx_recv_region_finish:;
     DYAD_C_FUNCTION_END ();
     return rc;
 }
@@ -1221,38 +2124,22 @@ dyad_rc_t dyad_dtl_ucx_close_connection (const dyad_ctx_t *ctx)
     dyad_dtl_comm_mode_t comm_mode = dtl_handle->comm_mode;
     if (comm_mode == DYAD_COMM_SEND) {
         if (dtl_handle != NULL) {
-            // TODO replace this code (either here or elsewhere) with LRU eviction
-            // rc = ucx_disconnect (ctx, dtl_handle->ucx_worker, dtl_handle->ep);
-            // if (DYAD_IS_ERROR (rc)) {
-            //     DYAD_LOG_ERROR (ctx,
-            //                   "Could not successfully close Endpoint! However, endpoint was "
-            //                   "released.");
-            // }
             /* Destroy the unpacked rkey handle. Only the producer (DYAD_COMM_SEND)
-             * creates rkey via ucp_ep_rkey_unpack() in ucx_send_no_wait(). */
+             * creates rkey via ucp_ep_rkey_unpack() in ucx_send_msg(). */
             if (dtl_handle->rkey != NULL) {
                 ucp_rkey_destroy (dtl_handle->rkey);
                 dtl_handle->rkey = NULL;
             }
-            /* Free the per-RPC malloc() allocation of producer's rkey_buf from
-             * dyad_dtl_ucx_rpc_unpack().
-             * The consumer's rkey_buf is UCX-allocated and freed in finalize(). */
-            if (dtl_handle->rkey_buf != NULL) {
-                free (dtl_handle->rkey_buf);
-                dtl_handle->rkey_buf = NULL;
-            }
+            /* The producer's rkey_buf and remote_address point into the
+             * registration of the consumer, which the ep_cache keeps. */
+            dtl_handle->rkey_buf = NULL;
+            dtl_handle->rkey_size = 0ul;
             /* ep is intentionally not destroyed here — it remains alive in
-             * ep_cache for reuse across RPCs and is destroyed in finalize(). */
+             * ep_cache for reuse across RPCs until the cache evicts it or
+             * is destroyed in finalize(). */
             dtl_handle->ep = NULL;
-            // Sender doesn't have a consumer address at this time
-            // So, free the consumer address when closing the connection
-            // NOTE: currently removing the deallocation of the remote address
-            //       because it is still in use by the endpoint cache
-            // if (dtl_handle->remote_address != NULL) {
-            //     free (dtl_handle->remote_address);
             dtl_handle->remote_address = NULL;
             dtl_handle->remote_addr_len = 0;
-            // }
             dtl_handle->comm_tag = 0;
         }
         DYAD_LOG_INFO (ctx, "UCP endpoint close successful\n");
@@ -1262,8 +2149,10 @@ dyad_rc_t dyad_dtl_ucx_close_connection (const dyad_ctx_t *ctx)
         // to explicitly close the connection. So, all we're
         // doing here is setting the tag back to 0 (which cannot
         // be valid for DYAD because DYAD won't send a file from
-        // one node to the same node).
+        // one node to the same node). The RPC is destroyed by the caller,
+        // once handed over by dyad_dtl_ucx_rpc_future() if it was sent again.
         dtl_handle->comm_tag = 0;
+        dtl_handle->f = NULL;
         rc = DYAD_RC_OK;
     } else {
         DYAD_LOG_ERROR (ctx, "Somehow, an invalid comm mode reached 'close_connection'\n");
@@ -1278,6 +2167,7 @@ dyad_rc_t dyad_dtl_ucx_finalize (const dyad_ctx_t *ctx)
 {
     DYAD_C_FUNCTION_START ();
     dyad_dtl_ucx_t *dtl_handle = NULL;
+    dyad_ucx_ep_cache_stats_t ep_stats;
     dyad_rc_t rc = DYAD_RC_OK;
     if (ctx->dtl_handle == NULL || ctx->dtl_handle->private_dtl.ucx_dtl_handle == NULL) {
         rc = DYAD_RC_OK;
@@ -1293,6 +2183,16 @@ dyad_rc_t dyad_dtl_ucx_finalize (const dyad_ctx_t *ctx)
      * bound to it. Actual connection teardown happens here, not in
      * close_connection(). */
     if (dtl_handle->ep_cache != NULL) {
+        dyad_ucx_ep_cache_stats (dtl_handle->ep_cache, &ep_stats);
+        DYAD_LOG_INFO (ctx,
+                       "UCX endpoint cache: %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64
+                       " evictions, %zu endpoints, %zu consumers (%" PRIu64 " dropped)",
+                       ep_stats.hits,
+                       ep_stats.misses,
+                       ep_stats.evictions,
+                       ep_stats.entries,
+                       ep_stats.consumers,
+                       ep_stats.dropped);
         dyad_ucx_ep_cache_finalize (ctx, &(dtl_handle->ep_cache), dtl_handle->ucx_worker);
         dtl_handle->ep_cache = NULL;
     }
@@ -1302,26 +2202,27 @@ dyad_rc_t dyad_dtl_ucx_finalize (const dyad_ctx_t *ctx)
         ucp_worker_release_address (dtl_handle->ucx_worker, dtl_handle->local_address);
         dtl_handle->local_address = NULL;
     }
-    // Free remote adddress structure if not already freed
-    if (dtl_handle->remote_address != NULL) {
-        free (dtl_handle->remote_address);
-        dtl_handle->remote_address = NULL;
-    }
-    /* rkey_buf deallocation differs by comm_mode:
-     * - DYAD_COMM_SEND: plain malloc() from rpc_unpack() ->free()
-     * - DYAD_COMM_RECV: UCX-allocated by ucp_rkey_pack() -> ucp_rkey_buffer_release() */
-    if (dtl_handle->rkey_buf != NULL) {
-        if (dtl_handle->comm_mode == DYAD_COMM_SEND)
-            free (dtl_handle->rkey_buf);
-        else
-            ucp_rkey_buffer_release (dtl_handle->rkey_buf);
-        dtl_handle->rkey_buf = NULL;
+    /* On the producer, remote_address and rkey_buf point into reg_copy.
+     * On the consumer, rkey_buf is
+     * UCX-allocated by ucp_rkey_pack() -> ucp_rkey_buffer_release(). */
+    dtl_handle->remote_address = NULL;
+    if (dtl_handle->rkey_buf != NULL && dtl_handle->comm_mode == DYAD_COMM_RECV) {
+        ucp_rkey_buffer_release (dtl_handle->rkey_buf);
     }
+    dtl_handle->rkey_buf = NULL;
+    free (dtl_handle->reg_copy);
+    dtl_handle->reg_copy = NULL;
+    dtl_handle->reg_copy_size = 0ul;
+    free (dtl_handle->regs);
+    dtl_handle->regs = NULL;
+    dtl_handle->nregs = 0ul;
+    ucx_rpc_clear (dtl_handle);
     if (dtl_handle->rkey != NULL) {
         ucp_rkey_destroy (dtl_handle->rkey);
         dtl_handle->rkey = NULL;
     }
-    // Free memory buffer if not already freed
+    // Release the registered buffer pool and the receive ring
+    ucx_pool_destroy (ctx, dtl_handle);
     if (dtl_handle->mem_handle != NULL) {
         ucx_free_buffer (ctx, dtl_handle->ucx_ctx, dtl_handle->mem_handle, &(dtl_handle->net_buf));
         dtl_handle->mem_handle = NULL;
@@ -1331,10 +2232,10 @@ dyad_rc_t dyad_dtl_ucx_finalize (const dyad_ctx_t *ctx)
         ucp_worker_destroy (dtl_handle->ucx_worker);
         dtl_handle->ucx_worker = NULL;
     }
-    /* UCX context destroyed last — all resources bound to it must
-     * already be released. */
+    /* UCX context released last — all resources of this handle bound to
+     * it must already be released. It is cleaned up with the last handle. */
     if (dtl_handle->ucx_ctx != NULL) {
-        ucp_cleanup (dtl_handle->ucx_ctx);
+        ucx_context_put ();
         dtl_handle->ucx_ctx = NULL;
     }
 
@@ -13,40 +13,149 @@
 #include <dyad/dtl/dyad_dtl_api.h>
 #include <dyad/dtl/ucx_ep_cache.h>
 
+/**
+ * @brief Largest number of slots of the receive ring of a consumer.
+ */
+#define DYAD_UCX_MAX_SLOTS 64u
+
+/**
+ * @brief Bytes reserved for the control words at the start of the receive
+ *        ring and of each of its slots, one cache line each.
+ */
+#define DYAD_UCX_HDR_SIZE 64ul
+
+/**
+ * @brief Size of the smallest class of the registered buffer pool.
+ */
+#define DYAD_UCX_POOL_MIN_CLASS (64ul * 1024ul)
+
+/**
+ * @brief Number of size classes of the registered buffer pool. Each class
+ *        holds buffers 4 times larger than the previous one, i.e., up to
+ *        256 MiB. Larger buffers are registered on demand.
+ */
+#define DYAD_UCX_POOL_CLASSES 7u
+
+/**
+ * @brief Number of free buffers kept registered in each size class.
+ */
+#define DYAD_UCX_POOL_KEEP 4u
+
+/**
+ * @brief Control words of a slot of the receive ring, followed by its data.
+ *
+ * @details
+ * The producer puts the data and the lengths first, and @c seq after a
+ * fence, so that the consumer polling on @c seq sees the whole chunk.
+ */
+typedef struct ucx_slot_hdr {
+    uint64_t seq;      ///< 1 + sequence number of the chunk in the slot, or 0.
+    uint64_t len;      ///< Number of bytes of the chunk.
+    uint64_t msg_len;  ///< Number of bytes of the message the chunk belongs to.
+    uint64_t offset;   ///< Offset of the chunk in its message.
+} ucx_slot_hdr_t;
+
+/**
+ * @brief A buffer of the registered buffer pool.
+ */
+typedef struct ucx_pool_buf {
+    struct ucx_pool_buf *next;  ///< Next buffer of the free or used list.
+    void *addr;                 ///< Start of the buffer.
+    size_t size;                ///< Size of the buffer in bytes.
+    ucp_mem_h memh;             ///< Registration of the buffer.
+    int cls;                    ///< Size class, or -1 if larger than all classes.
+} ucx_pool_buf_t;
+
+/**
+ * @brief Version of @c ucx_reg_hdr_t, checked by the producer.
+ */
+#define DYAD_UCX_REG_VERSION 1u
+
+/**
+ * @brief Header of the raw payload of a @c DYAD_DTL_REGISTER_RPC_NAME
+ *        request, followed by the UCP worker address of the consumer and
+ *        the packed key of its receive ring.
+ *
+ * @details
+ * Consumers and producers of a job are expected to share the byte order.
+ */
+typedef struct ucx_reg_hdr {
+    uint32_t version;    ///< @c DYAD_UCX_REG_VERSION.
+    uint32_t slots;      ///< Number of slots of the receive ring.
+    uint64_t slot_size;  ///< Bytes of data per slot of the receive ring.
+    uint64_t cons_buf;   ///< Address of the receive ring.
+    uint32_t addr_len;   ///< Bytes of the worker address.
+    uint32_t rkey_len;   ///< Bytes of the packed key.
+} ucx_reg_hdr_t;
+
+/**
+ * @brief A producer a consumer registered with.
+ */
+typedef struct ucx_reg {
+    uint32_t rank;  ///< Broker rank of the producer.
+    uint64_t key;   ///< Key under which the producer knows the consumer.
+} ucx_reg_t;
+
 struct dyad_dtl_ucx {
     flux_t *h;                       ///< Non-owning Flux handle, borrowed from @c ctx->h.
     dyad_dtl_comm_mode_t comm_mode;  ///< Communication direction. @see dyad_dtl_comm_mode_t.
     bool debug;                      ///< If @c true, enables verbose UCX debug logging.
 
-    ucp_context_h ucx_ctx;  ///< UCX context. Initialized by @c ucp_init().
+    ucp_context_h ucx_ctx;  ///< UCX context, shared by all handles of the process.
     /**
      * UCX worker. Created with @c UCS_THREAD_MODE_SERIALIZED — all UCX
      * calls must be made from a single thread at a time.
      */
     ucp_worker_h ucx_worker;
-    ucp_mem_h mem_handle;  ///< UCX memory handle for the pre-allocated RDMA buffer.
+    ucp_mem_h mem_handle;  ///< Registration of the receive ring. Consumer side only.
     /**
-     * Pointer to the UCX-allocated RDMA buffer. Size is
-     * @c max_transfer_size + @c sizeof(size_t). The extra @c sizeof(size_t)
-     * bytes hold the file size sentinel prepended by the producer so the
-     * consumer can detect when the RDMA push has started.
+     * Receive ring of the consumer, into which producers put the data.
+     * Starts with the count of chunks released by the consumer, read by
+     * the producer for flow control, followed by @c slots slots of
+     * @c DYAD_UCX_HDR_SIZE bytes of @c ucx_slot_hdr_t and @c slot_size
+     * bytes of data. @c NULL on the producer side.
      */
     void *net_buf;
-    size_t max_transfer_size;  ///< Maximum transfer size in bytes (@c UCX_MAX_TRANSFER_SIZE).
+    /**
+     * Bytes of data per slot of the receive ring, a multiple of
+     * @c DYAD_UCX_HDR_SIZE. On the producer side, that of the consumer
+     * being served, from the RPC payload.
+     */
+    size_t slot_size;
+    unsigned slots;       ///< Number of slots of the receive ring.
+    uint64_t chunk_seq;   ///< Chunks received or put during the current transfer.
+    /**
+     * Chunks released by the consumer during the current transfer. On the
+     * producer side, the last count read from the consumer.
+     */
+    uint64_t consumed;
+    uint64_t released;    ///< Slots returned by the consumer ahead of older ones.
+    uint64_t cons_count;  ///< Destination of the get of the consumer's count.
+    /**
+     * Control words put into each slot of the consumer, which must stay
+     * valid until their put completes. Producer side only.
+     */
+    ucx_slot_hdr_t send_hdr[DYAD_UCX_MAX_SLOTS];
+    /**
+     * Puts in flight into each slot of the consumer: the data, the lengths
+     * and the sequence number. Producer side only.
+     */
+    ucs_status_ptr_t send_req[DYAD_UCX_MAX_SLOTS][3];
+    ucx_pool_buf_t *pool_free[DYAD_UCX_POOL_CLASSES];  ///< Free buffers of each class.
+    unsigned pool_nfree[DYAD_UCX_POOL_CLASSES];        ///< Length of each free list.
+    ucx_pool_buf_t *pool_used;  ///< Buffers handed out by @c dyad_dtl_ucx_get_buffer().
 
     /**
-     * This worker's UCX address. Sent to the remote peer via the Flux RPC
-     * payload (base64-encoded) during @c dyad_dtl_ucx_rpc_pack() so the
+     * This worker's UCX address. Sent to each producer once, when the
+     * consumer registers with it in @c dyad_dtl_ucx_rpc_pack(), so the
      * producer can create an endpoint back to the consumer.
      * Released via @c ucp_worker_release_address() during finalization.
      */
     ucp_address_t *local_address;
     size_t local_addr_len;  ///< Length of @c local_address in bytes.
     /**
-     * Decoded UCX address of the remote peer. Producer side only — decoded
-     * from base64 in @c dyad_dtl_ucx_rpc_unpack() and allocated via
-     * @c malloc(). Released via @c free() during finalization. Not used
-     * on the consumer side.
+     * UCX address of the consumer being served. Producer side only — points
+     * into @c reg_copy, set in @c dyad_dtl_ucx_rpc_unpack(). Not owned.
      */
     ucp_address_t *remote_address;
     size_t remote_addr_len;  ///< Length of @c remote_address in bytes.
@@ -59,36 +168,68 @@ struct dyad_dtl_ucx {
     ucp_tag_t comm_tag;  ///< Communication tag: @c tag_prod << 32 | @c tag_cons.
                          ///<   Reset to 0 after each transfer.
     /**
-     * Endpoint cache keyed by remote worker address. Avoids recreating
-     * @c ucp_ep_h objects for repeated transfers to the same consumer,
-     * since UCX endpoint creation involves connection establishment and
-     * is expensive relative to the transfer itself.
+     * Endpoint cache of this worker, keyed by consumer key. Avoids
+     * recreating @c ucp_ep_h objects for repeated transfers to the same
+     * consumer, since UCX endpoint creation involves connection
+     * establishment and is expensive relative to the transfer itself.
      * Released via @c dyad_ucx_ep_cache_finalize().
      */
     ucx_ep_cache_h ep_cache;
-    ucp_tag_t consumer_conn_key;  ///< Endpoint cache lookup key: @c pid << 32 | @c tag_cons.
+    ucp_tag_t consumer_conn_key;  ///< Key of the consumer being served, from its request.
+    /**
+     * Copy of the registration of the consumer being served, which
+     * @c remote_address and @c rkey_buf point into, so that the registry
+     * of the process can drop it during the transfer. Grown as needed by
+     * @c dyad_ucx_consumer_find(). Producer side only.
+     */
+    void *reg_copy;
+    size_t reg_copy_size;  ///< Number of bytes @c reg_copy has room for.
+    /**
+     * Producers this consumer registered with, in the order of
+     * registration. Consumer side only.
+     */
+    ucx_reg_t *regs;
+    size_t nregs;        ///< Number of entries of @c regs.
+    size_t regs_cap;     ///< Number of entries @c regs has room for.
+    uint32_t prod_rank;  ///< Producer of the current transfer. Consumer side only.
+    /**
+     * Fetch RPC of the current transfer, polled while waiting for chunks
+     * so that a producer failing before sending them is noticed. Consumer
+     * side only. Not owned, unless it is @c retry_f.
+     */
+    flux_future_t *f;
+    /**
+     * Payload of the fetch RPC of the current transfer, referenced from
+     * @c dyad_dtl_ucx_rpc_pack() on, so that the request can be sent again
+     * under a new key. Consumer side only.
+     */
+    json_t *rpc_payload;
+    /**
+     * Fetch RPC sent again by @c ucx_rpc_retry(), owned until
+     * @c dyad_dtl_ucx_rpc_future() hands it over. Consumer side only.
+     */
+    flux_future_t *retry_f;
+    bool retried;  ///< Whether the current fetch was sent again. Consumer side only.
 
     /**
      * Packed remote key buffer for the consumer's RDMA-registered memory.
-     * On the producer side, allocated by @c ucp_rkey_pack() in
+     * On the consumer side, allocated by @c ucp_rkey_pack() in
      * @c ucx_allocate_buffer() — must be released via
-     * @c ucp_rkey_buffer_release(). On the consumer side, allocated by
-     * @c malloc() in @c dyad_dtl_ucx_rpc_unpack() — must be released
-     * via @c free(). The release method therefore depends on
-     * @c comm_mode.
+     * @c ucp_rkey_buffer_release(). On the producer side, points into
+     * @c reg_copy, and is not owned.
      */
     void *rkey_buf;
     size_t rkey_size;  ///< Size of @c rkey_buf in bytes.
     /**
-     * Remote destination address of the consumer's RDMA buffer. Used as
-     * the target address for @c ucp_put_nbx() in @c ucx_send_no_wait().
-     * Extracted from the Flux RPC payload in @c dyad_dtl_ucx_rpc_unpack().
+     * Address of the consumer's receive ring, from which the addresses of
+     * its slots are computed by the producer. Taken from the registration
+     * of the consumer in @c dyad_dtl_ucx_rpc_unpack().
      */
     uint64_t cons_buf_ptr;
 
     /**
      * Unpacked remote key handle. Unpacked per-transfer in
-     * @c ucx_send_no_wait() via @c ucp_ep_rkey_unpack() and destroyed
+     * @c ucx_send_msg() via @c ucp_ep_rkey_unpack() and destroyed
      * after each send via @c ucp_rkey_destroy(). Must be initialized to
      * @c NULL in @c dyad_dtl_ucx_init() to prevent passing an
      * uninitialized handle to @c ucp_rkey_destroy().
@@ -111,20 +252,29 @@ typedef struct dyad_dtl_ucx dyad_dtl_ucx_t;
  * - @c rpc_unpack           → @c dyad_dtl_ucx_rpc_unpack
  * - @c rpc_respond          → @c dyad_dtl_ucx_rpc_respond
  * - @c rpc_recv_response    → @c dyad_dtl_ucx_rpc_recv_response
+ * - @c rpc_register         → @c dyad_dtl_ucx_rpc_register
+ * - @c rpc_future           → @c dyad_dtl_ucx_rpc_future
  * - @c get_buffer           → @c dyad_dtl_ucx_get_buffer
  * - @c return_buffer        → @c dyad_dtl_ucx_return_buffer
  * - @c establish_connection → @c dyad_dtl_ucx_establish_connection
  * - @c send                 → @c dyad_dtl_ucx_send
+ * - @c send_mapped          → @c dyad_dtl_ucx_send_mapped
  * - @c recv                 → @c dyad_dtl_ucx_recv
  * - @c close_connection     → @c dyad_dtl_ucx_close_connection
  *
  * Initialization proceeds in the following order:
  *
  *  1. Allocates the @c dyad_dtl_ucx struct and initializes all fields
- *     to safe defaults (@c NULL, 0, or @c UCX_MAX_TRANSFER_SIZE).
+ *     to safe defaults (@c NULL or 0), and the receive ring geometry
+ *     from @c ctx->ucx_slot_size, rounded up to a multiple of
+ *     @c DYAD_UCX_HDR_SIZE, and @c ctx->ucx_slots, clamped to
+ *     @c DYAD_UCX_MAX_SLOTS.
  *     The Flux handle is borrowed from @c ctx->h as a non-owning pointer.
- *  2. Reads the UCX configuration via @c ucp_config_read().
- *  3. Initializes the UCX context via @c ucp_init() with the following
+ *  2. Takes a reference to the UCX context of the process. The first
+ *     handle reads the UCX configuration via @c ucp_config_read().
+ *  3. The first handle initializes the UCX context via @c ucp_init(),
+ *     with @c mt_workers_shared set, since every thread with a DYAD
+ *     context of its own creates its worker in it, and with the following
  *     features enabled:
  *     - @c UCP_FEATURE_RMA — Remote Memory Access for RDMA push.
  *     - @c UCP_FEATURE_AMO32 — 32-bit atomic memory operations.
@@ -140,22 +290,21 @@ typedef struct dyad_dtl_ucx dyad_dtl_ucx_t;
  *     storing it in @c dtl_handle->local_address. This address is sent
  *     to the remote peer during connection establishment so the peer
  *     can create an endpoint back to this worker.
- *  6. Initializes the endpoint cache via @c dyad_ucx_ep_cache_init().
- *     The cache stores @c ucp_ep_h endpoints keyed by remote worker
- *     address to avoid recreating endpoints for repeated transfers to
- *     the same peer.
- *  7. Allocates and registers an RDMA buffer of
- *     @c UCX_MAX_TRANSFER_SIZE + @c sizeof(size_t) bytes via
- *     @c ucx_allocate_buffer(). The extra @c sizeof(size_t) bytes hold
- *     a prepended file size sentinel used by the consumer to detect
- *     when the producer has started the RDMA push. On the consumer side
- *     (@c DYAD_COMM_RECV), also packs the registered memory region into
- *     @c rkey_buf via @c ucp_rkey_pack() so the packed key can be sent
- *     to the producer to authorize the RDMA push. On the producer side
- *     (@c DYAD_COMM_SEND), @c rkey_buf is left as @c NULL since no peer
- *     performs RDMA into the producer's buffer; it will be populated per
- *     transfer in @c dyad_dtl_ucx_rpc_unpack() with the consumer's
- *     packed key decoded from the RPC payload.
+ *  6. Initializes the endpoint cache of at most
+ *     @c ctx->ucx_ep_cache_size endpoints via @c dyad_ucx_ep_cache_init().
+ *     The cache stores @c ucp_ep_h endpoints keyed by consumer connection
+ *     to avoid recreating endpoints for repeated transfers to the same
+ *     peer.
+ *  7. On the consumer side (@c DYAD_COMM_RECV), allocates and
+ *     registers the receive ring of @c ctx->ucx_slots slots of
+ *     @c ctx->ucx_slot_size bytes via @c ucx_allocate_buffer(), and
+ *     packs its registration into @c rkey_buf via @c ucp_rkey_pack() so
+ *     the packed key can be sent to the producer to authorize the puts
+ *     into the ring. On the producer side (@c DYAD_COMM_SEND), no memory
+ *     is registered up front: the buffers of the registered buffer pool
+ *     are registered on first use by @c dyad_dtl_ucx_get_buffer(), and
+ *     @c rkey_buf is populated per transfer in
+ *     @c dyad_dtl_ucx_rpc_unpack() with the consumer's packed key.
  *  8. Wires all DTL function pointers.
  *  9. Performs a loopback connection warmup via @c ucx_warmup() to
  *     prime the UCX connection machinery before the first real transfer.
@@ -170,12 +319,8 @@ typedef struct dyad_dtl_ucx dyad_dtl_ucx_t;
  *                      since @c dyad_dtl_init() already stores the mode
  *                      in @c ctx->dtl_handle->mode before dispatch
  *                      (see TODO).
- * @param[in] comm_mode Communication direction. Controls the memory
- *                      protection flags for the RDMA buffer:
- *                      @c DYAD_COMM_SEND (producer) uses
- *                      @c UCP_MEM_MAP_PROT_LOCAL_READ;
- *                      @c DYAD_COMM_RECV (consumer) uses
- *                      @c UCP_MEM_MAP_PROT_REMOTE_WRITE.
+ * @param[in] comm_mode Communication direction. Only a consumer
+ *                      (@c DYAD_COMM_RECV) allocates a receive ring.
  * @param[in] debug     If @c true, prints the UCX configuration to
  *                      @c stderr and enables verbose debug logging.
  *
@@ -199,42 +344,33 @@ dyad_rc_t dyad_dtl_ucx_init (const dyad_ctx_t *ctx,
                              bool debug);
 
 /**
- * @brief Packs a file fetch request into a JSON object for a UCX RPC call.
+ * @brief Packs a file fetch request into a JSON object for a UCX RPC call,
+ *        registering with the producer first if needed.
  *
  * @details
- * Creates a Jansson JSON object containing all information the producer
- * needs to locate the file and perform an RDMA push into the consumer's
- * pre-registered buffer. Before packing, resets the first
- * @c sizeof(ssize_t) bytes of @c dtl_handle->net_buf to zero so that
- * @c ucx_recv_no_wait() can use this as a sentinel to detect when the
- * producer has started writing.
- *
- * The packed JSON object contains the following fields:
+ * Before packing, clears the receive ring via @c ucx_ring_reset() so that
+ * the chunks of this transfer start at its first slot and those of an
+ * earlier transfer are not mistaken for them.
+ *
+ * The producer needs the consumer's UCX worker address, the packed key
+ * of its receive ring, the address of the ring and its geometry to put
+ * data into it. These do not change over the life of the consumer, so
+ * they are sent once per producer: on the first request to
+ * @p producer_rank, the consumer sends them as a @c ucx_reg_hdr_t followed
+ * by the address and the key in a raw @c DYAD_DTL_REGISTER_RPC_NAME
+ * request, and remembers the key the producer answers with in
+ * @c dtl_handle->regs. The packed JSON object then only contains:
  *
  * - @c "upath"    — relative path of the file to fetch.
  * - @c "tag_prod" — Flux rank of the producer broker.
- * - @c "cons_buf" — consumer's RDMA buffer address (@c cons_buf_ptr)
- *                   encoded as a decimal string. The producer uses this
- *                   as the remote destination address for @c ucp_put_nbx().
- * - @c "pid_cons" — process ID of the consumer.
- * - @c "addr"     — consumer's UCX worker address, base64-encoded using
- *                   RFC 4648. The producer calls @c ucp_worker_get_address()
- *                   on this to create an endpoint back to the consumer.
- * - @c "rkey"     — consumer's UCX remote key (@c rkey_buf), base64-encoded
- *                   using RFC 4648. The producer calls @c ucp_ep_rkey_unpack()
- *                   on this to obtain the @c ucp_rkey_t needed for
- *                   @c ucp_put_nbx().
- *
- * Both the UCX worker address and the remote key are opaque binary
- * blobs that cannot be embedded directly in JSON. They are base64-encoded
- * (RFC 4648) before packing and decoded by the producer in
- * @c dyad_dtl_ucx_rpc_unpack(). The encoded buffers are freed after
- * @c json_pack() copies them into the JSON object.
- *
- * @note The UCX backend packs significantly more information than the
- *       Flux RPC or Margo backends because RDMA push requires the
- *       producer to know the consumer's exact memory address and
- *       access credentials before initiating the transfer.
+ * - @c "key"      — key under which the producer knows this consumer.
+ *
+ * so that neither side encodes, decodes or allocates the address and key
+ * of the consumer per file.
+ *
+ * A reference to the packed object is kept in @c dtl_handle->rpc_payload,
+ * so that @c ucx_rpc_retry() can send the request again, with the fields
+ * the caller adds to it, if the producer lost the registration.
  *
  * @param[in]  ctx           DYAD context.
  * @param[in]  upath         Relative path of the file to fetch.
@@ -246,11 +382,11 @@ dyad_rc_t dyad_dtl_ucx_init (const dyad_ctx_t *ctx,
  *
  * @return @c dyad_rc_t return code:
  * @retval DYAD_RC_OK      The JSON object was created successfully.
- * @retval DYAD_RC_BADPACK @c dtl_handle->local_address is @c NULL,
- *                         base64 encoding of the address or remote key
- *                         failed, or @c json_pack() failed.
- * @retval DYAD_RC_SYSFAIL Failed to allocate the base64 encoding buffer
- *                         for the address or remote key.
+ * @retval DYAD_RC_BADPACK @c dtl_handle->local_address is @c NULL, or
+ *                         @c json_pack() failed.
+ * @retval DYAD_RC_BADRPC  The registration RPC failed.
+ * @retval DYAD_RC_SYSFAIL Failed to allocate the registration payload or
+ *                         to remember the producer.
  */
 dyad_rc_t dyad_dtl_ucx_rpc_pack (const dyad_ctx_t *ctx,
                                  const char *upath,
@@ -259,47 +395,24 @@ dyad_rc_t dyad_dtl_ucx_rpc_pack (const dyad_ctx_t *ctx,
 
 /**
  * @brief Unpacks a file fetch request from an incoming Flux RPC message
- *        and decodes the consumer's UCX worker address and remote key.
+ *        and looks up the registration of its consumer.
  *
  * @details
- * Extracts the following fields from the JSON payload of @p msg using
- * @c flux_request_unpack():
- *
- * - @c "upath"    — relative path of the requested file.
- * - @c "tag_prod" — Flux rank of the producer broker.
- * - @c "cons_buf" — consumer's RDMA buffer address as a decimal string.
- *                   Parsed via @c atoll() and stored in
- *                   @c dtl_handle->cons_buf_ptr as the remote destination
- *                   address for @c ucp_put_nbx().
- * - @c "pid_cons" — process ID of the consumer. Combined with
- *                   @c tag_cons to form @c dtl_handle->consumer_conn_key,
- *                   used as the endpoint cache lookup key.
- * - @c "addr"     — base64-encoded (RFC 4648) UCX worker address of the
- *                   consumer. Decoded into a newly allocated
- *                   @c dtl_handle->remote_address buffer.
- * - @c "rkey"     — base64-encoded (RFC 4648) UCX remote key. Decoded
- *                   into a newly allocated @c dtl_handle->rkey_buf buffer.
- *
- * After unpacking, both the consumer's UCX worker address and remote key
- * are base64-decoded from RFC 4648 encoding. The decoded address is used
- * by @c dyad_dtl_ucx_establish_connection() to create a @c ucp_ep_h
- * endpoint to the consumer (or retrieve a cached one). The decoded remote
- * key is used by @c ucx_send_no_wait() via @c ucp_ep_rkey_unpack() to
- * obtain the @c ucp_rkey_t needed for @c ucp_put_nbx().
+ * Extracts @c "upath", @c "tag_prod" and @c "key" from the JSON payload
+ * of @p msg using @c flux_request_unpack(), and looks up the registration
+ * of the consumer under @c "key" with @c dyad_ucx_consumer_find(), which
+ * copies it into @c dtl_handle->reg_copy. The worker address, packed key
+ * and receive ring of the consumer are then pointed to in that copy, in
+ * @c dtl_handle->remote_address, @c dtl_handle->rkey_buf,
+ * @c dtl_handle->cons_buf_ptr, @c dtl_handle->slots and
+ * @c dtl_handle->slot_size, without any allocation once the copy is
+ * large enough.
  *
  * The communication tag is computed as:
- * @c dtl_handle->comm_tag = tag_prod << 32 | tag_cons
- *
- * The endpoint cache key is computed as:
- * @c dtl_handle->consumer_conn_key = pid << 32 | tag_cons
- *
- * On any decoding failure the corresponding allocated buffer is freed
- * and set to @c NULL before returning.
+ * @c dtl_handle->comm_tag = tag_prod << 32
  *
- * @note Unlike the Margo backend which calls @c margo_addr_lookup() to
- *       resolve the consumer's address, the UCX backend allocates a raw
- *       buffer for the decoded binary address and passes it directly to
- *       @c ucp_worker_get_address() during connection establishment.
+ * and @c "key" is also the endpoint cache key,
+ * @c dtl_handle->consumer_conn_key.
  *
  * @note @p upath is owned by the Flux message @p msg and must not be
  *       freed by the caller. It remains valid only for the lifetime
@@ -312,12 +425,11 @@ dyad_rc_t dyad_dtl_ucx_rpc_pack (const dyad_ctx_t *ctx,
  *                   Valid for the lifetime of @p msg.
  *
  * @return @c dyad_rc_t return code:
- * @retval DYAD_RC_OK           Unpacking and decoding succeeded.
- * @retval DYAD_RC_BADUNPACK    @c flux_request_unpack() failed.
- * @retval DYAD_RC_SYSFAIL      Failed to allocate the buffer for the
- *                              decoded address or remote key.
- * @retval DYAD_RC_BAD_B64DECODE Base64 decoding of the address or
- *                              remote key failed.
+ * @retval DYAD_RC_OK         Unpacking succeeded.
+ * @retval DYAD_RC_BADUNPACK  @c flux_request_unpack() failed.
+ * @retval DYAD_RC_NOTFOUND   No consumer is registered under @c "key",
+ *                            e.g., because the module was reloaded. The
+ *                            module fails the request with @c ESTALE.
  */
 dyad_rc_t dyad_dtl_ucx_rpc_unpack (const dyad_ctx_t *ctx, const flux_msg_t *msg, char **upath);
 
@@ -341,29 +453,75 @@ dyad_rc_t dyad_dtl_ucx_rpc_respond (const dyad_ctx_t *ctx, const flux_msg_t *ori
  * @brief Receives the initial RPC response from the service.
  *
  * @details
- * No-op for the UCX DTL. The consumer does not process a Flux RPC
- * response before data transfer begins — it waits directly on the
- * sentinel value in @c dtl_handle->net_buf via @c ucx_recv_no_wait(),
- * which polls until the producer's RDMA push has started writing data.
+ * The consumer does not process a Flux RPC response before data transfer
+ * begins — it waits directly on the slots of its receive ring in
+ * @c dyad_dtl_ucx_recv(), which polls until the producer's puts land.
+ * @p f is only kept in @c dtl_handle->f until
+ * @c dyad_dtl_ucx_close_connection(), so that the wait ends if the
+ * producer fails the request instead.
  *
- * @param[in] ctx Unused by this backend.
- * @param[in] f   Unused by this backend.
+ * @param[in] ctx DYAD context.
+ * @param[in] f   Future of the fetch RPC.
  *
  * @return Always returns @c DYAD_RC_OK.
  */
 dyad_rc_t dyad_dtl_ucx_rpc_recv_response (const dyad_ctx_t *ctx, flux_future_t *f);
 
 /**
- * @brief Returns a pointer to the pre-allocated UCX RDMA buffer.
+ * @brief Hands over the RPC through which the responses of the current
+ *        fetch come.
+ *
+ * @details
+ * A producer that does not know the key of this consumer, e.g., after a
+ * reload of its module or after dropping the registration from its
+ * bounded registry, fails the request with @c ESTALE. The consumer then
+ * registers again and sends the same request under the new key with
+ * @c ucx_rpc_retry(), once per fetch and only before the first chunk
+ * arrived. This happens while waiting for a chunk in
+ * @c dyad_dtl_ucx_recv(), or here if @p f already failed that way, as
+ * for batches whose caller reads the responses before receiving data.
+ *
+ * @param[in] ctx DYAD context.
+ * @param[in] f   Future passed to @c dyad_dtl_ucx_rpc_recv_response().
+ *
+ * @return @p f, or the future of the request sent again. In that case,
+ *         @p f is destroyed and the caller owns the returned future.
+ */
+flux_future_t *dyad_dtl_ucx_rpc_future (const dyad_ctx_t *ctx, flux_future_t *f);
+
+/**
+ * @brief Registers a consumer from the raw payload of a
+ *        @c DYAD_DTL_REGISTER_RPC_NAME request.
+ *
+ * @details
+ * Checks the @c ucx_reg_hdr_t at the start of the payload against its
+ * length and the limits of the receive ring, and stores the payload with
+ * @c dyad_ucx_consumer_register(), where every UCX worker of the process
+ * finds it. A consumer registering again with the same payload keeps its
+ * key.
+ *
+ * @param[in]  ctx DYAD context.
+ * @param[in]  msg Incoming registration request.
+ * @param[out] key Set to the key under which the consumer is known.
+ *
+ * @return @c dyad_rc_t return code:
+ * @retval DYAD_RC_OK         The consumer is registered.
+ * @retval DYAD_RC_BADUNPACK  The payload is not a valid registration.
+ * @retval DYAD_RC_SYSFAIL    The registration could not be stored.
+ */
+dyad_rc_t dyad_dtl_ucx_rpc_register (const dyad_ctx_t *ctx, const flux_msg_t *msg, uint64_t *key);
+
+/**
+ * @brief Takes a registered buffer from the UCX buffer pool.
  *
  * @details
  * Unlike the Flux RPC and Margo backends which allocate a new buffer
- * on each call, the UCX backend uses a single pre-allocated RDMA-
- * registered buffer (@c dtl_handle->net_buf) allocated during
- * @c dyad_dtl_ucx_init(). This function simply validates @p data_size
- * and sets @p *data_buf to point to that pre-allocated buffer.
+ * on each call, the UCX backend keeps a pool of buffers registered with
+ * @c ucp_mem_map(), in size classes of 64 KiB growing by a factor of 4.
+ * A free buffer of the class of @p data_size is reused, or a new one is
+ * registered. Larger requests are registered for their exact size.
  *
- * Reusing a pre-allocated buffer avoids the overhead of repeated
+ * Reusing registered buffers avoids the overhead of repeated
  * @c ucp_mem_map() registrations, which are expensive because they
  * pin memory and register it with the network hardware.
  *
@@ -373,48 +531,49 @@ dyad_rc_t dyad_dtl_ucx_rpc_recv_response (const dyad_ctx_t *ctx, flux_future_t *
  *       evaluates to @c true even when @p data_buf points to a @c NULL
  *       pointer (see TODO in source).
  *
- * @note The caller must not free @p *data_buf — it points into the
- *       UCX-registered memory region managed by @c dtl_handle and must
- *       be released via @c dyad_dtl_ucx_return_buffer() which is itself
- *       a no-op for UCX (the buffer is only freed during finalization).
+ * @note The caller must not free @p *data_buf — it must be given back
+ *       to the pool via @c dyad_dtl_ucx_return_buffer(). Up to
+ *       @c DYAD_UCX_POOL_KEEP buffers per class stay registered until
+ *       finalization.
  *
  * @todo Investigate and fix the @p *data_buf != @c NULL validation
  *       check that incorrectly fires for valid @c NULL-initialized
  *       pointers.
  *
  * @param[in]  ctx       DYAD context.
- * @param[in]  data_size Number of bytes needed. Must not exceed
- *                       @c dtl_handle->max_transfer_size
- *                       (@c UCX_MAX_TRANSFER_SIZE).
- * @param[out] data_buf  Set to @c dtl_handle->net_buf on success.
+ * @param[in]  data_size Number of bytes needed.
+ * @param[out] data_buf  Set to the registered buffer on success.
  *
  * @return @c dyad_rc_t return code:
- * @retval DYAD_RC_OK     @p *data_buf set to the pre-allocated buffer.
- * @retval DYAD_RC_BADBUF @p data_size exceeds @c max_transfer_size.
+ * @retval DYAD_RC_OK           @p *data_buf set to a registered buffer.
+ * @retval DYAD_RC_UCXMMAP_FAIL Registering a new buffer failed.
+ * @retval DYAD_RC_SYSFAIL      Tracking a new buffer failed.
  */
 dyad_rc_t dyad_dtl_ucx_get_buffer (const dyad_ctx_t *ctx, size_t data_size, void **data_buf);
 
 /**
- * @brief Releases a reference to the UCX pre-allocated RDMA buffer.
+ * @brief Gives back a buffer of @c dyad_dtl_ucx_get_buffer() or
+ *        @c dyad_dtl_ucx_recv().
  *
  * @details
  * Unlike the Flux RPC and Margo backends which @c free() the buffer,
- * the UCX backend only sets @p *data_buf to @c NULL since the buffer
- * is pre-allocated and RDMA-registered during @c dyad_dtl_ucx_init()
- * and must persist for the lifetime of the DTL handle. The actual
- * memory is released by @c ucx_free_buffer() during finalization.
+ * the UCX backend keeps registered memory for later transfers:
  *
- * Validates @p data_buf before clearing:
- * - If @p data_buf is @c NULL or @p *data_buf is @c NULL, returns
- *   @c DYAD_RC_BADBUF.
+ * - A message received in a single slot of the receive ring hands the
+ *   slot back to the producer via @c ucx_ring_release().
+ * - A buffer of the pool is returned to it via @c ucx_pool_release(),
+ *   which keeps it registered unless its class already has
+ *   @c DYAD_UCX_POOL_KEEP free buffers.
  *
  * @param[in,out] ctx      DYAD context.
  * @param[in,out] data_buf Pointer to the buffer pointer to clear.
  *                         @p *data_buf is set to @c NULL on success.
  *
  * @return @c dyad_rc_t return code:
- * @retval DYAD_RC_OK     @p *data_buf cleared successfully.
- * @retval DYAD_RC_BADBUF @p data_buf or @p *data_buf is @c NULL.
+ * @retval DYAD_RC_OK     @p *data_buf given back successfully.
+ * @retval DYAD_RC_BADBUF @p data_buf or @p *data_buf is @c NULL, or
+ *                        @p *data_buf is neither in the ring nor in
+ *                        the pool.
  */
 dyad_rc_t dyad_dtl_ucx_return_buffer (const dyad_ctx_t *ctx, void **data_buf);
 
@@ -430,12 +589,12 @@ dyad_rc_t dyad_dtl_ucx_return_buffer (const dyad_ctx_t *ctx, void **data_buf);
  *   exists, creates a new one via @c dyad_ucx_ep_cache_insert(), which
  *   calls @c ucp_ep_create() and stores the result in the cache.
  *   The endpoint is stored in @c dtl_handle->ep for use by
- *   @c ucx_send_no_wait(). If @p debug is @c true, prints endpoint
+ *   @c ucx_send_msg(). If @p debug is @c true, prints endpoint
  *   information to @c stderr via @c ucp_ep_print_info().
  *
  * - @c DYAD_COMM_RECV (consumer): No-op. The consumer does not need
  *   to create an endpoint — it passively waits for the producer to
- *   push data into the pre-registered RDMA buffer via @c ucp_put_nbx().
+ *   push data into its receive ring via @c ucp_put_nbx().
  *
  * The endpoint cache avoids recreating @c ucp_ep_h objects for repeated
  * transfers to the same consumer, which is significant because UCX
@@ -457,70 +616,94 @@ dyad_rc_t dyad_dtl_ucx_return_buffer (const dyad_ctx_t *ctx, void **data_buf);
 dyad_rc_t dyad_dtl_ucx_establish_connection (const dyad_ctx_t *ctx);
 
 /**
- * @brief Sends file data to the consumer via UCX RDMA push.
+ * @brief Sends a message to the consumer via UCX RDMA push.
  *
  * @details
- * Initiates a non-blocking RDMA put via @c ucx_send_no_wait() with
- * @c is_warmup=false, then blocks until the operation completes by
- * calling @c dyad_ucx_request_wait(). The data is pushed directly into
- * the consumer's pre-registered RDMA buffer at
- * @c dtl_handle->cons_buf_ptr using the endpoint and remote key
- * established during @c dyad_dtl_ucx_establish_connection() and
- * @c dyad_dtl_ucx_rpc_unpack().
- *
- * @note The producer prepends the file size to @p buf before calling
- *       this function (in @c dyad_fetch_request_cb()), so the consumer
- *       can use the first @c sizeof(size_t) bytes as a sentinel in
- *       @c ucx_recv_no_wait() to detect when the push has started.
+ * Cuts @p buf into chunks of at most @c dtl_handle->slot_size bytes and
+ * puts them with @c ucp_put_nbx() into the rotating slots of the
+ * consumer's receive ring, whose address, geometry and remote key were
+ * received in @c dyad_dtl_ucx_rpc_unpack(). Each chunk carries its
+ * length, its offset and the length of the whole message, followed by a
+ * sequence number put after a @c ucp_worker_fence(), on which the
+ * consumer polls. As many chunks as the ring has slots are in flight at
+ * once; further chunks wait, by reading the consumer's count of released
+ * chunks with @c ucp_get_nbx(), until the consumer frees a slot. Returns
+ * once all puts have completed.
  *
  * @param[in] ctx    DYAD context.
- * @param[in] buf    Buffer containing the file data to send. Must point
- *                   to the pre-allocated UCX-registered buffer
- *                   (@c dtl_handle->net_buf) since @c ucp_put_nbx()
- *                   requires the source buffer to be registered with UCX.
+ * @param[in] buf    Message to send. A buffer of
+ *                   @c dyad_dtl_ucx_get_buffer() is put with its pool
+ *                   registration. Any other buffer is registered by UCX
+ *                   on the fly.
  * @param[in] buflen Number of bytes to send.
  *
  * @return @c dyad_rc_t return code:
  * @retval DYAD_RC_OK            Data sent successfully.
- * @retval DYAD_RC_UCXCOMM_FAIL  @c ucp_put_nbx() or
- *                               @c dyad_ucx_request_wait() failed.
+ * @retval DYAD_RC_UCXCOMM_FAIL  Unpacking the remote key, or one of the
+ *                               gets, fences or puts failed.
  */
 dyad_rc_t dyad_dtl_ucx_send (const dyad_ctx_t *ctx, void *buf, size_t buflen);
 
 /**
- * @brief Receives file data from the producer via UCX RDMA push.
+ * @brief Sends file data that does not live in a UCX-registered buffer,
+ *        such as a file mapped by the service with @c mmap().
  *
  * @details
- * Calls @c ucx_recv_no_wait() with @c is_warmup=false to busy-poll
- * the first @c sizeof(ssize_t) bytes of @c dtl_handle->net_buf until
- * they become non-zero, indicating that the producer has started the
- * RDMA push. After @c ucx_recv_no_wait() returns, the received data
- * is available directly in @c dtl_handle->net_buf — @p buf and
- * @p buflen are not populated by this function and must be read by
- * the caller from the pre-allocated buffer via
- * @c dyad_dtl_ucx_get_buffer().
- *
- * @note The return value of @c ucx_recv_no_wait() is intentionally
- *       discarded (@c (void)stat_ptr) since it always returns @c NULL
- *       for the UCX backend — the actual completion is signalled by
- *       the buffer sentinel, not by a UCX request handle.
- *
- * @note Unlike the Flux RPC backend where @p buf and @p buflen are
- *       populated with a newly allocated copy of the received data,
- *       the UCX backend leaves data in the pre-allocated
- *       @c dtl_handle->net_buf. The caller reads it directly from
- *       there without an additional copy.
+ * Registers @p buf with @c ucp_mem_map() for the duration of the transfer
+ * and sends it in chunks as @c dyad_dtl_ucx_send() does.
  *
- * @param[in]  ctx    DYAD context.
- * @param[out] buf    Not populated by this function. The received data
- *                    is in @c dtl_handle->net_buf.
- * @param[out] buflen Not populated by this function.
+ * If @p buf cannot be registered (e.g., the transport does not support
+ * file-backed pages), each chunk is instead copied into a registered
+ * buffer of the pool of @c dtl_handle->slot_size bytes and put from
+ * there.
  *
- * @return Always returns @c DYAD_RC_OK.
+ * @param[in] ctx    DYAD context.
+ * @param[in] buf    File contents.
+ * @param[in] buflen Number of bytes to send.
  *
- * @todo Add error handling for cases where the RDMA push fails or
- *       times out. The current implementation spins indefinitely if
- *       the sentinel never becomes non-zero.
+ * @return @c dyad_rc_t return code:
+ * @retval DYAD_RC_OK            Data sent successfully.
+ * @retval DYAD_RC_UCXCOMM_FAIL  Unpacking the remote key, or one of the
+ *                               gets, fences or puts failed.
+ * @retval other                 Getting the staging buffer failed, see
+ *                               @c dyad_dtl_ucx_get_buffer().
+ */
+dyad_rc_t dyad_dtl_ucx_send_mapped (const dyad_ctx_t *ctx, void *buf, size_t buflen);
+
+/**
+ * @brief Receives a message from the producer via UCX RDMA push.
+ *
+ * @details
+ * Busy-polls the sequence number of the next slot of the receive ring
+ * via @c ucx_recv_chunk() until the producer's first chunk lands. A
+ * message that fits in that chunk is handed over in place: @p *buf
+ * points into the slot, which stays reserved until
+ * @c dyad_dtl_ucx_return_buffer(). A larger message is reassembled into
+ * a buffer of the pool as its chunks arrive, handing each slot back to
+ * the producer as soon as it has been copied, so that messages larger
+ * than the ring stream through it.
+ *
+ * @param[in]  ctx    DYAD context.
+ * @param[out] buf    Set to the received message. Must be given back
+ *                    with @c dyad_dtl_ucx_return_buffer().
+ * @param[out] buflen Set to the number of bytes of the message.
+ *
+ * @return @c dyad_rc_t return code:
+ * @retval DYAD_RC_OK            Message received.
+ * @retval DYAD_RC_UCXMMAP_FAIL  No buffer could be registered for a
+ *                               multi-chunk message. The message is
+ *                               still drained from the ring.
+ * @retval DYAD_RC_SYSFAIL       No buffer could be tracked for a
+ *                               multi-chunk message.
+ * @retval DYAD_RC_UCXCOMM_FAIL  A chunk did not fit in its message.
+ * @retval DYAD_RC_BADRPC        The producer ended the fetch RPC with an
+ *                               error before the next chunk landed. The
+ *                               registration with the producer is
+ *                               forgotten, so that the next request
+ *                               registers again.
+ *
+ * @todo Add a timeout for producers that neither put the next chunk nor
+ *       answer the fetch RPC.
  */
 dyad_rc_t dyad_dtl_ucx_recv (const dyad_ctx_t *ctx, void **buf, size_t *buflen);
 
@@ -532,38 +715,28 @@ dyad_rc_t dyad_dtl_ucx_recv (const dyad_ctx_t *ctx, void **buf, size_t *buflen);
  *
  * - @c DYAD_COMM_SEND (producer): Destroys the unpacked remote key
  *   via @c ucp_rkey_destroy() — the remote key is unpacked per-transfer
- *   in @c ucx_send_no_wait() and must be destroyed after each send.
+ *   in @c ucx_send_msg() and must be destroyed after each send.
  *   Clears @c dtl_handle->ep, @c dtl_handle->remote_address,
- *   @c dtl_handle->remote_addr_len, and @c dtl_handle->comm_tag.
+ *   @c dtl_handle->remote_addr_len, @c dtl_handle->rkey_buf and
+ *   @c dtl_handle->comm_tag. The address and packed key belong to the
+ *   registration of the consumer, which outlives the transfer.
  *
  *   The endpoint itself is @b not disconnected — it is retained in the
  *   endpoint cache for reuse in future transfers to the same consumer,
- *   avoiding the cost of reconnection. LRU eviction of stale endpoints
- *   from the cache is not yet implemented (see TODO).
- *
- *   @c dtl_handle->remote_address is set to @c NULL but not freed —
- *   the pointer is still referenced by the endpoint cache entry and
- *   must remain valid until the cache entry is evicted (see TODO).
+ *   avoiding the cost of reconnection. The cache closes its least recently
+ *   used endpoint once it holds @c ctx->ucx_ep_cache_size of them.
  *
  * - @c DYAD_COMM_RECV (consumer): No-op beyond resetting
- *   @c dtl_handle->comm_tag to 0. The consumer has no endpoint to
- *   close since it passively receives data via the pre-registered
- *   RDMA buffer without creating a @c ucp_ep_h.
+ *   @c dtl_handle->comm_tag to 0 and forgetting the fetch RPC in
+ *   @c dtl_handle->f. The consumer has no endpoint to close since it
+ *   passively receives data via the pre-registered RDMA buffer without
+ *   creating a @c ucp_ep_h.
  *
  * @param[in] ctx DYAD context.
  *
  * @return @c dyad_rc_t return code:
  * @retval DYAD_RC_OK          Connection closed successfully.
  * @retval DYAD_RC_BAD_COMM_MODE @c dtl_handle->comm_mode is invalid.
- *
- * @todo Implement LRU eviction for the endpoint cache to reclaim
- *       resources for endpoints that have not been used recently.
- *       The commented-out @c ucx_disconnect() call shows the intended
- *       disconnect path that would be used on eviction.
- *
- * @todo Free @c dtl_handle->remote_address here once the endpoint
- *       cache no longer references it, either by copying the address
- *       into the cache entry or by reference-counting it.
  */
 dyad_rc_t dyad_dtl_ucx_close_connection (const dyad_ctx_t *ctx);
 
@@ -579,9 +752,10 @@ dyad_rc_t dyad_dtl_ucx_close_connection (const dyad_ctx_t *ctx);
  *     via @c dyad_dtl_ucx_close_connection() to destroy the unpacked
  *     remote key and clear per-RPC connection state, then sets
  *     @c ep to @c NULL.
- *  2. If @c dtl_handle->ep_cache is non-@c NULL, finalizes the endpoint
- *     cache via @c dyad_ucx_ep_cache_finalize(), which disconnects and
- *     destroys all cached @c ucp_ep_h endpoints, then sets
+ *  2. If @c dtl_handle->ep_cache is non-@c NULL, logs its counters and
+ *     finalizes the endpoint cache via @c dyad_ucx_ep_cache_finalize(),
+ *     which disconnects and destroys all cached @c ucp_ep_h endpoints,
+ *     waits for the closes of evicted ones, then sets
  *     @c ep_cache to @c NULL. This is the actual connection teardown —
  *     endpoints are kept alive across RPCs in the cache and are only
  *     destroyed here.
@@ -590,31 +764,30 @@ dyad_rc_t dyad_dtl_ucx_close_connection (const dyad_ctx_t *ctx);
  *     sets it to @c NULL. @c ucp_worker_release_address() must be used
  *     instead of @c free() since the address is UCX-allocated by
  *     @c ucp_worker_get_address().
- *  4. If @c dtl_handle->remote_address is non-@c NULL, frees it with
- *     @c free() and sets it to @c NULL. This handles the case where
- *     @c dyad_dtl_ucx_close_connection() was skipped on an error path
- *     and @c remote_address was not freed there.
+ *  4. Sets @c dtl_handle->remote_address to @c NULL, as it pointed into
+ *     a registration kept by the process, and frees the list
+ *     of producers a consumer registered with.
  *  5. If @c dtl_handle->rkey is non-@c NULL, destroys the unpacked
  *     remote key handle via @c ucp_rkey_destroy() and sets it to
  *     @c NULL. This is normally @c NULL at finalization since
  *     @c dyad_dtl_ucx_close_connection() destroys it after each
  *     transfer. A non-@c NULL value indicates that
  *     @c close_connection() was skipped on an error path.
- *  6. If @c dtl_handle->rkey_buf is non-@c NULL, releases it and sets
- *     it to @c NULL. The release function differs by @c comm_mode:
- *     @c DYAD_COMM_SEND uses @c free() since @c rkey_buf is a plain
- *     @c malloc() allocation from @c dyad_dtl_ucx_rpc_unpack();
- *     @c DYAD_COMM_RECV uses @c ucp_rkey_buffer_release() since
- *     @c rkey_buf is UCX-allocated by @c ucp_rkey_pack() in
- *     @c ucx_allocate_buffer().
- *  7. If @c dtl_handle->mem_handle is non-@c NULL, unmaps and frees the
- *     pre-allocated RDMA buffer via @c ucx_free_buffer(), which calls
+ *  6. If @c dtl_handle->rkey_buf is non-@c NULL, releases it with
+ *     @c ucp_rkey_buffer_release() on the consumer side, since it is
+ *     UCX-allocated by @c ucp_rkey_pack() in @c ucx_allocate_buffer(),
+ *     and sets it to @c NULL. On the producer side, it pointed into a
+ *     registration and is only set to @c NULL.
+ *  7. Releases every buffer of the registered buffer pool, then, if
+ *     @c dtl_handle->mem_handle is non-@c NULL, unmaps and frees the
+ *     receive ring via @c ucx_free_buffer(), which calls
  *     @c ucp_mem_unmap() and sets @c dtl_handle->net_buf to @c NULL.
  *     Then sets @c mem_handle to @c NULL.
  *  8. If @c dtl_handle->ucx_worker is non-@c NULL, destroys the UCX
  *     worker via @c ucp_worker_destroy() and sets it to @c NULL.
- *  9. If @c dtl_handle->ucx_ctx is non-@c NULL, releases the UCX
- *     context via @c ucp_cleanup() and sets it to @c NULL.
+ *  9. If @c dtl_handle->ucx_ctx is non-@c NULL, drops its reference to
+ *     the UCX context, which the last handle of the process releases via
+ *     @c ucp_cleanup(), and sets it to @c NULL.
  * 10. Sets @c dtl_handle->h to @c NULL. The Flux handle is non-owning
  *     and must not be closed here — it is managed by the DYAD context.
  * 11. Frees the @c dyad_dtl_ucx struct and sets the handle pointer
@@ -11,10 +11,18 @@
 #include <dyad/common/dyad_structures_int.h>
 // clang-format on
 
+#include <algorithm>
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
 #include <functional>
+#include <list>
+#include <mutex>
 #include <new>
+#include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <dyad/common/dyad_logging.h>
 #include <dyad/common/dyad_profiler.h>
@@ -31,17 +39,84 @@
  */
 using key_type = uint64_t;
 
+/**
+ * @brief Cached endpoints in order of use, most recently used first.
+ */
+using lru_type = std::list<std::pair<key_type, ucp_ep_h>>;
+
 /**
  * @brief UCX endpoint cache type.
  *
  * @details
- * An unordered map from @c key_type to @c ucp_ep_h, used to cache
- * UCX endpoints keyed by consumer connection key. Lookups and insertions
- * are O(1) on average. Cached endpoints are reused across transfers to
- * the same consumer to avoid the cost of repeated @c ucp_ep_create()
- * calls.
+ * Cached endpoints are reused across transfers to the same consumer to
+ * avoid the cost of repeated @c ucp_ep_create() calls. Since every
+ * endpoint holds transport resources, e.g., queue pairs, and consumers
+ * come and go over the life of a producer, at most @c capacity endpoints
+ * are kept. Once full, the least recently used endpoint is evicted, and
+ * its close is only started, so that the transfer that needed the room
+ * does not wait for the teardown. The closes in progress are completed
+ * whenever another endpoint is inserted, and at finalization.
+ */
+struct cache_type {
+    lru_type lru;  ///< Cached endpoints, most recently used first.
+    std::unordered_map<key_type, lru_type::iterator> index;  ///< Entries of @c lru by key.
+    std::vector<ucs_status_ptr_t> closing;  ///< Close requests of evicted endpoints.
+    size_t capacity = 1ul;                  ///< Maximum number of cached endpoints.
+    dyad_ucx_ep_cache_stats_t stats = {};   ///< Counters. @c entries is not maintained.
+};
+
+/**
+ * @brief Registration of a consumer, as kept by the registry.
+ */
+struct consumer_entry {
+    std::vector<char> reg;            ///< Payload of the registration request.
+    std::string addr;                 ///< Worker address of the consumer.
+    std::list<key_type>::iterator pos;  ///< Entry of the key in @c consumer_registry::lru.
+};
+
+/**
+ * @brief Registrations of the consumers of the process.
+ *
+ * @details
+ * Holds the payload of the @c DYAD_DTL_REGISTER_RPC_NAME request of every
+ * consumer under the key it was given. It is shared by the endpoint
+ * caches of all UCX workers of the process, so that any of them can
+ * serve a consumer that registered once. Like the endpoint caches, it is
+ * bounded: it keeps as many registrations as the largest endpoint cache
+ * of the process keeps endpoints, and drops the least recently used one
+ * to make room for another. A consumer whose registration was dropped is
+ * told the key is unknown, and registers again. The registration a
+ * consumer replaces, e.g., after reallocating its ring, is dropped at
+ * once. Lookups copy the registration out, so that it can be dropped at
+ * any time.
+ */
+struct consumer_registry {
+    std::mutex lock;  ///< Protects the members below.
+    std::unordered_map<key_type, consumer_entry> consumers;  ///< Registration by key.
+    std::unordered_map<std::string, key_type> keys;  ///< Current key of each worker address.
+    std::list<key_type> lru;  ///< Keys of the registrations, most recently used first.
+    size_t capacity = 1ul;    ///< Maximum number of registrations.
+    key_type next_key = 1ull;  ///< Key of the next registration.
+    uint64_t evictions = 0ull;  ///< Registrations dropped to stay within the capacity.
+};
+
+static consumer_registry registry;
+
+/**
+ * @brief Drops the registration @p it of the registry.
+ *
+ * @details
+ * The caller must hold @c registry.lock.
  */
-using cache_type = std::unordered_map<key_type, ucp_ep_h>;
+static void registry_erase (std::unordered_map<key_type, consumer_entry>::iterator it)
+{
+    auto key_it = registry.keys.find (it->second.addr);
+    if (key_it != registry.keys.end () && key_it->second == it->first) {
+        registry.keys.erase (key_it);
+    }
+    registry.lru.erase (it->second.pos);
+    registry.consumers.erase (it);
+}
 
 /**
  * @brief UCX endpoint error handler callback.
@@ -107,6 +182,32 @@ ucx_connect_done:;
     return rc;
 }
 
+/**
+ * @brief Starts closing @p ep without waiting for the close to complete.
+ *
+ * @return @c NULL if the endpoint is closed, a request to progress until
+ *         it completes, or an error status. In any case, @p ep can no
+ *         longer be used.
+ */
+static ucs_status_ptr_t ucx_close_start (ucp_ep_h ep)
+{
+    // ucp_ep_close_nbx is the prefered version of this close
+    // since UCX 1.10 However, some systems (e.g., Lassen) may have
+    // an older verison This conditional compilation will use
+    // ucp_ep_close_nbx if using UCX 1.10+, and it will use the
+    // deprecated ucp_ep_close_nb if using UCX < 1.10.
+#if UCP_API_VERSION >= UCP_VERSION(1, 10)
+    ucp_request_param_t close_params;
+    close_params.op_attr_mask = UCP_OP_ATTR_FIELD_FLAGS;
+    close_params.flags = UCP_EP_CLOSE_FLAG_FORCE;
+    return ucp_ep_close_nbx (ep, &close_params);
+#else
+    // TODO change to FORCE if we decide to enable err handleing
+    // mode
+    return ucp_ep_close_nb (ep, UCP_EP_CLOSE_MODE_FORCE);
+#endif
+}
+
 dyad_rc_t ucx_disconnect (const dyad_ctx_t *ctx, ucp_worker_h worker, ucp_ep_h ep)
 {
     DYAD_C_FUNCTION_START ();
@@ -114,21 +215,7 @@ dyad_rc_t ucx_disconnect (const dyad_ctx_t *ctx, ucp_worker_h worker, ucp_ep_h e
     ucs_status_t status = UCS_OK;
     ucs_status_ptr_t stat_ptr;
     if (ep != NULL) {
-        // ucp_tag_send_sync_nbx is the prefered version of this send
-        // since UCX 1.9 However, some systems (e.g., Lassen) may have
-        // an older verison This conditional compilation will use
-        // ucp_tag_send_sync_nbx if using UCX 1.9+, and it will use the
-        // deprecated ucp_tag_send_sync_nb if using UCX < 1.9.
-#if UCP_API_VERSION >= UCP_VERSION(1, 10)
-        ucp_request_param_t close_params;
-        close_params.op_attr_mask = UCP_OP_ATTR_FIELD_FLAGS;
-        close_params.flags = UCP_EP_CLOSE_FLAG_FORCE;
-        stat_ptr = ucp_ep_close_nbx (ep, &close_params);
-#else
-        // TODO change to FORCE if we decide to enable err handleing
-        // mode
-        stat_ptr = ucp_ep_close_nb (ep, UCP_EP_CLOSE_MODE_FORCE);
-#endif
+        stat_ptr = ucx_close_start (ep);
         // Don't use dyad_ucx_request_wait here because ep_close behaves
         // differently than other UCX calls
         if (stat_ptr != NULL) {
@@ -158,19 +245,84 @@ ucx_disconnect_region_finish:
     return rc;
 }
 
-dyad_rc_t dyad_ucx_ep_cache_init (const dyad_ctx_t *ctx, ucx_ep_cache_h *cache)
+/**
+ * @brief Frees the close requests of the evicted endpoints that completed.
+ *
+ * @details
+ * With @p wait, progresses @p worker until every close completes instead.
+ */
+static void cache_reap (const dyad_ctx_t *ctx, cache_type *cache, ucp_worker_h worker, bool wait)
+{
+    size_t i = 0ul;
+    ucs_status_t status = UCS_OK;
+    while (i < cache->closing.size ()) {
+        status = ucp_request_check_status (cache->closing[i]);
+        if (status == UCS_INPROGRESS) {
+            if (wait) {
+                ucp_worker_progress (worker);
+            } else {
+                i++;
+            }
+            continue;
+        }
+        if (UCX_STATUS_FAIL (status)) {
+            DYAD_LOG_DEBUG (ctx, "Could not close an evicted UCP endpoint (status = %d)", status);
+        }
+        ucp_request_free (cache->closing[i]);
+        cache->closing[i] = cache->closing.back ();
+        cache->closing.pop_back ();
+    }
+}
+
+/**
+ * @brief Evicts the least recently used endpoint and starts closing it.
+ *
+ * @details
+ * The cache must not be empty. The close request, if any, is kept in
+ * @c cache->closing until @c cache_reap() sees it complete.
+ */
+static void cache_evict (const dyad_ctx_t *ctx, cache_type *cache)
+{
+    ucp_ep_h ep = cache->lru.back ().second;
+    ucs_status_ptr_t stat_ptr = NULL;
+    // Make room first, so that the request cannot be lost to an exception
+    cache->closing.reserve (cache->closing.size () + 1ul);
+    DYAD_LOG_DEBUG (ctx,
+                    "Evicting the UCP endpoint of consumer %" PRIu64,
+                    cache->lru.back ().first);
+    cache->index.erase (cache->lru.back ().first);
+    cache->lru.pop_back ();
+    cache->stats.evictions++;
+    stat_ptr = ucx_close_start (ep);
+    if (UCS_PTR_IS_PTR (stat_ptr)) {
+        cache->closing.push_back (stat_ptr);
+    } else if (UCS_PTR_IS_ERR (stat_ptr)) {
+        DYAD_LOG_DEBUG (ctx,
+                        "Could not close an evicted UCP endpoint (status = %d)",
+                        UCS_PTR_STATUS (stat_ptr));
+    }
+}
+
+dyad_rc_t dyad_ucx_ep_cache_init (const dyad_ctx_t *ctx, size_t capacity, ucx_ep_cache_h *cache)
 {
     DYAD_C_FUNCTION_START ();
     dyad_rc_t rc = DYAD_RC_OK;
-    if (cache == nullptr || *cache != nullptr) {
+    cache_type *cpp_cache = nullptr;
+    if (cache == nullptr || *cache != nullptr || capacity == 0ul) {
         rc = DYAD_RC_BADBUF;
         goto ucx_ep_cache_init_done;
     }
-    *cache = reinterpret_cast<ucx_ep_cache_h> (new (std::nothrow) cache_type ());
-    if (*cache == nullptr) {
+    cpp_cache = new (std::nothrow) cache_type ();
+    if (cpp_cache == nullptr) {
         rc = DYAD_RC_SYSFAIL;
         goto ucx_ep_cache_init_done;
     }
+    cpp_cache->capacity = capacity;
+    {
+        std::lock_guard<std::mutex> guard (registry.lock);
+        registry.capacity = std::max (registry.capacity, capacity);
+    }
+    *cache = reinterpret_cast<ucx_ep_cache_h> (cpp_cache);
 ucx_ep_cache_init_done:;
     DYAD_C_FUNCTION_END ();
     return rc;
@@ -189,14 +341,17 @@ dyad_rc_t dyad_ucx_ep_cache_find (const dyad_ctx_t *ctx,
         goto ucx_ep_cache_find_done;
     }
     try {
-        const auto *cpp_cache = reinterpret_cast<const cache_type *> (cache);
+        auto *cpp_cache = reinterpret_cast<cache_type *> (cache);
         auto key = ctx->dtl_handle->private_dtl.ucx_dtl_handle->consumer_conn_key;
-        auto cache_it = cpp_cache->find (key);
-        if (cache_it == cpp_cache->cend ()) {
+        auto cache_it = cpp_cache->index.find (key);
+        if (cache_it == cpp_cache->index.end ()) {
             *ep = nullptr;
+            cpp_cache->stats.misses++;
             rc = DYAD_RC_NOTFOUND;
         } else {
-            *ep = cache_it->second;
+            cpp_cache->lru.splice (cpp_cache->lru.begin (), cpp_cache->lru, cache_it->second);
+            *ep = cache_it->second->second;
+            cpp_cache->stats.hits++;
             rc = DYAD_RC_OK;
         }
     } catch (...) {
@@ -218,17 +373,33 @@ dyad_rc_t dyad_ucx_ep_cache_insert (const dyad_ctx_t *ctx,
     dyad_rc_t rc = DYAD_RC_OK;
     try {
         cache_type *cpp_cache = reinterpret_cast<cache_type *> (cache);
-        uint64_t key = ctx->dtl_handle->private_dtl.ucx_dtl_handle->consumer_conn_key;
-        DYAD_C_FUNCTION_UPDATE_INT ("cons_key",
-                                    ctx->dtl_handle->private_dtl.ucx_dtl_handle->consumer_conn_key)
-        auto cache_it = cpp_cache->find (key);
-        if (cache_it != cpp_cache->end ()) {
+        dyad_dtl_ucx_t *dtl_handle = ctx->dtl_handle->private_dtl.ucx_dtl_handle;
+        uint64_t key = dtl_handle->consumer_conn_key;
+        DYAD_C_FUNCTION_UPDATE_INT ("cons_key", dtl_handle->consumer_conn_key)
+        cache_reap (ctx, cpp_cache, worker, false);
+        auto cache_it = cpp_cache->index.find (key);
+        if (cache_it != cpp_cache->index.end ()) {
+            cpp_cache->lru.splice (cpp_cache->lru.begin (), cpp_cache->lru, cache_it->second);
+            dtl_handle->ep = cache_it->second->second;
             rc = DYAD_RC_OK;
         } else {
+            while (!cpp_cache->lru.empty () && cpp_cache->lru.size () >= cpp_cache->capacity) {
+                cache_evict (ctx, cpp_cache);
+            }
             DYAD_LOG_INFO (ctx, "No cache entry found. Creating new connection");
-            rc = ucx_connect (ctx, worker, addr, &ctx->dtl_handle->private_dtl.ucx_dtl_handle->ep);
+            rc = ucx_connect (ctx, worker, addr, &dtl_handle->ep);
             if (!DYAD_IS_ERROR (rc)) {
-                cpp_cache->insert_or_assign (key, ctx->dtl_handle->private_dtl.ucx_dtl_handle->ep);
+                try {
+                    cpp_cache->lru.emplace_front (key, dtl_handle->ep);
+                    cpp_cache->index.emplace (key, cpp_cache->lru.begin ());
+                } catch (...) {
+                    if (!cpp_cache->lru.empty () && cpp_cache->lru.front ().first == key) {
+                        cpp_cache->lru.pop_front ();
+                    }
+                    ucx_disconnect (ctx, worker, dtl_handle->ep);
+                    dtl_handle->ep = nullptr;
+                    throw;
+                }
                 rc = DYAD_RC_OK;
             }
         }
@@ -243,19 +414,15 @@ dyad_rc_t dyad_ucx_ep_cache_insert (const dyad_ctx_t *ctx,
  * @brief Internal helper that disconnects and removes a single cache entry.
  *
  * @details
- * If @p it is a valid iterator (not @c cache->end()), disconnects the
- * endpoint via @c ucx_disconnect(), erases the entry from the cache via
- * @c cache->erase(), and returns the iterator to the next entry. If
- * @p it is @c cache->end(), returns @c cache->end() immediately as a
- * no-op.
+ * Disconnects the endpoint of @p it via @c ucx_disconnect(), waiting for
+ * the close to complete, and erases the entry from both the recency list
+ * and the index of the cache.
  *
  * Used by both @c dyad_ucx_ep_cache_remove() for single-entry removal
  * and @c dyad_ucx_ep_cache_finalize() to iterate over and remove all
  * entries.
  *
- * @note The comment in the source mentions that the UCP address was
- *       allocated with @c malloc() during RPC unpacking. However the
- *       current implementation does not free the address here — it was
+ * @note The UCP address of the consumer is not freed here — it was
  *       extracted from @c dtl_handle->remote_address and is cleared in
  *       @c dyad_dtl_ucx_close_connection(). See the TODO in
  *       @c dyad_dtl_ucx_close_connection() regarding ownership of
@@ -263,31 +430,24 @@ dyad_rc_t dyad_ucx_ep_cache_insert (const dyad_ctx_t *ctx,
  *
  * @param[in] ctx    DYAD context. Used for logging in @c ucx_disconnect().
  * @param[in] cache  The cache from which to remove the entry.
- * @param[in] it     Iterator to the entry to remove. If equal to
- *                   @c cache->end(), the function is a no-op.
+ * @param[in] it     Iterator to the entry to remove. Must not be
+ *                   @c cache->lru.end().
  * @param[in] worker UCX worker passed to @c ucx_disconnect() to
  *                   progress the endpoint close operation.
  *
- * @return Iterator to the entry following the removed one, or
- *         @c cache->end() if @p it was already @c cache->end().
+ * @return Iterator to the entry following the removed one.
  */
-static inline cache_type::iterator cache_remove_impl (const dyad_ctx_t *ctx,
-                                                      cache_type *cache,
-                                                      cache_type::iterator it,
-                                                      ucp_worker_h worker)
+static inline lru_type::iterator cache_remove_impl (const dyad_ctx_t *ctx,
+                                                    cache_type *cache,
+                                                    lru_type::iterator it,
+                                                    ucp_worker_h worker)
 {
     DYAD_C_FUNCTION_START ();
-    if (it != cache->end ()) {
-        ucx_disconnect (ctx, worker, it->second);
-        // The UCP address was allocated with 'malloc' while unpacking
-        // the RPC message. So, we extract it from the key and free
-        // it after erasing the iterator
-        auto next_it = cache->erase (it);
-        DYAD_C_FUNCTION_END ();
-        return next_it;
-    }
+    ucx_disconnect (ctx, worker, it->second);
+    cache->index.erase (it->first);
+    auto next_it = cache->lru.erase (it);
     DYAD_C_FUNCTION_END ();
-    return cache->end ();
+    return next_it;
 }
 
 dyad_rc_t dyad_ucx_ep_cache_remove (const dyad_ctx_t *ctx,
@@ -301,8 +461,10 @@ dyad_rc_t dyad_ucx_ep_cache_remove (const dyad_ctx_t *ctx,
     try {
         cache_type *cpp_cache = reinterpret_cast<cache_type *> (cache);
         auto key = ctx->dtl_handle->private_dtl.ucx_dtl_handle->consumer_conn_key;
-        cache_type::iterator cache_it = cpp_cache->find (key);
-        cache_remove_impl (ctx, cpp_cache, cache_it, worker);
+        auto cache_it = cpp_cache->index.find (key);
+        if (cache_it != cpp_cache->index.end ()) {
+            cache_remove_impl (ctx, cpp_cache, cache_it->second, worker);
+        }
         rc = DYAD_RC_OK;
     } catch (...) {
         rc = DYAD_RC_SYSFAIL;
@@ -311,6 +473,108 @@ dyad_rc_t dyad_ucx_ep_cache_remove (const dyad_ctx_t *ctx,
     return rc;
 }
 
+dyad_rc_t dyad_ucx_consumer_register (const dyad_ctx_t *ctx,
+                                     const ucx_reg_hdr_t *reg,
+                                     size_t reg_len,
+                                     uint64_t *key)
+{
+    DYAD_C_FUNCTION_START ();
+    dyad_rc_t rc = DYAD_RC_OK;
+    try {
+        const char *data = reinterpret_cast<const char *> (reg);
+        consumer_entry entry;
+        entry.reg.assign (data, data + reg_len);
+        entry.addr.assign (data + sizeof (ucx_reg_hdr_t), reg->addr_len);
+        std::lock_guard<std::mutex> guard (registry.lock);
+        auto key_it = registry.keys.find (entry.addr);
+        if (key_it != registry.keys.end ()) {
+            auto cons_it = registry.consumers.find (key_it->second);
+            if (cons_it->second.reg == entry.reg) {
+                // Registering again, e.g., after forgetting the key
+                registry.lru.splice (registry.lru.begin (), registry.lru, cons_it->second.pos);
+                *key = cons_it->first;
+                goto ucx_consumer_register_done;
+            }
+            // A changed registration gets a new key, so that a consumer
+            // still using the old one is told to register again
+            registry_erase (cons_it);
+        }
+        while (!registry.lru.empty () && registry.lru.size () >= registry.capacity) {
+            DYAD_LOG_DEBUG (ctx, "Dropping UCX consumer %" PRIu64, registry.lru.back ());
+            registry_erase (registry.consumers.find (registry.lru.back ()));
+            registry.evictions++;
+        }
+        registry.lru.push_front (registry.next_key);
+        entry.pos = registry.lru.begin ();
+        const std::string addr = entry.addr;
+        try {
+            registry.keys[addr] = registry.next_key;
+            registry.consumers.emplace (registry.next_key, std::move (entry));
+        } catch (...) {
+            registry.keys.erase (addr);
+            registry.lru.pop_front ();
+            throw;
+        }
+        *key = registry.next_key++;
+        DYAD_LOG_DEBUG (ctx, "Registered UCX consumer %" PRIu64, *key);
+    } catch (...) {
+        rc = DYAD_RC_SYSFAIL;
+    }
+ucx_consumer_register_done:;
+    DYAD_C_FUNCTION_END ();
+    return rc;
+}
+
+dyad_rc_t dyad_ucx_consumer_find (const dyad_ctx_t *ctx,
+                                 uint64_t key,
+                                 void **reg,
+                                 size_t *reg_size)
+{
+    DYAD_C_FUNCTION_START ();
+    dyad_rc_t rc = DYAD_RC_OK;
+    try {
+        std::lock_guard<std::mutex> guard (registry.lock);
+        auto cons_it = registry.consumers.find (key);
+        if (cons_it == registry.consumers.end ()) {
+            rc = DYAD_RC_NOTFOUND;
+        } else {
+            const std::vector<char> &found = cons_it->second.reg;
+            if (*reg_size < found.size ()) {
+                void *grown = std::realloc (*reg, found.size ());
+                if (grown == nullptr) {
+                    rc = DYAD_RC_SYSFAIL;
+                    goto ucx_consumer_find_done;
+                }
+                *reg = grown;
+                *reg_size = found.size ();
+            }
+            std::memcpy (*reg, found.data (), found.size ());
+            registry.lru.splice (registry.lru.begin (), registry.lru, cons_it->second.pos);
+        }
+    } catch (...) {
+        rc = DYAD_RC_SYSFAIL;
+    }
+ucx_consumer_find_done:;
+    DYAD_C_FUNCTION_END ();
+    return rc;
+}
+
+void dyad_ucx_ep_cache_stats (const ucx_ep_cache_h cache, dyad_ucx_ep_cache_stats_t *stats)
+{
+    const auto *cpp_cache = reinterpret_cast<const cache_type *> (cache);
+    *stats = cpp_cache->stats;
+    stats->entries = cpp_cache->index.size ();
+    stats->closing = cpp_cache->closing.size ();
+    try {
+        std::lock_guard<std::mutex> guard (registry.lock);
+        stats->consumers = registry.consumers.size ();
+        stats->dropped = registry.evictions;
+    } catch (...) {
+        stats->consumers = 0ul;
+        stats->dropped = 0ull;
+    }
+}
+
 dyad_rc_t dyad_ucx_ep_cache_finalize (const dyad_ctx_t *ctx,
                                       ucx_ep_cache_h *cache,
                                       ucp_worker_h worker)
@@ -320,8 +584,13 @@ dyad_rc_t dyad_ucx_ep_cache_finalize (const dyad_ctx_t *ctx,
         return DYAD_RC_OK;
     }
     cache_type *cpp_cache = reinterpret_cast<cache_type *> (*cache);
-    for (cache_type::iterator it = cpp_cache->begin (); it != cpp_cache->end ();) {
-        it = cache_remove_impl (ctx, cpp_cache, it, worker);
+    try {
+        for (auto it = cpp_cache->lru.begin (); it != cpp_cache->lru.end ();) {
+            it = cache_remove_impl (ctx, cpp_cache, it, worker);
+        }
+        // Evicted endpoints must be closed before the worker is destroyed
+        cache_reap (ctx, cpp_cache, worker, true);
+    } catch (...) {
     }
     delete cpp_cache;
     *cache = nullptr;
@@ -42,6 +42,21 @@ extern "C" {
  */
 #define UCX_STATUS_FAIL(status) (status != UCS_OK)
 
+struct ucx_reg_hdr;
+
+/**
+ * @brief Snapshot of the endpoint cache counters.
+ */
+typedef struct dyad_ucx_ep_cache_stats {
+    uint64_t hits;       ///< Lookups that found a cached endpoint.
+    uint64_t misses;     ///< Lookups that found none.
+    uint64_t evictions;  ///< Endpoints closed to stay within the capacity.
+    size_t entries;      ///< Number of endpoints currently cached.
+    size_t closing;      ///< Number of evicted endpoints whose close is in progress.
+    size_t consumers;    ///< Number of consumers registered with the process.
+    uint64_t dropped;    ///< Registrations of the process dropped to stay within its capacity.
+} dyad_ucx_ep_cache_stats_t;
+
 /**
  * @brief Creates a UCX endpoint to a remote worker.
  *
@@ -106,8 +121,9 @@ dyad_rc_t ucx_connect (const dyad_ctx_t *ctx,
  *       to @c UCP_EP_CLOSE_MODE_FLUSH to allow in-flight operations to
  *       drain before closing (see TODO in source).
  *
- * @note This function is called by @c dyad_ucx_ep_cache_finalize()
- *       when evicting endpoints from the cache, and by @c ucx_warmup()
+ * @note This function is called by @c dyad_ucx_ep_cache_remove() and
+ *       @c dyad_ucx_ep_cache_finalize() when removing endpoints from the
+ *       cache, and by @c ucx_warmup()
  *       after the loopback warmup transfer. It is @b not called during
  *       normal transfer close — @c dyad_dtl_ucx_close_connection() sets
  *       @c dtl_handle->ep to @c NULL and relies on the cache to manage
@@ -130,11 +146,16 @@ dyad_rc_t ucx_disconnect (const dyad_ctx_t *ctx, ucp_worker_h worker, ucp_ep_h e
  * @brief Allocates and initializes the UCX endpoint cache.
  *
  * @details
- * Allocates a new @c cache_type (@c std::unordered_map<key_type, ucp_ep_h>)
- * using @c new(std::nothrow) and stores a @c reinterpret_cast pointer
- * to it in @p *cache as an opaque @c ucx_ep_cache_h handle. Using
- * @c std::nothrow ensures that allocation failure returns @c nullptr
- * rather than throwing @c std::bad_alloc.
+ * Allocates a new @c cache_type using @c new(std::nothrow) and stores a
+ * @c reinterpret_cast pointer to it in @p *cache as an opaque
+ * @c ucx_ep_cache_h handle. Using @c std::nothrow ensures that allocation
+ * failure returns @c nullptr rather than throwing @c std::bad_alloc.
+ *
+ * The cache holds at most @p capacity endpoints. Inserting another one
+ * evicts the least recently used endpoint, whose close is started but not
+ * waited for (see @c dyad_ucx_ep_cache_insert()).
+ * The registry of consumers of the process is raised to @p capacity
+ * registrations if it held fewer (see @c dyad_ucx_consumer_register()).
  *
  * Validates @p cache before allocation:
  * - If @p cache is @c nullptr, the caller passed an invalid output
@@ -143,20 +164,20 @@ dyad_rc_t ucx_disconnect (const dyad_ctx_t *ctx, ucp_worker_h worker, ucp_ep_h e
  *   and overwriting it would leak the existing allocation, so
  *   @c DYAD_RC_BADBUF is returned.
  *
- * @param[in]  ctx   DYAD context. Used for logging.
- * @param[out] cache Must point to a @c nullptr on entry. Set to the
- *                   allocated cache handle on success.
+ * @param[in]  ctx      DYAD context. Used for logging.
+ * @param[in]  capacity Maximum number of cached endpoints. Must be
+ *                      greater than 0.
+ * @param[out] cache    Must point to a @c nullptr on entry. Set to the
+ *                      allocated cache handle on success.
  *
  * @return @c dyad_rc_t return code:
  * @retval DYAD_RC_OK      Cache allocated successfully.
- * @retval DYAD_RC_BADBUF  @p cache is @c nullptr or @p *cache is
- *                         already non-@c nullptr.
+ * @retval DYAD_RC_BADBUF  @p cache is @c nullptr, @p *cache is already
+ *                         non-@c nullptr, or @p capacity is 0.
  * @retval DYAD_RC_SYSFAIL @c new(std::nothrow) failed to allocate
  *                         the cache.
- *
- * @todo Add an option to configure replacement strategy
  */
-dyad_rc_t dyad_ucx_ep_cache_init (const dyad_ctx_t *ctx, ucx_ep_cache_h *cache);
+dyad_rc_t dyad_ucx_ep_cache_init (const dyad_ctx_t *ctx, size_t capacity, ucx_ep_cache_h *cache);
 
 /**
  * @brief Looks up a cached UCX endpoint by consumer connection key.
@@ -165,8 +186,10 @@ dyad_rc_t dyad_ucx_ep_cache_init (const dyad_ctx_t *ctx, ucx_ep_cache_h *cache);
  * Searches the endpoint cache for an entry matching
  * @c ctx->dtl_handle->private_dtl.ucx_dtl_handle->consumer_conn_key
  * (@c pid << 32 | tag_cons). If found, sets @p *ep to the cached
- * @c ucp_ep_h and returns @c DYAD_RC_OK. If not found, sets @p *ep
- * to @c nullptr and returns @c DYAD_RC_NOTFOUND.
+ * @c ucp_ep_h, marks it as the most recently used endpoint and returns
+ * @c DYAD_RC_OK. If not found, sets @p *ep to @c nullptr and returns
+ * @c DYAD_RC_NOTFOUND. Either way, the lookup is counted as a hit or a
+ * miss.
  *
  * @note The @p addr and @p addr_size parameters are accepted for
  *       interface consistency but are not used — the lookup is performed
@@ -221,23 +244,26 @@ dyad_rc_t dyad_ucx_ep_cache_find (const dyad_ctx_t *ctx,
  * calls @c dyad_ucx_ep_cache_find() and @c dyad_ucx_ep_cache_insert()
  * in sequence and the entry was inserted between the two calls.
  *
- * If no entry exists, creates a new @c ucp_ep_h to @p addr via
- * @c ucx_connect() and inserts it into the cache using
- * @c insert_or_assign(). The new endpoint is also stored directly in
+ * If no entry exists, evicts the least recently used endpoints until
+ * there is room for one more, creates a new @c ucp_ep_h to @p addr via
+ * @c ucx_connect() and inserts it as the most recently used entry. The
+ * new endpoint is also stored directly in
  * @c ctx->dtl_handle->private_dtl.ucx_dtl_handle->ep for immediate
  * use by the caller.
  *
+ * The close of an evicted endpoint is only started, so that the transfer
+ * to the new consumer does not wait for the teardown of the old
+ * connection. Closes in progress are checked, and their requests freed
+ * once complete, on every insertion and at finalization.
+ *
  * @note All cache operations are wrapped in a @c try / @c catch(...)
  *       block to prevent C++ exceptions from propagating into the C
  *       calling code. Any exception is caught and returned as
  *       @c DYAD_RC_SYSFAIL.
  *
- * @note @c insert_or_assign() is used instead of @c insert() to handle
- *       the race condition where a concurrent insert could have occurred
- *       between the @c find() check and the insert. Since DYAD uses
- *       @c UCS_THREAD_MODE_SERIALIZED, true concurrency is not possible,
- *       but @c insert_or_assign() is safer and has no performance cost
- *       in the non-concurrent case.
+ * @note The cache is not thread-safe. Since DYAD uses
+ *       @c UCS_THREAD_MODE_SERIALIZED, the worker and its cache are only
+ *       used by one thread at a time.
  *
  * @param[in] ctx       DYAD context. The @c consumer_conn_key and
  *                      @c ep fields of the UCX DTL internal state are
@@ -249,7 +275,7 @@ dyad_rc_t dyad_ucx_ep_cache_find (const dyad_ctx_t *ctx,
  * @param[in] addr_size Size of @p addr in bytes. Passed to
  *                      @c ucx_connect() for consistency.
  * @param[in] worker    UCX worker used to create the new endpoint via
- *                      @c ucx_connect().
+ *                      @c ucx_connect() and to close evicted ones.
  *
  * @return @c dyad_rc_t return code:
  * @retval DYAD_RC_OK       A cached entry already existed, or a new
@@ -303,20 +329,83 @@ dyad_rc_t dyad_ucx_ep_cache_remove (const dyad_ctx_t *ctx,
                                     const size_t addr_size,
                                     ucp_worker_h worker);
 
+/**
+ * @brief Stores the registration of a consumer.
+ *
+ * @details
+ * Keeps a copy of the @p reg_len bytes of @p reg, i.e., the
+ * @c ucx_reg_hdr_t followed by the worker address and packed key of the
+ * consumer, which the caller must have checked. Registrations are shared
+ * by all UCX workers of the process, under a lock, so that any of them can
+ * serve the consumer. A consumer is identified by its worker address:
+ * registering again with the same payload returns the same key, while a
+ * new address or payload gets the next key, and the registration it
+ * replaces is dropped. Keys start at 1 and are never reused.
+ *
+ * The registry keeps at most as many registrations as the largest
+ * endpoint cache of the process, see @c dyad_ucx_ep_cache_init(), and
+ * drops the least recently used one to make room for another. The
+ * consumer of a dropped registration is told its key is unknown on its
+ * next fetch, and registers again.
+ *
+ * @param[in]  ctx     DYAD context. Used for logging.
+ * @param[in]  reg     Registration payload.
+ * @param[in]  reg_len Number of bytes of @p reg.
+ * @param[out] key     Set to the key of the consumer on success.
+ *
+ * @return @c dyad_rc_t return code:
+ * @retval DYAD_RC_OK      The consumer is registered.
+ * @retval DYAD_RC_SYSFAIL An unexpected C++ exception was thrown, e.g.,
+ *                         on allocation failure.
+ */
+dyad_rc_t dyad_ucx_consumer_register (const dyad_ctx_t *ctx,
+                                     const struct ucx_reg_hdr *reg,
+                                     size_t reg_len,
+                                     uint64_t *key);
+
+/**
+ * @brief Copies the registration of the consumer known as @p key.
+ *
+ * @details
+ * The registration is copied into @p *reg, which is grown with
+ * @c realloc() if it holds fewer than the needed bytes, so that the copy
+ * stays valid even if the registry drops the registration. The lookup
+ * marks the registration as the most recently used one.
+ *
+ * @param[in]     ctx       DYAD context. Used for logging.
+ * @param[in]     key       Key returned by @c dyad_ucx_consumer_register().
+ * @param[in,out] reg       Buffer owned by the caller, or @c NULL. Set to
+ *                          the grown buffer if it was too small.
+ * @param[in,out] reg_size  Number of bytes @p *reg has room for. Updated
+ *                          when @p *reg is grown.
+ *
+ * @return @c dyad_rc_t return code:
+ * @retval DYAD_RC_OK       The registration was copied.
+ * @retval DYAD_RC_NOTFOUND No consumer is registered as @p key.
+ * @retval DYAD_RC_SYSFAIL  @p *reg could not be grown, or an unexpected
+ *                          C++ exception was thrown.
+ */
+dyad_rc_t dyad_ucx_consumer_find (const dyad_ctx_t *ctx,
+                                 uint64_t key,
+                                 void **reg,
+                                 size_t *reg_size);
+
+/**
+ * @brief Copies the counters of the endpoint cache into @p stats.
+ *
+ * @param[in]  cache  Endpoint cache handle. Must not be @c NULL.
+ * @param[out] stats  Set to the current counters. Must not be @c NULL.
+ */
+void dyad_ucx_ep_cache_stats (const ucx_ep_cache_h cache, dyad_ucx_ep_cache_stats_t *stats);
+
 /**
  * @brief Finalizes and frees the UCX endpoint cache.
  *
  * @details
  * Iterates over all entries in the cache, disconnecting and removing
- * each endpoint via @c cache_remove_impl(). After all entries are
- * removed, deletes the @c cache_type object and sets @p *cache to
- * @c nullptr.
- *
- * The iteration uses the iterator returned by @c cache_remove_impl()
- * rather than incrementing the iterator manually, since @c erase()
- * invalidates the current iterator. @c cache_remove_impl() returns
- * the iterator to the next valid entry after the erased one, making
- * this a safe and correct way to drain the entire cache.
+ * each endpoint via @c cache_remove_impl(), then progresses @p worker
+ * until the closes of the endpoints evicted earlier complete. Finally,
+ * deletes the @c cache_type object and sets @p *cache to @c nullptr.
  *
  * If @p cache is @c nullptr or @p *cache is @c nullptr, the function
  * is a no-op and returns @c DYAD_RC_OK. This allows safe calls on a
@@ -328,16 +417,9 @@ dyad_rc_t dyad_ucx_ep_cache_remove (const dyad_ctx_t *ctx,
  *       @c ucx_disconnect() requires the worker to be active to
  *       progress the endpoint close operations.
  *
- * @note Unlike @c dyad_ucx_ep_cache_remove() which wraps operations
- *       in a @c try / @c catch block, this function does not — any
- *       C++ exception thrown during iteration or deletion will
- *       propagate to the caller. Since this is called only from C++
- *       translation units this is acceptable, but a @c try / @c catch
- *       wrapper could be added for robustness (see TODO).
- *
- * @todo Add a @c try / @c catch block around the iteration and
- *       @c delete to prevent C++ exceptions from propagating into
- *       the C calling code in @c dyad_dtl_ucx_finalize().
+ * @note C++ exceptions thrown while draining the cache are caught, so
+ *       that they cannot propagate into @c dyad_dtl_ucx_finalize(). The
+ *       cache is freed regardless.
  *
  * @param[in]     ctx    DYAD context. Used for logging in
  *                       @c cache_remove_impl() → @c ucx_disconnect().
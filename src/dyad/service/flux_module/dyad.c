@@ -14,6 +14,10 @@
 #error "no config"
 #endif
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif  // _GNU_SOURCE
+
 // clang-format off
 // #include <dyad/core/dyad_core_int.h>
 #include <dyad/common/dyad_dtl.h>
@@ -24,13 +28,21 @@
 #include <dyad/common/dyad_structures_int.h>
 #include <dyad/core/dyad_ctx.h>
 #include <dyad/dtl/dyad_dtl_api.h>
+#include <dyad/service/flux_module/dyad_mod_cache.h>
+#include <dyad/service/flux_module/dyad_mod_lanes.h>
+#include <dyad/service/flux_module/dyad_mod_pool.h>
+#include <dyad/utils/codec.h>
+#include <dyad/utils/io_engine.h>
 #include <dyad/utils/read_all.h>
+#include <dyad/utils/stats.h>
 #include <dyad/utils/utils.h>
 // clang-format on
 
 #if defined(__cplusplus)
 #include <cerrno>
 #include <cstddef>
+#include <cinttypes>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -38,7 +50,9 @@
 #else
 #include <errno.h>
 #include <stdbool.h>
+#include <inttypes.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -48,6 +62,8 @@
 #include <fcntl.h>
 #include <getopt.h>
 #include <linux/limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
@@ -79,6 +95,17 @@
  *                            @c -DDYAD_LOGGER=PRINTF at build time).
  *  - @c -e, @c --error_log   Redirect error logging to a file (requires
  *                            @c -DDYAD_LOGGER=PRINTF at build time).
+ *  - @c -w, @c --workers     Number of fetch worker threads. 0 (default)
+ *                            serves every fetch inline on the reactor.
+ *  - @c -z, @c --zero_copy   Send files from a memory mapping instead of
+ *                            reading them into a buffer first.
+ *  - @c -c, @c --cache_size  Memory budget in bytes for caching the
+ *                            contents of fetched files. 0 (default)
+ *                            disables the cache.
+ *  - @c -u, @c --io_engine   Engine with which files are read, @c posix
+ *                            (default) or @c io_uring.
+ *  - @c -n, @c --ep_cache_size  Maximum number of UCX endpoints kept open
+ *                            to consumers. 256 by default.
  */
 
 /**
@@ -92,9 +119,30 @@
 typedef struct dyad_mod_ctx {
     flux_msg_handler_t **handlers;  ///< Flux message handler table.
     dyad_ctx_t *ctx;                ///< DYAD context for this module instance.
+    /**
+     * Fetch worker pool. @c NULL when fetches are served inline on the
+     * reactor thread (the default). @see dyad_module_pool_init().
+     */
+    dyad_mod_pool_t *pool;
+    /**
+     * Whether files are sent from a memory mapping rather than read into
+     * a buffer first. Set once at load time. @see dyad_mod_map_fd().
+     */
+    bool zero_copy;
+    /**
+     * Cache of recently fetched files. @c NULL when disabled (the
+     * default). @see dyad_module_cache_init().
+     */
+    dyad_mod_cache_t *cache;
+    /**
+     * DTL handles the fetch workers send from. @c NULL when fetches are
+     * sent from the reactor thread (the default).
+     * @see dyad_module_lanes_init().
+     */
+    dyad_mod_lanes_t *lanes;
 } dyad_mod_ctx_t;
 
-const struct dyad_mod_ctx dyad_mod_ctx_default = {NULL, NULL};
+const struct dyad_mod_ctx dyad_mod_ctx_default = {NULL, NULL, NULL, false, NULL, NULL};
 
 static void dyad_mod_fini (void) __attribute__ ((destructor));
 
@@ -132,8 +180,11 @@ void dyad_mod_fini (void)
  * @details
  * Registered as the destructor callback for the @c "dyad" auxiliary data
  * on the Flux handle via @c flux_aux_set(). Called by the Flux broker when
- * the module is unloaded. Releases the message handler table, finalizes
- * the DYAD context via @c dyad_ctx_fini(), and frees the context struct.
+ * the module is unloaded. Releases the message handler table, stops the
+ * fetch worker pool and releases its lanes if @c mod_main() did not
+ * already do so, logs the
+ * counters of the file cache and releases it, finalizes the DYAD context
+ * via @c dyad_ctx_fini(), and frees the context struct.
  *
  * @param[in] arg  Pointer to the @c dyad_mod_ctx_t to free. Cast from
  *                 @c void* as required by the @c flux_free_f signature.
@@ -142,6 +193,24 @@ static void freectx (void *arg)
 {
     dyad_mod_ctx_t *mod_ctx = (dyad_mod_ctx_t *)arg;
     flux_msg_handler_delvec (mod_ctx->handlers);
+    dyad_mod_pool_destroy (mod_ctx->pool);
+    mod_ctx->pool = NULL;
+    dyad_mod_lanes_destroy (mod_ctx->lanes);
+    mod_ctx->lanes = NULL;
+    if (mod_ctx->cache != NULL) {
+        dyad_mod_cache_stats_t stats;
+        dyad_mod_cache_stats (mod_ctx->cache, &stats);
+        DYAD_LOG_STDOUT ("DYAD_MOD: File cache: %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64
+                         " invalidations, %" PRIu64 " evictions, %zu bytes in %zu files\n",
+                         stats.hits,
+                         stats.misses,
+                         stats.invalidations,
+                         stats.evictions,
+                         stats.bytes,
+                         stats.entries);
+        dyad_mod_cache_destroy (mod_ctx->cache);
+        mod_ctx->cache = NULL;
+    }
     if (mod_ctx->ctx) {
         dyad_ctx_fini ();
         mod_ctx->ctx = NULL;
@@ -175,6 +244,10 @@ static dyad_mod_ctx_t *get_mod_ctx (flux_t *h)
         }
         mod_ctx->handlers = NULL;
         mod_ctx->ctx = NULL;
+        mod_ctx->pool = NULL;
+        mod_ctx->zero_copy = false;
+        mod_ctx->cache = NULL;
+        mod_ctx->lanes = NULL;
 
         if (flux_aux_set (h, "dyad", mod_ctx, freectx) < 0) {
             DYAD_LOG_STDERR ("DYAD_MOD: flux_aux_set() failed!");
@@ -191,6 +264,1032 @@ getctx_done:
     return mod_ctx;
 }
 
+/**
+ * @brief @c fcntl() command used by fetch workers to take a shared lock.
+ *
+ * @details
+ * Classic POSIX record locks belong to the process, so the lock release of
+ * one worker thread would drop the lock still needed by another worker
+ * reading the same file. Open file description locks are owned by the file
+ * descriptor instead, and still conflict with the exclusive lock taken by
+ * the producer. They are used whenever the platform provides them.
+ */
+#ifdef F_OFD_SETLKW
+#define DYAD_MOD_SETLKW F_OFD_SETLKW
+#else
+#define DYAD_MOD_SETLKW F_SETLKW
+#endif
+
+/**
+ * @brief Reads exactly @p len bytes at @p offset of @p fd into @p buf.
+ *
+ * @details
+ * Reads with the engine selected by @c DYAD_IO_ENGINE or @c -u, i.e., in
+ * pieces of at most @c DYAD_POSIX_TRANSFER_GRANULARITY bytes, or as many
+ * blocks in flight through the calling thread's io_uring. Does not log, so
+ * that it can be called from the fetch worker threads as well as from the
+ * reactor.
+ *
+ * @param[in]  ctx     DYAD context of the module.
+ * @param[in]  fd      File descriptor opened for reading.
+ * @param[out] buf     Destination buffer of at least @p len bytes.
+ * @param[in]  len     Number of bytes to read.
+ * @param[in]  offset  File offset of the first byte to read.
+ *
+ * @return Number of bytes read. A value smaller than @p len indicates an
+ *         error or an unexpected end of file, with @c errno set.
+ */
+static ssize_t
+dyad_mod_read_fd (const dyad_ctx_t *ctx, int fd, char *buf, ssize_t len, off_t offset)
+{
+    const uint64_t t0 = dyad_stats_now ();
+    const ssize_t n = dyad_io_read ((dyad_io_engine_t)ctx->io_engine, fd, buf, (size_t)len, offset);
+    dyad_stats_record (DYAD_STATS_MOD_READ, t0);
+    return n;
+}
+
+/**
+ * @brief Maps the first @p size bytes of @p fd read-only.
+ *
+ * @details
+ * Used instead of @c dyad_mod_read_fd() in zero-copy mode, so that the
+ * DTL sends straight from the page cache. Not every file system supports
+ * @c mmap() (e.g., some FUSE and parallel file systems fail with
+ * @c ENODEV), in which case the caller falls back to reading the file.
+ * Does not log, so that it can be called from the fetch worker threads.
+ *
+ * @note The mapping is only valid as long as the file is not truncated.
+ *       Callers keep the shared lock until the mapping is released, which
+ *       holds off producers that take the exclusive lock to write.
+ *
+ * @param[in] fd    File descriptor opened for reading.
+ * @param[in] size  Number of bytes to map. Must be greater than 0.
+ *
+ * @return The start of the mapping, or @c NULL with @c errno set.
+ */
+static char *dyad_mod_map_fd (int fd, ssize_t size)
+{
+    void *map = mmap (NULL, (size_t)size, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+    (void)madvise (map, (size_t)size, MADV_SEQUENTIAL);
+    return (char *)map;
+}
+
+/**
+ * @brief Faults in @p len bytes of a mapping starting at @p addr.
+ *
+ * @details
+ * Lets a fetch worker take the page faults of a mapped file, so that the
+ * reactor does not block on disk I/O while sending it. Uses
+ * @c MADV_POPULATE_READ where available (Linux 5.14 and newer) and
+ * falls back to the asynchronous @c MADV_WILLNEED read-ahead hint.
+ *
+ * @param[in] addr  Address within a mapping from @c dyad_mod_map_fd().
+ * @param[in] len   Number of bytes to fault in.
+ */
+static void dyad_mod_prefault (const char *addr, ssize_t len)
+{
+    const uintptr_t page = (uintptr_t)sysconf (_SC_PAGESIZE);
+    const uintptr_t start = (uintptr_t)addr & ~(page - 1u);
+    const size_t span = (size_t)len + (size_t)((uintptr_t)addr - start);
+#ifdef MADV_POPULATE_READ
+    if (madvise ((void *)start, span, MADV_POPULATE_READ) == 0) {
+        return;
+    }
+#endif
+    (void)madvise ((void *)start, span, MADV_WILLNEED);
+}
+
+/**
+ * @brief Looks up the file at @p path in the module's file cache.
+ *
+ * @details
+ * Only calls @c stat() on the file, to check that the cached copy is
+ * still current. Does not log, so that it can be called from the fetch
+ * worker threads.
+ *
+ * @param[in]  mod_ctx  Module context.
+ * @param[in]  path     Producer-side path of the file.
+ * @param[out] ref      Set to the cache reference on a hit. Must be passed
+ *                      to @c dyad_mod_cache_release() after sending.
+ * @param[out] data     Set to the cached contents on a hit.
+ * @param[out] len      Set to the size of the file on a hit.
+ *
+ * @return @c true on a hit, @c false if the cache is disabled or does not
+ *         hold a current copy of the file.
+ */
+static bool dyad_mod_find_cached (const dyad_mod_ctx_t *mod_ctx,
+                                  const char *path,
+                                  dyad_mod_cache_ref_t **ref,
+                                  const char **data,
+                                  ssize_t *len)
+{
+    struct stat st;
+    size_t cached_len = 0ul;
+    if (mod_ctx->cache == NULL || stat (path, &st) != 0
+        || DYAD_IS_ERROR (dyad_mod_cache_get (mod_ctx->cache, path, &st, ref, data, &cached_len))) {
+        return false;
+    }
+    *len = (ssize_t)cached_len;
+    return true;
+}
+
+/**
+ * @brief Inserts a copy of a file just loaded from @p fd into the
+ *        module's file cache, if enabled.
+ *
+ * @details
+ * Must be called while @p fd is still locked, so that the @c fstat()
+ * results recorded with the copy match its contents. Files larger than
+ * the cache budget are silently skipped. Does not log.
+ *
+ * @param[in] mod_ctx  Module context.
+ * @param[in] path     Producer-side path of the file.
+ * @param[in] fd       File descriptor the contents were loaded from.
+ * @param[in] data     Contents of the whole file.
+ * @param[in] len      Size of the file.
+ */
+static void dyad_mod_cache_file (const dyad_mod_ctx_t *mod_ctx,
+                                 const char *path,
+                                 int fd,
+                                 const char *data,
+                                 ssize_t len)
+{
+    struct stat st;
+    if (mod_ctx->cache != NULL && fstat (fd, &st) == 0 && st.st_size == len) {
+        (void)dyad_mod_cache_put (mod_ctx->cache, path, &st, data, (size_t)len);
+    }
+}
+
+/**
+ * @brief Returns the chunk size in which the consumer asked to receive the
+ *        file, or 0 to send it as a single message.
+ *
+ * @details
+ * Consumers with @c DYAD_TRANSFER_CHUNK_SIZE set add a @c "chunk_size" key
+ * to the RPC payload. Older consumers do not, and always get the whole
+ * file in one message. Chunking is only honored with the @c FLUX_RPC DTL,
+ * where every @c send() is a separate response of the RPC stream. The
+ * consumers of the other DTLs receive a single message per request: Margo
+ * pulls it into one bulk buffer, and the UCX DTL already cuts each message
+ * into chunks that stream through the consumer's receive ring.
+ *
+ * @param[in] ctx  DYAD context of the module.
+ * @param[in] msg  The consumer's fetch request.
+ *
+ * @return The requested chunk size in bytes, or 0.
+ */
+static ssize_t dyad_mod_chunk_size (const dyad_ctx_t *ctx, const flux_msg_t *msg)
+{
+    json_int_t chunk_size = 0;
+    if (ctx->dtl_handle->mode != DYAD_DTL_FLUX_RPC) {
+        return 0l;
+    }
+    if (flux_request_unpack (msg, NULL, "{s?I}", "chunk_size", &chunk_size) < 0
+        || chunk_size <= 0) {
+        return 0l;
+    }
+    return (ssize_t)chunk_size;
+}
+
+/**
+ * @brief Extracts the byte range the consumer asked for.
+ *
+ * @details
+ * Consumers fetching part of a file with @c dyad_consume_range() add
+ * @c "offset" and @c "length" keys to the RPC payload. Requests without
+ * them, as sent by @c dyad_consume(), ask for the whole file, i.e., an
+ * offset and a length of 0. A length of 0 extends the range to the end
+ * of the file.
+ *
+ * @param[in]  msg     The consumer's fetch request.
+ * @param[out] offset  Set to the first byte requested.
+ * @param[out] length  Set to the number of bytes requested, or 0.
+ *
+ * @return @c false if the keys are malformed or negative.
+ */
+static bool dyad_mod_byte_range (const flux_msg_t *msg, ssize_t *offset, ssize_t *length)
+{
+    json_int_t range_offset = 0;
+    json_int_t range_length = 0;
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s?I s?I}",
+                             "offset",
+                             &range_offset,
+                             "length",
+                             &range_length)
+            < 0
+        || range_offset < 0 || range_length < 0) {
+        return false;
+    }
+    *offset = (ssize_t)range_offset;
+    *length = (ssize_t)range_length;
+    return true;
+}
+
+/**
+ * @brief Resolves a requested byte range against the size of the file.
+ *
+ * @param[in]     file_size  Size of the file.
+ * @param[in]     offset     First byte requested.
+ * @param[in,out] length     Number of bytes requested, or 0 for the rest of
+ *                           the file. Set to the number of bytes to send,
+ *                           which stops at the end of the file.
+ *
+ * @return 0, or @c EINVAL if @p offset is not within the file.
+ */
+static int dyad_mod_clamp_range (ssize_t file_size, ssize_t offset, ssize_t *length)
+{
+    if (offset >= file_size) {
+        return EINVAL;
+    }
+    if (*length == 0l || *length > file_size - offset) {
+        *length = file_size - offset;
+    }
+    return 0;
+}
+
+/**
+ * @brief Compression negotiated with the consumer for one transfer.
+ */
+typedef struct dyad_mod_codec {
+    dyad_codec_t codec;  ///< Codec to compress with, or @c DYAD_CODEC_NONE.
+    ssize_t min_size;    ///< Messages smaller than this are not compressed.
+} dyad_mod_codec_t;
+
+/**
+ * @brief Extracts the compression the consumer asked for.
+ *
+ * @details
+ * Consumers with @c DYAD_COMPRESSION set add a @c "codec" name and a
+ * @c "codec_min" size to the RPC payload, and then accept both framed
+ * (see @c codec.h) and plain messages. Requests without the keys or with
+ * a codec this module was built without are served uncompressed.
+ *
+ * @param[in]  ctx    DYAD context of the module.
+ * @param[in]  msg    The consumer's fetch request.
+ * @param[out] codec  Set to the negotiated compression.
+ */
+static void dyad_mod_codec (const dyad_ctx_t *ctx, const flux_msg_t *msg, dyad_mod_codec_t *codec)
+{
+    const char *name = NULL;
+    json_int_t min_size = 0;
+    int c = 0;
+
+    codec->codec = DYAD_CODEC_NONE;
+    codec->min_size = 0l;
+    if (flux_request_unpack (msg, NULL, "{s?s s?I}", "codec", &name, "codec_min", &min_size) < 0) {
+        return;
+    }
+    c = dyad_codec_from_name (name);
+    if (c <= 0 || !dyad_codec_is_available ((dyad_codec_t)c)) {
+        return;
+    }
+    codec->codec = (dyad_codec_t)c;
+    codec->min_size = (ssize_t)min_size;
+}
+
+/**
+ * @brief Frames a message as negotiated with the consumer.
+ *
+ * @details
+ * Does not log, so that fetch workers can compress the data they load.
+ *
+ * @param[in]  codec      Negotiated compression.
+ * @param[in]  data       Message to send.
+ * @param[in]  len        Size of @p data.
+ * @param[out] frame      Set to a frame to send instead of @p data, to be
+ *                        released with @c free(), or to @c NULL to send
+ *                        @p data as is.
+ * @param[out] frame_len  Set to the size of @p frame.
+ *
+ * @return 0, or @c ENOMEM if the frame could not be allocated.
+ */
+static int dyad_mod_encode (const dyad_mod_codec_t *codec,
+                            const char *data,
+                            ssize_t len,
+                            char **frame,
+                            ssize_t *frame_len)
+{
+    dyad_codec_t c = (len >= codec->min_size) ? codec->codec : DYAD_CODEC_NONE;
+    size_t raw_len = 0ul;
+    size_t cap = 0ul;
+    size_t n = 0ul;
+
+    *frame = NULL;
+    *frame_len = 0l;
+    // Consumers that did not ask for compression do not look for frames
+    if (codec->codec == DYAD_CODEC_NONE
+        || (c == DYAD_CODEC_NONE && !dyad_frame_check (data, (size_t)len, &raw_len))) {
+        return 0;
+    }
+    cap = dyad_frame_bound (c, (size_t)len);
+    *frame = (char *)malloc (cap);
+    if (*frame == NULL) {
+        return ENOMEM;
+    }
+    n = dyad_frame_encode (c, data, (size_t)len, *frame, cap);
+    if (n == 0ul) {
+        free (*frame);
+        *frame = NULL;
+        return 0;
+    }
+    *frame_len = (ssize_t)n;
+    return 0;
+}
+
+/**
+ * @brief Sends one message to the consumer over an established DTL
+ *        connection, compressed if negotiated.
+ *
+ * @param[in] ctx     DYAD context of the module.
+ * @param[in] codec   Negotiated compression.
+ * @param[in] data    Message to send.
+ * @param[in] len     Size of @p data.
+ * @param[in] mapped  Whether @p data is a mapping or a cached copy, to be
+ *                    sent with @c send_mapped() if not compressed.
+ *
+ * @return @c DYAD_RC_SYSFAIL if the frame could not be allocated, or the
+ *         return code of the DTL.
+ */
+static dyad_rc_t dyad_mod_send_msg (const dyad_ctx_t *ctx,
+                                    const dyad_mod_codec_t *codec,
+                                    const char *data,
+                                    ssize_t len,
+                                    bool mapped)
+{
+    dyad_rc_t rc = DYAD_RC_OK;
+    char *frame = NULL;
+    ssize_t frame_len = 0l;
+    uint64_t t0 = 0ull;
+
+    if (dyad_mod_encode (codec, data, len, &frame, &frame_len) != 0) {
+        DYAD_LOG_ERROR (ctx, "DYAD_MOD: Could not allocate a frame for %zd bytes", len);
+        return DYAD_RC_SYSFAIL;
+    }
+    t0 = dyad_stats_now ();
+    if (frame != NULL) {
+        rc = ctx->dtl_handle->send (ctx, frame, frame_len);
+        free (frame);
+    } else if (mapped) {
+        rc = ctx->dtl_handle->send_mapped (ctx, (void *)data, len);
+    } else {
+        rc = ctx->dtl_handle->send (ctx, (void *)data, len);
+    }
+    dyad_stats_record (DYAD_STATS_MOD_SEND, t0);
+    return rc;
+}
+
+/**
+ * @brief Sends @p file_size bytes of @p fd, starting at offset @p start, to
+ *        the consumer in chunks of @p chunk_size bytes over an already
+ *        established DTL connection.
+ *
+ * @details
+ * Each chunk is read into @p chunk and sent with the DTL's @c send(), or,
+ * if @p data is given, handed to @c send_mapped() straight from @p data.
+ * Chunks are compressed one by one if negotiated with the consumer.
+ *
+ * @param[in] ctx         DYAD context of the module.
+ * @param[in] fd          File descriptor opened for reading and locked.
+ *                        Unused if @p data is given.
+ * @param[in] data        Contents of the whole file already in memory, or
+ *                        @c NULL to read @p fd instead.
+ * @param[in] chunk       Buffer of at least @p chunk_size bytes. Unused if
+ *                        @p data is given.
+ * @param[in] start       File offset of the first byte to send.
+ * @param[in] file_size   Number of bytes to send.
+ * @param[in] chunk_size  Maximum number of bytes per message, before
+ *                        compression.
+ * @param[in] codec       Compression negotiated with the consumer.
+ *
+ * @return @c dyad_rc_t return code:
+ * @retval DYAD_RC_OK       The whole file was sent.
+ * @retval DYAD_RC_BADFIO   The file could not be read. @c errno is set.
+ * @retval DYAD_RC_*        Any error code propagated from the DTL, with
+ *                          @c errno set to @c ECOMM.
+ */
+static dyad_rc_t dyad_mod_send_data (const dyad_ctx_t *ctx,
+                                     int fd,
+                                     const char *data,
+                                     char *chunk,
+                                     ssize_t start,
+                                     ssize_t file_size,
+                                     ssize_t chunk_size,
+                                     const dyad_mod_codec_t *codec)
+{
+    dyad_rc_t rc = DYAD_RC_OK;
+    ssize_t offset = 0l;
+    ssize_t len = 0l;
+    int errnum = 0;
+
+    for (offset = 0l; offset < file_size; offset += len) {
+        len = (file_size - offset) > chunk_size ? chunk_size : (file_size - offset);
+        if (data != NULL) {
+            rc = dyad_mod_send_msg (ctx, codec, data + start + offset, len, true);
+        } else if (dyad_mod_read_fd (ctx, fd, chunk, len, start + offset) != len) {
+            errnum = errno;
+            DYAD_LOG_ERROR (ctx,
+                            "DYAD_MOD: Failed to read %zd bytes at offset %zd with code %d:%s.",
+                            len,
+                            start + offset,
+                            errnum,
+                            strerror (errnum));
+            errno = errnum;
+            return DYAD_RC_BADFIO;
+        } else {
+            rc = dyad_mod_send_msg (ctx, codec, chunk, len, false);
+        }
+        if (DYAD_IS_ERROR (rc)) {
+            DYAD_LOG_ERROR (ctx, "DYAD_MOD: Could not send data to client via DTL\n");
+            errno = ECOMM;
+            return rc;
+        }
+    }
+    DYAD_LOG_DEBUG (ctx, "DYAD_MOD: Sent %zd bytes in chunks of %zd", offset, chunk_size);
+    return DYAD_RC_OK;
+}
+
+/**
+ * @brief Streams @p file_size bytes of @p fd, starting at offset @p start,
+ *        to the consumer in chunks of @p chunk_size bytes.
+ *
+ * @details
+ * Only a single buffer of @p chunk_size bytes is allocated. The next chunk
+ * is read while the previous response is still being forwarded by the
+ * broker, since @c flux_respond_raw() copies the data and returns without
+ * waiting for delivery. The DTL request state must already have been set
+ * up with @c rpc_unpack() and @c rpc_respond().
+ *
+ * If @p data is given, no buffer is allocated and each chunk is handed to
+ * the DTL's @c send_mapped() straight from @p data. A @p chunk_size of
+ * @p file_size then sends the whole file at once.
+ *
+ * @param[in] ctx         DYAD context of the module.
+ * @param[in] fd          File descriptor opened for reading and locked.
+ *                        Unused if @p data is given.
+ * @param[in] data        Contents of the whole file already in memory,
+ *                        i.e., a mapping from @c dyad_mod_map_fd() or a
+ *                        cached copy, or @c NULL to read @p fd instead.
+ * @param[in] start       File offset of the first byte to send.
+ * @param[in] file_size   Number of bytes to send.
+ * @param[in] chunk_size  Maximum number of bytes per message.
+ * @param[in] codec       Compression negotiated with the consumer.
+ *
+ * @return @c dyad_rc_t return code:
+ * @retval DYAD_RC_OK       The whole file was sent.
+ * @retval DYAD_RC_BADFIO   The file could not be read. @c errno is set.
+ * @retval DYAD_RC_*        Any error code propagated from the DTL, with
+ *                          @c errno set to @c ECOMM or @c ECONNREFUSED.
+ */
+static dyad_rc_t dyad_mod_send_chunks (const dyad_ctx_t *ctx,
+                                       int fd,
+                                       const char *data,
+                                       ssize_t start,
+                                       ssize_t file_size,
+                                       ssize_t chunk_size,
+                                       const dyad_mod_codec_t *codec)
+{
+    DYAD_C_FUNCTION_START ();
+    DYAD_C_FUNCTION_UPDATE_INT ("chunk_size", chunk_size);
+    dyad_rc_t rc = DYAD_RC_OK;
+    char *chunk = NULL;
+    int errnum = 0;
+
+    if (data == NULL) {
+        rc = ctx->dtl_handle->get_buffer (ctx, chunk_size, (void **)&chunk);
+        if (DYAD_IS_ERROR (rc)) {
+            DYAD_LOG_ERROR (ctx, "DYAD_MOD: Could not allocate a %zd byte chunk", chunk_size);
+            errno = ENOMEM;
+            goto send_chunks_done;
+        }
+    }
+    DYAD_LOG_DEBUG (ctx, "DYAD_MOD: Establish DTL connection with consumer");
+    rc = ctx->dtl_handle->establish_connection (ctx);
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (ctx, "DYAD_MOD: Could not establish DTL connection with client");
+        errnum = ECONNREFUSED;
+        goto send_chunks_return;
+    }
+    rc = dyad_mod_send_data (ctx, fd, data, chunk, start, file_size, chunk_size, codec);
+    if (DYAD_IS_ERROR (rc)) {
+        errnum = errno;
+    }
+    ctx->dtl_handle->close_connection (ctx);
+
+send_chunks_return:;
+    if (chunk != NULL) {
+        ctx->dtl_handle->return_buffer (ctx, (void **)&chunk);
+    }
+    if (errnum != 0) {
+        errno = errnum;
+    }
+
+send_chunks_done:;
+    DYAD_C_FUNCTION_END ();
+    return rc;
+}
+
+/**
+ * @brief Maps the return code of @c rpc_unpack() to the @c errno value
+ *        reported to the consumer.
+ *
+ * @details
+ * A request naming a consumer the DTL does not know, e.g., after a reload
+ * of the module, is reported as @c ESTALE, so that the consumer registers
+ * again and sends it once more. Anything else is a malformed request.
+ */
+static int dyad_mod_unpack_errno (dyad_rc_t rc)
+{
+    return (rc == DYAD_RC_NOTFOUND) ? ESTALE : EPROTO;
+}
+
+/**
+ * @brief A fetch request handed to the module's worker pool.
+ *
+ * @details
+ * Created on the reactor by @c dyad_fetch_submit(), filled in by
+ * @c dyad_fetch_job_load() on a worker thread, and completed and freed by
+ * @c dyad_fetch_job_complete() back on the reactor.
+ */
+typedef struct dyad_fetch_job {
+    const flux_msg_t *msg;         ///< Reference to the consumer's request.
+    char fullpath[PATH_MAX + 1];   ///< Producer-side path of the requested file.
+    char *buf;                     ///< Loaded data, or @c NULL.
+    char *map;                     ///< Mapping of the whole file in zero-copy mode, or @c NULL.
+    dyad_mod_cache_ref_t *cached;  ///< Cache entry the file is sent from, or @c NULL.
+    const char *data;              ///< Whole file in memory (@c map or cached copy), or @c NULL.
+    ssize_t file_size;             ///< Size of the file in bytes.
+    ssize_t inlen;                 ///< Number of bytes of @c buf to send.
+    ssize_t chunk_size;            ///< Bytes per message, or 0 to send the whole range at once.
+    ssize_t offset;                ///< File offset following the last loaded chunk.
+    ssize_t range_length;          ///< Bytes requested, or 0 for the rest of the file until loaded.
+    ssize_t end;                   ///< File offset following the last byte to send.
+    dyad_mod_codec_t codec;        ///< Compression negotiated with the consumer.
+    char *frame;                   ///< Compressed form of the loaded message, or @c NULL.
+    ssize_t frame_len;             ///< Size of @c frame.
+    int fd;                        ///< Open and locked between chunks or while mapped, else -1.
+    uint64_t queued;               ///< When the job was last queued, for @c DYAD_STATS_MOD_QUEUE.
+    bool responded;                ///< Whether @c rpc_respond() was called.
+    bool sent;                     ///< Whether a worker sent the loaded data through a lane.
+    /**
+     * 0 once the file has been loaded, the @c errno value to report to the
+     * consumer otherwise. Initialized to @c ECANCELED so that jobs dropped
+     * by @c dyad_mod_pool_destroy() before running are reported as such.
+     */
+    int errnum;
+} dyad_fetch_job_t;
+
+/**
+ * @brief Worker-side transfer of a loaded chunk through a lane.
+ *
+ * @details
+ * Runs on a pool worker thread, right after @c dyad_fetch_job_load(), when
+ * the module has lanes, so that the transfers to several consumers proceed
+ * at the same time rather than one after another on the reactor. The
+ * request is unpacked with the DTL handle of the lane, which the worker
+ * holds until the chunk is sent. On success, @c job->sent is set and the
+ * reactor only closes the RPC stream or resubmits the job. Otherwise,
+ * @c job->errnum is set to the @c errno value to report to the consumer.
+ *
+ * @param[in,out] job    The loaded @c dyad_fetch_job_t.
+ * @param[in]     lanes  Lanes of the module.
+ */
+static void dyad_fetch_job_send (dyad_fetch_job_t *job, dyad_mod_lanes_t *lanes)
+{
+    DYAD_C_FUNCTION_START ();
+    dyad_ctx_t *lane = dyad_mod_lanes_acquire (lanes);
+    char *upath = NULL;
+    uint64_t t0 = 0ull;
+    dyad_rc_t rc = DYAD_RC_OK;
+
+    rc = lane->dtl_handle->rpc_unpack (lane, job->msg, &upath);
+    if (DYAD_IS_ERROR (rc)) {
+        job->errnum = dyad_mod_unpack_errno (rc);
+        goto job_send_done;
+    }
+    rc = lane->dtl_handle->establish_connection (lane);
+    if (DYAD_IS_ERROR (rc)) {
+        job->errnum = ECONNREFUSED;
+        goto job_send_done;
+    }
+    t0 = dyad_stats_now ();
+    if (job->frame != NULL) {
+        rc = lane->dtl_handle->send (lane, job->frame, job->frame_len);
+        free (job->frame);
+        job->frame = NULL;
+    } else if (job->data != NULL) {
+        rc = lane->dtl_handle->send_mapped (lane,
+                                            (void *)(job->data + job->offset - job->inlen),
+                                            job->inlen);
+    } else {
+        rc = lane->dtl_handle->send (lane, job->buf, job->inlen);
+    }
+    dyad_stats_record (DYAD_STATS_MOD_SEND, t0);
+    lane->dtl_handle->close_connection (lane);
+    if (DYAD_IS_ERROR (rc)) {
+        job->errnum = ECOMM;
+        goto job_send_done;
+    }
+    job->sent = true;
+
+job_send_done:;
+    dyad_mod_lanes_release (lanes, lane);
+    DYAD_C_FUNCTION_END ();
+}
+
+/**
+ * @brief Worker-side half of a pooled fetch: open, lock and read the file.
+ *
+ * @details
+ * Runs on a pool worker thread. Must not touch the Flux handle or the DTL
+ * handle of the module, and does not log, since neither is thread-safe.
+ * The outcome is recorded in @c job->errnum and reported by
+ * @c dyad_fetch_job_complete(). If the module has lanes, the loaded data
+ * is then sent through one of them by @c dyad_fetch_job_send().
+ *
+ * For a chunked transfer, each call loads only the next chunk. The file
+ * stays open and locked in @c job->fd until its last chunk has been
+ * loaded, so that the job can be resubmitted for the following chunk
+ * once the current one has been sent.
+ *
+ * In zero-copy mode the file is mapped instead of read, and "loading" a
+ * chunk only faults it in. The file then stays open and locked until
+ * @c dyad_fetch_job_complete() has sent its last chunk and unmapped it.
+ * If the file cannot be mapped, it is read as usual.
+ *
+ * If the file cache holds a current copy of the file, the file is not
+ * opened at all and every chunk is sent from that copy. Otherwise, files
+ * loaded in one piece are added to the cache.
+ *
+ * For a byte-range request, @c job->offset starts at the first requested
+ * byte, and only the range up to @c job->end is loaded and sent. Ranges
+ * are never added to the cache, but can be served from it.
+ *
+ * If the consumer asked for compression, the loaded message is also
+ * compressed into @c job->frame here, off the reactor.
+ *
+ * @param[in,out] arg_job  The @c dyad_fetch_job_t to load.
+ * @param[in]     arg      The @c dyad_mod_ctx_t of the module. Only its
+ *                         @c zero_copy flag, its thread-safe @c cache and
+ *                         @c lanes, and the I/O engine of its context,
+ *                         which never change after load time, are used.
+ */
+static void dyad_fetch_job_load (void *arg_job, void *arg)
+{
+    DYAD_C_FUNCTION_START ();
+    dyad_fetch_job_t *job = (dyad_fetch_job_t *)arg_job;
+    const dyad_mod_ctx_t *mod_ctx = (const dyad_mod_ctx_t *)arg;
+    struct flock shared_lock;
+    ssize_t len = 0l;
+
+    dyad_stats_record (DYAD_STATS_MOD_QUEUE, job->queued);
+    memset (&shared_lock, 0, sizeof (shared_lock));
+    shared_lock.l_whence = SEEK_SET;
+    if (job->fd < 0 && job->data == NULL
+        && dyad_mod_find_cached (mod_ctx,
+                                 job->fullpath,
+                                 &job->cached,
+                                 &job->data,
+                                 &job->file_size)) {
+        job->errnum = dyad_mod_clamp_range (job->file_size, job->offset, &job->range_length);
+        if (job->errnum != 0) {
+            goto load_done;
+        }
+        job->end = job->offset + job->range_length;
+        if (job->chunk_size >= job->range_length) {
+            job->chunk_size = 0l;
+        }
+    } else if (job->fd < 0 && job->data == NULL) {
+        job->fd = open (job->fullpath, O_RDONLY | O_CLOEXEC);
+        if (job->fd < 0) {
+            job->errnum = errno;
+            goto load_done;
+        }
+        shared_lock.l_type = F_RDLCK;
+        if (fcntl (job->fd, DYAD_MOD_SETLKW, &shared_lock) == -1) {
+            job->errnum = errno;
+            goto load_close;
+        }
+        job->file_size = get_file_size (job->fd);
+        if (job->file_size < 0l || (job->file_size == 0l && job->offset > 0l)) {
+            job->errnum = EINVAL;
+            goto load_unlock;
+        }
+        if (job->file_size == 0l) {
+            // An empty file is sent as a single empty message
+            job->range_length = 0l;
+            job->end = 0l;
+            job->chunk_size = 0l;
+            job->inlen = 0l;
+            job->errnum = 0;
+            goto load_unlock;
+        }
+        job->errnum = dyad_mod_clamp_range (job->file_size, job->offset, &job->range_length);
+        if (job->errnum != 0) {
+            goto load_unlock;
+        }
+        job->end = job->offset + job->range_length;
+        if (job->chunk_size >= job->range_length) {
+            job->chunk_size = 0l;
+        }
+        if (mod_ctx->zero_copy) {
+            job->map = dyad_mod_map_fd (job->fd, job->file_size);
+            job->data = job->map;
+        }
+        if (job->map == NULL) {
+            len = (job->chunk_size > 0l) ? job->chunk_size : job->range_length;
+            job->buf = (char *)malloc (len);
+            if (job->buf == NULL) {
+                job->errnum = ENOMEM;
+                goto load_unlock;
+            }
+        }
+    }
+    if (job->data != NULL) {
+        len = (job->chunk_size > 0l && (job->end - job->offset) > job->chunk_size)
+                  ? job->chunk_size
+                  : (job->end - job->offset);
+        if (job->map != NULL) {
+            dyad_mod_prefault (job->map + job->offset, len);
+            if (job->chunk_size == 0l && job->range_length == job->file_size) {
+                dyad_mod_cache_file (mod_ctx, job->fullpath, job->fd, job->map, job->file_size);
+            }
+        }
+        job->inlen = len;
+        job->offset += len;
+        job->errnum = 0;
+        goto load_done;
+    }
+    if (job->chunk_size > 0l) {
+        len = (job->end - job->offset) > job->chunk_size ? job->chunk_size
+                                                         : (job->end - job->offset);
+        if (dyad_mod_read_fd (mod_ctx->ctx, job->fd, job->buf, len, job->offset) != len) {
+            job->errnum = errno;
+            goto load_unlock;
+        }
+        job->inlen = len;
+        job->offset += len;
+        job->errnum = 0;
+        if (job->offset < job->end) {
+            goto load_done;
+        }
+        goto load_unlock;
+    }
+    if (dyad_mod_read_fd (mod_ctx->ctx, job->fd, job->buf, job->range_length, job->offset)
+        != job->range_length) {
+        job->errnum = errno;
+        free (job->buf);
+        job->buf = NULL;
+        goto load_unlock;
+    }
+    if (job->range_length == job->file_size) {
+        dyad_mod_cache_file (mod_ctx, job->fullpath, job->fd, job->buf, job->file_size);
+    }
+    job->inlen = job->range_length;
+    job->offset = job->end;
+    job->errnum = 0;
+
+load_unlock:;
+    shared_lock.l_type = F_UNLCK;
+    fcntl (job->fd, DYAD_MOD_SETLKW, &shared_lock);
+load_close:;
+    close (job->fd);
+    job->fd = -1;
+load_done:;
+    if (job->errnum == 0) {
+        job->errnum = dyad_mod_encode (&job->codec,
+                                       (job->data != NULL) ? job->data + job->offset - job->inlen
+                                                           : job->buf,
+                                       job->inlen,
+                                       &job->frame,
+                                       &job->frame_len);
+    }
+    if (job->errnum == 0 && mod_ctx->lanes != NULL) {
+        dyad_fetch_job_send (job, mod_ctx->lanes);
+    }
+    DYAD_C_FUNCTION_END ();
+}
+
+/**
+ * @brief Reactor-side half of a pooled fetch: transfer the loaded data and
+ *        close the consumer's RPC stream.
+ *
+ * @details
+ * Runs on the reactor thread. The DTL-specific part of the request is
+ * unpacked here rather than in @c dyad_fetch_request_cb(), because the
+ * DTL handle keeps per-request state (e.g., the consumer's UCX address
+ * and rkey) that would otherwise be overwritten by requests arriving
+ * while this one was queued. For the same reason it is unpacked again
+ * for every chunk of a chunked transfer.
+ *
+ * If a worker already sent the chunk through a lane, only the rest of the
+ * job is done here.
+ *
+ * If the file still has chunks left to load, the job is resubmitted to
+ * the pool, behind the requests queued in the meantime, so that a large
+ * file does not hold up smaller ones. Otherwise the RPC stream is closed,
+ * a mapped file is unmapped and unlocked, a cached copy is released, and
+ * the job is freed before returning.
+ *
+ * @param[in] arg_job  The @c dyad_fetch_job_t to complete.
+ * @param[in] arg      The @c dyad_mod_ctx_t of the module.
+ */
+static void dyad_fetch_job_complete (void *arg_job, void *arg)
+{
+    DYAD_C_FUNCTION_START ();
+    dyad_fetch_job_t *job = (dyad_fetch_job_t *)arg_job;
+    dyad_mod_ctx_t *mod_ctx = (dyad_mod_ctx_t *)arg;
+    flux_t *h = mod_ctx->ctx->h;
+    char *upath = NULL;
+    int errnum = job->errnum;
+    uint64_t t0 = 0ull;
+    dyad_rc_t rc = DYAD_RC_OK;
+
+    DYAD_C_FUNCTION_UPDATE_STR ("fullpath", job->fullpath);
+    if (errnum != 0) {
+        DYAD_LOG_ERROR (mod_ctx->ctx,
+                        "DYAD_MOD: Failed to load or send file \"%s\" with code %d:%s.",
+                        job->fullpath,
+                        errnum,
+                        strerror (errnum));
+        goto complete_error;
+    }
+    if (job->sent) {
+        // A worker already sent the chunk through a lane. Lanes are only
+        // used with the UCX DTL, whose rpc_respond() does nothing.
+        job->sent = false;
+        goto complete_sent;
+    }
+    rc = mod_ctx->ctx->dtl_handle->rpc_unpack (mod_ctx->ctx, job->msg, &upath);
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: Could not unpack message from client");
+        errnum = dyad_mod_unpack_errno (rc);
+        goto complete_error;
+    }
+    if (!job->responded) {
+        rc = mod_ctx->ctx->dtl_handle->rpc_respond (mod_ctx->ctx, job->msg);
+        if (DYAD_IS_ERROR (rc)) {
+            DYAD_LOG_ERROR (mod_ctx->ctx,
+                            "DYAD_MOD: Could not send primary RPC response to client");
+            errnum = ECOMM;
+            goto complete_error;
+        }
+        job->responded = true;
+    }
+    DYAD_C_FUNCTION_UPDATE_INT ("file_size", job->file_size);
+    DYAD_LOG_DEBUG (mod_ctx->ctx, "DYAD_MOD: Establish DTL connection with consumer");
+    rc = mod_ctx->ctx->dtl_handle->establish_connection (mod_ctx->ctx);
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: Could not establish DTL connection with client");
+        errnum = ECONNREFUSED;
+        goto complete_error;
+    }
+    DYAD_LOG_DEBUG (mod_ctx->ctx, "DYAD_MOD: Send file to consumer with DTL");
+    t0 = dyad_stats_now ();
+    if (job->frame != NULL) {
+        rc = mod_ctx->ctx->dtl_handle->send (mod_ctx->ctx, job->frame, job->frame_len);
+        free (job->frame);
+        job->frame = NULL;
+    } else if (job->data != NULL) {
+        rc = mod_ctx->ctx->dtl_handle->send_mapped (mod_ctx->ctx,
+                                                    (void *)(job->data + job->offset - job->inlen),
+                                                    job->inlen);
+    } else {
+        rc = mod_ctx->ctx->dtl_handle->send (mod_ctx->ctx, job->buf, job->inlen);
+    }
+    dyad_stats_record (DYAD_STATS_MOD_SEND, t0);
+    mod_ctx->ctx->dtl_handle->close_connection (mod_ctx->ctx);
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: Could not send data to client via DTL\n");
+        errnum = ECOMM;
+        goto complete_error;
+    }
+
+complete_sent:;
+    if (job->chunk_size > 0l && job->offset < job->end) {
+        // More chunks to go. Let a worker load the next one.
+        job->errnum = ECANCELED;
+        job->queued = dyad_stats_now ();
+        if (DYAD_IS_ERROR (dyad_mod_pool_submit (mod_ctx->pool, job))) {
+            DYAD_LOG_ERROR (mod_ctx->ctx,
+                            "DYAD_MOD: Could not queue the next chunk of %s",
+                            job->fullpath);
+            errnum = EAGAIN;
+            goto complete_error;
+        }
+        goto complete_requeued;
+    }
+    if (flux_respond_error (h, job->msg, ENODATA, NULL) < 0) {
+        DYAD_LOG_DEBUG (mod_ctx->ctx,
+                        "DYAD_MOD: %s: flux_respond_error with ENODATA failed\n",
+                        __func__);
+    }
+    goto complete_done;
+
+complete_error:;
+    DYAD_LOG_ERROR (mod_ctx->ctx,
+                    "DYAD_MOD: Close RPC message stream with an error (errno = %d)\n",
+                    errnum);
+    if (flux_respond_error (h, job->msg, errnum, NULL) < 0) {
+        DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: %s: flux_respond_error", __func__);
+    }
+
+complete_done:;
+    dyad_mod_cache_release (mod_ctx->cache, job->cached);
+    job->cached = NULL;
+    if (job->map != NULL) {
+        munmap (job->map, (size_t)job->file_size);
+        job->map = NULL;
+    }
+    if (job->fd >= 0) {
+        // Closing the descriptor also drops its lock
+        close (job->fd);
+        job->fd = -1;
+    }
+    free (job->frame);
+    free (job->buf);
+    flux_msg_decref (job->msg);
+    free (job);
+
+complete_requeued:;
+    DYAD_C_FUNCTION_END ();
+}
+
+/**
+ * @brief Hands a fetch request over to the module's worker pool.
+ *
+ * @details
+ * Only the relative path is extracted from the request here, using the
+ * @c "upath" key that every DTL places in its payload. A reference to the
+ * message is kept until @c dyad_fetch_job_complete() responds to it. If
+ * the request cannot be queued, e.g., because as many requests as
+ * @c DYAD_MOD_QUEUE_SIZE already wait for a worker, the consumer receives
+ * an error response right away, @c EAGAIN in that case.
+ *
+ * @param[in] h        Flux handle for the broker.
+ * @param[in] mod_ctx  Module context with a non-@c NULL @c pool.
+ * @param[in] msg      The consumer's fetch request.
+ */
+static void dyad_fetch_submit (flux_t *h, dyad_mod_ctx_t *mod_ctx, const flux_msg_t *msg)
+{
+    DYAD_C_FUNCTION_START ();
+    const char *upath = NULL;
+    dyad_fetch_job_t *job = NULL;
+    int errnum = 0;
+
+    if (flux_request_unpack (msg, NULL, "{s:s}", "upath", &upath) < 0) {
+        DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: Could not unpack message from client");
+        errnum = EPROTO;
+        goto submit_error;
+    }
+    DYAD_C_FUNCTION_UPDATE_STR ("upath", upath);
+    if (dyad_mod_pool_full (mod_ctx->pool)) {
+        DYAD_LOG_WARN (mod_ctx->ctx, "DYAD_MOD: Too many queued fetches, turning %s away", upath);
+        errnum = EAGAIN;
+        goto submit_error;
+    }
+    job = (dyad_fetch_job_t *)calloc (1, sizeof (*job));
+    if (job == NULL) {
+        errnum = ENOMEM;
+        goto submit_error;
+    }
+    strncpy (job->fullpath, mod_ctx->ctx->prod_managed_path, PATH_MAX - 1);
+    concat_str (job->fullpath, upath, "/", PATH_MAX);
+    job->errnum = ECANCELED;
+    job->fd = -1;
+    job->chunk_size = dyad_mod_chunk_size (mod_ctx->ctx, msg);
+    if (!dyad_mod_byte_range (msg, &job->offset, &job->range_length)) {
+        DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: Invalid byte range requested by client");
+        free (job);
+        errnum = EPROTO;
+        goto submit_error;
+    }
+    dyad_mod_codec (mod_ctx->ctx, msg, &job->codec);
+    job->msg = flux_msg_incref (msg);
+    DYAD_LOG_DEBUG (mod_ctx->ctx, "DYAD_MOD: Queueing %s for a fetch worker", job->fullpath);
+    job->queued = dyad_stats_now ();
+    if (DYAD_IS_ERROR (dyad_mod_pool_submit (mod_ctx->pool, job))) {
+        DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: Could not queue fetch of %s", job->fullpath);
+        flux_msg_decref (job->msg);
+        free (job);
+        errnum = EAGAIN;
+        goto submit_error;
+    }
+    goto submit_done;
+
+submit_error:;
+    if (flux_respond_error (h, msg, errnum, NULL) < 0) {
+        DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: %s: flux_respond_error", __func__);
+    }
+
+submit_done:;
+    DYAD_C_FUNCTION_END ();
+}
+
 /**
  * @brief Flux message handler callback that serves file data to a consumer
  *        via RPC.
@@ -221,13 +1320,40 @@ getctx_done:
  * @c flux_respond_error() and returns. The shared lock and file descriptor
  * are released before returning in all error paths.
  *
- * When built with UCX DTL support (@c DYAD_ENABLE_UCX_DTL), the file size
- * is prepended to the DTL buffer so the consumer can locate the data
- * boundary without an additional RMA call.
+ * If the consumer asked for a chunked transfer (@c DYAD_TRANSFER_CHUNK_SIZE
+ * on the consumer side, see @c dyad_mod_chunk_size()) and the file is
+ * larger than one chunk, steps 6 and 7 are replaced by
+ * @c dyad_mod_send_chunks(), which reads and sends one chunk at a time
+ * through a single chunk-sized buffer.
+ *
+ * In zero-copy mode (@c -z or @c DYAD_MOD_ZERO_COPY), the file is mapped
+ * with @c dyad_mod_map_fd() and @c dyad_mod_send_chunks() passes it to
+ * the DTL's @c send_mapped() without reading it into a buffer. The shared
+ * lock is then held until the data has been sent. Files that cannot be
+ * mapped are read as usual.
+ *
+ * With the file cache enabled (@c -c or @c DYAD_MOD_CACHE_SIZE), steps 5
+ * and 6 are skipped for files whose cached copy is still current, which
+ * is then sent the same way as a mapped file. Files loaded in one piece
+ * are added to the cache while their shared lock is still held.
+ *
+ * If the payload carries a byte range (see @c dyad_mod_byte_range()), only
+ * that part of the file is read and sent. A range starting beyond the end
+ * of the file is answered with @c EINVAL.
+ *
+ * If the consumer asked for compression (see @c dyad_mod_codec()), every
+ * message is compressed right before it is handed to the DTL.
  *
  * When built with @c DYAD_SPIN_WAIT, spins on @c get_stat() before
  * opening the file to wait for it to become accessible.
  *
+ * When the module was loaded with fetch workers (@c -w or
+ * @c DYAD_MOD_WORKERS), only step 1 runs here. The request is then
+ * passed to @c dyad_fetch_submit(), the file is loaded by a worker
+ * thread, and steps 2, 3, 7 and 8 run on the reactor once the load has
+ * finished (@c dyad_fetch_job_complete()). The reactor is therefore never
+ * blocked on file I/O, and a large file does not hold up other consumers.
+ *
  * @param[in] h    Flux handle for the broker.
  * @param[in] w    Flux message handler (unused directly).
  * @param[in] msg  Incoming Flux RPC message containing the file path
@@ -260,6 +1386,14 @@ dyad_fetch_request_cb (flux_t *h, flux_msg_handler_t *w, const flux_msg_t *msg,
     char fullpath[PATH_MAX + 1] = {'\0'};
     int saved_errno = errno;
     ssize_t file_size = 0l;
+    ssize_t chunk_size = 0l;
+    ssize_t range_offset = 0l;
+    ssize_t range_length = 0l;
+    char *map = NULL;
+    dyad_mod_cache_ref_t *cached = NULL;
+    const char *cached_data = NULL;
+    dyad_mod_codec_t codec;
+    int send_errno = 0;
     dyad_rc_t rc = 0;
     struct flock shared_lock;
     if (!flux_msg_is_streaming (msg)) {
@@ -270,13 +1404,18 @@ dyad_fetch_request_cb (flux_t *h, flux_msg_handler_t *w, const flux_msg_t *msg,
     if (flux_msg_get_userid (msg, &userid) < 0)
         goto fetch_error_wo_flock;
 
+    if (mod_ctx->pool != NULL) {
+        dyad_fetch_submit (h, mod_ctx, msg);
+        goto end_fetch_cb;
+    }
+
     DYAD_LOG_DEBUG (mod_ctx->ctx, "DYAD_MOD: unpacking RPC message");
 
     rc = mod_ctx->ctx->dtl_handle->rpc_unpack (mod_ctx->ctx, msg, &upath);
 
     if (DYAD_IS_ERROR (rc)) {
         DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: Could not unpack message from client");
-        errno = EPROTO;
+        errno = dyad_mod_unpack_errno (rc);
         goto fetch_error_wo_flock;
     }
     DYAD_C_FUNCTION_UPDATE_STR ("upath", upath);
@@ -292,6 +1431,12 @@ dyad_fetch_request_cb (flux_t *h, flux_msg_handler_t *w, const flux_msg_t *msg,
     strncpy (fullpath, mod_ctx->ctx->prod_managed_path, PATH_MAX - 1);
     concat_str (fullpath, upath, "/", PATH_MAX);
     DYAD_C_FUNCTION_UPDATE_STR ("fullpath", fullpath);
+    if (!dyad_mod_byte_range (msg, &range_offset, &range_length)) {
+        DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: Invalid byte range requested by client");
+        errno = EPROTO;
+        goto fetch_error_wo_flock;
+    }
+    dyad_mod_codec (mod_ctx->ctx, msg, &codec);
 
 #if DYAD_SPIN_WAIT
     if (!get_stat (fullpath, 1000U, 1000L)) {
@@ -300,6 +1445,35 @@ dyad_fetch_request_cb (flux_t *h, flux_msg_handler_t *w, const flux_msg_t *msg,
     }
 #endif  // DYAD_SPIN_WAIT
 
+    if (dyad_mod_find_cached (mod_ctx, fullpath, &cached, &cached_data, &file_size)) {
+        DYAD_LOG_DEBUG (mod_ctx->ctx, "DYAD_MOD: Sending file %s from the file cache", fullpath);
+        DYAD_C_FUNCTION_UPDATE_INT ("file_size", file_size);
+        send_errno = dyad_mod_clamp_range (file_size, range_offset, &range_length);
+        if (send_errno != 0) {
+            dyad_mod_cache_release (mod_ctx->cache, cached);
+            errno = send_errno;
+            goto fetch_error_wo_flock;
+        }
+        chunk_size = dyad_mod_chunk_size (mod_ctx->ctx, msg);
+        if (chunk_size <= 0l || chunk_size > range_length) {
+            chunk_size = range_length;
+        }
+        rc = dyad_mod_send_chunks (mod_ctx->ctx,
+                                   -1,
+                                   cached_data,
+                                   range_offset,
+                                   range_length,
+                                   chunk_size,
+                                   &codec);
+        send_errno = errno;
+        dyad_mod_cache_release (mod_ctx->cache, cached);
+        if (DYAD_IS_ERROR (rc)) {
+            errno = send_errno;
+            goto fetch_error_wo_flock;
+        }
+        goto fetch_sent;
+    }
+
     DYAD_LOG_DEBUG (mod_ctx->ctx, "DYAD_MOD: Reading file %s for transfer", fullpath);
     fd = open (fullpath, O_RDONLY);
 
@@ -313,62 +1487,78 @@ dyad_fetch_request_cb (flux_t *h, flux_msg_handler_t *w, const flux_msg_t *msg,
     }
     file_size = get_file_size (fd);
     DYAD_LOG_DEBUG (mod_ctx->ctx, "DYAD_MOD: file %s has size %zd", fullpath, file_size);
-    // clang-format off
-#ifdef DYAD_ENABLE_UCX_DTL
-    // For UCX RMA, prepend file_size so the consumer can find the data boundary
-    // in the shared buffer without an extra RMA call.
-    const size_t buf_offset = sizeof (file_size);
-#else
-    const size_t buf_offset = 0;
-#endif
-    // clang-format on
-    rc = mod_ctx->ctx->dtl_handle->get_buffer (mod_ctx->ctx, file_size, (void **)&inbuf);
-#ifdef DYAD_ENABLE_UCX_DTL
-    memcpy (inbuf, &file_size, sizeof (file_size));
-#endif
-    if (file_size > 0l) {
-        if (file_size < DYAD_POSIX_TRANSFER_GRANULARITY) {
-            inlen = read (fd, inbuf + buf_offset, file_size);
-        } else {
-            ssize_t read_data = 0;
-            int granularity = DYAD_POSIX_TRANSFER_GRANULARITY;
-            while (read_data < file_size) {
-                ssize_t read_size =
-                    (file_size - read_data) > granularity ? granularity : (file_size - read_data);
-                inlen = read (fd, inbuf + buf_offset + read_data, read_size);
-                DYAD_LOG_DEBUG (mod_ctx->ctx,
-                                "DYAD_MOD: reading file %s with bytes %zd of %zd",
-                                fullpath,
-                                read_size,
-                                inlen);
-                if (inlen <= 0) {
-                    DYAD_LOG_ERROR (mod_ctx->ctx,
-                                    "DYAD_MOD: Failed to load file \"%s\" only read %zd of %zd of "
-                                    "%zd. with code %d:%s.",
-                                    fullpath,
-                                    inlen,
-                                    read_size,
-                                    file_size,
-                                    errno,
-                                    strerror (errno));
-                    goto fetch_error;
-                }
-                read_data += inlen;
+    if (file_size > 0l && dyad_mod_clamp_range (file_size, range_offset, &range_length) != 0) {
+        DYAD_LOG_ERROR (mod_ctx->ctx,
+                        "DYAD_MOD: Requested offset %zd is beyond the end of \"%s\"",
+                        range_offset,
+                        fullpath);
+        errno = EINVAL;
+        goto fetch_error;
+    }
+    chunk_size = dyad_mod_chunk_size (mod_ctx->ctx, msg);
+    if (chunk_size <= 0l || chunk_size > range_length) {
+        chunk_size = range_length;
+    }
+    if (file_size > 0l && mod_ctx->zero_copy) {
+        map = dyad_mod_map_fd (fd, file_size);
+        if (map == NULL) {
+            DYAD_LOG_DEBUG (mod_ctx->ctx,
+                            "DYAD_MOD: Cannot map \"%s\" (%s), reading it instead",
+                            fullpath,
+                            strerror (errno));
+        }
+    }
+    if (file_size > 0l && (chunk_size < range_length || map != NULL)) {
+        DYAD_C_FUNCTION_UPDATE_INT ("file_size", file_size);
+        DYAD_LOG_DEBUG (mod_ctx->ctx, "DYAD_MOD: Send file to consumer in chunks with DTL");
+        rc = dyad_mod_send_chunks (mod_ctx->ctx,
+                                   fd,
+                                   map,
+                                   range_offset,
+                                   range_length,
+                                   chunk_size,
+                                   &codec);
+        send_errno = errno;
+        if (map != NULL) {
+            if (!DYAD_IS_ERROR (rc) && chunk_size == file_size) {
+                dyad_mod_cache_file (mod_ctx, fullpath, fd, map, file_size);
             }
-            inlen = read_data;
+            munmap (map, (size_t)file_size);
+        }
+        dyad_release_flock (mod_ctx->ctx, fd, &shared_lock);
+        close (fd);
+        if (DYAD_IS_ERROR (rc)) {
+            errno = send_errno;
+            goto fetch_error_wo_flock;
+        }
+    } else if (file_size > 0l) {
+        rc = mod_ctx->ctx->dtl_handle->get_buffer (mod_ctx->ctx, range_length, (void **)&inbuf);
+        if (DYAD_IS_ERROR (rc)) {
+            DYAD_LOG_ERROR (mod_ctx->ctx,
+                            "DYAD_MOD: Could not get a DTL buffer of %zd bytes",
+                            range_length);
+            errno = ENOMEM;
+            goto fetch_error;
         }
-        if (inlen != file_size) {
+        inlen = dyad_mod_read_fd (mod_ctx->ctx, fd, inbuf, range_length, range_offset);
+        if (inlen != range_length) {
             DYAD_LOG_ERROR (mod_ctx->ctx,
                             "DYAD_MOD: Failed to load file \"%s\" only read %zd of %zd. with code "
                             "%d:%s.",
                             fullpath,
                             inlen,
-                            file_size,
+                            range_length,
                             errno,
                             strerror (errno));
+            send_errno = errno;
+            mod_ctx->ctx->dtl_handle->return_buffer (mod_ctx->ctx, (void **)&inbuf);
+            errno = send_errno;
             goto fetch_error;
         }
-        inlen = file_size + (ssize_t)buf_offset;
+        if (range_length == file_size) {
+            dyad_mod_cache_file (mod_ctx, fullpath, fd, inbuf, file_size);
+        }
+        inlen = range_length;
         DYAD_C_FUNCTION_UPDATE_INT ("file_size", file_size);
         dyad_release_flock (mod_ctx->ctx, fd, &shared_lock);
         close (fd);
@@ -378,22 +1568,44 @@ dyad_fetch_request_cb (flux_t *h, flux_msg_handler_t *w, const flux_msg_t *msg,
         if (DYAD_IS_ERROR (rc)) {
             DYAD_LOG_ERROR (mod_ctx->ctx,
                             "DYAD_MOD: Could not establish DTL connection with client");
+            mod_ctx->ctx->dtl_handle->return_buffer (mod_ctx->ctx, (void **)&inbuf);
             errno = ECONNREFUSED;
             goto fetch_error_wo_flock;
         }
         DYAD_LOG_DEBUG (mod_ctx->ctx, "DYAD_MOD: Send file to consumer with DTL");
-        rc = mod_ctx->ctx->dtl_handle->send (mod_ctx->ctx, inbuf, inlen);
+        rc = dyad_mod_send_msg (mod_ctx->ctx, &codec, inbuf, inlen, false);
         if (DYAD_IS_ERROR (rc)) {
             DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: Could not send data to client via DTL\n");
+            mod_ctx->ctx->dtl_handle->close_connection (mod_ctx->ctx);
+            mod_ctx->ctx->dtl_handle->return_buffer (mod_ctx->ctx, (void **)&inbuf);
             errno = ECOMM;
             goto fetch_error_wo_flock;
         }
         DYAD_LOG_DEBUG (mod_ctx->ctx, "DYAD_MOD: Close DTL connection with consumer");
         mod_ctx->ctx->dtl_handle->close_connection (mod_ctx->ctx);
         mod_ctx->ctx->dtl_handle->return_buffer (mod_ctx->ctx, (void **)&inbuf);
+    } else if (file_size == 0l && range_offset == 0l) {
+        // An empty file is sent as a single empty message
+        dyad_release_flock (mod_ctx->ctx, fd, &shared_lock);
+        close (fd);
+        rc = mod_ctx->ctx->dtl_handle->establish_connection (mod_ctx->ctx);
+        if (DYAD_IS_ERROR (rc)) {
+            errno = ECONNREFUSED;
+            goto fetch_error_wo_flock;
+        }
+        rc = dyad_mod_send_msg (mod_ctx->ctx, &codec, "", 0l, false);
+        mod_ctx->ctx->dtl_handle->close_connection (mod_ctx->ctx);
+        if (DYAD_IS_ERROR (rc)) {
+            DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: Could not send data to client via DTL\n");
+            errno = ECOMM;
+            goto fetch_error_wo_flock;
+        }
     } else {
+        errno = EINVAL;
         goto fetch_error;
     }
+
+fetch_sent:;
     DYAD_LOG_DEBUG (mod_ctx->ctx,
                     "DYAD_MOD: Close RPC message stream with an ENODATA (%d) message",
                     ENODATA);
@@ -426,22 +1638,487 @@ end_fetch_cb:;
     return;
 }
 
+/**
+ * @brief Sends one file of a batched fetch: a header response followed by
+ *        the contents of the file.
+ *
+ * @details
+ * The header is @c {"index": index, "size": n} and is followed by @c n
+ * bytes of data, in messages of at most @p chunk_size bytes, or in one
+ * message if @p chunk_size is 0. An empty file is thus sent as a header
+ * alone. A file that cannot be opened, locked or sized is answered with
+ * @c {"index": index, "errnum": e} instead and does not end the stream,
+ * so that the consumer can fetch it on its own.
+ *
+ * The file is served from the file cache or mapped in zero-copy mode, as
+ * in @c dyad_fetch_request_cb(). Otherwise it is read through @p chunk,
+ * which is grown as needed and kept for the following files of the batch.
+ *
+ * @param[in]     h           Flux handle for the broker.
+ * @param[in]     mod_ctx     Module context.
+ * @param[in]     msg         The consumer's batch request.
+ * @param[in]     index       Position of the file in the request.
+ * @param[in]     upath       Path of the file relative to the managed path.
+ * @param[in]     chunk_size  Maximum number of bytes per message, or 0.
+ * @param[in]     codec       Compression negotiated with the consumer.
+ * @param[in,out] chunk       Read buffer shared by the files of the batch.
+ * @param[in,out] chunk_len   Size of @p chunk.
+ *
+ * @return @c dyad_rc_t return code:
+ * @retval DYAD_RC_OK        The file was sent, or its error was reported.
+ * @retval DYAD_RC_FLUXFAIL  The header could not be sent.
+ * @retval DYAD_RC_*         Any error code from @c dyad_mod_send_data().
+ *                           The stream must then be ended with @c errno.
+ */
+static dyad_rc_t dyad_mod_send_batch_file (flux_t *h,
+                                           const dyad_mod_ctx_t *mod_ctx,
+                                           const flux_msg_t *msg,
+                                           int index,
+                                           const char *upath,
+                                           ssize_t chunk_size,
+                                           const dyad_mod_codec_t *codec,
+                                           char **chunk,
+                                           ssize_t *chunk_len)
+{
+    DYAD_C_FUNCTION_START ();
+    DYAD_C_FUNCTION_UPDATE_STR ("upath", upath);
+    dyad_rc_t rc = DYAD_RC_OK;
+    char fullpath[PATH_MAX + 1] = {'\0'};
+    dyad_mod_cache_ref_t *cached = NULL;
+    const char *data = NULL;
+    char *map = NULL;
+    ssize_t file_size = 0l;
+    ssize_t msg_size = 0l;
+    int fd = -1;
+    int errnum = 0;
+    struct flock shared_lock;
+
+    strncpy (fullpath, mod_ctx->ctx->prod_managed_path, PATH_MAX - 1);
+    concat_str (fullpath, upath, "/", PATH_MAX);
+    if (!dyad_mod_find_cached (mod_ctx, fullpath, &cached, &data, &file_size)) {
+        fd = open (fullpath, O_RDONLY);
+        if (fd < 0) {
+            errnum = errno;
+            DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: Failed to open file \"%s\".", fullpath);
+            goto batch_file_skip;
+        }
+        if (DYAD_IS_ERROR (dyad_shared_flock (mod_ctx->ctx, fd, &shared_lock))) {
+            errnum = (errno != 0) ? errno : EIO;
+            goto batch_file_skip;
+        }
+        file_size = get_file_size (fd);
+        if (file_size < 0l) {
+            errnum = (errno != 0) ? errno : EIO;
+            goto batch_file_skip;
+        }
+        if (mod_ctx->zero_copy && file_size > 0l) {
+            map = dyad_mod_map_fd (fd, file_size);
+            data = map;
+        }
+    }
+    DYAD_LOG_DEBUG (mod_ctx->ctx, "DYAD_MOD: file %s has size %zd", fullpath, file_size);
+    msg_size = (chunk_size > 0l && chunk_size < file_size) ? chunk_size : file_size;
+    if (data == NULL && msg_size > *chunk_len) {
+        if (*chunk != NULL) {
+            mod_ctx->ctx->dtl_handle->return_buffer (mod_ctx->ctx, (void **)chunk);
+        }
+        *chunk_len = 0l;
+        if (DYAD_IS_ERROR (
+                mod_ctx->ctx->dtl_handle->get_buffer (mod_ctx->ctx, msg_size, (void **)chunk))) {
+            DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: Could not allocate a %zd byte chunk", msg_size);
+            errnum = ENOMEM;
+            goto batch_file_skip;
+        }
+        *chunk_len = msg_size;
+    }
+    if (flux_respond_pack (h, msg, "{s:i s:I}", "index", index, "size", (json_int_t)file_size)
+        < 0) {
+        DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: Could not send the header of %s", fullpath);
+        errnum = ECOMM;
+        rc = DYAD_RC_FLUXFAIL;
+        goto batch_file_done;
+    }
+    if (file_size == 0l) {
+        goto batch_file_done;
+    }
+    rc = dyad_mod_send_data (mod_ctx->ctx, fd, data, *chunk, 0l, file_size, msg_size, codec);
+    if (DYAD_IS_ERROR (rc)) {
+        errnum = errno;
+    } else if (map != NULL && msg_size == file_size) {
+        dyad_mod_cache_file (mod_ctx, fullpath, fd, map, file_size);
+    }
+    goto batch_file_done;
+
+batch_file_skip:;
+    DYAD_LOG_DEBUG (mod_ctx->ctx,
+                    "DYAD_MOD: Skipping %s in batch (errno = %d)",
+                    fullpath,
+                    errnum);
+    if (flux_respond_pack (h, msg, "{s:i s:i}", "index", index, "errnum", errnum) < 0) {
+        DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: Could not send the header of %s", fullpath);
+        errnum = ECOMM;
+        rc = DYAD_RC_FLUXFAIL;
+    }
+
+batch_file_done:;
+    if (map != NULL) {
+        munmap (map, (size_t)file_size);
+    }
+    dyad_mod_cache_release (mod_ctx->cache, cached);
+    if (fd != -1) {
+        dyad_release_flock (mod_ctx->ctx, fd, &shared_lock);
+        close (fd);
+    }
+    if (DYAD_IS_ERROR (rc)) {
+        errno = errnum;
+    }
+    DYAD_C_FUNCTION_END ();
+    return rc;
+}
+
+/**
+ * @brief Flux message handler callback that serves several files to a
+ *        consumer in a single RPC stream.
+ *
+ * @details
+ * Registered as the handler for @c DYAD_DTL_BATCH_RPC_NAME requests in
+ * @c htab. Unpacks and acknowledges the request like
+ * @c dyad_fetch_request_cb(), establishes a single DTL connection, sends
+ * every file listed in the @c "upaths" array of the payload with
+ * @c dyad_mod_send_batch_file(), and ends the stream with @c ENODATA.
+ * The per-file RPC, connection setup and end-of-stream round trips of
+ * individual fetches are thus paid once per batch.
+ *
+ * Files that cannot be served are reported in their header and skipped.
+ * A failure to send aborts the stream with the corresponding @c errno.
+ *
+ * Batches are only served with the @c FLUX_RPC DTL, whose @c send() calls
+ * are separate responses of the stream. The consumers of other DTLs
+ * receive a single message per request, and get @c EOPNOTSUPP. Batches
+ * are always served on the reactor, even when the module has fetch
+ * workers.
+ *
+ * @param[in] h    Flux handle for the broker.
+ * @param[in] w    Flux message handler (unused directly).
+ * @param[in] msg  Incoming Flux RPC message with the requested paths.
+ * @param[in] arg  Auxiliary argument (unused).
+ */
+static void
+dyad_fetch_batch_request_cb (flux_t *h, flux_msg_handler_t *w, const flux_msg_t *msg, void *arg)
+{
+    DYAD_C_FUNCTION_START ();
+    dyad_mod_ctx_t *mod_ctx = get_mod_ctx (h);
+    DYAD_LOG_DEBUG (mod_ctx->ctx, "DYAD_MOD: Launched callback for %s", DYAD_DTL_BATCH_RPC_NAME);
+    char *upath = NULL;
+    json_t *upaths = NULL;
+    json_t *value = NULL;
+    const char *batch_upath = NULL;
+    char *chunk = NULL;
+    ssize_t chunk_len = 0l;
+    ssize_t chunk_size = 0l;
+    dyad_mod_codec_t codec;
+    size_t index = 0ul;
+    int saved_errno = errno;
+    int errnum = 0;
+    dyad_rc_t rc = DYAD_RC_OK;
+
+    if (!flux_msg_is_streaming (msg)) {
+        errnum = EPROTO;
+        goto batch_error;
+    }
+    if (mod_ctx->ctx->dtl_handle->mode != DYAD_DTL_FLUX_RPC) {
+        errnum = EOPNOTSUPP;
+        goto batch_error;
+    }
+    rc = mod_ctx->ctx->dtl_handle->rpc_unpack (mod_ctx->ctx, msg, &upath);
+    if (DYAD_IS_ERROR (rc)
+        || flux_request_unpack (msg, NULL, "{s:o}", "upaths", &upaths) < 0
+        || !json_is_array (upaths)) {
+        DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: Could not unpack batch message from client");
+        errnum = DYAD_IS_ERROR (rc) ? dyad_mod_unpack_errno (rc) : EPROTO;
+        goto batch_error;
+    }
+    DYAD_C_FUNCTION_UPDATE_INT ("batch_size", json_array_size (upaths));
+    rc = mod_ctx->ctx->dtl_handle->rpc_respond (mod_ctx->ctx, msg);
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: Could not send primary RPC response to client");
+        errnum = EPROTO;
+        goto batch_error;
+    }
+    chunk_size = dyad_mod_chunk_size (mod_ctx->ctx, msg);
+    dyad_mod_codec (mod_ctx->ctx, msg, &codec);
+    rc = mod_ctx->ctx->dtl_handle->establish_connection (mod_ctx->ctx);
+    if (DYAD_IS_ERROR (rc)) {
+        DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: Could not establish DTL connection with client");
+        errnum = ECONNREFUSED;
+        goto batch_error;
+    }
+    json_array_foreach (upaths, index, value)
+    {
+        batch_upath = json_string_value (value);
+        if (batch_upath == NULL) {
+            errnum = EPROTO;
+            break;
+        }
+        rc = dyad_mod_send_batch_file (h,
+                                       mod_ctx,
+                                       msg,
+                                       (int)index,
+                                       batch_upath,
+                                       chunk_size,
+                                       &codec,
+                                       &chunk,
+                                       &chunk_len);
+        if (DYAD_IS_ERROR (rc)) {
+            errnum = errno;
+            break;
+        }
+    }
+    mod_ctx->ctx->dtl_handle->close_connection (mod_ctx->ctx);
+    if (chunk != NULL) {
+        mod_ctx->ctx->dtl_handle->return_buffer (mod_ctx->ctx, (void **)&chunk);
+    }
+    if (errnum != 0) {
+        goto batch_error;
+    }
+    DYAD_LOG_DEBUG (mod_ctx->ctx, "DYAD_MOD: Sent a batch of %zu files", index);
+    if (flux_respond_error (h, msg, ENODATA, NULL) < 0) {
+        DYAD_LOG_DEBUG (mod_ctx->ctx,
+                        "DYAD_MOD: %s: flux_respond_error with ENODATA failed\n",
+                        __func__);
+    }
+    goto end_batch_cb;
+
+batch_error:;
+    DYAD_LOG_ERROR (mod_ctx->ctx,
+                    "DYAD_MOD: Close batch RPC message stream with an error (errno = %d)\n",
+                    errnum);
+    if (flux_respond_error (h, msg, errnum, NULL) < 0) {
+        DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: %s: flux_respond_error", __func__);
+    }
+
+end_batch_cb:;
+    errno = saved_errno;
+    DYAD_C_FUNCTION_END ();
+}
+
+/**
+ * @brief Packs the non-empty histograms of @p stats as the @c "phases"
+ *        array of a @c DYAD_STATS_RPC_NAME response.
+ *
+ * @return The new array, or @c NULL if it could not be allocated.
+ */
+static json_t *dyad_mod_pack_stats (const dyad_stats_t *stats)
+{
+    json_t *phases = json_array ();
+    json_t *buckets = NULL;
+    json_t *entry = NULL;
+    const dyad_stats_hist_t *hist = NULL;
+    unsigned i = 0u;
+    unsigned b = 0u;
+
+    if (phases == NULL) {
+        return NULL;
+    }
+    for (i = 0u; i < DYAD_STATS_NUM_PHASES; i++) {
+        hist = &stats->phases[i];
+        if (hist->count == 0ull) {
+            continue;
+        }
+        buckets = json_array ();
+        for (b = 0u; buckets != NULL && b < DYAD_STATS_NUM_BUCKETS; b++) {
+            if (json_array_append_new (buckets, json_integer ((json_int_t)hist->buckets[b]))
+                < 0) {
+                json_decref (buckets);
+                buckets = NULL;
+            }
+        }
+        entry = (buckets == NULL) ? NULL
+                                  : json_pack ("{s:s s:I s:I s:I s:o}",
+                                               "name",
+                                               dyad_stats_phase_name ((dyad_stats_phase_t)i),
+                                               "count",
+                                               (json_int_t)hist->count,
+                                               "total_ns",
+                                               (json_int_t)hist->total_ns,
+                                               "max_ns",
+                                               (json_int_t)hist->max_ns,
+                                               "buckets",
+                                               buckets);
+        if (entry == NULL || json_array_append_new (phases, entry) < 0) {
+            json_decref (phases);
+            return NULL;
+        }
+    }
+    return phases;
+}
+
+/**
+ * @brief Callback for @c DYAD_STATS_RPC_NAME requests, replying with the
+ *        latency histograms recorded by the module.
+ *
+ * @details
+ * The histograms cover the module's phases of every fetch served so far
+ * (@c DYAD_STATS_MOD_QUEUE, @c DYAD_STATS_MOD_READ and
+ * @c DYAD_STATS_MOD_SEND), and are cleared after replying if the request
+ * has @c "reset" set. Served on the reactor.
+ *
+ * @param[in] h    Flux handle for the broker.
+ * @param[in] w    Flux message handler (unused directly).
+ * @param[in] msg  Incoming Flux RPC message.
+ * @param[in] arg  Auxiliary argument (unused).
+ */
+static void
+dyad_stats_request_cb (flux_t *h, flux_msg_handler_t *w, const flux_msg_t *msg, void *arg)
+{
+    dyad_mod_ctx_t *mod_ctx = get_mod_ctx (h);
+    dyad_stats_t stats;
+    json_t *phases = NULL;
+    int reset = 0;
+
+    if (flux_request_unpack (msg, NULL, "{s?b}", "reset", &reset) < 0) {
+        DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: Could not unpack stats request");
+        if (flux_respond_error (h, msg, EPROTO, NULL) < 0) {
+            DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: %s: flux_respond_error", __func__);
+        }
+        return;
+    }
+    dyad_stats_snapshot (&stats);
+    if (reset) {
+        dyad_stats_reset ();
+    }
+    phases = dyad_mod_pack_stats (&stats);
+    if (phases == NULL) {
+        if (flux_respond_error (h, msg, ENOMEM, NULL) < 0) {
+            DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: %s: flux_respond_error", __func__);
+        }
+        return;
+    }
+    if (flux_respond_pack (h, msg, "{s:o}", "phases", phases) < 0) {
+        DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: %s: flux_respond_pack", __func__);
+    }
+}
+
+/**
+ * @brief Callback for @c DYAD_STAT_RPC_NAME requests, replying with the size
+ *        of a file under the producer-managed directory.
+ *
+ * @details
+ * Lets a consumer split a large file into byte ranges before fetching it.
+ * Served on the reactor, as a @c stat() does not block for long.
+ *
+ * @param[in] h    Flux handle for the broker.
+ * @param[in] w    Flux message handler (unused directly).
+ * @param[in] msg  Incoming Flux RPC message.
+ * @param[in] arg  Auxiliary argument (unused).
+ */
+static void
+dyad_stat_request_cb (flux_t *h, flux_msg_handler_t *w, const flux_msg_t *msg, void *arg)
+{
+    dyad_mod_ctx_t *mod_ctx = get_mod_ctx (h);
+    const char *upath = NULL;
+    char fullpath[PATH_MAX + 1] = {'\0'};
+    struct stat st;
+    int errnum = 0;
+
+    if (flux_request_unpack (msg, NULL, "{s:s}", "upath", &upath) < 0) {
+        DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: Could not unpack stat request");
+        if (flux_respond_error (h, msg, EPROTO, NULL) < 0) {
+            DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: %s: flux_respond_error", __func__);
+        }
+        return;
+    }
+    strncpy (fullpath, mod_ctx->ctx->prod_managed_path, PATH_MAX - 1);
+    concat_str (fullpath, upath, "/", PATH_MAX);
+    if (stat (fullpath, &st) < 0) {
+        errnum = errno;
+    } else if (!S_ISREG (st.st_mode)) {
+        errnum = EINVAL;
+    }
+    if (errnum != 0) {
+        DYAD_LOG_DEBUG (mod_ctx->ctx, "DYAD_MOD: Cannot stat \"%s\"", fullpath);
+        if (flux_respond_error (h, msg, errnum, NULL) < 0) {
+            DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: %s: flux_respond_error", __func__);
+        }
+        return;
+    }
+    if (flux_respond_pack (h, msg, "{s:I}", "size", (json_int_t)st.st_size) < 0) {
+        DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: %s: flux_respond_pack", __func__);
+    }
+}
+
+/**
+ * @brief Callback for @c DYAD_DTL_REGISTER_RPC_NAME requests, remembering
+ *        the address of a consumer and replying with its key.
+ *
+ * @details
+ * Lets a consumer send its address once instead of with every fetch.
+ * Served on the reactor, which is the only thread using the DTL. Answered
+ * with @c ENOSYS if the DTL does not need consumers to register.
+ *
+ * @param[in] h    Flux handle for the broker.
+ * @param[in] w    Flux message handler (unused directly).
+ * @param[in] msg  Incoming Flux RPC message.
+ * @param[in] arg  Auxiliary argument (unused).
+ */
+static void
+dyad_register_request_cb (flux_t *h, flux_msg_handler_t *w, const flux_msg_t *msg, void *arg)
+{
+    dyad_mod_ctx_t *mod_ctx = get_mod_ctx (h);
+    uint64_t key = 0ull;
+    int errnum = 0;
+
+    if (mod_ctx->ctx->dtl_handle->rpc_register == NULL) {
+        errnum = ENOSYS;
+    } else if (DYAD_IS_ERROR (mod_ctx->ctx->dtl_handle->rpc_register (mod_ctx->ctx, msg, &key))) {
+        DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: Could not register consumer");
+        errnum = EPROTO;
+    }
+    if (errnum != 0) {
+        if (flux_respond_error (h, msg, errnum, NULL) < 0) {
+            DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: %s: flux_respond_error", __func__);
+        }
+        return;
+    }
+    if (flux_respond_raw (h, msg, &key, sizeof (key)) < 0) {
+        DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: %s: flux_respond_raw", __func__);
+    }
+}
+
 /**
  * @brief Flux message handler table for the DYAD module.
  *
  * @details
  * Registers @c dyad_fetch_request_cb as the handler for all incoming
  * @c FLUX_MSGTYPE_REQUEST messages addressed to @c DYAD_DTL_RPC_NAME.
- * This is the single RPC endpoint exposed by the DYAD module — consumers
- * send file fetch requests to this name on the producer's broker, and the
- * reactor dispatches them to @c dyad_fetch_request_cb.
+ * Consumers send file fetch requests to this name on the producer's
+ * broker, and the reactor dispatches them to @c dyad_fetch_request_cb.
  * @c DYAD_DTL_RPC_NAME is defined as "dyad.fetch"
  *
+ * Batched fetches of several files, addressed to
+ * @c DYAD_DTL_BATCH_RPC_NAME ("dyad.fetch_batch"), are dispatched to
+ * @c dyad_fetch_batch_request_cb.
+ *
+ * Requests for the module's latency histograms, addressed to
+ * @c DYAD_STATS_RPC_NAME ("dyad.stats"), are answered by
+ * @c dyad_stats_request_cb.
+ *
+ * Requests for the size of a file, addressed to @c DYAD_STAT_RPC_NAME
+ * ("dyad.stat"), are answered by @c dyad_stat_request_cb.
+ *
+ * Consumers register their DTL address once, with
+ * @c DYAD_DTL_REGISTER_RPC_NAME ("dyad.register"), through
+ * @c dyad_register_request_cb.
+ *
  * Passed to @c flux_msg_handler_addvec() in @c mod_main() and terminated
  * by @c FLUX_MSGHANDLER_TABLE_END as required by the Flux API.
  */
 static const struct flux_msg_handler_spec htab[] =
     {{FLUX_MSGTYPE_REQUEST, DYAD_DTL_RPC_NAME, dyad_fetch_request_cb, 0},
+     {FLUX_MSGTYPE_REQUEST, DYAD_DTL_BATCH_RPC_NAME, dyad_fetch_batch_request_cb, 0},
+     {FLUX_MSGTYPE_REQUEST, DYAD_STATS_RPC_NAME, dyad_stats_request_cb, 0},
+     {FLUX_MSGTYPE_REQUEST, DYAD_STAT_RPC_NAME, dyad_stat_request_cb, 0},
+     {FLUX_MSGTYPE_REQUEST, DYAD_DTL_REGISTER_RPC_NAME, dyad_register_request_cb, 0},
      FLUX_MSGHANDLER_TABLE_END};
 
 static void show_help (void)
@@ -462,6 +2139,33 @@ static void show_help (void)
         "                     error logging. Does nothing if DYAD was\n"
         "                     not configured with '-DDYAD_LOGGER=PRINTF'\n"
         "                     Need a filename as an argument.\n");
+    DYAD_LOG_STDOUT (
+        "    -w, --workers: Number of worker threads that load files for\n"
+        "                   fetch requests off the reactor thread.\n"
+        "                   0 (default) serves requests inline.\n"
+        "                   Need a number as an argument.\n");
+    DYAD_LOG_STDOUT (
+        "    -z, --zero_copy: Send files from a memory mapping instead of\n"
+        "                     reading them into a buffer first.\n");
+    DYAD_LOG_STDOUT (
+        "    -c, --cache_size: Memory budget in bytes for caching the\n"
+        "                      contents of fetched files.\n"
+        "                      0 (default) disables the cache.\n"
+        "                      Need a number as an argument.\n");
+    DYAD_LOG_STDOUT (
+        "    -u, --io_engine: Engine with which files are read.\n"
+        "                     Either 'posix' (default) or 'io_uring'.\n");
+    DYAD_LOG_STDOUT (
+        "    -n, --ep_cache_size: Maximum number of UCX endpoints kept open\n"
+        "                         to consumers. The least recently used one\n"
+        "                         is closed to open another. 256 by default.\n"
+        "                         Need a number as an argument.\n");
+    DYAD_LOG_STDOUT (
+        "    -x, --ucx_workers: Number of UCX workers from which the fetch\n"
+        "                       workers send files concurrently. Needs -w\n"
+        "                       and the UCX DTL. 0 (default) sends from\n"
+        "                       the reactor thread.\n"
+        "                       Need a number as an argument.\n");
 }
 
 /**
@@ -470,7 +2174,13 @@ static void show_help (void)
 struct opt_parse_out {
     const char *prod_managed_path;  ///< Producer-managed directory path, or @c NULL.
     const char *dtl_mode;           ///< DTL mode string, or @c NULL for default.
+    const char *workers;            ///< Number of fetch workers, or @c NULL for default.
+    const char *cache_size;         ///< File cache budget, or @c NULL for default.
+    const char *io_engine;          ///< I/O engine name, or @c NULL for default.
+    const char *ep_cache_size;      ///< UCX endpoint cache capacity, or @c NULL for default.
+    const char *ucx_workers;        ///< Number of UCX send workers, or @c NULL for default.
     bool debug;                     ///< Whether debug logging is enabled.
+    bool zero_copy;                 ///< Whether @c -z was passed.
     bool showed_help;               ///< Whether @c -h was passed and help was shown.
 };
 
@@ -492,6 +2202,12 @@ typedef struct opt_parse_out opt_parse_out_t;
  *  - @c -m / @c --mode        Sets @c opt->dtl_mode.
  *  - @c -i / @c --info_log    Redirects info log output to a per-rank file.
  *  - @c -e / @c --error_log   Redirects error log output to a per-rank file.
+ *  - @c -w / @c --workers     Sets @c opt->workers.
+ *  - @c -z / @c --zero_copy   Sets @c opt->zero_copy.
+ *  - @c -c / @c --cache_size  Sets @c opt->cache_size.
+ *  - @c -u / @c --io_engine   Sets @c opt->io_engine.
+ *  - @c -n / @c --ep_cache_size  Sets @c opt->ep_cache_size.
+ *  - @c -x / @c --ucx_workers    Sets @c opt->ucx_workers.
  *
  * Any remaining non-option argument is treated as the producer-managed
  * directory path and stored in @c opt->prod_managed_path.
@@ -552,10 +2268,16 @@ int opt_parse (opt_parse_out_t *restrict opt,
                                            {"mode", required_argument, 0, 'm'},
                                            {"info_log", required_argument, 0, 'i'},
                                            {"error_log", required_argument, 0, 'e'},
+                                           {"workers", required_argument, 0, 'w'},
+                                           {"zero_copy", no_argument, 0, 'z'},
+                                           {"cache_size", required_argument, 0, 'c'},
+                                           {"io_engine", required_argument, 0, 'u'},
+                                           {"ep_cache_size", required_argument, 0, 'n'},
+                                           {"ucx_workers", required_argument, 0, 'x'},
                                            {0, 0, 0, 0}};
 
     int c;
-    while ((c = getopt_long (_argc, _argv, "hdm:i:e:", long_options, NULL)) != -1) {
+    while ((c = getopt_long (_argc, _argv, "hdm:i:e:w:zc:u:n:x:", long_options, NULL)) != -1) {
         switch (c) {
             case 'h':
                 show_help ();
@@ -586,6 +2308,30 @@ int opt_parse (opt_parse_out_t *restrict opt,
                 sprintf (err_file_name, "%s_%d.err", optarg, broker_rank);
 #endif  // DYAD_LOGGER_NO_LOG
                 break;
+            case 'w':
+                DYAD_LOG_STDERR ("DYAD_MOD: 'workers' option -w with value `%s'\n", optarg);
+                opt->workers = optarg;
+                break;
+            case 'z':
+                DYAD_LOG_STDERR ("DYAD_MOD: 'zero_copy' option -z\n");
+                opt->zero_copy = true;
+                break;
+            case 'c':
+                DYAD_LOG_STDERR ("DYAD_MOD: 'cache_size' option -c with value `%s'\n", optarg);
+                opt->cache_size = optarg;
+                break;
+            case 'u':
+                DYAD_LOG_STDERR ("DYAD_MOD: 'io_engine' option -u with value `%s'\n", optarg);
+                opt->io_engine = optarg;
+                break;
+            case 'n':
+                DYAD_LOG_STDERR ("DYAD_MOD: 'ep_cache_size' option -n with value `%s'\n", optarg);
+                opt->ep_cache_size = optarg;
+                break;
+            case 'x':
+                DYAD_LOG_STDERR ("DYAD_MOD: 'ucx_workers' option -x with value `%s'\n", optarg);
+                opt->ucx_workers = optarg;
+                break;
             case '?':
                 /* getopt_long already printed an error message. */
                 break;
@@ -630,6 +2376,13 @@ int opt_parse (opt_parse_out_t *restrict opt,
  *    @c DYAD_PATH_PRODUCER_ENV and the directory is created if it does
  *    not already exist.
  *  - If @c opt->dtl_mode is set, it is written to @c DYAD_DTL_MODE_ENV.
+ *  - If @c opt->workers is set, it is written to @c DYAD_MOD_WORKERS_ENV.
+ *  - If @c opt->zero_copy is set, @c DYAD_MOD_ZERO_COPY_ENV is set.
+ *  - If @c opt->cache_size is set, it is written to
+ *    @c DYAD_MOD_CACHE_SIZE_ENV.
+ *  - If @c opt->io_engine is set, it is written to @c DYAD_IO_ENGINE_ENV.
+ *  - If @c opt->ucx_workers is set, it is written to
+ *    @c DYAD_MOD_UCX_WORKERS_ENV.
  *  - If @c DYAD_KVS_NAMESPACE is not set in the environment, a dummy
  *    value is written to allow @c dyad_ctx_init() to proceed. This is
  *    a known limitation (see TODO in source).
@@ -684,6 +2437,48 @@ dyad_rc_t dyad_module_ctx_init (const opt_parse_out_t *opt, flux_t *h)
                          opt->dtl_mode);
     }
 
+    if (opt->workers) {
+        setenv (DYAD_MOD_WORKERS_ENV, opt->workers, 1);
+        DYAD_LOG_STDOUT ("DYAD_MOD: Workers option set. Setting env %s=%s\n",
+                         DYAD_MOD_WORKERS_ENV,
+                         opt->workers);
+    }
+
+    if (opt->zero_copy) {
+        setenv (DYAD_MOD_ZERO_COPY_ENV, "1", 1);
+        DYAD_LOG_STDOUT ("DYAD_MOD: Zero-copy option set. Setting env %s=1\n",
+                         DYAD_MOD_ZERO_COPY_ENV);
+    }
+    mod_ctx->zero_copy = (getenv (DYAD_MOD_ZERO_COPY_ENV) != NULL);
+
+    if (opt->cache_size) {
+        setenv (DYAD_MOD_CACHE_SIZE_ENV, opt->cache_size, 1);
+        DYAD_LOG_STDOUT ("DYAD_MOD: Cache size option set. Setting env %s=%s\n",
+                         DYAD_MOD_CACHE_SIZE_ENV,
+                         opt->cache_size);
+    }
+
+    if (opt->io_engine) {
+        setenv (DYAD_IO_ENGINE_ENV, opt->io_engine, 1);
+        DYAD_LOG_STDOUT ("DYAD_MOD: I/O engine option set. Setting env %s=%s\n",
+                         DYAD_IO_ENGINE_ENV,
+                         opt->io_engine);
+    }
+
+    if (opt->ep_cache_size) {
+        setenv (DYAD_UCX_EP_CACHE_SIZE_ENV, opt->ep_cache_size, 1);
+        DYAD_LOG_STDOUT ("DYAD_MOD: Endpoint cache size option set. Setting env %s=%s\n",
+                         DYAD_UCX_EP_CACHE_SIZE_ENV,
+                         opt->ep_cache_size);
+    }
+
+    if (opt->ucx_workers) {
+        setenv (DYAD_MOD_UCX_WORKERS_ENV, opt->ucx_workers, 1);
+        DYAD_LOG_STDOUT ("DYAD_MOD: UCX workers option set. Setting env %s=%s\n",
+                         DYAD_MOD_UCX_WORKERS_ENV,
+                         opt->ucx_workers);
+    }
+
     char *kvs_namespace = getenv ("DYAD_KVS_NAMESPACE");
     if (kvs_namespace != NULL) {
         DYAD_LOG_STDOUT ("DYAD_MOD: DYAD_KVS_NAMESPACE is set to `%s'\n", kvs_namespace);
@@ -713,6 +2508,139 @@ dyad_rc_t dyad_module_ctx_init (const opt_parse_out_t *opt, flux_t *h)
     return DYAD_RC_OK;
 }
 
+/**
+ * @brief Starts the fetch worker pool if the module is configured for it.
+ *
+ * @details
+ * Reads the number of workers from @c DYAD_MOD_WORKERS_ENV, which
+ * @c dyad_module_ctx_init() sets from the @c -w option if given. With 0
+ * workers (the default) no pool is created and @c dyad_fetch_request_cb()
+ * serves every request inline on the reactor thread, as before. If the
+ * pool cannot be created, the module logs an error and also falls back to
+ * serving requests inline. The number of requests waiting for a worker is
+ * capped by @c DYAD_MOD_QUEUE_SIZE_ENV, 64 per worker by default.
+ *
+ * @param[in,out] mod_ctx  Module context with an initialized DYAD context.
+ *                         @c mod_ctx->pool is set on success.
+ *
+ * @return @c dyad_rc_t return code:
+ * @retval DYAD_RC_OK     The pool was started, or none was requested.
+ * @retval DYAD_RC_NOCTX  @p mod_ctx or its DYAD context is @c NULL.
+ */
+static dyad_rc_t dyad_module_pool_init (dyad_mod_ctx_t *mod_ctx)
+{
+    if (mod_ctx == NULL || mod_ctx->ctx == NULL) {
+        return DYAD_RC_NOCTX;
+    }
+    const char *workers_env = getenv (DYAD_MOD_WORKERS_ENV);
+    const unsigned nworkers =
+        (workers_env != NULL) ? (unsigned)strtoul (workers_env, NULL, 10) : 0u;
+    const char *queue_env = getenv (DYAD_MOD_QUEUE_SIZE_ENV);
+    const unsigned max_queued =
+        (queue_env != NULL) ? (unsigned)strtoul (queue_env, NULL, 10) : 64u * nworkers;
+    if (nworkers == 0u) {
+        DYAD_LOG_STDOUT ("DYAD_MOD: Serving fetch requests on the reactor thread\n");
+        return DYAD_RC_OK;
+    }
+    if (DYAD_IS_ERROR (dyad_mod_pool_create (mod_ctx->ctx->h,
+                                             nworkers,
+                                             max_queued,
+                                             dyad_fetch_job_load,
+                                             dyad_fetch_job_complete,
+                                             mod_ctx,
+                                             &mod_ctx->pool))) {
+        DYAD_LOG_STDERR ("DYAD_MOD: Could not start %u fetch workers. Serving inline\n",
+                         nworkers);
+        mod_ctx->pool = NULL;
+        return DYAD_RC_OK;
+    }
+    DYAD_LOG_STDOUT ("DYAD_MOD: Serving fetch requests with %u workers, queueing up to %u\n",
+                     nworkers,
+                     max_queued);
+    return DYAD_RC_OK;
+}
+
+/**
+ * @brief Creates the file cache if the module is configured for it.
+ *
+ * @details
+ * Reads the cache budget in bytes from @c DYAD_MOD_CACHE_SIZE_ENV, which
+ * @c dyad_module_ctx_init() sets from the @c -c option if given. With a
+ * budget of 0 (the default) no cache is created. If the cache cannot be
+ * created, the module logs an error and runs without it.
+ *
+ * @param[in,out] mod_ctx  Module context with an initialized DYAD context.
+ *                         @c mod_ctx->cache is set on success.
+ *
+ * @return @c dyad_rc_t return code:
+ * @retval DYAD_RC_OK     The cache was created, or none was requested.
+ * @retval DYAD_RC_NOCTX  @p mod_ctx or its DYAD context is @c NULL.
+ */
+static dyad_rc_t dyad_module_cache_init (dyad_mod_ctx_t *mod_ctx)
+{
+    if (mod_ctx == NULL || mod_ctx->ctx == NULL) {
+        return DYAD_RC_NOCTX;
+    }
+    const char *size_env = getenv (DYAD_MOD_CACHE_SIZE_ENV);
+    const size_t budget = (size_env != NULL) ? (size_t)strtoull (size_env, NULL, 10) : 0ul;
+    if (budget == 0ul) {
+        return DYAD_RC_OK;
+    }
+    if (DYAD_IS_ERROR (dyad_mod_cache_create (budget, &mod_ctx->cache))) {
+        DYAD_LOG_STDERR ("DYAD_MOD: Could not create a %zu byte file cache\n", budget);
+        mod_ctx->cache = NULL;
+        return DYAD_RC_OK;
+    }
+    DYAD_LOG_STDOUT ("DYAD_MOD: Caching up to %zu bytes of fetched files\n", budget);
+    return DYAD_RC_OK;
+}
+
+/**
+ * @brief Creates the lanes the fetch workers send from if the module is
+ *        configured for them.
+ *
+ * @details
+ * Reads the number of lanes from @c DYAD_MOD_UCX_WORKERS_ENV, which
+ * @c dyad_module_ctx_init() sets from the @c -x option if given. With 0
+ * lanes (the default), no worker pool, or a DTL other than UCX, every
+ * fetch is sent from the reactor thread. If the lanes cannot be created,
+ * the module logs an error and also sends from the reactor thread.
+ *
+ * @param[in,out] mod_ctx  Module context with an initialized DYAD context
+ *                         and, if configured, its worker pool.
+ *                         @c mod_ctx->lanes is set on success.
+ *
+ * @return @c dyad_rc_t return code:
+ * @retval DYAD_RC_OK     The lanes were created, or none were requested.
+ * @retval DYAD_RC_NOCTX  @p mod_ctx or its DYAD context is @c NULL.
+ */
+static dyad_rc_t dyad_module_lanes_init (dyad_mod_ctx_t *mod_ctx)
+{
+    if (mod_ctx == NULL || mod_ctx->ctx == NULL) {
+        return DYAD_RC_NOCTX;
+    }
+    mod_ctx->lanes = NULL;
+    const char *lanes_env = getenv (DYAD_MOD_UCX_WORKERS_ENV);
+    const unsigned nlanes = (lanes_env != NULL) ? (unsigned)strtoul (lanes_env, NULL, 10) : 0u;
+    if (nlanes == 0u) {
+        return DYAD_RC_OK;
+    }
+    if (mod_ctx->pool == NULL || mod_ctx->ctx->dtl_handle->mode != DYAD_DTL_UCX) {
+        DYAD_LOG_STDERR ("DYAD_MOD: UCX workers need fetch workers and the UCX DTL. "
+                         "Sending from the reactor thread\n");
+        return DYAD_RC_OK;
+    }
+    if (DYAD_IS_ERROR (dyad_mod_lanes_create (mod_ctx->ctx, nlanes, &mod_ctx->lanes))) {
+        DYAD_LOG_STDERR ("DYAD_MOD: Could not create %u UCX workers. "
+                         "Sending from the reactor thread\n",
+                         nlanes);
+        mod_ctx->lanes = NULL;
+        return DYAD_RC_OK;
+    }
+    DYAD_LOG_STDOUT ("DYAD_MOD: Sending fetched files from %u UCX workers\n", nlanes);
+    return DYAD_RC_OK;
+}
+
 /**
  * @brief Entry point for the DYAD Flux module, invoked in a new broker
  *        thread when the module is loaded.
@@ -731,10 +2659,16 @@ dyad_rc_t dyad_module_ctx_init (const opt_parse_out_t *opt, flux_t *h)
  *  4. Initializes the DYAD context via @c dyad_module_ctx_init(), which
  *     applies command-line overrides to environment variables before
  *     calling @c dyad_ctx_init().
- *  5. Registers Flux message handlers from @c htab via
+ *  5. Creates the file cache, starts the fetch worker pool and creates
+ *     the lanes it sends from, if configured, via
+ *     @c dyad_module_cache_init(), @c dyad_module_pool_init() and
+ *     @c dyad_module_lanes_init().
+ *  6. Registers Flux message handlers from @c htab via
  *     @c flux_msg_handler_addvec().
- *  6. Runs the Flux reactor loop via @c flux_reactor_run(), blocking
- *     until the module is unloaded.
+ *  7. Runs the Flux reactor loop via @c flux_reactor_run(), blocking
+ *     until the module is unloaded. The worker pool is stopped once the
+ *     reactor returns, while the Flux handle can still carry responses
+ *     to requests that were still queued.
  *
  * On any error, jumps to @c mod_error and returns @c EXIT_FAILURE.
  * On success or after printing help, jumps to @c mod_done and returns
@@ -793,7 +2727,7 @@ DYAD_DLL_EXPORTED int mod_main (flux_t *h, int argc, char **argv)
 
     mod_ctx = get_mod_ctx (h);
 
-    opt_parse_out_t opt = {NULL, NULL, false, false};
+    opt_parse_out_t opt = {NULL, NULL, NULL, NULL, NULL, NULL, NULL, false, false, false};
 
     if (DYAD_IS_ERROR (opt_parse (&opt, broker_rank, argc, argv))) {
         DYAD_LOG_STDERR ("DYAD_MOD: Cannot parse command line arguments\n");
@@ -809,6 +2743,15 @@ DYAD_DLL_EXPORTED int mod_main (flux_t *h, int argc, char **argv)
     if (DYAD_IS_ERROR (dyad_module_ctx_init (&opt, h))) {
         goto mod_error;
     }
+    if (DYAD_IS_ERROR (dyad_module_cache_init (mod_ctx))) {
+        goto mod_error;
+    }
+    if (DYAD_IS_ERROR (dyad_module_pool_init (mod_ctx))) {
+        goto mod_error;
+    }
+    if (DYAD_IS_ERROR (dyad_module_lanes_init (mod_ctx))) {
+        goto mod_error;
+    }
     /** This is not just for dftracer but an alias for other profiler calls as well.
      *  That is why comes after the potential profiler initialization, which can
      *  happen during dyad_ctx initialization, i.e., dyad_init ().
@@ -822,8 +2765,16 @@ DYAD_DLL_EXPORTED int mod_main (flux_t *h, int argc, char **argv)
 
     if (flux_reactor_run (flux_get_reactor (mod_ctx->ctx->h), 0) < 0) {
         DYAD_LOG_ERROR (mod_ctx->ctx, "DYAD_MOD: flux_reactor_run: %s\n", strerror (errno));
+        dyad_mod_pool_destroy (mod_ctx->pool);
+        mod_ctx->pool = NULL;
+        dyad_mod_lanes_destroy (mod_ctx->lanes);
+        mod_ctx->lanes = NULL;
         goto mod_error;
     }
+    dyad_mod_pool_destroy (mod_ctx->pool);
+    mod_ctx->pool = NULL;
+    dyad_mod_lanes_destroy (mod_ctx->lanes);
+    mod_ctx->lanes = NULL;
     DYAD_LOG_STDOUT ("DYAD_MOD: Finished\n");
     goto mod_done;
 
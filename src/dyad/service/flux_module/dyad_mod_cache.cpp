@@ -0,0 +1,241 @@
+#if defined(DYAD_HAS_CONFIG)
+#include <dyad/dyad_config.hpp>
+#else
+#error "no config"
+#endif
+
+// clang-format off
+#include <dyad/service/flux_module/dyad_mod_cache.h>
+#include <dyad/common/dyad_profiler.h>
+// clang-format on
+
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief A cached copy of one file.
+ *
+ * @details
+ * Handed out to callers as a @c dyad_mod_cache_ref_t. An entry is
+ * @c indexed while it can be found by lookups. Once it is evicted or
+ * replaced, it is freed as soon as its last reference is released.
+ */
+struct dyad_mod_cache_ref {
+    std::string key;               ///< Path of the file.
+    std::unique_ptr<char[]> data;  ///< File contents.
+    size_t len;                    ///< Size of the file.
+    struct stat st;                ///< @c stat() results at insertion time.
+    unsigned refs;                 ///< Number of outstanding references.
+    bool indexed;                  ///< Whether the entry is still in the cache.
+};
+
+using entry_type = dyad_mod_cache_ref;
+
+/**
+ * @brief Entries in order of use, most recently used first.
+ */
+using lru_type = std::list<entry_type *>;
+
+/**
+ * @brief Index from file path to the entry's position in the LRU list.
+ */
+using index_type = std::unordered_map<std::string, lru_type::iterator>;
+
+struct dyad_mod_cache {
+    std::mutex lock;               ///< Protects every other member.
+    lru_type lru;                  ///< Indexed entries, most recently used first.
+    index_type index;              ///< Lookup table for @c lru.
+    dyad_mod_cache_stats_t stats;  ///< Counters, including the byte total.
+};
+
+/**
+ * @brief Checks whether @p st describes the same version of the file as
+ *        the one recorded in @p entry.
+ */
+static inline bool cache_entry_is_current (const entry_type *entry, const struct stat *st)
+{
+    return entry->st.st_dev == st->st_dev && entry->st.st_ino == st->st_ino
+           && entry->st.st_size == st->st_size && entry->st.st_mtim.tv_sec == st->st_mtim.tv_sec
+           && entry->st.st_mtim.tv_nsec == st->st_mtim.tv_nsec
+           && entry->st.st_ctim.tv_sec == st->st_ctim.tv_sec
+           && entry->st.st_ctim.tv_nsec == st->st_ctim.tv_nsec;
+}
+
+/**
+ * @brief Unlinks the entry at @p pos from the LRU list, leaving its index
+ *        slot to the caller. Must be called with the lock held.
+ *
+ * @details
+ * The entry is freed right away unless references to it are
+ * outstanding, in which case the last @c dyad_mod_cache_release() does.
+ */
+static inline void cache_unlink (dyad_mod_cache_t *cache, lru_type::iterator pos)
+{
+    entry_type *entry = *pos;
+    cache->lru.erase (pos);
+    cache->stats.bytes -= entry->len;
+    entry->indexed = false;
+    if (entry->refs == 0u) {
+        delete entry;
+    }
+}
+
+/**
+ * @brief Removes an entry from the cache. Must be called with the lock
+ *        held.
+ */
+static inline void cache_unindex (dyad_mod_cache_t *cache, index_type::iterator it)
+{
+    lru_type::iterator pos = it->second;
+    cache->index.erase (it);
+    cache_unlink (cache, pos);
+}
+
+dyad_rc_t dyad_mod_cache_create (size_t budget, dyad_mod_cache_t **cache)
+{
+    DYAD_C_FUNCTION_START ();
+    dyad_rc_t rc = DYAD_RC_OK;
+    if (cache == nullptr || budget == 0ul) {
+        rc = DYAD_RC_BADBUF;
+        goto cache_create_done;
+    }
+    *cache = new (std::nothrow) dyad_mod_cache_t ();
+    if (*cache == nullptr) {
+        rc = DYAD_RC_SYSFAIL;
+        goto cache_create_done;
+    }
+    (*cache)->stats.budget = budget;
+cache_create_done:;
+    DYAD_C_FUNCTION_END ();
+    return rc;
+}
+
+void dyad_mod_cache_destroy (dyad_mod_cache_t *cache)
+{
+    DYAD_C_FUNCTION_START ();
+    if (cache != nullptr) {
+        for (entry_type *entry : cache->lru) {
+            delete entry;
+        }
+        delete cache;
+    }
+    DYAD_C_FUNCTION_END ();
+}
+
+dyad_rc_t dyad_mod_cache_get (dyad_mod_cache_t *cache,
+                              const char *key,
+                              const struct stat *st,
+                              dyad_mod_cache_ref_t **ref,
+                              const char **data,
+                              size_t *len)
+{
+    DYAD_C_FUNCTION_START ();
+    dyad_rc_t rc = DYAD_RC_NOTFOUND;
+    try {
+        std::lock_guard<std::mutex> guard (cache->lock);
+        auto it = cache->index.find (key);
+        if (it == cache->index.end ()) {
+            cache->stats.misses++;
+        } else if (!cache_entry_is_current (*(it->second), st)) {
+            cache_unindex (cache, it);
+            cache->stats.invalidations++;
+            cache->stats.misses++;
+        } else {
+            entry_type *entry = *(it->second);
+            cache->lru.splice (cache->lru.begin (), cache->lru, it->second);
+            entry->refs++;
+            cache->stats.hits++;
+            *ref = entry;
+            *data = entry->data.get ();
+            *len = entry->len;
+            rc = DYAD_RC_OK;
+        }
+    } catch (...) {
+        rc = DYAD_RC_SYSFAIL;
+    }
+    DYAD_C_FUNCTION_END ();
+    return rc;
+}
+
+void dyad_mod_cache_release (dyad_mod_cache_t *cache, dyad_mod_cache_ref_t *ref)
+{
+    DYAD_C_FUNCTION_START ();
+    if (ref != nullptr) {
+        std::lock_guard<std::mutex> guard (cache->lock);
+        ref->refs--;
+        if (ref->refs == 0u && !ref->indexed) {
+            delete ref;
+        }
+    }
+    DYAD_C_FUNCTION_END ();
+}
+
+dyad_rc_t dyad_mod_cache_put (dyad_mod_cache_t *cache,
+                              const char *key,
+                              const struct stat *st,
+                              const char *data,
+                              size_t len)
+{
+    DYAD_C_FUNCTION_START ();
+    dyad_rc_t rc = DYAD_RC_OK;
+    entry_type *entry = nullptr;
+    if (len == 0ul || len > cache->stats.budget) {
+        rc = DYAD_RC_BADBUF;
+        goto cache_put_done;
+    }
+    try {
+        entry = new entry_type ();
+        entry->key = key;
+        entry->data.reset (new char[len]);
+        std::memcpy (entry->data.get (), data, len);
+        entry->len = len;
+        entry->st = *st;
+        entry->refs = 0u;
+        entry->indexed = true;
+
+        std::lock_guard<std::mutex> guard (cache->lock);
+        // Link the entry before dropping anything: only linking allocates,
+        // so that a failure leaves the cache as it was
+        cache->lru.push_front (entry);
+        auto it = cache->index.find (entry->key);
+        if (it == cache->index.end ()) {
+            try {
+                cache->index.emplace (entry->key, cache->lru.begin ());
+            } catch (...) {
+                cache->lru.pop_front ();
+                throw;
+            }
+        } else {
+            // Take over the slot of the entry being replaced
+            lru_type::iterator replaced = it->second;
+            it->second = cache->lru.begin ();
+            cache_unlink (cache, replaced);
+        }
+        while (cache->lru.back () != entry && cache->stats.bytes + len > cache->stats.budget) {
+            cache_unindex (cache, cache->index.find (cache->lru.back ()->key));
+            cache->stats.evictions++;
+        }
+        cache->stats.bytes += len;
+        rc = DYAD_RC_OK;
+    } catch (...) {
+        delete entry;
+        rc = DYAD_RC_SYSFAIL;
+    }
+cache_put_done:;
+    DYAD_C_FUNCTION_END ();
+    return rc;
+}
+
+void dyad_mod_cache_stats (dyad_mod_cache_t *cache, dyad_mod_cache_stats_t *stats)
+{
+    DYAD_C_FUNCTION_START ();
+    std::lock_guard<std::mutex> guard (cache->lock);
+    *stats = cache->stats;
+    stats->entries = cache->index.size ();
+    DYAD_C_FUNCTION_END ();
+}
@@ -0,0 +1,176 @@
+/**
+ * @file dyad_mod_cache.h
+ * @brief Bounded in-memory cache of file contents used by the DYAD Flux
+ *        module.
+ *
+ * @details
+ * Workloads that shuffle a dataset across epochs fetch the same producer
+ * file from many consumers. Without a cache, every fetch opens, locks and
+ * reads the file again. This cache keeps the contents of recently fetched
+ * files in memory, up to a fixed budget in bytes, so that repeated
+ * fetches are served without touching the file system beyond a
+ * @c stat() call.
+ *
+ * Each entry remembers the device, inode, size, modification time and
+ * status change time of the file it was loaded from. A lookup with
+ * different @c stat() results drops the entry and counts as a miss, so a
+ * file rewritten by its producer is never served stale.
+ *
+ * When an insertion would exceed the budget, the least recently used
+ * entries are evicted first. Entries are reference counted, so an entry
+ * evicted while it is still being sent stays valid until it is released.
+ * Such entries no longer count towards the budget.
+ *
+ * All functions are thread-safe and do not log, so that they can be
+ * called from the fetch worker threads as well as from the reactor.
+ */
+
+#ifndef DYAD_SERVICE_FLUX_MODULE_DYAD_MOD_CACHE_H
+#define DYAD_SERVICE_FLUX_MODULE_DYAD_MOD_CACHE_H
+
+#if defined(DYAD_HAS_CONFIG)
+#include <dyad/dyad_config.hpp>
+#else
+#error "no config"
+#endif
+
+#include <sys/stat.h>
+
+#include <dyad/common/dyad_rc.h>
+
+#ifdef __cplusplus
+#include <cstddef>
+#include <cstdint>
+
+extern "C" {
+#else
+#include <stddef.h>
+#include <stdint.h>
+#endif
+
+/**
+ * @brief Opaque file content cache handle.
+ */
+typedef struct dyad_mod_cache dyad_mod_cache_t;
+
+/**
+ * @brief Opaque reference to a cache entry returned by a successful
+ *        @c dyad_mod_cache_get().
+ */
+typedef struct dyad_mod_cache_ref dyad_mod_cache_ref_t;
+
+/**
+ * @brief Snapshot of the cache counters.
+ */
+typedef struct dyad_mod_cache_stats {
+    uint64_t hits;           ///< Lookups served from the cache.
+    uint64_t misses;         ///< Lookups of absent or stale entries.
+    uint64_t invalidations;  ///< Entries dropped because the file changed.
+    uint64_t evictions;      ///< Entries dropped to stay within the budget.
+    size_t entries;          ///< Number of entries currently cached.
+    size_t bytes;            ///< Bytes currently cached.
+    size_t budget;           ///< Maximum number of bytes cached.
+} dyad_mod_cache_stats_t;
+
+/**
+ * @brief Creates an empty cache.
+ *
+ * @param[in]  budget  Maximum number of bytes of file contents to keep.
+ *                     Must be greater than 0.
+ * @param[out] cache   Set to the newly created cache on success.
+ *
+ * @return @c dyad_rc_t return code:
+ * @retval DYAD_RC_OK       The cache was created.
+ * @retval DYAD_RC_BADBUF   @p cache is @c NULL or @p budget is 0.
+ * @retval DYAD_RC_SYSFAIL  Allocation failed.
+ */
+dyad_rc_t dyad_mod_cache_create (size_t budget, dyad_mod_cache_t **cache);
+
+/**
+ * @brief Releases the cache and every entry in it.
+ *
+ * @details
+ * Every reference returned by @c dyad_mod_cache_get() must have been
+ * released beforehand. Safe to call with @c NULL.
+ *
+ * @param[in] cache  Cache to destroy.
+ */
+void dyad_mod_cache_destroy (dyad_mod_cache_t *cache);
+
+/**
+ * @brief Looks up the contents of a file.
+ *
+ * @details
+ * On a hit, the entry becomes the most recently used one and a reference
+ * to it is returned. @p data stays valid until that reference is passed
+ * to @c dyad_mod_cache_release(), even if the entry is evicted meanwhile.
+ *
+ * @param[in]  cache  Cache to search.
+ * @param[in]  key    Path of the file.
+ * @param[in]  st     Current @c stat() results of the file, compared with
+ *                    those recorded when the entry was inserted.
+ * @param[out] ref    Set to the entry reference on a hit.
+ * @param[out] data   Set to the cached file contents on a hit.
+ * @param[out] len    Set to the size of the file on a hit.
+ *
+ * @return @c dyad_rc_t return code:
+ * @retval DYAD_RC_OK        The file was found and is up to date.
+ * @retval DYAD_RC_NOTFOUND  The file is not cached or has changed.
+ * @retval DYAD_RC_SYSFAIL   An internal allocation failed.
+ */
+dyad_rc_t dyad_mod_cache_get (dyad_mod_cache_t *cache,
+                              const char *key,
+                              const struct stat *st,
+                              dyad_mod_cache_ref_t **ref,
+                              const char **data,
+                              size_t *len);
+
+/**
+ * @brief Releases a reference returned by @c dyad_mod_cache_get().
+ *
+ * @param[in] cache  Cache the reference was obtained from.
+ * @param[in] ref    Reference to release. Ignored if @c NULL.
+ */
+void dyad_mod_cache_release (dyad_mod_cache_t *cache, dyad_mod_cache_ref_t *ref);
+
+/**
+ * @brief Inserts a copy of the contents of a file.
+ *
+ * @details
+ * Replaces any existing entry for @p key, and evicts the least recently
+ * used entries as needed to stay within the budget. Entries are only
+ * replaced or evicted once the new one is inserted, so that a failed
+ * insertion drops nothing. The copy is made before the cache lock is
+ * taken, so concurrent lookups are not held up by large insertions.
+ *
+ * @param[in] cache  Cache to insert into.
+ * @param[in] key    Path of the file.
+ * @param[in] st     @c stat() results of the file taken while @p data
+ *                   was loaded under the file's shared lock.
+ * @param[in] data   File contents.
+ * @param[in] len    Size of the file.
+ *
+ * @return @c dyad_rc_t return code:
+ * @retval DYAD_RC_OK       The file was inserted.
+ * @retval DYAD_RC_BADBUF   @p len is 0 or larger than the whole budget.
+ * @retval DYAD_RC_SYSFAIL  Allocation failed. The cache is unchanged.
+ */
+dyad_rc_t dyad_mod_cache_put (dyad_mod_cache_t *cache,
+                              const char *key,
+                              const struct stat *st,
+                              const char *data,
+                              size_t len);
+
+/**
+ * @brief Copies the current counters of the cache into @p stats.
+ *
+ * @param[in]  cache  Cache to query.
+ * @param[out] stats  Filled with the counters.
+ */
+void dyad_mod_cache_stats (dyad_mod_cache_t *cache, dyad_mod_cache_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // DYAD_SERVICE_FLUX_MODULE_DYAD_MOD_CACHE_H
@@ -0,0 +1,116 @@
+#if defined(DYAD_HAS_CONFIG)
+#include <dyad/dyad_config.hpp>
+#else
+#error "no config"
+#endif
+
+#include <dyad/common/dyad_dtl.h>
+#include <dyad/common/dyad_logging.h>
+#include <dyad/common/dyad_profiler.h>
+#include <dyad/common/dyad_structures_int.h>
+#include <dyad/dtl/dyad_dtl_api.h>
+#include <dyad/service/flux_module/dyad_mod_lanes.h>
+
+#include <pthread.h>
+#include <stdlib.h>
+
+struct dyad_mod_lanes {
+    pthread_mutex_t lock;  ///< Protects @c free and @c nfree.
+    pthread_cond_t cond;   ///< Signalled when a lane is released.
+    dyad_ctx_t *ctx;       ///< DYAD context of each lane.
+    dyad_ctx_t **free;     ///< Stack of the lanes not in use.
+    unsigned nfree;        ///< Number of entries of @c free.
+    unsigned nlanes;       ///< Number of lanes with an initialized DTL.
+};
+
+dyad_rc_t dyad_mod_lanes_create (const dyad_ctx_t *ctx, unsigned nlanes, dyad_mod_lanes_t **lanes)
+{
+    DYAD_C_FUNCTION_START ();
+    dyad_rc_t rc = DYAD_RC_OK;
+    dyad_mod_lanes_t *l = NULL;
+    dyad_ctx_t *lane = NULL;
+
+    if (ctx == NULL || ctx->dtl_handle == NULL || lanes == NULL || nlanes == 0u) {
+        rc = DYAD_RC_BADBUF;
+        goto lanes_create_done;
+    }
+    *lanes = NULL;
+
+    l = (dyad_mod_lanes_t *)calloc (1, sizeof (*l));
+    if (l == NULL) {
+        rc = DYAD_RC_SYSFAIL;
+        goto lanes_create_done;
+    }
+    pthread_mutex_init (&l->lock, NULL);
+    pthread_cond_init (&l->cond, NULL);
+    l->ctx = (dyad_ctx_t *)calloc (nlanes, sizeof (dyad_ctx_t));
+    l->free = (dyad_ctx_t **)calloc (nlanes, sizeof (dyad_ctx_t *));
+    if (l->ctx == NULL || l->free == NULL) {
+        rc = DYAD_RC_SYSFAIL;
+        goto lanes_create_error;
+    }
+    for (l->nlanes = 0u; l->nlanes < nlanes; l->nlanes++) {
+        lane = &l->ctx[l->nlanes];
+        // Share the configuration of the module, but neither its Flux
+        // handle nor its DTL handle
+        *lane = *ctx;
+        lane->h = NULL;
+        lane->dtl_handle = NULL;
+        rc = dyad_dtl_init (lane, ctx->dtl_handle->mode, DYAD_COMM_SEND, ctx->debug);
+        if (DYAD_IS_ERROR (rc)) {
+            DYAD_LOG_ERROR (ctx, "DYAD_MOD: Could not initialize the DTL of lane %u", l->nlanes);
+            // Release what dyad_dtl_init() left of the handle
+            dyad_dtl_finalize (lane);
+            goto lanes_create_error;
+        }
+        l->free[l->nfree++] = lane;
+    }
+    *lanes = l;
+    rc = DYAD_RC_OK;
+    goto lanes_create_done;
+
+lanes_create_error:;
+    dyad_mod_lanes_destroy (l);
+
+lanes_create_done:;
+    DYAD_C_FUNCTION_END ();
+    return rc;
+}
+
+dyad_ctx_t *dyad_mod_lanes_acquire (dyad_mod_lanes_t *lanes)
+{
+    dyad_ctx_t *lane = NULL;
+
+    pthread_mutex_lock (&lanes->lock);
+    while (lanes->nfree == 0u) {
+        pthread_cond_wait (&lanes->cond, &lanes->lock);
+    }
+    lane = lanes->free[--lanes->nfree];
+    pthread_mutex_unlock (&lanes->lock);
+    return lane;
+}
+
+void dyad_mod_lanes_release (dyad_mod_lanes_t *lanes, dyad_ctx_t *lane)
+{
+    pthread_mutex_lock (&lanes->lock);
+    lanes->free[lanes->nfree++] = lane;
+    pthread_cond_signal (&lanes->cond);
+    pthread_mutex_unlock (&lanes->lock);
+}
+
+void dyad_mod_lanes_destroy (dyad_mod_lanes_t *lanes)
+{
+    unsigned i = 0u;
+
+    if (lanes == NULL) {
+        return;
+    }
+    for (i = 0u; i < lanes->nlanes; i++) {
+        dyad_dtl_finalize (&lanes->ctx[i]);
+    }
+    free (lanes->free);
+    free (lanes->ctx);
+    pthread_cond_destroy (&lanes->cond);
+    pthread_mutex_destroy (&lanes->lock);
+    free (lanes);
+}
@@ -0,0 +1,102 @@
+/**
+ * @file dyad_mod_lanes.h
+ * @brief DTL handles of the DYAD Flux module that its worker threads send
+ *        from concurrently.
+ *
+ * @details
+ * The module's own DTL handle is only used from the reactor thread, so
+ * the module serves one consumer at a time, even with a worker pool. A
+ * lane is a copy of the module's DYAD context with a DTL handle of its
+ * own, i.e., with the UCX DTL, a UCP worker with its own endpoints and
+ * registered buffers in the context shared by the process. A worker
+ * thread that has loaded a file acquires a free lane, sends the file
+ * through it and releases it, so that up to as many consumers as there
+ * are lanes are served at the same time.
+ *
+ * Lanes have no Flux handle, so that the DTL never sends Flux messages
+ * from a worker thread, and their Flux-backed logs go to @c stderr.
+ *
+ * @note Only DTLs whose @c rpc_unpack(), @c establish_connection(),
+ *       @c send() and @c close_connection() do not use the Flux handle,
+ *       i.e., UCX, can send through lanes.
+ */
+
+#ifndef DYAD_SERVICE_FLUX_MODULE_DYAD_MOD_LANES_H
+#define DYAD_SERVICE_FLUX_MODULE_DYAD_MOD_LANES_H
+
+#if defined(DYAD_HAS_CONFIG)
+#include <dyad/dyad_config.hpp>
+#else
+#error "no config"
+#endif
+
+#include <dyad/common/dyad_rc.h>
+#include <dyad/common/dyad_structures.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Opaque set of lanes.
+ */
+typedef struct dyad_mod_lanes dyad_mod_lanes_t;
+
+/**
+ * @brief Creates @p nlanes lanes for the module whose context is @p ctx.
+ *
+ * @details
+ * Each lane copies @p ctx, without its Flux handle, and initializes a DTL
+ * handle of the same mode in @c DYAD_COMM_SEND mode. Must be called on
+ * the reactor thread.
+ *
+ * @param[in]  ctx     DYAD context of the module, with an initialized DTL.
+ * @param[in]  nlanes  Number of lanes. Must be greater than 0.
+ * @param[out] lanes   Set to the new lanes on success.
+ *
+ * @return @c dyad_rc_t return code:
+ * @retval DYAD_RC_OK       The lanes were created.
+ * @retval DYAD_RC_BADBUF   @p ctx or @p lanes is @c NULL or @p nlanes is 0.
+ * @retval DYAD_RC_SYSFAIL  The lanes could not be allocated.
+ * @retval DYAD_RC_*        The error of @c dyad_dtl_init() for a lane. No
+ *                          resources are leaked.
+ */
+dyad_rc_t dyad_mod_lanes_create (const dyad_ctx_t *ctx, unsigned nlanes, dyad_mod_lanes_t **lanes);
+
+/**
+ * @brief Takes a free lane, waiting for one to be released if none is.
+ *
+ * @details
+ * Thread-safe. The lane is used by the caller alone until it is given
+ * back with @c dyad_mod_lanes_release().
+ *
+ * @param[in] lanes  Lanes created by @c dyad_mod_lanes_create().
+ *
+ * @return The DYAD context of the lane.
+ */
+dyad_ctx_t *dyad_mod_lanes_acquire (dyad_mod_lanes_t *lanes);
+
+/**
+ * @brief Gives back a lane taken with @c dyad_mod_lanes_acquire().
+ *
+ * @param[in] lanes  Lanes the lane belongs to.
+ * @param[in] lane   DYAD context of the lane.
+ */
+void dyad_mod_lanes_release (dyad_mod_lanes_t *lanes, dyad_ctx_t *lane);
+
+/**
+ * @brief Finalizes the DTL handle of every lane and frees the lanes.
+ *
+ * @details
+ * No lane may be in use, i.e., the worker threads must have stopped.
+ * Safe to call with @c NULL.
+ *
+ * @param[in] lanes  Lanes to destroy.
+ */
+void dyad_mod_lanes_destroy (dyad_mod_lanes_t *lanes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // DYAD_SERVICE_FLUX_MODULE_DYAD_MOD_LANES_H
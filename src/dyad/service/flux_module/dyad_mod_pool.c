@@ -0,0 +1,317 @@
+#if defined(DYAD_HAS_CONFIG)
+#include <dyad/dyad_config.hpp>
+#else
+#error "no config"
+#endif
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif  // _GNU_SOURCE
+
+#include <dyad/common/dyad_logging.h>
+#include <dyad/common/dyad_profiler.h>
+#include <dyad/service/flux_module/dyad_mod_pool.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/**
+ * @brief Singly linked FIFO node holding one opaque job.
+ */
+struct dyad_mod_pool_node {
+    void *job;                        ///< Caller-owned job.
+    struct dyad_mod_pool_node *next;  ///< Next node in the queue.
+};
+
+/**
+ * @brief FIFO of pool nodes with O(1) push and pop.
+ */
+struct dyad_mod_pool_queue {
+    struct dyad_mod_pool_node *head;
+    struct dyad_mod_pool_node *tail;
+};
+
+struct dyad_mod_pool {
+    flux_t *h;                            ///< Non-owning Flux handle of the module.
+    flux_watcher_t *watcher;              ///< Reactor watcher on @c wake_fd[0].
+    int wake_fd[2];                       ///< Pipe used by workers to wake the reactor.
+    dyad_mod_pool_work_f work;            ///< Runs on worker threads.
+    dyad_mod_pool_done_f done;            ///< Runs on the reactor thread.
+    void *arg;                            ///< User argument for both callbacks.
+    pthread_mutex_t lock;                 ///< Protects the queues and @c stopping.
+    pthread_cond_t cond;                  ///< Signalled when @c pending grows or on stop.
+    struct dyad_mod_pool_queue pending;   ///< Jobs waiting for a worker.
+    struct dyad_mod_pool_queue finished;  ///< Jobs waiting for the reactor.
+    unsigned nqueued;                     ///< Number of jobs in @c pending.
+    unsigned max_queued;                  ///< Cap on @c nqueued, or 0 for none.
+    bool stopping;                        ///< Set by @c dyad_mod_pool_destroy().
+    unsigned nworkers;                    ///< Number of started threads.
+    pthread_t *workers;                   ///< Worker thread handles.
+};
+
+static inline void queue_push (struct dyad_mod_pool_queue *q, struct dyad_mod_pool_node *node)
+{
+    node->next = NULL;
+    if (q->tail == NULL) {
+        q->head = node;
+    } else {
+        q->tail->next = node;
+    }
+    q->tail = node;
+}
+
+static inline struct dyad_mod_pool_node *queue_pop (struct dyad_mod_pool_queue *q)
+{
+    struct dyad_mod_pool_node *node = q->head;
+    if (node != NULL) {
+        q->head = node->next;
+        if (q->head == NULL) {
+            q->tail = NULL;
+        }
+        node->next = NULL;
+    }
+    return node;
+}
+
+/**
+ * @brief Worker thread entry point.
+ *
+ * @details
+ * Pops jobs from @c pending, runs the @c work callback without holding
+ * the pool lock, moves the job to @c finished and writes one byte to the
+ * wake pipe so that the reactor picks it up. Exits once @c stopping is
+ * set, leaving any remaining pending jobs for @c dyad_mod_pool_destroy().
+ */
+static void *dyad_mod_pool_worker (void *arg)
+{
+    dyad_mod_pool_t *pool = (dyad_mod_pool_t *)arg;
+    struct dyad_mod_pool_node *node = NULL;
+    const char wake = 1;
+
+    for (;;) {
+        pthread_mutex_lock (&pool->lock);
+        while (!pool->stopping && pool->pending.head == NULL) {
+            pthread_cond_wait (&pool->cond, &pool->lock);
+        }
+        if (pool->stopping) {
+            pthread_mutex_unlock (&pool->lock);
+            break;
+        }
+        node = queue_pop (&pool->pending);
+        pool->nqueued--;
+        pthread_mutex_unlock (&pool->lock);
+
+        pool->work (node->job, pool->arg);
+
+        pthread_mutex_lock (&pool->lock);
+        queue_push (&pool->finished, node);
+        pthread_mutex_unlock (&pool->lock);
+        // A full pipe already guarantees a pending wakeup, so a failed
+        // write (EAGAIN) can be ignored.
+        (void)!write (pool->wake_fd[1], &wake, sizeof (wake));
+    }
+    return NULL;
+}
+
+/**
+ * @brief Drains the finished queue and the wake pipe.
+ *
+ * @details
+ * The finished queue is detached under the lock and then completed
+ * without holding it, so that the @c done callback may safely submit new
+ * jobs to the pool.
+ */
+static void dyad_mod_pool_drain (dyad_mod_pool_t *pool)
+{
+    char sink[64];
+    struct dyad_mod_pool_queue finished = {NULL, NULL};
+    struct dyad_mod_pool_node *node = NULL;
+
+    while (read (pool->wake_fd[0], sink, sizeof (sink)) > 0) {
+    }
+
+    pthread_mutex_lock (&pool->lock);
+    finished = pool->finished;
+    pool->finished.head = NULL;
+    pool->finished.tail = NULL;
+    pthread_mutex_unlock (&pool->lock);
+
+    while ((node = queue_pop (&finished)) != NULL) {
+        pool->done (node->job, pool->arg);
+        free (node);
+    }
+}
+
+/**
+ * @brief Reactor callback for the wake pipe.
+ */
+static void dyad_mod_pool_wake_cb (flux_reactor_t *r, flux_watcher_t *w, int revents, void *arg)
+{
+    DYAD_C_FUNCTION_START ();
+    dyad_mod_pool_drain ((dyad_mod_pool_t *)arg);
+    DYAD_C_FUNCTION_END ();
+}
+
+dyad_rc_t dyad_mod_pool_create (flux_t *h,
+                                unsigned nworkers,
+                                unsigned max_queued,
+                                dyad_mod_pool_work_f work,
+                                dyad_mod_pool_done_f done,
+                                void *arg,
+                                dyad_mod_pool_t **pool)
+{
+    DYAD_C_FUNCTION_START ();
+    dyad_rc_t rc = DYAD_RC_OK;
+    dyad_mod_pool_t *p = NULL;
+
+    if (pool == NULL || nworkers == 0u || work == NULL || done == NULL) {
+        rc = DYAD_RC_BADBUF;
+        goto pool_create_done;
+    }
+    *pool = NULL;
+
+    p = (dyad_mod_pool_t *)calloc (1, sizeof (*p));
+    if (p == NULL) {
+        rc = DYAD_RC_SYSFAIL;
+        goto pool_create_done;
+    }
+    p->h = h;
+    p->work = work;
+    p->done = done;
+    p->arg = arg;
+    p->max_queued = max_queued;
+    p->wake_fd[0] = -1;
+    p->wake_fd[1] = -1;
+    pthread_mutex_init (&p->lock, NULL);
+    pthread_cond_init (&p->cond, NULL);
+
+    if (pipe2 (p->wake_fd, O_NONBLOCK | O_CLOEXEC) < 0) {
+        rc = DYAD_RC_SYSFAIL;
+        goto pool_create_error;
+    }
+    p->watcher = flux_fd_watcher_create (flux_get_reactor (h),
+                                         p->wake_fd[0],
+                                         FLUX_POLLIN,
+                                         dyad_mod_pool_wake_cb,
+                                         p);
+    if (p->watcher == NULL) {
+        rc = DYAD_RC_SYSFAIL;
+        goto pool_create_error;
+    }
+    flux_watcher_start (p->watcher);
+
+    p->workers = (pthread_t *)calloc (nworkers, sizeof (pthread_t));
+    if (p->workers == NULL) {
+        rc = DYAD_RC_SYSFAIL;
+        goto pool_create_error;
+    }
+    for (p->nworkers = 0u; p->nworkers < nworkers; p->nworkers++) {
+        if (pthread_create (&p->workers[p->nworkers], NULL, dyad_mod_pool_worker, p) != 0) {
+            rc = DYAD_RC_SYSFAIL;
+            goto pool_create_error;
+        }
+    }
+    *pool = p;
+    rc = DYAD_RC_OK;
+    goto pool_create_done;
+
+pool_create_error:;
+    dyad_mod_pool_destroy (p);
+
+pool_create_done:;
+    DYAD_C_FUNCTION_END ();
+    return rc;
+}
+
+dyad_rc_t dyad_mod_pool_submit (dyad_mod_pool_t *pool, void *job)
+{
+    DYAD_C_FUNCTION_START ();
+    dyad_rc_t rc = DYAD_RC_OK;
+    struct dyad_mod_pool_node *node = NULL;
+
+    if (pool == NULL || job == NULL) {
+        rc = DYAD_RC_BADBUF;
+        goto pool_submit_done;
+    }
+    node = (struct dyad_mod_pool_node *)malloc (sizeof (*node));
+    if (node == NULL) {
+        rc = DYAD_RC_SYSFAIL;
+        goto pool_submit_done;
+    }
+    node->job = job;
+
+    pthread_mutex_lock (&pool->lock);
+    if (pool->stopping) {
+        pthread_mutex_unlock (&pool->lock);
+        free (node);
+        rc = DYAD_RC_SYSFAIL;
+        goto pool_submit_done;
+    }
+    queue_push (&pool->pending, node);
+    pool->nqueued++;
+    pthread_cond_signal (&pool->cond);
+    pthread_mutex_unlock (&pool->lock);
+    rc = DYAD_RC_OK;
+
+pool_submit_done:;
+    DYAD_C_FUNCTION_END ();
+    return rc;
+}
+
+bool dyad_mod_pool_full (dyad_mod_pool_t *pool)
+{
+    bool full = false;
+    pthread_mutex_lock (&pool->lock);
+    full = (pool->max_queued > 0u && pool->nqueued >= pool->max_queued);
+    pthread_mutex_unlock (&pool->lock);
+    return full;
+}
+
+void dyad_mod_pool_destroy (dyad_mod_pool_t *pool)
+{
+    DYAD_C_FUNCTION_START ();
+    struct dyad_mod_pool_node *node = NULL;
+    if (pool == NULL) {
+        goto pool_destroy_done;
+    }
+
+    pthread_mutex_lock (&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast (&pool->cond);
+    pthread_mutex_unlock (&pool->lock);
+    for (unsigned i = 0u; i < pool->nworkers; i++) {
+        pthread_join (pool->workers[i], NULL);
+    }
+    free (pool->workers);
+    pool->workers = NULL;
+    pool->nworkers = 0u;
+
+    // Complete whatever the workers already finished, then hand back the
+    // jobs that never ran so the caller can release them.
+    if (pool->wake_fd[0] >= 0) {
+        dyad_mod_pool_drain (pool);
+    }
+    while ((node = queue_pop (&pool->pending)) != NULL) {
+        pool->done (node->job, pool->arg);
+        free (node);
+    }
+
+    flux_watcher_destroy (pool->watcher);
+    pool->watcher = NULL;
+    if (pool->wake_fd[0] >= 0) {
+        close (pool->wake_fd[0]);
+    }
+    if (pool->wake_fd[1] >= 0) {
+        close (pool->wake_fd[1]);
+    }
+    pthread_cond_destroy (&pool->cond);
+    pthread_mutex_destroy (&pool->lock);
+    free (pool);
+
+pool_destroy_done:;
+    DYAD_C_FUNCTION_END ();
+}
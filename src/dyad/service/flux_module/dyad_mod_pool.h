@@ -0,0 +1,148 @@
+/**
+ * @file dyad_mod_pool.h
+ * @brief Bounded worker thread pool used by the DYAD Flux module.
+ *
+ * @details
+ * The DYAD module services every fetch request on the broker's reactor
+ * thread by default. A single large file therefore stalls every other
+ * consumer on the node. This pool lets the module hand the blocking part
+ * of a request (file open, lock and read) to a fixed number of worker
+ * threads, while the part of the request that touches the Flux handle or
+ * the DTL handle is completed back on the reactor.
+ *
+ * Jobs are opaque to the pool. Each submitted job is passed to the
+ * @c work callback on one of the worker threads. Once that returns, the
+ * job is queued for completion and the reactor is woken through a pipe
+ * watched by a Flux fd watcher, which then invokes the @c done callback
+ * on the reactor thread.
+ *
+ * The number of jobs waiting for a worker can be capped, so that a burst
+ * of requests does not grow the queue without bound. The pool does not
+ * enforce the cap itself: the caller checks @c dyad_mod_pool_full() before
+ * admitting a new request, and may still resubmit a job it already
+ * admitted, e.g., for the next chunk of a file.
+ *
+ * @note Neither the Flux handle nor the DTL handles are thread-safe.
+ *       The @c work callback must not log through a Flux-backed logger,
+ *       send Flux messages or call into the DTL. Everything of that kind
+ *       belongs in the @c done callback.
+ */
+
+#ifndef DYAD_SERVICE_FLUX_MODULE_DYAD_MOD_POOL_H
+#define DYAD_SERVICE_FLUX_MODULE_DYAD_MOD_POOL_H
+
+#if defined(DYAD_HAS_CONFIG)
+#include <dyad/dyad_config.hpp>
+#else
+#error "no config"
+#endif
+
+#include <flux/core.h>
+#include <stdbool.h>
+
+#include <dyad/common/dyad_rc.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Callback executed on a worker thread for each submitted job.
+ *
+ * @param[in,out] job  The job passed to @c dyad_mod_pool_submit().
+ * @param[in]     arg  User argument given to @c dyad_mod_pool_create().
+ */
+typedef void (*dyad_mod_pool_work_f) (void *job, void *arg);
+
+/**
+ * @brief Callback executed on the reactor thread once a job's @c work
+ *        callback has returned.
+ *
+ * @details
+ * Ownership of @p job returns to the caller here. The callback is
+ * responsible for releasing any resources associated with the job.
+ *
+ * @param[in,out] job  The job passed to @c dyad_mod_pool_submit().
+ * @param[in]     arg  User argument given to @c dyad_mod_pool_create().
+ */
+typedef void (*dyad_mod_pool_done_f) (void *job, void *arg);
+
+/**
+ * @brief Opaque worker pool handle.
+ */
+typedef struct dyad_mod_pool dyad_mod_pool_t;
+
+/**
+ * @brief Creates a worker pool and attaches its completion watcher to the
+ *        reactor of @p h.
+ *
+ * @param[in]  h           Flux handle whose reactor runs the @p done callbacks.
+ * @param[in]  nworkers    Number of worker threads. Must be greater than 0.
+ * @param[in]  max_queued  Number of waiting jobs from which
+ *                         @c dyad_mod_pool_full() is true, 0 for no limit.
+ * @param[in]  work        Callback run on a worker thread for each job.
+ * @param[in]  done        Callback run on the reactor for each finished job.
+ * @param[in]  arg         User argument passed to both callbacks.
+ * @param[out] pool        Set to the newly created pool on success.
+ *
+ * @return @c dyad_rc_t return code:
+ * @retval DYAD_RC_OK       The pool was created and its threads started.
+ * @retval DYAD_RC_BADBUF   @p pool is @c NULL or @p nworkers is 0.
+ * @retval DYAD_RC_SYSFAIL  Allocation, pipe, watcher or thread creation
+ *                          failed. No resources are leaked.
+ */
+dyad_rc_t dyad_mod_pool_create (flux_t *h,
+                                unsigned nworkers,
+                                unsigned max_queued,
+                                dyad_mod_pool_work_f work,
+                                dyad_mod_pool_done_f done,
+                                void *arg,
+                                dyad_mod_pool_t **pool);
+
+/**
+ * @brief Queues a job for execution by the worker threads.
+ *
+ * @details
+ * Never blocks on I/O. Jobs are executed in submission order, but may
+ * complete out of order when more than one worker is configured.
+ *
+ * @param[in] pool  Pool created by @c dyad_mod_pool_create().
+ * @param[in] job   Caller-owned job. Must remain valid until the @c done
+ *                  callback has been invoked for it.
+ *
+ * @return @c dyad_rc_t return code:
+ * @retval DYAD_RC_OK       The job was queued.
+ * @retval DYAD_RC_BADBUF   @p pool or @p job is @c NULL.
+ * @retval DYAD_RC_SYSFAIL  The queue node could not be allocated, or the
+ *                          pool is shutting down.
+ */
+dyad_rc_t dyad_mod_pool_submit (dyad_mod_pool_t *pool, void *job);
+
+/**
+ * @brief Tells whether as many jobs as the cap given to
+ *        @c dyad_mod_pool_create() wait for a worker.
+ *
+ * @param[in] pool  Pool created by @c dyad_mod_pool_create().
+ *
+ * @return @c true if new requests should be turned away for now.
+ */
+bool dyad_mod_pool_full (dyad_mod_pool_t *pool);
+
+/**
+ * @brief Stops the worker threads and releases the pool.
+ *
+ * @details
+ * Jobs still waiting in the queue are not executed. Their @c done
+ * callback is invoked with the job so that the caller can release it.
+ * Jobs already being executed are allowed to finish, and are completed
+ * in the same way. Safe to call with @c NULL.
+ *
+ * @param[in] pool  Pool to destroy.
+ */
+void dyad_mod_pool_destroy (dyad_mod_pool_t *pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // DYAD_SERVICE_FLUX_MODULE_DYAD_MOD_POOL_H
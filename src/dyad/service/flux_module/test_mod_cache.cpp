@@ -0,0 +1,321 @@
+/**
+ * @file test_mod_cache.cpp
+ * @brief Self-checking test of the eviction policy of the file content
+ *        cache of the DYAD module.
+ *
+ * @details
+ * Checks that inserting past the byte budget evicts the least recently
+ * used entries and only as many as needed, that replacing an entry does
+ * not evict others, that an evicted entry stays readable while it is
+ * referenced, and that an insertion failing because the file is too large
+ * or because an allocation failed leaves the cache as it was. Allocation
+ * failures are injected by replacing the global @c operator @c new.
+ * Each failed check is printed to @c stderr.
+ *
+ * This is a standalone test executable and is not part of the DYAD module.
+ *
+ * Usage:
+ * @code
+ *   test_mod_cache
+ * @endcode
+ *
+ * @retval EXIT_SUCCESS  All checks passed.
+ * @retval EXIT_FAILURE  At least one check failed.
+ */
+
+#if defined(DYAD_HAS_CONFIG)
+#include <dyad/dyad_config.hpp>
+#else
+#error "no config"
+#endif
+
+// clang-format off
+#include <dyad/service/flux_module/dyad_mod_cache.h>
+// clang-format on
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                                   \
+    do {                                                                              \
+        if (!(cond)) {                                                                \
+            fprintf (stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                               \
+        }                                                                             \
+    } while (0)
+
+// Number of allocations to let through before failing, or -1 to never fail
+static long alloc_countdown = -1l;
+
+void *operator new (std::size_t size)
+{
+    if (alloc_countdown == 0l) {
+        throw std::bad_alloc ();
+    }
+    if (alloc_countdown > 0l) {
+        alloc_countdown--;
+    }
+    void *p = std::malloc (size > 0ul ? size : 1ul);
+    if (p == nullptr) {
+        throw std::bad_alloc ();
+    }
+    return p;
+}
+
+void *operator new[] (std::size_t size)
+{
+    return operator new (size);
+}
+
+void *operator new (std::size_t size, const std::nothrow_t &) noexcept
+{
+    try {
+        return operator new (size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void *operator new[] (std::size_t size, const std::nothrow_t &) noexcept
+{
+    return operator new (size, std::nothrow);
+}
+
+void operator delete (void *p) noexcept
+{
+    std::free (p);
+}
+
+void operator delete[] (void *p) noexcept
+{
+    std::free (p);
+}
+
+void operator delete (void *p, std::size_t) noexcept
+{
+    std::free (p);
+}
+
+void operator delete[] (void *p, std::size_t) noexcept
+{
+    std::free (p);
+}
+
+/**
+ * @brief Returns the @c stat() results of a file of @p len bytes whose
+ *        inode number is @p ino.
+ */
+static struct stat make_stat (ino_t ino, size_t len)
+{
+    struct stat st;
+    std::memset (&st, 0, sizeof (st));
+    st.st_dev = 1;
+    st.st_ino = ino;
+    st.st_size = (off_t)len;
+    return st;
+}
+
+/**
+ * @brief Inserts @p len bytes of @p fill under @p key.
+ */
+static dyad_rc_t put (dyad_mod_cache_t *cache, const char *key, ino_t ino, size_t len, char fill)
+{
+    std::string data (len, fill);
+    struct stat st = make_stat (ino, len);
+    return dyad_mod_cache_put (cache, key, &st, data.data (), len);
+}
+
+/**
+ * @brief Tells whether @p key is cached with @p len bytes of @p fill,
+ *        making it the most recently used entry.
+ */
+static bool has (dyad_mod_cache_t *cache, const char *key, ino_t ino, size_t len, char fill)
+{
+    struct stat st = make_stat (ino, len);
+    dyad_mod_cache_ref_t *ref = nullptr;
+    const char *data = nullptr;
+    size_t data_len = 0ul;
+    if (dyad_mod_cache_get (cache, key, &st, &ref, &data, &data_len) != DYAD_RC_OK) {
+        return false;
+    }
+    bool ok = (data_len == len && std::string (data, data_len) == std::string (len, fill));
+    dyad_mod_cache_release (cache, ref);
+    return ok;
+}
+
+static dyad_mod_cache_stats_t stats_of (dyad_mod_cache_t *cache)
+{
+    dyad_mod_cache_stats_t stats;
+    dyad_mod_cache_stats (cache, &stats);
+    return stats;
+}
+
+static void test_budget ()
+{
+    dyad_mod_cache_t *cache = nullptr;
+    dyad_mod_cache_stats_t stats;
+
+    CHECK (dyad_mod_cache_create (100ul, &cache) == DYAD_RC_OK);
+    if (cache == nullptr) {
+        return;
+    }
+    CHECK (put (cache, "a", 1, 40ul, 'a') == DYAD_RC_OK);
+    CHECK (put (cache, "b", 2, 40ul, 'b') == DYAD_RC_OK);
+    // Using "a" leaves "b" as the least recently used entry
+    CHECK (has (cache, "a", 1, 40ul, 'a'));
+    CHECK (put (cache, "c", 3, 40ul, 'c') == DYAD_RC_OK);
+    stats = stats_of (cache);
+    CHECK (stats.bytes == 80ul);
+    CHECK (stats.entries == 2ul);
+    CHECK (stats.evictions == 1u);
+    CHECK (!has (cache, "b", 2, 40ul, 'b'));
+    CHECK (has (cache, "a", 1, 40ul, 'a'));
+    CHECK (has (cache, "c", 3, 40ul, 'c'));
+
+    // Filling the budget exactly evicts nothing
+    CHECK (put (cache, "d", 4, 20ul, 'd') == DYAD_RC_OK);
+    stats = stats_of (cache);
+    CHECK (stats.bytes == 100ul);
+    CHECK (stats.entries == 3ul);
+    CHECK (stats.evictions == 1u);
+
+    // A large file evicts as many entries as it needs, oldest first
+    CHECK (put (cache, "e", 5, 70ul, 'e') == DYAD_RC_OK);
+    stats = stats_of (cache);
+    CHECK (stats.bytes == 90ul);
+    CHECK (stats.entries == 2ul);
+    CHECK (stats.evictions == 3u);
+    CHECK (has (cache, "d", 4, 20ul, 'd'));
+    CHECK (has (cache, "e", 5, 70ul, 'e'));
+
+    // Replacing an entry frees its bytes rather than evicting another
+    CHECK (put (cache, "e", 6, 80ul, 'E') == DYAD_RC_OK);
+    stats = stats_of (cache);
+    CHECK (stats.bytes == 100ul);
+    CHECK (stats.entries == 2ul);
+    CHECK (stats.evictions == 3u);
+    CHECK (has (cache, "e", 6, 80ul, 'E'));
+    CHECK (has (cache, "d", 4, 20ul, 'd'));
+
+    // A file of the whole budget fits alone
+    CHECK (put (cache, "f", 7, 100ul, 'f') == DYAD_RC_OK);
+    stats = stats_of (cache);
+    CHECK (stats.bytes == 100ul);
+    CHECK (stats.entries == 1ul);
+    CHECK (has (cache, "f", 7, 100ul, 'f'));
+    dyad_mod_cache_destroy (cache);
+}
+
+static void test_evicted_ref ()
+{
+    dyad_mod_cache_t *cache = nullptr;
+    dyad_mod_cache_ref_t *ref = nullptr;
+    const char *data = nullptr;
+    size_t len = 0ul;
+    struct stat st = make_stat (1, 60ul);
+
+    CHECK (dyad_mod_cache_create (100ul, &cache) == DYAD_RC_OK);
+    if (cache == nullptr) {
+        return;
+    }
+    CHECK (put (cache, "a", 1, 60ul, 'a') == DYAD_RC_OK);
+    CHECK (dyad_mod_cache_get (cache, "a", &st, &ref, &data, &len) == DYAD_RC_OK);
+    CHECK (put (cache, "b", 2, 60ul, 'b') == DYAD_RC_OK);
+    // Evicted entries no longer count towards the budget
+    CHECK (stats_of (cache).bytes == 60ul);
+    CHECK (!has (cache, "a", 1, 60ul, 'a'));
+    CHECK (len == 60ul && data != nullptr && std::string (data, len) == std::string (60ul, 'a'));
+    dyad_mod_cache_release (cache, ref);
+    dyad_mod_cache_destroy (cache);
+}
+
+static void test_failed_put ()
+{
+    dyad_mod_cache_t *cache = nullptr;
+    dyad_mod_cache_stats_t stats;
+    dyad_rc_t rc = DYAD_RC_OK;
+    long n = 0l;
+
+    CHECK (dyad_mod_cache_create (100ul, &cache) == DYAD_RC_OK);
+    if (cache == nullptr) {
+        return;
+    }
+    CHECK (put (cache, "a", 1, 50ul, 'a') == DYAD_RC_OK);
+    CHECK (put (cache, "b", 2, 50ul, 'b') == DYAD_RC_OK);
+
+    // Too large or empty files are rejected without evicting anything
+    CHECK (put (cache, "c", 3, 101ul, 'c') == DYAD_RC_BADBUF);
+    CHECK (put (cache, "c", 3, 0ul, 'c') == DYAD_RC_BADBUF);
+    CHECK (put (cache, "a", 4, 101ul, 'A') == DYAD_RC_BADBUF);
+    stats = stats_of (cache);
+    CHECK (stats.bytes == 100ul);
+    CHECK (stats.entries == 2ul);
+    CHECK (stats.evictions == 0u);
+    CHECK (has (cache, "a", 1, 50ul, 'a'));
+    CHECK (has (cache, "b", 2, 50ul, 'b'));
+
+    // Fail each allocation of an insertion in turn, until it succeeds
+    for (n = 0l;; n++) {
+        std::string data (50ul, 'c');
+        struct stat st = make_stat (3, 50ul);
+        alloc_countdown = n;
+        rc = dyad_mod_cache_put (cache, "c", &st, data.data (), 50ul);
+        alloc_countdown = -1l;
+        if (rc != DYAD_RC_SYSFAIL) {
+            break;
+        }
+        stats = stats_of (cache);
+        CHECK (stats.bytes == 100ul);
+        CHECK (stats.entries == 2ul);
+        CHECK (stats.evictions == 0u);
+        CHECK (has (cache, "a", 1, 50ul, 'a'));
+        CHECK (has (cache, "b", 2, 50ul, 'b'));
+    }
+    CHECK (rc == DYAD_RC_OK);
+    CHECK (n > 0l);
+    stats = stats_of (cache);
+    CHECK (stats.bytes == 100ul);
+    CHECK (stats.entries == 2ul);
+    CHECK (stats.evictions == 1u);
+    CHECK (has (cache, "b", 2, 50ul, 'b'));
+    CHECK (has (cache, "c", 3, 50ul, 'c'));
+
+    // Nor does a failed replacement drop the entry it would replace
+    for (n = 0l;; n++) {
+        std::string data (50ul, 'C');
+        struct stat st = make_stat (4, 50ul);
+        alloc_countdown = n;
+        rc = dyad_mod_cache_put (cache, "c", &st, data.data (), 50ul);
+        alloc_countdown = -1l;
+        if (rc != DYAD_RC_SYSFAIL) {
+            break;
+        }
+        CHECK (stats_of (cache).bytes == 100ul);
+        CHECK (has (cache, "c", 3, 50ul, 'c'));
+        CHECK (has (cache, "b", 2, 50ul, 'b'));
+    }
+    CHECK (rc == DYAD_RC_OK);
+    CHECK (has (cache, "c", 4, 50ul, 'C'));
+    CHECK (has (cache, "b", 2, 50ul, 'b'));
+    CHECK (stats_of (cache).evictions == 1u);
+    dyad_mod_cache_destroy (cache);
+}
+
+int main ()
+{
+    test_budget ();
+    test_evicted_ref ();
+    test_failed_put ();
+
+    if (failures > 0) {
+        fprintf (stderr, "%d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf ("All checks passed\n");
+    return EXIT_SUCCESS;
+}
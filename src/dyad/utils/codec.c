@@ -0,0 +1,219 @@
+#if defined(DYAD_HAS_CONFIG)
+#include <dyad/dyad_config.hpp>
+#else
+#error "no config"
+#endif
+
+#include <errno.h>
+#include <string.h>
+#include <strings.h>
+
+#ifdef DYAD_ENABLE_LZ4
+#include <lz4.h>
+#endif
+#ifdef DYAD_ENABLE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "codec.h"
+
+/**
+ * @brief Zstandard level used for transfers. Low levels keep the
+ *        compression speed close to that of the network.
+ */
+#define DYAD_ZSTD_LEVEL 1
+
+static const char *const codec_names[] = {"none", "lz4", "zstd"};
+
+int dyad_codec_from_name (const char *name)
+{
+    size_t i = 0ul;
+    if (name == NULL) {
+        return -1;
+    }
+    for (i = 0ul; i < sizeof (codec_names) / sizeof (codec_names[0]); i++) {
+        if (strcasecmp (name, codec_names[i]) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+const char *dyad_codec_name (dyad_codec_t codec)
+{
+    if ((size_t)codec >= sizeof (codec_names) / sizeof (codec_names[0])) {
+        return "unknown";
+    }
+    return codec_names[codec];
+}
+
+bool dyad_codec_is_available (dyad_codec_t codec)
+{
+    switch (codec) {
+        case DYAD_CODEC_NONE:
+            return true;
+#ifdef DYAD_ENABLE_LZ4
+        case DYAD_CODEC_LZ4:
+            return true;
+#endif
+#ifdef DYAD_ENABLE_ZSTD
+        case DYAD_CODEC_ZSTD:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Returns the largest size @p codec can compress @p len bytes to,
+ *        or 0 if it cannot compress them.
+ */
+static size_t codec_compress_bound (dyad_codec_t codec, size_t len)
+{
+    switch (codec) {
+#ifdef DYAD_ENABLE_LZ4
+        case DYAD_CODEC_LZ4:
+            return (len <= (size_t)LZ4_MAX_INPUT_SIZE) ? (size_t)LZ4_compressBound ((int)len)
+                                                        : 0ul;
+#endif
+#ifdef DYAD_ENABLE_ZSTD
+        case DYAD_CODEC_ZSTD:
+            return ZSTD_compressBound (len);
+#endif
+        default:
+            return 0ul;
+    }
+}
+
+/**
+ * @brief Compresses @p len bytes of @p src into @p dst, which can hold at
+ *        least @c codec_compress_bound() bytes.
+ *
+ * @return The compressed size, or 0 on failure.
+ */
+static size_t codec_compress (dyad_codec_t codec,
+                              const void *src,
+                              size_t len,
+                              void *dst,
+                              size_t cap)
+{
+    switch (codec) {
+#ifdef DYAD_ENABLE_LZ4
+        case DYAD_CODEC_LZ4: {
+            int n = LZ4_compress_default ((const char *)src,
+                                          (char *)dst,
+                                          (int)len,
+                                          LZ4_compressBound ((int)len));
+            return (n > 0) ? (size_t)n : 0ul;
+        }
+#endif
+#ifdef DYAD_ENABLE_ZSTD
+        case DYAD_CODEC_ZSTD: {
+            size_t n = ZSTD_compress (dst, cap, src, len, DYAD_ZSTD_LEVEL);
+            return ZSTD_isError (n) ? 0ul : n;
+        }
+#endif
+        default:
+            return 0ul;
+    }
+}
+
+size_t dyad_frame_bound (dyad_codec_t codec, size_t len)
+{
+    size_t bound = codec_compress_bound (codec, len);
+    return sizeof (dyad_frame_header_t) + ((bound > len) ? bound : len);
+}
+
+size_t dyad_frame_encode (dyad_codec_t codec,
+                          const void *src,
+                          size_t len,
+                          void *dst,
+                          size_t cap)
+{
+    dyad_frame_header_t header;
+    size_t n = 0ul;
+    size_t bound = codec_compress_bound (codec, len);
+    const size_t hlen = sizeof (header);
+
+    header.magic = DYAD_FRAME_MAGIC;
+    header.raw_len = (uint64_t)len;
+    if (bound > 0ul && cap >= hlen + bound) {
+        n = codec_compress (codec, src, len, (char *)dst + hlen, bound);
+    }
+    if (n > 0ul && hlen + n < len) {
+        header.codec = (uint32_t)codec;
+        memcpy (dst, &header, hlen);
+        return hlen + n;
+    }
+    // Otherwise the consumer would take the message for a frame
+    if (dyad_frame_check (src, len, &n)) {
+        if (cap < hlen + len) {
+            return 0ul;
+        }
+        header.codec = (uint32_t)DYAD_CODEC_NONE;
+        memcpy (dst, &header, hlen);
+        memcpy ((char *)dst + hlen, src, len);
+        return hlen + len;
+    }
+    return 0ul;
+}
+
+bool dyad_frame_check (const void *buf, size_t len, size_t *raw_len)
+{
+    dyad_frame_header_t header;
+    if (buf == NULL || len < sizeof (header)) {
+        return false;
+    }
+    memcpy (&header, buf, sizeof (header));
+    if (header.magic != DYAD_FRAME_MAGIC) {
+        return false;
+    }
+    *raw_len = (size_t)header.raw_len;
+    return true;
+}
+
+int dyad_frame_decode (const void *buf, size_t len, void *dst, size_t raw_len)
+{
+    dyad_frame_header_t header;
+    const char *payload = (const char *)buf + sizeof (header);
+    const size_t payload_len = len - sizeof (header);
+
+    memcpy (&header, buf, sizeof (header));
+    if ((size_t)header.raw_len != raw_len) {
+        errno = EPROTO;
+        return -1;
+    }
+    switch (header.codec) {
+        case DYAD_CODEC_NONE:
+            if (payload_len != raw_len) {
+                errno = EPROTO;
+                return -1;
+            }
+            memcpy (dst, payload, raw_len);
+            return 0;
+#ifdef DYAD_ENABLE_LZ4
+        case DYAD_CODEC_LZ4:
+            if (raw_len > (size_t)LZ4_MAX_INPUT_SIZE
+                || LZ4_decompress_safe (payload, (char *)dst, (int)payload_len, (int)raw_len)
+                       != (int)raw_len) {
+                errno = EPROTO;
+                return -1;
+            }
+            return 0;
+#endif
+#ifdef DYAD_ENABLE_ZSTD
+        case DYAD_CODEC_ZSTD: {
+            size_t n = ZSTD_decompress (dst, raw_len, payload, payload_len);
+            if (ZSTD_isError (n) || n != raw_len) {
+                errno = EPROTO;
+                return -1;
+            }
+            return 0;
+        }
+#endif
+        default:
+            errno = ENOTSUP;
+            return -1;
+    }
+}
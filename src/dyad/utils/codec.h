@@ -0,0 +1,148 @@
+/**
+ * @file codec.h
+ * @brief Optional compression of the file contents sent between the DYAD
+ *        module and its consumers.
+ *
+ * @details
+ * Every message of a transfer for which a consumer asked for compression
+ * is either sent as is or wrapped in a frame: a @c dyad_frame_header_t
+ * followed by the payload, compressed with the codec named in the header.
+ * Messages are framed independently, so chunked and batched transfers can
+ * be decoded one message at a time as they arrive.
+ *
+ * A message that does not pay off being compressed is sent as is, unless
+ * it happens to start with @c DYAD_FRAME_MAGIC, in which case it is framed
+ * with @c DYAD_CODEC_NONE so that it cannot be mistaken for a frame.
+ *
+ * The codecs are only available if DYAD was built with them
+ * (@c DYAD_ENABLE_LZ4, @c DYAD_ENABLE_ZSTD). Frames are not portable
+ * across byte orders.
+ */
+
+#ifndef DYAD_UTILS_CODEC_H
+#define DYAD_UTILS_CODEC_H
+
+#if defined(DYAD_HAS_CONFIG)
+#include <dyad/dyad_config.hpp>
+#else
+#error "no config"
+#endif
+
+#ifdef __cplusplus
+#include <cstddef>
+#include <cstdint>
+
+extern "C" {
+#else
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#endif
+
+/**
+ * @brief Compression codecs that can be negotiated for a transfer.
+ */
+enum dyad_codec {
+    DYAD_CODEC_NONE = 0,  ///< No compression
+    DYAD_CODEC_LZ4 = 1,   ///< LZ4, favoring speed
+    DYAD_CODEC_ZSTD = 2,  ///< Zstandard at a low level, favoring ratio
+};
+typedef enum dyad_codec dyad_codec_t;
+
+/**
+ * @brief First four bytes of every frame ("DYZ" followed by 0x01).
+ */
+#define DYAD_FRAME_MAGIC 0x015a5944u
+
+/**
+ * @brief Header placed in front of the payload of a frame.
+ */
+typedef struct dyad_frame_header {
+    uint32_t magic;    ///< Always @c DYAD_FRAME_MAGIC
+    uint32_t codec;    ///< @c dyad_codec_t the payload is encoded with
+    uint64_t raw_len;  ///< Size of the message once decoded
+} dyad_frame_header_t;
+
+/**
+ * @brief Looks up a codec by the name used in the RPC payload and in
+ *        @c DYAD_COMPRESSION.
+ *
+ * @param[in] name  @c "none", @c "lz4" or @c "zstd", case-insensitive.
+ *
+ * @return The codec, or -1 if @p name is @c NULL or unknown.
+ */
+int dyad_codec_from_name (const char *name);
+
+/**
+ * @brief Returns the name of @p codec, as accepted by
+ *        @c dyad_codec_from_name().
+ */
+const char *dyad_codec_name (dyad_codec_t codec);
+
+/**
+ * @brief Tells whether DYAD was built with support for @p codec.
+ *        @c DYAD_CODEC_NONE is always available.
+ */
+bool dyad_codec_is_available (dyad_codec_t codec);
+
+/**
+ * @brief Returns the size of the buffer @c dyad_frame_encode() needs to
+ *        frame @p len bytes with @p codec.
+ */
+size_t dyad_frame_bound (dyad_codec_t codec, size_t len);
+
+/**
+ * @brief Frames @p len bytes of @p src, compressing them with @p codec.
+ *
+ * @details
+ * If @p codec is unavailable, fails, or does not make @p src smaller,
+ * @p src is framed with @c DYAD_CODEC_NONE if it starts with
+ * @c DYAD_FRAME_MAGIC, and is left to be sent as is otherwise.
+ *
+ * Thread-safe, and does not log.
+ *
+ * @param[in]  codec  Codec to compress with, or @c DYAD_CODEC_NONE.
+ * @param[in]  src    Message to send.
+ * @param[in]  len    Size of @p src.
+ * @param[out] dst    Buffer receiving the frame.
+ * @param[in]  cap    Size of @p dst, at least @c dyad_frame_bound().
+ *
+ * @return The size of the frame written to @p dst, or 0 if @p src is to
+ *         be sent as is.
+ */
+size_t dyad_frame_encode (dyad_codec_t codec,
+                          const void *src,
+                          size_t len,
+                          void *dst,
+                          size_t cap);
+
+/**
+ * @brief Tells whether a received message is a frame.
+ *
+ * @param[in]  buf      Received message.
+ * @param[in]  len      Size of @p buf.
+ * @param[out] raw_len  Set to the size of the decoded message if @p buf is
+ *                      a frame.
+ *
+ * @return @c true if @p buf starts with a frame header.
+ */
+bool dyad_frame_check (const void *buf, size_t len, size_t *raw_len);
+
+/**
+ * @brief Decodes the frame @p buf into @p dst.
+ *
+ * @param[in]  buf      Frame, as accepted by @c dyad_frame_check().
+ * @param[in]  len      Size of @p buf.
+ * @param[out] dst      Buffer receiving the decoded message.
+ * @param[in]  raw_len  Size of @p dst, as returned by @c dyad_frame_check().
+ *
+ * @return 0 on success, or -1 with @c errno set to @c ENOTSUP if the codec
+ *         is unavailable, or to @c EPROTO if the frame is corrupted.
+ */
+int dyad_frame_decode (const void *buf, size_t len, void *dst, size_t raw_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // DYAD_UTILS_CODEC_H
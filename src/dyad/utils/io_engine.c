@@ -0,0 +1,303 @@
+#if defined(DYAD_HAS_CONFIG)
+#include <dyad/dyad_config.hpp>
+#else
+#error "no config"
+#endif
+
+#include <dyad/common/dyad_structures_int.h>
+#include <errno.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#ifdef DYAD_ENABLE_IO_URING
+#include <liburing.h>
+#include <pthread.h>
+#include <stdlib.h>
+#endif
+
+#include "io_engine.h"
+
+static const char *const engine_names[] = {"posix", "io_uring"};
+
+int dyad_io_engine_from_name (const char *name)
+{
+    size_t i = 0ul;
+    if (name == NULL) {
+        return -1;
+    }
+    for (i = 0ul; i < sizeof (engine_names) / sizeof (engine_names[0]); i++) {
+        if (strcasecmp (name, engine_names[i]) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+const char *dyad_io_engine_name (dyad_io_engine_t engine)
+{
+    if ((size_t)engine >= sizeof (engine_names) / sizeof (engine_names[0])) {
+        return "unknown";
+    }
+    return engine_names[engine];
+}
+
+bool dyad_io_engine_is_available (dyad_io_engine_t engine)
+{
+    switch (engine) {
+        case DYAD_IO_ENGINE_POSIX:
+            return true;
+#ifdef DYAD_ENABLE_IO_URING
+        case DYAD_IO_ENGINE_IO_URING:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Transfers @p len bytes between @p buf and @p fd at @p offset with
+ *        @c pread() or @c pwrite(), one piece at a time.
+ */
+static ssize_t posix_transfer (bool is_write, int fd, char *buf, size_t len, off_t offset)
+{
+    size_t done = 0ul;
+    ssize_t n = 0l;
+    while (done < len) {
+        const size_t size = (len - done) > (size_t)DYAD_POSIX_TRANSFER_GRANULARITY
+                                ? (size_t)DYAD_POSIX_TRANSFER_GRANULARITY
+                                : (len - done);
+        n = is_write ? pwrite (fd, buf + done, size, offset + (off_t)done)
+                     : pread (fd, buf + done, size, offset + (off_t)done);
+        if (n < 0l && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0l) {
+            if (n == 0l) {
+                errno = is_write ? EIO : ENODATA;
+            }
+            break;
+        }
+        done += (size_t)n;
+    }
+    return (ssize_t)done;
+}
+
+#ifdef DYAD_ENABLE_IO_URING
+/**
+ * @brief One block of a transfer, tracked from submission to completion.
+ */
+typedef struct uring_slot {
+    char *buf;      ///< Part of the caller's buffer left to transfer.
+    size_t len;     ///< Number of bytes left to transfer.
+    off_t offset;   ///< File offset of @c buf.
+    bool busy;      ///< Whether the block is part of the current transfer.
+    bool resubmit;  ///< Whether the block must be submitted (again).
+} uring_slot_t;
+
+/**
+ * @brief Ring of a thread, set up on first use.
+ */
+typedef struct uring_state {
+    struct io_uring ring;
+    bool failed;  ///< Whether the ring could not be set up.
+    uring_slot_t slots[DYAD_IO_URING_QUEUE_DEPTH];
+} uring_state_t;
+
+static pthread_key_t uring_key;
+static pthread_once_t uring_once = PTHREAD_ONCE_INIT;
+static bool uring_key_ok = false;
+
+static void uring_state_free (void *arg)
+{
+    uring_state_t *state = (uring_state_t *)arg;
+    if (state != NULL && !state->failed) {
+        io_uring_queue_exit (&state->ring);
+    }
+    free (state);
+}
+
+static void uring_key_create (void)
+{
+    uring_key_ok = (pthread_key_create (&uring_key, uring_state_free) == 0);
+}
+
+/**
+ * @brief Returns the ring of the calling thread, setting it up if needed.
+ *
+ * @return The ring, or @c NULL if the thread has to fall back to POSIX.
+ */
+static uring_state_t *uring_get_state (void)
+{
+    uring_state_t *state = NULL;
+
+    if (pthread_once (&uring_once, uring_key_create) != 0 || !uring_key_ok) {
+        return NULL;
+    }
+    state = (uring_state_t *)pthread_getspecific (uring_key);
+    if (state == NULL) {
+        state = (uring_state_t *)calloc (1ul, sizeof (*state));
+        if (state == NULL) {
+            return NULL;
+        }
+        state->failed = (io_uring_queue_init (DYAD_IO_URING_QUEUE_DEPTH, &state->ring, 0u) < 0);
+        if (pthread_setspecific (uring_key, state) != 0) {
+            uring_state_free (state);
+            return NULL;
+        }
+    }
+    return state->failed ? NULL : state;
+}
+
+/**
+ * @brief Tears down the ring of @p state after a failed submission, once
+ *        the @p inflight blocks the kernel already took have completed.
+ *
+ * @details
+ * Blocks still queued in the submission ring must never reach the kernel,
+ * since they refer to the caller's buffer. Destroying the ring discards
+ * them, and the thread uses the POSIX engine from then on.
+ */
+static void uring_abort (uring_state_t *state, unsigned inflight)
+{
+    struct io_uring_cqe *cqe = NULL;
+    int ret = 0;
+    while (inflight > 0u) {
+        ret = io_uring_wait_cqe (&state->ring, &cqe);
+        if (ret == -EINTR) {
+            continue;
+        }
+        if (ret < 0) {
+            break;
+        }
+        io_uring_cqe_seen (&state->ring, cqe);
+        inflight--;
+    }
+    io_uring_queue_exit (&state->ring);
+    state->failed = true;
+}
+
+/**
+ * @brief Transfers @p len bytes between @p buf and @p fd at @p offset
+ *        through the ring of @p state.
+ *
+ * @details
+ * Fills the ring with up to @c DYAD_IO_URING_QUEUE_DEPTH blocks, then
+ * submits and reaps in a loop, queueing the next blocks and the remainders
+ * of short transfers as slots free up. On the first error no more blocks
+ * are queued, but the ones in flight are still reaped, since they refer to
+ * the caller's buffer. If the ring itself fails, it is torn down with
+ * @c uring_abort().
+ */
+static ssize_t
+uring_transfer (uring_state_t *state, bool is_write, int fd, char *buf, size_t len, off_t offset)
+{
+    struct io_uring_sqe *sqe = NULL;
+    struct io_uring_cqe *cqe = NULL;
+    uring_slot_t *slot = NULL;
+    size_t next = 0ul;
+    size_t done = 0ul;
+    unsigned inflight = 0u;
+    unsigned i = 0u;
+    int errnum = 0;
+    int ret = 0;
+
+    while (inflight > 0u || (errnum == 0 && done < len)) {
+        for (i = 0u; errnum == 0 && i < DYAD_IO_URING_QUEUE_DEPTH; i++) {
+            slot = &state->slots[i];
+            if (!slot->busy && next < len) {
+                slot->buf = buf + next;
+                slot->len = (len - next) > DYAD_IO_URING_BLOCK_SIZE ? DYAD_IO_URING_BLOCK_SIZE
+                                                                     : (len - next);
+                slot->offset = offset + (off_t)next;
+                slot->busy = true;
+                slot->resubmit = true;
+                next += slot->len;
+            }
+            if (!slot->resubmit) {
+                continue;
+            }
+            sqe = io_uring_get_sqe (&state->ring);
+            if (sqe == NULL) {
+                break;
+            }
+            if (is_write) {
+                io_uring_prep_write (sqe, fd, slot->buf, (unsigned)slot->len, slot->offset);
+            } else {
+                io_uring_prep_read (sqe, fd, slot->buf, (unsigned)slot->len, slot->offset);
+            }
+            io_uring_sqe_set_data (sqe, slot);
+            slot->resubmit = false;
+            inflight++;
+        }
+        ret = io_uring_submit_and_wait (&state->ring, 1u);
+        if (ret < 0 && ret != -EINTR && ret != -EAGAIN && ret != -EBUSY) {
+            errnum = -ret;
+            uring_abort (state, inflight - io_uring_sq_ready (&state->ring));
+            break;
+        }
+        while (io_uring_peek_cqe (&state->ring, &cqe) == 0) {
+            slot = (uring_slot_t *)io_uring_cqe_get_data (cqe);
+            ret = cqe->res;
+            io_uring_cqe_seen (&state->ring, cqe);
+            inflight--;
+            if (ret == -EINTR || ret == -EAGAIN) {
+                slot->resubmit = (errnum == 0);
+            } else if (ret < 0) {
+                errnum = (errnum == 0) ? -ret : errnum;
+            } else if (ret == 0) {
+                errnum = (errnum == 0) ? (is_write ? EIO : ENODATA) : errnum;
+            } else {
+                done += (size_t)ret;
+                slot->buf += ret;
+                slot->len -= (size_t)ret;
+                slot->offset += ret;
+                slot->resubmit = (slot->len > 0ul && errnum == 0);
+            }
+            slot->busy = slot->resubmit;
+        }
+    }
+    for (i = 0u; i < DYAD_IO_URING_QUEUE_DEPTH; i++) {
+        state->slots[i].busy = false;
+        state->slots[i].resubmit = false;
+    }
+    if (errnum != 0) {
+        errno = errnum;
+        return (done < len) ? (ssize_t)done : (ssize_t)len - 1l;
+    }
+    return (ssize_t)done;
+}
+#endif  // DYAD_ENABLE_IO_URING
+
+/**
+ * @brief Dispatches a transfer to @p engine, falling back to POSIX if the
+ *        engine is unavailable to the calling thread.
+ */
+static ssize_t
+io_transfer (dyad_io_engine_t engine, bool is_write, int fd, char *buf, size_t len, off_t offset)
+{
+#ifdef DYAD_ENABLE_IO_URING
+    uring_state_t *state = NULL;
+    if (engine == DYAD_IO_ENGINE_IO_URING && len > 0ul && (state = uring_get_state ()) != NULL) {
+        return uring_transfer (state, is_write, fd, buf, len, offset);
+    }
+#else
+    (void)engine;
+#endif
+    return posix_transfer (is_write, fd, buf, len, offset);
+}
+
+ssize_t dyad_io_read (dyad_io_engine_t engine, int fd, void *buf, size_t len, off_t offset)
+{
+    return io_transfer (engine, false, fd, (char *)buf, len, offset);
+}
+
+ssize_t dyad_io_write (dyad_io_engine_t engine,
+                       int fd,
+                       const void *buf,
+                       size_t len,
+                       off_t offset)
+{
+    return io_transfer (engine, true, fd, (char *)buf, len, offset);
+}
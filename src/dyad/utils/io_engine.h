@@ -0,0 +1,127 @@
+/**
+ * @file io_engine.h
+ * @brief Positioned whole-buffer file reads and writes, issued either with
+ *        plain POSIX calls or through io_uring.
+ *
+ * @details
+ * The POSIX engine transfers a buffer with a loop of @c pread() or
+ * @c pwrite() calls of at most @c DYAD_POSIX_TRANSFER_GRANULARITY bytes.
+ *
+ * The io_uring engine splits the buffer into blocks of
+ * @c DYAD_IO_URING_BLOCK_SIZE bytes and keeps up to
+ * @c DYAD_IO_URING_QUEUE_DEPTH of them in flight, so that a single thread
+ * keeps the device queue busy with a handful of system calls. Each thread
+ * gets its own ring the first time it uses the engine, which is torn down
+ * when the thread exits. A thread whose ring cannot be set up, e.g.,
+ * because the kernel or a seccomp filter does not allow io_uring, falls
+ * back to the POSIX engine.
+ *
+ * io_uring is only available if DYAD was built with
+ * @c DYAD_ENABLE_IO_URING.
+ */
+
+#ifndef DYAD_UTILS_IO_ENGINE_H
+#define DYAD_UTILS_IO_ENGINE_H
+
+#if defined(DYAD_HAS_CONFIG)
+#include <dyad/dyad_config.hpp>
+#else
+#error "no config"
+#endif
+
+#ifdef __cplusplus
+#include <cstddef>
+
+extern "C" {
+#else
+#include <stdbool.h>
+#include <stddef.h>
+#endif
+#include <sys/types.h>
+
+/**
+ * @brief Engines that can be selected for file I/O.
+ */
+enum dyad_io_engine {
+    DYAD_IO_ENGINE_POSIX = 0,     ///< Blocking pread()/pwrite()
+    DYAD_IO_ENGINE_IO_URING = 1,  ///< Batched submissions through io_uring
+};
+typedef enum dyad_io_engine dyad_io_engine_t;
+
+/**
+ * @brief Size of the blocks the io_uring engine splits a transfer into.
+ */
+#define DYAD_IO_URING_BLOCK_SIZE (1024ul * 1024ul)
+
+/**
+ * @brief Maximum number of blocks the io_uring engine keeps in flight per
+ *        thread.
+ */
+#define DYAD_IO_URING_QUEUE_DEPTH 32u
+
+/**
+ * @brief Looks up an engine by the name used in @c DYAD_IO_ENGINE.
+ *
+ * @param[in] name  @c "posix" or @c "io_uring", case-insensitive.
+ *
+ * @return The engine, or -1 if @p name is @c NULL or unknown.
+ */
+int dyad_io_engine_from_name (const char *name);
+
+/**
+ * @brief Returns the name of @p engine, as accepted by
+ *        @c dyad_io_engine_from_name().
+ */
+const char *dyad_io_engine_name (dyad_io_engine_t engine);
+
+/**
+ * @brief Tells whether DYAD was built with support for @p engine.
+ *        @c DYAD_IO_ENGINE_POSIX is always available.
+ */
+bool dyad_io_engine_is_available (dyad_io_engine_t engine);
+
+/**
+ * @brief Reads exactly @p len bytes at @p offset of @p fd into @p buf.
+ *
+ * @details
+ * Retries short and interrupted reads. Thread-safe, and does not log, so
+ * that it can be called from worker threads.
+ *
+ * @param[in]  engine  Engine to read with.
+ * @param[in]  fd      File descriptor opened for reading.
+ * @param[out] buf     Destination buffer of at least @p len bytes.
+ * @param[in]  len     Number of bytes to read.
+ * @param[in]  offset  File offset of the first byte to read.
+ *
+ * @return @p len on success. A smaller value indicates an error, with
+ *         @c errno set, or an unexpected end of file, with @c errno set to
+ *         @c ENODATA.
+ */
+ssize_t dyad_io_read (dyad_io_engine_t engine, int fd, void *buf, size_t len, off_t offset);
+
+/**
+ * @brief Writes exactly @p len bytes of @p buf to @p fd at @p offset.
+ *
+ * @details
+ * Retries short and interrupted writes. Thread-safe, and does not log.
+ *
+ * @param[in] engine  Engine to write with.
+ * @param[in] fd      File descriptor opened for writing.
+ * @param[in] buf     Data to write.
+ * @param[in] len     Number of bytes of @p buf to write.
+ * @param[in] offset  File offset at which to write @p buf.
+ *
+ * @return @p len on success. A smaller value indicates an error, with
+ *         @c errno set.
+ */
+ssize_t dyad_io_write (dyad_io_engine_t engine,
+                       int fd,
+                       const void *buf,
+                       size_t len,
+                       off_t offset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // DYAD_UTILS_IO_ENGINE_H
@@ -0,0 +1,240 @@
+#if defined(DYAD_HAS_CONFIG)
+#include <dyad/dyad_config.hpp>
+#else
+#error "no config"
+#endif
+
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <new>
+#include <string>
+#include <unordered_map>
+
+#include "mdata_cache.h"
+
+using clock_type = std::chrono::steady_clock;
+
+/**
+ * @brief Cached outcome of the KVS lookup of one file.
+ */
+struct mdata_entry {
+    std::string upath;              ///< Path relative to the consumer-managed directory.
+    dyad_mdata_record_t record;     ///< Published record, if @c found.
+    bool found;                     ///< Whether the file was published, or is a cached miss.
+    clock_type::time_point expiry;  ///< When the entry stops being valid.
+    bool expires;                   ///< Whether @c expiry applies.
+};
+
+/**
+ * @brief Entries in order of use, most recently used first.
+ */
+using lru_type = std::list<mdata_entry>;
+
+/**
+ * @brief Index from path to the entry's position in the LRU list.
+ */
+using index_type = std::unordered_map<std::string, lru_type::iterator>;
+
+struct dyad_mdata_cache {
+    std::mutex lock;                 ///< Protects every other member.
+    lru_type lru;                    ///< Entries, most recently used first.
+    index_type index;                ///< Lookup table for @c lru.
+    size_t capacity;                 ///< Maximum number of entries.
+    clock_type::duration ttl;        ///< Lifetime of a record, or 0 for no expiration.
+    clock_type::duration neg_ttl;    ///< Lifetime of a miss, or 0 not to cache misses.
+    dyad_mdata_cache_stats_t stats;  ///< Counters.
+};
+
+// Cache shared by the users of the process on the same KVS namespace,
+// created by the first of them and destroyed with the last
+static std::mutex shared_lock;
+static dyad_mdata_cache_t *shared_cache = nullptr;
+static std::string shared_name;
+static unsigned shared_refs = 0u;
+
+static inline clock_type::duration to_duration (double seconds)
+{
+    return std::chrono::duration_cast<clock_type::duration> (
+        std::chrono::duration<double> (seconds));
+}
+
+/**
+ * @brief Inserts or replaces the entry of @p upath, which is a cached miss
+ *        if @p record is @c NULL, evicting the least recently used entries
+ *        beyond the capacity.
+ */
+static dyad_rc_t cache_insert (dyad_mdata_cache_t *cache,
+                               const char *upath,
+                               const dyad_mdata_record_t *record,
+                               clock_type::duration ttl)
+{
+    try {
+        std::lock_guard<std::mutex> guard (cache->lock);
+        auto it = cache->index.find (upath);
+        if (it != cache->index.end ()) {
+            cache->lru.erase (it->second);
+            cache->index.erase (it);
+        }
+        while (!cache->lru.empty () && cache->lru.size () >= cache->capacity) {
+            cache->index.erase (cache->lru.back ().upath);
+            cache->lru.pop_back ();
+            cache->stats.evictions++;
+        }
+        cache->lru.push_front (mdata_entry ());
+        mdata_entry &entry = cache->lru.front ();
+        entry.found = (record != nullptr);
+        if (entry.found) {
+            entry.record = *record;
+        }
+        entry.expires = (ttl.count () > 0);
+        entry.expiry = clock_type::now () + ttl;
+        try {
+            entry.upath = upath;
+            cache->index.emplace (entry.upath, cache->lru.begin ());
+        } catch (...) {
+            cache->lru.pop_front ();
+            throw;
+        }
+    } catch (...) {
+        return DYAD_RC_SYSFAIL;
+    }
+    return DYAD_RC_OK;
+}
+
+dyad_rc_t dyad_mdata_cache_create (size_t capacity,
+                                   double ttl,
+                                   double negative_ttl,
+                                   dyad_mdata_cache_t **cache)
+{
+    if (cache == nullptr || capacity == 0ul || ttl < 0.0 || negative_ttl < 0.0) {
+        return DYAD_RC_BADBUF;
+    }
+    *cache = new (std::nothrow) dyad_mdata_cache_t ();
+    if (*cache == nullptr) {
+        return DYAD_RC_SYSFAIL;
+    }
+    (*cache)->capacity = capacity;
+    (*cache)->ttl = to_duration (ttl);
+    (*cache)->neg_ttl = to_duration (negative_ttl);
+    return DYAD_RC_OK;
+}
+
+void dyad_mdata_cache_destroy (dyad_mdata_cache_t *cache)
+{
+    delete cache;
+}
+
+dyad_rc_t dyad_mdata_cache_get (dyad_mdata_cache_t *cache,
+                                const char *upath,
+                                bool *found,
+                                dyad_mdata_record_t *record)
+{
+    dyad_rc_t rc = DYAD_RC_NOTFOUND;
+    try {
+        std::lock_guard<std::mutex> guard (cache->lock);
+        auto it = cache->index.find (upath);
+        if (it == cache->index.end ()) {
+            cache->stats.misses++;
+        } else if (it->second->expires && clock_type::now () >= it->second->expiry) {
+            cache->lru.erase (it->second);
+            cache->index.erase (it);
+            cache->stats.misses++;
+        } else {
+            cache->lru.splice (cache->lru.begin (), cache->lru, it->second);
+            *found = it->second->found;
+            if (it->second->found) {
+                *record = it->second->record;
+                cache->stats.hits++;
+            } else {
+                cache->stats.negative_hits++;
+            }
+            rc = DYAD_RC_OK;
+        }
+    } catch (...) {
+        rc = DYAD_RC_SYSFAIL;
+    }
+    return rc;
+}
+
+dyad_rc_t dyad_mdata_cache_put (dyad_mdata_cache_t *cache,
+                                const char *upath,
+                                const dyad_mdata_record_t *record)
+{
+    return cache_insert (cache, upath, record, cache->ttl);
+}
+
+dyad_rc_t dyad_mdata_cache_put_negative (dyad_mdata_cache_t *cache, const char *upath)
+{
+    if (cache->neg_ttl.count () <= 0) {
+        return DYAD_RC_OK;
+    }
+    return cache_insert (cache, upath, nullptr, cache->neg_ttl);
+}
+
+void dyad_mdata_cache_invalidate (dyad_mdata_cache_t *cache, const char *upath)
+{
+    try {
+        std::lock_guard<std::mutex> guard (cache->lock);
+        auto it = cache->index.find (upath);
+        if (it != cache->index.end ()) {
+            cache->lru.erase (it->second);
+            cache->index.erase (it);
+        }
+    } catch (...) {
+    }
+}
+
+void dyad_mdata_cache_stats (dyad_mdata_cache_t *cache, dyad_mdata_cache_stats_t *stats)
+{
+    std::lock_guard<std::mutex> guard (cache->lock);
+    *stats = cache->stats;
+    stats->entries = cache->index.size ();
+}
+
+dyad_rc_t dyad_mdata_cache_acquire (const char *name,
+                                    size_t capacity,
+                                    double ttl,
+                                    double negative_ttl,
+                                    dyad_mdata_cache_t **cache)
+{
+    dyad_rc_t rc = DYAD_RC_OK;
+    std::lock_guard<std::mutex> guard (shared_lock);
+
+    if (shared_cache != nullptr && shared_name == name) {
+        shared_refs++;
+        *cache = shared_cache;
+        return DYAD_RC_OK;
+    }
+    rc = dyad_mdata_cache_create (capacity, ttl, negative_ttl, cache);
+    if (DYAD_IS_ERROR (rc) || shared_cache != nullptr) {
+        return rc;
+    }
+    try {
+        shared_name = name;
+    } catch (...) {
+        // Still usable, just not shared
+        return DYAD_RC_OK;
+    }
+    shared_cache = *cache;
+    shared_refs = 1u;
+    return DYAD_RC_OK;
+}
+
+void dyad_mdata_cache_release (dyad_mdata_cache_t *cache)
+{
+    if (cache == nullptr) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> guard (shared_lock);
+        if (cache == shared_cache) {
+            if (--shared_refs > 0u) {
+                return;
+            }
+            shared_cache = nullptr;
+            shared_name.clear ();
+        }
+    }
+    dyad_mdata_cache_destroy (cache);
+}
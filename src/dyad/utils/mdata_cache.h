@@ -0,0 +1,180 @@
+/**
+ * @file mdata_cache.h
+ * @brief Bounded cache of the file records looked up in the Flux KVS by the
+ *        DYAD client.
+ *
+ * @details
+ * Consumers look up the broker rank owning a file before every fetch, so
+ * re-opening a file, e.g., once per epoch of a training run, costs a KVS
+ * round trip each time. This cache remembers the record, i.e., the owner
+ * rank and what else the producer published, of each path relative to the
+ * consumer-managed directory for a limited time, so that such lookups are
+ * answered without contacting the broker.
+ *
+ * Optionally, lookups that found nothing can be cached as well, for a
+ * separate and usually much shorter time, so that a consumer polling for
+ * a file that is not published yet does not flood the KVS.
+ *
+ * Entries expire after their time to live, and the least recently used
+ * entries are evicted once the capacity is reached. Since the cache does
+ * not watch the KVS, a producer republishing a file from another broker is
+ * only noticed once the entry expires or is dropped with
+ * @c dyad_mdata_cache_invalidate(), which the client does whenever a fetch
+ * from the cached owner fails.
+ *
+ * All functions are thread-safe and do not log.
+ */
+
+#ifndef DYAD_UTILS_MDATA_CACHE_H
+#define DYAD_UTILS_MDATA_CACHE_H
+
+#if defined(DYAD_HAS_CONFIG)
+#include <dyad/dyad_config.hpp>
+#else
+#error "no config"
+#endif
+
+#include <dyad/common/dyad_rc.h>
+#include <dyad/utils/mdata_record.h>
+
+#ifdef __cplusplus
+#include <cstddef>
+#include <cstdint>
+
+extern "C" {
+#else
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#endif
+
+/**
+ * @brief Opaque record cache handle.
+ */
+typedef struct dyad_mdata_cache dyad_mdata_cache_t;
+
+/**
+ * @brief Snapshot of the cache counters.
+ */
+typedef struct dyad_mdata_cache_stats {
+    uint64_t hits;           ///< Lookups answered with a record.
+    uint64_t negative_hits;  ///< Lookups answered with a cached miss.
+    uint64_t misses;         ///< Lookups of absent or expired entries.
+    uint64_t evictions;      ///< Entries dropped to stay within the capacity.
+    size_t entries;          ///< Number of entries currently cached.
+} dyad_mdata_cache_stats_t;
+
+/**
+ * @brief Creates an empty cache.
+ *
+ * @param[in]  capacity      Maximum number of entries. Must be greater
+ *                           than 0.
+ * @param[in]  ttl           Seconds a record stays valid, or 0 for no
+ *                           expiration.
+ * @param[in]  negative_ttl  Seconds a miss stays valid, or 0 not to cache
+ *                           misses.
+ * @param[out] cache         Set to the newly created cache on success.
+ *
+ * @return @c dyad_rc_t return code:
+ * @retval DYAD_RC_OK       The cache was created.
+ * @retval DYAD_RC_BADBUF   @p cache is @c NULL, @p capacity is 0 or a time
+ *                          to live is negative.
+ * @retval DYAD_RC_SYSFAIL  Allocation failed.
+ */
+dyad_rc_t dyad_mdata_cache_create (size_t capacity,
+                                   double ttl,
+                                   double negative_ttl,
+                                   dyad_mdata_cache_t **cache);
+
+/**
+ * @brief Releases the cache and every entry in it. Safe to call with
+ *        @c NULL.
+ */
+void dyad_mdata_cache_destroy (dyad_mdata_cache_t *cache);
+
+/**
+ * @brief Looks up the record of a file.
+ *
+ * @details
+ * On a hit, the entry becomes the most recently used one. Expired entries
+ * are dropped and count as misses.
+ *
+ * @param[in]  cache       Cache to search.
+ * @param[in]  upath       Path of the file relative to the consumer-managed
+ *                         directory.
+ * @param[out] found       Set on a hit to whether the file was found, i.e.,
+ *                         whether @p record is set, or is a cached miss.
+ * @param[out] record      Set to the record of the file on a hit with
+ *                         @p found set.
+ *
+ * @return @c dyad_rc_t return code:
+ * @retval DYAD_RC_OK        The lookup was answered from the cache.
+ * @retval DYAD_RC_NOTFOUND  The file is not cached or its entry expired.
+ * @retval DYAD_RC_SYSFAIL   An internal allocation failed.
+ */
+dyad_rc_t dyad_mdata_cache_get (dyad_mdata_cache_t *cache,
+                                const char *upath,
+                                bool *found,
+                                dyad_mdata_record_t *record);
+
+/**
+ * @brief Records the record of a file, replacing any existing entry.
+ *
+ * @return @c DYAD_RC_OK, or @c DYAD_RC_SYSFAIL if allocation failed, in
+ *         which case the cache is unchanged.
+ */
+dyad_rc_t dyad_mdata_cache_put (dyad_mdata_cache_t *cache,
+                                const char *upath,
+                                const dyad_mdata_record_t *record);
+
+/**
+ * @brief Records that a file has not been published yet, replacing any
+ *        existing entry. Does nothing if misses are not cached.
+ *
+ * @return @c DYAD_RC_OK, or @c DYAD_RC_SYSFAIL if allocation failed, in
+ *         which case the cache is unchanged.
+ */
+dyad_rc_t dyad_mdata_cache_put_negative (dyad_mdata_cache_t *cache, const char *upath);
+
+/**
+ * @brief Drops the entry of a file, if any.
+ */
+void dyad_mdata_cache_invalidate (dyad_mdata_cache_t *cache, const char *upath);
+
+/**
+ * @brief Copies the current counters of the cache into @p stats.
+ */
+void dyad_mdata_cache_stats (dyad_mdata_cache_t *cache, dyad_mdata_cache_stats_t *stats);
+
+/**
+ * @brief Returns the cache of the process for the KVS namespace @p name,
+ *        creating it if this is the first user.
+ *
+ * @details
+ * Threads of a process usually consume the same files, e.g., the ranks of
+ * a data loader, so their contexts share a single cache rather than each
+ * looking the files up in the KVS again. The shared cache is sized by its
+ * first user. A user on another namespace, whose files may have other
+ * owners under the same paths, gets a cache of its own.
+ *
+ * Every cache acquired is released with @c dyad_mdata_cache_release().
+ *
+ * @return As @c dyad_mdata_cache_create().
+ */
+dyad_rc_t dyad_mdata_cache_acquire (const char *name,
+                                    size_t capacity,
+                                    double ttl,
+                                    double negative_ttl,
+                                    dyad_mdata_cache_t **cache);
+
+/**
+ * @brief Drops a reference taken by @c dyad_mdata_cache_acquire(). The
+ *        cache is destroyed with its last user. Safe to call with @c NULL.
+ */
+void dyad_mdata_cache_release (dyad_mdata_cache_t *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // DYAD_UTILS_MDATA_CACHE_H
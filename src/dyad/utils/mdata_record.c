@@ -0,0 +1,139 @@
+#if defined(DYAD_HAS_CONFIG)
+#include <dyad/dyad_config.hpp>
+#else
+#error "no config"
+#endif
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "mdata_record.h"
+#include "murmur3.h"
+
+static inline void put_u32 (unsigned char *p, uint32_t v)
+{
+    unsigned i = 0u;
+    for (i = 0u; i < 4u; i++) {
+        p[i] = (unsigned char)(v >> (8u * i));
+    }
+}
+
+static inline void put_u64 (unsigned char *p, uint64_t v)
+{
+    unsigned i = 0u;
+    for (i = 0u; i < 8u; i++) {
+        p[i] = (unsigned char)(v >> (8u * i));
+    }
+}
+
+static inline uint32_t get_u32 (const unsigned char *p)
+{
+    uint32_t v = 0u;
+    unsigned i = 0u;
+    for (i = 0u; i < 4u; i++) {
+        v |= (uint32_t)p[i] << (8u * i);
+    }
+    return v;
+}
+
+static inline uint64_t get_u64 (const unsigned char *p)
+{
+    uint64_t v = 0ull;
+    unsigned i = 0u;
+    for (i = 0u; i < 8u; i++) {
+        v |= (uint64_t)p[i] << (8u * i);
+    }
+    return v;
+}
+
+void dyad_mdata_record_encode (const dyad_mdata_record_t *record, void *buf)
+{
+    unsigned char *p = (unsigned char *)buf;
+
+    memset (p, 0, DYAD_MDATA_RECORD_SIZE);
+    memcpy (p, DYAD_MDATA_RECORD_MAGIC, 4ul);
+    put_u32 (p + 4, record->owner_rank);
+    put_u32 (p + 8, record->flags);
+    put_u64 (p + 16, record->file_size);
+    put_u64 (p + 24, (uint64_t)record->mtime_ns);
+    put_u64 (p + 32, record->checksum);
+    put_u64 (p + 40, record->block_size);
+}
+
+dyad_rc_t dyad_mdata_record_decode (const void *buf, size_t len, dyad_mdata_record_t *record)
+{
+    const unsigned char *p = (const unsigned char *)buf;
+    char legacy[16] = {'\0'};
+    char *end = NULL;
+    unsigned long rank = 0ul;
+
+    memset (record, 0, sizeof (*record));
+    if (buf == NULL) {
+        return DYAD_RC_BADMETADATA;
+    }
+    if (len >= DYAD_MDATA_RECORD_SIZE && memcmp (p, DYAD_MDATA_RECORD_MAGIC, 4ul) == 0) {
+        record->owner_rank = get_u32 (p + 4);
+        record->flags = get_u32 (p + 8);
+        record->file_size = get_u64 (p + 16);
+        record->mtime_ns = (int64_t)get_u64 (p + 24);
+        record->checksum = get_u64 (p + 32);
+        record->block_size = get_u64 (p + 40);
+        return DYAD_RC_OK;
+    }
+    // Older producers store the rank as a JSON integer
+    if (len == 0ul || len >= sizeof (legacy)) {
+        return DYAD_RC_BADMETADATA;
+    }
+    memcpy (legacy, p, len);
+    errno = 0;
+    rank = strtoul (legacy, &end, 10);
+    if (errno != 0 || end == legacy || *end != '\0' || rank > UINT32_MAX) {
+        return DYAD_RC_BADMETADATA;
+    }
+    record->owner_rank = (uint32_t)rank;
+    return DYAD_RC_OK;
+}
+
+int dyad_mdata_checksum (int fd, uint64_t file_size, uint64_t block_size, uint64_t *checksum)
+{
+    char *block = NULL;
+    uint64_t offset = 0ull;
+    uint64_t hash[2] = {0ull, 0ull};
+    uint64_t h = 0ull;
+    size_t len = 0ul;
+    size_t done = 0ul;
+    ssize_t n = 0l;
+
+    if (block_size == 0ull || block_size > (uint64_t)INT32_MAX) {
+        errno = EINVAL;
+        return -1;
+    }
+    block = (char *)malloc ((size_t)block_size);
+    if (block == NULL) {
+        return -1;
+    }
+    for (offset = 0ull; offset < file_size; offset += len) {
+        len = (size_t)((file_size - offset < block_size) ? file_size - offset : block_size);
+        for (done = 0ul; done < len; done += (size_t)n) {
+            n = pread (fd, block + done, len - done, (off_t)(offset + done));
+            if (n < 0l && errno == EINTR) {
+                n = 0l;
+                continue;
+            }
+            if (n <= 0l) {
+                if (n == 0l) {
+                    errno = EIO;
+                }
+                free (block);
+                return -1;
+            }
+        }
+        MurmurHash3_x64_128 (block, (int)len, (uint32_t)(h ^ (h >> 32)), hash);
+        h = hash[0] ^ hash[1];
+    }
+    free (block);
+    *checksum = h;
+    return 0;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file mdata_record.h
+ * @brief Binary encoding of the per-file record published in the Flux KVS.
+ *
+ * @details
+ * Producers used to publish their broker rank alone, as a JSON integer.
+ * The record now also carries what consumers need to plan a transfer
+ * before any data arrives: the size of the file, its modification time at
+ * publication, and optionally a checksum of its contents along with the
+ * block size it was computed over, which tells a stale local copy from a
+ * current one.
+ *
+ * The record is encoded as @c DYAD_MDATA_RECORD_SIZE bytes in little-endian
+ * order, starting with @c DYAD_MDATA_RECORD_MAGIC:
+ *
+ * | Offset | Size | Field        |
+ * |-------:|-----:|--------------|
+ * |      0 |    4 | magic        |
+ * |      4 |    4 | owner_rank   |
+ * |      8 |    4 | flags        |
+ * |     12 |    4 | reserved (0) |
+ * |     16 |    8 | file_size    |
+ * |     24 |    8 | mtime_ns     |
+ * |     32 |    8 | checksum     |
+ * |     40 |    8 | block_size   |
+ *
+ * Values not starting with the magic are decoded as the JSON integer of
+ * older producers.
+ */
+
+#ifndef DYAD_UTILS_MDATA_RECORD_H
+#define DYAD_UTILS_MDATA_RECORD_H
+
+#if defined(DYAD_HAS_CONFIG)
+#include <dyad/dyad_config.hpp>
+#else
+#error "no config"
+#endif
+
+#include <dyad/common/dyad_rc.h>
+
+#ifdef __cplusplus
+#include <cstddef>
+#include <cstdint>
+
+extern "C" {
+#else
+#include <stddef.h>
+#include <stdint.h>
+#endif
+
+/**
+ * @brief First bytes of an encoded record, "DYM" followed by the format
+ *        version.
+ */
+#define DYAD_MDATA_RECORD_MAGIC "DYM\001"
+
+/**
+ * @brief Size in bytes of an encoded record.
+ */
+#define DYAD_MDATA_RECORD_SIZE 48ul
+
+/**
+ * @brief Set in @c flags if @c file_size and @c mtime_ns are known.
+ */
+#define DYAD_MDATA_HAS_SIZE 0x1u
+
+/**
+ * @brief Set in @c flags if @c checksum and @c block_size are known.
+ */
+#define DYAD_MDATA_HAS_CHECKSUM 0x2u
+
+/**
+ * @brief Set in @c flags by consumers, and never published, if the record
+ *        was just read from the KVS rather than from a cache or an event.
+ */
+#define DYAD_MDATA_FROM_KVS 0x80000000u
+
+/**
+ * @brief Block size over which checksums are computed.
+ */
+#define DYAD_MDATA_CHECKSUM_BLOCK (1024ul * 1024ul)
+
+/**
+ * @brief Decoded KVS record of a file.
+ */
+typedef struct dyad_mdata_record {
+    uint32_t owner_rank;  ///< Broker rank of the producer.
+    uint32_t flags;       ///< @c DYAD_MDATA_HAS_* bits of the fields below that are set.
+    uint64_t file_size;   ///< Size of the file in bytes.
+    int64_t mtime_ns;     ///< Modification time at publication, in ns since the epoch.
+    uint64_t checksum;    ///< Checksum of the contents, see @c dyad_mdata_checksum().
+    uint64_t block_size;  ///< Block size the checksum was computed over.
+} dyad_mdata_record_t;
+
+/**
+ * @brief Encodes @p record into the @c DYAD_MDATA_RECORD_SIZE bytes of
+ *        @p buf.
+ */
+void dyad_mdata_record_encode (const dyad_mdata_record_t *record, void *buf);
+
+/**
+ * @brief Decodes a value read from the KVS, either an encoded record or
+ *        the JSON integer of an older producer.
+ *
+ * @param[in]  buf     Value of the KVS key.
+ * @param[in]  len     Length of @p buf in bytes.
+ * @param[out] record  Set to the decoded record. Only @c owner_rank is set
+ *                     for the value of an older producer.
+ *
+ * @return @c DYAD_RC_OK, or @c DYAD_RC_BADMETADATA if @p buf is neither.
+ */
+dyad_rc_t dyad_mdata_record_decode (const void *buf, size_t len, dyad_mdata_record_t *record);
+
+/**
+ * @brief Computes the checksum of the first @p file_size bytes of @p fd.
+ *
+ * @details
+ * The file is read in blocks of @p block_size bytes, and each block is
+ * hashed with MurmurHash3 seeded with the hash of the previous one, so the
+ * checksum does not require the whole file in memory.
+ *
+ * @return 0, or -1 with @c errno set if a read failed or the file is
+ *         shorter than @p file_size.
+ */
+int dyad_mdata_checksum (int fd, uint64_t file_size, uint64_t block_size, uint64_t *checksum);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // DYAD_UTILS_MDATA_RECORD_H
@@ -0,0 +1,199 @@
+#if defined(DYAD_HAS_CONFIG)
+#include <dyad/dyad_config.hpp>
+#else
+#error "no config"
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "stats.h"
+
+static const char *const phase_names[DYAD_STATS_NUM_PHASES] = {"kvs_lookup",
+                                                               "rpc_setup",
+                                                               "dtl_recv",
+                                                               "cons_store",
+                                                               "lock_wait",
+                                                               "mod_queue",
+                                                               "mod_read",
+                                                               "mod_send"};
+
+static dyad_stats_t stats_table;
+static bool stats_enabled = true;
+
+/**
+ * @brief Maps a latency to its bucket, i.e., the position of its highest
+ *        set bit.
+ */
+static inline unsigned stats_bucket (uint64_t ns)
+{
+    unsigned bucket = (ns == 0ull) ? 0u : (unsigned)(63 - __builtin_clzll (ns));
+    return (bucket < DYAD_STATS_NUM_BUCKETS) ? bucket : DYAD_STATS_NUM_BUCKETS - 1u;
+}
+
+void dyad_stats_enable (bool enable)
+{
+    __atomic_store_n (&stats_enabled, enable, __ATOMIC_RELAXED);
+}
+
+uint64_t dyad_stats_now (void)
+{
+    struct timespec ts;
+    if (!__atomic_load_n (&stats_enabled, __ATOMIC_RELAXED)
+        || clock_gettime (CLOCK_MONOTONIC, &ts) != 0) {
+        return 0ull;
+    }
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void dyad_stats_record (dyad_stats_phase_t phase, uint64_t start)
+{
+    dyad_stats_hist_t *hist = NULL;
+    uint64_t now = 0ull;
+    uint64_t ns = 0ull;
+    uint64_t max = 0ull;
+
+    if (start == 0ull || (unsigned)phase >= DYAD_STATS_NUM_PHASES) {
+        return;
+    }
+    now = dyad_stats_now ();
+    ns = (now > start) ? now - start : 0ull;
+    hist = &stats_table.phases[phase];
+    __atomic_fetch_add (&hist->count, 1ull, __ATOMIC_RELAXED);
+    __atomic_fetch_add (&hist->total_ns, ns, __ATOMIC_RELAXED);
+    __atomic_fetch_add (&hist->buckets[stats_bucket (ns)], 1ull, __ATOMIC_RELAXED);
+    max = __atomic_load_n (&hist->max_ns, __ATOMIC_RELAXED);
+    while (ns > max
+           && !__atomic_compare_exchange_n (&hist->max_ns,
+                                            &max,
+                                            ns,
+                                            true,
+                                            __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED)) {
+    }
+}
+
+void dyad_stats_snapshot (dyad_stats_t *stats)
+{
+    const uint64_t *src = (const uint64_t *)&stats_table;
+    uint64_t *dst = (uint64_t *)stats;
+    size_t i = 0ul;
+    for (i = 0ul; i < sizeof (stats_table) / sizeof (uint64_t); i++) {
+        dst[i] = __atomic_load_n (&src[i], __ATOMIC_RELAXED);
+    }
+}
+
+void dyad_stats_reset (void)
+{
+    uint64_t *dst = (uint64_t *)&stats_table;
+    size_t i = 0ul;
+    for (i = 0ul; i < sizeof (stats_table) / sizeof (uint64_t); i++) {
+        __atomic_store_n (&dst[i], 0ull, __ATOMIC_RELAXED);
+    }
+}
+
+const char *dyad_stats_phase_name (dyad_stats_phase_t phase)
+{
+    if ((unsigned)phase >= DYAD_STATS_NUM_PHASES) {
+        return "unknown";
+    }
+    return phase_names[phase];
+}
+
+int dyad_stats_phase_from_name (const char *name)
+{
+    int i = 0;
+    if (name == NULL) {
+        return -1;
+    }
+    for (i = 0; i < DYAD_STATS_NUM_PHASES; i++) {
+        if (strcmp (name, phase_names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+uint64_t dyad_stats_quantile (const dyad_stats_hist_t *hist, double q)
+{
+    uint64_t rank = 0ull;
+    uint64_t seen = 0ull;
+    unsigned i = 0u;
+
+    if (hist->count == 0ull) {
+        return 0ull;
+    }
+    rank = (uint64_t)(q * (double)hist->count);
+    rank = (rank < 1ull) ? 1ull : ((rank > hist->count) ? hist->count : rank);
+    for (i = 0u; i < DYAD_STATS_NUM_BUCKETS - 1u; i++) {
+        seen += hist->buckets[i];
+        if (seen >= rank) {
+            break;
+        }
+    }
+    if (i == DYAD_STATS_NUM_BUCKETS - 1u) {
+        return hist->max_ns;
+    }
+    return ((2ull << i) < hist->max_ns) ? (2ull << i) : hist->max_ns;
+}
+
+int dyad_stats_dump (const dyad_stats_t *stats, const char *label, const char *path)
+{
+    char buf[4096];
+    size_t len = 0ul;
+    int n = 0;
+    int fd = -1;
+    int errnum = 0;
+    unsigned i = 0u;
+    const dyad_stats_hist_t *hist = NULL;
+
+    n = snprintf (buf,
+                  sizeof (buf),
+                  "DYAD stats: %s\n%-10s %12s %12s %12s %12s %12s\n",
+                  label,
+                  "phase",
+                  "count",
+                  "mean_us",
+                  "p50_us",
+                  "p99_us",
+                  "max_us");
+    len = (n > 0) ? (size_t)n : 0ul;
+    for (i = 0u; i < DYAD_STATS_NUM_PHASES && len < sizeof (buf); i++) {
+        hist = &stats->phases[i];
+        if (hist->count == 0ull) {
+            continue;
+        }
+        n = snprintf (buf + len,
+                      sizeof (buf) - len,
+                      "%-10s %12" PRIu64 " %12.1f %12.1f %12.1f %12.1f\n",
+                      phase_names[i],
+                      hist->count,
+                      (double)hist->total_ns / (double)hist->count / 1000.0,
+                      (double)dyad_stats_quantile (hist, 0.5) / 1000.0,
+                      (double)dyad_stats_quantile (hist, 0.99) / 1000.0,
+                      (double)hist->max_ns / 1000.0);
+        len += (n > 0) ? (size_t)n : 0ul;
+    }
+    len = (len < sizeof (buf)) ? len : sizeof (buf) - 1ul;
+    if (strcmp (path, "-") == 0) {
+        return (write (STDERR_FILENO, buf, len) == (ssize_t)len) ? 0 : -1;
+    }
+    fd = open (path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+    if (write (fd, buf, len) != (ssize_t)len) {
+        errnum = (errno != 0) ? errno : EIO;
+    }
+    close (fd);
+    if (errnum != 0) {
+        errno = errnum;
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file stats.h
+ * @brief Recording of the latency histograms of @c dyad_stats.h.
+ *
+ * @details
+ * The histograms are global to the process and updated with relaxed
+ * atomic operations, so phases can be recorded from any thread without a
+ * lock. A phase is timed as follows:
+ * @code
+ *   uint64_t t0 = dyad_stats_now ();
+ *   ...
+ *   dyad_stats_record (DYAD_STATS_DTL_RECV, t0);
+ * @endcode
+ * While recording is disabled, @c dyad_stats_now() returns 0 and
+ * @c dyad_stats_record() ignores samples started at 0.
+ */
+
+#ifndef DYAD_UTILS_STATS_H
+#define DYAD_UTILS_STATS_H
+
+#if defined(DYAD_HAS_CONFIG)
+#include <dyad/dyad_config.hpp>
+#else
+#error "no config"
+#endif
+
+#include <dyad/common/dyad_stats.h>
+
+#ifdef __cplusplus
+#include <cstddef>
+#include <cstdint>
+
+extern "C" {
+#else
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#endif
+
+/**
+ * @brief Turns recording on or off. On by default.
+ */
+void dyad_stats_enable (bool enable);
+
+/**
+ * @brief Returns the start time of a phase, or 0 if recording is disabled.
+ */
+uint64_t dyad_stats_now (void);
+
+/**
+ * @brief Adds the time elapsed since @p start to the histogram of @p phase.
+ *        Does nothing if @p start is 0.
+ */
+void dyad_stats_record (dyad_stats_phase_t phase, uint64_t start);
+
+/**
+ * @brief Copies the current histograms into @p stats.
+ *
+ * @details
+ * Each counter is read atomically, but the snapshot as a whole is not:
+ * samples recorded concurrently may be partially included.
+ */
+void dyad_stats_snapshot (dyad_stats_t *stats);
+
+/**
+ * @brief Clears every histogram.
+ */
+void dyad_stats_reset (void);
+
+/**
+ * @brief Returns the name of @p phase, e.g., @c "kvs_lookup", as used in
+ *        dumps and in the @c dyad.stats RPC.
+ */
+const char *dyad_stats_phase_name (dyad_stats_phase_t phase);
+
+/**
+ * @brief Looks up a phase by the name returned by
+ *        @c dyad_stats_phase_name().
+ *
+ * @return The phase, or -1 if @p name is @c NULL or unknown.
+ */
+int dyad_stats_phase_from_name (const char *name);
+
+/**
+ * @brief Returns an upper bound of the @p q quantile of @p hist, in
+ *        nanoseconds.
+ *
+ * @param[in] hist  Histogram to read.
+ * @param[in] q     Quantile between 0 and 1, e.g., 0.99.
+ *
+ * @return The upper bound of the bucket holding the quantile, capped by
+ *         @c hist->max_ns, or 0 if @p hist is empty.
+ */
+uint64_t dyad_stats_quantile (const dyad_stats_hist_t *hist, double q);
+
+/**
+ * @brief Appends a table of the non-empty histograms of @p stats to
+ *        @p path, or writes it to standard error if @p path is @c "-".
+ *
+ * @details
+ * The table is written with a single @c write() to a file opened with
+ * @c O_APPEND, so that processes dumping to the same file do not
+ * interleave their tables. Does not log.
+ *
+ * @param[in] stats  Histograms to dump.
+ * @param[in] label  Heading of the table, e.g., the rank of the process.
+ * @param[in] path   File to append to.
+ *
+ * @return 0 on success, or -1 with @c errno set.
+ */
+int dyad_stats_dump (const dyad_stats_t *stats, const char *label, const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // DYAD_UTILS_STATS_H
@@ -0,0 +1,256 @@
+#if defined(DYAD_HAS_CONFIG)
+#include <dyad/dyad_config.hpp>
+#else
+#error "no config"
+#endif
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif  // _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "store_engine.h"
+
+/**
+ * @brief One part of a buffer, written by one thread.
+ */
+typedef struct store_part {
+    const dyad_store_opts_t *opts;
+    int fd;            ///< Descriptor of the file, through the page cache.
+    int direct_fd;     ///< Descriptor of the file opened with O_DIRECT, or -1.
+    const char *buf;   ///< First byte of the part.
+    size_t len;        ///< Number of bytes of the part.
+    off_t offset;      ///< File offset of @c buf.
+    size_t written;    ///< Number of leading bytes written.
+    int errnum;        ///< errno of the failed write, or 0.
+    bool queued;       ///< Whether the part was handed to the pool.
+} store_part_t;
+
+int dyad_store_prealloc (int fd, off_t offset, size_t len)
+{
+#ifdef FALLOC_FL_KEEP_SIZE
+    if (len == 0ul) {
+        return 0;
+    }
+    return fallocate (fd, FALLOC_FL_KEEP_SIZE, offset, (off_t)len);
+#else
+    (void)fd;
+    (void)offset;
+    (void)len;
+    errno = EOPNOTSUPP;
+    return -1;
+#endif
+}
+
+/**
+ * @brief Opens a second descriptor of the file open as @p fd, bypassing
+ *        the page cache.
+ *
+ * @return The descriptor, or -1 if the file system does not support
+ *         @c O_DIRECT.
+ */
+static int store_open_direct (int fd)
+{
+#ifdef O_DIRECT
+    char path[64] = {'\0'};
+    snprintf (path, sizeof (path), "/proc/self/fd/%d", fd);
+    return open (path, O_WRONLY | O_DIRECT);
+#else
+    (void)fd;
+    return -1;
+#endif
+}
+
+/**
+ * @brief Writes @p len bytes at @p offset, all of them multiples of
+ *        @c DYAD_STORE_ALIGNMENT, through the direct descriptor of
+ *        @p part, copying @p buf through an aligned buffer if needed.
+ *
+ * @return The number of bytes written. On a short count, @c errno is set,
+ *         to @c EIO if the engine reported no error.
+ */
+static size_t
+store_write_direct (const store_part_t *part, const char *buf, size_t len, off_t offset)
+{
+    char *bounce = NULL;
+    size_t done = 0ul;
+    size_t size = 0ul;
+    ssize_t n = 0l;
+
+    if ((uintptr_t)buf % DYAD_STORE_ALIGNMENT == 0ul) {
+        n = dyad_io_write (part->opts->engine, part->direct_fd, buf, len, offset);
+        if (n >= 0l && n != (ssize_t)len) {
+            errno = EIO;
+        }
+        return (n > 0l) ? (size_t)n : 0ul;
+    }
+    size = (len < DYAD_STORE_BOUNCE_SIZE) ? len : DYAD_STORE_BOUNCE_SIZE;
+    if (posix_memalign ((void **)&bounce, DYAD_STORE_ALIGNMENT, size) != 0) {
+        errno = ENOMEM;
+        return 0ul;
+    }
+    while (done < len) {
+        size = (len - done < DYAD_STORE_BOUNCE_SIZE) ? (len - done) : DYAD_STORE_BOUNCE_SIZE;
+        memcpy (bounce, buf + done, size);
+        n = dyad_io_write (part->opts->engine,
+                           part->direct_fd,
+                           bounce,
+                           size,
+                           offset + (off_t)done);
+        if (n != (ssize_t)size) {
+            if (n >= 0l) {
+                errno = EIO;
+            }
+            done += (n > 0l) ? (size_t)n : 0ul;
+            break;
+        }
+        done += size;
+    }
+    free (bounce);
+    return done;
+}
+
+/**
+ * @brief Writes the part through the page cache, or, with a direct
+ *        descriptor, its aligned body directly and its head and tail
+ *        through the page cache.
+ *
+ * @details
+ * A body the direct descriptor refuses, e.g., because the file system
+ * wants a larger alignment, is written through the page cache instead.
+ */
+static void store_write_part (store_part_t *part)
+{
+    size_t head = 0ul;
+    size_t body = 0ul;
+    size_t n = 0ul;
+    ssize_t ret = 0l;
+
+    if (part->direct_fd != -1) {
+        head = (DYAD_STORE_ALIGNMENT - (size_t)part->offset % DYAD_STORE_ALIGNMENT)
+               % DYAD_STORE_ALIGNMENT;
+        head = (head > part->len) ? part->len : head;
+        body = ((part->len - head) / DYAD_STORE_ALIGNMENT) * DYAD_STORE_ALIGNMENT;
+    }
+    if (head > 0ul) {
+        ret = dyad_io_write (part->opts->engine, part->fd, part->buf, head, part->offset);
+        if (ret != (ssize_t)head) {
+            goto part_failed;
+        }
+        part->written = head;
+    }
+    if (body > 0ul) {
+        n = store_write_direct (part, part->buf + head, body, part->offset + (off_t)head);
+        part->written += n;
+        if (n != body && errno != EINVAL) {
+            goto part_failed;
+        }
+    }
+    ret = dyad_io_write (part->opts->engine,
+                         part->fd,
+                         part->buf + part->written,
+                         part->len - part->written,
+                         part->offset + (off_t)part->written);
+    if (ret != (ssize_t)(part->len - part->written)) {
+        goto part_failed;
+    }
+    part->written = part->len;
+    return;
+
+part_failed:;
+    part->errnum = (errno != 0) ? errno : EIO;
+}
+
+static void store_part_work (void *arg)
+{
+    store_write_part ((store_part_t *)arg);
+}
+
+ssize_t dyad_store_write (const dyad_store_opts_t *opts,
+                          int fd,
+                          const void *buf,
+                          size_t len,
+                          off_t offset)
+{
+    store_part_t single;
+    store_part_t *part = &single;
+    size_t nparts = 1ul;
+    size_t i = 0ul;
+    off_t end = 0;
+    int direct_fd = -1;
+    ssize_t ret = (ssize_t)len;
+    dyad_work_group_t group;
+    bool grouped = false;
+
+    if (!opts->direct
+        && (opts->threads < 2u || opts->pool == NULL || len < 2ul * DYAD_STORE_MIN_PART)) {
+        return dyad_io_write (opts->engine, fd, buf, len, offset);
+    }
+    if (opts->threads > 1u && opts->pool != NULL) {
+        nparts = len / DYAD_STORE_MIN_PART;
+        nparts = (nparts > (size_t)opts->threads) ? (size_t)opts->threads : nparts;
+        nparts = (nparts == 0ul) ? 1ul : nparts;
+    }
+    if (nparts > 1ul) {
+        part = (store_part_t *)calloc (nparts, sizeof (store_part_t));
+        if (part == NULL) {
+            part = &single;
+            nparts = 1ul;
+        }
+    }
+    grouped = (nparts > 1ul && dyad_work_group_init (&group) == 0);
+    direct_fd = opts->direct ? store_open_direct (fd) : -1;
+    // Cut the buffer at aligned file offsets
+    for (i = 0ul; i < nparts; i++) {
+        part[i].opts = opts;
+        part[i].fd = fd;
+        part[i].direct_fd = direct_fd;
+        part[i].offset = (i == 0ul) ? offset : end;
+        end = offset + (off_t)len;
+        if (i + 1ul < nparts) {
+            end = offset + (off_t)((len / nparts) * (i + 1ul));
+            end -= end % (off_t)DYAD_STORE_ALIGNMENT;
+        }
+        part[i].buf = (const char *)buf + (part[i].offset - offset);
+        part[i].len = (size_t)(end - part[i].offset);
+        part[i].written = 0ul;
+        part[i].errnum = 0;
+        part[i].queued = false;
+        if (i > 0ul && grouped) {
+            part[i].queued =
+                (dyad_worker_pool_submit (opts->pool, &group, store_part_work, &part[i]) == 0);
+        }
+    }
+    store_write_part (&part[0]);
+    // Parts the pool had no thread for are written here
+    for (i = 1ul; i < nparts; i++) {
+        if (!part[i].queued) {
+            store_write_part (&part[i]);
+        }
+    }
+    if (grouped) {
+        dyad_work_group_wait (&group);
+    }
+    // Report the bytes up to the first failure
+    for (i = 0ul; i < nparts; i++) {
+        if (part[i].errnum != 0) {
+            errno = part[i].errnum;
+            ret = (ssize_t)(part[i].offset - offset) + (ssize_t)part[i].written;
+            break;
+        }
+    }
+    if (direct_fd != -1) {
+        close (direct_fd);
+    }
+    if (part != &single) {
+        free (part);
+    }
+    return ret;
+}
@@ -0,0 +1,108 @@
+/**
+ * @file store_engine.h
+ * @brief Writes of large received buffers to node-local storage, split
+ *        across threads and optionally bypassing the page cache.
+ *
+ * @details
+ * A buffer is cut into parts of at least @c DYAD_STORE_MIN_PART bytes,
+ * whose boundaries fall on multiples of @c DYAD_STORE_ALIGNMENT in the
+ * file. The first part is written by the caller and the others by the
+ * threads of a persistent @c worker_pool.h pool, with the I/O engine of
+ * @c io_engine.h, so that the copies into the page cache, or the device
+ * queue, are driven by several cores. As the threads outlive the writes,
+ * so do their @c io_uring rings.
+ *
+ * With direct I/O, the aligned body of each part is written through a
+ * second descriptor of the file opened with @c O_DIRECT. A body that does
+ * not start at an aligned address in memory is copied through an aligned
+ * bounce buffer, while the unaligned head and tail of the part go through
+ * the page cache. A file system that does not support @c O_DIRECT, e.g.,
+ * tmpfs, is written through the page cache.
+ */
+
+#ifndef DYAD_UTILS_STORE_ENGINE_H
+#define DYAD_UTILS_STORE_ENGINE_H
+
+#if defined(DYAD_HAS_CONFIG)
+#include <dyad/dyad_config.hpp>
+#else
+#error "no config"
+#endif
+
+#include <dyad/utils/io_engine.h>
+#include <dyad/utils/worker_pool.h>
+
+#ifdef __cplusplus
+#include <cstddef>
+
+extern "C" {
+#else
+#include <stdbool.h>
+#include <stddef.h>
+#endif
+#include <sys/types.h>
+
+/**
+ * @brief Alignment of the file offsets, lengths and memory addresses of
+ *        direct writes, and of the boundaries between parts.
+ */
+#define DYAD_STORE_ALIGNMENT 4096ul
+
+/**
+ * @brief Smallest part of a buffer given to a thread of its own.
+ */
+#define DYAD_STORE_MIN_PART (8ul * 1024ul * 1024ul)
+
+/**
+ * @brief Size of the aligned buffer through which unaligned data is copied
+ *        for direct writes.
+ */
+#define DYAD_STORE_BOUNCE_SIZE (4ul * 1024ul * 1024ul)
+
+/**
+ * @brief How @c dyad_store_write() writes a buffer.
+ */
+typedef struct dyad_store_opts {
+    dyad_io_engine_t engine;   ///< Engine issuing the writes of each part.
+    unsigned threads;          ///< Maximum number of parts written concurrently.
+    dyad_worker_pool_t *pool;  ///< Threads writing the parts after the first, or
+                               ///< NULL to write the buffer as a single part.
+    bool direct;               ///< Whether to bypass the page cache with @c O_DIRECT.
+} dyad_store_opts_t;
+
+/**
+ * @brief Reserves the blocks of @p len bytes at @p offset of @p fd without
+ *        changing the size of the file.
+ *
+ * @return 0, or -1 with @c errno set, e.g., to @c EOPNOTSUPP if the file
+ *         system does not support it.
+ */
+int dyad_store_prealloc (int fd, off_t offset, size_t len);
+
+/**
+ * @brief Writes exactly @p len bytes of @p buf to @p fd at @p offset.
+ *
+ * @details
+ * Thread-safe, and does not log, so that it can be called from the
+ * threads of a striped transfer.
+ *
+ * @param[in] opts    How to write the buffer. Must not be @c NULL.
+ * @param[in] fd      File descriptor opened for writing.
+ * @param[in] buf     Data to write.
+ * @param[in] len     Number of bytes of @p buf to write.
+ * @param[in] offset  File offset at which to write @p buf.
+ *
+ * @return @p len on success. A smaller value indicates an error, with
+ *         @c errno set.
+ */
+ssize_t dyad_store_write (const dyad_store_opts_t *opts,
+                          int fd,
+                          const void *buf,
+                          size_t len,
+                          off_t offset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // DYAD_UTILS_STORE_ENGINE_H
@@ -0,0 +1,256 @@
+/**
+ * @file test_mdata_cache.c
+ * @brief Self-checking test of the metadata cache of @c mdata_cache.h.
+ *
+ * @details
+ * Checks that records and cached misses expire after their own time to
+ * live, that the least recently used entries are evicted once the capacity
+ * is reached, and that the cache returned by @c dyad_mdata_cache_acquire()
+ * is shared by the users of a namespace and lives until the last of them
+ * releases it. Each failed check is printed to @c stderr.
+ *
+ * This is a standalone test executable and is not part of the DYAD library.
+ *
+ * Usage:
+ * @code
+ *   test_mdata_cache
+ * @endcode
+ *
+ * @retval EXIT_SUCCESS  All checks passed.
+ * @retval EXIT_FAILURE  At least one check failed.
+ */
+
+#if defined(DYAD_HAS_CONFIG)
+#include <dyad/dyad_config.hpp>
+#else
+#error "no config"
+#endif
+
+// clang-format off
+#include <dyad/utils/mdata_cache.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+// clang-format on
+
+static int failures = 0;
+
+#define CHECK(cond)                                                                   \
+    do {                                                                              \
+        if (!(cond)) {                                                                \
+            fprintf (stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                               \
+        }                                                                             \
+    } while (0)
+
+static void sleep_seconds (double seconds)
+{
+    struct timespec ts;
+    ts.tv_sec = (time_t)seconds;
+    ts.tv_nsec = (long)((seconds - (double)ts.tv_sec) * 1e9);
+    while (nanosleep (&ts, &ts) != 0) {
+    }
+}
+
+static dyad_mdata_record_t make_record (uint32_t rank)
+{
+    dyad_mdata_record_t record;
+    memset (&record, 0, sizeof (record));
+    record.owner_rank = rank;
+    record.flags = DYAD_MDATA_HAS_SIZE;
+    record.file_size = 1024ull * rank;
+    return record;
+}
+
+/**
+ * @brief Tells whether @p upath is cached as a record of @p rank.
+ */
+static bool has_record (dyad_mdata_cache_t *cache, const char *upath, uint32_t rank)
+{
+    bool found = false;
+    dyad_mdata_record_t record;
+    memset (&record, 0, sizeof (record));
+    return dyad_mdata_cache_get (cache, upath, &found, &record) == DYAD_RC_OK && found
+           && record.owner_rank == rank && record.file_size == 1024ull * rank;
+}
+
+static void test_ttl (void)
+{
+    dyad_mdata_cache_t *cache = NULL;
+    dyad_mdata_cache_stats_t stats;
+    dyad_mdata_record_t record = make_record (4u);
+    bool found = true;
+
+    CHECK (dyad_mdata_cache_create (16ul, 0.2, 0.0, &cache) == DYAD_RC_OK);
+    if (cache == NULL) {
+        return;
+    }
+    CHECK (dyad_mdata_cache_put (cache, "a", &record) == DYAD_RC_OK);
+    CHECK (has_record (cache, "a", 4u));
+    sleep_seconds (0.3);
+    CHECK (dyad_mdata_cache_get (cache, "a", &found, &record) == DYAD_RC_NOTFOUND);
+    dyad_mdata_cache_stats (cache, &stats);
+    CHECK (stats.hits == 1u);
+    CHECK (stats.misses == 1u);
+    CHECK (stats.entries == 0ul);
+
+    // Misses are not cached without a negative time to live
+    CHECK (dyad_mdata_cache_put_negative (cache, "b") == DYAD_RC_OK);
+    CHECK (dyad_mdata_cache_get (cache, "b", &found, &record) == DYAD_RC_NOTFOUND);
+    dyad_mdata_cache_destroy (cache);
+
+    // Without a time to live, records do not expire
+    CHECK (dyad_mdata_cache_create (16ul, 0.0, 0.0, &cache) == DYAD_RC_OK);
+    if (cache == NULL) {
+        return;
+    }
+    CHECK (dyad_mdata_cache_put (cache, "a", &record) == DYAD_RC_OK);
+    sleep_seconds (0.1);
+    CHECK (has_record (cache, "a", 4u));
+    dyad_mdata_cache_destroy (cache);
+}
+
+static void test_negative_ttl (void)
+{
+    dyad_mdata_cache_t *cache = NULL;
+    dyad_mdata_cache_stats_t stats;
+    dyad_mdata_record_t record = make_record (2u);
+    bool found = true;
+
+    // Misses expire well before records
+    CHECK (dyad_mdata_cache_create (16ul, 60.0, 0.2, &cache) == DYAD_RC_OK);
+    if (cache == NULL) {
+        return;
+    }
+    CHECK (dyad_mdata_cache_put_negative (cache, "missing") == DYAD_RC_OK);
+    CHECK (dyad_mdata_cache_put (cache, "present", &record) == DYAD_RC_OK);
+    CHECK (dyad_mdata_cache_get (cache, "missing", &found, &record) == DYAD_RC_OK);
+    CHECK (!found);
+    sleep_seconds (0.3);
+    CHECK (dyad_mdata_cache_get (cache, "missing", &found, &record) == DYAD_RC_NOTFOUND);
+    CHECK (has_record (cache, "present", 2u));
+    dyad_mdata_cache_stats (cache, &stats);
+    CHECK (stats.negative_hits == 1u);
+    CHECK (stats.hits == 1u);
+    CHECK (stats.misses == 1u);
+
+    // A record replaces a cached miss, and the other way around
+    CHECK (dyad_mdata_cache_put_negative (cache, "late") == DYAD_RC_OK);
+    CHECK (dyad_mdata_cache_put (cache, "late", &record) == DYAD_RC_OK);
+    CHECK (has_record (cache, "late", 2u));
+    CHECK (dyad_mdata_cache_put_negative (cache, "present") == DYAD_RC_OK);
+    CHECK (dyad_mdata_cache_get (cache, "present", &found, &record) == DYAD_RC_OK);
+    CHECK (!found);
+    dyad_mdata_cache_destroy (cache);
+}
+
+static void test_lru (void)
+{
+    dyad_mdata_cache_t *cache = NULL;
+    dyad_mdata_cache_stats_t stats;
+    dyad_mdata_record_t record;
+    bool found = false;
+
+    CHECK (dyad_mdata_cache_create (3ul, 0.0, 0.0, &cache) == DYAD_RC_OK);
+    if (cache == NULL) {
+        return;
+    }
+    record = make_record (1u);
+    CHECK (dyad_mdata_cache_put (cache, "a", &record) == DYAD_RC_OK);
+    record = make_record (2u);
+    CHECK (dyad_mdata_cache_put (cache, "b", &record) == DYAD_RC_OK);
+    record = make_record (3u);
+    CHECK (dyad_mdata_cache_put (cache, "c", &record) == DYAD_RC_OK);
+    // Using "a" leaves "b" as the least recently used entry
+    CHECK (has_record (cache, "a", 1u));
+    record = make_record (4u);
+    CHECK (dyad_mdata_cache_put (cache, "d", &record) == DYAD_RC_OK);
+    dyad_mdata_cache_stats (cache, &stats);
+    CHECK (stats.entries == 3ul);
+    CHECK (stats.evictions == 1u);
+    CHECK (dyad_mdata_cache_get (cache, "b", &found, &record) == DYAD_RC_NOTFOUND);
+    CHECK (has_record (cache, "a", 1u));
+    CHECK (has_record (cache, "c", 3u));
+    CHECK (has_record (cache, "d", 4u));
+
+    // Replacing an entry at capacity evicts nothing
+    record = make_record (5u);
+    CHECK (dyad_mdata_cache_put (cache, "c", &record) == DYAD_RC_OK);
+    dyad_mdata_cache_stats (cache, &stats);
+    CHECK (stats.entries == 3ul);
+    CHECK (stats.evictions == 1u);
+    CHECK (has_record (cache, "c", 5u));
+
+    // Nor does re-inserting after an invalidation
+    dyad_mdata_cache_invalidate (cache, "a");
+    CHECK (dyad_mdata_cache_get (cache, "a", &found, &record) == DYAD_RC_NOTFOUND);
+    record = make_record (6u);
+    CHECK (dyad_mdata_cache_put (cache, "e", &record) == DYAD_RC_OK);
+    dyad_mdata_cache_stats (cache, &stats);
+    CHECK (stats.entries == 3ul);
+    CHECK (stats.evictions == 1u);
+    dyad_mdata_cache_destroy (cache);
+}
+
+static void test_shared (void)
+{
+    dyad_mdata_cache_t *first = NULL;
+    dyad_mdata_cache_t *second = NULL;
+    dyad_mdata_cache_t *other = NULL;
+    dyad_mdata_cache_t *again = NULL;
+    dyad_mdata_cache_stats_t stats;
+    dyad_mdata_record_t record = make_record (9u);
+
+    CHECK (dyad_mdata_cache_acquire ("ns", 16ul, 0.0, 0.0, &first) == DYAD_RC_OK);
+    // Sized by its first user
+    CHECK (dyad_mdata_cache_acquire ("ns", 1ul, 0.0, 0.0, &second) == DYAD_RC_OK);
+    CHECK (first != NULL && first == second);
+    CHECK (dyad_mdata_cache_acquire ("other", 16ul, 0.0, 0.0, &other) == DYAD_RC_OK);
+    CHECK (other != NULL && other != first);
+    if (first == NULL || second == NULL || other == NULL) {
+        return;
+    }
+
+    CHECK (dyad_mdata_cache_put (first, "x", &record) == DYAD_RC_OK);
+    CHECK (dyad_mdata_cache_put (first, "y", &record) == DYAD_RC_OK);
+    CHECK (has_record (second, "x", 9u));
+    CHECK (has_record (second, "y", 9u));
+    dyad_mdata_cache_stats (other, &stats);
+    CHECK (stats.entries == 0ul);
+
+    // The cache outlives all but its last user
+    dyad_mdata_cache_release (first);
+    CHECK (has_record (second, "x", 9u));
+    CHECK (dyad_mdata_cache_acquire ("ns", 16ul, 0.0, 0.0, &again) == DYAD_RC_OK);
+    CHECK (again == second);
+    dyad_mdata_cache_release (again);
+    dyad_mdata_cache_release (second);
+    dyad_mdata_cache_release (other);
+
+    // and a new one is created once it is gone
+    CHECK (dyad_mdata_cache_acquire ("ns", 16ul, 0.0, 0.0, &again) == DYAD_RC_OK);
+    if (again == NULL) {
+        return;
+    }
+    dyad_mdata_cache_stats (again, &stats);
+    CHECK (stats.entries == 0ul);
+    CHECK (stats.hits == 0u);
+    dyad_mdata_cache_release (again);
+    dyad_mdata_cache_release (NULL);
+}
+
+int main (void)
+{
+    test_ttl ();
+    test_negative_ttl ();
+    test_lru ();
+    test_shared ();
+
+    if (failures > 0) {
+        fprintf (stderr, "%d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf ("All checks passed\n");
+    return EXIT_SUCCESS;
+}
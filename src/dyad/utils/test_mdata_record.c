@@ -0,0 +1,175 @@
+/**
+ * @file test_mdata_record.c
+ * @brief Self-checking test of @c dyad_mdata_record_encode() and
+ *        @c dyad_mdata_record_decode().
+ *
+ * @details
+ * Checks that an encoded record decodes to the same fields, flags
+ * included, that truncated or unknown values are rejected, and that the
+ * JSON integer published by older producers decodes to its rank alone.
+ * Each failed check is printed to @c stderr.
+ *
+ * This is a standalone test executable and is not part of the DYAD library.
+ *
+ * Usage:
+ * @code
+ *   test_mdata_record
+ * @endcode
+ *
+ * @retval EXIT_SUCCESS  All checks passed.
+ * @retval EXIT_FAILURE  At least one check failed.
+ */
+
+#if defined(DYAD_HAS_CONFIG)
+#include <dyad/dyad_config.hpp>
+#else
+#error "no config"
+#endif
+
+// clang-format off
+#include <dyad/utils/mdata_record.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+// clang-format on
+
+static int failures = 0;
+
+#define CHECK(cond)                                                                   \
+    do {                                                                              \
+        if (!(cond)) {                                                                \
+            fprintf (stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                               \
+        }                                                                             \
+    } while (0)
+
+static void test_round_trip (void)
+{
+    unsigned char buf[DYAD_MDATA_RECORD_SIZE];
+    dyad_mdata_record_t in = {7u,
+                              DYAD_MDATA_HAS_SIZE | DYAD_MDATA_HAS_CHECKSUM,
+                              123456789012ull,
+                              -1700000000123456789ll,
+                              0xfedcba9876543210ull,
+                              DYAD_MDATA_CHECKSUM_BLOCK};
+    dyad_mdata_record_t out;
+
+    dyad_mdata_record_encode (&in, buf);
+    CHECK (memcmp (buf, DYAD_MDATA_RECORD_MAGIC, 4ul) == 0);
+    CHECK (buf[12] == 0u && buf[13] == 0u && buf[14] == 0u && buf[15] == 0u);
+    // Little-endian regardless of the host
+    CHECK (buf[4] == 7u && buf[5] == 0u && buf[6] == 0u && buf[7] == 0u);
+
+    CHECK (dyad_mdata_record_decode (buf, sizeof (buf), &out) == DYAD_RC_OK);
+    CHECK (out.owner_rank == in.owner_rank);
+    CHECK (out.flags == in.flags);
+    CHECK (out.file_size == in.file_size);
+    CHECK (out.mtime_ns == in.mtime_ns);
+    CHECK (out.checksum == in.checksum);
+    CHECK (out.block_size == in.block_size);
+
+    // Trailing bytes after a full record are ignored
+    {
+        unsigned char longer[DYAD_MDATA_RECORD_SIZE + 8ul];
+        memset (longer, 0xff, sizeof (longer));
+        memcpy (longer, buf, sizeof (buf));
+        CHECK (dyad_mdata_record_decode (longer, sizeof (longer), &out) == DYAD_RC_OK);
+        CHECK (out.checksum == in.checksum);
+    }
+}
+
+static void test_flags (void)
+{
+    unsigned char buf[DYAD_MDATA_RECORD_SIZE];
+    dyad_mdata_record_t in = {3u, 0u, 0ull, 0ll, 0ull, 0ull};
+    dyad_mdata_record_t out;
+
+    // A rank-only record keeps its flags clear
+    dyad_mdata_record_encode (&in, buf);
+    CHECK (dyad_mdata_record_decode (buf, sizeof (buf), &out) == DYAD_RC_OK);
+    CHECK (out.owner_rank == 3u);
+    CHECK (out.flags == 0u);
+
+    in.flags = DYAD_MDATA_HAS_SIZE;
+    in.file_size = 4096ull;
+    dyad_mdata_record_encode (&in, buf);
+    CHECK (dyad_mdata_record_decode (buf, sizeof (buf), &out) == DYAD_RC_OK);
+    CHECK (out.flags == DYAD_MDATA_HAS_SIZE);
+    CHECK ((out.flags & DYAD_MDATA_HAS_CHECKSUM) == 0u);
+    CHECK ((out.flags & DYAD_MDATA_FROM_KVS) == 0u);
+
+    // The high bits are carried as they are, so the consumer-only bit must
+    // be set after decoding rather than published
+    in.flags = DYAD_MDATA_HAS_SIZE | DYAD_MDATA_FROM_KVS;
+    dyad_mdata_record_encode (&in, buf);
+    CHECK (dyad_mdata_record_decode (buf, sizeof (buf), &out) == DYAD_RC_OK);
+    CHECK (out.flags == (DYAD_MDATA_HAS_SIZE | DYAD_MDATA_FROM_KVS));
+}
+
+static void test_invalid (void)
+{
+    unsigned char buf[DYAD_MDATA_RECORD_SIZE];
+    dyad_mdata_record_t in = {5u, DYAD_MDATA_HAS_SIZE, 10ull, 20ll, 0ull, 0ull};
+    dyad_mdata_record_t out;
+
+    dyad_mdata_record_encode (&in, buf);
+
+    // Truncated records
+    CHECK (dyad_mdata_record_decode (buf, DYAD_MDATA_RECORD_SIZE - 1ul, &out)
+           == DYAD_RC_BADMETADATA);
+    CHECK (dyad_mdata_record_decode (buf, 4ul, &out) == DYAD_RC_BADMETADATA);
+    CHECK (dyad_mdata_record_decode (buf, 0ul, &out) == DYAD_RC_BADMETADATA);
+    CHECK (dyad_mdata_record_decode (NULL, sizeof (buf), &out) == DYAD_RC_BADMETADATA);
+
+    // A failed decode leaves no stale field behind
+    out.owner_rank = 99u;
+    out.flags = DYAD_MDATA_HAS_SIZE;
+    CHECK (dyad_mdata_record_decode (buf, 1ul, &out) == DYAD_RC_BADMETADATA);
+    CHECK (out.owner_rank == 0u && out.flags == 0u);
+
+    // Unknown format version
+    buf[3] = 2u;
+    CHECK (dyad_mdata_record_decode (buf, sizeof (buf), &out) == DYAD_RC_BADMETADATA);
+
+    // Values that are not a JSON integer either
+    CHECK (dyad_mdata_record_decode ("", 0ul, &out) == DYAD_RC_BADMETADATA);
+    CHECK (dyad_mdata_record_decode ("12a", 3ul, &out) == DYAD_RC_BADMETADATA);
+    CHECK (dyad_mdata_record_decode ("abc", 3ul, &out) == DYAD_RC_BADMETADATA);
+    CHECK (dyad_mdata_record_decode ("4294967296", 10ul, &out) == DYAD_RC_BADMETADATA);
+    CHECK (dyad_mdata_record_decode ("1234567890123456", 16ul, &out) == DYAD_RC_BADMETADATA);
+}
+
+static void test_legacy (void)
+{
+    dyad_mdata_record_t out;
+
+    CHECK (dyad_mdata_record_decode ("42", 2ul, &out) == DYAD_RC_OK);
+    CHECK (out.owner_rank == 42u);
+    CHECK (out.flags == 0u);
+    CHECK (out.file_size == 0ull && out.mtime_ns == 0ll);
+    CHECK (out.checksum == 0ull && out.block_size == 0ull);
+
+    CHECK (dyad_mdata_record_decode ("0", 1ul, &out) == DYAD_RC_OK);
+    CHECK (out.owner_rank == 0u);
+    CHECK (dyad_mdata_record_decode ("4294967295", 10ul, &out) == DYAD_RC_OK);
+    CHECK (out.owner_rank == 4294967295u);
+
+    // Only the given length is read
+    CHECK (dyad_mdata_record_decode ("17xyz", 2ul, &out) == DYAD_RC_OK);
+    CHECK (out.owner_rank == 17u);
+}
+
+int main (void)
+{
+    test_round_trip ();
+    test_flags ();
+    test_invalid ();
+    test_legacy ();
+
+    if (failures > 0) {
+        fprintf (stderr, "%d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf ("All checks passed\n");
+    return EXIT_SUCCESS;
+}
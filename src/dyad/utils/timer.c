@@ -0,0 +1,152 @@
+#if defined(DYAD_HAS_CONFIG)
+#include <dyad/dyad_config.hpp>
+#else
+#error "no config"
+#endif
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "timer.h"
+
+struct dyad_timer {
+    pthread_mutex_t lock;      ///< Lent to the owner by dyad_timer_lock().
+    pthread_mutex_t state;     ///< Guards the fields below.
+    pthread_cond_t wake;       ///< Signaled when armed or on shutdown.
+    pthread_t thread;          ///< Helper thread, if @c started.
+    bool started;              ///< Whether @c thread was created.
+    bool stopping;             ///< Set by dyad_timer_destroy().
+    bool armed;                ///< Whether @c deadline is pending.
+    struct timespec deadline;  ///< When to call @c fn, on CLOCK_MONOTONIC.
+    dyad_timer_fn_t fn;        ///< Callback of the pending deadline.
+    void *arg;                 ///< Argument of @c fn.
+};
+
+static bool dyad_timer_passed (const struct timespec *deadline)
+{
+    struct timespec now;
+    clock_gettime (CLOCK_MONOTONIC, &now);
+    return now.tv_sec > deadline->tv_sec
+           || (now.tv_sec == deadline->tv_sec && now.tv_nsec >= deadline->tv_nsec);
+}
+
+static void *dyad_timer_main (void *arg)
+{
+    dyad_timer_t *timer = (dyad_timer_t *)arg;
+    dyad_timer_fn_t fn = NULL;
+    void *fn_arg = NULL;
+
+    pthread_mutex_lock (&timer->state);
+    while (!timer->stopping) {
+        if (!timer->armed) {
+            pthread_cond_wait (&timer->wake, &timer->state);
+            continue;
+        }
+        if (!dyad_timer_passed (&timer->deadline)) {
+            pthread_cond_timedwait (&timer->wake, &timer->state, &timer->deadline);
+            continue;
+        }
+        timer->armed = false;
+        fn = timer->fn;
+        fn_arg = timer->arg;
+        pthread_mutex_unlock (&timer->state);
+        fn (fn_arg);
+        pthread_mutex_lock (&timer->state);
+    }
+    pthread_mutex_unlock (&timer->state);
+    return NULL;
+}
+
+int dyad_timer_create (dyad_timer_t **timer)
+{
+    dyad_timer_t *t = NULL;
+    pthread_condattr_t attr;
+
+    t = (dyad_timer_t *)calloc (1ul, sizeof (dyad_timer_t));
+    if (t == NULL) {
+        return -1;
+    }
+    if (pthread_condattr_init (&attr) != 0) {
+        free (t);
+        errno = ENOMEM;
+        return -1;
+    }
+    // Deadlines are taken on the monotonic clock, which wall clock
+    // adjustments do not move
+    pthread_condattr_setclock (&attr, CLOCK_MONOTONIC);
+    if (pthread_cond_init (&t->wake, &attr) != 0) {
+        pthread_condattr_destroy (&attr);
+        free (t);
+        errno = ENOMEM;
+        return -1;
+    }
+    pthread_condattr_destroy (&attr);
+    pthread_mutex_init (&t->lock, NULL);
+    pthread_mutex_init (&t->state, NULL);
+    *timer = t;
+    return 0;
+}
+
+void dyad_timer_destroy (dyad_timer_t *timer)
+{
+    if (timer == NULL) {
+        return;
+    }
+    pthread_mutex_lock (&timer->state);
+    timer->stopping = true;
+    timer->armed = false;
+    pthread_cond_signal (&timer->wake);
+    pthread_mutex_unlock (&timer->state);
+    if (timer->started) {
+        pthread_join (timer->thread, NULL);
+    }
+    pthread_cond_destroy (&timer->wake);
+    pthread_mutex_destroy (&timer->state);
+    pthread_mutex_destroy (&timer->lock);
+    free (timer);
+}
+
+int dyad_timer_arm (dyad_timer_t *timer, double delay, dyad_timer_fn_t fn, void *arg)
+{
+    struct timespec deadline;
+    int rc = 0;
+
+    clock_gettime (CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += (time_t)delay;
+    deadline.tv_nsec += (long)((delay - (double)(time_t)delay) * 1e9);
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    pthread_mutex_lock (&timer->state);
+    if (!timer->started && !timer->stopping) {
+        rc = pthread_create (&timer->thread, NULL, dyad_timer_main, timer);
+        timer->started = (rc == 0);
+    }
+    if (timer->started) {
+        timer->deadline = deadline;
+        timer->fn = fn;
+        timer->arg = arg;
+        timer->armed = true;
+        pthread_cond_signal (&timer->wake);
+    }
+    pthread_mutex_unlock (&timer->state);
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+    return 0;
+}
+
+void dyad_timer_lock (dyad_timer_t *timer)
+{
+    pthread_mutex_lock (&timer->lock);
+}
+
+void dyad_timer_unlock (dyad_timer_t *timer)
+{
+    pthread_mutex_unlock (&timer->lock);
+}
@@ -0,0 +1,78 @@
+/**
+ * @file timer.h
+ * @brief One-shot deadline run on a helper thread, for work that must
+ *        happen even while its owner is busy elsewhere, such as committing
+ *        a publication batch that grew old.
+ *
+ * @details
+ * A timer holds at most one pending deadline. Arming it again replaces the
+ * pending one. The callback runs on the helper thread, which is started the
+ * first time the timer is armed, so that a timer that is never armed costs
+ * no thread.
+ *
+ * The timer also carries a mutex, with which the owner guards the state it
+ * shares with the callback. The callback is called without it held.
+ *
+ * All functions are thread-safe and do not log.
+ */
+
+#ifndef DYAD_UTILS_TIMER_H
+#define DYAD_UTILS_TIMER_H
+
+#if defined(DYAD_HAS_CONFIG)
+#include <dyad/dyad_config.hpp>
+#else
+#error "no config"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Opaque timer handle.
+ */
+typedef struct dyad_timer dyad_timer_t;
+
+/**
+ * @brief Callback run on the helper thread once the deadline passed.
+ */
+typedef void (*dyad_timer_fn_t) (void *arg);
+
+/**
+ * @brief Creates a disarmed timer.
+ *
+ * @return 0, or -1 with @c errno set.
+ */
+int dyad_timer_create (dyad_timer_t **timer);
+
+/**
+ * @brief Disarms @p timer, waits for a running callback, stops the helper
+ *        thread and frees the timer. A @c NULL timer is ignored.
+ */
+void dyad_timer_destroy (dyad_timer_t *timer);
+
+/**
+ * @brief Arms @p timer to call @p fn with @p arg in @p delay seconds,
+ *        replacing the pending deadline, if any.
+ *
+ * @return 0, or -1 with @c errno set if the helper thread could not be
+ *         started.
+ */
+int dyad_timer_arm (dyad_timer_t *timer, double delay, dyad_timer_fn_t fn, void *arg);
+
+/**
+ * @brief Locks the mutex of @p timer.
+ */
+void dyad_timer_lock (dyad_timer_t *timer);
+
+/**
+ * @brief Unlocks the mutex of @p timer.
+ */
+void dyad_timer_unlock (dyad_timer_t *timer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // DYAD_UTILS_TIMER_H
@@ -55,6 +55,7 @@
 #include <dyad/common/dyad_logging.h>
 #include <dyad/common/dyad_profiler.h>
 #include <dyad/utils/murmur3.h>
+#include <dyad/utils/stats.h>
 
 #ifndef DYAD_PATH_DELIM
 #define DYAD_PATH_DELIM "/"
@@ -526,6 +527,7 @@ dyad_rc_t dyad_excl_flock (const dyad_ctx_t* __restrict__ ctx,
                            struct flock* __restrict__ lock)
 {
     dyad_rc_t rc = DYAD_RC_OK;
+    uint64_t t0 = 0ull;
     DYAD_C_FUNCTION_START ();
     DYAD_C_FUNCTION_UPDATE_INT ("fd", fd);
     DYAD_LOG_DEBUG (ctx,
@@ -542,12 +544,14 @@ dyad_rc_t dyad_excl_flock (const dyad_ctx_t* __restrict__ ctx,
     lock->l_whence = SEEK_SET;
     lock->l_start = 0;
     lock->l_len = 0;
-    lock->l_pid = ctx->pid;                  // getpid();
+    lock->l_pid = ctx->pid;  // getpid();
+    t0 = dyad_stats_now ();
     if (fcntl (fd, F_SETLKW, lock) == -1) {  // will wait until able to lock
         DYAD_LOG_ERROR (ctx, "DYAD UTIL: Cannot apply exclusive lock on fd %d.", fd);
         rc = DYAD_RC_BADFIO;
         goto excl_flock_end;
     }
+    dyad_stats_record (DYAD_STATS_LOCK_WAIT, t0);
     rc = DYAD_RC_OK;
 excl_flock_end:;
     DYAD_C_FUNCTION_END ();
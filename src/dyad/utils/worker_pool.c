@@ -0,0 +1,205 @@
+#if defined(DYAD_HAS_CONFIG)
+#include <dyad/dyad_config.hpp>
+#else
+#error "no config"
+#endif
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "worker_pool.h"
+
+/**
+ * @brief A queued task.
+ */
+typedef struct dyad_work {
+    dyad_work_fn_t fn;
+    void *arg;
+    dyad_work_group_t *group;  ///< Group notified once @c fn returned.
+    struct dyad_work *next;
+} dyad_work_t;
+
+struct dyad_worker_pool {
+    pthread_mutex_t lock;
+    pthread_cond_t ready;      ///< Signaled when a task is queued or on shutdown.
+    dyad_work_t *head;         ///< Oldest queued task, or NULL.
+    dyad_work_t *tail;         ///< Newest queued task, or NULL.
+    pthread_t *threads;        ///< Started threads, @c started of them.
+    unsigned max_threads;      ///< Capacity of @c threads.
+    unsigned started;          ///< Number of threads started.
+    unsigned idle;             ///< Number of threads waiting for a task.
+    dyad_work_fn_t on_start;   ///< Run by each thread when it starts, or NULL.
+    void *on_start_arg;        ///< Argument of @c on_start.
+    bool stopping;             ///< Set by dyad_worker_pool_destroy().
+};
+
+static void *dyad_worker_main (void *arg)
+{
+    dyad_worker_pool_t *pool = (dyad_worker_pool_t *)arg;
+    dyad_work_t *work = NULL;
+
+    if (pool->on_start != NULL) {
+        pool->on_start (pool->on_start_arg);
+    }
+    pthread_mutex_lock (&pool->lock);
+    for (;;) {
+        while (pool->head == NULL && !pool->stopping) {
+            pool->idle++;
+            pthread_cond_wait (&pool->ready, &pool->lock);
+            pool->idle--;
+        }
+        if (pool->head == NULL) {
+            break;
+        }
+        work = pool->head;
+        pool->head = work->next;
+        if (pool->head == NULL) {
+            pool->tail = NULL;
+        }
+        pthread_mutex_unlock (&pool->lock);
+        work->fn (work->arg);
+        pthread_mutex_lock (&work->group->lock);
+        if (--work->group->pending == 0u) {
+            pthread_cond_broadcast (&work->group->done);
+        }
+        pthread_mutex_unlock (&work->group->lock);
+        free (work);
+        pthread_mutex_lock (&pool->lock);
+    }
+    pthread_mutex_unlock (&pool->lock);
+    return NULL;
+}
+
+int dyad_worker_pool_create (unsigned max_threads,
+                             dyad_work_fn_t on_start,
+                             void *arg,
+                             dyad_worker_pool_t **pool)
+{
+    dyad_worker_pool_t *p = NULL;
+
+    if (max_threads == 0u || pool == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    p = (dyad_worker_pool_t *)calloc (1ul, sizeof (dyad_worker_pool_t));
+    if (p == NULL) {
+        return -1;
+    }
+    p->threads = (pthread_t *)calloc (max_threads, sizeof (pthread_t));
+    if (p->threads == NULL) {
+        free (p);
+        return -1;
+    }
+    if (pthread_mutex_init (&p->lock, NULL) != 0) {
+        free (p->threads);
+        free (p);
+        errno = ENOMEM;
+        return -1;
+    }
+    if (pthread_cond_init (&p->ready, NULL) != 0) {
+        pthread_mutex_destroy (&p->lock);
+        free (p->threads);
+        free (p);
+        errno = ENOMEM;
+        return -1;
+    }
+    p->max_threads = max_threads;
+    p->on_start = on_start;
+    p->on_start_arg = arg;
+    *pool = p;
+    return 0;
+}
+
+void dyad_worker_pool_destroy (dyad_worker_pool_t *pool)
+{
+    unsigned i = 0u;
+
+    if (pool == NULL) {
+        return;
+    }
+    pthread_mutex_lock (&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast (&pool->ready);
+    pthread_mutex_unlock (&pool->lock);
+    for (i = 0u; i < pool->started; i++) {
+        pthread_join (pool->threads[i], NULL);
+    }
+    pthread_cond_destroy (&pool->ready);
+    pthread_mutex_destroy (&pool->lock);
+    free (pool->threads);
+    free (pool);
+}
+
+int dyad_work_group_init (dyad_work_group_t *group)
+{
+    group->pending = 0u;
+    if (pthread_mutex_init (&group->lock, NULL) != 0) {
+        errno = ENOMEM;
+        return -1;
+    }
+    if (pthread_cond_init (&group->done, NULL) != 0) {
+        pthread_mutex_destroy (&group->lock);
+        errno = ENOMEM;
+        return -1;
+    }
+    return 0;
+}
+
+void dyad_work_group_wait (dyad_work_group_t *group)
+{
+    pthread_mutex_lock (&group->lock);
+    while (group->pending > 0u) {
+        pthread_cond_wait (&group->done, &group->lock);
+    }
+    pthread_mutex_unlock (&group->lock);
+    pthread_cond_destroy (&group->done);
+    pthread_mutex_destroy (&group->lock);
+}
+
+int dyad_worker_pool_submit (dyad_worker_pool_t *pool,
+                             dyad_work_group_t *group,
+                             dyad_work_fn_t fn,
+                             void *arg)
+{
+    dyad_work_t *work = NULL;
+    int rc = 0;
+
+    if (pool == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    work = (dyad_work_t *)malloc (sizeof (dyad_work_t));
+    if (work == NULL) {
+        return -1;
+    }
+    work->fn = fn;
+    work->arg = arg;
+    work->group = group;
+    work->next = NULL;
+    pthread_mutex_lock (&pool->lock);
+    if (pool->idle == 0u && pool->started < pool->max_threads) {
+        rc = pthread_create (&pool->threads[pool->started], NULL, dyad_worker_main, pool);
+        if (rc == 0) {
+            pool->started++;
+        }
+    }
+    if (pool->started == 0u || pool->stopping) {
+        pthread_mutex_unlock (&pool->lock);
+        free (work);
+        errno = (rc != 0) ? rc : EAGAIN;
+        return -1;
+    }
+    pthread_mutex_lock (&group->lock);
+    group->pending++;
+    pthread_mutex_unlock (&group->lock);
+    if (pool->tail == NULL) {
+        pool->head = work;
+    } else {
+        pool->tail->next = work;
+    }
+    pool->tail = work;
+    pthread_cond_signal (&pool->ready);
+    pthread_mutex_unlock (&pool->lock);
+    return 0;
+}
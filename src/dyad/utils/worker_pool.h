@@ -0,0 +1,110 @@
+/**
+ * @file worker_pool.h
+ * @brief Persistent threads running the work of one owner, such as the
+ *        byte ranges of a striped fetch or the parts of a large write.
+ *
+ * @details
+ * Threads are started on demand, up to a maximum, and then wait for more
+ * work until the pool is destroyed, so that what a thread sets up when it
+ * starts, e.g., a DYAD context or an @c io_uring ring, is reused by every
+ * task it runs rather than built and torn down per task.
+ *
+ * Tasks are submitted as part of a @c dyad_work_group_t, on which the
+ * submitter waits for them, so that several threads can share a pool.
+ *
+ * All functions are thread-safe and do not log.
+ */
+
+#ifndef DYAD_UTILS_WORKER_POOL_H
+#define DYAD_UTILS_WORKER_POOL_H
+
+#if defined(DYAD_HAS_CONFIG)
+#include <dyad/dyad_config.hpp>
+#else
+#error "no config"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <pthread.h>
+
+/**
+ * @brief Opaque worker pool handle.
+ */
+typedef struct dyad_worker_pool dyad_worker_pool_t;
+
+/**
+ * @brief Task run by a worker, or hook run by a worker when it starts.
+ */
+typedef void (*dyad_work_fn_t) (void *arg);
+
+/**
+ * @brief Tasks a submitter waits for together.
+ */
+typedef struct dyad_work_group {
+    pthread_mutex_t lock;
+    pthread_cond_t done;  ///< Signaled when @c pending drops to 0.
+    unsigned pending;     ///< Number of submitted tasks not finished yet.
+} dyad_work_group_t;
+
+/**
+ * @brief Creates a pool of up to @p max_threads threads, none started yet.
+ *
+ * @param[in]  max_threads  Maximum number of threads. Must be positive.
+ * @param[in]  on_start     Run by each thread when it starts, with
+ *                          @p arg, or @c NULL.
+ * @param[in]  arg          Argument of @p on_start.
+ * @param[out] pool         Set to the new pool.
+ *
+ * @return 0, or -1 with @c errno set.
+ */
+int dyad_worker_pool_create (unsigned max_threads,
+                             dyad_work_fn_t on_start,
+                             void *arg,
+                             dyad_worker_pool_t **pool);
+
+/**
+ * @brief Lets the threads of @p pool finish the submitted tasks, joins
+ *        them and frees the pool. A @c NULL pool is ignored.
+ *
+ * @details
+ * Thread-local state set up by @c on_start is released by the destructors
+ * of its keys when the threads exit.
+ */
+void dyad_worker_pool_destroy (dyad_worker_pool_t *pool);
+
+/**
+ * @brief Initializes an empty group.
+ *
+ * @return 0, or -1 with @c errno set.
+ */
+int dyad_work_group_init (dyad_work_group_t *group);
+
+/**
+ * @brief Waits for the tasks of @p group, then releases it.
+ */
+void dyad_work_group_wait (dyad_work_group_t *group);
+
+/**
+ * @brief Queues @p fn to run with @p arg on a thread of @p pool, as part
+ *        of @p group.
+ *
+ * @details
+ * Starts a thread if none is idle and the pool has fewer than its maximum.
+ * A task is only queued if the pool has a thread to run it, so that the
+ * caller can run it itself otherwise.
+ *
+ * @return 0, or -1 with @c errno set if no thread could be started.
+ */
+int dyad_worker_pool_submit (dyad_worker_pool_t *pool,
+                             dyad_work_group_t *group,
+                             dyad_work_fn_t fn,
+                             void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // DYAD_UTILS_WORKER_POOL_H
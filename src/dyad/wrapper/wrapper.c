@@ -47,6 +47,7 @@ using namespace std;  // std::clock ()
 #include <dyad/utils/utils.h>
 #include <fcntl.h>
 #include <libgen.h>  // dirname
+#include <pthread.h>
 #include <unistd.h>
 
 #pragma clang diagnostic push
@@ -61,6 +62,13 @@ extern "C" {
 
 static __thread const dyad_ctx_t *ctx = NULL;
 static __thread dyad_ctx_t *ctx_mutable = NULL;
+static __thread bool ctx_attached = false;
+// Context of the thread that loaded the wrapper, used to tell which files
+// are managed by DYAD before another thread gets a context of its own.
+// Read under main_ctx_lock, which dyad_wrapper_fini () takes for writing
+// before the context is freed
+static const dyad_ctx_t *main_ctx = NULL;
+static pthread_rwlock_t main_ctx_lock = PTHREAD_RWLOCK_INITIALIZER;
 static void dyad_wrapper_init (void) __attribute__ ((constructor));
 static void dyad_wrapper_fini (void) __attribute__ ((destructor));
 
@@ -158,6 +166,10 @@ static __attribute__ ((constructor)) void dyad_wrapper_init (void)
     dyad_ctx_init (DYAD_COMM_RECV, NULL);
     DYAD_C_FUNCTION_START ();  // this is after initialization of profiler
     ctx = ctx_mutable = dyad_ctx_get ();
+    pthread_rwlock_wrlock (&main_ctx_lock);
+    main_ctx = ctx;
+    pthread_rwlock_unlock (&main_ctx_lock);
+    ctx_attached = true;
     // See dyad_consume () in dyad_client.c
     // TODO: In case that the wrapper and c++ stream wrapper class co-exist
     // this variable should be context dependent.
@@ -191,9 +203,59 @@ static __attribute__ ((destructor)) void dyad_wrapper_fini (void)
     DYAD_C_FUNCTION_START ();
     DYAD_LOG_DEBUG (ctx, "DYAD Wrapper: Finalized");
     DYAD_C_FUNCTION_END ();  // this is before teardown of profiler
+    // Wait for the threads still reading the context before it is freed
+    pthread_rwlock_wrlock (&main_ctx_lock);
+    main_ctx = NULL;
+    pthread_rwlock_unlock (&main_ctx_lock);
     dyad_ctx_fini ();
 }
 
+/**
+ * @brief Gives the calling thread its own DYAD context the first time it
+ *        opens a file managed by DYAD.
+ *
+ * @details
+ * Only the thread that loaded the wrapper gets a context from
+ * @c dyad_wrapper_init(). Without one, the other threads, e.g., the workers
+ * of a multithreaded data loader, would bypass DYAD. Sharing that context
+ * instead would make their transfers race on its Flux and DTL handles, so
+ * each thread gets a context of its own from @c dyad_ctx_attach(), and
+ * fetches run in parallel across threads.
+ *
+ * Threads that never open a file under a managed path, such as those
+ * created by the DTL libraries, are left without a context. The attempt is
+ * made once per thread, and opens performed while initializing the context
+ * are not intercepted.
+ *
+ * @param[in] path  Path of the file being opened. May be @c NULL.
+ */
+static void dyad_wrapper_attach (const char *path)
+{
+    char upath[PATH_MAX + 1] = {'\0'};
+    bool managed = false;
+
+    if (ctx_attached || path == NULL) {
+        return;
+    }
+    pthread_rwlock_rdlock (&main_ctx_lock);
+    managed = main_ctx != NULL && main_ctx->h != NULL
+              && ((main_ctx->relative_to_managed_path
+                   && (strncmp (path, DYAD_PATH_DELIM, main_ctx->delim_len) != 0))
+                  || (main_ctx->cons_managed_path != NULL
+                      && cmp_canonical_path_prefix (main_ctx, false, path, upath, PATH_MAX))
+                  || (main_ctx->prod_managed_path != NULL
+                      && cmp_canonical_path_prefix (main_ctx, true, path, upath, PATH_MAX)));
+    pthread_rwlock_unlock (&main_ctx_lock);
+    if (!managed) {
+        return;
+    }
+    ctx_attached = true;
+    ctx = ctx_mutable = dyad_ctx_attach (DYAD_COMM_RECV);
+    if (ctx_mutable != NULL) {
+        ctx_mutable->use_fs_locks = true;
+    }
+}
+
 /**
  * @brief GOTCHA wrapper for @c open() that integrates DYAD synchronization
  *        and data transfer.
@@ -241,6 +303,7 @@ static int dyad_open_wrapper (const char *path, int oflag, ...)
 {
     DYAD_C_FUNCTION_START ();
     DYAD_C_FUNCTION_UPDATE_STR ("path", "path");
+    dyad_wrapper_attach (path);
     typedef int (*open_ptr_t) (const char *, int, mode_t, ...);
     open_ptr_t func_ptr = NULL;
     int mode = 0;
@@ -314,6 +377,7 @@ static FILE *dyad_fopen_wrapper (const char *path, const char *mode)
 {
     DYAD_C_FUNCTION_START ();
     DYAD_C_FUNCTION_UPDATE_STR ("path", "path");
+    dyad_wrapper_attach (path);
     typedef FILE *(*fopen_ptr_t) (const char *, const char *);
     fopen_ptr_t func_ptr = NULL;
     char upath[PATH_MAX + 1] = {'\0'};
@@ -385,7 +449,10 @@ real_call:;
  *     @c ctx->fsync_write is enabled.
  *  2. Releases the exclusive lock acquired during @c dyad_open_wrapper().
  *  3. Calls the real @c close().
- *  4. Calls @c dyad_produce() to publish the file metadata to the Flux KVS
+ *  4. Calls @c dyad_produce() to publish the file metadata to the Flux KVS,
+ *     which only adds it to the publication batch if
+ *     @c DYAD_PUBLISH_BATCH_COUNT is set. Files left in the batch are
+ *     committed when the wrapper is unloaded.
  *
  * If any of the preconditions are not met, or the file was not opened for
  * writing, the real @c close() is called directly without synchronization.
@@ -595,6 +662,7 @@ static int dyad_open64_wrapper (const char *path, int oflag, ...)
 {
     DYAD_C_FUNCTION_START ();
     DYAD_C_FUNCTION_UPDATE_STR ("path", "path");
+    dyad_wrapper_attach (path);
     typedef int (*open64_ptr_t) (const char *, int, mode_t, ...);
     open64_ptr_t func_ptr = NULL;
     int mode = 0;
@@ -669,6 +737,7 @@ static FILE *dyad_fopen64_wrapper (const char *path, const char *mode)
 {
     DYAD_C_FUNCTION_START ();
     DYAD_C_FUNCTION_UPDATE_STR ("path", "path");
+    dyad_wrapper_attach (path);
     typedef FILE *(*fopen64_ptr_t) (const char *, const char *);
     fopen64_ptr_t func_ptr = NULL;
     char upath[PATH_MAX + 1] = {'\0'};
@@ -2,9 +2,18 @@
 #include <dyad/core/dyad_ctx.h>
 #include <dyad/client/dyad_client_int.h>
 #include <dyad/client/dyad_client.h>
+#include <dyad/dtl/dyad_dtl_api.h>
+#include <dyad/utils/codec.h>
+#include <dyad/utils/store_engine.h>
+#include <dyad/utils/worker_pool.h>
 #include <fcntl.h>
 
+#include <atomic>
 #include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
 
 int create_files_per_broker() {
   char filename[4096], first_file[4096];
@@ -128,6 +137,72 @@ TEST_CASE("RemoteDataAggBandwidth", "[files= " + std::to_string(args.number_of_f
   REQUIRE(posttest() == 0);
 }
 
+// clang-format off
+TEST_CASE("RemoteDataMultiThreadBandwidth", "[files= " + std::to_string(args.number_of_files) +"]"
+                                            "[file_size= " + std::to_string(args.request_size*args.iteration) +"]"
+                                            "[parallel_req= " + std::to_string(info.comm_size) +"]"
+                                            "[num_nodes= " + std::to_string(info.comm_size / args.process_per_node) +"]") {
+  // clang-format on
+  REQUIRE(pretest() == 0);
+  REQUIRE(clean_directories() == 0);
+  REQUIRE(create_files_per_broker() == 0);
+  dyad_init_env(DYAD_COMM_RECV, info.flux_handle);
+  const unsigned thread_counts[] = {1, 4};
+  for (unsigned threads : thread_counts) {
+    SECTION("Test " + std::to_string(threads) + " threads") {
+      Timer data_time;
+      uint32_t neighour_broker_idx = (info.broker_idx + 1) % info.broker_size;
+      size_t data_len = args.request_size * args.iteration;
+      std::atomic<int> failures(0);
+      // Each thread fetches every threads-th file through a context, and
+      // thus a UCX worker, of its own
+      auto fetch = [&](unsigned tid) {
+        dyad_ctx_t *tctx = dyad_ctx_attach(DYAD_COMM_RECV);
+        if (tctx == NULL || !tctx->initialized) {
+          failures++;
+          return;
+        }
+        char filename[4096];
+        dyad_metadata_t mdata;
+        mdata.owner_rank = neighour_broker_idx;
+        for (size_t file_idx = tid; file_idx < args.number_of_files;
+             file_idx += threads) {
+          sprintf(filename, "%s_%u_%zu.bat", args.filename.c_str(),
+                  neighour_broker_idx, file_idx);
+          mdata.fpath = filename;
+          char *file_data = NULL;
+          size_t file_len = 0;
+          auto rc = dyad_get_data(tctx, &mdata, &file_data, &file_len);
+          if (rc < 0 || file_len != data_len) failures++;
+          if (file_data != NULL)
+            tctx->dtl_handle->return_buffer(tctx, (void **)&file_data);
+        }
+      };
+      std::vector<std::thread> workers;
+      data_time.resumeTime();
+      for (unsigned tid = 0; tid < threads; ++tid) {
+        workers.emplace_back(fetch, tid);
+      }
+      for (auto &worker : workers) {
+        worker.join();
+      }
+      data_time.pauseTime();
+      REQUIRE(failures == 0);
+      AGGREGATE_TIME(data);
+      if (info.rank == 0) {
+        printf("[DYAD_TEST],%10u,%10d,%10lu,%10.6f,%10.6f\n", threads,
+               info.comm_size, data_len * args.number_of_files,
+               total_data / info.comm_size,
+               data_len * args.number_of_files * info.comm_size *
+                   info.comm_size / total_data / 1024 / 1024.0);
+      }
+    }
+  }
+  auto rc = dyad_finalize();
+  REQUIRE(rc >= 0);
+  REQUIRE(clean_directories() == 0);
+  REQUIRE(posttest() == 0);
+}
 // clang-format off
 TEST_CASE("LocalProcessDataBandwidth", "[files= " + std::to_string(args.number_of_files) +"]"
                                  "[file_size= " + std::to_string(args.request_size*args.iteration) +"]"
@@ -216,3 +291,130 @@ TEST_CASE("LocalNodeDataBandwidth", "[files= " + std::to_string(args.number_of_f
   REQUIRE(clean_directories() == 0);
   REQUIRE(posttest() == 0);
 }
+// clang-format off
+TEST_CASE("CompressionCrossover", "[file_size= " + std::to_string(args.request_size*args.iteration) +"]") {
+  // clang-format on
+  size_t data_len = args.request_size * args.iteration;
+  // Same alphabet as the files of the bandwidth tests
+  const char alnum[] =
+      "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+  unsigned int seed = info.rank;
+  std::vector<char> raw(data_len), decoded(data_len);
+  for (size_t i = 0; i < data_len; ++i) {
+    raw[i] = alnum[rand_r(&seed) % (sizeof(alnum) - 1)];
+  }
+  for (int codec = DYAD_CODEC_LZ4; codec <= DYAD_CODEC_ZSTD; ++codec) {
+    if (!dyad_codec_is_available((dyad_codec_t)codec)) continue;
+    SECTION(std::string("Test ") + dyad_codec_name((dyad_codec_t)codec)) {
+      Timer compress_time, decompress_time;
+      std::vector<char> frame(dyad_frame_bound((dyad_codec_t)codec, data_len));
+      compress_time.resumeTime();
+      size_t frame_len = dyad_frame_encode((dyad_codec_t)codec, raw.data(),
+                                           data_len, frame.data(), frame.size());
+      compress_time.pauseTime();
+      if (frame_len == 0) {
+        // Not worth compressing: sent as is
+        frame_len = data_len;
+      } else {
+        size_t raw_len = 0;
+        REQUIRE(dyad_frame_check(frame.data(), frame_len, &raw_len));
+        REQUIRE(raw_len == data_len);
+        decompress_time.resumeTime();
+        int status = dyad_frame_decode(frame.data(), frame_len,
+                                       decoded.data(), raw_len);
+        decompress_time.pauseTime();
+        REQUIRE(status == 0);
+        REQUIRE(decoded == raw);
+      }
+      if (info.rank == 0) {
+        // Compression pays off on links slower than
+        // (1 - ratio) / (1 / compress_bw + 1 / decompress_bw)
+        double ratio = (double)frame_len / data_len;
+        double mb = data_len / 1024 / 1024.0;
+        double c_time = compress_time.getElapsedTime();
+        double d_time = decompress_time.getElapsedTime();
+        printf("[DYAD_TEST],%10s,%10lu,%10.6f,%10.6f,%10.6f,%10.6f\n",
+               dyad_codec_name((dyad_codec_t)codec), data_len, ratio,
+               c_time > 0.0 ? mb / c_time : 0.0,
+               d_time > 0.0 ? mb / d_time : 0.0,
+               c_time + d_time > 0.0 ? (1.0 - ratio) * mb / (c_time + d_time)
+                                     : 0.0);
+      }
+    }
+  }
+}
+// clang-format off
+TEST_CASE("StoreEngine", "[file_size= " + std::to_string(args.request_size*args.iteration) +"]"
+                         "[parallel_req= " + std::to_string(info.comm_size) +"]") {
+  // clang-format on
+  REQUIRE(pretest() == 0);
+  REQUIRE(clean_directories() == 0);
+  if (info.rank % args.process_per_node == 0) {
+    fs::create_directories(args.dyad_managed_dir);
+  }
+  MPI_Barrier(MPI_COMM_WORLD);
+  size_t data_len = args.request_size * args.iteration;
+  // Offset by one byte as receive buffers rarely start on a page
+  std::vector<char> raw(data_len + 1);
+  unsigned int seed = info.rank;
+  for (size_t i = 0; i < raw.size(); ++i) {
+    raw[i] = (char)rand_r(&seed);
+  }
+  const unsigned thread_counts[] = {1, 4};
+  for (int engine = DYAD_IO_ENGINE_POSIX; engine <= DYAD_IO_ENGINE_IO_URING;
+       ++engine) {
+    if (!dyad_io_engine_is_available((dyad_io_engine_t)engine)) continue;
+    for (unsigned threads : thread_counts) {
+      for (int direct = 0; direct <= 1; ++direct) {
+        std::string mode = std::string(dyad_io_engine_name(
+                               (dyad_io_engine_t)engine)) +
+                           "_" + std::to_string(threads) +
+                           (direct ? "_direct" : "_buffered");
+        SECTION("Test " + mode) {
+          dyad_store_opts_t opts;
+          opts.engine = (dyad_io_engine_t)engine;
+          opts.threads = threads;
+          opts.pool = NULL;
+          opts.direct = direct;
+          if (threads > 1) {
+            REQUIRE(dyad_worker_pool_create(threads - 1, NULL, NULL,
+                                            &opts.pool) == 0);
+          }
+          Timer data_time;
+          char filename[4096];
+          sprintf(filename, "%s/%s_%d.bat", args.dyad_managed_dir.c_str(),
+                  args.filename.c_str(), info.rank);
+          int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+          REQUIRE(fd != -1);
+          data_time.resumeTime();
+          dyad_store_prealloc(fd, 0, data_len);
+          ssize_t written =
+              dyad_store_write(&opts, fd, raw.data() + 1, data_len, 0);
+          int status = fsync(fd);
+          data_time.pauseTime();
+          REQUIRE((size_t)written == data_len);
+          REQUIRE(status == 0);
+          REQUIRE(close(fd) == 0);
+          std::vector<char> check(data_len);
+          fd = open(filename, O_RDONLY);
+          REQUIRE(fd != -1);
+          REQUIRE(dyad_io_read(DYAD_IO_ENGINE_POSIX, fd, check.data(),
+                               data_len, 0) == (ssize_t)data_len);
+          REQUIRE(close(fd) == 0);
+          REQUIRE(memcmp(check.data(), raw.data() + 1, data_len) == 0);
+          dyad_worker_pool_destroy(opts.pool);
+          AGGREGATE_TIME(data);
+          if (info.rank == 0) {
+            printf("[DYAD_TEST],%20s,%10d,%10lu,%10.6f,%10.6f\n",
+                   mode.c_str(), info.comm_size, data_len,
+                   total_data / info.comm_size,
+                   data_len * info.comm_size * info.comm_size / total_data /
+                       1024 / 1024.0);
+          }
+        }
+      }
+    }
+  }
+  REQUIRE(clean_directories() == 0);
+  REQUIRE(posttest() == 0);
+}